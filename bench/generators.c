@@ -0,0 +1,215 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "generators.h"
+#include <stdio.h>
+
+
+#define NESTING_DEPTH		200
+#define CHAIN_LENGTH		10000
+#define INITIALIZER_SIZE	100000
+#define FUNCTIONS_NUMBER	2000
+#define MACROS_NUMBER		1000
+#define ACCESSES_NUMBER		2000
+#define IDENTIFIERS_NUMBER	2000
+
+#define ITEMS_PER_LINE		16
+
+
+static const char *const CYRILLIC_NAME = "очень_длинный_идентификатор_переменной_для_замера_номер_";
+
+
+static FILE *open_file(const char *const dir, const char *const name, char *const path)
+{
+	snprintf(path, MAX_BENCH_PATH, "%s/%s", dir, name);
+	return fopen(path, "w");
+}
+
+static int close_file(FILE *const file)
+{
+	const int failed = ferror(file);
+	return fclose(file) || failed ? -1 : 0;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int gen_deep_expression(const char *const dir, const size_t scale, char *const path)
+{
+	FILE *const file = open_file(dir, "deep_expression.c", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	fprintf(file, "void main()\n{\n\tint a = 1;\n\tint b = ");
+	const size_t depth = NESTING_DEPTH * scale;
+	for (size_t i = 0; i < depth; i++)
+	{
+		fprintf(file, "(");
+	}
+
+	fprintf(file, "a");
+	for (size_t i = 0; i < depth; i++)
+	{
+		fprintf(file, i % 2 == 0 ? " + %zu)" : " * %zu)", i % 7 + 1);
+	}
+
+	// Длинная цепочка без вложенности нагружает разбор бинарных операций
+	fprintf(file, ";\n\tint c = a");
+	const size_t length = CHAIN_LENGTH * scale;
+	for (size_t i = 0; i < length; i++)
+	{
+		fprintf(file, i % ITEMS_PER_LINE == 0 ? "\n\t\t%s b" : " %s b", i % 3 == 0 ? "-" : "+");
+	}
+
+	fprintf(file, ";\n\tassert(c != b, \"unreachable\");\n}\n");
+	return close_file(file);
+}
+
+int gen_initializer(const char *const dir, const size_t scale, char *const path)
+{
+	FILE *const file = open_file(dir, "initializer.c", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	const size_t size = INITIALIZER_SIZE * scale;
+	fprintf(file, "int values[%zu] = {", size);
+	for (size_t i = 0; i < size; i++)
+	{
+		fprintf(file, "%s%s%zu", i == 0 ? "" : ",", i % ITEMS_PER_LINE == 0 ? "\n\t" : " ", i % 1000);
+	}
+
+	fprintf(file, "\n};\n\nvoid main()\n{\n\tassert(values[1] == 1, \"wrong initialization\");\n}\n");
+	return close_file(file);
+}
+
+int gen_functions(const char *const dir, const size_t scale, char *const path)
+{
+	FILE *const file = open_file(dir, "functions.c", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	const size_t number = FUNCTIONS_NUMBER * scale;
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "int function_%zu(int x)\n{\n\tint y = x * %zu;\n\tif (y > 100)\n\t{\n\t\treturn y - %zu;\n\t}\n\n"
+			"\treturn y + 1;\n}\n\n", i, i % 13 + 1, i % 100);
+	}
+
+	fprintf(file, "void main()\n{\n\tint sum = 0;\n");
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "\tsum = sum + function_%zu(%zu);\n", i, i % 10);
+	}
+
+	fprintf(file, "\tassert(sum != 0, \"wrong sum\");\n}\n");
+	return close_file(file);
+}
+
+int gen_macro_header(const char *const dir, const size_t scale, char *const path)
+{
+	FILE *file = open_file(dir, "macro_heavy.h", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	const size_t number = MACROS_NUMBER * scale;
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "#define VALUE_%zu %zu\n#define ADD_%zu(a, b) ((a) + (b) + VALUE_%zu)\n", i, i % 100, i, i);
+	}
+
+	if (close_file(file))
+	{
+		return -1;
+	}
+
+	file = open_file(dir, "macro_heavy.c", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	fprintf(file, "#include \"macro_heavy.h\"\n\nvoid main()\n{\n\tint sum = 0;\n");
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "\tsum = ADD_%zu(sum, VALUE_%zu);\n", i, (i * 7) % number);
+	}
+
+	fprintf(file, "\tassert(sum != 0, \"wrong sum\");\n}\n");
+	return close_file(file);
+}
+
+int gen_macro_reuse(const char *const dir, const size_t scale, char *const path)
+{
+	FILE *const file = open_file(dir, "macro_reuse.c", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	// Одни и те же вложенные вызовы с одинаковыми аргументами, как при доступе к полям регистров
+	fprintf(file, "#define REG(base, offset) (base[(offset) / 4])\n"
+		"#define FIELD(base, offset, shift, mask) ((REG(base, offset) >> (shift)) & (mask))\n"
+		"#define SET_FIELD(base, offset, value) REG(base, offset) = REG(base, offset) | (value)\n\n"
+		"int registers[64];\n\nvoid main()\n{\n\tint sum = 0;\n");
+
+	const size_t number = ACCESSES_NUMBER * scale;
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "\tSET_FIELD(registers, 8, %zu);\n\tsum = sum + FIELD(registers, 8, 3, 7);\n", i % 2);
+	}
+
+	fprintf(file, "\tassert(sum >= 0, \"wrong sum\");\n}\n");
+	return close_file(file);
+}
+
+int gen_cyrillic(const char *const dir, const size_t scale, char *const path)
+{
+	FILE *const file = open_file(dir, "cyrillic.c", path);
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	const size_t number = IDENTIFIERS_NUMBER * scale;
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "цел %s%zu = %zu;\n", CYRILLIC_NAME, i, i % 100);
+	}
+
+	fprintf(file, "\nvoid main()\n{\n\tцел сумма = 0;\n");
+	for (size_t i = 0; i < number; i++)
+	{
+		fprintf(file, "\tсумма = сумма + %s%zu;\n", CYRILLIC_NAME, i);
+	}
+
+	fprintf(file, "\tassert(сумма != 0, \"wrong sum\");\n}\n");
+	return close_file(file);
+}
@@ -0,0 +1,61 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+
+#define MAX_BENCH_PATH 1024
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Prototype of synthetic input generator
+ *
+ *	@param	dir		Directory for generated files
+ *	@param	scale	Size multiplier of generated input
+ *	@param	path	Path of main generated file
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+typedef int (*generator)(const char *const dir, const size_t scale, char *const path);
+
+
+/** Deeply nested parentheses and long flat chains of operators */
+int gen_deep_expression(const char *const dir, const size_t scale, char *const path);
+
+/** Global array with hundred thousands elements in initializer */
+int gen_initializer(const char *const dir, const size_t scale, char *const path);
+
+/** Thousands of small functions called from main */
+int gen_functions(const char *const dir, const size_t scale, char *const path);
+
+/** Header with thousands of object-like and function-like macros */
+int gen_macro_header(const char *const dir, const size_t scale, char *const path);
+
+/** Repeated invocations of nested function-like macros with identical arguments */
+int gen_macro_reuse(const char *const dir, const size_t scale, char *const path);
+
+/** Thousands of variables with long Cyrillic identifiers */
+int gen_cyrillic(const char *const dir, const size_t scale, char *const path);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
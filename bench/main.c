@@ -0,0 +1,346 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "generators.h"
+#include "logger.h"
+#include "strings.h"
+#include "workspace.h"
+
+#ifndef _WIN32
+	#include <dirent.h>
+	#include <sys/stat.h>
+	#include <sys/types.h>
+#else
+	#include <direct.h>
+#endif
+
+
+#define MAX_REPORT_SIZE 8192
+#define PHASES 4
+
+
+static const char *const DEFAULT_DIR = "bench_inputs";
+static const char *const DEFAULT_CORPUS = "../tests/codegen/executable";
+static const char *const OUTPUT_NAME = "bench.out";
+static const char *const SKIPPED_DIR = "include";
+
+static const char *const PHASE_NAMES[PHASES] = { "macro", "parse", "link", "codegen" };
+static const char *const TABLE_NAMES[] = { "tree", "identifiers", "types", "representations", "functions", "strings" };
+
+#define TABLES (sizeof(TABLE_NAMES) / sizeof(TABLE_NAMES[0]))
+
+
+/** Results of one run of benchmark */
+typedef struct sample
+{
+	double wall[PHASES];		/**< Wall time of phases */
+	double cpu[PHASES];			/**< CPU time of phases */
+	size_t tables[TABLES];		/**< Sizes of syntax tables */
+	size_t allocs;				/**< Number of arena allocations */
+	size_t peak_rss;			/**< Peak resident set size in kilobytes */
+	size_t files;				/**< Number of compiled files */
+	size_t failures;			/**< Number of files failed to compile */
+} sample;
+
+/** Benchmark options */
+typedef struct options
+{
+	size_t repeats;				/**< Number of runs, the fastest one is reported */
+	size_t scale;				/**< Size multiplier of inputs */
+	const char *dir;			/**< Directory for generated inputs and outputs */
+	const char *corpus;			/**< Directory of tests corpus */
+	const char *flag;			/**< Additional compiler flag */
+} options;
+
+/** Synthetic benchmark */
+typedef struct benchmark
+{
+	const char *name;			/**< Benchmark name */
+	generator generate;			/**< Generator of input */
+} benchmark;
+
+
+static const benchmark BENCHMARKS[] =
+{
+	{ "deep_expression", &gen_deep_expression },
+	{ "initializer", &gen_initializer },
+	{ "functions", &gen_functions },
+	{ "macro_header", &gen_macro_header },
+	{ "macro_reuse", &gen_macro_reuse },
+	{ "cyrillic", &gen_cyrillic },
+};
+
+
+static char report[MAX_REPORT_SIZE];
+
+
+static void silent_log(const char *const tag, const char *const msg)
+{
+	(void)tag;
+	(void)msg;
+}
+
+static void report_log(const char *const tag, const char *const msg)
+{
+	(void)tag;
+	snprintf(report, MAX_REPORT_SIZE, "%s", msg);
+}
+
+
+/** Get number from JSON report by key of object and key of its field */
+static double get_number(const char *const object, const char *const field)
+{
+	char key[64];
+	sprintf(key, "\"%s\": ", object);
+
+	const char *position = strstr(report, key);
+	if (position != NULL && field != NULL)
+	{
+		sprintf(key, "\"%s\": ", field);
+		position = strstr(position, key);
+	}
+
+	return position != NULL ? strtod(position + strlen(key), NULL) : 0;
+}
+
+static double get_total(const double *const phases)
+{
+	double total = 0;
+	for (size_t i = 0; i < PHASES; i++)
+	{
+		total += phases[i];
+	}
+
+	return total;
+}
+
+
+/** Compile file and add its report to sample */
+static void compile_file(const options *const opts, const char *const path, sample *const smp)
+{
+	char output[MAX_BENCH_PATH];
+	snprintf(output, MAX_BENCH_PATH, "%s/%s", opts->dir, OUTPUT_NAME);
+
+	workspace ws = ws_create();
+	ws_add_file(&ws, path);
+	ws_add_flag(&ws, "-ftime-report=json");
+	ws_add_flag(&ws, "-Wno");
+	if (opts->flag != NULL)
+	{
+		ws_add_flag(&ws, opts->flag);
+	}
+	ws_set_output(&ws, output);
+	ws_set_log(&ws, &silent_log, &silent_log);
+
+	report[0] = '\0';
+	const status_t sts = compile(&ws);
+	ws_clear(&ws);
+
+	smp->files++;
+	smp->failures += sts != sts_success ? 1 : 0;
+
+	for (size_t i = 0; i < PHASES; i++)
+	{
+		smp->wall[i] += get_number(PHASE_NAMES[i], "wall");
+		smp->cpu[i] += get_number(PHASE_NAMES[i], "cpu");
+	}
+
+	for (size_t i = 0; i < TABLES; i++)
+	{
+		smp->tables[i] += (size_t)get_number(TABLE_NAMES[i], NULL);
+	}
+
+	smp->allocs += (size_t)get_number("allocs", NULL);
+	const size_t peak_rss = (size_t)get_number("peak_rss_kb", NULL);
+	smp->peak_rss = peak_rss > smp->peak_rss ? peak_rss : smp->peak_rss;
+}
+
+/** Add test files from directory to corpus */
+static void collect_corpus(const char *const dir, strings *const corpus)
+{
+#ifndef _WIN32
+	DIR *const handle = opendir(dir);
+	if (handle == NULL)
+	{
+		return;
+	}
+
+	struct dirent *entry;
+	while ((entry = readdir(handle)) != NULL)
+	{
+		const char *const name = entry->d_name;
+		if (name[0] == '.')
+		{
+			continue;
+		}
+
+		char path[MAX_BENCH_PATH];
+		snprintf(path, MAX_BENCH_PATH, "%s/%s", dir, name);
+
+		struct stat stat_buf;
+		if (stat(path, &stat_buf))
+		{
+			continue;
+		}
+
+		// Многофайловые тесты собираются только вместе, поэтому пропускаются
+		if (S_ISDIR(stat_buf.st_mode) && strcmp(name, SKIPPED_DIR) != 0)
+		{
+			collect_corpus(path, corpus);
+		}
+		else if (S_ISREG(stat_buf.st_mode) && strlen(name) > 2 && strcmp(&name[strlen(name) - 2], ".c") == 0)
+		{
+			strings_add(corpus, path);
+		}
+	}
+
+	closedir(handle);
+#else
+	(void)dir;
+	(void)corpus;
+#endif
+}
+
+
+static void print_sample(const options *const opts, const char *const name, const sample *const smp)
+{
+	printf("{\"bench\": \"%s\", \"scale\": %zu, \"repeats\": %zu, \"files\": %zu, \"failures\": %zu, \"phases\": {"
+		, name, opts->scale, opts->repeats, smp->files, smp->failures);
+	for (size_t i = 0; i < PHASES; i++)
+	{
+		printf("%s\"%s\": {\"wall\": %.6f, \"cpu\": %.6f}", i == 0 ? "" : ", ", PHASE_NAMES[i], smp->wall[i], smp->cpu[i]);
+	}
+
+	printf("}, \"total\": {\"wall\": %.6f, \"cpu\": %.6f}, \"peak_rss_kb\": %zu, \"allocs\": %zu, \"tables\": {"
+		, get_total(smp->wall), get_total(smp->cpu), smp->peak_rss, smp->allocs);
+	for (size_t i = 0; i < TABLES; i++)
+	{
+		printf("%s\"%s\": %zu", i == 0 ? "" : ", ", TABLE_NAMES[i], smp->tables[i]);
+	}
+
+	printf("}}\n");
+	fflush(stdout);
+}
+
+/** Run benchmark several times and print the fastest run */
+static void run(const options *const opts, const char *const name, const strings *const files, const size_t times)
+{
+	sample best;
+	for (size_t i = 0; i < opts->repeats; i++)
+	{
+		sample smp;
+		memset(&smp, 0, sizeof(sample));
+
+		for (size_t j = 0; j < times; j++)
+		{
+			for (size_t k = 0; k < strings_size(files); k++)
+			{
+				compile_file(opts, strings_get(files, k), &smp);
+			}
+		}
+
+		if (i == 0 || get_total(smp.wall) < get_total(best.wall))
+		{
+			best = smp;
+		}
+	}
+
+	print_sample(opts, name, &best);
+}
+
+
+static options parse_options(const int argc, const char *const *const argv)
+{
+	options opts = { .repeats = 5, .scale = 1, .dir = DEFAULT_DIR, .corpus = DEFAULT_CORPUS, .flag = NULL };
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strncmp(argv[i], "--repeat=", 9) == 0)
+		{
+			opts.repeats = (size_t)strtoul(&argv[i][9], NULL, 10);
+		}
+		else if (strncmp(argv[i], "--scale=", 8) == 0)
+		{
+			opts.scale = (size_t)strtoul(&argv[i][8], NULL, 10);
+		}
+		else if (strncmp(argv[i], "--dir=", 6) == 0)
+		{
+			opts.dir = &argv[i][6];
+		}
+		else if (strncmp(argv[i], "--corpus=", 9) == 0)
+		{
+			opts.corpus = &argv[i][9];
+		}
+		else if (strncmp(argv[i], "--flag=", 7) == 0)
+		{
+			opts.flag = &argv[i][7];
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [--repeat=N] [--scale=N] [--dir=path] [--corpus=path] [--flag=compiler_flag]\n", argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	opts.repeats = opts.repeats != 0 ? opts.repeats : 1;
+	opts.scale = opts.scale != 0 ? opts.scale : 1;
+	return opts;
+}
+
+
+int main(int argc, const char *argv[])
+{
+	const options opts = parse_options(argc, argv);
+
+#ifndef _WIN32
+	mkdir(opts.dir, 0777);
+#else
+	_mkdir(opts.dir);
+#endif
+
+	set_report_log(&report_log);
+
+	// Каждая строка вывода — отдельный JSON объект, чтобы результаты разных коммитов сравнивались построчно
+	for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++)
+	{
+		char path[MAX_BENCH_PATH];
+		if (BENCHMARKS[i].generate(opts.dir, opts.scale, path))
+		{
+			fprintf(stderr, "%s: failed to generate input\n", BENCHMARKS[i].name);
+			continue;
+		}
+
+		strings files = strings_create(1);
+		strings_add(&files, path);
+		run(&opts, BENCHMARKS[i].name, &files, 1);
+		strings_clear(&files);
+	}
+
+	// Корпус тестов увеличивается повторной компиляцией каждого файла
+	strings corpus = strings_create(512);
+	collect_corpus(opts.corpus, &corpus);
+	if (strings_size(&corpus) != 0)
+	{
+		run(&opts, "corpus", &corpus, opts.scale);
+	}
+
+	strings_clear(&corpus);
+	return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hash.h"
+#include "map.h"
+#include "stack.h"
+#include "strings.h"
+#include "tree.h"
+#include "vector.h"
+
+
+#define MAX_KEY_SIZE 128
+
+#define MIN_SIZE 1000
+#define DEFAULT_MAX_SIZE 10000000
+
+#define TREE_LOOKUPS 1000
+#define TREE_MAX_SIZE 100000
+
+
+static const char *const SHORT_KEY = "key%zu";
+static const char *const LONG_KEY = "очень_длинный_общий_префикс_идентификатора_с_одинаковым_началом_%zu";
+
+static const uint64_t RANDOM_MULTIPLIER = 6364136223846793005ULL;
+static const uint64_t RANDOM_INCREMENT = 1442695040888963407ULL;
+
+
+/** Measurement of one operation on container */
+typedef struct measure
+{
+	double start;				/**< Time of measurement start */
+	size_t size;				/**< Number of elements */
+} measure;
+
+
+// Результат операций сохраняется, чтобы компилятор не выбросил замеряемый код
+static volatile item_t sink;
+
+
+static double get_time(void)
+{
+	struct timespec time;
+#ifndef _WIN32
+	clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+	timespec_get(&time, TIME_UTC);
+#endif
+	return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+/** Pseudo-random index less than size */
+static inline size_t get_random(uint64_t *const state, const size_t size)
+{
+	*state = *state * RANDOM_MULTIPLIER + RANDOM_INCREMENT;
+	return (size_t)(*state >> 33) % size;
+}
+
+
+static measure measure_begin(const size_t size)
+{
+	measure msr = { .start = get_time(), .size = size };
+	return msr;
+}
+
+static void measure_end(const measure *const msr, const char *const name, const size_t ops)
+{
+	const double seconds = get_time() - msr->start;
+	printf("{\"bench\": \"%s\", \"size\": %zu, \"ops\": %zu, \"seconds\": %.6f, \"ns_per_op\": %.3f}\n"
+		, name, msr->size, ops, seconds, ops != 0 ? seconds * 1e9 / (double)ops : 0);
+	fflush(stdout);
+}
+
+
+static void bench_vector(const size_t size)
+{
+	vector vec = vector_create(1);
+
+	measure msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		vector_add(&vec, (item_t)i);
+	}
+	measure_end(&msr, "vector_add", size);
+
+	msr = measure_begin(size);
+	item_t sum = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		sum += vector_get(&vec, i);
+	}
+	sink = sum;
+	measure_end(&msr, "vector_iterate", size);
+
+	uint64_t state = size;
+	msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sum += vector_get(&vec, get_random(&state, size));
+	}
+	sink = sum;
+	measure_end(&msr, "vector_lookup", size);
+
+	vector_clear(&vec);
+}
+
+static void bench_stack(const size_t size)
+{
+	stack stk = stack_create(1);
+
+	measure msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		stack_push(&stk, (item_t)i);
+	}
+
+	item_t sum = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		sum += stack_pop(&stk);
+	}
+	sink = sum;
+	measure_end(&msr, "stack_push_pop", 2 * size);
+
+	stack_clear(&stk);
+}
+
+static void bench_hash(const size_t size)
+{
+	hash hs = hash_create(1);
+
+	measure msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		// Ключи с шагом степени двойки проверяют распределение по корзинам
+		const item_t key = (item_t)(i << 4);
+		hash_add(&hs, key, 1);
+		hash_set(&hs, key, 0, (item_t)i);
+	}
+	measure_end(&msr, "hash_add", size);
+
+	uint64_t state = size;
+	item_t sum = 0;
+	msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sum += hash_get(&hs, (item_t)(get_random(&state, size) << 4), 0);
+	}
+	sink = sum;
+	measure_end(&msr, "hash_lookup", size);
+
+	hash_clear(&hs);
+}
+
+static void bench_map(const size_t size, const char *const format, const char *const name_add
+	, const char *const name_lookup, const char *const name_iterate)
+{
+	map as = map_create(1);
+	char key[MAX_KEY_SIZE];
+
+	measure msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sprintf(key, format, i);
+		map_add(&as, key, (item_t)i);
+	}
+	measure_end(&msr, name_add, size);
+
+	uint64_t state = size;
+	item_t sum = 0;
+	msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sprintf(key, format, get_random(&state, size));
+		sum += map_get(&as, key);
+	}
+	sink = sum;
+	measure_end(&msr, name_lookup, size);
+
+	msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sum += map_get_by_index(&as, i);
+	}
+	sink = sum;
+	measure_end(&msr, name_iterate, size);
+
+	map_clear(&as);
+}
+
+static void bench_strings(const size_t size)
+{
+	strings vec = strings_create(1);
+	char key[MAX_KEY_SIZE];
+
+	measure msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sprintf(key, SHORT_KEY, i);
+		strings_add(&vec, key);
+	}
+	measure_end(&msr, "strings_add", size);
+
+	size_t sum = 0;
+	msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		sum += (size_t)strings_get(&vec, i)[0];
+	}
+	sink = (item_t)sum;
+	measure_end(&msr, "strings_iterate", size);
+
+	strings_clear(&vec);
+}
+
+static void bench_tree(const size_t size)
+{
+	vector tree = vector_create(1);
+	node root = node_get_root(&tree);
+
+	measure msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		node child = node_add_child(&root, (item_t)i);
+		node_add_arg(&child, (item_t)i);
+	}
+	measure_end(&msr, "tree_add_child", size);
+
+	// Дети без заморозки хранятся списком, поэтому доступ по индексу замеряется на равномерной выборке
+	const size_t lookups = size < TREE_LOOKUPS ? size : TREE_LOOKUPS;
+	item_t sum = 0;
+	msr = measure_begin(size);
+	for (size_t i = 0; i < lookups; i++)
+	{
+		const node child = node_get_child(&root, i * (size / lookups));
+		sum += node_get_type(&child);
+	}
+	sink = sum;
+	measure_end(&msr, "tree_get_child", lookups);
+
+	node_freeze(&root);
+	msr = measure_begin(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node child = node_get_child(&root, i);
+		sum += node_get_type(&child);
+	}
+	sink = sum;
+	measure_end(&msr, "tree_get_child_frozen", size);
+
+	msr = measure_begin(size);
+	node nd = node_get_next(&root);
+	for (size_t i = 0; i < size && node_is_correct(&nd); i++)
+	{
+		sum += node_get_arg(&nd, 0);
+		nd = node_get_next(&nd);
+	}
+	sink = sum;
+	measure_end(&msr, "tree_traverse", size);
+
+	msr = measure_begin(size);
+	size_t depths = 0;
+	for (node_iterator it = node_iterator_create(&root); node_iterator_is_correct(&it); node_iterator_next(&it))
+	{
+		const node current = node_iterator_get(&it);
+		sum += node_get_type(&current);
+		depths += node_iterator_get_depth(&it);
+	}
+	sink = sum + (item_t)depths;
+	measure_end(&msr, "tree_iterate", size);
+
+	vector_clear(&tree);
+}
+
+
+int main(int argc, const char *argv[])
+{
+	size_t max_size = DEFAULT_MAX_SIZE;
+	if (argc == 2 && strncmp(argv[1], "--max=", 6) == 0)
+	{
+		max_size = (size_t)strtoul(&argv[1][6], NULL, 10);
+	}
+	else if (argc != 1)
+	{
+		fprintf(stderr, "Usage: %s [--max=N]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Каждая строка вывода — отдельный JSON объект, чтобы результаты разных коммитов сравнивались построчно
+	for (size_t size = MIN_SIZE; size <= max_size; size *= 10)
+	{
+		bench_vector(size);
+		bench_stack(size);
+		bench_hash(size);
+		bench_map(size, SHORT_KEY, "map_add", "map_lookup", "map_iterate");
+		bench_map(size, LONG_KEY, "map_add_common_prefix", "map_lookup_common_prefix", "map_iterate_common_prefix");
+		bench_strings(size);
+
+		// Добавление ребёнка проходит список братьев, поэтому большие деревья строятся слишком долго
+		if (size <= TREE_MAX_SIZE)
+		{
+			bench_tree(size);
+		}
+	}
+
+	return 0;
+}
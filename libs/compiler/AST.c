@@ -34,6 +34,32 @@ static inline void node_set_child(const node *const parent, const node *const ch
 	node_remove(&temp);
 }
 
+#if LOCATION_SIZE == 1
+static const size_t LOCATION_BITS = 32;
+static const item_t LOCATION_MASK = 0x7FFFFFFF;
+
+static inline item_t location_pack(const range_location loc)
+{
+	// Позиции вне 2 ГиБ и неизвестные позиции не упаковываются
+	if (loc.begin > (size_t)LOCATION_MASK || loc.end < loc.begin || loc.end - loc.begin > (size_t)LOCATION_MASK)
+	{
+		return ITEM_MAX;
+	}
+
+	return (item_t)loc.begin | (item_t)(loc.end - loc.begin) << LOCATION_BITS;
+}
+#endif
+
+static inline void node_add_location(const node *const nd, const range_location loc)
+{
+#if LOCATION_SIZE == 1
+	node_add_arg(nd, location_pack(loc));
+#else
+	node_add_arg(nd, (item_t)loc.begin);
+	node_add_arg(nd, (item_t)loc.end);
+#endif
+}
+
 
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
@@ -47,7 +73,28 @@ static inline void node_set_child(const node *const parent, const node *const ch
 range_location node_get_location(const node *const nd)
 {
 	const size_t argc = node_get_argc(nd);
+#if LOCATION_SIZE == 1
+	const item_t value = node_get_arg(nd, argc - 1);
+	if (value == ITEM_MAX)
+	{
+		return (range_location){ (size_t)ITEM_MAX, (size_t)ITEM_MAX };
+	}
+
+	const size_t begin = (size_t)(value & LOCATION_MASK);
+	return (range_location){ begin, begin + (size_t)((value >> LOCATION_BITS) & LOCATION_MASK) };
+#else
 	return (range_location){ (size_t)node_get_arg(nd, argc - 2), (size_t)node_get_arg(nd, argc - 1) };
+#endif
+}
+
+void node_set_location(const node *const nd, const size_t index, const range_location loc)
+{
+#if LOCATION_SIZE == 1
+	node_set_arg(nd, index, location_pack(loc));
+#else
+	node_set_arg(nd, index, (item_t)loc.begin);
+	node_set_arg(nd, index + 1, (item_t)loc.end);
+#endif
 }
 
 expression_t expression_get_class(const node *const nd)
@@ -90,8 +137,7 @@ node expression_identifier(node *const context, const item_t type, const size_t
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, LVALUE);						// Категория значения выражения
 	node_add_arg(&nd, (item_t)id);					// Индекс в таблице идентификаторов
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -102,6 +148,12 @@ size_t expression_identifier_get_id(const node *const nd)
 	return (size_t)node_get_arg(nd, 2);
 }
 
+void expression_literal_set_string(const node *const nd, const size_t index)
+{
+	assert(node_get_type(nd) == OP_LITERAL);
+	node_set_arg(nd, 2, (item_t)index);
+}
+
 
 node expression_null_literal(node *const context, const item_t type, const range_location loc)
 {
@@ -109,8 +161,7 @@ node expression_null_literal(node *const context, const item_t type, const range
 
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -123,8 +174,7 @@ node expression_boolean_literal(node *const context, const item_t type, const bo
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
 	node_add_arg(&nd, value ? 1 : 0);				// Значение литерала
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -143,8 +193,7 @@ node expression_character_literal(node *const context, const item_t type, const
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
 	node_add_arg(&nd, (item_t)value);				// Значение литерала
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -156,23 +205,24 @@ char32_t expression_literal_get_character(const node *const nd)
 }
 
 
-node expression_integer_literal(node *const context, const item_t type, const item_t value, const range_location loc)
+node expression_integer_literal(node *const context, const item_t type, const int64_t value, const range_location loc)
 {
 	node nd = node_create(context, OP_LITERAL);
 
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
-	node_add_arg(&nd, value);						// Значение литерала
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_arg_int64(&nd, value);					// Значение литерала
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
 
-item_t expression_literal_get_integer(const node *const nd)
+int64_t expression_literal_get_integer(const node *const nd)
 {
 	assert(node_get_type(nd) == OP_LITERAL);
-	return node_get_arg(nd, 2);
+
+	// Литералы-символы и логические литералы занимают один элемент
+	return node_get_argc(nd) == INT64_SIZE + 2 + LOCATION_SIZE ? node_get_arg_int64(nd, 2) : (int64_t)node_get_arg(nd, 2);
 }
 
 
@@ -183,8 +233,7 @@ node expression_floating_literal(node *const context, const item_t type, const d
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
 	node_add_arg_double(&nd, value);				// Значение литерала
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -203,8 +252,7 @@ node expression_string_literal(node *const context, const item_t type, const siz
 	node_add_arg(&nd, type);						// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
 	node_add_arg(&nd, (item_t)index);				// Значение литерала
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция выражения
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция выражения
+	node_add_location(&nd, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -218,13 +266,12 @@ size_t expression_literal_get_string(const node *const nd)
 
 node expression_subscript(const item_t type, node *const base, node *const index, const range_location loc)
 {
-	node nd = node_insert(base, OP_SLICE, 4);		// Выражение-операнд
+	node nd = node_insert(base, OP_SLICE, 2 + LOCATION_SIZE);	// Выражение-операнд
 	node_set_child(&nd, index);						// Выражение-индекс
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, LVALUE);					// Категория значения выражения
-	node_set_arg(&nd, 2, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 3, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 2, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -244,11 +291,13 @@ node expression_subscript_get_index(const node *const nd)
 
 node expression_call(const item_t type, node *const callee, node_vector *const args, const range_location loc)
 {
-	node nd = node_insert(callee, OP_CALL, 4);		// Операнд выражения
+	node nd = node_insert(callee, OP_CALL, 2 + LOCATION_SIZE);	// Операнд выражения
 
-	if (node_vector_is_correct(args))
+	const size_t amount = node_vector_is_correct(args) ? node_vector_size(args) : 0;
+	const node last = amount != 0 ? node_vector_get(args, amount - 1) : node_broken();
+	if (amount != 0 && node_absorb(&nd, amount, &last))
 	{
-		const size_t amount = node_vector_size(args);
+		// Аргументы не идут подряд за вызовом, переносим по одному
 		for (size_t i = 0; i < amount; i++)
 		{
 			node arg = node_vector_get(args, i);
@@ -258,8 +307,7 @@ node expression_call(const item_t type, node *const callee, node_vector *const a
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, RVALUE);					// Категория значения выражения
-	node_set_arg(&nd, 2, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 3, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 2, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -286,14 +334,13 @@ node expression_call_get_argument(const node *const nd, const size_t index)
 node expression_member(const item_t type, const category_t ctg
 	, const size_t index, bool is_arrow, node *const base, const range_location loc)
 {
-	node nd = node_insert(base, OP_SELECT, 6);		// Операнд выражения
+	node nd = node_insert(base, OP_SELECT, 4 + LOCATION_SIZE);	// Операнд выражения
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, ctg);						// Категория значения выражения
 	node_set_arg(&nd, 2, (item_t)index);			// Индекс поля выборки
 	node_set_arg(&nd, 3, is_arrow);					// Является ли оператор '->'
-	node_set_arg(&nd, 4, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 5, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 4, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -319,13 +366,12 @@ bool expression_member_is_arrow(const node *const nd)
 
 node expression_cast(const item_t target_type, const item_t source_type, node *const expr, const range_location loc)
 {
-	node nd = node_insert(expr, OP_CAST, 5);		// Операнд выражения
+	node nd = node_insert(expr, OP_CAST, 3 + LOCATION_SIZE);	// Операнд выражения
 
 	node_set_arg(&nd, 0, target_type);				// Тип значения выражения
 	node_set_arg(&nd, 1, RVALUE);					// Категория значения выражения
 	node_set_arg(&nd, 2, source_type);				// Тип до преобразования
-	node_set_arg(&nd, 3, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 4, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 3, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -345,13 +391,12 @@ node expression_cast_get_operand(const node *const nd)
 
 node expression_unary(const item_t type, const category_t ctg, node *const expr, const unary_t op, const range_location loc)
 {
-	node nd = node_insert(expr, OP_UNARY, 5);		// Операнд выражения
+	node nd = node_insert(expr, OP_UNARY, 3 + LOCATION_SIZE);	// Операнд выражения
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, ctg);						// Категория значения выражения
 	node_set_arg(&nd, 2, op);						// Вид унарного оператора
-	node_set_arg(&nd, 3, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 4, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 3, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -371,14 +416,13 @@ node expression_unary_get_operand(const node *const nd)
 
 node expression_binary(const item_t type, node *const LHS, node *const RHS, const binary_t op, const range_location loc)
 {
-	node nd = node_insert(LHS, OP_BINARY, 5);		// Первый операнд выражения
+	node nd = node_insert(LHS, OP_BINARY, 3 + LOCATION_SIZE);	// Первый операнд выражения
 	node_set_child(&nd, RHS);						// Второй операнд выражения
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, RVALUE);					// Категория значения выражения
 	node_set_arg(&nd, 2, op);						// Вид бинарного оператора
-	node_set_arg(&nd, 3, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 4, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 3, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -404,14 +448,13 @@ node expression_binary_get_RHS(const node *const nd)
 
 node expression_ternary(const item_t type, node *const cond, node *const LHS, node *const RHS, const range_location loc)
 {
-	node nd = node_insert(cond, OP_TERNARY, 4);		// Первый операнд выражения
+	node nd = node_insert(cond, OP_TERNARY, 2 + LOCATION_SIZE);	// Первый операнд выражения
 	node_set_child(&nd, LHS);						// Второй операнд выражения
 	node_set_child(&nd, RHS);						// Третий операнд выражения
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, RVALUE);					// Категория значения выражения
-	node_set_arg(&nd, 2, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 3, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 2, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -437,14 +480,13 @@ node expression_ternary_get_RHS(const node *const nd)
 
 node expression_assignment(const item_t type, node *const LHS, node *const RHS, const binary_t op, const range_location loc)
 {
-	node nd = node_insert(LHS, OP_ASSIGNMENT, 5);	// Первый операнд выражения
+	node nd = node_insert(LHS, OP_ASSIGNMENT, 3 + LOCATION_SIZE);	// Первый операнд выражения
 	node_set_child(&nd, RHS);						// Второй операнд выражения
 
 	node_set_arg(&nd, 0, type);						// Тип значения выражения
 	node_set_arg(&nd, 1, RVALUE);					// Категория значения выражения
 	node_set_arg(&nd, 2, op);						// Вид бинарного оператора
-	node_set_arg(&nd, 3, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 4, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 3, loc);					// Позиция выражения
 
 	return nd;
 }
@@ -471,23 +513,47 @@ node expression_assignment_get_RHS(const node *const nd)
 node expression_initializer(node_vector *const exprs, const range_location loc)
 {
 	node fst = node_vector_get(exprs, 0);
-	node nd = node_insert(&fst, OP_INITIALIZER, 4);
+	node nd = node_insert(&fst, OP_INITIALIZER, 2 + LOCATION_SIZE);
 
 	node_set_arg(&nd, 0, TYPE_UNDEFINED);			// Тип значения выражения
 	node_set_arg(&nd, 1, RVALUE);					// Категория значения выражения
-	node_set_arg(&nd, 2, (item_t)loc.begin);		// Начальная позиция выражения
-	node_set_arg(&nd, 3, (item_t)loc.end);			// Конечная позиция выражения
+	node_set_location(&nd, 2, loc);					// Позиция выражения
 
 	const size_t amount = node_vector_size(exprs);
-	for (size_t i = 1; i < amount; i++)
+	const node last = node_vector_get(exprs, amount - 1);
+	if (amount > 1 && node_absorb(&nd, amount - 1, &last))
 	{
-		node subexpr = node_vector_get(exprs, i);
-		node_set_child(&nd, &subexpr);				// i-ое подвыражение списка
+		// Подвыражения не идут подряд за первым, переносим по одному
+		for (size_t i = 1; i < amount; i++)
+		{
+			node subexpr = node_vector_get(exprs, i);
+			node_set_child(&nd, &subexpr);			// i-ое подвыражение списка
+		}
 	}
 
 	return nd;
 }
 
+node expression_packed_initializer(node *const context, const item_t type, const vector *const values
+	, const range_location loc)
+{
+	node nd = node_create(context, OP_INITIALIZER);
+
+	node_add_arg(&nd, TYPE_UNDEFINED);				// Тип значения выражения
+	node_add_arg(&nd, RVALUE);						// Категория значения выражения
+	node_add_arg(&nd, type);						// Тип литералов
+
+	// Целые и вещественные значения занимают одинаковое число элементов
+	const size_t size = vector_size(values);
+	for (size_t i = 0; i < size; i++)
+	{
+		node_add_arg(&nd, vector_get(values, i));	// Значения литералов
+	}
+
+	node_add_location(&nd, loc);					// Позиция выражения
+	return nd;
+}
+
 void expression_initializer_set_type(const node *const nd, const item_t type)
 {
 	assert(node_get_type(nd) == OP_INITIALIZER);
@@ -497,15 +563,42 @@ void expression_initializer_set_type(const node *const nd, const item_t type)
 size_t expression_initializer_get_size(const node *const nd)
 {
 	assert(node_get_type(nd) == OP_INITIALIZER);
-	return node_get_amount(nd);
+	return expression_initializer_is_packed(nd)
+		? (node_get_argc(nd) - 3 - LOCATION_SIZE) / INT64_SIZE
+		: node_get_amount(nd);
 }
 
 node expression_initializer_get_subexpr(const node *const nd, const size_t index)
 {
 	assert(node_get_type(nd) == OP_INITIALIZER);
+	assert(!expression_initializer_is_packed(nd));
 	return node_get_child(nd, index);
 }
 
+bool expression_initializer_is_packed(const node *const nd)
+{
+	assert(node_get_type(nd) == OP_INITIALIZER);
+	return node_get_argc(nd) > 2 + LOCATION_SIZE;
+}
+
+item_t expression_initializer_get_literal_type(const node *const nd)
+{
+	assert(expression_initializer_is_packed(nd));
+	return node_get_arg(nd, 2);
+}
+
+int64_t expression_initializer_get_integer(const node *const nd, const size_t index)
+{
+	assert(expression_initializer_is_packed(nd));
+	return node_get_arg_int64(nd, 3 + index * INT64_SIZE);
+}
+
+double expression_initializer_get_floating(const node *const nd, const size_t index)
+{
+	assert(expression_initializer_is_packed(nd));
+	return node_get_arg_double(nd, 3 + index * DOUBLE_SIZE);
+}
+
 
 node expression_empty_bound(node *const context, const range_location loc)
 {
@@ -514,8 +607,7 @@ node expression_empty_bound(node *const context, const range_location loc)
 
 	node_add_arg(&nd, TYPE_INTEGER);				// Тип значения выражения
 	node_add_arg(&nd, RVALUE);						// Категория значения выражения
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция оператора
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -559,11 +651,10 @@ statement_t statement_get_class(const node *const nd)
 
 node statement_case(node *const expr, node *const substmt, const range_location loc)
 {
-	node nd = node_insert(expr, OP_CASE, 2);
+	node nd = node_insert(expr, OP_CASE, LOCATION_SIZE);
 	node_set_child(&nd, substmt);
 
-	node_set_arg(&nd, 0, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 1, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 0, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -583,10 +674,9 @@ node statement_case_get_substmt(const node *const nd)
 
 node statement_default(node *const substmt, const range_location loc)
 {
-	node nd = node_insert(substmt, OP_DEFAULT, 2);
+	node nd = node_insert(substmt, OP_DEFAULT, LOCATION_SIZE);
 
-	node_set_arg(&nd, 0, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 1, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 0, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -602,8 +692,7 @@ node statement_compound(node *const context, node_vector *const stmts, const ran
 {
 	node nd = node_create(context, OP_BLOCK);
 
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция оператора
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция оператора
 
 	if (node_vector_is_correct(stmts))
 	{
@@ -635,8 +724,7 @@ node statement_null(node *const context, const range_location loc)
 {
 	node nd = node_create(context, OP_NOP);
 
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция оператора
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -644,12 +732,11 @@ node statement_null(node *const context, const range_location loc)
 
 node statement_if(node *const cond, node *const then_stmt, node *const else_stmt, const range_location loc)
 {
-	node nd = node_insert(cond, OP_IF, 3);
+	node nd = node_insert(cond, OP_IF, 1 + LOCATION_SIZE);
 	node_set_child(&nd, then_stmt);
 
 	node_set_arg(&nd, 0, 0);						// Флаг наличия else-части
-	node_set_arg(&nd, 1, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 2, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 1, loc);					// Позиция оператора
 
 	if (node_is_correct(else_stmt))
 	{
@@ -688,11 +775,10 @@ node statement_if_get_else_substmt(const node *const nd)
 
 node statement_switch(node *const cond, node *const body, const range_location loc)
 {
-	node nd = node_insert(cond, OP_SWITCH, 2);
+	node nd = node_insert(cond, OP_SWITCH, LOCATION_SIZE);
 	node_set_child(&nd, body);
 
-	node_set_arg(&nd, 0, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 1, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 0, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -712,11 +798,10 @@ node statement_switch_get_body(const node *const nd)
 
 node statement_while(node *const cond, node *const body, const range_location loc)
 {
-	node nd = node_insert(cond, OP_WHILE, 2);
+	node nd = node_insert(cond, OP_WHILE, LOCATION_SIZE);
 	node_set_child(&nd, body);
 
-	node_set_arg(&nd, 0, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 1, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 0, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -736,11 +821,10 @@ node statement_while_get_body(const node *const nd)
 
 node statement_do(node *const body, node *const cond, const range_location loc)
 {
-	node nd = node_insert(body, OP_DO, 2);
+	node nd = node_insert(body, OP_DO, LOCATION_SIZE);
 	node_set_child(&nd, cond);
 
-	node_set_arg(&nd, 0, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 1, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 0, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -760,7 +844,7 @@ node statement_do_get_body(const node *const nd)
 
 node statement_for(node *const init, node *const cond, node *const incr, node *const body, const range_location loc)
 {
-	node nd = node_insert(body, OP_FOR, 5);
+	node nd = node_insert(body, OP_FOR, 3 + LOCATION_SIZE);
 
 	node_set_arg(&nd, 0, 0);
 	node_set_arg(&nd, 1, 0);
@@ -784,8 +868,7 @@ node statement_for(node *const init, node *const cond, node *const incr, node *c
 		node_set_child(&nd, incr);
 	}
 
-	node_set_arg(&nd, 3, (item_t)loc.begin);		// Начальная позиция оператора
-	node_set_arg(&nd, 4, (item_t)loc.end);			// Конечная позиция оператора
+	node_set_location(&nd, 3, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -839,8 +922,7 @@ node statement_continue(node *const context, const range_location loc)
 {
 	node nd = node_create(context, OP_CONTINUE);
 
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция оператора
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -850,8 +932,7 @@ node statement_break(node *const context, const range_location loc)
 {
 	node nd = node_create(context, OP_BREAK);
 
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция оператора
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция оператора
 
 	return nd;
 }
@@ -862,8 +943,7 @@ node statement_return(node *const context, node *const expr, const range_locatio
 	node nd = node_create(context, OP_RETURN);
 
 	node_add_arg(&nd, 0);							// Содержит ли выражение
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция оператора
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция оператора
 
 	if (node_is_correct(expr))
 	{
@@ -891,8 +971,7 @@ node statement_declaration(node *const context)
 {
 	node nd = node_create(context, OP_DECLSTMT);
 
-	node_add_arg(&nd, ITEM_MAX);					// Начальная позиция оператора
-	node_add_arg(&nd, ITEM_MAX);					// Конечная позиция оператора
+	node_add_location(&nd, (range_location){ ITEM_MAX, ITEM_MAX });	// Позиция оператора
 
 	return nd;
 }
@@ -906,8 +985,7 @@ void statement_declaration_add_declarator(const node *const nd, node *const decl
 node statement_declaration_set_location(const node *const nd, const range_location loc)
 {
 	assert(node_get_type(nd) == OP_DECLSTMT);
-	node_set_arg(nd, 0, (item_t)loc.begin);
-	node_set_arg(nd, 1, (item_t)loc.end);
+	node_set_location(nd, 0, loc);
 
 	return *nd;
 }
@@ -950,8 +1028,7 @@ node declaration_member(node *const context, const item_t type, const size_t nam
 
 	node_add_arg(&nd, type);						// Тип поля
 	node_add_arg(&nd, (item_t)name);				// Имя поля
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция объявления
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция объявления
+	node_add_location(&nd, loc);					// Позиция объявления
 
 	if (node_vector_is_correct(bounds))
 	{
@@ -997,8 +1074,7 @@ node declaration_struct(node *const context, const size_t name, const range_loca
 
 	node_add_arg(&nd, (item_t)name);				// Имя структуры
 	node_add_arg(&nd, TYPE_UNDEFINED);				// Тип структуры
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция объявления
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция объявления
+	node_add_location(&nd, loc);					// Позиция объявления
 
 	return nd;
 }
@@ -1018,8 +1094,7 @@ void declaration_struct_set_type(node *const nd, const item_t type)
 node declaration_struct_set_location(node *const nd, const range_location loc)
 {
 	assert(node_get_type(nd) == OP_DECL_STRUCT);
-	node_set_arg(nd, 2, (item_t)loc.begin);
-	node_set_arg(nd, 3, (item_t)loc.end);
+	node_set_location(nd, 2, loc);
 
 	return *nd;
 }
@@ -1056,8 +1131,7 @@ node declaration_variable(node *const context, const size_t id, node_vector *con
 
 	node_add_arg(&nd, (item_t)id);					// Идентификатор переменной
 	node_add_arg(&nd, initializer ? 1 : 0);			// Имеет ли инициализатор
-	node_add_arg(&nd, (item_t)loc.begin);			// Начальная позиция объявления
-	node_add_arg(&nd, (item_t)loc.end);				// Конечная позиция оператора
+	node_add_location(&nd, loc);					// Позиция объявления
 
 	if (node_vector_is_correct(bounds))
 	{
@@ -23,6 +23,14 @@
 #include "tree.h"
 
 
+#if ITEM > 32 || ITEM < -32
+	/** Location is packed into one argument as 32-bit begin and length */
+	#define LOCATION_SIZE 1
+#else
+	#define LOCATION_SIZE 2
+#endif
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -101,6 +109,15 @@ inline node node_broken(void)
  */
 range_location node_get_location(const node *const nd);
 
+/**
+ *	Set node location, it occupies @c LOCATION_SIZE arguments
+ *
+ *	@param	nd				Node
+ *	@param	index			Index of first location argument
+ *	@param	loc				Node location
+ */
+void node_set_location(const node *const nd, const size_t index, const range_location loc);
+
 
 /**
  *	Get expression class
@@ -224,7 +241,7 @@ char32_t expression_literal_get_character(const node *const nd);
  *
  *	@return	Integer literal expression
  */
-node expression_integer_literal(node *const context, const item_t type, const item_t value, const range_location loc);
+node expression_integer_literal(node *const context, const item_t type, const int64_t value, const range_location loc);
 
 /**
  *	Get value of integer literal expression
@@ -233,7 +250,7 @@ node expression_integer_literal(node *const context, const item_t type, const it
  *
  *	@return	Integer value
  */
-item_t expression_literal_get_integer(const node *const nd);
+int64_t expression_literal_get_integer(const node *const nd);
 
 
 /**
@@ -279,6 +296,14 @@ node expression_string_literal(node *const context, const item_t type, const siz
  */
 size_t expression_literal_get_string(const node *const nd);
 
+/**
+ *	Set string index of literal expression
+ *
+ *	@param	nd				Literal expression
+ *	@param	index			String index
+ */
+void expression_literal_set_string(const node *const nd, const size_t index);
+
 
 /**
  *	Create new subscript expression
@@ -590,6 +615,19 @@ node expression_assignment_get_RHS(const node *const nd);
  */
 node expression_initializer(node_vector *const exprs, const range_location loc);
 
+/**
+ *	Create new packed initializer, which stores values of literals instead of their nodes
+ *
+ *	@param	context			Context node
+ *	@param	type			Type of literals, integer or floating
+ *	@param	values			Values of literals
+ *	@param	loc				Expression location
+ *
+ *	@return	Packed initializer
+ */
+node expression_packed_initializer(node *const context, const item_t type, const vector *const values
+	, const range_location loc);
+
 /**
  *	Set type of initializer
  *
@@ -617,6 +655,44 @@ size_t expression_initializer_get_size(const node *const nd);
  */
 node expression_initializer_get_subexpr(const node *const nd, const size_t index);
 
+/**
+ *	Check if initializer is packed
+ *
+ *	@param	nd				Initializer
+ *
+ *	@return	@c true on packed initializer, @c false on initializer with subexpressions
+ */
+bool expression_initializer_is_packed(const node *const nd);
+
+/**
+ *	Get type of literals of packed initializer
+ *
+ *	@param	nd				Packed initializer
+ *
+ *	@return	Type of literals
+ */
+item_t expression_initializer_get_literal_type(const node *const nd);
+
+/**
+ *	Get integer value of packed initializer by index
+ *
+ *	@param	nd				Packed initializer
+ *	@param	index			Value index
+ *
+ *	@return	Integer value
+ */
+int64_t expression_initializer_get_integer(const node *const nd, const size_t index);
+
+/**
+ *	Get floating value of packed initializer by index
+ *
+ *	@param	nd				Packed initializer
+ *	@param	index			Value index
+ *
+ *	@return	Floating value
+ */
+double expression_initializer_get_floating(const node *const nd, const size_t index);
+
 
 /**
  *	Create new empty bound expression
@@ -15,12 +15,18 @@
  */
 
 #include "builder.h"
+#include <stdlib.h>
+#include <string.h>
 #include "AST.h"
+#include "visitor.h"
 
 
 #define MAX_PRINTF_ARGS 20
 
 
+static const size_t MIN_PACKED_INITIALIZER = 8;
+
+
 /**
  *	Emit a semantic error
  *
@@ -96,7 +102,7 @@ static node fold_unary_expression(builder *const bldr, const item_t type, const
 		case TYPE_ENUM:
 		case TYPE_INTEGER:
 		{
-			const item_t value = expression_literal_get_integer(expr);
+			const int64_t value = expression_literal_get_integer(expr);
 			node_remove(expr);
 
 			switch (op)
@@ -149,8 +155,8 @@ static node fold_binary_expression(builder *const bldr, const item_t type
 		case TYPE_INTEGER:
 		case TYPE_BOOLEAN:
 		{
-			const item_t left_value = expression_literal_get_integer(LHS);
-			const item_t right_value = expression_literal_get_integer(RHS);
+			const int64_t left_value = expression_literal_get_integer(LHS);
+			const int64_t right_value = expression_literal_get_integer(RHS);
 			node_remove(LHS);
 			node_remove(RHS);
 
@@ -237,7 +243,170 @@ static node fold_binary_expression(builder *const bldr, const item_t type
 	}
 }
 
+/**
+ *	Get string of literal argument, which contains only ASCII characters
+ *
+ *	@param	bldr		AST builder
+ *	@param	argument	Argument of call
+ *
+ *	@return	String, @c NULL if argument is not such literal
+ */
+static const char *get_ascii_literal(builder *const bldr, const node *const argument)
+{
+	if (expression_get_class(argument) != EXPR_LITERAL || !type_is_array(bldr->sx, expression_get_type(argument)))
+	{
+		return NULL;
+	}
+
+	// Символы вне ASCII занимают разное число элементов строки в разных кодогенераторах
+	const char *const string = string_get(bldr->sx, expression_literal_get_string(argument));
+	for (const char *ch = string; *ch != '\0'; ch++)
+	{
+		if ((unsigned char)*ch >= 0x80)
+		{
+			return NULL;
+		}
+	}
+
+	return string;
+}
+
+/**
+ *	Fold call of string function with literal arguments
+ *
+ *	@param	bldr		AST builder
+ *	@param	callee		Called function
+ *	@param	args		Arguments
+ *	@param	loc			Call location
+ *
+ *	@return	Integer literal, broken node if call cannot be folded
+ */
+static node fold_string_call_expression(builder *const bldr, node *const callee, node_vector *const args
+	, const range_location loc)
+{
+	const size_t func = expression_identifier_get_id(callee);
+	if (func != BI_STRLEN && func != BI_STRCMP && func != BI_STRNCMP)
+	{
+		return node_broken();
+	}
+
+	const node fst = node_vector_get(args, 0);
+	const char *const fst_string = get_ascii_literal(bldr, &fst);
+	if (fst_string == NULL)
+	{
+		return node_broken();
+	}
+
+	int64_t value = (int64_t)strlen(fst_string);
+	if (func != BI_STRLEN)
+	{
+		const node snd = node_vector_get(args, 1);
+		const char *const snd_string = get_ascii_literal(bldr, &snd);
+		if (snd_string == NULL)
+		{
+			return node_broken();
+		}
+
+		size_t limit = SIZE_MAX;
+		if (func == BI_STRNCMP)
+		{
+			const node amount = node_vector_get(args, 2);
+			if (expression_get_class(&amount) != EXPR_LITERAL || expression_literal_get_integer(&amount) < 0)
+			{
+				return node_broken();
+			}
+			limit = (size_t)expression_literal_get_integer(&amount);
+		}
+
+		// Результат сравнения - разность первых несовпавших символов
+		size_t i = 0;
+		while (i < limit && fst_string[i] != '\0' && fst_string[i] == snd_string[i])
+		{
+			i++;
+		}
+		value = i == limit ? 0 : (int64_t)fst_string[i] - (int64_t)snd_string[i];
+	}
+
+	for (size_t i = 0; i < node_vector_size(args); i++)
+	{
+		node argument = node_vector_get(args, i);
+		node_remove(&argument);
+	}
+	node_remove(callee);
+
+	return build_integer_literal_expression(bldr, value, loc);
+}
+
 
+/**
+ *	Get value of condition, if it is a constant
+ *
+ *	@param	bldr		AST builder
+ *	@param	cond		Condition
+ *	@param	value		Value of condition to return
+ *
+ *	@return	@c 1 on constant condition, @c 0 otherwise
+ */
+static bool get_constant_condition(builder *const bldr, const node *const cond, bool *const value)
+{
+	if (expression_get_class(cond) != EXPR_LITERAL)
+	{
+		return false;
+	}
+
+	switch (type_get_class(bldr->sx, expression_get_type(cond)))
+	{
+		case TYPE_ENUM:
+		case TYPE_INTEGER:
+		case TYPE_BOOLEAN:
+			*value = expression_literal_get_integer(cond) != 0;
+			return true;
+
+		case TYPE_FLOATING:
+			*value = expression_literal_get_floating(cond) != 0;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static int stop_on_label(void *const context, const node *const nd)
+{
+	(void)context;
+	(void)nd;
+	return -1;
+}
+
+/**
+ *	Check that statement can be removed as unreachable,
+ *	i.e. there are no case or default labels to jump into it
+ *
+ *	@param	nd			Statement
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static bool is_removable_statement(const node *const nd)
+{
+	visitor vis = visitor_create(NULL);
+	visitor_set(&vis, OP_CASE, &stop_on_label, NULL);
+	visitor_set(&vis, OP_DEFAULT, &stop_on_label, NULL);
+
+	const bool ret = visitor_walk(&vis, nd) == 0;
+	visitor_clear(&vis);
+	return ret;
+}
+
+/**
+ *	Check format string and collect types of its placeholders
+ *
+ *	@param	bldr			AST builder
+ *	@param	format_str		Format string literal
+ *	@param	format_types	Types of placeholders
+ *	@param	placeholders	Placeholder specifiers
+ *
+ *	@return	Number of placeholders, @c SIZE_MAX on wrong format string
+ */
 static size_t evaluate_args(builder *const bldr, const node *const format_str
 	, item_t *const format_types, char32_t *const placeholders)
 {
@@ -256,7 +425,7 @@ static size_t evaluate_args(builder *const bldr, const node *const format_str
 				if (args == MAX_PRINTF_ARGS)
 				{
 					semantic_error(bldr, node_get_location(format_str), too_many_printf_args, (size_t)MAX_PRINTF_ARGS);
-					return 0;
+					return SIZE_MAX;
 				}
 
 				placeholders[args] = specifier;
@@ -286,11 +455,11 @@ static size_t evaluate_args(builder *const bldr, const node *const format_str
 
 				case '\0':
 					semantic_error(bldr, node_get_location(format_str), expected_format_specifier);
-					return 0;
+					return SIZE_MAX;
 
 				default:
 					semantic_error(bldr, node_get_location(format_str), unknown_format_specifier, specifier);
-					return 0;
+					return SIZE_MAX;
 			}
 		}
 	}
@@ -298,6 +467,85 @@ static size_t evaluate_args(builder *const bldr, const node *const format_str
 	return args;
 }
 
+/**
+ *	Get C specifier for Russian printf specifier
+ *
+ *	@param	specifier	Specifier
+ *
+ *	@return	C specifier, @c '\0' if specifier is not Russian
+ */
+static char printf_latin_specifier(const char32_t specifier)
+{
+	switch (specifier)
+	{
+		case U'ц':
+			return 'i';
+		case U'л':
+			return 'c';
+		case U'в':
+			return 'f';
+		case U'с':
+			return 's';
+		default:
+			return '\0';
+	}
+}
+
+/**
+ *	Replace Russian specifiers of checked format string by C ones,
+ *	so runtime printf gets ready format without translation
+ *
+ *	@param	bldr		AST builder
+ *	@param	format_str	Format string literal
+ */
+static void translate_format(builder *const bldr, const node *const format_str)
+{
+	const char *const string = string_get(bldr->sx, expression_literal_get_string(format_str));
+	char *const format = malloc(strlen(string) + 1);
+	if (format == NULL)
+	{
+		return;
+	}
+
+	bool is_translated = false;
+	size_t size = 0;
+	for (size_t i = 0; string[i] != '\0';)
+	{
+		const bool is_placeholder = string[i] == '%';
+		if (is_placeholder)
+		{
+			format[size++] = string[i++];
+			if (string[i] == '\0')
+			{
+				break;
+			}
+		}
+
+		const size_t symbol_size = utf8_symbol_size(string[i]);
+		const char specifier = is_placeholder ? printf_latin_specifier(utf8_convert(&string[i])) : '\0';
+		if (specifier != '\0')
+		{
+			format[size++] = specifier;
+			is_translated = true;
+		}
+		else
+		{
+			memcpy(&format[size], &string[i], symbol_size);
+			size += symbol_size;
+		}
+
+		i += symbol_size;
+	}
+
+	format[size] = '\0';
+	if (is_translated)
+	{
+		expression_literal_set_string(format_str, strings_intern(&bldr->sx->string_literals, format));
+	}
+
+	free(format);
+}
+
 static node build_printf_expression(builder *const bldr, node *const callee, node_vector *const args, const range_location r_loc)
 {
 	const size_t argc = node_vector_size(args);
@@ -323,6 +571,10 @@ static node build_printf_expression(builder *const bldr, node *const callee, nod
 	char32_t placeholders[MAX_PRINTF_ARGS];
 	item_t format_types[MAX_PRINTF_ARGS];
 	const size_t expected_args = evaluate_args(bldr, &fst, format_types, placeholders);
+	if (expected_args == SIZE_MAX)
+	{
+		return node_broken();
+	}
 
 	if (expected_args != argc - 1)
 	{
@@ -342,6 +594,8 @@ static node build_printf_expression(builder *const bldr, node *const callee, nod
 		node_vector_set(args, i, &argument);
 	}
 
+	translate_format(bldr, &fst);
+
 	const range_location loc = { node_get_location(callee).begin, r_loc.end };
 	return expression_call(TYPE_INTEGER, callee, args, loc);
 }
@@ -433,6 +687,7 @@ builder builder_create(syntax *const sx)
 	node root = node_get_root(&bldr.sx->tree);
 	node_copy(&bldr.context, &root);
 
+	bldr.references = NULL;
 	return bldr;
 }
 
@@ -474,6 +729,19 @@ bool check_assignment_operands(builder *const bldr, const item_t expected_type,
 		else if (type_is_array(sx, expected_type))
 		{
 			const item_t type = type_array_get_element_type(sx, expected_type);
+			if (expression_initializer_is_packed(init))
+			{
+				// Упакованные литералы уже приведены к типу элементов
+				if (expression_initializer_get_literal_type(init) != type)
+				{
+					semantic_error(bldr, loc, wrong_init);
+					return false;
+				}
+
+				expression_initializer_set_type(init, expected_type);
+				return true;
+			}
+
 			for (size_t i = 0; i < actual_inits; i++)
 			{
 				node subexpr = expression_initializer_get_subexpr(init, i);
@@ -539,6 +807,8 @@ node build_identifier_expression(builder *const bldr, const size_t name, const r
 		return node_broken();
 	}
 
+	ident_add_occurrence(bldr->sx, (size_t)identifier, false, loc.begin, loc.end);
+
 	const item_t type = ident_get_type(bldr->sx, (size_t)identifier);
 	if (type_is_enum_field(bldr->sx, type))
 	{
@@ -547,6 +817,11 @@ node build_identifier_expression(builder *const bldr, const size_t name, const r
 		return expression_integer_literal(&bldr->context, enum_type, value, loc);
 	}
 
+	if (bldr->references != NULL && type_is_function(bldr->sx, type))
+	{
+		vector_add(bldr->references, identifier);
+	}
+
 	return expression_identifier(&bldr->context, type, (size_t)identifier, loc);
 }
 
@@ -565,7 +840,7 @@ node build_character_literal_expression(builder *const bldr, const char32_t valu
 	return expression_character_literal(&bldr->context, TYPE_CHARACTER, value, loc);
 }
 
-node build_integer_literal_expression(builder *const bldr, const item_t value, const range_location loc)
+node build_integer_literal_expression(builder *const bldr, const int64_t value, const range_location loc)
 {
 	return expression_integer_literal(&bldr->context, TYPE_INTEGER, value, loc);
 }
@@ -663,6 +938,15 @@ node build_call_expression(builder *const bldr, node *const callee
 
 	const item_t return_type = type_function_get_return_type(bldr->sx, callee_type);
 	const range_location loc = { node_get_location(callee).begin, r_loc.end };
+	if (expression_get_class(callee) == EXPR_IDENTIFIER)
+	{
+		const node folded = fold_string_call_expression(bldr, callee, args, loc);
+		if (node_is_correct(&folded))
+		{
+			return folded;
+		}
+	}
+
 	return expression_call(return_type, callee, args, loc);
 }
 
@@ -732,14 +1016,13 @@ node build_cast_expression(const item_t target_type, node *const expr)
 		if (expression_get_class(expr) == EXPR_LITERAL)
 		{
 			// Пока тут только int -> float
-			const item_t value = expression_literal_get_integer(expr);
-			const node result = node_insert(expr, OP_LITERAL, DOUBLE_SIZE + 4);
+			const int64_t value = expression_literal_get_integer(expr);
+			const node result = node_insert(expr, OP_LITERAL, DOUBLE_SIZE + 2 + LOCATION_SIZE);
 
 			node_set_arg(&result, 0, TYPE_FLOATING);
 			node_set_arg(&result, 1, RVALUE);
 			node_set_arg_double(&result, 2, (double)value);
-			node_set_arg(&result, DOUBLE_SIZE + 2, (item_t)loc.begin);
-			node_set_arg(&result, DOUBLE_SIZE + 3, (item_t)loc.end);
+			node_set_location(&result, DOUBLE_SIZE + 2, loc);
 
 			node_remove(expr);
 			return result;
@@ -911,6 +1194,18 @@ node build_binary_expression(builder *const bldr, node *const LHS, node *const R
 		case BIN_ADD:
 		case BIN_SUB:
 		{
+			if (type_is_vector(bldr->sx, left_type) || type_is_vector(bldr->sx, right_type))
+			{
+				// Векторы вычисляются покомпонентно и только с векторами того же типа
+				if (left_type != right_type)
+				{
+					semantic_error(bldr, op_loc, typecheck_binary_expr);
+					return node_broken();
+				}
+
+				return expression_binary(left_type, LHS, RHS, op_kind, loc);
+			}
+
 			if (!type_is_arithmetic(bldr->sx, left_type) || !type_is_arithmetic(bldr->sx, right_type))
 			{
 				semantic_error(bldr, op_loc, typecheck_binary_expr);
@@ -1076,10 +1371,58 @@ node build_initializer(builder *const bldr, node_vector *const exprs, const rang
 		return node_broken();
 	}
 
+	bldr->sx->initializer_amount += actual_inits;
 	const range_location loc = { l_loc.begin, r_loc.end };
 	return expression_initializer(exprs, loc);
 }
 
+node build_packed_initializer(builder *const bldr, node_vector *const exprs, const item_t type, const size_t size
+	, const range_location l_loc, const range_location r_loc)
+{
+	const size_t actual_inits = node_vector_size(exprs);
+	if (actual_inits < MIN_PACKED_INITIALIZER || (type != TYPE_INTEGER && type != TYPE_FLOATING))
+	{
+		return node_broken();
+	}
+
+	// Литералы построены последними детьми контекста, поэтому их можно отрезать вместе с хвостом дерева
+	for (size_t i = 0; i < actual_inits; i++)
+	{
+		const node expr = node_vector_get(exprs, i);
+		const item_t expr_type = expression_get_type(&expr);
+		if (expression_get_class(&expr) != EXPR_LITERAL || expr.index < size
+			|| node_get_parent(&expr).index != bldr->context.index
+			|| (expr_type != type && expr_type != TYPE_INTEGER))
+		{
+			return node_broken();
+		}
+	}
+
+	vector values = vector_create(actual_inits * INT64_SIZE);
+	for (size_t i = 0; i < actual_inits; i++)
+	{
+		const node expr = node_vector_get(exprs, i);
+		if (type == TYPE_INTEGER)
+		{
+			vector_add_int64(&values, expression_literal_get_integer(&expr));
+		}
+		else
+		{
+			vector_add_double(&values, expression_get_type(&expr) == TYPE_FLOATING
+				? expression_literal_get_floating(&expr)
+				: (double)expression_literal_get_integer(&expr));
+		}
+	}
+
+	node_truncate(&bldr->context, node_get_amount(&bldr->context) - actual_inits, size);
+
+	bldr->sx->initializer_amount += actual_inits;
+	const range_location loc = { l_loc.begin, r_loc.end };
+	const node result = expression_packed_initializer(&bldr->context, type, &values, loc);
+	vector_clear(&values);
+	return result;
+}
+
 node build_constant_expression(builder *const bldr, node *const expr)
 {
 	if (expression_get_class(expr) != EXPR_LITERAL)
@@ -1218,6 +1561,7 @@ node build_declarator(builder *const bldr, const item_t type, const size_t name
 		semantic_error(bldr, ident_loc, repeated_decl, repr_get_name(bldr->sx, name));
 	}
 
+	ident_add_occurrence(bldr->sx, id, true, ident_loc.begin, ident_loc.end);
 
 	return declaration_variable(&bldr->context, id, bounds, initializer, ident_loc);
 }
@@ -1318,6 +1662,24 @@ node build_if_statement(builder *const bldr, node *const cond
 	}
 
 	const range_location loc = { if_loc.begin, node_get_location(else_stmt ? else_stmt : then_stmt).end };
+
+	bool value;
+	if (bldr->sx->is_optimized && get_constant_condition(bldr, cond, &value))
+	{
+		node *const taken = value ? then_stmt : else_stmt;
+		node *const skipped = value ? else_stmt : then_stmt;
+		if (skipped == NULL || is_removable_statement(skipped))
+		{
+			if (skipped != NULL)
+			{
+				node_remove(skipped);
+			}
+
+			node_remove(cond);
+			return taken != NULL ? *taken : build_null_statement(bldr, loc);
+		}
+	}
+
 	return statement_if(cond, then_stmt, else_stmt, loc);
 }
 
@@ -1352,6 +1714,15 @@ node build_while_statement(builder *const bldr, node *const cond, node *const bo
 	}
 
 	const range_location loc = { while_loc.begin, node_get_location(body).end };
+
+	bool value;
+	if (bldr->sx->is_optimized && get_constant_condition(bldr, cond, &value) && !value && is_removable_statement(body))
+	{
+		node_remove(body);
+		node_remove(cond);
+		return build_null_statement(bldr, loc);
+	}
+
 	return statement_while(cond, body, loc);
 }
 
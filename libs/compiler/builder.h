@@ -36,6 +36,8 @@ typedef struct builder
 	node context;			/**< Context for creating new nodes */
 
 	item_t func_type;		/**< Type of current parsed function */
+
+	vector *references;		/**< Identifiers of referenced functions, @c NULL if not collected */
 } builder;
 
 
@@ -112,7 +114,7 @@ node build_character_literal_expression(builder *const bldr, const char32_t valu
  *
  *	@return	Integer literal expression node
  */
-node build_integer_literal_expression(builder *const bldr, const item_t value, const range_location loc);
+node build_integer_literal_expression(builder *const bldr, const int64_t value, const range_location loc);
 
 /**
  *	Build a floating literal expression
@@ -241,6 +243,22 @@ node build_ternary_expression(builder *const bldr, node *const cond, node *const
  */
 node build_initializer(builder *const bldr, node_vector *const exprs, const range_location l_loc, const range_location r_loc);
 
+/**
+ *	Build a packed initializer from integer or floating literals,
+ *	nodes of literals are released
+ *
+ *	@param	bldr			AST builder
+ *	@param	exprs			Vector of expressions
+ *	@param	type			Type of array elements
+ *	@param	size			Size of tree before the first expression
+ *	@param	l_loc			Left brace location
+ *	@param	r_loc			Right brace location
+ *
+ *	@return	Packed initializer, broken node if expressions are not literals of element type
+ */
+node build_packed_initializer(builder *const bldr, node_vector *const exprs, const item_t type, const size_t size
+	, const range_location l_loc, const range_location r_loc);
+
 /**
  *	Build a constant expression
  *
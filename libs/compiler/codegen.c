@@ -15,28 +15,47 @@
  */
 
 #include "codegen.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include "AST.h"
+#include "commenter.h"
+#include "counters.h"
 #include "errors.h"
+#include "hash.h"
+#include "inliner.h"
 #include "instructions.h"
 #include "item.h"
+#include "logger.h"
+#include "lz.h"
+#include "map.h"
+#include "numbering.h"
 #include "string.h"
 #include "tree.h"
 #include "uniprinter.h"
 #include "utf8.h"
+#include "visitor.h"
 #include "writer.h"
-#include "debug.h"
 
 
-size_t curline=0, line=0;
-int ii=0, pconnect=-1;
-typedef struct dline
-{
-	size_t line;
-	size_t pc;
-}dline;
-dline connect[100];
-
 #define DISPL_START 3
+#define MAX_PROFILE_KEY 1024
+#define MAX_COST_REPORT_SIZE 2048
+#define MAX_MIX_REPORTED 8
+
+static const char *const SHEBANG = "#!/usr/bin/ruc-vm\n";
+static const char *const BINARY_MAGIC = "#RUCB\n";
+static const uint32_t BINARY_VERSION = 9;
+static const item_t EXTENDED_VM_VERSION = 2;
+static const uint64_t BINARY_EAGER = 1;
+static const uint64_t BINARY_DENSE = 2;
+static const uint64_t BINARY_COMPACT = 4;
+static const uint64_t BINARY_COMPRESSED = 8;
+static const uint64_t BINARY_PACKED = 16;
+static const uint64_t BINARY_ALIGNED = 32;
+static const uint64_t BINARY_EXTENDED = 64;
+static const size_t BINARY_ALIGNMENT = 8;
+static const size_t BINARY_SECTION_SIZE = 4096;
 
 #ifndef abs
 	#define abs(a) ((a) > 0 ? (a) : -(a))
@@ -48,8 +67,12 @@ dline connect[100];
 #endif
 
 
-static const char *const DEFAULT_CODES = "codes.txt";
-static const size_t MAX_MEM_SIZE = 100000;
+static const char *const DEFAULT_PROFILE = "profile.txt";
+static const char *const TAG_COST_REPORT = "cost-report";
+static const char *const DEFAULT_EXECUTION_PROFILE = "execution_profile.txt";
+static const size_t NODES_PER_JUMP = 16;
+static const size_t MIN_DISPATCH_CASES = 8;
+static const size_t MAX_LINEAR_CASES = 3;
 
 /** Kinds of lvalue */
 typedef enum OPERAND
@@ -58,6 +81,15 @@ typedef enum OPERAND
 	ADDRESS,		/**< Address operand */
 } operand_t;
 
+/** States of shared address value */
+typedef enum ADDRESS_STATE
+{
+	ADDRESS_PENDING,	/**< Address is not computed yet */
+	ADDRESS_COMPUTING,	/**< Address is being computed */
+	ADDRESS_SAVED,		/**< Address is saved to temporary */
+	ADDRESS_UNSHARED,	/**< Expression is a variable, there is no address to share */
+} address_state_t;
+
 
 /** Allocated value designator */
 typedef struct lvalue
@@ -67,6 +99,20 @@ typedef struct lvalue
 	const item_t displ;				/**< Value displacement */
 } lvalue;
 
+/** Case label of switch statement */
+typedef struct case_label
+{
+	item_t value;					/**< Case value */
+	size_t address;					/**< Address of case body */
+} case_label;
+
+/** Case labels of switch statement, which can be reached by dispatch */
+typedef struct case_labels
+{
+	size_t amount;					/**< Number of cases before default */
+	bool is_constant;				/**< Set, if all these cases are literals */
+} case_labels;
+
 /** RuC-VM Intermediate Representation encoder */
 typedef struct encoder
 {
@@ -77,12 +123,35 @@ typedef struct encoder
 
 	vector identifiers;				/**< Local identifiers table */
 	vector representations;			/**< Local representations table */
-	vector displacements;			/**< Displacements table */
+	hash names;						/**< Offsets of names in local representations table */
+	hash globals;					/**< Displacements of global variables and numbers of functions */
+	hash locals;					/**< Displacements of local variables of current function */
 	vector functions;				/**< Functions table */
+	vector owners;					/**< Identifiers of functions by their numbers, @c 0 for reserved numbers */
+	vector entries;					/**< Triples of address, size and name of functions for lazy loading */
+	vector blocks;					/**< Pairs of begin and end of data embedded in codes */
+	vector texts;					/**< Beginnings of string literals among data embedded in codes */
+	vector jumps;					/**< Addresses of jump operands */
+	vector lines;					/**< Debug lines table of line and address pairs */
+	const comment_index *index;		/**< Index of line ends in code for debug lines */
 
 	size_t addr_cond;				/**< Condition address */
 	size_t addr_case;				/**< Case operator address */
 	size_t addr_break;				/**< Break operator address */
+	size_t addr_default;			/**< Default operator address */
+
+	vector cases;					/**< Pairs of case values and addresses of current switches */
+	vector data;					/**< Constant initializers of global variables */
+	inliner inl;					/**< Selector of functions expanded inline */
+	hash temporaries;				/**< Displacements of temporaries, which replace expressions in loops */
+	numbering numbers;				/**< Value numbers of address computations in current statement */
+	vector addresses;				/**< Pairs of temporary displacement and state of shared address values */
+	map profile;					/**< Execution counters of functions and blocks by their names */
+	vector cold;					/**< Cold statements with addresses of jumps to them and back and displacements */
+	vector effects;					/**< Pairs of address and stack effect of instructions with variable effect */
+	vector depths;					/**< Maximal operand stack depths of functions, @c -1 if unknown */
+	hash bodies;					/**< Numbers of functions by hashes of their codes */
+	vector slots;					/**< Pairs of displacement and size of frame slots freed by dead variables */
 
 	item_t displ;					/**< Current stack displacement */
 
@@ -90,9 +159,83 @@ typedef struct encoder
 	item_t max_global_displ;		/**< Maximal global displacement */
 
 	const node *curr_func;			/**< Currently emitted function */
+	size_t forward_call;			/**< Address of the last call operand, which refers to function not emitted yet */
+	bool has_escapes;				/**< Set, if frame of current function can be reached from other frames */
+	bool has_addresses;				/**< Set, if addresses of variables are taken in current function */
 	const item_status target;		/**< Target tables item type */
+	const bool is_binary;			/**< Set, if tables are exported in binary format */
+	const bool is_eager;			/**< Set, if virtual machine loads all functions at start */
+	const bool is_dense;			/**< Set, if instructions are exported with dense codes */
+	const bool is_compact;			/**< Set, if codes are exported in compact variable-length form */
+	const bool is_packed;			/**< Set, if string literals in compact codes are packed as octets */
+	const bool is_aligned;			/**< Set, if floating variables get slots aligned to size of double */
+	const bool is_compressed;		/**< Set, if sections of binary format are compressed */
+	const bool is_extended;			/**< Set, if codes are emitted for extended virtual machine */
+	const bool is_debug;			/**< Set, if debug lines are emitted */
+	const bool is_folding;			/**< Set, if functions with equal codes share one copy */
+	const bool is_sharing;			/**< Set, if variables reuse frame slots of dead variables */
+	const bool is_inlining;			/**< Set, if calls of small functions are expanded inline */
+	const bool is_hoisting;			/**< Set, if loop invariants are hoisted and induction products reduced */
+	const bool is_numbering;		/**< Set, if equal address computations of statement are emitted once */
+	const bool is_pruning;			/**< Set, if declarations unreachable from main are not emitted */
+	bool is_profiled;				/**< Set, if execution profile is used for code layout */
 } encoder;
 
+/** Sections of binary format after header */
+typedef enum SECTION
+{
+	SECTION_LINES,					/**< Debug lines */
+	SECTION_INDEX,					/**< Index of functions and bounds of data embedded in codes */
+	SECTION_CODES,					/**< Codes of virtual machine */
+	SECTION_TABLE,					/**< Other table */
+} section_t;
+
+/** Reachability of external declarations from main */
+typedef struct reachability
+{
+	const syntax *const sx;			/**< Syntax structure */
+	vector owners;					/**< Number of external declaration plus one for each identifier */
+	vector is_reachable;			/**< Flags of external declarations */
+	vector stack;					/**< Numbers of external declarations to traverse */
+	bool has_side_effects;			/**< Set, if traversed declaration has side effects */
+} reachability;
+
+/** Analysis of loop for invariant code motion and strength reduction */
+typedef struct loop_analysis
+{
+	encoder *const enc;				/**< Encoder */
+	hash writes;					/**< Number of writes of each identifier in loop */
+	hash invariants;				/**< Indices of loop invariant expressions */
+	vector hoisted;					/**< Indices of invariant expressions computed before loop */
+	vector products;				/**< Indices of products of induction variable and literal */
+	vector factors;					/**< Pairs of literal and displacement of reduced product */
+	bool has_side_writes;			/**< Set, if loop has calls or writes by addresses */
+	size_t induction;				/**< Induction variable, @c SIZE_MAX if none */
+	item_t step;					/**< Step of induction variable */
+} loop_analysis;
+
+/** Properties of function body for call optimizations */
+typedef struct function_properties
+{
+	const encoder *const enc;		/**< Encoder */
+	bool is_leaf;					/**< Set, if function calls no user functions */
+	bool has_escapes;				/**< Set, if locals can be reached by address or live out of frame */
+	bool has_addresses;				/**< Set, if addresses of variables are taken */
+} function_properties;
+
+/** Last uses of variables declared in compound statement */
+typedef struct liveness
+{
+	const encoder *const enc;		/**< Encoder */
+	hash numbers;					/**< Numbers of variables by their identifiers */
+	vector identifiers;				/**< Identifiers of variables by their numbers */
+	vector lasts;					/**< Indices of statements with the last uses of variables */
+	vector deaths;					/**< Number plus one of the first variable dead after each statement */
+	vector next;					/**< Number plus one of the next variable dead after the same statement */
+	size_t index;					/**< Index of current statement */
+	bool has_addresses;				/**< Set, if addresses are taken in statements */
+} liveness;
+
 
 static void emit_void_expression(encoder *const enc, const node *const nd);
 static lvalue emit_lvalue(encoder *const enc, const node *const nd);
@@ -130,21 +273,17 @@ static inline void mem_add_double(encoder *const enc, const double value)
 {
 	item_t buffer[8];
 	const size_t size = item_store_double_for_target(enc->target, value, buffer);
-
-	for (size_t i = 0; i < size; i++)
-	{
-		mem_add(enc, buffer[i]);
-	}
+	vector_append(&enc->memory, buffer, size);
 }
 
-static inline int mem_set(encoder *const enc, const size_t index, const item_t value)
+static inline void mem_set(encoder *const enc, const size_t index, const item_t value)
 {
-	return vector_set(&enc->memory, index, value);
+	vector_put(&enc->memory, index, value);
 }
 
 static inline item_t mem_get(const encoder *const enc, const size_t index)
 {
-	return vector_get(&enc->memory, index);
+	return vector_at(&enc->memory, index);
 }
 
 static inline size_t mem_reserve(encoder *const enc)
@@ -152,6 +291,65 @@ static inline size_t mem_reserve(encoder *const enc)
 	return vector_add(&enc->memory, 0);
 }
 
+/**
+ *	Add instruction with variable displacement to memory table
+ *
+ *	@param	enc			Encoder
+ *	@param	instruction	Instruction of local variable
+ *	@param	displ		Variable displacement, negative for global variables
+ *
+ *	@return	Index of instruction
+ */
+static inline size_t mem_add_variable(encoder *const enc, const instruction_t instruction, const item_t displ)
+{
+	// Расширенная машина получает область памяти при компиляции, а не по знаку смещения во время исполнения
+	const bool is_global = enc->is_extended && displ < 0;
+	const size_t index = mem_add(enc, is_global ? instruction_to_global_ver(instruction) : instruction);
+	mem_add(enc, displ);
+	return index;
+}
+
+/**
+ *	Mark data embedded in codes, which ends at the end of memory table
+ *
+ *	@param	enc			Encoder
+ *	@param	begin		Address of data
+ */
+static inline void blocks_add(encoder *const enc, const size_t begin)
+{
+	vector_add(&enc->blocks, (item_t)begin);
+	vector_add(&enc->blocks, (item_t)mem_size(enc));
+}
+
+/**
+ *	Mark string literal embedded in codes, which ends at the end of memory table
+ *
+ *	@param	enc			Encoder
+ *	@param	begin		Address of number of characters
+ */
+static inline void blocks_add_text(encoder *const enc, const size_t begin)
+{
+	blocks_add(enc, begin);
+	vector_add(&enc->texts, (item_t)begin);
+}
+
+/**
+ *	Add jump instruction to memory table
+ *
+ *	@param	enc			Encoder
+ *	@param	instruction	Jump instruction
+ *	@param	address		Jump address or reference to the previous unresolved jump
+ *
+ *	@return	Index of jump operand
+ */
+static inline size_t mem_add_jump(encoder *const enc, const instruction_t instruction, const item_t address)
+{
+	mem_add(enc, instruction);
+	const size_t index = mem_add(enc, address);
+	vector_add(&enc->jumps, (item_t)index);
+	return index;
+}
+
 
 static inline int proc_set(encoder *const enc, const size_t index, const item_t value)
 {
@@ -164,20 +362,169 @@ static inline item_t proc_get(const encoder *const enc, const size_t index)
 }
 
 
+/**
+ *	Add line to debug lines table, if it follows the last added one
+ *
+ *	@param	enc			Encoder
+ *	@param	line		Source line of code at current address
+ */
+static inline void lines_add(encoder *const enc, const size_t line)
+{
+	const size_t size = vector_size(&enc->lines);
+	const size_t last_line = size == 0 ? 0 : (size_t)vector_get(&enc->lines, size - 2);
+	if (last_line < line)
+	{
+		vector_add(&enc->lines, (item_t)line);
+		vector_add(&enc->lines, (item_t)mem_size(enc));
+	}
+}
+
+static inline size_t lines_amount(const encoder *const enc)
+{
+	return vector_size(&enc->lines) / 2;
+}
+
+static inline size_t lines_get_line(const encoder *const enc, const size_t index)
+{
+	return (size_t)vector_get(&enc->lines, 2 * index);
+}
+
+static inline size_t lines_get_address(const encoder *const enc, const size_t index)
+{
+	return (size_t)vector_get(&enc->lines, 2 * index + 1);
+}
+
+
+/**
+ *	Get size of target item in bytes
+ *
+ *	@param	enc			Encoder
+ *
+ *	@return	Size of item
+ */
+static inline size_t item_width(const encoder *const enc)
+{
+	return enc->target == item_int64 || enc->target == item_uint64
+		? 8
+		: enc->target == item_int32 || enc->target == item_uint32
+			? 4
+			: enc->target == item_int16 || enc->target == item_uint16
+				? 2
+				: 1;
+}
+
+/**
+ *	Round displacement up to alignment of floating slots, so virtual machine with narrow items
+ *	can access double in one operation
+ *
+ *	@param	enc			Encoder
+ *	@param	displ		Non-negative displacement
+ *	@param	type		Type of variable
+ *
+ *	@return	Aligned displacement
+ */
+static inline item_t displacements_align(const encoder *const enc, const item_t displ, const item_t type)
+{
+	const item_t alignment = (item_t)(sizeof(double) / item_width(enc));
+	if (!enc->is_aligned || !type_is_floating(type) || alignment <= 1)
+	{
+		return displ;
+	}
+
+	return (displ + alignment - 1) / alignment * alignment;
+}
+
+static inline void displacements_put(hash *const table, const size_t identifier, const item_t displ)
+{
+	size_t index = hash_get_index(table, (item_t)identifier);
+	if (index == SIZE_MAX)
+	{
+		index = hash_add(table, (item_t)identifier, 1);
+	}
+
+	hash_set_by_index(table, index, 0, displ);
+}
+
+/**
+ *	Set displacement of global variable or number of function
+ *
+ *	@param	enc			Encoder
+ *	@param	identifier	Identifier
+ *	@param	displ		Displacement
+ */
+static inline void globals_set(encoder *const enc, const size_t identifier, const item_t displ)
+{
+	displacements_put(&enc->globals, identifier, displ);
+}
+
+/**
+ *	Set variable displacement, local variables are kept only until the end of their function
+ *
+ *	@param	enc			Encoder
+ *	@param	identifier	Variable identifier
+ *	@param	displ		Variable displacement
+ */
+static inline void displacements_set(encoder *const enc, const size_t identifier, const item_t displ)
+{
+	displacements_put(enc->curr_func != NULL ? &enc->locals : &enc->globals, identifier, displ);
+}
+
+/**
+ *	Check if variable can take frame slot of dead variable
+ *
+ *	@param	enc			Encoder
+ *	@param	type		Variable type
+ *
+ *	@return	@c true on shared slot
+ */
+static inline bool displacements_is_shared(const encoder *const enc, const item_t type)
+{
+	return enc->is_sharing && (type_is_scalar(enc->sx, type) || type_is_floating(type));
+}
+
 /**
  *	Allocate variable
  *
  *	@param	enc			Encoder
  *	@param	identifier	Variable identifier
+ *	@param	is_parameter	Set for parameters of emitted function, which lie just as arguments were pushed
  *
  *	@return	Allocated variable displacement
  */
-static inline item_t displacements_add(encoder *const enc, const size_t identifier)
+static inline item_t displacements_add(encoder *const enc, const size_t identifier, const bool is_parameter)
 {
 	const item_t type = ident_get_type(enc->sx, identifier);
 	const item_t size = (item_t)type_size(enc->sx, type);
-	item_t result_displ = enc->displ;
 
+	if (enc->curr_func && !is_parameter && displacements_is_shared(enc, type))
+	{
+		// Переменная занимает место переменной, которая больше не используется
+		for (size_t i = vector_size(&enc->slots); i > 0; i -= 2)
+		{
+			const item_t displ = vector_get(&enc->slots, i - 2);
+			if (vector_get(&enc->slots, i - 1) == size && displacements_align(enc, displ, type) == displ)
+			{
+				const size_t last = vector_size(&enc->slots) - 2;
+				vector_set(&enc->slots, i - 2, vector_get(&enc->slots, last));
+				vector_set(&enc->slots, i - 1, vector_get(&enc->slots, last + 1));
+				vector_resize(&enc->slots, last);
+
+				displacements_set(enc, identifier, displ);
+				return displ;
+			}
+		}
+	}
+
+	if (enc->curr_func && !is_parameter)
+	{
+		enc->displ = displacements_align(enc, enc->displ, type);
+	}
+	else if (!enc->curr_func)
+	{
+		enc->max_global_displ = displacements_align(enc, enc->max_global_displ, type);
+	}
+
+	item_t result_displ = enc->displ;
 	if (enc->curr_func)
 	{
 		if (type_is_function(enc->sx, type))
@@ -194,10 +541,33 @@ static inline item_t displacements_add(encoder *const enc, const size_t identifi
 		enc->max_global_displ += size;
 	}
 
-	vector_set(&enc->displacements, identifier, result_displ);
+	displacements_set(enc, identifier, result_displ);
 	return result_displ;
 }
 
+/**
+ *	Allocate unnamed variable in current frame or in global memory
+ *
+ *	@param	enc			Encoder
+ *	@param	size		Variable size
+ *
+ *	@return	Allocated variable displacement
+ */
+static inline item_t displacements_reserve(encoder *const enc, const item_t size)
+{
+	if (enc->curr_func)
+	{
+		const item_t displ = enc->displ;
+		enc->displ += size;
+		enc->max_local_displ = max(enc->displ, enc->max_local_displ);
+		return displ;
+	}
+
+	const item_t displ = -enc->max_global_displ;
+	enc->max_global_displ += size;
+	return displ;
+}
+
 /**
  *	Get variable displacement
  *
@@ -208,7 +578,17 @@ static inline item_t displacements_add(encoder *const enc, const size_t identifi
  */
 static inline item_t displacements_get(const encoder *const enc, const size_t identifier)
 {
-	return vector_get(&enc->displacements, identifier);
+	if (enc->curr_func != NULL)
+	{
+		const item_t displ = hash_get(&enc->locals, (item_t)identifier, 0);
+		if (displ != ITEM_MAX)
+		{
+			return displ;
+		}
+	}
+
+	const item_t displ = hash_get(&enc->globals, (item_t)identifier, 0);
+	return displ != ITEM_MAX ? displ : 0;
 }
 
 
@@ -219,18 +599,11 @@ static inline item_t displacements_get(const encoder *const enc, const size_t id
  *	@param	identifier	Function identifier
  *	@param	address		Function address
  */
-static inline void functions_add(encoder *const enc, const size_t identifier, const size_t address)
+static inline void functions_set_calls(encoder *const enc, const item_t displ, const size_t func_number)
 {
-	const size_t func_number = vector_add(&enc->functions, (item_t)address);
-	vector_set(&enc->displacements, identifier, (item_t)func_number);
-
-	// If the function is defined after its calls, the callee is a predecl id
-	const size_t predecl_identifier = ident_get_prev(enc->sx, identifier);
-	item_t predecl_displ = displacements_get(enc, predecl_identifier);
-
-	if (predecl_displ < 0)
+	if (displ < 0)
 	{
-		size_t call_address = (size_t)abs(predecl_displ);
+		size_t call_address = (size_t)abs(displ);
 		while (call_address != 0)
 		{
 			const size_t ref = (size_t)mem_get(enc, call_address);
@@ -240,6 +613,21 @@ static inline void functions_add(encoder *const enc, const size_t identifier, co
 	}
 }
 
+static inline void functions_add(encoder *const enc, const size_t identifier, const size_t address)
+{
+	const size_t func_number = vector_add(&enc->functions, (item_t)address);
+	vector_add(&enc->owners, (item_t)identifier);
+
+	// If functions are reordered by profile, the function itself can be called before its definition
+	const item_t displ = displacements_get(enc, identifier);
+	globals_set(enc, identifier, (item_t)func_number);
+	functions_set_calls(enc, displ, func_number);
+
+	// If the function is defined after its calls, the callee is a predecl id
+	const size_t predecl_identifier = ident_get_prev(enc->sx, identifier);
+	functions_set_calls(enc, displacements_get(enc, predecl_identifier), func_number);
+}
+
 /**
  *	Get function displacement
  *
@@ -250,7 +638,7 @@ static inline void functions_add(encoder *const enc, const size_t identifier, co
  */
 static inline item_t functions_get(encoder *const enc, const size_t identifier)
 {
-	const item_t displ = vector_get(&enc->displacements, identifier);
+	const item_t displ = displacements_get(enc, identifier);
 
 	if (enc->curr_func)
 	{
@@ -267,7 +655,8 @@ static inline item_t functions_get(encoder *const enc, const size_t identifier)
 
 	if (displ <= 0)
 	{
-		vector_set(&enc->displacements, identifier, -(item_t)mem_size(enc));
+		globals_set(enc, identifier, -(item_t)mem_size(enc));
+		enc->forward_call = mem_size(enc);
 	}
 
 	return abs(displ);
@@ -304,1497 +693,4085 @@ static void addr_end_break(encoder *const enc)
 	}
 }
 
-
 /**
- *	Create encoder
+ *	Get final address of jump, following unconditional jumps
  *
- *	@param	ws			Compiler workspace
- *	@param	sx			Syntax structure
+ *	@param	enc			Encoder
+ *	@param	address		Jump address
  *
- *	@return	Encoder
+ *	@return	Final jump address
  */
-static encoder enc_create(const workspace *const ws, syntax *const sx)
+static size_t jump_get_target(const encoder *const enc, size_t address)
 {
-	encoder enc = { .sx = sx, .target = item_get_status(ws) };
-
-	enc.memory = vector_create(MAX_MEM_SIZE);
-	enc.iniprocs = vector_create(0);
-
-	const size_t records = vector_size(&sx->identifiers) / 4;
-	enc.identifiers = vector_create(records * 3);
-	enc.representations = vector_create(records * 8);
-	enc.displacements = vector_create(records);
-	enc.functions = vector_create(records);
-
-	vector_increase(&enc.memory, 4);
-	vector_increase(&enc.iniprocs, vector_size(&enc.sx->types));
-	vector_increase(&enc.displacements, vector_size(&sx->identifiers));
-	vector_increase(&enc.functions, 2);
+	// Ограничение на число переходов защищает от бесконечных циклов вида for (;;);
+	for (size_t i = vector_size(&enc->jumps); i > 0; i--)
+	{
+		if (address + 1 >= mem_size(enc) || mem_get(enc, address) != IC_B)
+		{
+			break;
+		}
 
-	enc.max_global_displ = 3;
-	enc.curr_func = NULL;
+		address = (size_t)mem_get(enc, address + 1);
+	}
 
-	return enc;
+	return address;
 }
 
-static int print_debug_lines(const encoder *const enc)
-{
-	int i;
-	for (i=0; i<=pconnect; i++)
-	{
-		uni_printf(enc->sx->io, "%zi %zi ", connect[i].line, connect[i].pc);
-	}
-	uni_printf(enc->sx->io, "\n");
-	return 0;
-}
 /**
- *	Print table
+ *	Thread jumps in memory table: jump to unconditional jump is redirected to its target,
+ *	unconditional jump to return is replaced by return itself.
+ *	Addresses are kept, so functions table and debug lines stay correct.
  *
  *	@param	enc			Encoder
- *	@param	table		Table for printing
- *
- *	@return	@c 0 on success, @c -1 on error
  */
-static int print_table(const encoder *const enc, const vector *const table)
+static void optimize_jumps(encoder *const enc)
 {
-	const size_t size = vector_size(table);
-	for (size_t i = 0; i < size; i++)
+	const size_t amount = vector_size(&enc->jumps);
+	for (size_t i = 0; i < amount; i++)
 	{
-		const item_t item = vector_get(table, i);
-		if (!item_check_var(enc->target, item))
+		const size_t index = (size_t)vector_get(&enc->jumps, i);
+		const instruction_t instruction = (instruction_t)mem_get(enc, index - 1);
+		if (instruction != IC_B && instruction != IC_BE0 && instruction != IC_BNE0)
 		{
-			system_error(tables_cannot_be_compressed);
-			return -1;
+			continue;
 		}
 
-		uni_printf(enc->sx->io, "%" PRIitem " ", item);
-	}
+		const size_t target = jump_get_target(enc, (size_t)mem_get(enc, index));
+		if (target >= mem_size(enc))
+		{
+			continue;
+		}
 
-	uni_printf(enc->sx->io, "\n");
-	return 0;
+		mem_set(enc, index, (item_t)target);
+
+		const instruction_t next = (instruction_t)mem_get(enc, target);
+		if (instruction == IC_B && next == IC_RETURN_VOID)
+		{
+			mem_set(enc, index - 1, IC_RETURN_VOID);
+			mem_set(enc, index, IC_NOP);
+		}
+		else if (instruction == IC_B && next == IC_RETURN_VAL && target + 1 < mem_size(enc))
+		{
+			mem_set(enc, index - 1, IC_RETURN_VAL);
+			mem_set(enc, index, mem_get(enc, target + 1));
+		}
+	}
 }
 
 /**
- *	Export codes of virtual machine
+ *	Get index of the first jump operand at address or after it
  *
  *	@param	enc			Encoder
+ *	@param	address		Address in memory table
  *
- *	@return	@c 0 on success, @c -1 on error
+ *	@return	Index in jumps table
  */
-static int enc_export(const encoder *const enc)
+static size_t jumps_lower_bound(const encoder *const enc, const size_t address)
 {
-	uni_printf(enc->sx->io, "#!/usr/bin/ruc-vm\n");
-
-	uni_printf(enc->sx->io, "%i %zi %zi %zi %zi %zi %" PRIitem " 0\n"
-		, pconnect
-		, vector_size(&enc->memory)
-		, vector_size(&enc->functions)
-		, vector_size(&enc->identifiers)
-		, vector_size(&enc->representations)
-		, vector_size(&enc->sx->types)
-		, enc->max_global_displ);
+	// Операнды переходов добавляются по возрастанию адресов
+	size_t left = 0;
+	size_t right = vector_size(&enc->jumps);
+	while (left < right)
+	{
+		const size_t middle = (left + right) / 2;
+		if ((size_t)vector_get(&enc->jumps, middle) < address)
+		{
+			left = middle + 1;
+		}
+		else
+		{
+			right = middle;
+		}
+	}
 
-	return print_debug_lines(enc)
-		|| print_table(enc, &enc->memory)
-		|| print_table(enc, &enc->functions)
-		|| print_table(enc, &enc->identifiers)
-		|| print_table(enc, &enc->representations)
-		|| print_table(enc, &enc->sx->types);
+	return left;
 }
 
 /**
- *	Free allocated memory
+ *	Get hash of function code, in which jump operands and end of function are taken relative to its beginning
  *
  *	@param	enc			Encoder
+ *	@param	address		Address of function header
+ *
+ *	@return	Hash of function code
  */
-static void enc_clear(encoder *const enc)
+static item_t function_hash(const encoder *const enc, const size_t address)
 {
-	vector_clear(&enc->memory);
-	vector_clear(&enc->iniprocs);
-	vector_clear(&enc->identifiers);
-	vector_clear(&enc->representations);
-	vector_clear(&enc->displacements);
-	vector_clear(&enc->functions);
+	const size_t end = (size_t)mem_get(enc, address + 2);
+	const size_t amount = vector_size(&enc->jumps);
+	size_t jump = jumps_lower_bound(enc, address);
+
+	uint64_t hash = 14695981039346656037u;
+	for (size_t i = address; i < end; i++)
+	{
+		const bool is_jump = jump < amount && (size_t)vector_get(&enc->jumps, jump) == i;
+		jump += is_jump ? 1 : 0;
+
+		const item_t value = is_jump || i == address + 2 ? mem_get(enc, i) - (item_t)address : mem_get(enc, i);
+		hash = (hash ^ (uint64_t)value) * 1099511628211u;
+	}
+
+	return (item_t)(hash % (uint64_t)ITEM_MAX);
 }
 
 /**
- *	Emit an error from encoder
+ *	Check that codes of two functions are equal, jump operands and ends of functions
+ *	are compared relative to beginnings of functions
  *
  *	@param	enc			Encoder
- *	@param	num			Error code
+ *	@param	fst			Address of the first function header
+ *	@param	snd			Address of the second function header
+ *
+ *	@return	@c true on equal codes, @c false otherwise
  */
-static void encoder_error(encoder *const enc, const range_location loc, err_t num, ...)
+static bool functions_are_equal(const encoder *const enc, const size_t fst, const size_t snd)
 {
-	va_list args;
-	va_start(args, num);
+	const size_t size = (size_t)mem_get(enc, fst + 2) - fst;
+	if (size != (size_t)mem_get(enc, snd + 2) - snd)
+	{
+		return false;
+	}
 
-	report_error(&enc->sx->rprt, enc->sx->io, loc, num, args);
+	const size_t amount = vector_size(&enc->jumps);
+	size_t fst_jump = jumps_lower_bound(enc, fst);
+	size_t snd_jump = jumps_lower_bound(enc, snd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const bool is_fst_jump = fst_jump < amount && (size_t)vector_get(&enc->jumps, fst_jump) == fst + i;
+		const bool is_snd_jump = snd_jump < amount && (size_t)vector_get(&enc->jumps, snd_jump) == snd + i;
+		if (is_fst_jump != is_snd_jump)
+		{
+			return false;
+		}
 
-	va_end(args);
-}
+		fst_jump += is_fst_jump ? 1 : 0;
+		snd_jump += is_snd_jump ? 1 : 0;
 
+		// Прочие адреса кода указывают внутрь своей функции, поэтому у разных функций не совпадут
+		const bool is_relative = is_fst_jump || i == 2;
+		const item_t fst_value = mem_get(enc, fst + i) - (is_relative ? (item_t)fst : 0);
+		const item_t snd_value = mem_get(enc, snd + i) - (is_relative ? (item_t)snd : 0);
+		if (fst_value != snd_value)
+		{
+			return false;
+		}
+	}
 
-/*
- *	 ______     __  __     ______   ______     ______     ______     ______     __     ______     __   __     ______
- *	/\  ___\   /\_\_\_\   /\  == \ /\  == \   /\  ___\   /\  ___\   /\  ___\   /\ \   /\  __ \   /\ "-.\ \   /\  ___\
- *	\ \  __\   \/_/\_\/_  \ \  _-/ \ \  __<   \ \  __\   \ \___  \  \ \___  \  \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
- *	 \ \_____\   /\_\/\_\  \ \_\    \ \_\ \_\  \ \_____\  \/\_____\  \/\_____\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
- *	  \/_____/   \/_/\/_/   \/_/     \/_/ /_/   \/_____/   \/_____/   \/_____/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+	return true;
+}
+
+/**
+ *	Remove records of table, which refer to removed code at the end of memory table
+ *
+ *	@param	table		Table of records with addresses in ascending order
+ *	@param	width		Number of values in record
+ *	@param	offset		Offset of address in record
+ *	@param	address		Beginning of removed code
  */
+static void table_truncate(vector *const table, const size_t width, const size_t offset, const size_t address)
+{
+	size_t size = vector_size(table);
+	while (size >= width && (size_t)vector_get(table, size - width + offset) >= address)
+	{
+		size -= width;
+	}
 
+	vector_resize(table, size);
+}
 
 /**
- * 	Emit load of lvalue
+ *	Fold just emitted function: if its code is equal to code of already emitted function,
+ *	the code is removed and function number refers to the code of that function.
+ *	Calls refer to functions by their numbers, so they stay correct.
  *
- * 	@param	enc		Encoder
+ *	@param	enc			Encoder
+ *	@param	number		Function number
  */
-static void emit_load_of_lvalue(encoder *const enc, lvalue value)
+static void function_fold(encoder *const enc, const size_t number)
 {
-	switch (value.kind)
+	// Операнды вызовов ещё не выведенных функций связаны в список, который нельзя удалять
+	const size_t address = (size_t)vector_get(&enc->functions, number);
+	if (enc->forward_call >= address)
 	{
-		case VARIABLE:
-		{
-			if (type_is_structure(enc->sx, value.type))
-			{
-				mem_add(enc, IC_COPY0ST);
-				mem_add(enc, value.displ);
-				mem_add(enc, (item_t)type_size(enc->sx, value.type));
-			}
-			else
-			{
-				mem_add(enc, type_is_floating(value.type) ? IC_LOADD : IC_LOAD);
-				mem_add(enc, value.displ);
-			}
-
-			return;
-		}
+		return;
+	}
 
-		case ADDRESS:
-		{
-			if (type_is_structure(enc->sx, value.type))
-			{
-				mem_add(enc, IC_COPY1ST);
-				mem_add(enc, (item_t)type_size(enc->sx, value.type));
-			}
-			else if (!type_is_array(enc->sx, value.type) && !type_is_pointer(enc->sx, value.type))
-			{
-				mem_add(enc, type_is_integer(enc->sx, value.type) ? IC_LAT : IC_LATD);
-			}
+	const item_t key = function_hash(enc, address);
+	const size_t index = hash_get_index(&enc->bodies, key);
+	if (index == SIZE_MAX)
+	{
+		hash_set_by_index(&enc->bodies, hash_add(&enc->bodies, key, 1), 0, (item_t)number);
+		return;
+	}
 
-			return;
-		}
+	const size_t original = (size_t)vector_get(&enc->functions, (size_t)hash_get(&enc->bodies, key, 0));
+	if (!functions_are_equal(enc, original, address))
+	{
+		return;
 	}
+
+	vector_set(&enc->functions, number, (item_t)original);
+	vector_resize(&enc->memory, address);
+	table_truncate(&enc->jumps, 1, 0, address);
+	table_truncate(&enc->lines, 2, 1, address);
+	table_truncate(&enc->blocks, 2, 0, address);
+	table_truncate(&enc->texts, 1, 0, address);
+	table_truncate(&enc->effects, 2, 0, address);
 }
 
 /**
- *	Emit identifier lvalue
+ *	Remember stack effect of instruction, which depends on its operands or callee
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
- *
- *	@return	Identifier designator
+ *	@param	address		Instruction address
+ *	@param	effect		Change of operand stack depth in words
  */
-static lvalue emit_identifier_lvalue(encoder *const enc, const node *const nd)
+static inline void effects_add(encoder *const enc, const size_t address, const item_t effect)
 {
-	const size_t identifier = expression_identifier_get_id(nd);
-	const item_t type = ident_get_type(enc->sx, identifier);
-	const item_t displ = displacements_get(enc, identifier);
-
-	return (lvalue){ .kind = VARIABLE, .type = type, .displ = displ };
+	vector_add(&enc->effects, (item_t)address);
+	vector_add(&enc->effects, effect);
 }
 
 /**
- *	Emit subscript lvalue
+ *	Get stack effect of instruction
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	address		Instruction address
  *
- *	@return Subscript designator
+ *	@return	Change of operand stack depth in words, @c STACK_VARIABLE if unknown
  */
-static lvalue emit_subscript_lvalue(encoder *const enc, const node *const nd)
+static item_t effects_get(const encoder *const enc, const size_t address)
 {
-	const node base = expression_subscript_get_base(nd);
-	emit_expression(enc, &base);
-
-	const node index = expression_subscript_get_index(nd);
-	emit_expression(enc, &index);
-
-	mem_add(enc, IC_SLICE);
-
-	const item_t type = expression_get_type(nd);
-	mem_add(enc, (item_t)type_size(enc->sx, type));
-	if (type_is_array(enc->sx, type))
+	// Команды добавляются по возрастанию адресов, поэтому таблица упорядочена
+	size_t left = 0;
+	size_t right = vector_size(&enc->effects) / 2;
+	while (left < right)
 	{
-		mem_add(enc, IC_LAT);
+		const size_t middle = (left + right) / 2;
+		const size_t current = (size_t)vector_get(&enc->effects, 2 * middle);
+		if (current == address)
+		{
+			return vector_get(&enc->effects, 2 * middle + 1);
+		}
+
+		if (current < address)
+		{
+			left = middle + 1;
+		}
+		else
+		{
+			right = middle;
+		}
 	}
 
-	return (lvalue){ .kind = ADDRESS, .type = type };
+	const instruction_info *const info = instruction_get_info((instruction_t)mem_get(enc, address));
+	return info != NULL ? info->stack : STACK_VARIABLE;
 }
 
 /**
- *	Emit member lvalue
+ *	Compute maximal operand stack depth of function by abstract interpretation of its code.
+ *	Depth is counted in words above frame of function, arguments of calls belong to callee frame.
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	address		Address of function header
  *
- *	@return	Member designator
+ *	@return	Maximal stack depth, @c -1 if code has instruction with unknown effect or depths do not match
  */
-static lvalue emit_member_lvalue(encoder *const enc, const node *const nd)
+static item_t stack_depth(const encoder *const enc, const size_t address)
 {
-	const item_t type = expression_get_type(nd);
-	const node base = expression_member_get_base(nd);
-	const item_t base_type = expression_get_type(&base);
-	const bool is_arrow = expression_member_is_arrow(nd);
-	const size_t member_index = expression_member_get_member_index(nd);
-	const item_t struct_type = is_arrow ? type_pointer_get_element_type(enc->sx, base_type) : base_type;
+	const size_t begin = address + 3;
+	const size_t end = (size_t)mem_get(enc, address + 2);
+	if (end <= begin || end > mem_size(enc))
+	{
+		return -1;
+	}
 
-	item_t member_displ = 0;
-	for (size_t i = 0; i < member_index; i++)
+	vector depths = vector_create(end - begin);
+	vector_increase(&depths, end - begin);
+	vector stack = vector_create(0);
+	for (size_t i = 0; i < end - begin; i++)
 	{
-		const item_t member_type = type_structure_get_member_type(enc->sx, struct_type, i);
-		member_displ += (item_t)type_size(enc->sx, member_type);
+		vector_set(&depths, i, -1);
 	}
 
-	if (is_arrow)
+	vector_set(&depths, 0, 0);
+	vector_add(&stack, (item_t)begin);
+
+	item_t max_depth = 0;
+	while (vector_size(&stack) != 0 && max_depth >= 0)
 	{
-		emit_expression(enc, &base);
-		mem_add(enc, IC_SELECT);
-		mem_add(enc, member_displ);
-		if (type_is_array(enc->sx, type) || type_is_pointer(enc->sx, type))
+		const size_t pc = (size_t)vector_remove(&stack);
+		const instruction_t instruction = (instruction_t)mem_get(enc, pc);
+		if (instruction == IC_RETURN_VAL || instruction == IC_RETURN_VOID || instruction == IC_STOP
+			|| instruction == IC_TAIL_CALL)
 		{
-			mem_add(enc, IC_LAT);
+			continue;
 		}
 
-		return (lvalue){ .kind = ADDRESS, .type = type };
-	}
-	else
-	{
-		const lvalue value = emit_lvalue(enc, &base);
-		if (value.kind == VARIABLE)
+		const instruction_info *const info = instruction_get_info(instruction);
+		const item_t effect = effects_get(enc, pc);
+		const item_t depth = vector_get(&depths, pc - begin) + effect;
+		if (info == NULL || effect == STACK_VARIABLE || depth < 0)
 		{
-			const item_t displ = value.displ > 0 ? value.displ + member_displ : value.displ - member_displ;
-			return (lvalue){ .kind = VARIABLE, .type = type, .displ = displ };
+			max_depth = -1;
+			break;
 		}
-		else // if (enc->last_kind == ADDRESS)
-		{
-			mem_add(enc, IC_SELECT);
-			mem_add(enc, member_displ);
 
-			if (type_is_array(enc->sx, type) || type_is_pointer(enc->sx, type))
+		max_depth = depth > max_depth ? depth : max_depth;
+
+		// Условный переход продолжается и по адресу перехода, и следующей командой
+		const bool is_jump = instruction == IC_B || instruction == IC_BE0 || instruction == IC_BNE0;
+		const size_t targets[] = { is_jump ? (size_t)mem_get(enc, pc + 1) : SIZE_MAX
+			, instruction != IC_B ? pc + 1 + info->argc : SIZE_MAX };
+		for (size_t i = 0; i < 2 && max_depth >= 0; i++)
+		{
+			if (targets[i] == SIZE_MAX)
 			{
-				mem_add(enc, IC_LAT);
+				continue;
 			}
 
-			return (lvalue){ .kind = ADDRESS, .type = type };
+			if (targets[i] < begin || targets[i] >= end)
+			{
+				max_depth = -1;
+			}
+			else if (vector_get(&depths, targets[i] - begin) == -1)
+			{
+				vector_set(&depths, targets[i] - begin, depth);
+				vector_add(&stack, (item_t)targets[i]);
+			}
+			else if (vector_get(&depths, targets[i] - begin) != depth)
+			{
+				max_depth = -1;
+			}
 		}
 	}
+
+	vector_clear(&stack);
+	vector_clear(&depths);
+	return max_depth;
 }
 
 /**
- *	Emit indirection lvalue
+ *	Compute maximal operand stack depths of all functions
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
- *
- *	@return	Indirection designator
  */
-static lvalue emit_indirection_lvalue(encoder *const enc, const node *const nd)
+static void stack_depths(encoder *const enc)
 {
-	const item_t type = expression_get_type(nd);
-	const node operand = expression_unary_get_operand(nd);
-	const lvalue value = emit_lvalue(enc, &operand);
-	if (value.kind == VARIABLE)
+	const size_t amount = vector_size(&enc->functions);
+	for (size_t i = 0; i < amount; i++)
 	{
-		mem_add(enc, IC_LOAD);
-		mem_add(enc, value.displ);
+		const size_t address = (size_t)vector_get(&enc->functions, i);
+		const instruction_t instruction = address + 2 < mem_size(enc) ? (instruction_t)mem_get(enc, address) : IC_NOP;
+		const bool is_function = instruction == IC_FUNC_BEG || instruction == IC_FUNC_BEG_LEAF;
+		vector_add(&enc->depths, is_function ? stack_depth(enc, address) : -1);
 	}
-
-	return (lvalue){ .kind = ADDRESS, .type = type };
 }
 
+
+/** Static costs of range of codes */
+typedef struct cost
+{
+	size_t instructions;			/**< Number of instructions */
+	size_t calls;					/**< Number of calls of functions */
+	vector mix;						/**< Pairs of instruction and its number, the most frequent first */
+} cost;
+
 /**
- *	Emit lvalue
+ *	Count instructions of range of codes, data embedded in codes is skipped
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	begin		Address of the first instruction
+ *	@param	end			Address after the last instruction
  *
- *	@return	Lvalue designator
+ *	@return	Costs of range
  */
-static lvalue emit_lvalue(encoder *const enc, const node *const nd)
+static cost cost_count(const encoder *const enc, const size_t begin, const size_t end)
 {
-	switch (expression_get_class(nd))
+	cost cst = { .instructions = 0, .calls = 0, .mix = vector_create(2 * MAX_MIX_REPORTED) };
+
+	const size_t blocks = vector_size(&enc->blocks);
+	size_t block = 0;
+	while (block < blocks && (size_t)vector_get(&enc->blocks, block + 1) <= begin)
 	{
-		case EXPR_IDENTIFIER:
-			return emit_identifier_lvalue(enc, nd);
+		block += 2;
+	}
 
-		case EXPR_SUBSCRIPT:
-			return emit_subscript_lvalue(enc, nd);
+	for (size_t pc = begin; pc < end; )
+	{
+		if (block < blocks && pc >= (size_t)vector_get(&enc->blocks, block))
+		{
+			pc = max(pc, (size_t)vector_get(&enc->blocks, block + 1));
+			block += 2;
+			continue;
+		}
 
-		case EXPR_MEMBER:
-			return emit_member_lvalue(enc, nd);
+		const item_t instruction = mem_get(enc, pc);
+		const instruction_info *const info = instruction_get_info((instruction_t)instruction);
+		cst.instructions++;
+		cst.calls += instruction == IC_CALL2 || instruction == IC_TAIL_CALL ? 1 : 0;
 
-		case EXPR_UNARY:
-			// There can be only indirection
-			return emit_indirection_lvalue(enc, nd);
+		// Число разных команд функции невелико, поэтому хватает линейного поиска
+		size_t i = 0;
+		while (i < vector_size(&cst.mix) && vector_get(&cst.mix, i) != instruction)
+		{
+			i += 2;
+		}
 
-		default:
-			// Cannot be lvalue
-			system_error(node_unexpected, nd);
-			return (lvalue){ .displ = ITEM_MAX };
+		if (i == vector_size(&cst.mix))
+		{
+			vector_add(&cst.mix, instruction);
+			vector_add(&cst.mix, 0);
+		}
+
+		vector_set(&cst.mix, i + 1, vector_get(&cst.mix, i + 1) + 1);
+		pc += info != NULL ? info->argc + 1 : 1;
+	}
+
+	// Сортировка вставками по убыванию числа, равные остаются в порядке появления
+	for (size_t i = 2; i < vector_size(&cst.mix); i += 2)
+	{
+		const item_t instruction = vector_get(&cst.mix, i);
+		const item_t count = vector_get(&cst.mix, i + 1);
+
+		size_t j = i;
+		for (; j > 0 && vector_get(&cst.mix, j - 1) < count; j -= 2)
+		{
+			vector_set(&cst.mix, j, vector_get(&cst.mix, j - 2));
+			vector_set(&cst.mix, j + 1, vector_get(&cst.mix, j - 1));
+		}
+
+		vector_set(&cst.mix, j, instruction);
+		vector_set(&cst.mix, j + 1, count);
 	}
+
+	return cst;
 }
 
+/**
+ *	Print the most frequent instructions of costs
+ *
+ *	@param	cst			Costs
+ *	@param	is_json		Set, if mix is printed as JSON object
+ *	@param	buffer		Buffer
+ *	@param	size		Size of printed text
+ */
+static void cost_print_mix(const cost *const cst, const bool is_json, char *const buffer, size_t *const size)
+{
+	const size_t amount = vector_size(&cst->mix) / 2;
+	const size_t reported = amount < MAX_MIX_REPORTED ? amount : MAX_MIX_REPORTED;
+
+	size_t others = cst->instructions;
+	*size += (size_t)snprintf(&buffer[*size], MAX_COST_REPORT_SIZE - *size, is_json ? "{" : "");
+	for (size_t i = 0; i < reported && *size < MAX_COST_REPORT_SIZE; i++)
+	{
+		const instruction_info *const info = instruction_get_info((instruction_t)vector_get(&cst->mix, 2 * i));
+		const item_t count = vector_get(&cst->mix, 2 * i + 1);
+		others -= (size_t)count;
+
+		*size += (size_t)snprintf(&buffer[*size], MAX_COST_REPORT_SIZE - *size
+			, is_json ? "%s\"%s\": %" PRIitem : "%s%s %" PRIitem
+			, i == 0 ? "" : ", ", info != NULL ? info->name : "?", count);
+	}
+
+	if (others != 0 && *size < MAX_COST_REPORT_SIZE)
+	{
+		*size += (size_t)snprintf(&buffer[*size], MAX_COST_REPORT_SIZE - *size
+			, is_json ? ", \"other\": %zu" : ", other %zu", others);
+	}
+
+	if (*size < MAX_COST_REPORT_SIZE)
+	{
+		*size += (size_t)snprintf(&buffer[*size], MAX_COST_REPORT_SIZE - *size, is_json ? "}" : "");
+	}
+}
 
 /**
- *	Emit literal expression
+ *	Report loops of function, loop is a range from target of backward jump to this jump
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	name		Function name
+ *	@param	begin		Address of the first instruction of function
+ *	@param	end			Address after the last instruction of function
+ *	@param	is_json		Set, if report is printed as JSON
  */
-static void emit_literal_expression(encoder *const enc, const node *const nd)
+static void cost_report_loops(const encoder *const enc, const char *const name
+	, const size_t begin, const size_t end, const bool is_json)
 {
-	switch (type_get_class(enc->sx, expression_get_type(nd)))
+	vector loops = vector_create(0);
+
+	// Переходы ищутся тем же обходом, что и подсчёт, чтобы данные в кодах не принимались за команды
+	const size_t blocks = vector_size(&enc->blocks);
+	size_t block = 0;
+	for (size_t pc = begin; pc < end; )
 	{
-		case TYPE_NULL_POINTER:
+		if (block < blocks && pc >= (size_t)vector_get(&enc->blocks, block))
 		{
-			mem_add(enc, IC_LI);
-			mem_add(enc, 0);
-			return;
+			pc = max(pc, (size_t)vector_get(&enc->blocks, block + 1));
+			block += 2;
+			continue;
 		}
 
-		case TYPE_BOOLEAN:
+		const instruction_t instruction = (instruction_t)mem_get(enc, pc);
+		const instruction_info *const info = instruction_get_info(instruction);
+		const bool is_jump = instruction == IC_B || instruction == IC_BE0 || instruction == IC_BNE0;
+		const size_t target = is_jump ? (size_t)mem_get(enc, pc + 1) : SIZE_MAX;
+		if (target >= begin && target <= pc)
 		{
-			const bool value = expression_literal_get_boolean(nd);
+			// Несколько обратных переходов к одному заголовку образуют один цикл
+			size_t i = 0;
+			while (i < vector_size(&loops) && (size_t)vector_get(&loops, i) != target)
+			{
+				i += 2;
+			}
 
-			mem_add(enc, IC_LI);
-			mem_add(enc, value ? 1 : 0);
-			return;
+			if (i == vector_size(&loops))
+			{
+				vector_add(&loops, (item_t)target);
+				vector_add(&loops, (item_t)(pc + 2));
+			}
+			else
+			{
+				vector_set(&loops, i + 1, (item_t)(pc + 2));
+			}
 		}
 
-		case TYPE_CHARACTER:
-		{
-			const char32_t value = expression_literal_get_character(nd);
+		pc += info != NULL ? info->argc + 1 : 1;
+	}
 
-			mem_add(enc, IC_LI);
-			mem_add(enc, value);
-			return;
+	// Циклы выводятся в порядке начал, так что внешний цикл предшествует вложенным
+	const size_t amount = vector_size(&loops) / 2;
+	for (size_t i = 1; i < amount; i++)
+	{
+		const item_t loop_begin = vector_get(&loops, 2 * i);
+		const item_t loop_end = vector_get(&loops, 2 * i + 1);
+
+		size_t j = i;
+		for (; j > 0 && vector_get(&loops, 2 * j - 2) > loop_begin; j--)
+		{
+			vector_set(&loops, 2 * j, vector_get(&loops, 2 * j - 2));
+			vector_set(&loops, 2 * j + 1, vector_get(&loops, 2 * j - 1));
 		}
 
-		case TYPE_INTEGER:
-		case TYPE_ENUM:
+		vector_set(&loops, 2 * j, loop_begin);
+		vector_set(&loops, 2 * j + 1, loop_end);
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		const size_t loop_begin = (size_t)vector_get(&loops, 2 * i);
+		const size_t loop_end = (size_t)vector_get(&loops, 2 * i + 1);
+
+		size_t depth = 1;
+		for (size_t j = 0; j < amount; j++)
 		{
-			const item_t value = expression_literal_get_integer(nd);
+			depth += j != i && (size_t)vector_get(&loops, 2 * j) <= loop_begin
+				&& (size_t)vector_get(&loops, 2 * j + 1) >= loop_end ? 1 : 0;
+		}
 
-			mem_add(enc, IC_LI);
-			mem_add(enc, value);
-			return;
+		cost cst = cost_count(enc, loop_begin, loop_end);
+
+		char buffer[MAX_COST_REPORT_SIZE];
+		size_t size = (size_t)snprintf(buffer, MAX_COST_REPORT_SIZE, is_json
+			? "{\"kind\": \"loop\", \"function\": \"%s\", \"begin\": %zu, \"end\": %zu, \"depth\": %zu"
+				", \"instructions\": %zu, \"calls\": %zu, \"mix\": "
+			: "  loop %s [%zu, %zu) depth %zu: instructions %zu, calls %zu, mix "
+			, name, loop_begin, loop_end, depth, cst.instructions, cst.calls);
+
+		if (size < MAX_COST_REPORT_SIZE)
+		{
+			cost_print_mix(&cst, is_json, buffer, &size);
 		}
 
-		case TYPE_FLOATING:
+		if (is_json && size < MAX_COST_REPORT_SIZE)
 		{
-			const double value = expression_literal_get_floating(nd);
-
-			mem_add(enc, IC_LID);
-			mem_add_double(enc, value);
-			return;
-		}
-
-		case TYPE_ARRAY:
-		{
-			// Это может быть только строка
-			const size_t string_num = expression_literal_get_string(nd);
-			const char *const string = string_get(enc->sx, string_num);
-
-			mem_add(enc, IC_LI);
-			const size_t reserved = mem_size(enc) + 4;
-			mem_add(enc, (item_t)reserved);
-			mem_add(enc, IC_B);
-			mem_increase(enc, 2);
-
-
-			item_t length = 0;
-			for (size_t i = 0; string[i] != '\0'; i += utf8_symbol_size(string[i]))
-			{
-				mem_add(enc, utf8_convert(&string[i]));
-				length++;
-			}
-
-			mem_set(enc, reserved - 1, length);
-			mem_set(enc, reserved - 2, (item_t)mem_size(enc));
-			return;
+			snprintf(&buffer[size], MAX_COST_REPORT_SIZE - size, "}");
 		}
 
-		default:
-			// Таких литералов не бывает
-			return;
+		log_report(TAG_COST_REPORT, buffer);
+		vector_clear(&cst.mix);
 	}
+
+	vector_clear(&loops);
 }
 
 /**
- *	Emit argument
+ *	Report static costs of functions and their loops: numbers of instructions and calls,
+ *	the most frequent instructions, frame size and operand stack depth
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	is_json		Set, if report is printed as JSON, one object per line
  */
-static void emit_argument(encoder *const enc, const node *const nd)
+static void cost_report(const encoder *const enc, const bool is_json)
 {
-	const item_t arg_type = expression_get_type(nd);
-	if (type_is_function(enc->sx, arg_type))
-	{
-		const size_t identifier = expression_identifier_get_id(nd);
-		const item_t displ = displacements_get(enc, identifier);
-		mem_add(enc, displ >= 0 ? IC_LI : IC_LOAD);
-		mem_add(enc, abs(displ));
-	}
-	else if (expression_get_class(nd) == EXPR_INITIALIZER)
+	const size_t amount = vector_size(&enc->functions);
+	for (size_t i = 0; i < amount; i++)
 	{
-		mem_add(enc, IC_LI);
-		const size_t reserved = mem_size(enc) + 4;
-		mem_add(enc, (item_t)reserved);
-		mem_add(enc, IC_B);
-		mem_increase(enc, 2);
+		const size_t address = (size_t)vector_get(&enc->functions, i);
+		const size_t identifier = (size_t)vector_get(&enc->owners, i);
+		const instruction_t instruction = identifier != 0 && address + 2 < mem_size(enc)
+			? (instruction_t)mem_get(enc, address)
+			: IC_NOP;
+		if (instruction != IC_FUNC_BEG && instruction != IC_FUNC_BEG_LEAF)
+		{
+			continue;
+		}
 
-		const node fst = expression_initializer_get_subexpr(nd, 0);
-		const size_t size = expression_initializer_get_size(nd);
-		for (size_t i = 0; i < size; i++)
+		const char *const name = ident_get_spelling(enc->sx, identifier);
+		const size_t begin = address + 3;
+		const size_t end = (size_t)mem_get(enc, address + 2);
+		const item_t frame = mem_get(enc, address + 1);
+		const item_t stack = i < vector_size(&enc->depths) ? vector_get(&enc->depths, i) : -1;
+
+		cost cst = cost_count(enc, begin, end);
+
+		char buffer[MAX_COST_REPORT_SIZE];
+		size_t size = (size_t)snprintf(buffer, MAX_COST_REPORT_SIZE, is_json
+			? "{\"kind\": \"function\", \"function\": \"%s\", \"begin\": %zu, \"end\": %zu, \"instructions\": %zu"
+				", \"calls\": %zu, \"frame\": %" PRIitem ", \"stack\": %" PRIitem ", \"mix\": "
+			: "%s [%zu, %zu): instructions %zu, calls %zu, frame %" PRIitem ", stack %" PRIitem ", mix "
+			, name, begin, end, cst.instructions, cst.calls, frame, stack);
+
+		if (size < MAX_COST_REPORT_SIZE)
 		{
-			const node subexpr = expression_initializer_get_subexpr(nd, i);
-			if (expression_get_class(&subexpr) != EXPR_LITERAL)
-			{
-				encoder_error(enc, node_get_location(&subexpr), wrong_init_in_actparam);
-			}
+			cost_print_mix(&cst, is_json, buffer, &size);
+		}
 
-			if (type_is_integer(enc->sx, expression_get_type(&fst)))
-			{
-				mem_add(enc, expression_literal_get_integer(&subexpr));
-			}
-			else
-			{
-				mem_add_double(enc, expression_literal_get_floating(&subexpr));
-			}
+		if (is_json && size < MAX_COST_REPORT_SIZE)
+		{
+			snprintf(&buffer[size], MAX_COST_REPORT_SIZE - size, "}");
 		}
 
-		mem_set(enc, reserved - 1, (item_t)size);
-		mem_set(enc, reserved - 2, (item_t)mem_size(enc));
-	}
-	else
-	{
-		emit_expression(enc, nd);
+		log_report(TAG_COST_REPORT, buffer);
+		vector_clear(&cst.mix);
+
+		cost_report_loops(enc, name, begin, end, is_json);
 	}
 }
 
-static void compress_ident(encoder *const enc, const size_t ref)
+
+/**
+ *	Load execution profile, it consists of lines with counter value and name
+ *
+ *	@param	enc			Encoder
+ *	@param	path		Profile file
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int profile_load(encoder *const enc, const char *const path)
 {
-	if (vector_get(&enc->sx->identifiers, ref) == ITEM_MAX)
+	FILE *const file = fopen(path, "r");
+	if (file == NULL)
 	{
-		mem_add(enc, ident_get_repr(enc->sx, ref));
-		return;
+		return -1;
 	}
 
-	const item_t new_ref = (item_t)vector_size(&enc->identifiers) - 1;
-	vector_add(&enc->identifiers, (item_t)vector_size(&enc->representations) - 2);
-	vector_add(&enc->identifiers, ident_get_type(enc->sx, ref));
-	vector_add(&enc->identifiers, displacements_get(enc, ref));
-
-	const char *buffer = repr_get_name(enc->sx, (size_t)ident_get_repr(enc->sx, ref));
-	for (size_t i = 0; buffer[i] != '\0'; i += utf8_symbol_size(buffer[i]))
+	int64_t count;
+	char name[MAX_PROFILE_KEY];
+	while (fscanf(file, "%" SCNd64 " %1023s", &count, name) == 2)
 	{
-		vector_add(&enc->representations, (item_t)utf8_convert(&buffer[i]));
+		map_add(&enc->profile, name, (item_t)count);
 	}
-	vector_add(&enc->representations, '\0');
 
-	vector_set(&enc->sx->identifiers, ref, ITEM_MAX);
-	ident_set_repr(enc->sx, ref, new_ref);
-	mem_add(enc, new_ref);
+	fclose(file);
+	return 0;
 }
 
 /**
- *	Emit printid expression
+ *	Create encoder
  *
- *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	ws			Compiler workspace
+ *	@param	sx			Syntax structure
+ *
+ *	@return	Encoder
  */
-static void emit_printid_expression(encoder *const enc, const node *const nd)
+static encoder enc_create(const workspace *const ws, syntax *const sx)
 {
-	const size_t argc = expression_call_get_arguments_amount(nd);
-	for (size_t i = 0; i < argc; i++)
+	encoder enc = { .sx = sx, .target = item_get_status(ws), .is_binary = ws_has_option(ws, OPT_BINARY)
+		, .is_eager = ws_has_option(ws, OPT_EAGER)
+		, .is_dense = ws_has_option(ws, OPT_DENSE) || ws_has_option(ws, OPT_COMPACT) || ws_has_option(ws, OPT_PACKED)
+		, .is_compact = ws_has_option(ws, OPT_COMPACT) || ws_has_option(ws, OPT_PACKED)
+		, .is_packed = ws_has_option(ws, OPT_PACKED)
+		, .is_aligned = ws_has_option(ws, OPT_ALIGN_DOUBLE)
+		, .is_compressed = ws_has_option(ws, OPT_COMPRESS)
+		, .is_extended = ws_has_option(ws, OPT_VM_EXTENDED)
+		, .is_debug = ws_has_option(ws, OPT_DEBUG)
+		, .is_folding = sx->is_optimized && !ws_has_option(ws, OPT_DEBUG)
+		, .is_sharing = sx->is_optimized && !ws_has_option(ws, OPT_DEBUG)
+		, .is_inlining = sx->is_optimized && !ws_has_option(ws, OPT_DEBUG)
+		, .is_hoisting = sx->is_optimized && !ws_has_option(ws, OPT_DEBUG)
+		, .is_numbering = sx->is_optimized && !ws_has_option(ws, OPT_DEBUG)
+		, .is_pruning = sx->is_optimized && !ws_has_option(ws, OPT_DEBUG) };
+
+	// Код занимает не больше слова на элемент дерева и символ строки,
+	// а данные глобальных переменных – не больше двух слов на инициализатор
+	const size_t nodes = vector_size(&sx->tree);
+	size_t characters = 0;
+	for (size_t i = 0; i < strings_size(&sx->string_literals); i++)
 	{
-		mem_add(enc, IC_PRINTID);
-
-		const node arg = expression_call_get_argument(nd, i);
-		compress_ident(enc, expression_identifier_get_id(&arg)); // Ссылка в identtab
+		characters += strings_get_length(&sx->string_literals, i) + 1;
 	}
+
+	enc.memory = vector_create(nodes + characters);
+	enc.iniprocs = vector_create(vector_size(&sx->types));
+
+	const size_t functions = vector_size(&sx->functions) + 2;
+	enc.identifiers = vector_create(0);
+	enc.representations = vector_create(0);
+	enc.names = hash_create(0);
+	enc.globals = hash_create(0);
+	enc.locals = hash_create(0);
+	enc.functions = vector_create(functions);
+	enc.owners = vector_create(functions);
+	enc.entries = vector_create(0);
+	enc.blocks = vector_create(0);
+	enc.texts = vector_create(0);
+	enc.jumps = vector_create(nodes / NODES_PER_JUMP);
+	enc.lines = vector_create(enc.is_debug ? nodes / NODES_PER_JUMP : 0);
+	enc.cases = vector_create(0);
+	enc.data = vector_create(2 * sx->initializer_amount);
+	enc.profile = map_create(0);
+	enc.cold = vector_create(0);
+	enc.effects = vector_create(0);
+	enc.depths = vector_create(0);
+	enc.bodies = hash_create(functions);
+	enc.is_profiled = ws_has_option(ws, OPT_PROFILE_USE) && profile_load(&enc, DEFAULT_EXECUTION_PROFILE) == 0;
+	enc.index = source_get_index(&sx->src);
+	enc.inl = inliner_create(sx);
+	enc.temporaries = hash_create(0);
+	enc.numbers = numbering_create(sx);
+	enc.addresses = vector_create(0);
+	enc.slots = vector_create(0);
+
+	vector_increase(&enc.memory, 4);
+	vector_add(&enc.blocks, 0);
+	vector_add(&enc.blocks, 4);
+	vector_increase(&enc.iniprocs, vector_size(&enc.sx->types));
+	vector_increase(&enc.functions, 2);
+	vector_increase(&enc.owners, 2);
+
+	enc.max_global_displ = 3;
+	enc.curr_func = NULL;
+	enc.forward_call = 0;
+	enc.has_escapes = true;
+	enc.has_addresses = true;
+
+	return enc;
 }
 
 /**
- *	Emit getid expression
+ *	Print debug lines table as line and address pairs
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_getid_expression(encoder *const enc, const node *const nd)
+static int print_debug_lines(const encoder *const enc)
 {
-	const size_t argc = expression_call_get_arguments_amount(nd);
-	for (size_t i = 0; i < argc; i++)
+	const size_t amount = lines_amount(enc);
+	for (size_t i = 0; i < amount; i++)
 	{
-		mem_add(enc, IC_GETID);
-
-		const node arg = expression_call_get_argument(nd, i);
-		compress_ident(enc, expression_identifier_get_id(&arg)); // Ссылка в identtab
+		uni_printf(enc->sx->io, "%zu %zu ", lines_get_line(enc, i), lines_get_address(enc, i));
 	}
-}
 
+	uni_print_char(enc->sx->io, '\n');
+	return 0;
+}
 /**
- *	Emit printf expression
+ *	Get name of identifier in local representations table, name is added on first request
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	ref			Identifier
+ *
+ *	@return	Name reference
  */
-static void emit_printf_expression(encoder *const enc, const node *const nd)
+static item_t names_get(encoder *const enc, const size_t ref)
 {
-	size_t sum_size = 0;
-	const size_t argc = expression_call_get_arguments_amount(nd);
-	for (size_t i = 1; i < argc; i++)
+	// Сжатый идентификатор ссылается на свою запись в локальной таблице идентификаторов
+	if (vector_get(&enc->sx->identifiers, ref) == ITEM_MAX)
 	{
-		const node arg = expression_call_get_argument(nd, i);
-		emit_expression(enc, &arg);
-
-		sum_size += type_size(enc->sx, expression_get_type(&arg));
+		return vector_get(&enc->identifiers, (size_t)ident_get_repr(enc->sx, ref) + 1);
 	}
 
-	const node format_string = expression_call_get_argument(nd, 0);
-	emit_expression(enc, &format_string);
+	// Одинаковые имена разных идентификаторов хранятся в таблице строк один раз
+	const item_t repr = ident_get_repr(enc->sx, ref);
+	item_t name = hash_get(&enc->names, repr, 0);
+	if (name == ITEM_MAX)
+	{
+		name = (item_t)vector_size(&enc->representations) - 2;
+		hash_add(&enc->names, repr, 1);
+		hash_set(&enc->names, repr, 0, name);
 
-	mem_add(enc, IC_PRINTF);
-	mem_add(enc, (item_t)sum_size);
+		const char *buffer = repr_get_name(enc->sx, (size_t)repr);
+		vector_reserve(&enc->representations, vector_size(&enc->representations) + strlen(buffer) + 1);
+		for (size_t i = 0; buffer[i] != '\0'; i += utf8_symbol_size(buffer[i]))
+		{
+			vector_add(&enc->representations, (item_t)utf8_convert(&buffer[i]));
+		}
+		vector_add(&enc->representations, '\0');
+	}
+
+	return name;
 }
 
 /**
- *	Emit print expression
+ *	Build index of function codes, so virtual machine can load and verify each function on its first call
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
  */
-static void emit_print_expression(encoder *const enc, const node *const nd)
+static void function_index(encoder *const enc)
 {
-	const size_t argc = expression_call_get_arguments_amount(nd);
-	for (size_t i = 0; i < argc; i++)
+	const size_t amount = vector_size(&enc->functions);
+	vector_reserve(&enc->entries, 3 * amount);
+	for (size_t i = 0; i < amount; i++)
 	{
-		const node arg = expression_call_get_argument(nd, i);
-		emit_expression(enc, &arg);
-
-		mem_add(enc, IC_PRINT);
-		mem_add(enc, expression_get_type(&arg));
+		// Заголовок функции хранит адрес конца её кода
+		const size_t address = (size_t)vector_get(&enc->functions, i);
+		const size_t identifier = (size_t)vector_get(&enc->owners, i);
+		const bool is_function = identifier != 0 && address + 2 < mem_size(enc);
+
+		vector_add(&enc->entries, is_function ? (item_t)address : 0);
+		vector_add(&enc->entries, is_function ? mem_get(enc, address + 2) - (item_t)address : 0);
+		vector_add(&enc->entries, is_function ? names_get(enc, identifier) : -1);
 	}
 }
 
 /**
- *	Emit call expression
+ *	Print table
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	table		Table for printing
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_call_expression(encoder *const enc, const node *const nd)
+static int print_table(const encoder *const enc, const vector *const table)
 {
-	const node callee = expression_call_get_callee(nd);
-	const size_t func = expression_identifier_get_id(&callee);
-
-	switch (func)
-	{
-		case BI_PRINTF:
-			emit_printf_expression(enc, nd);
-			return;
-		case BI_PRINT:
-			emit_print_expression(enc, nd);
-			return;
-		case BI_PRINTID:
-			emit_printid_expression(enc, nd);
-			return;
-		case BI_GETID:
-			emit_getid_expression(enc, nd);
-			return;
-	}
-
-	if (func >= BEGIN_USER_FUNC)
+	const size_t size = vector_size(table);
+	for (size_t i = 0; i < size; i++)
 	{
-		mem_add(enc, IC_CALL1);
-	}
+		const item_t item = vector_at(table, i);
+		if (!item_check_var(enc->target, item))
+		{
+			system_error(tables_cannot_be_compressed);
+			return -1;
+		}
 
-	const size_t args = expression_call_get_arguments_amount(nd);
-	for (size_t i = 0; i < args; i++)
-	{
-		const node argument = expression_call_get_argument(nd, i);
-		emit_argument(enc, &argument);
+		uni_print_item(enc->sx->io, item);
+		uni_print_char(enc->sx->io, ' ');
 	}
 
-	if (func >= BEGIN_USER_FUNC)
-	{
-		mem_add(enc, IC_CALL2);
-		mem_add(enc, functions_get(enc, func));
-	}
-	else
-	{
-		mem_add(enc, builtin_to_instruction((builtin_t)func));
-	}
+	uni_print_char(enc->sx->io, '\n');
+	return 0;
 }
 
 /**
- *	Emit rvalue of member expression
+ *	Write unsigned value in little-endian order
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	value		Value
+ *	@param	width		Number of bytes
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_member_expression(encoder *const enc, const node *const nd)
+static int write_binary(const encoder *const enc, const uint64_t value, const size_t width, size_t *const offset)
 {
-	// Member expression может выдать rvalue только в одном случае: слева rvalue и оператор '.'
-	const node base = expression_member_get_base(nd);
-	emit_expression(enc, &base);
-
-	const item_t base_type = expression_get_type(&base);
-	const size_t member_index = expression_member_get_member_index(nd);
-
-	size_t member_displ = 0;
-	for (size_t i = 0; i < member_index; i++)
+	char buffer[sizeof(uint64_t)];
+	for (size_t i = 0; i < width; i++)
 	{
-		const item_t member_type = type_structure_get_member_type(enc->sx, base_type, i);
-		member_displ += type_size(enc->sx, member_type);
+		buffer[i] = (char)((value >> (8 * i)) & 0xFF);
 	}
 
-	mem_add(enc, IC_COPYST);
-	mem_add(enc, (item_t)member_displ);
-	mem_add(enc, (item_t)type_size(enc->sx, expression_get_type(nd)));
-	mem_add(enc, (item_t)type_size(enc->sx, base_type));
+	*offset += width;
+	return out_write(enc->sx->io, buffer, width) == (int)width ? 0 : -1;
 }
 
 /**
- *	Emit cast expression
+ *	Write zero bytes up to alignment of binary section
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_cast_expression(encoder *const enc, const node *const nd)
+static int write_binary_alignment(const encoder *const enc, size_t *const offset)
 {
-	const node subexpr = expression_cast_get_operand(nd);
-	emit_expression(enc, &subexpr);
-
-	const item_t target_type = expression_get_type(nd);
-	const item_t source_type = expression_get_type(&subexpr);
-
-	// Необходимо только преобразование 'int' -> 'float'
-	if (type_is_integer(enc->sx, source_type) && type_is_floating(target_type))
+	int ret = 0;
+	while (*offset % BINARY_ALIGNMENT != 0 && !ret)
 	{
-		mem_add(enc, IC_WIDEN);
+		ret = write_binary(enc, 0, 1, offset);
 	}
+
+	return ret;
 }
 
 /**
- *	Emit increment expression
+ *	Write debug lines table as binary section of line and address deltas,
+ *	every delta is unsigned LEB128 number
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_increment_expression(encoder *const enc, const node *const nd)
+static int write_binary_lines(const encoder *const enc, size_t *const offset)
 {
-	const node operand = expression_unary_get_operand(nd);
-	const lvalue value = emit_lvalue(enc, &operand);
+	size_t prev_line = 0;
+	size_t prev_address = 0;
 
-	const unary_t op = expression_unary_get_operator(nd);
-	instruction_t instruction = unary_to_instruction(op);
-
-	if (value.kind == ADDRESS)
+	const size_t amount = lines_amount(enc);
+	for (size_t i = 0; i < amount; i++)
 	{
-		instruction = instruction_to_address_ver(instruction);
-	}
+		// Строки возрастают, а адреса не убывают, поэтому разности неотрицательны
+		const size_t deltas[] = { lines_get_line(enc, i) - prev_line, lines_get_address(enc, i) - prev_address };
+		for (size_t j = 0; j < 2; j++)
+		{
+			size_t value = deltas[j];
+			do
+			{
+				const uint64_t byte = (value & 0x7F) | (value > 0x7F ? 0x80 : 0);
+				if (write_binary(enc, byte, 1, offset))
+				{
+					return -1;
+				}
 
-	if (type_is_floating(expression_get_type(nd)))
-	{
-		mem_add(enc, instruction_to_floating_ver(instruction));
-	}
-	else
-	{
-		mem_add(enc, instruction);
-	}
+				value >>= 7;
+			} while (value != 0);
+		}
 
-	if (value.kind == VARIABLE)
-	{
-		mem_add(enc, value.displ);
+		prev_line = lines_get_line(enc, i);
+		prev_address = lines_get_address(enc, i);
 	}
+
+	return write_binary_alignment(enc, offset);
 }
 
 /**
- *	Emit unary expression
+ *	Write table as binary section of fixed-width items
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	table		Table for writing
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_unary_expression(encoder *const enc, const node *const nd)
+static int write_binary_table(const encoder *const enc, const vector *const table, size_t *const offset)
 {
-	const item_t type = expression_get_type(nd);
-	const unary_t operator = expression_unary_get_operator(nd);
-	const node operand = expression_unary_get_operand(nd);
-	switch (operator)
-	{
-		case UN_POSTINC:
-		case UN_POSTDEC:
-		case UN_PREINC:
-		case UN_PREDEC:
-			emit_increment_expression(enc, nd);
-			return;
+	const size_t width = item_width(enc);
 
-		case UN_ADDRESS:
+	const size_t size = vector_size(table);
+	for (size_t i = 0; i < size; i++)
+	{
+		const item_t item = vector_at(table, i);
+		if (!item_check_var(enc->target, item))
 		{
-			const lvalue value = emit_lvalue(enc, &operand);
-			if (value.kind == VARIABLE)
-			{
-				mem_add(enc, IC_LA);
-				mem_add(enc, value.displ);
-			}
-
-			return;
+			system_error(tables_cannot_be_compressed);
+			return -1;
 		}
 
-		case UN_INDIRECTION:
-			// Unreachable
-			return;
-
-		case UN_MINUS:
-			emit_expression(enc, &operand);
-			mem_add(enc, type_is_integer(enc->sx, type) ? IC_UNMINUS : IC_UNMINUS_R);
-			return;
-
-		case UN_NOT:
-			emit_expression(enc, &operand);
-			mem_add(enc, IC_NOT);
-			return;
-
-		case UN_LOGNOT:
-			emit_expression(enc, &operand);
-			mem_add(enc, IC_LOG_NOT);
-			return;
-
-		case UN_ABS:
-			emit_expression(enc, &operand);
-			mem_add(enc, type_is_integer(enc->sx, type) ? IC_ABSI : IC_ABS);
-			return;
-
-		case UN_UPB:
+		if (write_binary(enc, (uint64_t)(int64_t)item, width, offset))
 		{
-			mem_add(enc, IC_LI);
-			mem_add(enc, 0);
-
-			emit_expression(enc, &operand);
-			mem_add(enc, IC_UPB);
-			return;
+			return -1;
 		}
 	}
+
+	return write_binary_alignment(enc, offset);
 }
 
 /**
- *	Emit binary expression
+ *	Write codes as binary section of compact codes
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	bytes		Compact codes
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_binary_expression(encoder *const enc, const node *const nd)
+static int write_binary_compact(const encoder *const enc, const vector *const bytes, size_t *const offset)
 {
-	const binary_t operator = expression_binary_get_operator(nd);
-	const node LHS = expression_binary_get_LHS(nd);
-	const node RHS = expression_binary_get_RHS(nd);
-	if (operator == BIN_COMMA)
+	// Декодированные коды должны поместиться в элементы заданного типа
+	for (size_t i = 0; i < mem_size(enc); i++)
 	{
-		emit_void_expression(enc, &LHS);
-		emit_expression(enc, &RHS);
+		if (!item_check_var(enc->target, mem_get(enc, i)))
+		{
+			system_error(tables_cannot_be_compressed);
+			return -1;
+		}
 	}
-	else
-	{
-		emit_expression(enc, &LHS);
 
-		size_t addr = SIZE_MAX;
-		const bool is_logical = operator == BIN_LOG_AND || operator == BIN_LOG_OR;
-		if (is_logical)
+	const size_t size = vector_size(bytes);
+	for (size_t i = 0; i < size; i++)
+	{
+		if (write_binary(enc, (uint64_t)vector_get(bytes, i), 1, offset))
 		{
-			mem_add(enc, IC_DUPLICATE);
-			mem_add(enc, operator == BIN_LOG_AND ? IC_BE0 : IC_BNE0);
-			addr = mem_reserve(enc);
+			return -1;
 		}
+	}
 
-		emit_expression(enc, &RHS);
+	return write_binary_alignment(enc, offset);
+}
 
-		if (is_logical)
-		{
-			mem_set(enc, addr, (item_t)mem_size(enc) + 1);
-		}
+/**
+ *	Write section data of binary format
+ *
+ *	@param	enc			Encoder
+ *	@param	kind		Section kind
+ *	@param	table		Table or compact codes for codes and tables sections
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
+ */
+static int write_binary_section_data(const encoder *const enc, const section_t kind, const vector *const table
+	, size_t *const offset)
+{
+	switch (kind)
+	{
+		case SECTION_LINES:
+			return write_binary_lines(enc, offset);
 
-		const instruction_t instruction = binary_to_instruction(operator);
-		if (type_is_floating(expression_get_type(&LHS)))
-		{
-			mem_add(enc, instruction_to_floating_ver(instruction));
-		}
-		else
+		case SECTION_INDEX:
 		{
-			mem_add(enc, instruction);
+			// Индекс из 64-битных значений не зависит от типа элементов таблиц
+			const size_t entries = vector_size(&enc->entries);
+			for (size_t i = 0; i < entries; i++)
+			{
+				if (write_binary(enc, (uint64_t)(int64_t)vector_get(&enc->entries, i), 8, offset))
+				{
+					return -1;
+				}
+			}
+
+			const size_t blocks = enc->is_compact ? vector_size(&enc->blocks) : 0;
+			for (size_t i = 0; i < blocks; i++)
+			{
+				if (write_binary(enc, (uint64_t)vector_get(&enc->blocks, i), 8, offset))
+				{
+					return -1;
+				}
+			}
+
+			const size_t texts = enc->is_packed ? vector_size(&enc->texts) : 0;
+			for (size_t i = 0; i < texts; i++)
+			{
+				if (write_binary(enc, (uint64_t)vector_get(&enc->texts, i), 8, offset))
+				{
+					return -1;
+				}
+			}
+
+			return 0;
 		}
+
+		case SECTION_CODES:
+			return enc->is_compact ? write_binary_compact(enc, table, offset) : write_binary_table(enc, table, offset);
+
+		default:
+			return write_binary_table(enc, table, offset);
 	}
 }
 
 /**
- *	Emit ternary expression
+ *	Write section of binary format, compressed section is preceded by
+ *	its uncompressed and compressed sizes and is aligned as whole
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	kind		Section kind
+ *	@param	table		Table or compact codes for codes and tables sections
+ *	@param	offset		Offset in output to update
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_ternary_expression(encoder *const enc, const node *const nd)
+static int write_binary_section(const encoder *const enc, const section_t kind, const vector *const table
+	, size_t *const offset)
 {
-	const node condition = expression_ternary_get_condition(nd);
-	emit_expression(enc, &condition);
+	if (!enc->is_compressed)
+	{
+		return write_binary_section_data(enc, kind, table, offset);
+	}
 
-	mem_add(enc, IC_BE0);
-	size_t addr = mem_reserve(enc);
+	// Раздел собирается в буфере, так как его размеры записываются перед сжатыми данными
+	universal_io buffer = io_create();
+	out_set_buffer(&buffer, BINARY_SECTION_SIZE);
+	out_swap(enc->sx->io, &buffer);
 
-	const node LHS = expression_ternary_get_LHS(nd);
-	emit_expression(enc, &LHS);
+	size_t size = 0;
+	int ret = write_binary_section_data(enc, kind, table, &size);
 
-	mem_set(enc, addr, (item_t)mem_size(enc) + 2);
-	mem_add(enc, IC_B);
-	addr = mem_reserve(enc);
+	out_swap(enc->sx->io, &buffer);
+	uint8_t *const data = (uint8_t *)out_extract_buffer(&buffer);
+	io_erase(&buffer);
 
-	const node RHS = expression_ternary_get_RHS(nd);
-	emit_expression(enc, &RHS);
+	const size_t capacity = lz_bound(size);
+	uint8_t *const compressed = ret || data == NULL ? NULL : malloc(capacity);
+	const size_t compressed_size = compressed != NULL ? lz_compress(data, size, compressed, capacity) : SIZE_MAX;
 
-	mem_set(enc, addr, (item_t)mem_size(enc));
+	ret = compressed_size == SIZE_MAX
+		|| write_binary(enc, size, 8, offset)
+		|| write_binary(enc, compressed_size, 8, offset)
+		|| out_write(enc->sx->io, (const char *)compressed, compressed_size) != (int)compressed_size;
+	*offset += ret ? 0 : compressed_size;
+
+	free(data);
+	free(compressed);
+	return ret || write_binary_alignment(enc, offset) ? -1 : 0;
 }
 
 /**
- *	Emit assignment expression
+ *	Export codes of virtual machine in binary format:
+ *	header of magic, version, item type, flags and table sizes, then debug lines,
+ *	index of functions and tables, all values are little-endian and
+ *	every section is aligned for mapping into memory.
+ *	Index holds address and size of code and name of each function, so loader can
+ *	skip codes of functions until their first call unless eager flag is set.
+ *	With dense flag instructions are numbered from zero, and header holds version
+ *	and number of dense codes for direct dispatch tables of virtual machine.
+ *	With compact flag codes section holds octets of dense instructions and
+ *	LEB128 operands, bounds of data embedded in codes follow the index.
+ *	With packed flag string literals in compact codes hold characters in UTF-8,
+ *	and beginnings of string literals follow bounds of data.
+ *	With compressed flag every section after header is compressed independently
+ *	in LZ4 block format, so loader can decompress sections one by one while reading
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_assignment_expression(encoder *const enc, const node *const nd)
+static int enc_export_binary(const encoder *const enc)
 {
-	const node LHS = expression_assignment_get_LHS(nd);
-	const lvalue value = emit_lvalue(enc, &LHS);
-
-	const node RHS = expression_assignment_get_RHS(nd);
-	emit_expression(enc, &RHS);
-
-	const item_t type = expression_get_type(nd);
-	if (type_is_structure(enc->sx, type))
+	size_t offset = strlen(SHEBANG);
+	for (size_t i = 0; BINARY_MAGIC[i] != '\0'; i++)
 	{
-		if (value.kind == VARIABLE)
+		if (write_binary(enc, (uint64_t)BINARY_MAGIC[i], 1, &offset))
 		{
-			mem_add(enc, IC_COPY0ST_ASSIGN);
-			mem_add(enc, value.displ);
+			return -1;
 		}
-		else
+	}
+
+	// Плотные коды записываются в копию, чтобы дампы показывали исходные команды
+	vector codes = vector_create(enc->is_dense ? mem_size(enc) : 0);
+	if (enc->is_compact)
+	{
+		if (instructions_compact(&enc->memory, &enc->blocks, enc->is_packed ? &enc->texts : NULL, &codes))
 		{
-			mem_add(enc, IC_COPY1ST_ASSIGN);
+			system_error(codes_cannot_be_dense);
+			vector_clear(&codes);
+			return -1;
 		}
-
-		mem_add(enc, (item_t)type_size(enc->sx, type));
 	}
-	else // Скалярное присваивание
+	else if (enc->is_dense)
 	{
-		const binary_t op = expression_assignment_get_operator(nd);
-		instruction_t instruction = binary_to_instruction(op);
-		if (value.kind == ADDRESS)
+		for (size_t i = 0; i < mem_size(enc); i++)
 		{
-			instruction = instruction_to_address_ver(instruction);
+			vector_add(&codes, mem_get(enc, i));
 		}
 
-		if (type_is_floating(type))
+		if (instructions_to_dense(&codes, &enc->blocks))
 		{
-			instruction = instruction_to_floating_ver(instruction);
+			system_error(codes_cannot_be_dense);
+			vector_clear(&codes);
+			return -1;
 		}
+	}
 
-		mem_add(enc, instruction);
+	const vector *const tables[] = { enc->is_dense && !enc->is_compact ? &codes : &enc->memory, &enc->functions
+		, &enc->identifiers, &enc->representations, &enc->sx->types, &enc->data, &enc->depths };
+	const size_t amount = sizeof(tables) / sizeof(tables[0]);
+
+	const uint64_t flags = (enc->is_eager ? BINARY_EAGER : 0) | (enc->is_dense ? BINARY_DENSE : 0)
+		| (enc->is_compact ? BINARY_COMPACT : 0) | (enc->is_compressed ? BINARY_COMPRESSED : 0)
+		| (enc->is_packed ? BINARY_PACKED : 0) | (enc->is_aligned ? BINARY_ALIGNED : 0)
+		| (enc->is_extended ? BINARY_EXTENDED : 0);
+	int ret = write_binary_alignment(enc, &offset)
+		|| write_binary(enc, BINARY_VERSION, 4, &offset)
+		|| write_binary(enc, (uint64_t)enc->target, 4, &offset)
+		|| write_binary(enc, flags, 8, &offset)
+		|| write_binary(enc, enc->is_dense ? DENSE_INSTRUCTION_VERSION : 0, 4, &offset)
+		|| write_binary(enc, enc->is_dense ? instruction_dense_amount() : 0, 4, &offset)
+		|| write_binary(enc, lines_amount(enc), 8, &offset)
+		|| write_binary(enc, (uint64_t)(int64_t)enc->max_global_displ, 8, &offset);
+
+	for (size_t i = 0; i < amount && !ret; i++)
+	{
+		ret = write_binary(enc, vector_size(tables[i]), 8, &offset);
+	}
 
-		if (value.kind == VARIABLE)
-		{
-			mem_add(enc, value.displ);
-		}
+	ret = ret || write_binary(enc, enc->is_compact ? vector_size(&codes) : 0, 8, &offset)
+		|| write_binary(enc, enc->is_compact ? vector_size(&enc->blocks) : 0, 8, &offset)
+		|| write_binary(enc, enc->is_packed ? vector_size(&enc->texts) : 0, 8, &offset)
+		|| write_binary_section(enc, SECTION_LINES, NULL, &offset)
+		|| write_binary_section(enc, SECTION_INDEX, NULL, &offset)
+		|| write_binary_section(enc, SECTION_CODES, enc->is_compact ? &codes : tables[0], &offset);
+	for (size_t i = 1; i < amount && !ret; i++)
+	{
+		ret = write_binary_section(enc, SECTION_TABLE, tables[i], &offset);
 	}
+
+	vector_clear(&codes);
+	return ret ? -1 : 0;
 }
 
 /**
- *	Emit initializer
+ *	Export codes of virtual machine
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *
+ *	@return	@c 0 on success, @c -1 on error
  */
-static void emit_initializer(encoder *const enc, const node *const nd)
+static int enc_export(const encoder *const enc)
 {
-	const item_t type = expression_get_type(nd);
-	const size_t size = expression_initializer_get_size(nd);
-
-	if (type_is_array(enc->sx, type))
+	uni_printf(enc->sx->io, "%s", SHEBANG);
+	if (enc->is_binary)
 	{
-		mem_add(enc, IC_BEG_INIT);
-		mem_add(enc, (item_t)size);
+		return enc_export_binary(enc);
 	}
 
-	for (size_t i = 0; i < size; i++)
+	uni_printf(enc->sx->io, "%i %zi %zi %zi %zi %zi %" PRIitem
+		, (int)lines_amount(enc) - 1
+		, vector_size(&enc->memory)
+		, vector_size(&enc->functions)
+		, vector_size(&enc->identifiers)
+		, vector_size(&enc->representations)
+		, vector_size(&enc->sx->types)
+		, enc->max_global_displ);
+
+	// Прежняя машина ожидает в последнем поле заголовка ноль, расширенная – свою версию и размер таблицы данных
+	if (enc->is_extended)
 	{
-		const node subexpr = expression_initializer_get_subexpr(nd, i);
-		emit_expression(enc, &subexpr);
+		uni_printf(enc->sx->io, " %" PRIitem " %zi\n", EXTENDED_VM_VERSION, vector_size(&enc->data));
 	}
+	else
+	{
+		uni_printf(enc->sx->io, " 0\n");
+	}
+
+	return print_debug_lines(enc)
+		|| print_table(enc, &enc->memory)
+		|| print_table(enc, &enc->functions)
+		|| print_table(enc, &enc->identifiers)
+		|| print_table(enc, &enc->representations)
+		|| print_table(enc, &enc->sx->types)
+		|| (enc->is_extended && print_table(enc, &enc->data));
 }
 
 /**
- *	Emit expression
+ *	Free allocated memory
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
  */
-static void emit_expression(encoder *const enc, const node *const nd)
+static void enc_clear(encoder *const enc)
 {
-	memory_into_txt(&enc->memory);
-	line=debug_which_is_needed(nd,enc->sx->io);
-	if (curline<line)
-	{
-		curline=line;
-		connect[++pconnect].line=line;
-		connect[pconnect].pc=mem_size(enc);
-	}
-	if (expression_is_lvalue(nd))
-	{
-		const lvalue value = emit_lvalue(enc, nd);
-		emit_load_of_lvalue(enc, value);
-		return;
-	}
+	vector_clear(&enc->memory);
+	vector_clear(&enc->iniprocs);
+	vector_clear(&enc->identifiers);
+	vector_clear(&enc->representations);
+	hash_clear(&enc->names);
+	hash_clear(&enc->globals);
+	hash_clear(&enc->locals);
+	vector_clear(&enc->functions);
+	vector_clear(&enc->jumps);
+	vector_clear(&enc->lines);
+	vector_clear(&enc->cases);
+	vector_clear(&enc->data);
+	inliner_clear(&enc->inl);
+	hash_clear(&enc->temporaries);
+	numbering_clear(&enc->numbers);
+	vector_clear(&enc->addresses);
+	vector_clear(&enc->slots);
+	map_clear(&enc->profile);
+	vector_clear(&enc->cold);
+	vector_clear(&enc->effects);
+	vector_clear(&enc->depths);
+	hash_clear(&enc->bodies);
+	vector_clear(&enc->owners);
+	vector_clear(&enc->entries);
+	vector_clear(&enc->blocks);
+	vector_clear(&enc->texts);
+}
 
-	switch (expression_get_class(nd))
+/**
+ *	Emit an error from encoder
+ *
+ *	@param	enc			Encoder
+ *	@param	num			Error code
+ */
+static void encoder_error(encoder *const enc, const range_location loc, err_t num, ...)
+{
+	va_list args;
+	va_start(args, num);
+
+	report_error(&enc->sx->rprt, enc->sx->io, loc, num, args);
+
+	va_end(args);
+}
+
+
+/*
+ *	 ______     __  __     ______   ______     ______     ______     ______     __     ______     __   __     ______
+ *	/\  ___\   /\_\_\_\   /\  == \ /\  == \   /\  ___\   /\  ___\   /\  ___\   /\ \   /\  __ \   /\ "-.\ \   /\  ___\
+ *	\ \  __\   \/_/\_\/_  \ \  _-/ \ \  __<   \ \  __\   \ \___  \  \ \___  \  \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
+ *	 \ \_____\   /\_\/\_\  \ \_\    \ \_\ \_\  \ \_____\  \/\_____\  \/\_____\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
+ *	  \/_____/   \/_/\/_/   \/_/     \/_/ /_/   \/_____/   \/_____/   \/_____/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+ */
+
+
+/**
+ * 	Emit load of lvalue
+ *
+ * 	@param	enc		Encoder
+ */
+static void emit_load_of_lvalue(encoder *const enc, lvalue value)
+{
+	switch (value.kind)
 	{
-		case EXPR_LITERAL:
-			emit_literal_expression(enc, nd);
-			return;
+		case VARIABLE:
+		{
+			if (type_is_structure(enc->sx, value.type))
+			{
+				effects_add(enc, mem_add(enc, IC_COPY0ST), (item_t)type_size(enc->sx, value.type));
+				mem_add(enc, value.displ);
+				mem_add(enc, (item_t)type_size(enc->sx, value.type));
+			}
+			else
+			{
+				mem_add_variable(enc, type_is_floating(value.type) ? IC_LOADD : IC_LOAD, value.displ);
+			}
 
-		case EXPR_CALL:
-			emit_call_expression(enc, nd);
 			return;
+		}
 
-		case EXPR_MEMBER:
-			emit_member_expression(enc, nd);
-			return;
+		case ADDRESS:
+		{
+			if (type_is_structure(enc->sx, value.type))
+			{
+				effects_add(enc, mem_add(enc, IC_COPY1ST), (item_t)type_size(enc->sx, value.type) - 1);
+				mem_add(enc, (item_t)type_size(enc->sx, value.type));
+			}
+			else if (!type_is_array(enc->sx, value.type) && !type_is_pointer(enc->sx, value.type))
+			{
+				mem_add(enc, type_is_integer(enc->sx, value.type) ? IC_LAT : IC_LATD);
+			}
 
-		case EXPR_CAST:
-			emit_cast_expression(enc, nd);
 			return;
+		}
+	}
+}
+
+/**
+ *	Emit identifier lvalue
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return	Identifier designator
+ */
+static lvalue emit_identifier_lvalue(encoder *const enc, const node *const nd)
+{
+	const size_t identifier = expression_identifier_get_id(nd);
+	const item_t type = ident_get_type(enc->sx, identifier);
+	const item_t displ = displacements_get(enc, identifier);
+
+	return (lvalue){ .kind = VARIABLE, .type = type, .displ = displ };
+}
+
+/**
+ *	Emit subscript lvalue
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return Subscript designator
+ */
+static lvalue emit_subscript_lvalue(encoder *const enc, const node *const nd)
+{
+	const node base = expression_subscript_get_base(nd);
+	emit_expression(enc, &base);
+
+	const node index = expression_subscript_get_index(nd);
+	emit_expression(enc, &index);
+
+	mem_add(enc, IC_SLICE);
+
+	const item_t type = expression_get_type(nd);
+	mem_add(enc, (item_t)type_size(enc->sx, type));
+	if (type_is_array(enc->sx, type))
+	{
+		mem_add(enc, IC_LAT);
+	}
+
+	return (lvalue){ .kind = ADDRESS, .type = type };
+}
+
+/**
+ *	Emit member lvalue
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return	Member designator
+ */
+static lvalue emit_member_lvalue(encoder *const enc, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const node base = expression_member_get_base(nd);
+	const item_t base_type = expression_get_type(&base);
+	const bool is_arrow = expression_member_is_arrow(nd);
+	const size_t member_index = expression_member_get_member_index(nd);
+	const item_t struct_type = is_arrow ? type_pointer_get_element_type(enc->sx, base_type) : base_type;
+
+	const item_t member_displ = (item_t)type_structure_get_member_offset(enc->sx, struct_type, member_index);
+
+	if (is_arrow)
+	{
+		emit_expression(enc, &base);
+		mem_add(enc, IC_SELECT);
+		mem_add(enc, member_displ);
+		if (type_is_array(enc->sx, type) || type_is_pointer(enc->sx, type))
+		{
+			mem_add(enc, IC_LAT);
+		}
+
+		return (lvalue){ .kind = ADDRESS, .type = type };
+	}
+	else
+	{
+		const lvalue value = emit_lvalue(enc, &base);
+		if (value.kind == VARIABLE)
+		{
+			const item_t displ = value.displ > 0 ? value.displ + member_displ : value.displ - member_displ;
+			return (lvalue){ .kind = VARIABLE, .type = type, .displ = displ };
+		}
+		else // if (enc->last_kind == ADDRESS)
+		{
+			mem_add(enc, IC_SELECT);
+			mem_add(enc, member_displ);
+
+			if (type_is_array(enc->sx, type) || type_is_pointer(enc->sx, type))
+			{
+				mem_add(enc, IC_LAT);
+			}
+
+			return (lvalue){ .kind = ADDRESS, .type = type };
+		}
+	}
+}
+
+/**
+ *	Emit indirection lvalue
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return	Indirection designator
+ */
+static lvalue emit_indirection_lvalue(encoder *const enc, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const node operand = expression_unary_get_operand(nd);
+	const lvalue value = emit_lvalue(enc, &operand);
+	if (value.kind == VARIABLE)
+	{
+		mem_add_variable(enc, IC_LOAD, value.displ);
+	}
+
+	return (lvalue){ .kind = ADDRESS, .type = type };
+}
+
+/**
+ *	Emit lvalue, which address is shared by equal expressions of statement
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *	@param	number		Value number of address
+ *
+ *	@return	Lvalue designator
+ */
+static lvalue emit_shared_lvalue(encoder *const enc, const node *const nd, const size_t number)
+{
+	const item_t displ = vector_get(&enc->addresses, 2 * number);
+	if (vector_get(&enc->addresses, 2 * number + 1) == ADDRESS_SAVED)
+	{
+		mem_add_variable(enc, IC_LOAD, displ);
+		return (lvalue){ .kind = ADDRESS, .type = expression_get_type(nd) };
+	}
+
+	vector_set(&enc->addresses, 2 * number + 1, ADDRESS_COMPUTING);
+	const lvalue value = emit_lvalue(enc, nd);
+	if (value.kind == ADDRESS)
+	{
+		// Адрес остаётся на стеке для первого использования
+		mem_add_variable(enc, IC_ASSIGN, displ);
+	}
+
+	vector_set(&enc->addresses, 2 * number + 1, value.kind == ADDRESS ? ADDRESS_SAVED : ADDRESS_UNSHARED);
+	return value;
+}
+
+/**
+ *	Emit lvalue
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return	Lvalue designator
+ */
+static lvalue emit_lvalue(encoder *const enc, const node *const nd)
+{
+	const size_t number = numbering_get(&enc->numbers, nd);
+	if (number != SIZE_MAX)
+	{
+		const item_t state = vector_get(&enc->addresses, 2 * number + 1);
+		if (state == ADDRESS_PENDING || state == ADDRESS_SAVED)
+		{
+			return emit_shared_lvalue(enc, nd, number);
+		}
+	}
+
+	switch (expression_get_class(nd))
+	{
+		case EXPR_IDENTIFIER:
+			return emit_identifier_lvalue(enc, nd);
+
+		case EXPR_SUBSCRIPT:
+			return emit_subscript_lvalue(enc, nd);
+
+		case EXPR_MEMBER:
+			return emit_member_lvalue(enc, nd);
 
 		case EXPR_UNARY:
-			emit_unary_expression(enc, nd);
-			return;
+			// There can be only indirection
+			return emit_indirection_lvalue(enc, nd);
 
-		case EXPR_BINARY:
-			emit_binary_expression(enc, nd);
-			return;
+		default:
+			// Cannot be lvalue
+			system_error(node_unexpected, nd);
+			return (lvalue){ .displ = ITEM_MAX };
+	}
+}
 
-		case EXPR_TERNARY:
-			emit_ternary_expression(enc, nd);
+
+/**
+ *	Emit literal expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_literal_expression(encoder *const enc, const node *const nd)
+{
+	switch (type_get_class(enc->sx, expression_get_type(nd)))
+	{
+		case TYPE_NULL_POINTER:
+		{
+			mem_add(enc, IC_LI);
+			mem_add(enc, 0);
+			return;
+		}
+
+		case TYPE_BOOLEAN:
+		{
+			const bool value = expression_literal_get_boolean(nd);
+
+			mem_add(enc, IC_LI);
+			mem_add(enc, value ? 1 : 0);
+			return;
+		}
+
+		case TYPE_CHARACTER:
+		{
+			const char32_t value = expression_literal_get_character(nd);
+
+			mem_add(enc, IC_LI);
+			mem_add(enc, value);
+			return;
+		}
+
+		case TYPE_INTEGER:
+		case TYPE_ENUM:
+		{
+			const item_t value = (item_t)expression_literal_get_integer(nd);
+
+			mem_add(enc, IC_LI);
+			mem_add(enc, value);
+			return;
+		}
+
+		case TYPE_FLOATING:
+		{
+			const double value = expression_literal_get_floating(nd);
+
+			mem_add(enc, IC_LID);
+			mem_add_double(enc, value);
+			return;
+		}
+
+		case TYPE_ARRAY:
+		{
+			// Это может быть только строка
+			const size_t string_num = expression_literal_get_string(nd);
+			const char *const string = string_get(enc->sx, string_num);
+
+			mem_add(enc, IC_LI);
+			const size_t reserved = mem_size(enc) + 4;
+			mem_add(enc, (item_t)reserved);
+			mem_add(enc, IC_B);
+			mem_increase(enc, 2);
+
+
+			item_t length = 0;
+			for (size_t i = 0; string[i] != '\0'; i += utf8_symbol_size(string[i]))
+			{
+				mem_add(enc, utf8_convert(&string[i]));
+				length++;
+			}
+
+			mem_set(enc, reserved - 1, length);
+			mem_set(enc, reserved - 2, (item_t)mem_size(enc));
+			blocks_add_text(enc, reserved - 1);
+			return;
+		}
+
+		default:
+			// Таких литералов не бывает
+			return;
+	}
+}
+
+/**
+ *	Emit argument
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_argument(encoder *const enc, const node *const nd)
+{
+	const item_t arg_type = expression_get_type(nd);
+	if (type_is_function(enc->sx, arg_type))
+	{
+		const size_t identifier = expression_identifier_get_id(nd);
+		const item_t displ = displacements_get(enc, identifier);
+		mem_add(enc, displ >= 0 ? IC_LI : IC_LOAD);
+		mem_add(enc, abs(displ));
+	}
+	else if (expression_get_class(nd) == EXPR_INITIALIZER)
+	{
+		mem_add(enc, IC_LI);
+		const size_t reserved = mem_size(enc) + 4;
+		mem_add(enc, (item_t)reserved);
+		mem_add(enc, IC_B);
+		mem_increase(enc, 2);
+
+		const node fst = expression_initializer_get_subexpr(nd, 0);
+		const size_t size = expression_initializer_get_size(nd);
+		vector_reserve(&enc->memory, mem_size(enc) + size);
+		for (size_t i = 0; i < size; i++)
+		{
+			const node subexpr = expression_initializer_get_subexpr(nd, i);
+			if (expression_get_class(&subexpr) != EXPR_LITERAL)
+			{
+				encoder_error(enc, node_get_location(&subexpr), wrong_init_in_actparam);
+			}
+
+			if (type_is_integer(enc->sx, expression_get_type(&fst)))
+			{
+				mem_add(enc, (item_t)expression_literal_get_integer(&subexpr));
+			}
+			else
+			{
+				mem_add_double(enc, expression_literal_get_floating(&subexpr));
+			}
+		}
+
+		mem_set(enc, reserved - 1, (item_t)size);
+		mem_set(enc, reserved - 2, (item_t)mem_size(enc));
+		blocks_add(enc, reserved - 1);
+	}
+	else
+	{
+		emit_expression(enc, nd);
+	}
+}
+
+static void compress_ident(encoder *const enc, const size_t ref)
+{
+	if (vector_get(&enc->sx->identifiers, ref) == ITEM_MAX)
+	{
+		mem_add(enc, ident_get_repr(enc->sx, ref));
+		return;
+	}
+
+	const item_t name = names_get(enc, ref);
+	const item_t new_ref = (item_t)vector_size(&enc->identifiers) - 1;
+	vector_add(&enc->identifiers, name);
+	vector_add(&enc->identifiers, ident_get_type(enc->sx, ref));
+	vector_add(&enc->identifiers, displacements_get(enc, ref));
+
+	vector_set(&enc->sx->identifiers, ref, ITEM_MAX);
+	ident_set_repr(enc->sx, ref, new_ref);
+	mem_add(enc, new_ref);
+}
+
+/**
+ *	Emit printid expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_printid_expression(encoder *const enc, const node *const nd)
+{
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < argc; i++)
+	{
+		effects_add(enc, mem_add(enc, IC_PRINTID), 0);
+
+		const node arg = expression_call_get_argument(nd, i);
+		compress_ident(enc, expression_identifier_get_id(&arg)); // Ссылка в identtab
+	}
+}
+
+/**
+ *	Emit getid expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_getid_expression(encoder *const enc, const node *const nd)
+{
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < argc; i++)
+	{
+		effects_add(enc, mem_add(enc, IC_GETID), 0);
+
+		const node arg = expression_call_get_argument(nd, i);
+		compress_ident(enc, expression_identifier_get_id(&arg)); // Ссылка в identtab
+	}
+}
+
+/**
+ *	Emit printf expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_printf_expression(encoder *const enc, const node *const nd)
+{
+	size_t sum_size = 0;
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 1; i < argc; i++)
+	{
+		const node arg = expression_call_get_argument(nd, i);
+		emit_expression(enc, &arg);
+
+		sum_size += type_size(enc->sx, expression_get_type(&arg));
+	}
+
+	const node format_string = expression_call_get_argument(nd, 0);
+	emit_expression(enc, &format_string);
+
+	// Команда снимает со стека аргументы и адрес строки формата
+	effects_add(enc, mem_add(enc, IC_PRINTF), -(item_t)sum_size - 1);
+	mem_add(enc, (item_t)sum_size);
+}
+
+/**
+ *	Emit print expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_print_expression(encoder *const enc, const node *const nd)
+{
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < argc; i++)
+	{
+		const node arg = expression_call_get_argument(nd, i);
+		emit_expression(enc, &arg);
+
+		effects_add(enc, mem_add(enc, IC_PRINT), -(item_t)type_size(enc->sx, expression_get_type(&arg)));
+		mem_add(enc, expression_get_type(&arg));
+	}
+}
+
+/**
+ *	Get definition of function, which call is expanded inline in current function
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Call expression
+ *
+ *	@return	Function definition, broken node if call is not expanded
+ */
+static node inline_get_definition(const encoder *const enc, const node *const nd)
+{
+	return enc->is_inlining && enc->curr_func != NULL ? inliner_get_definition(&enc->inl, nd) : node_broken();
+}
+
+/**
+ *	Emit inline expansion of call, parameters of callee are allocated in current frame
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Call expression
+ *	@param	definition	Callee definition
+ *	@param	is_void		Set, if value of call is not used
+ */
+static void emit_inline_call(encoder *const enc, const node *const nd, const node *const definition, const bool is_void)
+{
+	const item_t scope_displacement = enc->displ;
+
+	// Параметры размещаются после вычисления всех аргументов, которые сами могут быть подставлены
+	const size_t args = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < args; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		emit_expression(enc, &argument);
+	}
+
+	for (size_t i = 0; i < args; i++)
+	{
+		displacements_add(enc, declaration_function_get_parameter(definition, i), false);
+	}
+
+	for (size_t i = args; i > 0; i--)
+	{
+		const size_t parameter = declaration_function_get_parameter(definition, i - 1);
+		mem_add_variable(enc, type_is_floating(ident_get_type(enc->sx, parameter)) ? IC_ASSIGN_R_V : IC_ASSIGN_V
+			, displacements_get(enc, parameter));
+	}
+
+	const node body = declaration_function_get_body(definition);
+	const size_t size = statement_compound_get_size(&body);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node substmt = statement_compound_get_substmt(&body, i);
+		if (statement_get_class(&substmt) != STMT_RETURN)
+		{
+			emit_statement(enc, &substmt);
+		}
+		else if (statement_return_has_expression(&substmt))
+		{
+			// Значение последнего оператора возврата остаётся на стеке как значение вызова
+			const node expr = statement_return_get_expression(&substmt);
+			if (is_void)
+			{
+				emit_void_expression(enc, &expr);
+			}
+			else
+			{
+				emit_expression(enc, &expr);
+			}
+		}
+	}
+
+	enc->displ = scope_displacement;
+}
+
+/**
+ *	Emit call expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_call_expression(encoder *const enc, const node *const nd)
+{
+	const node callee = expression_call_get_callee(nd);
+	const size_t func = expression_identifier_get_id(&callee);
+
+	switch (func)
+	{
+		case BI_PRINTF:
+			emit_printf_expression(enc, nd);
+			return;
+		case BI_PRINT:
+			emit_print_expression(enc, nd);
+			return;
+		case BI_PRINTID:
+			emit_printid_expression(enc, nd);
+			return;
+		case BI_GETID:
+			emit_getid_expression(enc, nd);
+			return;
+	}
+
+	const node definition = inline_get_definition(enc, nd);
+	if (node_is_correct(&definition))
+	{
+		emit_inline_call(enc, nd, &definition, false);
+		return;
+	}
+
+	if (func >= BEGIN_USER_FUNC)
+	{
+		mem_add(enc, IC_CALL1);
+	}
+
+	// Вызов снимает со стека аргументы и кладёт результат
+	const item_t type = expression_get_type(nd);
+	item_t effect = type_is_void(type) ? 0 : (item_t)type_size(enc->sx, type);
+
+	const size_t args = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < args; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		emit_argument(enc, &argument);
+		effect -= (item_t)type_size(enc->sx, expression_get_type(&argument));
+	}
+
+	if (func >= BEGIN_USER_FUNC)
+	{
+		effects_add(enc, mem_add(enc, IC_CALL2), effect);
+		mem_add(enc, functions_get(enc, func));
+	}
+	else
+	{
+		effects_add(enc, mem_add(enc, builtin_to_instruction((builtin_t)func)), effect);
+	}
+}
+
+/**
+ *	Emit call in return statement, which reuses frame of current function.
+ *	Arguments are put on stack as for usual call, then they replace parameters.
+ *	Only extended virtual machine has this instruction.
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_tail_call(encoder *const enc, const node *const nd)
+{
+	const node callee = expression_call_get_callee(nd);
+	const size_t func = expression_identifier_get_id(&callee);
+	item_t size = 0;
+
+	const size_t args = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < args; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		emit_argument(enc, &argument);
+		size += (item_t)type_size(enc->sx, expression_get_type(&argument));
+	}
+
+	mem_add(enc, IC_TAIL_CALL);
+	mem_add(enc, functions_get(enc, func));
+	mem_add(enc, size);
+}
+
+/**
+ *	Emit rvalue of member expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_member_expression(encoder *const enc, const node *const nd)
+{
+	// Member expression может выдать rvalue только в одном случае: слева rvalue и оператор '.'
+	const node base = expression_member_get_base(nd);
+	emit_expression(enc, &base);
+
+	const item_t base_type = expression_get_type(&base);
+	const size_t member_index = expression_member_get_member_index(nd);
+
+	const size_t member_displ = type_structure_get_member_offset(enc->sx, base_type, member_index);
+
+	// Структура на стеке заменяется своим полем
+	const item_t effect = (item_t)type_size(enc->sx, expression_get_type(nd)) - (item_t)type_size(enc->sx, base_type);
+	effects_add(enc, mem_add(enc, IC_COPYST), effect);
+	mem_add(enc, (item_t)member_displ);
+	mem_add(enc, (item_t)type_size(enc->sx, expression_get_type(nd)));
+	mem_add(enc, (item_t)type_size(enc->sx, base_type));
+}
+
+/**
+ *	Emit cast expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_cast_expression(encoder *const enc, const node *const nd)
+{
+	const node subexpr = expression_cast_get_operand(nd);
+	emit_expression(enc, &subexpr);
+
+	const item_t target_type = expression_get_type(nd);
+	const item_t source_type = expression_get_type(&subexpr);
+
+	// Необходимо только преобразование 'int' -> 'float'
+	if (type_is_integer(enc->sx, source_type) && type_is_floating(target_type))
+	{
+		mem_add(enc, IC_WIDEN);
+	}
+}
+
+/**
+ *	Emit increment expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_increment_expression(encoder *const enc, const node *const nd)
+{
+	const node operand = expression_unary_get_operand(nd);
+	const lvalue value = emit_lvalue(enc, &operand);
+
+	const unary_t op = expression_unary_get_operator(nd);
+	instruction_t instruction = unary_to_instruction(op);
+
+	if (value.kind == ADDRESS)
+	{
+		instruction = instruction_to_address_ver(instruction);
+	}
+
+	if (type_is_floating(expression_get_type(nd)))
+	{
+		instruction = instruction_to_floating_ver(instruction);
+	}
+
+	if (value.kind == VARIABLE)
+	{
+		mem_add_variable(enc, instruction, value.displ);
+	}
+	else
+	{
+		mem_add(enc, instruction);
+	}
+}
+
+/**
+ *	Emit unary expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_unary_expression(encoder *const enc, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const unary_t operator = expression_unary_get_operator(nd);
+	const node operand = expression_unary_get_operand(nd);
+	switch (operator)
+	{
+		case UN_POSTINC:
+		case UN_POSTDEC:
+		case UN_PREINC:
+		case UN_PREDEC:
+			emit_increment_expression(enc, nd);
+			return;
+
+		case UN_ADDRESS:
+		{
+			const lvalue value = emit_lvalue(enc, &operand);
+			if (value.kind == VARIABLE)
+			{
+				mem_add_variable(enc, IC_LA, value.displ);
+			}
+
+			return;
+		}
+
+		case UN_INDIRECTION:
+			// Unreachable
+			return;
+
+		case UN_MINUS:
+			emit_expression(enc, &operand);
+			mem_add(enc, type_is_integer(enc->sx, type) ? IC_UNMINUS : IC_UNMINUS_R);
+			return;
+
+		case UN_NOT:
+			emit_expression(enc, &operand);
+			mem_add(enc, IC_NOT);
+			return;
+
+		case UN_LOGNOT:
+			emit_expression(enc, &operand);
+			mem_add(enc, IC_LOG_NOT);
+			return;
+
+		case UN_ABS:
+			emit_expression(enc, &operand);
+			mem_add(enc, type_is_integer(enc->sx, type) ? IC_ABSI : IC_ABS);
+			return;
+
+		case UN_UPB:
+		{
+			mem_add(enc, IC_LI);
+			mem_add(enc, 0);
+
+			emit_expression(enc, &operand);
+			mem_add(enc, IC_UPB);
+			return;
+		}
+	}
+}
+
+/**
+ *	Emit binary expression of vectors
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_vector_expression(encoder *const enc, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const item_t element_type = type_vector_get_element_type(enc->sx, type);
+	const item_t size = (item_t)type_size(enc->sx, type);
+	const item_t lane = (item_t)type_size(enc->sx, element_type);
+
+	// В ВМ нет векторных команд, поэтому операнды кладутся в переменные,
+	// а результат собирается на стеке из покомпонентных операций
+	const node operands[] = { expression_binary_get_LHS(nd), expression_binary_get_RHS(nd) };
+	item_t displs[2];
+	for (size_t i = 0; i < 2; i++)
+	{
+		if (expression_is_lvalue(&operands[i]))
+		{
+			const lvalue value = emit_lvalue(enc, &operands[i]);
+			if (value.kind == VARIABLE)
+			{
+				// Компоненты переменной загружаются без копирования
+				displs[i] = value.displ;
+				continue;
+			}
+
+			emit_load_of_lvalue(enc, value);
+		}
+		else
+		{
+			emit_expression(enc, &operands[i]);
+		}
+
+		displs[i] = displacements_reserve(enc, size);
+		effects_add(enc, mem_add(enc, IC_COPY0ST_ASSIGN), -size);
+		mem_add(enc, displs[i]);
+		mem_add(enc, size);
+	}
+
+	const instruction_t instruction = binary_to_instruction(expression_binary_get_operator(nd));
+	for (item_t offset = 0; offset < size; offset += lane)
+	{
+		for (size_t i = 0; i < 2; i++)
+		{
+			mem_add_variable(enc, type_is_floating(element_type) ? IC_LOADD : IC_LOAD
+				, displs[i] > 0 ? displs[i] + offset : displs[i] - offset);
+		}
+
+		mem_add(enc, type_is_floating(element_type) ? instruction_to_floating_ver(instruction) : instruction);
+	}
+}
+
+/**
+ *	Emit binary expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_binary_expression(encoder *const enc, const node *const nd)
+{
+	const binary_t operator = expression_binary_get_operator(nd);
+	const node LHS = expression_binary_get_LHS(nd);
+	const node RHS = expression_binary_get_RHS(nd);
+	if (operator == BIN_COMMA)
+	{
+		emit_void_expression(enc, &LHS);
+		emit_expression(enc, &RHS);
+	}
+	else if (type_is_vector(enc->sx, expression_get_type(nd)))
+	{
+		emit_vector_expression(enc, nd);
+	}
+	else
+	{
+		emit_expression(enc, &LHS);
+
+		size_t addr = SIZE_MAX;
+		const bool is_logical = operator == BIN_LOG_AND || operator == BIN_LOG_OR;
+		if (is_logical)
+		{
+			mem_add(enc, IC_DUPLICATE);
+			addr = mem_add_jump(enc, operator == BIN_LOG_AND ? IC_BE0 : IC_BNE0, 0);
+		}
+
+		emit_expression(enc, &RHS);
+
+		if (is_logical)
+		{
+			mem_set(enc, addr, (item_t)mem_size(enc) + 1);
+		}
+
+		const instruction_t instruction = binary_to_instruction(operator);
+		if (type_is_floating(expression_get_type(&LHS)))
+		{
+			mem_add(enc, instruction_to_floating_ver(instruction));
+		}
+		else
+		{
+			mem_add(enc, instruction);
+		}
+	}
+}
+
+/**
+ *	Emit ternary expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_ternary_expression(encoder *const enc, const node *const nd)
+{
+	const node condition = expression_ternary_get_condition(nd);
+	emit_expression(enc, &condition);
+
+	size_t addr = mem_add_jump(enc, IC_BE0, 0);
+
+	const node LHS = expression_ternary_get_LHS(nd);
+	emit_expression(enc, &LHS);
+
+	mem_set(enc, addr, (item_t)mem_size(enc) + 2);
+	addr = mem_add_jump(enc, IC_B, 0);
+
+	const node RHS = expression_ternary_get_RHS(nd);
+	emit_expression(enc, &RHS);
+
+	mem_set(enc, addr, (item_t)mem_size(enc));
+}
+
+/**
+ *	Emit assignment expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_assignment_expression(encoder *const enc, const node *const nd)
+{
+	const node LHS = expression_assignment_get_LHS(nd);
+	const lvalue value = emit_lvalue(enc, &LHS);
+
+	const node RHS = expression_assignment_get_RHS(nd);
+	emit_expression(enc, &RHS);
+
+	const item_t type = expression_get_type(nd);
+	if (type_is_structure(enc->sx, type))
+	{
+		const item_t size = (item_t)type_size(enc->sx, type);
+		if (value.kind == VARIABLE)
+		{
+			effects_add(enc, mem_add(enc, IC_COPY0ST_ASSIGN), -size);
+			mem_add(enc, value.displ);
+		}
+		else
+		{
+			effects_add(enc, mem_add(enc, IC_COPY1ST_ASSIGN), -size - 1);
+		}
+
+		mem_add(enc, (item_t)type_size(enc->sx, type));
+	}
+	else // Скалярное присваивание
+	{
+		const binary_t op = expression_assignment_get_operator(nd);
+		instruction_t instruction = binary_to_instruction(op);
+		if (value.kind == ADDRESS)
+		{
+			instruction = instruction_to_address_ver(instruction);
+		}
+
+		if (type_is_floating(type))
+		{
+			instruction = instruction_to_floating_ver(instruction);
+		}
+
+		if (value.kind == VARIABLE)
+		{
+			mem_add_variable(enc, instruction, value.displ);
+		}
+		else
+		{
+			mem_add(enc, instruction);
+		}
+	}
+}
+
+/**
+ *	Emit initializer
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_initializer(encoder *const enc, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const size_t size = expression_initializer_get_size(nd);
+
+	if (type_is_array(enc->sx, type))
+	{
+		mem_add(enc, IC_BEG_INIT);
+		mem_add(enc, (item_t)size);
+	}
+
+	if (expression_initializer_is_packed(nd))
+	{
+		// Значения загружаются так же, как литералы
+		const bool is_floating = type_is_floating(expression_initializer_get_literal_type(nd));
+		vector_reserve(&enc->memory, mem_size(enc) + size * (is_floating ? 1 + DOUBLE_SIZE : 2));
+		for (size_t i = 0; i < size; i++)
+		{
+			if (is_floating)
+			{
+				mem_add(enc, IC_LID);
+				mem_add_double(enc, expression_initializer_get_floating(nd, i));
+			}
+			else
+			{
+				mem_add(enc, IC_LI);
+				mem_add(enc, (item_t)expression_initializer_get_integer(nd, i));
+			}
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		const node subexpr = expression_initializer_get_subexpr(nd, i);
+		emit_expression(enc, &subexpr);
+	}
+}
+
+/**
+ *	Emit expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_expression(encoder *const enc, const node *const nd)
+{
+	const item_t temporary = hash_get(&enc->temporaries, (item_t)nd->index, 0);
+	if (temporary != ITEM_MAX)
+	{
+		mem_add_variable(enc, type_is_floating(expression_get_type(nd)) ? IC_LOADD : IC_LOAD, temporary);
+		return;
+	}
+
+	if (expression_is_lvalue(nd))
+	{
+		const lvalue value = emit_lvalue(enc, nd);
+		emit_load_of_lvalue(enc, value);
+		return;
+	}
+
+	switch (expression_get_class(nd))
+	{
+		case EXPR_LITERAL:
+			emit_literal_expression(enc, nd);
+			return;
+
+		case EXPR_CALL:
+			emit_call_expression(enc, nd);
+			return;
+
+		case EXPR_MEMBER:
+			emit_member_expression(enc, nd);
+			return;
+
+		case EXPR_CAST:
+			emit_cast_expression(enc, nd);
+			return;
+
+		case EXPR_UNARY:
+			emit_unary_expression(enc, nd);
+			return;
+
+		case EXPR_BINARY:
+			emit_binary_expression(enc, nd);
+			return;
+
+		case EXPR_TERNARY:
+			emit_ternary_expression(enc, nd);
+			return;
+
+		case EXPR_ASSIGNMENT:
+			emit_assignment_expression(enc, nd);
+			return;
+
+		case EXPR_INITIALIZER:
+			emit_initializer(enc, nd);
+			return;
+
+		default:
+			// Cannot be rvalue
+			return;
+	}
+}
+
+/**
+ *	Emit expression which will be evaluated as a void expression
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_void_expression(encoder *const enc, const node *const nd)
+{
+	const node definition = expression_get_class(nd) == EXPR_CALL ? inline_get_definition(enc, nd) : node_broken();
+	if (node_is_correct(&definition))
+	{
+		emit_inline_call(enc, nd, &definition, true);
+	}
+	else if (expression_is_lvalue(nd))
+	{
+		emit_lvalue(enc, nd);
+	}
+	else
+	{
+		emit_expression(enc, nd);
+
+		const size_t index = mem_get(enc, mem_size(enc) - 1) < MIN_INSTRUCTION_CODE
+			? mem_size(enc) - 2
+			: mem_size(enc) - 1;
+
+		const instruction_t operation = (instruction_t)mem_get(enc, index);
+		mem_set(enc, index, instruction_to_void_ver(operation));
+	}
+}
+
+
+/*
+ *	 _____     ______     ______     __         ______     ______     ______     ______   __     ______     __   __     ______
+ *	/\  __-.  /\  ___\   /\  ___\   /\ \       /\  __ \   /\  == \   /\  __ \   /\__  _\ /\ \   /\  __ \   /\ "-.\ \   /\  ___\
+ *	\ \ \/\ \ \ \  __\   \ \ \____  \ \ \____  \ \  __ \  \ \  __<   \ \  __ \  \/_/\ \/ \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
+ *	 \ \____-  \ \_____\  \ \_____\  \ \_____\  \ \_\ \_\  \ \_\ \_\  \ \_\ \_\    \ \_\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
+ *	  \/____/   \/_____/   \/_____/   \/_____/   \/_/\/_/   \/_/ /_/   \/_/\/_/     \/_/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+ */
+
+
+/**
+ *	Check that there are only strings in array initializer
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Initializer
+ *
+ *	@return @c 1 on true, @c 0 on false
+ */
+static bool only_strings(const encoder *const enc, const node *const nd)
+{
+	switch (expression_get_class(nd))
+	{
+		case EXPR_LITERAL:
+			return type_is_string(enc->sx, expression_get_type(nd));
+
+		case EXPR_INITIALIZER:
+		{
+			if (expression_initializer_is_packed(nd))
+			{
+				return false;
+			}
+
+			const size_t size = expression_initializer_get_size(nd);
+			for (size_t i = 0; i < size; i++)
+			{
+				const node subexpr = expression_initializer_get_subexpr(nd, i);
+				if (!only_strings(enc, &subexpr))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/**
+ *	Check that initializer is a literal of arithmetic or boolean type
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Initializer
+ *
+ *	@return @c 1 on true, @c 0 on false
+ */
+static bool is_constant_initializer(const encoder *const enc, const node *const nd)
+{
+	if (expression_get_class(nd) != EXPR_LITERAL)
+	{
+		return false;
+	}
+
+	const item_t type = expression_get_type(nd);
+	return type_is_arithmetic(enc->sx, type) || type_is_boolean(type);
+}
+
+/**
+ *	Add floating value to data table
+ *
+ *	@param	enc			Encoder
+ *	@param	value		Value
+ *	@param	type		Type of variable
+ */
+static void data_add_floating(encoder *const enc, const double value, const item_t type)
+{
+	item_t buffer[8];
+	const size_t size = item_store_double_for_target(enc->target, value, buffer);
+	vector_append(&enc->data, buffer, size);
+
+	// Вещественное значение занимает столько же, сколько в таблице глобальных переменных
+	vector_increase(&enc->data, type_size(enc->sx, type) - size);
+}
+
+/**
+ *	Add value of literal to data table
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Literal
+ *	@param	type		Type of variable
+ */
+static void data_add_literal(encoder *const enc, const node *const nd, const item_t type)
+{
+	const item_t value_type = expression_get_type(nd);
+	if (type_is_floating(type))
+	{
+		data_add_floating(enc, type_is_floating(value_type)
+			? expression_literal_get_floating(nd)
+			: (double)expression_literal_get_integer(nd), type);
+	}
+	else if (type_is_boolean(value_type))
+	{
+		vector_add(&enc->data, expression_literal_get_boolean(nd) ? 1 : 0);
+	}
+	else if (value_type == TYPE_CHARACTER)
+	{
+		vector_add(&enc->data, (item_t)expression_literal_get_character(nd));
+	}
+	else
+	{
+		vector_add(&enc->data, (item_t)expression_literal_get_integer(nd));
+	}
+}
+
+/**
+ *	Add global variable with constant initializer to data table instead of init code.
+ *	Record consists of variable displacement, number of array elements or @c 0 for scalar,
+ *	element size and values. Only extended virtual machine reads this table.
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return @c 1 on success, @c 0 if initializer needs code
+ */
+static bool data_add_declaration(encoder *const enc, const node *const nd)
+{
+	if (!enc->is_extended || enc->curr_func != NULL || !declaration_variable_has_initializer(nd))
+	{
+		return false;
+	}
+
+	const size_t identifier = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(enc->sx, identifier);
+	const node initializer = declaration_variable_get_initializer(nd);
+	size_t elements = 0;
+	item_t element_type = type;
+
+	if (type_is_array(enc->sx, type))
+	{
+		// Поддерживаются одномерные массивы, границу которых не нужно проверять во время исполнения
+		element_type = type_array_get_element_type(enc->sx, type);
+		const node bound = declaration_variable_get_bound(nd, 0);
+		if (type_is_array(enc->sx, element_type) || expression_get_class(&initializer) != EXPR_INITIALIZER)
+		{
+			return false;
+		}
+
+		elements = expression_initializer_get_size(&initializer);
+		if (expression_get_class(&bound) != EXPR_EMPTY_BOUND && (expression_get_class(&bound) != EXPR_LITERAL
+			|| expression_literal_get_integer(&bound) != (int64_t)elements))
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < elements && !expression_initializer_is_packed(&initializer); i++)
+		{
+			const node subexpr = expression_initializer_get_subexpr(&initializer, i);
+			if (!is_constant_initializer(enc, &subexpr))
+			{
+				return false;
+			}
+		}
+	}
+	else if (!is_constant_initializer(enc, &initializer))
+	{
+		return false;
+	}
+
+	if (!type_is_arithmetic(enc->sx, element_type) && !type_is_boolean(element_type))
+	{
+		return false;
+	}
+
+	vector_add(&enc->data, displacements_add(enc, identifier, false));
+	vector_add(&enc->data, (item_t)elements);
+	vector_add(&enc->data, (item_t)type_size(enc->sx, element_type));
+
+	if (elements == 0)
+	{
+		data_add_literal(enc, &initializer, type);
+	}
+
+	if (elements != 0 && expression_initializer_is_packed(&initializer))
+	{
+		// Упакованные значения уже приведены к типу элементов
+		for (size_t i = 0; i < elements; i++)
+		{
+			if (type_is_floating(element_type))
+			{
+				data_add_floating(enc, expression_initializer_get_floating(&initializer, i), element_type);
+			}
+			else
+			{
+				vector_add(&enc->data, (item_t)expression_initializer_get_integer(&initializer, i));
+			}
+		}
+		return true;
+	}
+
+	for (size_t i = 0; i < elements; i++)
+	{
+		const node subexpr = expression_initializer_get_subexpr(&initializer, i);
+		data_add_literal(enc, &subexpr, element_type);
+	}
+
+	return true;
+}
+
+/**
+ *	Emit array declaration
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_array_declaration(encoder *const enc, const node *const nd)
+{
+	const size_t identifier = declaration_variable_get_id(nd);
+	item_t type = ident_get_type(enc->sx, identifier);
+	item_t dimensions = 0;
+	item_t bounds = 0;
+	bool has_empty_bounds = false;
+
+	while (type_is_array(enc->sx, type))
+	{
+		type = type_array_get_element_type(enc->sx, type);
+		const node bound = declaration_variable_get_bound(nd, (size_t)dimensions);
+		if (expression_get_class(&bound) == EXPR_EMPTY_BOUND)
+		{
+			if (type_is_array(enc->sx, type))
+			{
+				encoder_error(enc, node_get_location(&bound), empty_init);
+			}
+
+			has_empty_bounds = true;
+		}
+		else
+		{
+			emit_expression(enc, &bound);
+			bounds++;
+		}
+
+		dimensions++;
+	}
+
+	const bool has_initializer = declaration_variable_has_initializer(nd);
+	const item_t length = (item_t)type_size(enc->sx, type);
+	const item_t displ = displacements_add(enc, identifier, false);
+	const item_t iniproc = proc_get(enc, (size_t)type);
+
+	effects_add(enc, mem_add(enc, IC_DEFARR), -bounds);	// DEFARR N, d, displ, iniproc, usual N1...NN, уже лежат на стеке
+	mem_add(enc, has_initializer ? dimensions - 1 : dimensions);
+	mem_add(enc, length);
+	mem_add(enc, displ);
+	mem_add(enc, iniproc && iniproc != ITEM_MAX ? iniproc : 0);
+
+	const size_t usual_addr = mem_size(enc);
+	item_t usual = has_empty_bounds ? 0 : 1;
+	mem_add(enc, usual);
+
+	mem_add(enc, has_initializer);
+	mem_add(enc, 0);				// is in structure
+
+	if (has_initializer)
+	{
+		const node initializer = declaration_variable_get_initializer(nd);
+		emit_expression(enc, &initializer);
+
+		if (only_strings(enc, &initializer))
+		{
+			usual += 2;
+			mem_set(enc, usual_addr, usual);
+		}
+
+		mem_add(enc, IC_ARR_INIT);
+		mem_add(enc, dimensions);
+		mem_add(enc, length);
+		mem_add(enc, displ);
+		mem_add(enc, usual);
+	}
+}
+
+/**
+ *	Emit variable declaration
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_variable_declaration(encoder *const enc, const node *const nd)
+{
+	if (data_add_declaration(enc, nd))
+	{
+		return;
+	}
+
+	const size_t identifier = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(enc->sx, identifier);
+	if (type_is_array(enc->sx, type))
+	{
+		emit_array_declaration(enc, nd);
+		return;
+	}
+
+	const item_t displ = displacements_add(enc, identifier, false);
+	const item_t iniproc = proc_get(enc, (size_t)type);
+	if (iniproc != ITEM_MAX && iniproc != 0)
+	{
+		effects_add(enc, mem_add(enc, IC_STRUCT_WITH_ARR), 0);
+		mem_add(enc, displ);
+		mem_add(enc, iniproc);
+	}
+
+	if (declaration_variable_has_initializer(nd))
+	{
+		const node initializer = declaration_variable_get_initializer(nd);
+		emit_expression(enc, &initializer);
+
+		if (type_is_structure(enc->sx, type))
+		{
+			effects_add(enc, mem_add(enc, IC_COPY0ST_ASSIGN), -(item_t)type_size(enc->sx, type));
+			mem_add(enc, displ);
+			mem_add(enc, (item_t)type_size(enc->sx, type));
+		}
+		else
+		{
+			mem_add_variable(enc, type_is_floating(type) ? IC_ASSIGN_R_V : IC_ASSIGN_V, displ);
+		}
+	}
+}
+
+/**
+ *	Emit member declaration
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ *	@param	displ		Member displacement
+ */
+static void emit_member_declaration(encoder *const enc, const node *const nd, const item_t displ)
+{
+	item_t member_type = declaration_member_get_type(nd);
+	if (!type_is_array(enc->sx, member_type))
+	{
+		return;
+	}
+
+	while (type_is_array(enc->sx, member_type))
+	{
+		member_type = type_array_get_element_type(enc->sx, member_type);
+	}
+
+	const size_t bounds = declaration_member_get_bounds_amount(nd);
+	for (size_t i = 0; i < bounds; i++)
+	{
+		const node bound = declaration_member_get_bound(nd, i);
+		emit_expression(enc, &bound);
+	}
+
+	const size_t length = type_size(enc->sx, member_type);
+	const item_t iniproc = proc_get(enc, (size_t)member_type);
+
+	effects_add(enc, mem_add(enc, IC_DEFARR), -(item_t)bounds);	// DEFARR N, d, displ, iniproc, usual N1...NN, уже лежат на стеке
+	mem_add(enc, (item_t)bounds);
+	mem_add(enc, (item_t)length);
+	mem_add(enc, (item_t)displ);
+	mem_add(enc, iniproc && iniproc != ITEM_MAX ? iniproc : 0);
+	mem_add(enc, 1);				// usual
+	mem_add(enc, 0);				// has initializer
+	mem_add(enc, 1);				// is in structure
+}
+
+/**
+ *	Emit struct declaration
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_struct_declaration(encoder *const enc, const node *const nd)
+{
+	const item_t type = declaration_struct_get_type(nd);
+	const size_t members = type_structure_get_member_amount(enc->sx, type);
+
+	bool has_arrays = false;
+	for (size_t i = 0; i < members; i++)
+	{
+		const item_t member_type = type_structure_get_member_type(enc->sx, type, i);
+		if (type_is_array(enc->sx, member_type))
+		{
+			has_arrays = true;
+		}
+	}
+
+	if (!has_arrays)
+	{
+		return;
+	}
+
+	const size_t addr = mem_add_jump(enc, IC_B, 0);
+
+	proc_set(enc, (size_t)type, (item_t)addr + 1);
+
+	item_t displ = 0;
+	const size_t size = declaration_struct_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node member = declaration_struct_get_member(nd, i);
+		if (declaration_get_class(&member) == DECL_MEMBER)
+		{
+			emit_member_declaration(enc, &member, displ);
+			displ += type_size(enc->sx, declaration_member_get_type(&member));
+		}
+		else
+		{
+			emit_declaration(enc, &member);
+		}
+	}
+
+	mem_add(enc, IC_STOP);
+	mem_set(enc, addr, (item_t)mem_size(enc));
+}
+
+static int find_user_call(void *const context, const node *const nd)
+{
+	// Подставляемые функции сами не вызывают пользовательских функций
+	function_properties *const properties = context;
+	const node callee = expression_call_get_callee(nd);
+	const node definition = inline_get_definition(properties->enc, nd);
+	if ((expression_get_class(&callee) != EXPR_IDENTIFIER || expression_identifier_get_id(&callee) >= BEGIN_USER_FUNC)
+		&& !node_is_correct(&definition))
+	{
+		properties->is_leaf = false;
+	}
+
+	return 0;
+}
+
+static int find_address(void *const context, const node *const nd)
+{
+	function_properties *const properties = context;
+	if (expression_unary_get_operator(nd) == UN_ADDRESS)
+	{
+		properties->has_escapes = true;
+		properties->has_addresses = true;
+	}
+
+	return 0;
+}
+
+static int find_frame_allocation(void *const context, const node *const nd)
+{
+	// Массивы и структуры с массивами размещаются за кадром функции
+	function_properties *const properties = context;
+	const item_t type = ident_get_type(properties->enc->sx, declaration_variable_get_id(nd));
+	const item_t iniproc = type_is_structure(properties->enc->sx, type) ? proc_get(properties->enc, (size_t)type) : 0;
+	if (type_is_array(properties->enc->sx, type) || (iniproc != 0 && iniproc != ITEM_MAX))
+	{
+		properties->has_escapes = true;
+	}
+
+	return 0;
+}
+
+/**
+ *	Get properties of function body for call optimizations
+ *
+ *	@param	enc			Encoder
+ *	@param	body		Function body
+ *
+ *	@return	Function properties
+ */
+static function_properties function_get_properties(const encoder *const enc, const node *const body)
+{
+	function_properties properties = { .enc = enc, .is_leaf = true, .has_escapes = false, .has_addresses = false };
+	visitor vis = visitor_create(&properties);
+	visitor_set(&vis, OP_CALL, &find_user_call, NULL);
+	visitor_set(&vis, OP_UNARY, &find_address, NULL);
+	visitor_set(&vis, OP_DECL_VAR, &find_frame_allocation, NULL);
+
+	visitor_walk(&vis, body);
+	visitor_clear(&vis);
+
+	return properties;
+}
+
+/**
+ *	Get execution counter of function or its block from profile
+ *
+ *	@param	enc			Encoder
+ *	@param	func		Function identifier
+ *	@param	nd			Statement of block, @c NULL for function entry
+ *
+ *	@return	Counter value, @c ITEM_MAX if it is absent
+ */
+static item_t profile_get(encoder *const enc, const size_t func, const node *const nd)
+{
+	char key[MAX_PROFILE_KEY];
+	const char *const spelling = ident_get_spelling(enc->sx, func);
+	if (nd == NULL)
+	{
+		snprintf(key, MAX_PROFILE_KEY, "%s", spelling);
+	}
+	else
+	{
+		const comment cmt = cmt_index_search(enc->index, node_get_location(nd).begin);
+		snprintf(key, MAX_PROFILE_KEY, "%s:%zu", spelling, cmt_get_line(&cmt));
+	}
+
+	return map_get(&enc->profile, key);
+}
+
+static int stop_on_jump(void *const context, const node *const nd)
+{
+	(void)nd;
+	bool *const is_movable = context;
+	*is_movable = false;
+	return -1;
+}
+
+/**
+ *	Check that statement was never executed in profile and can be moved to the end of function
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Statement
+ *
+ *	@return	@c true on cold statement, @c false otherwise
+ */
+static bool is_cold_statement(encoder *const enc, const node *const nd)
+{
+	if (!enc->is_profiled || enc->curr_func == NULL)
+	{
+		return false;
+	}
+
+	const size_t func = declaration_function_get_id(enc->curr_func);
+	const item_t entries = profile_get(enc, func, NULL);
+	if (entries == 0 || entries == ITEM_MAX || profile_get(enc, func, nd) != 0)
+	{
+		return false;
+	}
+
+	// Тела подставленных функций остаются на месте, так как их параметры размещаются заново при каждой подстановке
+	node parent = node_get_parent(nd);
+	while (node_is_correct(&parent) && node_get_type(&parent) != OP_FUNC_DEF)
+	{
+		parent = node_get_parent(&parent);
+	}
+
+	if (!node_is_correct(&parent) || parent.index != enc->curr_func->index)
+	{
+		return false;
+	}
+
+	// Переходы из перенесённого оператора потеряли бы свои циклы и переключатели
+	bool is_movable = true;
+	visitor vis = visitor_create(&is_movable);
+	visitor_set(&vis, OP_BREAK, &stop_on_jump, NULL);
+	visitor_set(&vis, OP_CONTINUE, &stop_on_jump, NULL);
+	visitor_set(&vis, OP_CASE, &stop_on_jump, NULL);
+	visitor_set(&vis, OP_DEFAULT, &stop_on_jump, NULL);
+
+	visitor_walk(&vis, nd);
+	visitor_clear(&vis);
+
+	return is_movable;
+}
+
+/**
+ *	Add cold statement, which is emitted at the end of function
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Statement
+ *	@param	addr		Address of jump to statement
+ */
+static void cold_add(encoder *const enc, const node *const nd, const size_t addr)
+{
+	vector_add(&enc->cold, (item_t)node_save(nd));
+	vector_add(&enc->cold, (item_t)addr);
+	vector_add(&enc->cold, (item_t)mem_size(enc));
+	vector_add(&enc->cold, enc->displ);
+}
+
+/**
+ *	Emit cold statements of function, each one jumps back after execution
+ *
+ *	@param	enc			Encoder
+ */
+static void emit_cold_statements(encoder *const enc)
+{
+	// Перенесённые операторы могут добавлять свои холодные ветви
+	for (size_t i = 0; i < vector_size(&enc->cold); i += 4)
+	{
+		const node nd = node_load(&enc->sx->tree, (size_t)vector_get(&enc->cold, i));
+		mem_set(enc, (size_t)vector_get(&enc->cold, i + 1), (item_t)mem_size(enc));
+		enc->displ = vector_get(&enc->cold, i + 3);
+		vector_resize(&enc->slots, 0);
+
+		emit_statement(enc, &nd);
+		mem_add_jump(enc, IC_B, vector_get(&enc->cold, i + 2));
+	}
+
+	vector_resize(&enc->cold, 0);
+}
+
+/**
+ *	Emit function definition
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_function_definition(encoder *const enc, const node *const nd)
+{
+	const size_t identifier = declaration_function_get_id(nd);
+	functions_add(enc, identifier, mem_size(enc));
+	const size_t number = vector_size(&enc->functions) - 1;
+
+	// Смещения локальных переменных прошлой функции больше не нужны
+	hash_clear(&enc->locals);
+	enc->locals = hash_create(0);
+
+	enc->curr_func = nd;
+	enc->displ = DISPL_START;
+	enc->max_local_displ = enc->displ;
+
+	const size_t parameters_amount = declaration_function_get_parameters_amount(nd);
+	for (size_t i = 0; i < parameters_amount; i++)
+	{
+		const size_t parameter = declaration_function_get_parameter(nd, i);
+		displacements_add(enc, parameter, true);
+	}
+
+	const node function_body = declaration_function_get_body(nd);
+	const function_properties properties = function_get_properties(enc, &function_body);
+	enc->has_escapes = properties.has_escapes;
+	enc->has_addresses = properties.has_addresses;
+
+	// Листовые функции понимает только расширенная виртуальная машина
+	mem_add(enc, enc->is_extended && properties.is_leaf ? IC_FUNC_BEG_LEAF : IC_FUNC_BEG);
+
+	const size_t displ_addr = mem_reserve(enc);
+	const size_t jump_addr = mem_reserve(enc);
+
+	emit_statement(enc, &function_body);
+	mem_add(enc, IC_RETURN_VOID);
+	emit_cold_statements(enc);
+
+	// Размер кадра выравнивается, чтобы выровненными оставались и кадры вызываемых функций
+	mem_set(enc, displ_addr, displacements_align(enc, enc->max_local_displ, TYPE_FLOATING));
+	mem_set(enc, jump_addr, (item_t)mem_size(enc));
+	enc->curr_func = NULL;
+
+	if (enc->is_folding)
+	{
+		function_fold(enc, number);
+	}
+}
+
+/**
+ *	Emit declaration
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_declaration(encoder *const enc, const node *const nd)
+{
+	switch (declaration_get_class(nd))
+	{
+		case DECL_VAR:
+			emit_variable_declaration(enc, nd);
 			return;
 
-		case EXPR_ASSIGNMENT:
-			emit_assignment_expression(enc, nd);
+		case DECL_STRUCT:
+			emit_struct_declaration(enc, nd);
 			return;
 
-		case EXPR_INITIALIZER:
-			emit_initializer(enc, nd);
+		case DECL_FUNC:
+			emit_function_definition(enc, nd);
 			return;
 
 		default:
-			// Cannot be rvalue
+			// Unreachable
 			return;
 	}
 }
 
+
+/*
+ *	 ______     ______   ______     ______   ______     __    __     ______     __   __     ______   ______
+ *	/\  ___\   /\__  _\ /\  __ \   /\__  _\ /\  ___\   /\ "-./  \   /\  ___\   /\ "-.\ \   /\__  _\ /\  ___\
+ *	\ \___  \  \/_/\ \/ \ \  __ \  \/_/\ \/ \ \  __\   \ \ \-./\ \  \ \  __\   \ \ \-.  \  \/_/\ \/ \ \___  \
+ *	 \/\_____\    \ \_\  \ \_\ \_\    \ \_\  \ \_____\  \ \_\ \ \_\  \ \_____\  \ \_\\"\_\    \ \_\  \/\_____\
+ *	  \/_____/     \/_/   \/_/\/_/     \/_/   \/_____/   \/_/  \/_/   \/_____/   \/_/ \/_/     \/_/   \/_____/
+ */
+
+
 /**
- *	Emit expression which will be evaluated as a void expression
+ *	Emit declaration statement
  *
  *	@param	enc			Encoder
  *	@param	nd			Node in AST
  */
-static void emit_void_expression(encoder *const enc, const node *const nd)
+static void emit_declaration_statement(encoder *const enc, const node *const nd)
 {
-	if (expression_is_lvalue(nd))
+	const size_t size = statement_declaration_get_size(nd);
+	for (size_t i = 0; i < size; i++)
 	{
-		emit_lvalue(enc, nd);
+		const node decl = statement_declaration_get_declarator(nd, i);
+		emit_declaration(enc, &decl);
 	}
-	else
+}
+
+/**
+ *	Emit case statement
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_case_statement(encoder *const enc, const node *const nd)
+{
+	if (enc->addr_case != 0)
 	{
-		emit_expression(enc, nd);
+		mem_set(enc, enc->addr_case, (item_t)mem_size(enc));
+	}
 
-		const size_t index = mem_get(enc, mem_size(enc) - 1) < MIN_INSTRUCTION_CODE
-			? mem_size(enc) - 2
-			: mem_size(enc) - 1;
+	mem_add(enc, IC_DUPLICATE);
 
-		const instruction_t operation = (instruction_t)mem_get(enc, index);
-		mem_set(enc, index, instruction_to_void_ver(operation));
+	const node expr = statement_case_get_expression(nd);
+	emit_expression(enc, &expr);
+
+	mem_add(enc, IC_EQ);
+	enc->addr_case = mem_add_jump(enc, IC_BE0, 0);
+
+	if (expression_get_class(&expr) == EXPR_LITERAL && mem_get(enc, mem_size(enc) - 5) == IC_LI)
+	{
+		vector_add(&enc->cases, mem_get(enc, mem_size(enc) - 4));
+		vector_add(&enc->cases, (item_t)mem_size(enc));
 	}
+
+	const node substmt = statement_case_get_substmt(nd);
+	emit_statement(enc, &substmt);
 }
 
+/**
+ *	Emit default statement
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_default_statement(encoder *const enc, const node *const nd)
+{
+	if (enc->addr_case != 0)
+	{
+		mem_set(enc, enc->addr_case, (item_t)mem_size(enc));
+	}
+	enc->addr_case = 0;
 
-/*
- *	 _____     ______     ______     __         ______     ______     ______     ______   __     ______     __   __     ______
- *	/\  __-.  /\  ___\   /\  ___\   /\ \       /\  __ \   /\  == \   /\  __ \   /\__  _\ /\ \   /\  __ \   /\ "-.\ \   /\  ___\
- *	\ \ \/\ \ \ \  __\   \ \ \____  \ \ \____  \ \  __ \  \ \  __<   \ \  __ \  \/_/\ \/ \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
- *	 \ \____-  \ \_____\  \ \_____\  \ \_____\  \ \_\ \_\  \ \_\ \_\  \ \_\ \_\    \ \_\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
- *	  \/____/   \/_____/   \/_____/   \/_____/   \/_/\/_/   \/_/ /_/   \/_/\/_/     \/_/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+	if (enc->addr_default == 0)
+	{
+		enc->addr_default = mem_size(enc);
+	}
+
+	const node substmt = statement_default_get_substmt(nd);
+	emit_statement(enc, &substmt);
+}
+
+/**
+ *	Emit expression statement, equal address computations of statement are emitted once
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
  */
+static void emit_expression_statement(encoder *const enc, const node *const nd)
+{
+	const item_t old_displ = enc->displ;
+	const size_t amount = enc->is_numbering ? numbering_build(&enc->numbers, nd) : 0;
+	for (size_t i = 0; i < amount; i++)
+	{
+		vector_add(&enc->addresses, enc->displ++);
+		vector_add(&enc->addresses, ADDRESS_PENDING);
+	}
+	enc->max_local_displ = max(enc->displ, enc->max_local_displ);
+
+	emit_void_expression(enc, nd);
+
+	vector_resize(&enc->addresses, 0);
+	enc->displ = old_displ;
+}
+
+static int find_use(void *const context, const node *const nd)
+{
+	liveness *const live = context;
+	const item_t number = hash_get(&live->numbers, (item_t)expression_identifier_get_id(nd), 0);
+	if (number != ITEM_MAX)
+	{
+		vector_set(&live->lasts, (size_t)number, (item_t)live->index);
+	}
+
+	return 0;
+}
+
+static int find_taken_address(void *const context, const node *const nd)
+{
+	liveness *const live = context;
+	if (expression_unary_get_operator(nd) == UN_ADDRESS)
+	{
+		live->has_addresses = true;
+		return -1;
+	}
 
+	return 0;
+}
 
 /**
- *	Check that there are only strings in array initializer
+ *	Find the last uses of scalar variables declared in compound statement
  *
  *	@param	enc			Encoder
- *	@param	nd			Initializer
+ *	@param	nd			Compound statement
  *
- *	@return @c 1 on true, @c 0 on false
+ *	@return	Liveness of variables, no variable dies, if some address is taken
  */
-static bool only_strings(const encoder *const enc, const node *const nd)
+static liveness liveness_create(encoder *const enc, const node *const nd)
 {
-	switch (expression_get_class(nd))
+	liveness live = { .enc = enc, .numbers = hash_create(0), .identifiers = vector_create(0)
+		, .lasts = vector_create(0), .deaths = vector_create(0), .next = vector_create(0) };
+	if (!enc->is_sharing)
 	{
-		case EXPR_LITERAL:
-			return type_is_string(enc->sx, expression_get_type(nd));
+		return live;
+	}
 
-		case EXPR_INITIALIZER:
+	const size_t size = statement_compound_get_size(nd);
+	size_t first = size;
+	for (size_t i = 0; i < size; i++)
+	{
+		const node substmt = statement_compound_get_substmt(nd, i);
+		if (statement_get_class(&substmt) != STMT_DECL)
 		{
-			const size_t size = expression_initializer_get_size(nd);
-			for (size_t i = 0; i < size; i++)
+			continue;
+		}
+
+		const size_t amount = statement_declaration_get_size(&substmt);
+		for (size_t j = 0; j < amount; j++)
+		{
+			const node decl = statement_declaration_get_declarator(&substmt, j);
+			if (declaration_get_class(&decl) != DECL_VAR)
 			{
-				const node subexpr = expression_initializer_get_subexpr(nd, i);
-				if (!only_strings(enc, &subexpr))
-				{
-					return false;
-				}
+				continue;
 			}
 
-			return true;
+			const size_t identifier = declaration_variable_get_id(&decl);
+			if (displacements_is_shared(enc, ident_get_type(enc->sx, identifier)))
+			{
+				hash_add(&live.numbers, (item_t)identifier, 1);
+				hash_set(&live.numbers, (item_t)identifier, 0, (item_t)vector_size(&live.identifiers));
+				vector_add(&live.identifiers, (item_t)identifier);
+				vector_add(&live.lasts, (item_t)i);
+				first = first == size ? i : first;
+
+				// Место освобождается, только если объявление было выдано
+				displacements_set(enc, identifier, 0);
+			}
 		}
+	}
 
-		default:
-			return false;
+	visitor vis = visitor_create(&live);
+	visitor_set(&vis, OP_IDENTIFIER, &find_use, NULL);
+	visitor_set(&vis, OP_UNARY, &find_taken_address, NULL);
+	for (size_t i = first; i < size && !live.has_addresses; i++)
+	{
+		const node substmt = statement_compound_get_substmt(nd, i);
+		live.index = i;
+		visitor_walk(&vis, &substmt);
+	}
+	visitor_clear(&vis);
+
+	if (first != size && !live.has_addresses)
+	{
+		vector_increase(&live.deaths, size);
+		for (size_t i = 0; i < vector_size(&live.lasts); i++)
+		{
+			const size_t index = (size_t)vector_get(&live.lasts, i);
+			vector_add(&live.next, vector_get(&live.deaths, index));
+			vector_set(&live.deaths, index, (item_t)i + 1);
+		}
 	}
+
+	return live;
 }
 
 /**
- *	Emit array declaration
+ *	Free frame slots of variables, which are not used after statement
+ *
+ *	@param	enc			Encoder
+ *	@param	live		Liveness of variables
+ *	@param	index		Index of statement
+ */
+static void liveness_release(encoder *const enc, const liveness *const live, const size_t index)
+{
+	if (index >= vector_size(&live->deaths))
+	{
+		return;
+	}
+
+	for (item_t i = vector_get(&live->deaths, index); i != 0; i = vector_get(&live->next, (size_t)i - 1))
+	{
+		const size_t identifier = (size_t)vector_get(&live->identifiers, (size_t)i - 1);
+		const item_t displ = displacements_get(enc, identifier);
+		if (displ >= DISPL_START)
+		{
+			vector_add(&enc->slots, displ);
+			vector_add(&enc->slots, (item_t)type_size(enc->sx, ident_get_type(enc->sx, identifier)));
+		}
+	}
+}
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	live		Liveness of variables
+ */
+static void liveness_clear(liveness *const live)
+{
+	hash_clear(&live->numbers);
+	vector_clear(&live->identifiers);
+	vector_clear(&live->lasts);
+	vector_clear(&live->deaths);
+	vector_clear(&live->next);
+}
+
+/**
+ *	Emit compound statement
  *
  *	@param	enc			Encoder
  *	@param	nd			Node in AST
  */
-static void emit_array_declaration(encoder *const enc, const node *const nd)
+static void emit_compound_statement(encoder *const enc, const node *const nd)
 {
-	const size_t identifier = declaration_variable_get_id(nd);
-	item_t type = ident_get_type(enc->sx, identifier);
-	item_t dimensions = 0;
-	bool has_empty_bounds = false;
+	const item_t scope_displacement = enc->displ;
+	const size_t size = statement_compound_get_size(nd);
+	liveness live = liveness_create(enc, nd);
 
-	while (type_is_array(enc->sx, type))
+	for (size_t i = 0; i < size; i++)
 	{
-		type = type_array_get_element_type(enc->sx, type);
-		const node bound = declaration_variable_get_bound(nd, (size_t)dimensions);
-		if (expression_get_class(&bound) == EXPR_EMPTY_BOUND)
+		const node substmt = statement_compound_get_substmt(nd, i);
+		emit_statement(enc, &substmt);
+		liveness_release(enc, &live, i);
+	}
+
+	liveness_clear(&live);
+	enc->displ = scope_displacement;
+
+	// Свободные места выше начала блока освобождаются вместе с ним
+	size_t kept = 0;
+	for (size_t i = 0; i < vector_size(&enc->slots); i += 2)
+	{
+		if (vector_get(&enc->slots, i) < scope_displacement)
 		{
-			if (type_is_array(enc->sx, type))
+			vector_set(&enc->slots, kept++, vector_get(&enc->slots, i));
+			vector_set(&enc->slots, kept++, vector_get(&enc->slots, i + 1));
+		}
+	}
+	vector_resize(&enc->slots, kept);
+}
+
+/**
+ *	Emit if statement
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_if_statement(encoder *const enc, const node *const nd)
+{
+	const node condition = statement_if_get_condition(nd);
+	emit_expression(enc, &condition);
+
+	const node then_substmt = statement_if_get_then_substmt(nd);
+	const bool has_else = statement_if_has_else_substmt(nd);
+	const node else_substmt = has_else ? statement_if_get_else_substmt(nd) : node_broken();
+	const bool is_then_cold = is_cold_statement(enc, &then_substmt);
+	const bool is_else_cold = has_else && is_cold_statement(enc, &else_substmt);
+
+	// Невыполнявшаяся ветвь переносится в конец функции, чтобы не разрывать горячий код
+	if (is_then_cold != is_else_cold)
+	{
+		const size_t addr = mem_add_jump(enc, is_then_cold ? IC_BNE0 : IC_BE0, 0);
+		if (is_then_cold)
+		{
+			if (has_else)
 			{
-				encoder_error(enc, node_get_location(&bound), empty_init);
+				emit_statement(enc, &else_substmt);
 			}
-
-			has_empty_bounds = true;
 		}
 		else
 		{
-			emit_expression(enc, &bound);
+			emit_statement(enc, &then_substmt);
 		}
 
-		dimensions++;
+		cold_add(enc, is_then_cold ? &then_substmt : &else_substmt, addr);
+		return;
+	}
+
+	size_t addr = mem_add_jump(enc, IC_BE0, 0);
+	emit_statement(enc, &then_substmt);
+
+	if (has_else)
+	{
+		mem_set(enc, addr, (item_t)mem_size(enc) + 2);
+		addr = mem_add_jump(enc, IC_B, 0);
+		emit_statement(enc, &else_substmt);
+	}
+
+	mem_set(enc, addr, (item_t)mem_size(enc));
+}
+
+static int case_label_compare(const void *const fst, const void *const snd)
+{
+	const case_label *const a = fst;
+	const case_label *const b = snd;
+	return a->value != b->value
+		? (a->value < b->value ? -1 : 1)
+		: (a->address < b->address ? -1 : a->address > b->address ? 1 : 0);
+}
+
+static int count_case_label(void *const context, const node *const nd)
+{
+	case_labels *const labels = context;
+	const node expr = statement_case_get_expression(nd);
+
+	labels->amount++;
+	labels->is_constant = labels->is_constant && expression_get_class(&expr) == EXPR_LITERAL;
+	return 0;
+}
+
+static int stop_on_default_label(void *const context, const node *const nd)
+{
+	(void)context;
+	(void)nd;
+	return -1;
+}
+
+static int skip_switch_statement(void *const context, const node *const nd)
+{
+	(void)context;
+	(void)nd;
+	return 1;
+}
+
+/**
+ *	Get number of case labels before default one, which can be reached by dispatch
+ *
+ *	@param	body		Body of switch statement
+ *
+ *	@return	Number of case labels, @c 0 if dispatch is impossible
+ */
+static size_t switch_get_dispatch_amount(const node *const body)
+{
+	// Операторы перед первой меткой выполняются всегда, поэтому сразу переходить к метке нельзя
+	const bool is_compound = statement_get_class(body) == STMT_COMPOUND;
+	if (is_compound && statement_compound_get_size(body) == 0)
+	{
+		return 0;
 	}
 
-	const bool has_initializer = declaration_variable_has_initializer(nd);
-	const item_t length = (item_t)type_size(enc->sx, type);
-	const item_t displ = displacements_add(enc, identifier);
-	const item_t iniproc = proc_get(enc, (size_t)type);
+	const node first = is_compound ? statement_compound_get_substmt(body, 0) : *body;
+	if (statement_get_class(&first) != STMT_CASE)
+	{
+		return 0;
+	}
 
-	mem_add(enc, IC_DEFARR); 		// DEFARR N, d, displ, iniproc, usual N1...NN, уже лежат на стеке
-	mem_add(enc, has_initializer ? dimensions - 1 : dimensions);
-	mem_add(enc, length);
-	mem_add(enc, displ);
-	mem_add(enc, iniproc && iniproc != ITEM_MAX ? iniproc : 0);
+	case_labels labels = { .amount = 0, .is_constant = true };
+	visitor vis = visitor_create(&labels);
+	visitor_set(&vis, OP_CASE, &count_case_label, NULL);
+	visitor_set(&vis, OP_DEFAULT, &stop_on_default_label, NULL);
+	visitor_set(&vis, OP_SWITCH, &skip_switch_statement, NULL);
 
-	const size_t usual_addr = mem_size(enc);
-	item_t usual = has_empty_bounds ? 0 : 1;
-	mem_add(enc, usual);
+	visitor_walk(&vis, body);
+	visitor_clear(&vis);
 
-	mem_add(enc, has_initializer);
-	mem_add(enc, 0);				// is in structure
+	return labels.is_constant ? labels.amount : 0;
+}
 
-	if (has_initializer)
+/**
+ *	Emit search of case label by binary search on stack top value
+ *
+ *	@param	enc			Encoder
+ *	@param	labels		Sorted case labels
+ *	@param	begin		First label in search
+ *	@param	end			Label after the last one in search
+ */
+static void emit_case_search(encoder *const enc, const case_label *const labels, const size_t begin, const size_t end)
+{
+	if (end - begin <= MAX_LINEAR_CASES)
 	{
-		const node initializer = declaration_variable_get_initializer(nd);
-		emit_expression(enc, &initializer);
+		for (size_t i = begin; i < end; i++)
+		{
+			mem_add(enc, IC_DUPLICATE);
+			mem_add(enc, IC_LI);
+			mem_add(enc, labels[i].value);
+			mem_add(enc, IC_EQ);
+			mem_add_jump(enc, IC_BNE0, (item_t)labels[i].address);
+		}
 
-		if (only_strings(enc, &initializer))
+		if (enc->addr_default != 0)
 		{
-			usual += 2;
-			mem_set(enc, usual_addr, usual);
+			mem_add_jump(enc, IC_B, (item_t)enc->addr_default);
+		}
+		else
+		{
+			enc->addr_break = mem_add_jump(enc, IC_B, (item_t)enc->addr_break);
 		}
 
-		mem_add(enc, IC_ARR_INIT);
-		mem_add(enc, dimensions);
-		mem_add(enc, length);
-		mem_add(enc, displ);
-		mem_add(enc, usual);
+		return;
 	}
+
+	const size_t middle = begin + (end - begin) / 2;
+	mem_add(enc, IC_DUPLICATE);
+	mem_add(enc, IC_LI);
+	mem_add(enc, labels[middle].value);
+	mem_add(enc, IC_LT);
+	const size_t addr = mem_add_jump(enc, IC_BNE0, 0);
+
+	emit_case_search(enc, labels, middle, end);
+	mem_set(enc, addr, (item_t)mem_size(enc));
+	emit_case_search(enc, labels, begin, middle);
 }
 
 /**
- *	Emit variable declaration
+ *	Emit dispatch of switch statement, which jumps straight to matching case body
+ *	instead of checking cases one by one
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	begin		Index of the first case in cases table
+ *	@param	amount		Number of cases before default one
+ *	@param	addr		Address of the first case check
  */
-static void emit_variable_declaration(encoder *const enc, const node *const nd)
+static void emit_switch_dispatch(encoder *const enc, const size_t begin, const size_t amount, const size_t addr)
 {
-	const size_t identifier = declaration_variable_get_id(nd);
-	const item_t type = ident_get_type(enc->sx, identifier);
-	if (type_is_array(enc->sx, type))
+	case_label *const labels = malloc(amount * sizeof(case_label));
+	if (labels == NULL)
 	{
-		emit_array_declaration(enc, nd);
+		mem_add_jump(enc, IC_B, (item_t)addr);
 		return;
 	}
 
-	const item_t displ = displacements_add(enc, identifier);
-	const item_t iniproc = proc_get(enc, (size_t)type);
-	if (iniproc != ITEM_MAX && iniproc != 0)
+	for (size_t i = 0; i < amount; i++)
 	{
-		mem_add(enc, IC_STRUCT_WITH_ARR);
-		mem_add(enc, displ);
-		mem_add(enc, iniproc);
+		labels[i].value = vector_get(&enc->cases, begin + 2 * i);
+		labels[i].address = (size_t)vector_get(&enc->cases, begin + 2 * i + 1);
 	}
 
-	if (declaration_variable_has_initializer(nd))
+	// Из одинаковых значений выбирается первое по порядку проверок
+	qsort(labels, amount, sizeof(case_label), &case_label_compare);
+	size_t unique = 0;
+	for (size_t i = 0; i < amount; i++)
 	{
-		const node initializer = declaration_variable_get_initializer(nd);
-		emit_expression(enc, &initializer);
-
-		if (type_is_structure(enc->sx, type))
-		{
-			mem_add(enc, IC_COPY0ST_ASSIGN);
-			mem_add(enc, displ);
-			mem_add(enc, (item_t)type_size(enc->sx, type));
-		}
-		else
+		if (unique == 0 || labels[unique - 1].value != labels[i].value)
 		{
-			mem_add(enc, type_is_floating(type) ? IC_ASSIGN_R_V : IC_ASSIGN_V);
-			mem_add(enc, displ);
+			labels[unique++] = labels[i];
 		}
 	}
+
+	emit_case_search(enc, labels, 0, unique);
+	free(labels);
 }
 
 /**
- *	Emit member declaration
+ *	Emit switch statement
  *
  *	@param	enc			Encoder
  *	@param	nd			Node in AST
- *	@param	displ		Member displacement
  */
-static void emit_member_declaration(encoder *const enc, const node *const nd, const item_t displ)
+static void emit_switch_statement(encoder *const enc, const node *const nd)
 {
-	item_t member_type = declaration_member_get_type(nd);
-	if (!type_is_array(enc->sx, member_type))
+	const size_t old_addr_break = enc->addr_break;
+	const size_t old_addr_case = enc->addr_case;
+	const size_t old_addr_default = enc->addr_default;
+	enc->addr_break = 0;
+	enc->addr_case = 0;
+	enc->addr_default = 0;
+
+	const node condition = statement_switch_get_condition(nd);
+	emit_expression(enc, &condition);
+
+	const node body = statement_switch_get_body(nd);
+	const size_t cases_begin = vector_size(&enc->cases);
+	const size_t cases_amount = switch_get_dispatch_amount(&body);
+	const bool is_dispatched = cases_amount >= MIN_DISPATCH_CASES;
+	const size_t addr_dispatch = is_dispatched ? mem_add_jump(enc, IC_B, 0) : 0;
+
+	emit_statement(enc, &body);
+
+	if (is_dispatched && vector_size(&enc->cases) >= cases_begin + 2 * cases_amount)
 	{
-		return;
+		enc->addr_break = mem_add_jump(enc, IC_B, (item_t)enc->addr_break);
+		mem_set(enc, addr_dispatch, (item_t)mem_size(enc));
+		emit_switch_dispatch(enc, cases_begin, cases_amount, addr_dispatch + 1);
 	}
-
-	while (type_is_array(enc->sx, member_type))
+	else if (is_dispatched)
 	{
-		member_type = type_array_get_element_type(enc->sx, member_type);
+		mem_set(enc, addr_dispatch, (item_t)addr_dispatch + 1);
 	}
 
-	const size_t bounds = declaration_member_get_bounds_amount(nd);
-	for (size_t i = 0; i < bounds; i++)
+	if (enc->addr_case > 0)
 	{
-		const node bound = declaration_member_get_bound(nd, i);
-		emit_expression(enc, &bound);
+		mem_set(enc, enc->addr_case, (item_t)mem_size(enc));
 	}
 
-	const size_t length = type_size(enc->sx, member_type);
-	const item_t iniproc = proc_get(enc, (size_t)member_type);
+	addr_end_break(enc);
+	vector_resize(&enc->cases, cases_begin);
 
-	mem_add(enc, IC_DEFARR); 		// DEFARR N, d, displ, iniproc, usual N1...NN, уже лежат на стеке
-	mem_add(enc, (item_t)bounds);
-	mem_add(enc, (item_t)length);
-	mem_add(enc, (item_t)displ);
-	mem_add(enc, iniproc && iniproc != ITEM_MAX ? iniproc : 0);
-	mem_add(enc, 1);				// usual
-	mem_add(enc, 0);				// has initializer
-	mem_add(enc, 1);				// is in structure
+	enc->addr_default = old_addr_default;
+	enc->addr_case = old_addr_case;
+	enc->addr_break = old_addr_break;
 }
 
 /**
- *	Emit struct declaration
+ *	Allocate temporary for expression in current frame, further emission of expression loads it
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	nd			Expression
+ *
+ *	@return	Temporary displacement
  */
-static void emit_struct_declaration(encoder *const enc, const node *const nd)
+static item_t temporary_add(encoder *const enc, const node *const nd)
 {
-	const item_t type = declaration_struct_get_type(nd);
-	const size_t members = type_structure_get_member_amount(enc->sx, type);
+	const item_t type = expression_get_type(nd);
+	const item_t displ = displacements_align(enc, enc->displ, type);
+	enc->displ = displ + (item_t)type_size(enc->sx, type);
+	enc->max_local_displ = max(enc->displ, enc->max_local_displ);
 
-	bool has_arrays = false;
-	for (size_t i = 0; i < members; i++)
+	hash_add(&enc->temporaries, (item_t)nd->index, 1);
+	hash_set(&enc->temporaries, (item_t)nd->index, 0, displ);
+	return displ;
+}
+
+static void loop_add_write(loop_analysis *const la, const size_t identifier)
+{
+	const item_t writes = hash_get(&la->writes, (item_t)identifier, 0);
+	if (writes == ITEM_MAX)
 	{
-		const item_t member_type = type_structure_get_member_type(enc->sx, type, i);
-		if (type_is_array(enc->sx, member_type))
-		{
-			has_arrays = true;
-		}
+		hash_add(&la->writes, (item_t)identifier, 1);
+		hash_set(&la->writes, (item_t)identifier, 0, 1);
 	}
-
-	if (!has_arrays)
+	else
 	{
-		return;
+		hash_set(&la->writes, (item_t)identifier, 0, writes + 1);
 	}
+}
 
-	mem_add(enc, IC_B);
-	const size_t addr = mem_reserve(enc);
-
-	proc_set(enc, (size_t)type, (item_t)addr + 1);
+static void loop_add_target(loop_analysis *const la, const node *const nd)
+{
+	if (expression_get_class(nd) == EXPR_IDENTIFIER)
+	{
+		loop_add_write(la, expression_identifier_get_id(nd));
+	}
+	else
+	{
+		la->has_side_writes = true;
+	}
+}
 
-	item_t displ = 0;
-	const size_t size = declaration_struct_get_size(nd);
-	for (size_t i = 0; i < size; i++)
+static int find_write(void *const context, const node *const nd)
+{
+	loop_analysis *const la = context;
+	switch (node_get_type(nd))
 	{
-		const node member = declaration_struct_get_member(nd, i);
-		if (declaration_get_class(&member) == DECL_MEMBER)
+		case OP_ASSIGNMENT:
 		{
-			emit_member_declaration(enc, &member, displ);
-			displ += type_size(enc->sx, declaration_member_get_type(&member));
+			const node LHS = expression_assignment_get_LHS(nd);
+			loop_add_target(la, &LHS);
+			return 0;
 		}
-		else
+
+		case OP_UNARY:
 		{
-			emit_declaration(enc, &member);
+			const unary_t operator = expression_unary_get_operator(nd);
+			if (operator == UN_POSTINC || operator == UN_POSTDEC || operator == UN_PREINC || operator == UN_PREDEC
+				|| operator == UN_ADDRESS)
+			{
+				const node operand = expression_unary_get_operand(nd);
+				loop_add_target(la, &operand);
+			}
+			return 0;
+		}
+
+		case OP_CALL:
+		{
+			// getid записывает значения в переданные переменные
+			la->has_side_writes = true;
+			const node callee = expression_call_get_callee(nd);
+			if (expression_get_class(&callee) == EXPR_IDENTIFIER && expression_identifier_get_id(&callee) == BI_GETID)
+			{
+				const size_t argc = expression_call_get_arguments_amount(nd);
+				for (size_t i = 0; i < argc; i++)
+				{
+					const node argument = expression_call_get_argument(nd, i);
+					loop_add_target(la, &argument);
+				}
+			}
+			return 0;
 		}
+
+		case OP_DECL_VAR:
+			loop_add_write(la, declaration_variable_get_id(nd));
+			return 0;
+
+		default:
+			return 0;
 	}
+}
 
-	mem_add(enc, IC_STOP);
-	mem_set(enc, addr, (item_t)mem_size(enc));
+static inline bool loop_is_invariant(const loop_analysis *const la, const node *const nd)
+{
+	return hash_get_index(&la->invariants, (item_t)nd->index) != SIZE_MAX;
+}
+
+static inline bool loop_is_temporary(const loop_analysis *const la, const node *const nd)
+{
+	return hash_get_index(&la->enc->temporaries, (item_t)nd->index) != SIZE_MAX;
 }
 
 /**
- *	Emit function definition
+ *	Check that variable is not changed in loop.
+ *	Only local variables are considered, global ones can be changed by other threads.
  *
- *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	la			Loop analysis
+ *	@param	identifier	Variable identifier
+ *
+ *	@return	@c true on invariant variable, @c false otherwise
  */
-static void emit_function_definition(encoder *const enc, const node *const nd)
+static bool loop_is_invariant_variable(const loop_analysis *const la, const size_t identifier)
 {
-	const size_t identifier = declaration_function_get_id(nd);
-	functions_add(enc, identifier, mem_size(enc));
-
-	enc->curr_func = nd;
-	enc->displ = DISPL_START;
-	enc->max_local_displ = enc->displ;
+	const encoder *const enc = la->enc;
+	const item_t type = ident_get_type(enc->sx, identifier);
+	return (type_is_integer(enc->sx, type) || type_is_floating(type))
+		&& displacements_get(enc, identifier) > 0
+		&& hash_get_index(&la->writes, (item_t)identifier) == SIZE_MAX
+		&& !(la->has_side_writes && enc->has_addresses);
+}
 
-	const size_t parameters_amount = declaration_function_get_parameters_amount(nd);
-	for (size_t i = 0; i < parameters_amount; i++)
+/**
+ *	Check that expression has the same value on every iteration and can be computed before loop,
+ *	expressions, which can fail, are not considered
+ *
+ *	@param	la			Loop analysis
+ *	@param	nd			Expression with analysed subexpressions
+ *
+ *	@return	@c true on invariant expression, @c false otherwise
+ */
+static bool loop_is_invariant_expression(const loop_analysis *const la, const node *const nd)
+{
+	switch (node_get_type(nd))
 	{
-		const size_t parameter = declaration_function_get_parameter(nd, i);
-		displacements_add(enc, parameter);
-	}
+		case OP_LITERAL:
+			return !type_is_array(la->enc->sx, expression_get_type(nd));
 
-	mem_add(enc, IC_FUNC_BEG);
+		case OP_IDENTIFIER:
+			return loop_is_invariant_variable(la, expression_identifier_get_id(nd));
 
-	const size_t displ_addr = mem_reserve(enc);
-	const size_t jump_addr = mem_reserve(enc);
+		case OP_UNARY:
+		{
+			const unary_t operator = expression_unary_get_operator(nd);
+			if (operator != UN_MINUS && operator != UN_NOT && operator != UN_LOGNOT && operator != UN_ABS)
+			{
+				return false;
+			}
+			break;
+		}
 
-	const node function_body = declaration_function_get_body(nd);
-	emit_statement(enc, &function_body);
-	mem_add(enc, IC_RETURN_VOID);
+		case OP_BINARY:
+		{
+			const binary_t operator = expression_binary_get_operator(nd);
+			if (operator == BIN_DIV || operator == BIN_REM || operator == BIN_COMMA)
+			{
+				return false;
+			}
+			break;
+		}
 
-	mem_set(enc, displ_addr, enc->max_local_displ);
-	mem_set(enc, jump_addr, (item_t)mem_size(enc));
-	enc->curr_func = NULL;
+		case OP_CAST:
+			break;
+
+		default:
+			return false;
+	}
+
+	const size_t amount = node_get_amount(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node child = node_get_child(nd, i);
+		if (!loop_is_invariant(la, &child))
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 /**
- *	Emit declaration
+ *	Check that hoisting of invariant expression saves instructions
  *
- *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	la			Loop analysis
+ *	@param	nd			Invariant expression
+ *
+ *	@return	@c true on expression with operators, @c false otherwise
  */
-static void emit_declaration(encoder *const enc, const node *const nd)
+static bool loop_is_hoistable(const loop_analysis *const la, const node *const nd)
 {
-	switch (declaration_get_class(nd))
+	// Временные переменные хранят только скалярные значения
+	const item_t kind = node_get_type(nd);
+	return (kind == OP_UNARY || kind == OP_BINARY || kind == OP_CAST) && !loop_is_temporary(la, nd)
+		&& !type_is_structure(la->enc->sx, expression_get_type(nd));
+}
+
+static bool loop_is_product(const loop_analysis *const la, const node *const nd)
+{
+	if (la->induction == SIZE_MAX || node_get_type(nd) != OP_BINARY || expression_binary_get_operator(nd) != BIN_MUL)
 	{
-		case DECL_VAR:
-			emit_variable_declaration(enc, nd);
-			return;
+		return false;
+	}
 
-		case DECL_STRUCT:
-			emit_struct_declaration(enc, nd);
-			return;
+	const node LHS = expression_binary_get_LHS(nd);
+	const node RHS = expression_binary_get_RHS(nd);
+	const node variable = expression_get_class(&LHS) == EXPR_IDENTIFIER ? LHS : RHS;
+	const node factor = expression_get_class(&LHS) == EXPR_IDENTIFIER ? RHS : LHS;
+	return expression_get_class(&variable) == EXPR_IDENTIFIER
+		&& expression_identifier_get_id(&variable) == la->induction
+		&& expression_get_class(&factor) == EXPR_LITERAL
+		&& type_is_integer(la->enc->sx, expression_get_type(&factor));
+}
 
-		case DECL_FUNC:
-			emit_function_definition(enc, nd);
-			return;
+static int skip_temporary(void *const context, const node *const nd)
+{
+	// Выражения, вынесенные из объемлющего цикла, уже вычислены
+	return loop_is_temporary(context, nd) ? 1 : 0;
+}
 
-		default:
-			// Unreachable
-			return;
+static int find_invariant(void *const context, const node *const nd)
+{
+	loop_analysis *const la = context;
+	if (loop_is_temporary(la, nd) || loop_is_invariant_expression(la, nd))
+	{
+		hash_add(&la->invariants, (item_t)nd->index, 0);
+		return 0;
 	}
-}
 
+	if (loop_is_product(la, nd))
+	{
+		vector_add(&la->products, (item_t)nd->index);
+		return 0;
+	}
 
-/*
- *	 ______     ______   ______     ______   ______     __    __     ______     __   __     ______   ______
- *	/\  ___\   /\__  _\ /\  __ \   /\__  _\ /\  ___\   /\ "-./  \   /\  ___\   /\ "-.\ \   /\__  _\ /\  ___\
- *	\ \___  \  \/_/\ \/ \ \  __ \  \/_/\ \/ \ \  __\   \ \ \-./\ \  \ \  __\   \ \ \-.  \  \/_/\ \/ \ \___  \
- *	 \/\_____\    \ \_\  \ \_\ \_\    \ \_\  \ \_____\  \ \_\ \ \_\  \ \_____\  \ \_\\"\_\    \ \_\  \/\_____\
- *	  \/_____/     \/_/   \/_/\/_/     \/_/   \/_____/   \/_/  \/_/   \/_____/   \/_/ \/_/     \/_/   \/_____/
- */
+	// Выносятся только наибольшие инвариантные подвыражения
+	const size_t amount = node_get_amount(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node child = node_get_child(nd, i);
+		if (loop_is_invariant(la, &child) && loop_is_hoistable(la, &child))
+		{
+			vector_add(&la->hoisted, (item_t)child.index);
+		}
+	}
 
+	return 0;
+}
 
 /**
- *	Emit declaration statement
+ *	Find induction variable of for statement, which is changed only by increment by literal
  *
- *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	la			Loop analysis
+ *	@param	nd			Increment expression
  */
-static void emit_declaration_statement(encoder *const enc, const node *const nd)
+static void loop_find_induction(loop_analysis *const la, const node *const nd)
 {
-	const size_t size = statement_declaration_get_size(nd);
-	for (size_t i = 0; i < size; i++)
+	const encoder *const enc = la->enc;
+	node variable = node_broken();
+	item_t step = 0;
+
+	if (expression_get_class(nd) == EXPR_UNARY)
 	{
-		const node decl = statement_declaration_get_declarator(nd, i);
-		emit_declaration(enc, &decl);
+		const unary_t operator = expression_unary_get_operator(nd);
+		variable = expression_unary_get_operand(nd);
+		step = operator == UN_POSTINC || operator == UN_PREINC
+			? 1
+			: operator == UN_POSTDEC || operator == UN_PREDEC ? -1 : 0;
+	}
+	else if (expression_get_class(nd) == EXPR_ASSIGNMENT)
+	{
+		const binary_t operator = expression_assignment_get_operator(nd);
+		const node RHS = expression_assignment_get_RHS(nd);
+		variable = expression_assignment_get_LHS(nd);
+		if ((operator == BIN_ADD_ASSIGN || operator == BIN_SUB_ASSIGN) && expression_get_class(&RHS) == EXPR_LITERAL
+			&& type_is_integer(enc->sx, expression_get_type(&RHS)))
+		{
+			step = (item_t)expression_literal_get_integer(&RHS);
+			step = operator == BIN_ADD_ASSIGN ? step : -step;
+		}
+	}
+
+	if (step == 0 || enc->has_addresses || expression_get_class(&variable) != EXPR_IDENTIFIER)
+	{
+		return;
+	}
+
+	const size_t identifier = expression_identifier_get_id(&variable);
+	if (type_is_integer(enc->sx, ident_get_type(enc->sx, identifier)) && displacements_get(enc, identifier) > 0
+		&& hash_get(&la->writes, (item_t)identifier, 0) == 1)
+	{
+		la->induction = identifier;
+		la->step = step;
 	}
 }
 
 /**
- *	Emit case statement
+ *	Analyse loop and emit computation of its invariant expressions and reduced products,
+ *	they are replaced by temporaries in loop. Without hoisting the analysis is empty
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	parts		Condition, body and increment of loop, broken nodes for absent ones
+ *	@param	increment	Increment of for statement, broken node for other loops
+ *
+ *	@return	Loop analysis
  */
-static void emit_case_statement(encoder *const enc, const node *const nd)
+static loop_analysis emit_loop_preheader(encoder *const enc, const node *const parts, const node *const increment)
 {
-	if (enc->addr_case != 0)
+	loop_analysis la = { .enc = enc, .has_side_writes = false, .induction = SIZE_MAX, .step = 0 };
+	la.writes = hash_create(0);
+	la.invariants = hash_create(0);
+	la.hoisted = vector_create(0);
+	la.products = vector_create(0);
+	la.factors = vector_create(0);
+	if (!enc->is_hoisting)
 	{
-		mem_set(enc, enc->addr_case, (item_t)mem_size(enc));
+		return la;
 	}
 
-	mem_add(enc, IC_DUPLICATE);
+	visitor vis = visitor_create(&la);
+	for (size_t i = 0; i < VISITOR_KINDS; i++)
+	{
+		visitor_set(&vis, (operation_t)i, &find_write, NULL);
+	}
 
-	const node expr = statement_case_get_expression(nd);
-	emit_expression(enc, &expr);
+	for (size_t i = 0; i < 3; i++)
+	{
+		visitor_walk(&vis, &parts[i]);
+	}
 
-	mem_add(enc, IC_EQ);
-	mem_add(enc, IC_BE0);
-	enc->addr_case = mem_reserve(enc);
+	if (node_is_correct(increment))
+	{
+		loop_find_induction(&la, increment);
+	}
 
-	const node substmt = statement_case_get_substmt(nd);
-	emit_statement(enc, &substmt);
-}
+	for (size_t i = 0; i < VISITOR_KINDS; i++)
+	{
+		visitor_set(&vis, (operation_t)i, &skip_temporary, &find_invariant);
+	}
 
-/**
- *	Emit default statement
- *
- *	@param	enc			Encoder
- *	@param	nd			Node in AST
- */
-static void emit_default_statement(encoder *const enc, const node *const nd)
-{
-	if (enc->addr_case != 0)
+	for (size_t i = 0; i < 3; i++)
 	{
-		mem_set(enc, enc->addr_case, (item_t)mem_size(enc));
+		if (visitor_walk(&vis, &parts[i]) == 0 && loop_is_invariant(&la, &parts[i]) && loop_is_hoistable(&la, &parts[i]))
+		{
+			vector_add(&la.hoisted, (item_t)parts[i].index);
+		}
 	}
-	enc->addr_case = 0;
 
-	const node substmt = statement_default_get_substmt(nd);
-	emit_statement(enc, &substmt);
-}
+	visitor_clear(&vis);
 
-/**
- *	Emit compound statement
- *
- *	@param	enc			Encoder
- *	@param	nd			Node in AST
- */
-static void emit_compound_statement(encoder *const enc, const node *const nd)
-{
-	const item_t scope_displacement = enc->displ;
-	const size_t size = statement_compound_get_size(nd);
+	for (size_t i = 0; i < vector_size(&la.hoisted); i++)
+	{
+		const node nd = node_load(&enc->sx->tree, (size_t)vector_get(&la.hoisted, i));
+		emit_expression(enc, &nd);
 
-	for (size_t i = 0; i < size; i++)
+		const item_t displ = temporary_add(enc, &nd);
+		mem_add_variable(enc, type_is_floating(expression_get_type(&nd)) ? IC_ASSIGN_R_V : IC_ASSIGN_V, displ);
+	}
+
+	// Произведения индуктивной переменной на одинаковые литералы вычисляются один раз
+	for (size_t i = 0; i < vector_size(&la.products); i++)
 	{
-		const node substmt = statement_compound_get_substmt(nd, i);
-		emit_statement(enc, &substmt);
+		const node nd = node_load(&enc->sx->tree, (size_t)vector_get(&la.products, i));
+		const node LHS = expression_binary_get_LHS(&nd);
+		const node RHS = expression_binary_get_RHS(&nd);
+		const item_t factor = (item_t)expression_literal_get_integer(expression_get_class(&LHS) == EXPR_LITERAL ? &LHS : &RHS);
+
+		size_t j = 0;
+		while (j < vector_size(&la.factors) && vector_get(&la.factors, j) != factor)
+		{
+			j += 2;
+		}
+
+		if (j < vector_size(&la.factors))
+		{
+			hash_add(&enc->temporaries, (item_t)nd.index, 1);
+			hash_set(&enc->temporaries, (item_t)nd.index, 0, vector_get(&la.factors, j + 1));
+			continue;
+		}
+
+		emit_expression(enc, &nd);
+
+		const item_t displ = temporary_add(enc, &nd);
+		mem_add_variable(enc, IC_ASSIGN_V, displ);
+
+		vector_add(&la.factors, factor);
+		vector_add(&la.factors, displ);
 	}
 
-	enc->displ = scope_displacement;
+	return la;
 }
 
 /**
- *	Emit if statement
+ *	Emit update of reduced products after increment of induction variable
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	la			Loop analysis
  */
-static void emit_if_statement(encoder *const enc, const node *const nd)
+static void emit_loop_induction(encoder *const enc, const loop_analysis *const la)
 {
-	const node condition = statement_if_get_condition(nd);
-	emit_expression(enc, &condition);
-
-	mem_add(enc, IC_BE0);
-	size_t addr = mem_reserve(enc);
-
-	const node then_substmt = statement_if_get_then_substmt(nd);
-	emit_statement(enc, &then_substmt);
-
-	if (statement_if_has_else_substmt(nd))
+	for (size_t i = 0; i < vector_size(&la->factors); i += 2)
 	{
-		mem_set(enc, addr, (item_t)mem_size(enc) + 2);
-		mem_add(enc, IC_B);
-		addr = mem_reserve(enc);
-
-		const node else_substmt = statement_if_get_else_substmt(nd);
-		emit_statement(enc, &else_substmt);
+		mem_add(enc, IC_LI);
+		mem_add(enc, vector_get(&la->factors, i) * la->step);
+		mem_add_variable(enc, IC_ADD_ASSIGN_V, vector_get(&la->factors, i + 1));
 	}
-
-	mem_set(enc, addr, (item_t)mem_size(enc));
 }
 
 /**
- *	Emit switch statement
+ *	Release temporaries of loop and free allocated memory
  *
  *	@param	enc			Encoder
- *	@param	nd			Node in AST
+ *	@param	la			Loop analysis
  */
-static void emit_switch_statement(encoder *const enc, const node *const nd)
+static void loop_clear(encoder *const enc, loop_analysis *const la)
 {
-	const size_t old_addr_break = enc->addr_break;
-	const size_t old_addr_case = enc->addr_case;
-	enc->addr_break = 0;
-	enc->addr_case = 0;
-
-	const node condition = statement_switch_get_condition(nd);
-	emit_expression(enc, &condition);
-
-	const node body = statement_switch_get_body(nd);
-	emit_statement(enc, &body);
-
-	if (enc->addr_case > 0)
+	for (size_t i = 0; i < vector_size(&la->hoisted); i++)
 	{
-		mem_set(enc, enc->addr_case, (item_t)mem_size(enc));
+		hash_remove(&enc->temporaries, vector_get(&la->hoisted, i));
 	}
 
-	addr_end_break(enc);
+	for (size_t i = 0; i < vector_size(&la->products); i++)
+	{
+		hash_remove(&enc->temporaries, vector_get(&la->products, i));
+	}
 
-	enc->addr_case = old_addr_case;
-	enc->addr_break = old_addr_break;
+	hash_clear(&la->writes);
+	hash_clear(&la->invariants);
+	vector_clear(&la->hoisted);
+	vector_clear(&la->products);
+	vector_clear(&la->factors);
 }
 
 /**
@@ -1805,6 +4782,10 @@ static void emit_switch_statement(encoder *const enc, const node *const nd)
  */
 static void emit_while_statement(encoder *const enc, const node *const nd)
 {
+	const item_t scope_displacement = enc->displ;
+	const node parts[] = { statement_while_get_condition(nd), statement_while_get_body(nd), node_broken() };
+	loop_analysis la = emit_loop_preheader(enc, parts, &parts[2]);
+
 	const size_t old_addr_break = enc->addr_break;
 	const size_t old_addr_cond = enc->addr_cond;
 	const size_t addr = mem_size(enc);
@@ -1813,20 +4794,20 @@ static void emit_while_statement(encoder *const enc, const node *const nd)
 	const node condition = statement_while_get_condition(nd);
 	emit_expression(enc, &condition);
 
-	mem_add(enc, IC_BE0);
-	enc->addr_break = mem_size(enc);
-	mem_add(enc, 0);
+	enc->addr_break = mem_add_jump(enc, IC_BE0, 0);
 
 	const node body = statement_while_get_body(nd);
 	emit_statement(enc, &body);
 
 	addr_begin_condition(enc, addr);
-	mem_add(enc, IC_B);
-	mem_add(enc, (item_t)addr);
+	mem_add_jump(enc, IC_B, (item_t)addr);
 	addr_end_break(enc);
 
 	enc->addr_break = old_addr_break;
 	enc->addr_cond = old_addr_cond;
+
+	loop_clear(enc, &la);
+	enc->displ = scope_displacement;
 }
 
 /**
@@ -1837,6 +4818,10 @@ static void emit_while_statement(encoder *const enc, const node *const nd)
  */
 static void emit_do_statement(encoder *const enc, const node *const nd)
 {
+	const item_t scope_displacement = enc->displ;
+	const node parts[] = { statement_do_get_condition(nd), statement_do_get_body(nd), node_broken() };
+	loop_analysis la = emit_loop_preheader(enc, parts, &parts[2]);
+
 	const size_t old_addr_break = enc->addr_break;
 	const size_t old_addr_cond = enc->addr_cond;
 	const item_t addr = (item_t)mem_size(enc);
@@ -1851,12 +4836,14 @@ static void emit_do_statement(encoder *const enc, const node *const nd)
 	const node condition = statement_do_get_condition(nd);
 	emit_expression(enc, &condition);
 
-	mem_add(enc, IC_BNE0);
-	mem_add(enc, addr);
+	mem_add_jump(enc, IC_BNE0, addr);
 	addr_end_break(enc);
 
 	enc->addr_break = old_addr_break;
 	enc->addr_cond = old_addr_cond;
+
+	loop_clear(enc, &la);
+	enc->displ = scope_displacement;
 }
 
 /**
@@ -1874,6 +4861,14 @@ static void emit_for_statement(encoder *const enc, const node *const nd)
 		emit_statement(enc, &inition);
 	}
 
+	const node parts[] =
+	{
+		statement_for_has_condition(nd) ? statement_for_get_condition(nd) : node_broken(),
+		statement_for_get_body(nd),
+		statement_for_has_increment(nd) ? statement_for_get_increment(nd) : node_broken()
+	};
+	loop_analysis la = emit_loop_preheader(enc, parts, &parts[2]);
+
 	const size_t old_addr_break = enc->addr_break;
 	const size_t old_addr_cond = enc->addr_cond;
 	enc->addr_cond = 0;
@@ -1885,9 +4880,7 @@ static void emit_for_statement(encoder *const enc, const node *const nd)
 		const node condition = statement_for_get_condition(nd);
 		emit_expression(enc, &condition);
 
-		mem_add(enc, IC_BE0);
-		enc->addr_break = mem_size(enc);
-		mem_add(enc, 0);
+		enc->addr_break = mem_add_jump(enc, IC_BE0, 0);
 	}
 
 	const node body = statement_for_get_body(nd);
@@ -1898,14 +4891,16 @@ static void emit_for_statement(encoder *const enc, const node *const nd)
 	{
 		const node increment = statement_for_get_increment(nd);
 		emit_void_expression(enc, &increment);
+		emit_loop_induction(enc, &la);
 	}
 
-	mem_add(enc, IC_B);
-	mem_add(enc, (item_t)addr_init);
+	mem_add_jump(enc, IC_B, (item_t)addr_init);
 	addr_end_break(enc);
 
 	enc->addr_break = old_addr_break;
 	enc->addr_cond = old_addr_cond;
+
+	loop_clear(enc, &la);
 	enc->displ = scope_displacement;
 }
 
@@ -1916,9 +4911,7 @@ static void emit_for_statement(encoder *const enc, const node *const nd)
  */
 static void emit_continue_statement(encoder *const enc)
 {
-	mem_add(enc, IC_B);
-	mem_add(enc, (item_t)enc->addr_cond);
-	enc->addr_cond = mem_size(enc) - 1;
+	enc->addr_cond = mem_add_jump(enc, IC_B, (item_t)enc->addr_cond);
 }
 
 /**
@@ -1928,9 +4921,7 @@ static void emit_continue_statement(encoder *const enc)
  */
 static void emit_break_statement(encoder *const enc)
 {
-	mem_add(enc, IC_B);
-	mem_add(enc, (item_t)enc->addr_break);
-	enc->addr_break = mem_size(enc) - 1;
+	enc->addr_break = mem_add_jump(enc, IC_B, (item_t)enc->addr_break);
 }
 
 /**
@@ -1946,6 +4937,18 @@ static void emit_return_statement(encoder *const enc, const node *const nd)
 		const node expr = statement_return_get_expression(nd);
 		const item_t type = expression_get_type(&expr);
 
+		if (enc->is_extended && !enc->has_escapes && expression_get_class(&expr) == EXPR_CALL)
+		{
+			const node callee = expression_call_get_callee(&expr);
+			const node definition = inline_get_definition(enc, &expr);
+			if (expression_get_class(&callee) == EXPR_IDENTIFIER
+				&& expression_identifier_get_id(&callee) >= BEGIN_USER_FUNC && !node_is_correct(&definition))
+			{
+				emit_tail_call(enc, &expr);
+				return;
+			}
+		}
+
 		emit_expression(enc, &expr);
 
 		mem_add(enc, IC_RETURN_VAL);
@@ -1965,7 +4968,19 @@ static void emit_return_statement(encoder *const enc, const node *const nd)
  */
 static void emit_statement(encoder *const enc, const node *const nd)
 {
-	switch (statement_get_class(nd))
+	const statement_t stmt_class = statement_get_class(nd);
+	if (enc->is_debug && stmt_class != STMT_COMPOUND)
+	{
+		// Позиция оператора объявления не задана, если он ещё не достроен
+		const range_location loc = node_get_location(nd);
+		if (loc.begin != (size_t)ITEM_MAX)
+		{
+			const comment cmt = cmt_index_search(enc->index, loc.begin);
+			lines_add(enc, cmt_get_line(&cmt));
+		}
+	}
+
+	switch (stmt_class)
 	{
 		case STMT_DECL:
 			emit_declaration_statement(enc, nd);
@@ -1984,7 +4999,7 @@ static void emit_statement(encoder *const enc, const node *const nd)
 			return;
 
 		case STMT_EXPR:
-			emit_void_expression(enc, nd);
+			emit_expression_statement(enc, nd);
 			return;
 
 		case STMT_NULL:
@@ -2024,6 +5039,195 @@ static void emit_statement(encoder *const enc, const node *const nd)
 	}
 }
 
+static void reachability_mark(reachability *const rch, const size_t index)
+{
+	if (vector_get(&rch->is_reachable, index) == 0)
+	{
+		vector_set(&rch->is_reachable, index, 1);
+		vector_add(&rch->stack, (item_t)index);
+	}
+}
+
+static int mark_identifier(void *const context, const node *const nd)
+{
+	reachability *const rch = context;
+	const item_t owner = vector_get(&rch->owners, expression_identifier_get_id(nd));
+	if (owner > 0)
+	{
+		reachability_mark(rch, (size_t)owner - 1);
+	}
+
+	return 0;
+}
+
+static int find_side_effect(void *const context, const node *const nd)
+{
+	reachability *const rch = context;
+	if (node_get_type(nd) == OP_UNARY)
+	{
+		const unary_t operator = expression_unary_get_operator(nd);
+		if (operator != UN_POSTINC && operator != UN_POSTDEC && operator != UN_PREINC && operator != UN_PREDEC)
+		{
+			return 0;
+		}
+	}
+
+	rch->has_side_effects = true;
+	return -1;
+}
+
+/**
+ *	Check if global variable declaration has side effects and must be emitted even if unused
+ *
+ *	@param	rch			Reachability analysis
+ *	@param	nd			Variable declaration
+ *
+ *	@return	@c true on side effects, @c false otherwise
+ */
+static bool declaration_has_side_effects(reachability *const rch, const node *const nd)
+{
+	visitor vis = visitor_create(rch);
+	visitor_set(&vis, OP_CALL, &find_side_effect, NULL);
+	visitor_set(&vis, OP_ASSIGNMENT, &find_side_effect, NULL);
+	visitor_set(&vis, OP_UNARY, &find_side_effect, NULL);
+
+	rch->has_side_effects = false;
+	visitor_walk(&vis, nd);
+	visitor_clear(&vis);
+
+	return rch->has_side_effects;
+}
+
+/**
+ *	Find external declarations reachable from main through calls, function pointers and initializers.
+ *	Structure declarations and global variables with side effects in initializers are always reachable,
+ *	without pruning all declarations are reachable.
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Translation unit
+ *
+ *	@return	Flags of external declarations
+ */
+static vector reachability_analyze(const encoder *const enc, const node *const nd)
+{
+	const size_t size = translation_unit_get_size(nd);
+	reachability rch = { .sx = enc->sx };
+	rch.is_reachable = vector_create(size);
+	vector_increase(&rch.is_reachable, size);
+	if (!enc->is_pruning)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			vector_set(&rch.is_reachable, i, 1);
+		}
+
+		return rch.is_reachable;
+	}
+
+	rch.owners = vector_create(vector_size(&enc->sx->identifiers));
+	rch.stack = vector_create(size);
+	vector_increase(&rch.owners, vector_size(&enc->sx->identifiers));
+
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(nd, i);
+		switch (declaration_get_class(&decl))
+		{
+			case DECL_VAR:
+				vector_set(&rch.owners, declaration_variable_get_id(&decl), (item_t)i + 1);
+				if (declaration_has_side_effects(&rch, &decl))
+				{
+					reachability_mark(&rch, i);
+				}
+				break;
+
+			case DECL_FUNC:
+			{
+				// Вызовы до определения функции ссылаются на её прототип
+				const size_t identifier = declaration_function_get_id(&decl);
+				const size_t prototype = ident_get_prev(enc->sx, identifier);
+				vector_set(&rch.owners, identifier, (item_t)i + 1);
+				if (prototype >= BEGIN_USER_FUNC && type_is_function(enc->sx, ident_get_type(enc->sx, prototype)))
+				{
+					vector_set(&rch.owners, prototype, (item_t)i + 1);
+				}
+				break;
+			}
+
+			default:
+				reachability_mark(&rch, i);
+				break;
+		}
+	}
+
+	const item_t main_owner = vector_get(&rch.owners, enc->sx->ref_main);
+	if (main_owner > 0)
+	{
+		reachability_mark(&rch, (size_t)main_owner - 1);
+	}
+
+	visitor vis = visitor_create(&rch);
+	visitor_set(&vis, OP_IDENTIFIER, &mark_identifier, NULL);
+	while (vector_size(&rch.stack) != 0)
+	{
+		const node decl = translation_unit_get_declaration(nd, (size_t)vector_remove(&rch.stack));
+		visitor_walk(&vis, &decl);
+	}
+
+	visitor_clear(&vis);
+	vector_clear(&rch.owners);
+	vector_clear(&rch.stack);
+	return rch.is_reachable;
+}
+
+/**
+ *	Get reachable function definitions ordered by number of their calls in profile
+ *
+ *	@param	enc			Encoder
+ *	@param	nd			Translation unit
+ *	@param	is_reachable	Reachability flags of declarations
+ *
+ *	@return	Indexes of function definitions in translation unit
+ */
+static vector functions_order(encoder *const enc, const node *const nd, const vector *const is_reachable)
+{
+	vector order = vector_create(0);
+	if (!enc->is_profiled)
+	{
+		return order;
+	}
+
+	vector counts = vector_create(0);
+
+	const size_t size = translation_unit_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(nd, i);
+		if (vector_get(is_reachable, i) == 0 || declaration_get_class(&decl) != DECL_FUNC)
+		{
+			continue;
+		}
+
+		const item_t count = profile_get(enc, declaration_function_get_id(&decl), NULL);
+
+		// Сортировка вставками устойчива, поэтому функции без счётчиков остаются в исходном порядке
+		size_t j = vector_size(&order);
+		vector_add(&order, 0);
+		vector_add(&counts, 0);
+		for (; j > 0 && vector_get(&counts, j - 1) < (count == ITEM_MAX ? 0 : count); j--)
+		{
+			vector_set(&order, j, vector_get(&order, j - 1));
+			vector_set(&counts, j, vector_get(&counts, j - 1));
+		}
+
+		vector_set(&order, j, (item_t)i);
+		vector_set(&counts, j, count == ITEM_MAX ? 0 : count);
+	}
+
+	vector_clear(&counts);
+	return order;
+}
+
 /**
  *	Emit translation unit
  *
@@ -2032,13 +5236,30 @@ static void emit_statement(encoder *const enc, const node *const nd)
  */
 static void emit_translation_unit(encoder *const enc, const node *const nd)
 {
+	// Недостижимые из main функции и глобальные переменные не попадают в таблицы
+	vector is_reachable = reachability_analyze(enc, nd);
+	vector order = functions_order(enc, nd, &is_reachable);
+
+	// Места определений функций занимаются ими в порядке убывания числа вызовов
+	size_t next = 0;
 	const size_t size = translation_unit_get_size(nd);
 	for (size_t i = 0; i < size; i++)
 	{
-		const node decl = translation_unit_get_declaration(nd, i);
-		emit_declaration(enc, &decl);
+		if (vector_get(&is_reachable, i) != 0)
+		{
+			node decl = translation_unit_get_declaration(nd, i);
+			if (enc->is_profiled && declaration_get_class(&decl) == DECL_FUNC)
+			{
+				decl = translation_unit_get_declaration(nd, (size_t)vector_get(&order, next++));
+			}
+
+			emit_declaration(enc, &decl);
+		}
 	}
 
+	vector_clear(&order);
+	vector_clear(&is_reachable);
+
 	const item_t main_displ = displacements_get(enc, enc->sx->ref_main);
 
 	mem_add(enc, IC_CALL1);
@@ -2063,18 +5284,29 @@ int encode_to_vm(const workspace *const ws, syntax *const sx)
 	{
 		return -1;
 	}
+	COUNTER_OUTPUT(COUNTER_PRINTF_VM);
 	encoder enc = enc_create(ws, sx);
 
 	const node root = node_get_root(&sx->tree);
 	emit_translation_unit(&enc, &root);
+	optimize_jumps(&enc);
+	stack_depths(&enc);
+	if (enc.is_binary)
+	{
+		function_index(&enc);
+	}
 
-#ifndef NDEBUG
-	write_codes(DEFAULT_CODES, &enc.memory);
-#endif
-	for (ii=0; ii<=pconnect; ii++)
+	write_codes_dump(ws, &enc.memory);
+	if (ws_has_option(ws, OPT_COST_REPORT) || ws_has_option(ws, OPT_COST_REPORT_JSON))
 	{
-		printf("%zi %zi\n", connect[ii].line, connect[ii].pc);
+		cost_report(&enc, ws_has_option(ws, OPT_COST_REPORT_JSON));
 	}
+
+	if (ws_has_option(ws, OPT_PROFILE))
+	{
+		write_profile(DEFAULT_PROFILE, &enc.memory);
+	}
+
 	int ret = reporter_get_errors_number(&enc.sx->rprt) != 0 ? 1 : 0;
 	if (!ret)
 	{
@@ -2082,5 +5314,6 @@ int encode_to_vm(const workspace *const ws, syntax *const sx)
 	}
 
 	enc_clear(&enc);
+	COUNTER_OUTPUT(COUNTER_PRINTF);
 	return ret;
 }
@@ -25,7 +25,8 @@ extern "C" {
 #endif
 
 /**
- *	Encode to virtual machine codes
+ *	Encode to virtual machine codes,
+ *	functions and global variables unreachable from main are not emitted
  *
  *	@param	ws				Compiler workspace
  *	@param	sx				Syntax structure
@@ -15,6 +15,8 @@
  */
 
 #include "compiler.h"
+#include <inttypes.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "codegen.h"
@@ -23,24 +25,58 @@
 #include "llvmgen.h"
 #include "parser.h"
 #include "macro.h"
+#include "profiler.h"
+#include "regvmgen.h"
+#include "remote.h"
+#include "scheduler.h"
 #include "syntax.h"
 #include "uniio.h"
+#include "writer.h"
 
 #ifndef _WIN32
 	#include <sys/stat.h>
 	#include <sys/types.h>
+	#include <unistd.h>
+#else
+	#include <direct.h>
 #endif
 
 
 static const char *const DEFAULT_MACRO = "macro.txt";
+static const char *const DEFAULT_SOURCE = "source.c";
 
 static const char *const DEFAULT_VM = "out.ruc";
 static const char *const DEFAULT_LLVM = "out.ll";
+static const char *const DEFAULT_BITCODE = "out.bc";
 static const char *const DEFAULT_MIPS = "out.s";
+static const char *const DEFAULT_RVM = "out.rvm";
+
+static const size_t OUTPUT_BUFFER_SIZE = 4096;
+
+static const char *const LLVM_SUFFIX = ".ll";
+static const char *const BITCODE_SUFFIX = ".bc";
+
+static const char *const HASH_SUFFIX = ".hash";
+static const char *const SNAPSHOT_SUFFIX = ".sx";
+
+static const char *const PCH_FLAG = "--pch";
+static const char *const PCH_DIR_FLAG = "--pch=";
+static const char *const DEFAULT_PCH_DIR = "pch_cache";
+static const char *const PCH_SUFFIX = ".pch";
+
+static const uint64_t HASH_BASIS = 14695981039346656037ULL;
+static const uint64_t HASH_PRIME = 1099511628211ULL;
 
 
 typedef int (*encoder)(const workspace *const ws, syntax *const sx);
 
+/** Independent compilation jobs run by scheduler */
+typedef struct batch
+{
+	workspace *jobs;				/**< Workspaces of jobs */
+	status_t *statuses;				/**< Statuses of jobs */
+} batch;
+
 
 /** Make executable actually executable on best-effort basis (if possible) */
 static inline void make_executable(const char *const path)
@@ -60,37 +96,308 @@ static inline void make_executable(const char *const path)
 }
 
 
-static status_t compile_from_io(const workspace *const ws, universal_io *const io, const encoder enc)
+static inline uint64_t hash_bytes(uint64_t hash, const char *const bytes, const size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ (unsigned char)bytes[i]) * HASH_PRIME;
+	}
+
+	return hash * HASH_PRIME;
+}
+
+static inline uint64_t hash_string(uint64_t hash, const char *const str)
+{
+	for (size_t i = 0; str[i] != '\0'; i++)
+	{
+		hash = (hash ^ (unsigned char)str[i]) * HASH_PRIME;
+	}
+
+	// Разделитель, чтобы склейка строк давала другой хеш
+	return hash * HASH_PRIME;
+}
+
+/** Add compilation flags to hash of preprocessed input */
+static uint64_t get_flags_hash(const workspace *const ws, uint64_t hash)
+{
+	const size_t flags = ws_get_flags_num(ws);
+	for (size_t i = 0; i < flags; i++)
+	{
+		hash = hash_string(hash, ws_get_flag(ws, i));
+	}
+
+	return hash;
+}
+
+/** Check that output exists and was built from input with the same hash */
+static bool is_output_actual(const char *const output, const uint64_t hash)
+{
+	char path[MAX_ARG_SIZE + 8];
+	sprintf(path, "%s%s", output, HASH_SUFFIX);
+
+	FILE *file = fopen(output, "rb");
+	if (file == NULL)
+	{
+		return false;
+	}
+	fclose(file);
+
+	file = fopen(path, "r");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	uint64_t saved;
+	const bool is_read = fscanf(file, "%" SCNx64, &saved) == 1;
+	fclose(file);
+
+	return is_read && saved == hash;
+}
+
+/** Remember hash of input, from which output was built */
+static void save_output_hash(const char *const output, const uint64_t hash)
+{
+	char path[MAX_ARG_SIZE + 8];
+	sprintf(path, "%s%s", output, HASH_SUFFIX);
+
+	FILE *file = fopen(path, "w");
+	if (file != NULL)
+	{
+		fprintf(file, "%016" PRIx64 "\n", hash);
+		fclose(file);
+	}
+}
+
+
+/** Get directory of precompiled headers from flags, @c NULL if they are disabled */
+static const char *pch_get_dir(const workspace *const ws)
+{
+	const char *const dir = ws_get_flag_value(ws, PCH_DIR_FLAG);
+	if (dir != NULL)
+	{
+		return dir;
+	}
+
+	return ws_has_flag(ws, PCH_FLAG) ? DEFAULT_PCH_DIR : NULL;
+}
+
+/**
+ *	Get size of preprocessed code, which comes from headers included before the first line of main file
+ *
+ *	@param	sx			Syntax structure
+ *	@param	main		Path of main file
+ *
+ *	@return	Size of prefix, @c 0 if code does not start with headers
+ */
+static size_t pch_get_prefix(const syntax *const sx, const char *const main)
 {
-	if (!in_is_correct(io) || !out_is_correct(io))
+	const char *const code = sx->src.code;
+	const size_t size = sx->src.size;
+	const comment_index *const index = source_get_index(&sx->src);
+	char path[MAX_ARG_SIZE];
+
+	bool has_headers = false;
+	bool is_marker = true;
+	size_t line = 0;
+	while (line < size)
+	{
+		size_t i = line;
+		while (i < size && (code[i] == ' ' || code[i] == '\t' || code[i] == '\r'))
+		{
+			i++;
+		}
+
+		// Файл меняется только после маркера, поэтому путь ищется лишь для первой строки кода за ним
+		if ((i + 1 < size && code[i] == '/' && code[i + 1] == '/') || cmt_index_is_marked(index, line))
+		{
+			is_marker = true;
+		}
+		else if (i < size && code[i] != '\n' && is_marker)
+		{
+			const comment cmt = source_search(&sx->src, i);
+			if (cmt_get_path(&cmt, path) == 0)
+			{
+				return 0;
+			}
+
+			if (strcmp(path, main) == 0)
+			{
+				return has_headers ? line : 0;
+			}
+
+			has_headers = true;
+			is_marker = false;
+		}
+
+		while (i < size && code[i] != '\n')
+		{
+			i++;
+		}
+		line = i + 1;
+	}
+
+	return 0;
+}
+
+/**
+ *	Parse program, continuing precompiled header of headers included at its beginning.
+ *	Header is keyed by its preprocessed code, so changes of included files or macros are detected.
+ *	If there is no such header, it is saved right after parsing of its declarations.
+ *
+ *	@param	ws			Compiler workspace
+ *	@param	io			Universal io structure
+ *	@param	sx			Syntax structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int parse_with_pch(const workspace *const ws, universal_io *const io, syntax *const sx)
+{
+	// Снимок заголовков не хранит вхождения идентификаторов, поэтому индекс строится полным разбором
+	const char *const dir = sx->is_indexed ? NULL : pch_get_dir(ws);
+	const size_t prefix = dir != NULL && ws_get_files_num(ws) != 0 ? pch_get_prefix(sx, ws_get_file(ws, 0)) : 0;
+	if (prefix == 0)
+	{
+		return parse(sx);
+	}
+
+	// Разбор зависит от уровня оптимизации и проверки синтаксиса, поэтому они входят в ключ заголовка
+	const uint64_t hash = hash_bytes(HASH_BASIS, sx->src.code, prefix);
+	const uint64_t key = sx->is_checked_only
+		? hash_string(hash, "-fsyntax-only")
+		: sx->is_optimized
+			? hash_string(hash, "-O1")
+			: hash;
+
+	char path[MAX_ARG_SIZE + 32];
+	sprintf(path, "%.*s/%016" PRIx64 "%s", MAX_ARG_SIZE, dir, key, PCH_SUFFIX);
+	if (!sx_load(sx, path, key))
+	{
+		return parse_range(sx, prefix, SIZE_MAX);
+	}
+
+	sx_clear(sx);
+	*sx = sx_create(ws, io);
+
+	const int ret = parse_range(sx, 0, prefix);
+	if (!ret)
+	{
+#ifndef _WIN32
+		mkdir(dir, 0777);
+#else
+		_mkdir(dir);
+#endif
+
+		// Запись во временный файл, чтобы параллельные сборки не прочитали его частично
+		char temp[MAX_ARG_SIZE + 40];
+		sprintf(temp, "%s.tmp", path);
+		if (!sx_save(sx, temp, key))
+		{
+#ifdef _WIN32
+			remove(path);
+#endif
+			if (rename(temp, path))
+			{
+				remove(temp);
+			}
+		}
+	}
+
+	const int rest = parse_range(sx, prefix, SIZE_MAX);
+	return ret || rest ? -1 : 0;
+}
+
+
+/** Check that main and all prototyped functions are defined */
+static int check_links(syntax *const sx, profiler *const prof)
+{
+	prof_begin(prof);
+	const int ret = !sx_is_correct(sx);
+	prof_end(prof, PHASE_LINK);
+	return ret;
+}
+
+static status_t compile_from_io(const workspace *const ws, universal_io *const io, const encoder enc, const uint64_t key
+	, profiler *const prof)
+{
+	// При проверке синтаксиса ничего не выводится
+	const bool is_checked_only = ws_has_option(ws, OPT_SYNTAX_ONLY);
+	if (!in_is_correct(io) || (!out_is_correct(io) && !is_checked_only))
 	{
 		error_msg("некорректные параметры ввода/вывода");
 		io_erase(io);
 		return sts_system_error;
 	}
 
+	// Снимок таблиц не зависит от флагов, поэтому общий для всех кодогенераторов
+	char path[MAX_ARG_SIZE + 8] = "";
+	if (key != 0)
+	{
+		sprintf(path, "%s%s", ws_get_output(ws), SNAPSHOT_SUFFIX);
+	}
+
+	prof_begin(prof);
 	syntax sx = sx_create(ws, io);
-	int ret = parse(&sx);
+
+	// При потоковой генерации описания разбирает кодогенератор, и снимок таблиц не строится
+	const bool has_snapshot = key != 0 && !sx.is_streaming && !sx.is_indexed;
+	const bool is_loaded = has_snapshot && !sx_load(&sx, path, key);
+	if (has_snapshot && !is_loaded)
+	{
+		sx_clear(&sx);
+		sx = sx_create(ws, io);
+	}
+
+	int ret = is_loaded || sx.is_streaming ? 0 : parse_with_pch(ws, io, &sx);
 	status_t sts = sts_parse_error;
+	write_tree_dump(ws, &sx);
+	write_xref_dump(ws, &sx);
+
+	if (!ret && has_snapshot && !is_loaded)
+	{
+		sx_save(&sx, path, key);
+	}
+
+	// Сообщения разбора выводятся до сообщений следующих стадий
+	reporter_flush(&sx.rprt, sx.io);
+	prof_end(prof, PHASE_PARSE);
 
-	if (!ret && !ws_has_flag(ws, "-c")) // Skip linker stage
+	const bool is_linked = !ws_has_option(ws, OPT_COMPILE_ONLY) && !is_checked_only;
+	if (!ret && is_linked && !sx.is_streaming) // Skip linker stage
 	{
-		ret = !sx_is_correct(&sx);
+		ret = check_links(&sx, prof);
 		sts = sts_link_error;
 	}
 
-	if (!ret)
+	if (!ret && !is_checked_only)
 	{
+		prof_begin(prof);
 		ret = enc(ws, &sx);
-		sts = sts_codegen_error;
+		sts = sx.is_streaming && reporter_get_errors_number(&sx.rprt) != 0 ? sts_parse_error : sts_codegen_error;
+		prof_end(prof, PHASE_CODEGEN);
+	}
+
+	// Все описания при потоковой генерации известны только после вывода кода
+	if (!ret && is_linked && sx.is_streaming)
+	{
+		ret = check_links(&sx, prof);
+		sts = sts_link_error;
 	}
 
+	prof_tables(prof, &sx);
 	sx_clear(&sx);
-	io_erase(io);
+
+	// Буфер вывода забирает вызывающая сторона
+	in_clear(io);
+	if (!out_is_buffer(io))
+	{
+		out_clear(io);
+	}
+
 	return ret ? sts : sts_success;
 }
 
-static status_t compile_from_ws(workspace *const ws, const encoder enc)
+static status_t compile_from_files(workspace *const ws, const encoder enc, profiler *const prof)
 {
 	if (!ws_is_correct(ws) || ws_get_files_num(ws) == 0)
 	{
@@ -98,41 +405,287 @@ static status_t compile_from_ws(workspace *const ws, const encoder enc)
 		return sts_system_error;
 	}
 
-	if (ws_has_flag(ws, "-E"))
+	if (ws_has_option(ws, OPT_PREPROCESS_ONLY))
 	{
-		return macro_to_file(ws, ws_get_output(ws)) ? sts_macro_error : sts_success;
+		prof_begin(prof);
+		const int ret = macro_to_file(ws, ws_get_output(ws));
+		prof_end(prof, PHASE_MACRO);
+		return ret ? sts_macro_error : sts_success;
 	}
 
 	universal_io io = io_create();
 
 #ifndef GENERATE_MACRO
 	// Препроцессинг в массив
+	prof_begin(prof);
 	char *const preprocessing = macro(ws); // макрогенерация
+	prof_end(prof, PHASE_MACRO);
 	if (preprocessing == NULL)
 	{
 		return sts_macro_error;
 	}
 
+	// Повторная компиляция не нужна, если входные данные и флаги не изменились
+	const bool is_incremental = ws_has_option(ws, OPT_INCREMENTAL) && !ws_has_option(ws, OPT_SYNTAX_ONLY);
+	// Разбор зависит от уровня оптимизации, поэтому он входит в ключ снимка
+	const uint64_t key = !is_incremental
+		? 0
+		: ws_has_option(ws, OPT_O1)
+			? hash_string(hash_string(HASH_BASIS, preprocessing), "-O1")
+			: hash_string(HASH_BASIS, preprocessing);
+	const uint64_t hash = is_incremental ? get_flags_hash(ws, key) : 0;
+	if (is_incremental && is_output_actual(ws_get_output(ws), hash))
+	{
+		free(preprocessing);
+		return sts_success;
+	}
+
+	// Модуль компилируется локально, если ни один из серверов не ответил
+	const int remote = ws_has_option(ws, OPT_SYNTAX_ONLY) ? -1 : remote_compile(ws, preprocessing);
+	if (remote != -1)
+	{
+		if (is_incremental && remote == sts_success)
+		{
+			save_output_hash(ws_get_output(ws), hash);
+		}
+
+		free(preprocessing);
+		return (status_t)remote;
+	}
+
+	// Метки строк нужны в тексте для кеша и удалённой компиляции, а здесь переносятся в карту
+	location_map locations = cmt_map_create();
+	cmt_map_extract(&locations, preprocessing);
 	in_set_buffer(&io, preprocessing);
+	in_set_locations(&io, &locations);
 #else
+	prof_begin(prof);
 	int ret_macro = macro_to_file(ws, DEFAULT_MACRO);
+	prof_end(prof, PHASE_MACRO);
 	if (ret_macro)
 	{
 		return sts_macro_error;
 	}
 
-	in_set_file(&io, DEFAULT_MACRO);
+	in_set_mmap(&io, DEFAULT_MACRO);
 #endif
 
-	out_set_file(&io, ws_get_output(ws));
-	const status_t sts = compile_from_io(ws, &io, enc);
+	if (!ws_has_option(ws, OPT_SYNTAX_ONLY))
+	{
+		out_set_file(&io, ws_get_output(ws));
+		if (ws_has_option(ws, OPT_ASYNC_OUTPUT))
+		{
+			// Если поток записи не создан, вывод остаётся синхронным
+			out_set_async(&io);
+		}
+	}
+
+#ifndef GENERATE_MACRO
+	const status_t sts = compile_from_io(ws, &io, enc, key, prof);
+#else
+	const status_t sts = compile_from_io(ws, &io, enc, 0, prof);
+#endif
 
 #ifndef GENERATE_MACRO
+	if (is_incremental && sts == sts_success)
+	{
+		save_output_hash(ws_get_output(ws), hash);
+	}
+
+	cmt_map_clear(&locations);
 	free(preprocessing);
 #endif
 	return sts;
 }
 
+/** Preprocess source text, which is not stored on disk */
+static char *macro_from_buffer(const char *const code)
+{
+	macro_context *const ctx = macro_create();
+	if (macro_add_buffer(ctx, DEFAULT_SOURCE, code))
+	{
+		macro_destroy(ctx);
+		return NULL;
+	}
+
+	char *const preprocessing = macro_finish(ctx);
+	macro_destroy(ctx);
+	return preprocessing;
+}
+
+static status_t compile_from_memory(workspace *const ws, const encoder enc, const char *const code
+	, const bool is_preprocessed, char **const buffer, size_t *const size, profiler *const prof)
+{
+	if (!ws_is_correct(ws) || (code == NULL && ws_get_files_num(ws) == 0))
+	{
+		error_msg("некорректные входные данные");
+		return sts_system_error;
+	}
+
+	// Уже обработанный текст не проходит препроцессор повторно, иначе пропали бы метки строк
+	prof_begin(prof);
+	char *const preprocessing = is_preprocessed ? NULL : code != NULL ? macro_from_buffer(code) : macro(ws);
+	prof_end(prof, PHASE_MACRO);
+	if (preprocessing == NULL && !is_preprocessed)
+	{
+		return sts_macro_error;
+	}
+
+	// Переданный текст не изменяется, поэтому его метки строк остаются комментариями
+	location_map locations = cmt_map_create();
+	cmt_map_extract(&locations, preprocessing);
+
+	universal_io io = io_create();
+	in_set_buffer(&io, is_preprocessed ? code : preprocessing);
+	in_set_locations(&io, is_preprocessed ? NULL : &locations);
+	out_set_buffer(&io, OUTPUT_BUFFER_SIZE);
+
+	const status_t sts = compile_from_io(ws, &io, enc, 0, prof);
+	if (sts == sts_success)
+	{
+		*size = out_get_position(&io);
+		*buffer = out_extract_buffer(&io);
+	}
+
+	io_erase(&io);
+	cmt_map_clear(&locations);
+	free(preprocessing);
+	return sts;
+}
+
+static status_t compile_to_memory(workspace *const ws, const encoder enc, const status_t target
+	, const char *const code, const bool is_preprocessed, char **const buffer, size_t *const size)
+{
+	if (buffer == NULL || size == NULL)
+	{
+		error_msg("некорректные параметры ввода/вывода");
+		return sts_system_error;
+	}
+
+	*buffer = NULL;
+	*size = 0;
+
+	const logger error_log = set_thread_error_log(ws != NULL ? ws->error_log : NULL);
+	const logger warning_log = set_thread_warning_log(ws != NULL ? ws->warning_log : NULL);
+
+	profiler prof = prof_create(ws);
+	const status_t sts = compile_from_memory(ws, enc, code, is_preprocessed, buffer, size, &prof);
+	prof_report(&prof, ws);
+
+	set_thread_error_log(error_log);
+	set_thread_warning_log(warning_log);
+	return sts == sts_codegen_error ? target : sts;
+}
+
+/** Compile source text with default flags */
+static status_t compile_buffer(const char *const code, const encoder enc, const status_t target
+	, char **const buffer, size_t *const size)
+{
+	if (code == NULL)
+	{
+		error_msg("некорректные входные данные");
+		return sts_system_error;
+	}
+
+	workspace ws = ws_create();
+	const status_t sts = compile_to_memory(&ws, enc, target, code, false, buffer, size);
+	ws_clear(&ws);
+	return sts;
+}
+
+static status_t compile_from_ws(workspace *const ws, const encoder enc)
+{
+	// Сообщения задания идут в журналы рабочего пространства, не мешая заданиям других потоков
+	const logger error_log = set_thread_error_log(ws != NULL ? ws->error_log : NULL);
+	const logger warning_log = set_thread_warning_log(ws != NULL ? ws->warning_log : NULL);
+
+	profiler prof = prof_create(ws);
+	const status_t sts = compile_from_files(ws, enc, &prof);
+	prof_report(&prof, ws);
+
+	set_thread_error_log(error_log);
+	set_thread_warning_log(warning_log);
+	return sts;
+}
+
+
+/** Compile job of batch with index */
+static void batch_run(void *const context, const size_t index)
+{
+	batch *const bt = context;
+	bt->statuses[index] = compile(&bt->jobs[index]);
+}
+
+
+/** Check that all input files are separately compiled LLVM modules */
+static bool is_llvm_units(const workspace *const ws)
+{
+	const size_t files = ws_get_files_num(ws);
+	for (size_t i = 0; i < files; i++)
+	{
+		const char *const extension = strrchr(ws_get_file(ws, i), '.');
+		if (extension == NULL || (strcmp(extension, LLVM_SUFFIX) != 0 && strcmp(extension, BITCODE_SUFFIX) != 0))
+		{
+			return false;
+		}
+	}
+
+	return files != 0;
+}
+
+/** Compile each input file into its own unit next to it, units are compiled concurrently */
+static status_t compile_units(const workspace *const ws, const char *const suffix)
+{
+	const size_t num = ws_get_files_num(ws);
+	workspace *const jobs = malloc(num * sizeof(workspace));
+	status_t *const statuses = malloc(num * sizeof(status_t));
+	if (jobs == NULL || statuses == NULL)
+	{
+		free(jobs);
+		free(statuses);
+		return sts_system_error;
+	}
+
+	for (size_t i = 0; i < num; i++)
+	{
+		const char *const file = ws_get_file(ws, i);
+		const char *const extension = strrchr(file, '.');
+		const char *const separator = strrchr(file, '/');
+		const size_t length = extension != NULL && (separator == NULL || extension > separator)
+			? (size_t)(extension - file)
+			: strlen(file);
+
+		char output[MAX_ARG_SIZE];
+		snprintf(output, MAX_ARG_SIZE, "%.*s%s", (int)length, file, suffix);
+
+		jobs[i] = ws_create();
+		ws_add_file(&jobs[i], file);
+		ws_set_output(&jobs[i], output);
+		ws_set_log(&jobs[i], ws->error_log, ws->warning_log);
+		for (size_t j = 0; j < ws_get_dirs_num(ws); j++)
+		{
+			ws_add_dir(&jobs[i], ws_get_dir(ws, j));
+		}
+		for (size_t j = 0; j < ws_get_flags_num(ws); j++)
+		{
+			ws_add_flag(&jobs[i], ws_get_flag(ws, j));
+		}
+	}
+
+	compile_batch(jobs, statuses, num);
+
+	status_t sts = sts_success;
+	for (size_t i = 0; i < num; i++)
+	{
+		sts = sts == sts_success ? statuses[i] : sts;
+		ws_clear(&jobs[i]);
+	}
+
+	free(jobs);
+	free(statuses);
+	return sts;
+}
+
 
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
@@ -145,15 +698,24 @@ static status_t compile_from_ws(workspace *const ws, const encoder enc)
 
 status_t compile(workspace *const ws)
 {
-	if (ws_has_flag(ws, "-LLVM"))
+	// Проверка синтаксиса не зависит от целевой платформы
+	if (ws_has_option(ws, OPT_SYNTAX_ONLY))
+	{
+		return compile_from_ws(ws, NULL);
+	}
+	else if (ws_has_option(ws, OPT_LLVM))
 	{
 		return compile_to_llvm(ws);
 	}
-	else if (ws_has_flag(ws, "-MIPS"))
+	else if (ws_has_option(ws, OPT_MIPS))
 	{
 		return compile_to_mips(ws);
 	}
-	else // if (ws_has_flag(ws, "-VM"))
+	else if (ws_has_option(ws, OPT_RVM))
+	{
+		return compile_to_rvm(ws);
+	}
+	else // if (ws_has_option(ws, OPT_VM))
 	{
 		return compile_to_vm(ws);
 	}
@@ -177,25 +739,140 @@ status_t compile_to_vm(workspace *const ws)
 
 status_t compile_to_llvm(workspace *const ws)
 {
+	// Каждый файл компилируется в свой модуль, а модули связываются отдельным вызовом
+	if (ws_has_option(ws, OPT_COMPILE_ONLY) && ws_get_files_num(ws) > 1)
+	{
+		return compile_units(ws, ws_has_option(ws, OPT_BITCODE) ? BITCODE_SUFFIX : LLVM_SUFFIX);
+	}
+
 	if (ws_get_output(ws) == NULL)
 	{
-		ws_set_output(ws, DEFAULT_LLVM);
+		ws_set_output(ws, ws_has_option(ws, OPT_BITCODE) ? DEFAULT_BITCODE : DEFAULT_LLVM);
+	}
+
+	if (is_llvm_units(ws))
+	{
+		const logger error_log = set_thread_error_log(ws->error_log);
+		const int ret = link_llvm(ws);
+		set_thread_error_log(error_log);
+		return ret ? sts_link_error : sts_success;
 	}
 
 	const status_t sts = compile_from_ws(ws, &encode_to_llvm);
 	return sts == sts_codegen_error ? sts_llvm_error : sts;
 }
 
-int compile_to_mips(workspace *const ws)
+status_t compile_to_mips(workspace *const ws)
 {
 	if (ws_get_output(ws) == NULL)
 	{
 		ws_set_output(ws, DEFAULT_MIPS);
 	}
 
-	return compile_from_ws(ws, &encode_to_mips);
+	const status_t sts = compile_from_ws(ws, &encode_to_mips);
+	return sts == sts_codegen_error ? sts_mips_error : sts;
 }
 
+status_t compile_to_rvm(workspace *const ws)
+{
+	if (ws_get_output(ws) == NULL)
+	{
+		ws_set_output(ws, DEFAULT_RVM);
+	}
+
+	const status_t sts = compile_from_ws(ws, &encode_to_rvm);
+	return sts == sts_codegen_error ? sts_rvm_error : sts;
+}
+
+status_t compile_to_buffer(workspace *const ws, char **const buffer, size_t *const size)
+{
+	if (ws_has_option(ws, OPT_LLVM))
+	{
+		return compile_to_memory(ws, &encode_to_llvm, sts_llvm_error, NULL, false, buffer, size);
+	}
+	else if (ws_has_option(ws, OPT_MIPS))
+	{
+		return compile_to_memory(ws, &encode_to_mips, sts_mips_error, NULL, false, buffer, size);
+	}
+	else if (ws_has_option(ws, OPT_RVM))
+	{
+		return compile_to_memory(ws, &encode_to_rvm, sts_rvm_error, NULL, false, buffer, size);
+	}
+	else
+	{
+		return compile_to_memory(ws, &encode_to_vm, sts_virtul_error, NULL, false, buffer, size);
+	}
+}
+
+status_t compile_preprocessed_to_buffer(workspace *const ws, const char *const code
+	, char **const buffer, size_t *const size)
+{
+	if (code == NULL)
+	{
+		error_msg("некорректные входные данные");
+		return sts_system_error;
+	}
+
+	if (ws_has_option(ws, OPT_SYNTAX_ONLY))
+	{
+		return compile_to_memory(ws, NULL, sts_codegen_error, code, true, buffer, size);
+	}
+	else if (ws_has_option(ws, OPT_LLVM))
+	{
+		return compile_to_memory(ws, &encode_to_llvm, sts_llvm_error, code, true, buffer, size);
+	}
+	else if (ws_has_option(ws, OPT_MIPS))
+	{
+		return compile_to_memory(ws, &encode_to_mips, sts_mips_error, code, true, buffer, size);
+	}
+	else if (ws_has_option(ws, OPT_RVM))
+	{
+		return compile_to_memory(ws, &encode_to_rvm, sts_rvm_error, code, true, buffer, size);
+	}
+	else
+	{
+		return compile_to_memory(ws, &encode_to_vm, sts_virtul_error, code, true, buffer, size);
+	}
+}
+
+status_t compile_and_run(workspace *const ws, int *const result)
+{
+	char *buffer = NULL;
+	size_t size = 0;
+
+	status_t sts = compile_to_memory(ws, &encode_to_llvm, sts_llvm_error, NULL, false, &buffer, &size);
+	if (sts == sts_success && run_llvm(ws, buffer, size, result))
+	{
+		sts = sts_llvm_error;
+	}
+
+	free(buffer);
+	return sts;
+}
+
+status_t compile_buffer_to_vm(const char *const code, char **const buffer, size_t *const size)
+{
+	return compile_buffer(code, &encode_to_vm, sts_virtul_error, buffer, size);
+}
+
+status_t compile_buffer_to_llvm(const char *const code, char **const buffer, size_t *const size)
+{
+	return compile_buffer(code, &encode_to_llvm, sts_llvm_error, buffer, size);
+}
+
+
+void compile_batch(workspace *const jobs, status_t *const statuses, const size_t num)
+{
+	if (jobs == NULL || statuses == NULL || num == 0)
+	{
+		return;
+	}
+
+	// Задания и их вложенные задачи делят одни ядра, поэтому долгие задания не задерживают остальные
+	batch bt = { .jobs = jobs, .statuses = statuses };
+	scheduler_set_jobs(ws_get_jobs(&jobs[0]));
+	scheduler_for(&batch_run, &bt, num);
+}
 
 
 int auto_compile(const int argc, const char *const *const argv)
@@ -230,18 +907,27 @@ int auto_compile_to_mips(const int argc, const char *const *const argv)
 	return ret;
 }
 
+int auto_compile_to_rvm(const int argc, const char *const *const argv)
+{
+	workspace ws = ws_parse_args(argc, argv);
+	const int ret = compile_to_rvm(&ws);
+	ws_clear(&ws);
+	return ret;
+}
+
 
 int no_macro_compile_to_vm(const char *const path)
 {
 	universal_io io = io_create();
-	in_set_file(&io, path);
+	in_set_mmap(&io, path);
 
 	workspace ws = ws_create();
 	ws_add_file(&ws, path);
 	ws_set_output(&ws, DEFAULT_VM);
 	out_set_file(&io, ws_get_output(&ws));
 
-	const int ret = compile_from_io(&ws, &io, &encode_to_vm);
+	profiler prof = prof_create(&ws);
+	const int ret = compile_from_io(&ws, &io, &encode_to_vm, 0, &prof);
 	if (!ret)
 	{
 		make_executable(ws_get_output(&ws));
@@ -254,14 +940,15 @@ int no_macro_compile_to_vm(const char *const path)
 int no_macro_compile_to_llvm(const char *const path)
 {
 	universal_io io = io_create();
-	in_set_file(&io, path);
+	in_set_mmap(&io, path);
 
 	workspace ws = ws_create();
 	ws_add_file(&ws, path);
 	ws_set_output(&ws, DEFAULT_LLVM);
 	out_set_file(&io, ws_get_output(&ws));
 
-	const int ret = compile_from_io(&ws, &io, &encode_to_llvm);
+	profiler prof = prof_create(&ws);
+	const int ret = compile_from_io(&ws, &io, &encode_to_llvm, 0, &prof);
 	ws_clear(&ws);
 	return ret;
 }
@@ -269,14 +956,15 @@ int no_macro_compile_to_llvm(const char *const path)
 int no_macro_compile_to_mips(const char *const path)
 {
 	universal_io io = io_create();
-	in_set_file(&io, path);
+	in_set_mmap(&io, path);
 
 	workspace ws = ws_create();
 	ws_add_file(&ws, path);
 	ws_set_output(&ws, DEFAULT_MIPS);
 	out_set_file(&io, ws_get_output(&ws));
 
-	const int ret = compile_from_io(&ws, &io, &encode_to_mips);
+	profiler prof = prof_create(&ws);
+	const int ret = compile_from_io(&ws, &io, &encode_to_mips, 0, &prof);
 	ws_clear(&ws);
 	return ret;
 }
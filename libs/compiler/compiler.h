@@ -41,6 +41,7 @@ typedef enum STATUS
 	sts_virtul_error,			/**< Virtual Machine generator error code */
 	sts_llvm_error,				/**< LLVM generator error code */
 	sts_mips_error,				/**< MIPS generator error code */
+	sts_rvm_error,				/**< Register Virtual Machine generator error code */
 } status_t;
 
 
@@ -78,7 +79,87 @@ EXPORTED status_t compile_to_llvm(workspace *const ws);
  *
  *	@return	Status code
  */
-EXPORTED int compile_to_mips(workspace *const ws);
+EXPORTED status_t compile_to_mips(workspace *const ws);
+
+/**
+ *	Compile register virtual machine code from workspace
+ *
+ *	@param	ws		Compiler workspace
+ *
+ *	@return	Status code
+ */
+EXPORTED status_t compile_to_rvm(workspace *const ws);
+
+/**
+ *	Compile code from workspace into memory instead of output file.
+ *	Target is chosen by flags as in @ref compile(), output file of workspace is ignored.
+ *
+ *	@param	ws		Compiler workspace
+ *	@param	buffer	Allocated output buffer on success, @c NULL otherwise, should be freed by caller
+ *	@param	size	Size of output
+ *
+ *	@return	Status code
+ */
+EXPORTED status_t compile_to_buffer(workspace *const ws, char **const buffer, size_t *const size);
+
+/**
+ *	Compile preprocessed code into memory, e.g. code received by compile server.
+ *	Target is chosen by flags as in @ref compile(), files and output file of workspace are ignored.
+ *
+ *	@param	ws		Compiler workspace
+ *	@param	code	Preprocessed code with line markers
+ *	@param	buffer	Allocated output buffer on success, @c NULL otherwise, should be freed by caller
+ *	@param	size	Size of output
+ *
+ *	@return	Status code
+ */
+EXPORTED status_t compile_preprocessed_to_buffer(workspace *const ws, const char *const code
+	, char **const buffer, size_t *const size);
+
+/**
+ *	Compile LLVM code from workspace and execute it in process by JIT without output files.
+ *	Available only when compiler is built with LLVM C API.
+ *
+ *	@param	ws		Compiler workspace
+ *	@param	result	Exit code of executed program
+ *
+ *	@return	Status code
+ */
+EXPORTED status_t compile_and_run(workspace *const ws, int *const result);
+
+/**
+ *	Compile RuC virtual machine code from source text in memory.
+ *	Text is preprocessed, so already preprocessed text is accepted as well.
+ *
+ *	@param	code	Source text
+ *	@param	buffer	Allocated output buffer on success, @c NULL otherwise, should be freed by caller
+ *	@param	size	Size of output
+ *
+ *	@return	Status code
+ */
+EXPORTED status_t compile_buffer_to_vm(const char *const code, char **const buffer, size_t *const size);
+
+/**
+ *	Compile LLVM code from source text in memory.
+ *	Text is preprocessed, so already preprocessed text is accepted as well.
+ *
+ *	@param	code	Source text
+ *	@param	buffer	Allocated output buffer on success, @c NULL otherwise, should be freed by caller
+ *	@param	size	Size of output
+ *
+ *	@return	Status code
+ */
+EXPORTED status_t compile_buffer_to_llvm(const char *const code, char **const buffer, size_t *const size);
+
+/**
+ *	Compile independent jobs concurrently, each job is compiled as by @ref compile().
+ *	Jobs should have different output files.
+ *
+ *	@param	jobs		Workspaces of jobs
+ *	@param	statuses	Status codes of jobs
+ *	@param	num			Number of jobs
+ */
+EXPORTED void compile_batch(workspace *const jobs, status_t *const statuses, const size_t num);
 
 
 /**
@@ -121,6 +202,16 @@ EXPORTED int auto_compile_to_llvm(const int argc, const char *const *const argv)
  */
 EXPORTED int auto_compile_to_mips(const int argc, const char *const *const argv);
 
+/**
+ *	Compile register virtual machine code from terminal arguments
+ *
+ *	@param	argc	Number of command line arguments
+ *	@param	argv	Command line arguments
+ *
+ *	@return	Status code
+ */
+EXPORTED int auto_compile_to_rvm(const int argc, const char *const *const argv);
+
 
 /**
  *	Compile RuC virtual machine code with no macro
@@ -0,0 +1,369 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "effects.h"
+#include "AST.h"
+#include "visitor.h"
+
+
+/** Effects of function body without called functions */
+typedef struct body_effects
+{
+	const syntax *const sx;			/**< Syntax structure */
+	vector *const callees;			/**< Identifiers of called user functions */
+	int flags;						/**< Flags of effects */
+} body_effects;
+
+
+/**
+ *	Get effects of builtin function call
+ *
+ *	@param	func		Builtin function
+ *
+ *	@return	Flags of effects
+ */
+static int builtin_effects(const size_t func)
+{
+	switch (func)
+	{
+		case BI_ASIN:
+		case BI_COS:
+		case BI_SIN:
+		case BI_EXP:
+		case BI_LOG:
+		case BI_LOG10:
+		case BI_SQRT:
+		case BI_ROUND:
+			return 0;
+
+		case BI_STRCMP:
+		case BI_STRNCMP:
+		case BI_STRSTR:
+		case BI_STRLEN:
+			return EFFECT_READ;
+
+		case BI_RAND:
+			return EFFECT_READ | EFFECT_WRITE;
+
+		// Эти функции вызывают переданные им функции
+		case BI_T_CREATE:
+		case BI_PARALLEL_FOR:
+			return EFFECT_ALL;
+
+		default:
+			return EFFECT_READ | EFFECT_WRITE | EFFECT_DIVERGENCE;
+	}
+}
+
+/**
+ *	Check that modifiable expression refers to local variable
+ *
+ *	@param	sx			Syntax structure
+ *	@param	nd			Modifiable expression
+ *
+ *	@return	@c true on local variable or its member, @c false otherwise
+ */
+static bool is_local_lvalue(const syntax *const sx, const node *const nd)
+{
+	node target = *nd;
+	while (expression_get_class(&target) == EXPR_MEMBER && !expression_member_is_arrow(&target))
+	{
+		target = expression_member_get_base(&target);
+	}
+
+	return expression_get_class(&target) == EXPR_IDENTIFIER
+		&& ident_is_local(sx, expression_identifier_get_id(&target));
+}
+
+static int check_node(void *const context, const node *const nd)
+{
+	body_effects *const properties = context;
+	const syntax *const sx = properties->sx;
+
+	switch (node_get_type(nd))
+	{
+		case OP_IDENTIFIER:
+		{
+			// Функции имеют положительное смещение, глобальные переменные – отрицательное
+			const size_t id = expression_identifier_get_id(nd);
+			if (!ident_is_local(sx, id))
+			{
+				properties->flags |= EFFECT_READ;
+			}
+			break;
+		}
+
+		case OP_LITERAL:
+			if (type_is_array(sx, expression_get_type(nd)))
+			{
+				properties->flags |= EFFECT_READ;
+			}
+			break;
+
+		case OP_CALL:
+		{
+			const node callee = expression_call_get_callee(nd);
+			const size_t func = expression_get_class(&callee) == EXPR_IDENTIFIER
+				? expression_identifier_get_id(&callee)
+				: SIZE_MAX;
+
+			if (func == SIZE_MAX || !ident_is_local(sx, func) || !type_is_function(sx, ident_get_type(sx, func)))
+			{
+				// Вызов через указатель может привести к любой функции
+				properties->flags |= EFFECT_ALL;
+			}
+			else if (func < BEGIN_USER_FUNC)
+			{
+				properties->flags |= builtin_effects(func);
+			}
+			else
+			{
+				vector_add(properties->callees, (item_t)func);
+			}
+			break;
+		}
+
+		case OP_SLICE:
+		{
+			// Вырезка из строки с константным индексом вне границ завершает программу
+			const node base = expression_subscript_get_base(nd);
+			properties->flags |= expression_get_class(&base) == EXPR_LITERAL
+				? EFFECT_READ | EFFECT_WRITE | EFFECT_DIVERGENCE
+				: EFFECT_READ;
+			break;
+		}
+
+		case OP_SELECT:
+			if (expression_member_is_arrow(nd))
+			{
+				properties->flags |= EFFECT_READ;
+			}
+			break;
+
+		case OP_UNARY:
+			switch (expression_unary_get_operator(nd))
+			{
+				case UN_INDIRECTION:
+				case UN_UPB:
+					properties->flags |= EFFECT_READ;
+					break;
+
+				case UN_POSTINC:
+				case UN_POSTDEC:
+				case UN_PREINC:
+				case UN_PREDEC:
+				{
+					const node operand = expression_unary_get_operand(nd);
+					if (!is_local_lvalue(sx, &operand))
+					{
+						properties->flags |= EFFECT_WRITE;
+					}
+					break;
+				}
+
+				default:
+					break;
+			}
+			break;
+
+		case OP_ASSIGNMENT:
+		{
+			const node LHS = expression_assignment_get_LHS(nd);
+			if (!is_local_lvalue(sx, &LHS))
+			{
+				properties->flags |= EFFECT_WRITE;
+			}
+			break;
+		}
+
+		case OP_DECL_VAR:
+			// Память массивов выделяется динамически
+			if (type_is_array(sx, ident_get_type(sx, declaration_variable_get_id(nd))))
+			{
+				properties->flags |= EFFECT_READ | EFFECT_WRITE;
+			}
+			break;
+
+		case OP_WHILE:
+		case OP_DO:
+		case OP_FOR:
+			properties->flags |= EFFECT_DIVERGENCE;
+			break;
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+/**
+ *	Get index of function definition
+ *
+ *	@param	owners		Definitions plus one for each identifier
+ *	@param	function	Identifier of function
+ *
+ *	@return	Index of definition, @c SIZE_MAX for unknown function
+ */
+static inline size_t get_definition(const vector *const owners, const size_t function)
+{
+	const item_t owner = function < vector_size(owners) ? vector_get(owners, function) : 0;
+	return owner > 0 ? (size_t)owner - 1 : SIZE_MAX;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+effects effects_create(syntax *const sx)
+{
+	effects eff = { .sx = sx, .flags = vector_create(vector_size(&sx->identifiers)) };
+	vector_increase(&eff.flags, vector_size(&sx->identifiers));
+
+	const node root = node_get_root(&sx->tree);
+	const size_t size = translation_unit_get_size(&root);
+
+	// Сначала нумеруются определения, так как вызов может предшествовать определению
+	vector owners = vector_create(vector_size(&sx->identifiers));
+	vector_increase(&owners, vector_size(&sx->identifiers));
+	vector functions = vector_create(size);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(&root, i);
+		if (declaration_get_class(&decl) != DECL_FUNC)
+		{
+			continue;
+		}
+
+		// Вызовы до определения функции ссылаются на её прототип
+		const size_t identifier = declaration_function_get_id(&decl);
+		const size_t prototype = ident_get_prev(sx, identifier);
+		const item_t definition = (item_t)vector_size(&functions) + 1;
+		vector_set(&owners, identifier, definition);
+		if (prototype >= BEGIN_USER_FUNC && type_is_function(sx, ident_get_type(sx, prototype)))
+		{
+			vector_set(&owners, prototype, definition);
+		}
+		vector_add(&functions, (item_t)i);
+	}
+
+	// Для каждой функции хранятся собственные эффекты и границы списка вызываемых функций
+	const size_t amount = vector_size(&functions);
+	vector local = vector_create(amount);
+	vector current = vector_create(amount);
+	vector bounds = vector_create(amount + 1);
+	vector callees = vector_create(amount);
+	vector_add(&bounds, 0);
+
+	body_effects properties = { .sx = sx, .callees = &callees, .flags = 0 };
+	visitor vis = visitor_create(&properties);
+	for (size_t i = 0; i < VISITOR_KINDS; i++)
+	{
+		visitor_set(&vis, (operation_t)i, &check_node, NULL);
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node decl = translation_unit_get_declaration(&root, (size_t)vector_get(&functions, i));
+		const node body = declaration_function_get_body(&decl);
+		const size_t begin = vector_size(&callees);
+
+		properties.flags = 0;
+		visitor_walk(&vis, &body);
+
+		// Вызовы функций без определения заменяются их эффектами
+		for (size_t j = begin; j < vector_size(&callees); j++)
+		{
+			const size_t definition = get_definition(&owners, (size_t)vector_get(&callees, j));
+			if (definition == SIZE_MAX)
+			{
+				properties.flags |= EFFECT_ALL;
+			}
+			vector_set(&callees, j, definition == SIZE_MAX ? (item_t)i : (item_t)definition);
+		}
+
+		vector_add(&local, properties.flags);
+		vector_add(&current, properties.flags | EFFECT_RECURSION);
+		vector_add(&bounds, (item_t)vector_size(&callees));
+	}
+	visitor_clear(&vis);
+
+	// Чтение, запись и зацикливание только добавляются, а рекурсия только снимается,
+	// поэтому итерации сходятся
+	bool was_changed = true;
+	while (was_changed)
+	{
+		was_changed = false;
+		for (size_t i = 0; i < amount; i++)
+		{
+			int flags = (int)vector_get(&local, i);
+			bool is_recursive = false;
+
+			const size_t end = (size_t)vector_get(&bounds, i + 1);
+			for (size_t j = (size_t)vector_get(&bounds, i); j < end; j++)
+			{
+				const size_t callee = (size_t)vector_get(&callees, j);
+				const int callee_flags = (int)vector_get(&current, callee);
+				flags |= callee_flags & (EFFECT_READ | EFFECT_WRITE | EFFECT_DIVERGENCE);
+				is_recursive = is_recursive || callee == i || (callee_flags & EFFECT_RECURSION) != 0;
+			}
+
+			flags |= is_recursive ? EFFECT_RECURSION : 0;
+			if (flags != (int)vector_get(&current, i))
+			{
+				vector_set(&current, i, flags);
+				was_changed = true;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(&sx->identifiers); i++)
+	{
+		const size_t definition = get_definition(&owners, i);
+		if (definition != SIZE_MAX)
+		{
+			// Рекурсивная функция может не завершиться
+			const int flags = (int)vector_get(&current, definition);
+			const int divergence = (flags & EFFECT_RECURSION) != 0 ? EFFECT_DIVERGENCE : 0;
+			vector_set(&eff.flags, i, (flags | divergence) + 1);
+		}
+	}
+
+	vector_clear(&owners);
+	vector_clear(&functions);
+	vector_clear(&local);
+	vector_clear(&current);
+	vector_clear(&bounds);
+	vector_clear(&callees);
+	return eff;
+}
+
+int effects_get_function(const effects *const eff, const size_t function)
+{
+	const item_t flags = function < vector_size(&eff->flags) ? vector_get(&eff->flags, function) : 0;
+	return flags > 0 ? (int)flags - 1 : EFFECT_ALL;
+}
+
+void effects_clear(effects *const eff)
+{
+	vector_clear(&eff->flags);
+}
@@ -0,0 +1,81 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "syntax.h"
+#include "tree.h"
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Side effects of function */
+typedef enum EFFECT
+{
+	EFFECT_READ			= 1,	/**< Function may read memory visible to its caller */
+	EFFECT_WRITE		= 2,	/**< Function may write memory visible to its caller or do input/output */
+	EFFECT_RECURSION	= 4,	/**< Function may call itself directly or indirectly */
+	EFFECT_DIVERGENCE	= 8,	/**< Function may loop forever or terminate program */
+
+	EFFECT_ALL			= 15,	/**< All effects, used for unknown functions */
+} effect_t;
+
+/**
+ *	Interprocedural analysis of function side effects.
+ *
+ *	Effects of function body are joined with effects of called functions
+ *	until fixed point is reached. Calls through pointers and unknown builtins
+ *	are assumed to have all effects, so analysis is conservative.
+ */
+typedef struct effects
+{
+	syntax *sx;					/**< Syntax structure */
+	vector flags;				/**< Effects plus one for each identifier of defined function */
+} effects;
+
+
+/**
+ *	Create effects analysis and analyze functions of translation unit
+ *
+ *	@param	sx				Syntax structure
+ *
+ *	@return	Effects analysis
+ */
+effects effects_create(syntax *const sx);
+
+/**
+ *	Get side effects of function
+ *
+ *	@param	eff				Effects analysis
+ *	@param	function		Identifier of function
+ *
+ *	@return	Flags of effects, @c EFFECT_ALL for unknown function
+ */
+int effects_get_function(const effects *const eff, const size_t function);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	eff				Effects analysis
+ */
+void effects_clear(effects *const eff);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -29,7 +29,6 @@
 #define TAG_RUC "ruc"
 
 #define MAX_TAG_SIZE 128
-#define MAX_MSG_SIZE MAX_TAG_SIZE * 4
 #define MAX_LINE_SIZE MAX_TAG_SIZE * 4
 
 
@@ -427,6 +426,27 @@ static void get_error(const err_t num, char *const msg, va_list args)
 		case too_many_arguments:
 			sprintf(msg, "слишком много аргументов у функции, допустимое количество до 128");
 			break;
+		case construction_not_supported:
+			sprintf(msg, "такие конструкции пока не поддерживаются в кодогенераторе регистровой машины");
+			break;
+		case mips_construction_not_supported:
+			sprintf(msg, "такие конструкции пока не поддерживаются в кодогенераторе MIPS");
+			break;
+		case llvm_construction_not_supported:
+			sprintf(msg, "такие конструкции пока не поддерживаются в кодогенераторе LLVM");
+			break;
+		case llvm_bitcode_is_not_supported:
+			sprintf(msg, "компилятор собран без поддержки биткода LLVM");
+			break;
+		case llvm_bitcode_error:
+			sprintf(msg, "ошибка LLVM при построении биткода: %s", va_arg(args, char *));
+			break;
+		case llvm_jit_error:
+			sprintf(msg, "ошибка LLVM при исполнении программы: %s", va_arg(args, char *));
+			break;
+		case codes_cannot_be_dense:
+			sprintf(msg, "невозможно перенумеровать команды плотными кодами");
+			break;
 
 		default:
 			sprintf(msg, "неизвестный код ошибки (%i)", num);
@@ -514,6 +534,27 @@ void vwarning(universal_io *const io, const warning_t num, va_list args)
 }
 
 
+void error_text(const err_t num, char *const msg, va_list args)
+{
+	get_error(num, msg, args);
+}
+
+void warning_text(const warning_t num, char *const msg, va_list args)
+{
+	get_warning(num, msg, args);
+}
+
+void error_at(universal_io *const io, const char *const msg)
+{
+	output(io, msg, &log_system_error, &log_auto_error);
+}
+
+void warning_at(universal_io *const io, const char *const msg)
+{
+	output(io, msg, &log_system_warning, &log_auto_warning);
+}
+
+
 void system_error(err_t num, ...)
 {
 	va_list args;
@@ -19,6 +19,9 @@
 #include "uniio.h"
 
 
+#define MAX_MSG_SIZE 512
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -156,7 +159,14 @@ typedef enum ERROR
 	wrong_init_in_actparam,
 	array_borders_cannot_be_static_dynamic,
 	such_array_is_not_supported,
-	too_many_arguments
+	too_many_arguments,
+	construction_not_supported,
+	mips_construction_not_supported,
+	llvm_construction_not_supported,
+	llvm_bitcode_is_not_supported,
+	llvm_bitcode_error,
+	llvm_jit_error,
+	codes_cannot_be_dense
 } err_t;
 
 /** Warnings codes */
@@ -204,6 +214,41 @@ void verror(universal_io *const io, const err_t num, va_list args);
 void vwarning(universal_io *const io, const warning_t num, va_list args);
 
 
+/**
+ *	Write text of error without location
+ *
+ *	@param	num			Error number
+ *	@param	msg			Destination string of @c MAX_MSG_SIZE bytes
+ *	@param	args		Variable list
+ */
+void error_text(const err_t num, char *const msg, va_list args);
+
+/**
+ *	Write text of warning without location
+ *
+ *	@param	num			Warning number
+ *	@param	msg			Destination string of @c MAX_MSG_SIZE bytes
+ *	@param	args		Variable list
+ */
+void warning_text(const warning_t num, char *const msg, va_list args);
+
+/**
+ *	Emit an error message at current position of io
+ *
+ *	@param	io			Universal io
+ *	@param	msg			Error message
+ */
+void error_at(universal_io *const io, const char *const msg);
+
+/**
+ *	Emit a warning message at current position of io
+ *
+ *	@param	io			Universal io
+ *	@param	msg			Warning message
+ */
+void warning_at(universal_io *const io, const char *const msg);
+
+
 /**
  *	Emit an error by number
  *
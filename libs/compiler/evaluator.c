@@ -0,0 +1,862 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "evaluator.h"
+#include <stdint.h>
+#include "AST.h"
+#include "tree.h"
+#include "vector.h"
+
+
+#define MAX_EVALUATION_STEPS 100000
+#define MAX_EVALUATION_DEPTH 64
+#define FRAME_RECORD (1 + INT64_SIZE)
+
+
+/** Value of arithmetic expression */
+typedef union value
+{
+	int64_t integer;				/**< Integer, enum or boolean value */
+	double floating;				/**< Floating value */
+} value;
+
+/** Result of statement execution */
+typedef enum RESULT
+{
+	RESULT_NEXT,					/**< Execution goes to next statement */
+	RESULT_BREAK,					/**< Break statement was executed */
+	RESULT_CONTINUE,				/**< Continue statement was executed */
+	RESULT_RETURN,					/**< Return statement was executed */
+	RESULT_FAIL,					/**< Statement cannot be evaluated */
+} result_t;
+
+/** Interpreter of pure functions */
+typedef struct evaluator
+{
+	syntax *const sx;				/**< Syntax structure */
+	vector frame;					/**< Identifiers and values of local variables of called functions */
+	size_t base;					/**< Start of current function records in frame */
+	size_t steps;					/**< Number of remaining steps */
+	size_t depth;					/**< Depth of function calls */
+	value returned;					/**< Value of last executed return statement */
+} evaluator;
+
+
+static bool evaluate_expression(evaluator *const ev, const node *const nd, value *const result);
+static result_t evaluate_statement(evaluator *const ev, const node *const nd);
+
+
+/**
+ *	Check that values of type can be evaluated
+ *
+ *	@param	sx			Syntax structure
+ *	@param	type		Type
+ *
+ *	@return	@c true on arithmetic type, @c false otherwise
+ */
+static bool is_evaluated_type(const syntax *const sx, const item_t type)
+{
+	return type == TYPE_INTEGER || type == TYPE_FLOATING || type_is_boolean(type)
+		|| type_is_enum(sx, type) || type_is_enum_field(sx, type);
+}
+
+/**
+ *	Wrap integer value as a machine integer
+ *
+ *	@param	integer		Value
+ *
+ *	@return	Value in range of integer type
+ */
+static inline int64_t wrap_integer(const int64_t integer)
+{
+	return (int32_t)(uint32_t)(uint64_t)integer;
+}
+
+static inline bool is_true(const item_t type, const value val)
+{
+	return type_is_floating(type) ? val.floating != 0 : val.integer != 0;
+}
+
+static size_t frame_search(const evaluator *const ev, const size_t id)
+{
+	for (size_t i = ev->base; i < vector_size(&ev->frame); i += FRAME_RECORD)
+	{
+		if ((size_t)vector_get(&ev->frame, i) == id)
+		{
+			return i;
+		}
+	}
+
+	return SIZE_MAX;
+}
+
+static void frame_set(evaluator *const ev, const size_t id, const value val)
+{
+	const size_t index = frame_search(ev, id);
+	if (index == SIZE_MAX)
+	{
+		vector_add(&ev->frame, (item_t)id);
+		vector_add_int64(&ev->frame, val.integer);
+	}
+	else
+	{
+		vector_set_int64(&ev->frame, index + 1, val.integer);
+	}
+}
+
+static bool frame_get(const evaluator *const ev, const size_t id, value *const val)
+{
+	const size_t index = frame_search(ev, id);
+	if (index == SIZE_MAX)
+	{
+		// Глобальные и не получившие значения переменные не вычисляются
+		return false;
+	}
+
+	val->integer = vector_get_int64(&ev->frame, index + 1);
+	return true;
+}
+
+/**
+ *	Apply arithmetic, bitwise or relational operator to evaluated operands
+ *
+ *	@param	type		Type of operands
+ *	@param	op			Operator
+ *	@param	left		Left operand
+ *	@param	right		Right operand
+ *	@param	result		Result of operation
+ *
+ *	@return	@c true on success, @c false on undefined or unknown operation
+ */
+static bool evaluate_operation(const item_t type, const binary_t op, const value left, const value right
+	, value *const result)
+{
+	if (type_is_floating(type))
+	{
+		const double x = left.floating;
+		const double y = right.floating;
+		switch (op)
+		{
+			case BIN_MUL:	result->floating = x * y;	return true;
+			case BIN_DIV:	result->floating = x / y;	return y != 0;
+			case BIN_ADD:	result->floating = x + y;	return true;
+			case BIN_SUB:	result->floating = x - y;	return true;
+			case BIN_LT:	result->integer = x < y;	return true;
+			case BIN_GT:	result->integer = x > y;	return true;
+			case BIN_LE:	result->integer = x <= y;	return true;
+			case BIN_GE:	result->integer = x >= y;	return true;
+			case BIN_EQ:	result->integer = x == y;	return true;
+			case BIN_NE:	result->integer = x != y;	return true;
+			default:		return false;
+		}
+	}
+
+	const int64_t x = left.integer;
+	const int64_t y = right.integer;
+	switch (op)
+	{
+		case BIN_MUL:	result->integer = wrap_integer(x * y);	return true;
+		case BIN_ADD:	result->integer = wrap_integer(x + y);	return true;
+		case BIN_SUB:	result->integer = wrap_integer(x - y);	return true;
+		case BIN_LT:	result->integer = x < y;				return true;
+		case BIN_GT:	result->integer = x > y;				return true;
+		case BIN_LE:	result->integer = x <= y;				return true;
+		case BIN_GE:	result->integer = x >= y;				return true;
+		case BIN_EQ:	result->integer = x == y;				return true;
+		case BIN_NE:	result->integer = x != y;				return true;
+		case BIN_AND:	result->integer = x & y;				return true;
+		case BIN_XOR:	result->integer = x ^ y;				return true;
+		case BIN_OR:	result->integer = x | y;				return true;
+
+		case BIN_DIV:
+		case BIN_REM:
+			// Деление на ноль и переполнение при делении остаются ошибками времени исполнения
+			if (y == 0 || (x == INT32_MIN && y == -1))
+			{
+				return false;
+			}
+			result->integer = op == BIN_DIV ? x / y : x % y;
+			return true;
+
+		case BIN_SHL:
+		case BIN_SHR:
+			if (y < 0 || y >= 32)
+			{
+				return false;
+			}
+			result->integer = op == BIN_SHL ? wrap_integer((int64_t)((uint64_t)x << y)) : x >> y;
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ *	Get operator of compound assignment
+ *
+ *	@param	op			Assignment operator
+ *
+ *	@return	Binary operator, @c BIN_ASSIGN for simple assignment
+ */
+static binary_t assignment_get_operation(const binary_t op)
+{
+	switch (op)
+	{
+		case BIN_MUL_ASSIGN:	return BIN_MUL;
+		case BIN_DIV_ASSIGN:	return BIN_DIV;
+		case BIN_REM_ASSIGN:	return BIN_REM;
+		case BIN_ADD_ASSIGN:	return BIN_ADD;
+		case BIN_SUB_ASSIGN:	return BIN_SUB;
+		case BIN_SHL_ASSIGN:	return BIN_SHL;
+		case BIN_SHR_ASSIGN:	return BIN_SHR;
+		case BIN_AND_ASSIGN:	return BIN_AND;
+		case BIN_XOR_ASSIGN:	return BIN_XOR;
+		case BIN_OR_ASSIGN:		return BIN_OR;
+		default:				return BIN_ASSIGN;
+	}
+}
+
+static bool evaluate_literal_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const item_t type = expression_get_type(nd);
+	if (type_is_floating(type))
+	{
+		result->floating = expression_literal_get_floating(nd);
+	}
+	else if (type_is_boolean(type))
+	{
+		result->integer = expression_literal_get_boolean(nd);
+	}
+	else
+	{
+		result->integer = expression_literal_get_integer(nd);
+	}
+
+	return is_evaluated_type(ev->sx, type);
+}
+
+static bool evaluate_cast_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const node operand = expression_cast_get_operand(nd);
+	if (!evaluate_expression(ev, &operand, result))
+	{
+		return false;
+	}
+
+	// Неявные преобразования бывают только из целых в вещественные
+	if (type_is_floating(expression_get_type(nd)) && !type_is_floating(expression_cast_get_source_type(nd)))
+	{
+		result->floating = (double)result->integer;
+	}
+
+	return true;
+}
+
+static bool evaluate_unary_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const item_t type = expression_get_type(nd);
+	const unary_t op = expression_unary_get_operator(nd);
+	const node operand = expression_unary_get_operand(nd);
+
+	if (op == UN_POSTINC || op == UN_POSTDEC || op == UN_PREINC || op == UN_PREDEC)
+	{
+		if (expression_get_class(&operand) != EXPR_IDENTIFIER)
+		{
+			return false;
+		}
+
+		const size_t id = expression_identifier_get_id(&operand);
+		value old;
+		if (!frame_get(ev, id, &old))
+		{
+			return false;
+		}
+
+		value delta = { .integer = 1 };
+		if (type_is_floating(type))
+		{
+			delta.floating = 1.0;
+		}
+
+		value updated;
+		if (!evaluate_operation(type, op == UN_POSTINC || op == UN_PREINC ? BIN_ADD : BIN_SUB, old, delta, &updated))
+		{
+			return false;
+		}
+
+		frame_set(ev, id, updated);
+		*result = op == UN_PREINC || op == UN_PREDEC ? updated : old;
+		return true;
+	}
+
+	value val;
+	if (!evaluate_expression(ev, &operand, &val))
+	{
+		return false;
+	}
+
+	const item_t operand_type = expression_get_type(&operand);
+	switch (op)
+	{
+		case UN_MINUS:
+			if (type_is_floating(operand_type))
+			{
+				result->floating = -val.floating;
+			}
+			else
+			{
+				result->integer = wrap_integer(-val.integer);
+			}
+			return true;
+
+		case UN_NOT:
+			result->integer = ~val.integer;
+			return !type_is_floating(operand_type);
+
+		case UN_LOGNOT:
+			result->integer = !is_true(operand_type, val);
+			return true;
+
+		case UN_ABS:
+			if (type_is_floating(operand_type))
+			{
+				result->floating = val.floating >= 0 ? val.floating : -val.floating;
+			}
+			else
+			{
+				result->integer = wrap_integer(val.integer >= 0 ? val.integer : -val.integer);
+			}
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static bool evaluate_binary_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const binary_t op = expression_binary_get_operator(nd);
+	const node LHS = expression_binary_get_LHS(nd);
+	const node RHS = expression_binary_get_RHS(nd);
+
+	value left;
+	if (!evaluate_expression(ev, &LHS, &left))
+	{
+		return false;
+	}
+
+	// Второй операнд логических операций вычисляется только при необходимости
+	if (op == BIN_LOG_AND || op == BIN_LOG_OR)
+	{
+		const bool is_left_true = is_true(expression_get_type(&LHS), left);
+		if (is_left_true == (op == BIN_LOG_OR))
+		{
+			result->integer = is_left_true;
+			return true;
+		}
+
+		value right;
+		if (!evaluate_expression(ev, &RHS, &right))
+		{
+			return false;
+		}
+
+		result->integer = is_true(expression_get_type(&RHS), right);
+		return true;
+	}
+
+	value right;
+	if (!evaluate_expression(ev, &RHS, &right))
+	{
+		return false;
+	}
+
+	if (op == BIN_COMMA)
+	{
+		*result = right;
+		return true;
+	}
+
+	return evaluate_operation(expression_get_type(&LHS), op, left, right, result);
+}
+
+static bool evaluate_ternary_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const node condition = expression_ternary_get_condition(nd);
+	value val;
+	if (!evaluate_expression(ev, &condition, &val))
+	{
+		return false;
+	}
+
+	const node branch = is_true(expression_get_type(&condition), val)
+		? expression_ternary_get_LHS(nd)
+		: expression_ternary_get_RHS(nd);
+	return evaluate_expression(ev, &branch, result);
+}
+
+static bool evaluate_assignment_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const node LHS = expression_assignment_get_LHS(nd);
+	const node RHS = expression_assignment_get_RHS(nd);
+	if (expression_get_class(&LHS) != EXPR_IDENTIFIER)
+	{
+		return false;
+	}
+
+	const size_t id = expression_identifier_get_id(&LHS);
+	if (!ident_is_local(ev->sx, id))
+	{
+		return false;
+	}
+
+	value val;
+	if (!evaluate_expression(ev, &RHS, &val))
+	{
+		return false;
+	}
+
+	const binary_t op = assignment_get_operation(expression_assignment_get_operator(nd));
+	if (op != BIN_ASSIGN)
+	{
+		value old;
+		if (!frame_get(ev, id, &old) || !evaluate_operation(expression_get_type(&LHS), op, old, val, &val))
+		{
+			return false;
+		}
+	}
+
+	frame_set(ev, id, val);
+	*result = val;
+	return true;
+}
+
+static bool evaluate_call_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	const node callee = expression_call_get_callee(nd);
+	if (expression_get_class(&callee) != EXPR_IDENTIFIER || ev->depth == MAX_EVALUATION_DEPTH)
+	{
+		return false;
+	}
+
+	// Вызовы через указатели и встроенных функций не вычисляются
+	const size_t func = expression_identifier_get_id(&callee);
+	if (func < BEGIN_USER_FUNC || !ident_is_local(ev->sx, func) || !type_is_function(ev->sx, ident_get_type(ev->sx, func)))
+	{
+		return false;
+	}
+
+	const item_t reference = func_get(ev->sx, (size_t)ident_get_displ(ev->sx, func));
+	if (reference <= 0 || reference == ITEM_MAX)
+	{
+		return false;
+	}
+
+	const node definition = node_load(&ev->sx->tree, (size_t)reference);
+	if (node_get_type(&definition) != OP_FUNC_DEF)
+	{
+		return false;
+	}
+
+	const size_t parameters = expression_call_get_arguments_amount(nd);
+	const size_t frame_end = vector_size(&ev->frame);
+	for (size_t i = 0; i < parameters; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		const size_t parameter = declaration_function_get_parameter(&definition, i);
+		value val;
+		if (!is_evaluated_type(ev->sx, ident_get_type(ev->sx, parameter)) || !evaluate_expression(ev, &argument, &val))
+		{
+			vector_resize(&ev->frame, frame_end);
+			return false;
+		}
+
+		vector_add(&ev->frame, (item_t)parameter);
+		vector_add_int64(&ev->frame, val.integer);
+	}
+
+	const size_t old_base = ev->base;
+	ev->base = frame_end;
+	ev->depth++;
+
+	const node body = declaration_function_get_body(&definition);
+	const result_t res = evaluate_statement(ev, &body);
+
+	ev->depth--;
+	ev->base = old_base;
+	vector_resize(&ev->frame, frame_end);
+
+	*result = ev->returned;
+	return res == RESULT_RETURN;
+}
+
+static bool evaluate_expression(evaluator *const ev, const node *const nd, value *const result)
+{
+	if (ev->steps == 0 || !is_evaluated_type(ev->sx, expression_get_type(nd)))
+	{
+		return false;
+	}
+	ev->steps--;
+
+	switch (expression_get_class(nd))
+	{
+		case EXPR_IDENTIFIER:
+			return frame_get(ev, expression_identifier_get_id(nd), result);
+		case EXPR_LITERAL:
+			return evaluate_literal_expression(ev, nd, result);
+		case EXPR_CALL:
+			return evaluate_call_expression(ev, nd, result);
+		case EXPR_CAST:
+			return evaluate_cast_expression(ev, nd, result);
+		case EXPR_UNARY:
+			return evaluate_unary_expression(ev, nd, result);
+		case EXPR_BINARY:
+			return evaluate_binary_expression(ev, nd, result);
+		case EXPR_TERNARY:
+			return evaluate_ternary_expression(ev, nd, result);
+		case EXPR_ASSIGNMENT:
+			return evaluate_assignment_expression(ev, nd, result);
+		default:
+			return false;
+	}
+}
+
+static bool evaluate_condition(evaluator *const ev, const node *const nd, bool *const condition)
+{
+	value val;
+	if (!evaluate_expression(ev, nd, &val))
+	{
+		return false;
+	}
+
+	*condition = is_true(expression_get_type(nd), val);
+	return true;
+}
+
+static result_t evaluate_declaration_statement(evaluator *const ev, const node *const nd)
+{
+	const size_t size = statement_declaration_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = statement_declaration_get_declarator(nd, i);
+		if (declaration_get_class(&decl) != DECL_VAR)
+		{
+			return RESULT_FAIL;
+		}
+
+		const size_t id = declaration_variable_get_id(&decl);
+		if (!is_evaluated_type(ev->sx, ident_get_type(ev->sx, id)))
+		{
+			return RESULT_FAIL;
+		}
+
+		if (declaration_variable_has_initializer(&decl))
+		{
+			const node initializer = declaration_variable_get_initializer(&decl);
+			value val;
+			if (!evaluate_expression(ev, &initializer, &val))
+			{
+				return RESULT_FAIL;
+			}
+
+			frame_set(ev, id, val);
+		}
+	}
+
+	return RESULT_NEXT;
+}
+
+/**
+ *	Execute loop body and get result of loop
+ *
+ *	@param	ev			Evaluator
+ *	@param	body		Loop body
+ *	@param	is_done		Set, if loop is finished
+ *
+ *	@return	Result of loop, @c RESULT_NEXT if loop goes on or finished normally
+ */
+static result_t evaluate_loop_body(evaluator *const ev, const node *const body, bool *const is_done)
+{
+	const result_t res = evaluate_statement(ev, body);
+	*is_done = res == RESULT_BREAK || res == RESULT_RETURN || res == RESULT_FAIL;
+	return res == RESULT_BREAK || res == RESULT_CONTINUE ? RESULT_NEXT : res;
+}
+
+static result_t evaluate_statement(evaluator *const ev, const node *const nd)
+{
+	if (ev->steps == 0)
+	{
+		return RESULT_FAIL;
+	}
+	ev->steps--;
+
+	switch (statement_get_class(nd))
+	{
+		case STMT_DECL:
+			return evaluate_declaration_statement(ev, nd);
+
+		case STMT_COMPOUND:
+		{
+			const size_t size = statement_compound_get_size(nd);
+			for (size_t i = 0; i < size; i++)
+			{
+				const node substmt = statement_compound_get_substmt(nd, i);
+				const result_t res = evaluate_statement(ev, &substmt);
+				if (res != RESULT_NEXT)
+				{
+					return res;
+				}
+			}
+
+			return RESULT_NEXT;
+		}
+
+		case STMT_EXPR:
+		{
+			value val;
+			return evaluate_expression(ev, nd, &val) ? RESULT_NEXT : RESULT_FAIL;
+		}
+
+		case STMT_NULL:
+			return RESULT_NEXT;
+
+		case STMT_IF:
+		{
+			const node condition = statement_if_get_condition(nd);
+			bool is_then = false;
+			if (!evaluate_condition(ev, &condition, &is_then))
+			{
+				return RESULT_FAIL;
+			}
+
+			if (is_then)
+			{
+				const node then_stmt = statement_if_get_then_substmt(nd);
+				return evaluate_statement(ev, &then_stmt);
+			}
+
+			if (statement_if_has_else_substmt(nd))
+			{
+				const node else_stmt = statement_if_get_else_substmt(nd);
+				return evaluate_statement(ev, &else_stmt);
+			}
+
+			return RESULT_NEXT;
+		}
+
+		case STMT_WHILE:
+		{
+			const node condition = statement_while_get_condition(nd);
+			const node body = statement_while_get_body(nd);
+			while (true)
+			{
+				bool is_running = false;
+				if (!evaluate_condition(ev, &condition, &is_running))
+				{
+					return RESULT_FAIL;
+				}
+
+				bool is_done = !is_running;
+				const result_t res = is_done ? RESULT_NEXT : evaluate_loop_body(ev, &body, &is_done);
+				if (is_done)
+				{
+					return res;
+				}
+			}
+		}
+
+		case STMT_DO:
+		{
+			const node condition = statement_do_get_condition(nd);
+			const node body = statement_do_get_body(nd);
+			while (true)
+			{
+				bool is_done = false;
+				const result_t res = evaluate_loop_body(ev, &body, &is_done);
+				if (is_done)
+				{
+					return res;
+				}
+
+				bool is_running = false;
+				if (!evaluate_condition(ev, &condition, &is_running))
+				{
+					return RESULT_FAIL;
+				}
+
+				if (!is_running)
+				{
+					return RESULT_NEXT;
+				}
+			}
+		}
+
+		case STMT_FOR:
+		{
+			if (statement_for_has_inition(nd))
+			{
+				const node inition = statement_for_get_inition(nd);
+				if (evaluate_statement(ev, &inition) != RESULT_NEXT)
+				{
+					return RESULT_FAIL;
+				}
+			}
+
+			const node body = statement_for_get_body(nd);
+			while (true)
+			{
+				bool is_running = true;
+				if (statement_for_has_condition(nd))
+				{
+					const node condition = statement_for_get_condition(nd);
+					if (!evaluate_condition(ev, &condition, &is_running))
+					{
+						return RESULT_FAIL;
+					}
+				}
+
+				bool is_done = !is_running;
+				const result_t res = is_done ? RESULT_NEXT : evaluate_loop_body(ev, &body, &is_done);
+				if (is_done)
+				{
+					return res;
+				}
+
+				if (statement_for_has_increment(nd))
+				{
+					const node increment = statement_for_get_increment(nd);
+					value val;
+					if (!evaluate_expression(ev, &increment, &val))
+					{
+						return RESULT_FAIL;
+					}
+				}
+			}
+		}
+
+		case STMT_CONTINUE:
+			return RESULT_CONTINUE;
+
+		case STMT_BREAK:
+			return RESULT_BREAK;
+
+		case STMT_RETURN:
+		{
+			if (!statement_return_has_expression(nd))
+			{
+				return RESULT_FAIL;
+			}
+
+			const node expression = statement_return_get_expression(nd);
+			return evaluate_expression(ev, &expression, &ev->returned) ? RESULT_RETURN : RESULT_FAIL;
+		}
+
+		default:
+			// Оператор выбора и операторы с метками не вычисляются
+			return RESULT_FAIL;
+	}
+}
+
+/**
+ *	Replace expression by literal with its value, if it has calls of pure functions,
+ *	otherwise try to replace its subexpressions
+ *
+ *	@param	ev			Evaluator
+ *	@param	nd			Expression
+ *
+ *	@return	Number of replaced expressions
+ */
+static size_t fold_expression(evaluator *const ev, node *const nd)
+{
+	const expression_t class = expression_get_class(nd);
+	if (class == EXPR_LITERAL || class == EXPR_IDENTIFIER || class == EXPR_EMPTY_BOUND)
+	{
+		return 0;
+	}
+
+	value val;
+	ev->steps = MAX_EVALUATION_STEPS;
+	if (class != EXPR_INITIALIZER && evaluate_expression(ev, nd, &val))
+	{
+		const item_t type = expression_get_type(nd);
+		const range_location loc = node_get_location(nd);
+
+		node parent = node_get_parent(nd);
+		node literal = type_is_floating(type)
+			? expression_floating_literal(&parent, type, val.floating, loc)
+			: type_is_boolean(type)
+				? expression_boolean_literal(&parent, type, val.integer != 0, loc)
+				: expression_integer_literal(&parent, type, val.integer, loc);
+
+		// Литерал занимает место выражения, которое удаляется из дерева
+		node_swap(nd, &literal);
+		node_remove(nd);
+		return 1;
+	}
+
+	size_t folded = 0;
+	for (size_t i = 0; i < node_get_amount(nd); i++)
+	{
+		node child = node_get_child(nd, i);
+		folded += fold_expression(ev, &child);
+	}
+
+	return folded;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+size_t evaluate_global_declarations(syntax *const sx)
+{
+	evaluator ev = { .sx = sx, .frame = vector_create(FRAME_RECORD * 16), .base = 0, .steps = 0, .depth = 0 };
+
+	size_t folded = 0;
+	const node root = node_get_root(&sx->tree);
+	const size_t size = translation_unit_get_size(&root);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(&root, i);
+		if (declaration_get_class(&decl) != DECL_VAR)
+		{
+			continue;
+		}
+
+		const size_t bounds = declaration_variable_get_bounds_amount(&decl);
+		for (size_t j = 0; j < bounds; j++)
+		{
+			node bound = declaration_variable_get_bound(&decl, j);
+			folded += fold_expression(&ev, &bound);
+		}
+
+		if (declaration_variable_has_initializer(&decl))
+		{
+			node initializer = declaration_variable_get_initializer(&decl);
+			folded += fold_expression(&ev, &initializer);
+		}
+	}
+
+	vector_clear(&ev.frame);
+	return folded;
+}
@@ -0,0 +1,42 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "syntax.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Evaluate calls of pure functions in initializers and array bounds of global variables
+ *	and replace them by literals.
+ *
+ *	Function body is interpreted, if it uses only its parameters and local variables
+ *	of arithmetic types and calls only such functions. Interpretation stops on exhausted
+ *	step budget, so functions which do not terminate stay calls evaluated at runtime.
+ *
+ *	@param	sx				Syntax structure
+ *
+ *	@return	Number of replaced expressions
+ */
+size_t evaluate_global_declarations(syntax *const sx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,204 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "inliner.h"
+#include "AST.h"
+#include "visitor.h"
+
+
+#define MAX_INLINE_NODES 24
+
+
+/** Properties of function body for inline expansion */
+typedef struct body_properties
+{
+	const syntax *const sx;			/**< Syntax structure */
+	size_t nodes;					/**< Number of nodes in body */
+	size_t returns;					/**< Number of return statements */
+	bool is_inlinable;				/**< Set, if body can be expanded inline */
+} body_properties;
+
+
+static int check_node(void *const context, const node *const nd)
+{
+	body_properties *const properties = context;
+	properties->nodes++;
+
+	switch (node_get_type(nd))
+	{
+		case OP_CALL:
+		{
+			// Вызовы пользовательских функций запрещены, поэтому рекурсия невозможна
+			const node callee = expression_call_get_callee(nd);
+			const size_t func = expression_get_class(&callee) == EXPR_IDENTIFIER
+				? expression_identifier_get_id(&callee)
+				: BEGIN_USER_FUNC;
+			properties->is_inlinable = func < BEGIN_USER_FUNC && func != BI_PRINTID && func != BI_GETID;
+			break;
+		}
+
+		case OP_UNARY:
+			properties->is_inlinable = expression_unary_get_operator(nd) != UN_ADDRESS;
+			break;
+
+		case OP_DECL_VAR:
+		{
+			const item_t type = ident_get_type(properties->sx, declaration_variable_get_id(nd));
+			properties->is_inlinable = !type_is_array(properties->sx, type) && !type_is_structure(properties->sx, type);
+			break;
+		}
+
+		case OP_DECL_STRUCT:
+			properties->is_inlinable = false;
+			break;
+
+		case OP_RETURN:
+			properties->returns++;
+			break;
+
+		default:
+			break;
+	}
+
+	properties->is_inlinable = properties->is_inlinable && properties->nodes <= MAX_INLINE_NODES;
+	return properties->is_inlinable ? 0 : -1;
+}
+
+/**
+ *	Check that type can be passed to inlined function or returned from it
+ *
+ *	@param	sx			Syntax structure
+ *	@param	type		Type
+ *
+ *	@return	@c true on scalar type, @c false otherwise
+ */
+static bool is_scalar_type(const syntax *const sx, const item_t type)
+{
+	return !type_is_structure(sx, type) && !type_is_array(sx, type) && !type_is_function(sx, type);
+}
+
+/**
+ *	Check that function definition can be expanded inline
+ *
+ *	@param	sx			Syntax structure
+ *	@param	nd			Function definition
+ *
+ *	@return	@c true on inlinable function, @c false otherwise
+ */
+static bool is_inlinable(const syntax *const sx, const node *const nd)
+{
+	const item_t type = ident_get_type(sx, declaration_function_get_id(nd));
+	const item_t return_type = type_function_get_return_type(sx, type);
+	if (!type_is_void(return_type) && !is_scalar_type(sx, return_type))
+	{
+		return false;
+	}
+
+	const size_t parameters = type_function_get_parameter_amount(sx, type);
+	for (size_t i = 0; i < parameters; i++)
+	{
+		if (!is_scalar_type(sx, type_function_get_parameter_type(sx, type, i)))
+		{
+			return false;
+		}
+	}
+
+	body_properties properties = { .sx = sx, .nodes = 0, .returns = 0, .is_inlinable = true };
+	visitor vis = visitor_create(&properties);
+	for (size_t i = 0; i < VISITOR_KINDS; i++)
+	{
+		visitor_set(&vis, (operation_t)i, &check_node, NULL);
+	}
+
+	const node body = declaration_function_get_body(nd);
+	visitor_walk(&vis, &body);
+	visitor_clear(&vis);
+
+	if (!properties.is_inlinable)
+	{
+		return false;
+	}
+
+	if (properties.returns == 0)
+	{
+		return type_is_void(return_type);
+	}
+
+	// Возврат допускается только последним оператором тела
+	const size_t size = statement_compound_get_size(&body);
+	const node last = statement_compound_get_substmt(&body, size - 1);
+	return properties.returns == 1 && statement_get_class(&last) == STMT_RETURN;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+inliner inliner_create(syntax *const sx)
+{
+	inliner inl = { .sx = sx, .definitions = vector_create(vector_size(&sx->identifiers)) };
+	vector_increase(&inl.definitions, vector_size(&sx->identifiers));
+
+	const node root = node_get_root(&sx->tree);
+	const size_t size = translation_unit_get_size(&root);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(&root, i);
+		if (declaration_get_class(&decl) != DECL_FUNC || !is_inlinable(sx, &decl))
+		{
+			continue;
+		}
+
+		// Вызовы до определения функции ссылаются на её прототип
+		const size_t identifier = declaration_function_get_id(&decl);
+		const size_t prototype = ident_get_prev(sx, identifier);
+		const item_t definition = (item_t)node_save(&decl) + 1;
+		vector_set(&inl.definitions, identifier, definition);
+		if (prototype >= BEGIN_USER_FUNC && type_is_function(sx, ident_get_type(sx, prototype)))
+		{
+			vector_set(&inl.definitions, prototype, definition);
+		}
+	}
+
+	return inl;
+}
+
+node inliner_get_definition(const inliner *const inl, const node *const nd)
+{
+	const node callee = expression_call_get_callee(nd);
+	if (expression_get_class(&callee) != EXPR_IDENTIFIER)
+	{
+		return node_broken();
+	}
+
+	const size_t identifier = expression_identifier_get_id(&callee);
+	const item_t definition = identifier < vector_size(&inl->definitions)
+		? vector_get(&inl->definitions, identifier)
+		: 0;
+
+	return definition > 0 ? node_load(&inl->sx->tree, (size_t)definition - 1) : node_broken();
+}
+
+void inliner_clear(inliner *const inl)
+{
+	vector_clear(&inl->definitions);
+}
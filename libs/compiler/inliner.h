@@ -0,0 +1,71 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "syntax.h"
+#include "tree.h"
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Selector of functions for inline expansion of calls.
+ *
+ *	Function can be inlined, if its body is small, calls no user functions,
+ *	does not take addresses and does not allocate arrays or structures,
+ *	has only scalar parameters and returns only by its last statement.
+ *	Expansion itself is done by backend.
+ */
+typedef struct inliner
+{
+	syntax *sx;					/**< Syntax structure */
+	vector definitions;			/**< Saved definition plus one for each identifier of inlinable function */
+} inliner;
+
+
+/**
+ *	Create inliner and select inlinable functions of translation unit
+ *
+ *	@param	sx				Syntax structure
+ *
+ *	@return	Inliner
+ */
+inliner inliner_create(syntax *const sx);
+
+/**
+ *	Get definition of function, which call can be expanded inline
+ *
+ *	@param	inl				Inliner
+ *	@param	nd				Call expression
+ *
+ *	@return	Function definition, broken node if call cannot be inlined
+ */
+node inliner_get_definition(const inliner *const inl, const node *const nd);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	inl				Inliner
+ */
+void inliner_clear(inliner *const inl);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
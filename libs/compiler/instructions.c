@@ -16,10 +16,461 @@
 
 #include "instructions.h"
 #include "errors.h"
+#include "utf8.h"
+
+
+/** Index of instruction in metadata table, codes of printing functions are negative */
+#define INSTRUCTION_INDEX(code) ((code) < MIN_INSTRUCTION_CODE \
+	? (size_t)((code) - IC_GETID) \
+	: (size_t)((code) - MIN_INSTRUCTION_CODE + IC_PRINTID - IC_GETID + 1))
+
+/** Instruction by its index in metadata table */
+#define INSTRUCTION_BY_INDEX(index) ((index) <= (size_t)(IC_PRINTID - IC_GETID) \
+	? (instruction_t)(IC_GETID + (int)(index)) \
+	: (instruction_t)(MIN_INSTRUCTION_CODE + (int)(index) - (IC_PRINTID - IC_GETID + 1)))
 
 
 static const size_t DISPL_TO_FLOAT = 50;
 static const size_t DISPL_TO_VOID = 200;
+static const size_t DISPL_GLOBAL_TO_VOID = IC_REM_ASSIGN_V_G - IC_REM_ASSIGN_G;
+
+/** Ranges of instructions with variable displacement and first instructions of their global versions */
+static const instruction_t GLOBAL_RANGES[][3] =
+{
+	{ IC_REM_ASSIGN, IC_DIV_ASSIGN, IC_REM_ASSIGN_G },
+	{ IC_POST_INC, IC_PRE_DEC, IC_POST_INC_G },
+	{ IC_ASSIGN_R, IC_DIV_ASSIGN_R, IC_ASSIGN_R_G },
+	{ IC_POST_INC_R, IC_PRE_DEC_R, IC_POST_INC_R_G },
+	{ IC_REM_ASSIGN_V, IC_DIV_ASSIGN_V, IC_REM_ASSIGN_V_G },
+	{ IC_POST_INC_V, IC_PRE_DEC_V, IC_POST_INC_V_G },
+	{ IC_ASSIGN_R_V, IC_DIV_ASSIGN_R_V, IC_ASSIGN_R_V_G },
+	{ IC_POST_INC_R_V, IC_PRE_DEC_R_V, IC_POST_INC_R_V_G },
+	{ IC_LOAD, IC_LOADD, IC_LOAD_G },
+	{ IC_LA, IC_LA, IC_LA_G },
+};
+
+// Таблица заполняется по кодам команд, пропуски соответствуют неизвестным командам
+static const instruction_info INSTRUCTIONS[INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE)] =
+{
+	[INSTRUCTION_INDEX(IC_GETID)] = { "GETID", 1, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_PRINTF)] = { "PRINTF", 1, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_PRINT)] = { "PRINT", 1, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_PRINTID)] = { "PRINTID", 1, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_REM_ASSIGN)] = { "%=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SHL_ASSIGN)] = { "<<=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SHR_ASSIGN)] = { ">>=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_AND_ASSIGN)] = { "&=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_XOR_ASSIGN)] = { "^=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_OR_ASSIGN)] = { "|=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ASSIGN)] = { "=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN)] = { "+=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN)] = { "-=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN)] = { "*=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN)] = { "/=", 1, 0 },
+	[INSTRUCTION_INDEX(IC_REM_ASSIGN_AT)] = { "%=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SHL_ASSIGN_AT)] = { "<<=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SHR_ASSIGN_AT)] = { ">>=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_AND_ASSIGN_AT)] = { "&=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_XOR_ASSIGN_AT)] = { "^=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_OR_ASSIGN_AT)] = { "|=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_AT)] = { "=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_AT)] = { "+=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_AT)] = { "-=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_AT)] = { "*=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_AT)] = { "/=@", 0, -1 },
+	[INSTRUCTION_INDEX(IC_REM)] = { "%", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SHL)] = { "<<", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SHR)] = { ">>", 0, -1 },
+	[INSTRUCTION_INDEX(IC_AND)] = { "&", 0, -1 },
+	[INSTRUCTION_INDEX(IC_XOR)] = { "^", 0, -1 },
+	[INSTRUCTION_INDEX(IC_OR)] = { "|", 0, -1 },
+	[INSTRUCTION_INDEX(IC_LOG_AND)] = { "&&", 0, -1 },
+	[INSTRUCTION_INDEX(IC_LOG_OR)] = { "||", 0, -1 },
+	[INSTRUCTION_INDEX(IC_EQ)] = { "==", 0, -1 },
+	[INSTRUCTION_INDEX(IC_NE)] = { "!=", 0, -1 },
+	[INSTRUCTION_INDEX(IC_LT)] = { "<", 0, -1 },
+	[INSTRUCTION_INDEX(IC_GT)] = { ">", 0, -1 },
+	[INSTRUCTION_INDEX(IC_LE)] = { "<=", 0, -1 },
+	[INSTRUCTION_INDEX(IC_GE)] = { ">=", 0, -1 },
+	[INSTRUCTION_INDEX(IC_ADD)] = { "+", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SUB)] = { "-", 0, -1 },
+	[INSTRUCTION_INDEX(IC_MUL)] = { "*", 0, -1 },
+	[INSTRUCTION_INDEX(IC_DIV)] = { "/", 0, -1 },
+	[INSTRUCTION_INDEX(IC_POST_INC)] = { "POSTINC", 1, 1 },
+	[INSTRUCTION_INDEX(IC_POST_DEC)] = { "POSTDEC", 1, 1 },
+	[INSTRUCTION_INDEX(IC_PRE_INC)] = { "INC", 1, 1 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC)] = { "DEC", 1, 1 },
+	[INSTRUCTION_INDEX(IC_POST_INC_AT)] = { "POSTINC@", 0, 0 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_AT)] = { "POSTDEC@", 0, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_AT)] = { "INC@", 0, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_AT)] = { "DEC@", 0, 0 },
+	[INSTRUCTION_INDEX(IC_UNMINUS)] = { "UNMINUS", 0, 0 },
+	[INSTRUCTION_INDEX(IC_NOT)] = { "BITNOT", 0, 0 },
+	[INSTRUCTION_INDEX(IC_LOG_NOT)] = { "NOT", 0, 0 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_R)] = { "=f", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_R)] = { "+=f", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_R)] = { "-=f", 1, 0 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_R)] = { "*=f", 1, 0 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_R)] = { "/=f", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_AT_R)] = { "=@f", 0, -1 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_AT_R)] = { "+=@f", 0, -1 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_AT_R)] = { "-=@f", 0, -1 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_AT_R)] = { "*=@f", 0, -1 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_AT_R)] = { "/=@f", 0, -1 },
+	[INSTRUCTION_INDEX(IC_EQ_R)] = { "==f", 0, -3 },
+	[INSTRUCTION_INDEX(IC_NE_R)] = { "!=f", 0, -3 },
+	[INSTRUCTION_INDEX(IC_LT_R)] = { "<f", 0, -3 },
+	[INSTRUCTION_INDEX(IC_GT_R)] = { ">f", 0, -3 },
+	[INSTRUCTION_INDEX(IC_LE_R)] = { "<=f", 0, -3 },
+	[INSTRUCTION_INDEX(IC_GE_R)] = { ">=f", 0, -3 },
+	[INSTRUCTION_INDEX(IC_ADD_R)] = { "+f", 0, -2 },
+	[INSTRUCTION_INDEX(IC_SUB_R)] = { "-f", 0, -2 },
+	[INSTRUCTION_INDEX(IC_MUL_R)] = { "*f", 0, -2 },
+	[INSTRUCTION_INDEX(IC_DIV_R)] = { "/f", 0, -2 },
+	[INSTRUCTION_INDEX(IC_POST_INC_R)] = { "POSTINCf", 1, 2 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_R)] = { "POSTDECf", 1, 2 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_R)] = { "INCf", 1, 2 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_R)] = { "DECf", 1, 2 },
+	[INSTRUCTION_INDEX(IC_POST_INC_AT_R)] = { "POSTINC@f", 0, 1 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_AT_R)] = { "POSTDEC@f", 0, 1 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_AT_R)] = { "INC@f", 0, 1 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_AT_R)] = { "DEC@f", 0, 1 },
+	[INSTRUCTION_INDEX(IC_UNMINUS_R)] = { "UNMINUSf", 0, 0 },
+	[INSTRUCTION_INDEX(IC_REM_ASSIGN_V)] = { "%=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SHL_ASSIGN_V)] = { "<<=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SHR_ASSIGN_V)] = { ">>=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_AND_ASSIGN_V)] = { "&=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_XOR_ASSIGN_V)] = { "^=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_OR_ASSIGN_V)] = { "|=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_V)] = { "=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_V)] = { "+=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_V)] = { "-=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_V)] = { "*=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_V)] = { "/=V", 1, -1 },
+	[INSTRUCTION_INDEX(IC_REM_ASSIGN_AT_V)] = { "%=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_SHL_ASSIGN_AT_V)] = { "<<=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_SHR_ASSIGN_AT_V)] = { ">>=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_AND_ASSIGN_AT_V)] = { "&=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_XOR_ASSIGN_AT_V)] = { "^=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_OR_ASSIGN_AT_V)] = { "|=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_AT_V)] = { "=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_AT_V)] = { "+=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_AT_V)] = { "-=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_AT_V)] = { "*=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_AT_V)] = { "/=@V", 0, -2 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_R_V)] = { "=fV", 1, -2 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_R_V)] = { "+=fV", 1, -2 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_R_V)] = { "-=fV", 1, -2 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_R_V)] = { "*=fV", 1, -2 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_R_V)] = { "/=fV", 1, -2 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_AT_R_V)] = { "=@fV", 0, -3 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_AT_R_V)] = { "+=@fV", 0, -3 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_AT_R_V)] = { "-=@fV", 0, -3 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_AT_R_V)] = { "*=@fV", 0, -3 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_AT_R_V)] = { "/=@fV", 0, -3 },
+	[INSTRUCTION_INDEX(IC_POST_INC_V)] = { "POSTINCV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_V)] = { "POSTDECV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_V)] = { "INCV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_V)] = { "DECV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_INC_AT_V)] = { "POSTINC@V", 0, -1 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_AT_V)] = { "POSTDEC@V", 0, -1 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_AT_V)] = { "INC@V", 0, -1 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_AT_V)] = { "DEC@V", 0, -1 },
+	[INSTRUCTION_INDEX(IC_POST_INC_R_V)] = { "POSTINCfV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_R_V)] = { "POSTDECfV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_R_V)] = { "INCfV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_R_V)] = { "DECfV", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_INC_AT_R_V)] = { "POSTINC@fV", 0, -1 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_AT_R_V)] = { "POSTDEC@fV", 0, -1 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_AT_R_V)] = { "INC@fV", 0, -1 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_AT_R_V)] = { "DEC@fV", 0, -1 },
+	[INSTRUCTION_INDEX(IC_NOP)] = { "NOP", 0, 0 },
+	[INSTRUCTION_INDEX(IC_DEFARR)] = { "DEFARR", 7, STACK_VARIABLE, { "N", "elem_len", "displ", "iniproc", "usual", "all", "instruct" } },
+	[INSTRUCTION_INDEX(IC_LI)] = { "LI", 1, 1 },
+	[INSTRUCTION_INDEX(IC_LID)] = { "LID", 2, 2 },
+	[INSTRUCTION_INDEX(IC_LOAD)] = { "LOAD", 1, 1 },
+	[INSTRUCTION_INDEX(IC_LOADD)] = { "LOADD", 1, 2 },
+	[INSTRUCTION_INDEX(IC_LAT)] = { "L@", 0, 0 },
+	[INSTRUCTION_INDEX(IC_LATD)] = { "L@f", 0, 1 },
+	[INSTRUCTION_INDEX(IC_STOP)] = { "STOP", 0, 0 },
+	[INSTRUCTION_INDEX(IC_SELECT)] = { "SELECT", 1, 0, { "field_displ" } },
+	[INSTRUCTION_INDEX(IC_FUNC_BEG)] = { "FUNCBEG", 2, 0, { "maxdispl", "pc" } },
+	[INSTRUCTION_INDEX(IC_LA)] = { "LA", 1, 1 },
+	[INSTRUCTION_INDEX(IC_CALL1)] = { "CALL1", 0, 0 },
+	[INSTRUCTION_INDEX(IC_CALL2)] = { "CALL2", 1, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_RETURN_VAL)] = { "RETURNVAL", 1, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_RETURN_VOID)] = { "RETURNVOID", 0, 0 },
+	[INSTRUCTION_INDEX(IC_B)] = { "B", 1, 0 },
+	[INSTRUCTION_INDEX(IC_BE0)] = { "BE0", 1, -1 },
+	[INSTRUCTION_INDEX(IC_BNE0)] = { "BNE0", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SLICE)] = { "SLICE", 1, -1, { "d" } },
+	[INSTRUCTION_INDEX(IC_WIDEN)] = { "WIDEN", 0, 1 },
+	[INSTRUCTION_INDEX(IC_WIDEN1)] = { "WIDEN1", 0, 1 },
+	[INSTRUCTION_INDEX(IC_DUPLICATE)] = { "DUPLICATE", 0, 1 },
+	[INSTRUCTION_INDEX(IC_ARR_INIT)] = { "ARRINIT", 4, STACK_VARIABLE, { "N", "elem_len", "displ", "usual" } },
+	[INSTRUCTION_INDEX(IC_STRUCT_WITH_ARR)] = { "STRUCTWITHARR", 2, STACK_VARIABLE, { "displ", "iniproc" } },
+	[INSTRUCTION_INDEX(IC_BEG_INIT)] = { "BEGINIT", 1, STACK_VARIABLE, { "n" } },
+	[INSTRUCTION_INDEX(IC_TAIL_CALL)] = { "TAILCALL", 2, STACK_VARIABLE, { "func", "args" } },
+	[INSTRUCTION_INDEX(IC_FUNC_BEG_LEAF)] = { "FUNCBEGLEAF", 2, 0, { "maxdispl", "pc" } },
+	[INSTRUCTION_INDEX(IC_COPY00)] = { "COPY00", 3, STACK_VARIABLE, { "displleft", "displright", "length" } },
+	[INSTRUCTION_INDEX(IC_COPY01)] = { "COPY01", 2, STACK_VARIABLE, { "displleft", "length" } },
+	[INSTRUCTION_INDEX(IC_COPY10)] = { "COPY10", 2, STACK_VARIABLE, { "displright", "length" } },
+	[INSTRUCTION_INDEX(IC_COPY11)] = { "COPY11", 1, STACK_VARIABLE, { "length" } },
+	[INSTRUCTION_INDEX(IC_COPY0ST)] = { "COPY0ST", 2, STACK_VARIABLE, { "displleft", "length" } },
+	[INSTRUCTION_INDEX(IC_COPY1ST)] = { "COPY1ST", 1, STACK_VARIABLE, { "length" } },
+	[INSTRUCTION_INDEX(IC_COPY0ST_ASSIGN)] = { "COPY0STASS", 2, STACK_VARIABLE, { "displleft", "length" } },
+	[INSTRUCTION_INDEX(IC_COPY1ST_ASSIGN)] = { "COPY1STASS", 1, STACK_VARIABLE, { "length" } },
+	[INSTRUCTION_INDEX(IC_COPYST)] = { "COPYST", 3, STACK_VARIABLE, { "displ", "length", "length1" } },
+	[INSTRUCTION_INDEX(IC_REM_ASSIGN_G)] = { "%=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SHL_ASSIGN_G)] = { "<<=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SHR_ASSIGN_G)] = { ">>=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_AND_ASSIGN_G)] = { "&=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_XOR_ASSIGN_G)] = { "^=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_OR_ASSIGN_G)] = { "|=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_G)] = { "=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_G)] = { "+=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_G)] = { "-=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_G)] = { "*=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_G)] = { "/=G", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_INC_G)] = { "POSTINCG", 1, 1 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_G)] = { "POSTDECG", 1, 1 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_G)] = { "INCG", 1, 1 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_G)] = { "DECG", 1, 1 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_R_G)] = { "=fG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_R_G)] = { "+=fG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_R_G)] = { "-=fG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_R_G)] = { "*=fG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_R_G)] = { "/=fG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_INC_R_G)] = { "POSTINCfG", 1, 2 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_R_G)] = { "POSTDECfG", 1, 2 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_R_G)] = { "INCfG", 1, 2 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_R_G)] = { "DECfG", 1, 2 },
+	[INSTRUCTION_INDEX(IC_REM_ASSIGN_V_G)] = { "%=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SHL_ASSIGN_V_G)] = { "<<=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SHR_ASSIGN_V_G)] = { ">>=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_AND_ASSIGN_V_G)] = { "&=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_XOR_ASSIGN_V_G)] = { "^=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_OR_ASSIGN_V_G)] = { "|=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_V_G)] = { "=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_V_G)] = { "+=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_V_G)] = { "-=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_V_G)] = { "*=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_V_G)] = { "/=VG", 1, -1 },
+	[INSTRUCTION_INDEX(IC_POST_INC_V_G)] = { "POSTINCVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_V_G)] = { "POSTDECVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_V_G)] = { "INCVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_V_G)] = { "DECVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_ASSIGN_R_V_G)] = { "=fVG", 1, -2 },
+	[INSTRUCTION_INDEX(IC_ADD_ASSIGN_R_V_G)] = { "+=fVG", 1, -2 },
+	[INSTRUCTION_INDEX(IC_SUB_ASSIGN_R_V_G)] = { "-=fVG", 1, -2 },
+	[INSTRUCTION_INDEX(IC_MUL_ASSIGN_R_V_G)] = { "*=fVG", 1, -2 },
+	[INSTRUCTION_INDEX(IC_DIV_ASSIGN_R_V_G)] = { "/=fVG", 1, -2 },
+	[INSTRUCTION_INDEX(IC_POST_INC_R_V_G)] = { "POSTINCfVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_POST_DEC_R_V_G)] = { "POSTDECfVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_INC_R_V_G)] = { "INCfVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_PRE_DEC_R_V_G)] = { "DECfVG", 1, 0 },
+	[INSTRUCTION_INDEX(IC_LOAD_G)] = { "LOADG", 1, 1 },
+	[INSTRUCTION_INDEX(IC_LOADD_G)] = { "LOADDG", 1, 2 },
+	[INSTRUCTION_INDEX(IC_LA_G)] = { "LAG", 1, 1 },
+	[INSTRUCTION_INDEX(IC_ABS)] = { "ABS", 0, 0 },
+	[INSTRUCTION_INDEX(IC_SQRT)] = { "SQRT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_EXP)] = { "EXP", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SIN)] = { "SIN", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_COS)] = { "COS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_LOG)] = { "LOG", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_LOG10)] = { "LOG10", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ASIN)] = { "ASIN", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_RAND)] = { "RAND", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROUND)] = { "ROUND", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRCPY)] = { "STRCPY", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRNCPY)] = { "STRNCPY", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRCAT)] = { "STRCAT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRNCAT)] = { "STRNCAT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRCMP)] = { "STRCMP", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRNCMP)] = { "STRNCMP", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRSTR)] = { "STRSTR", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_STRLEN)] = { "STRLENC", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_MSG_SEND)] = { "TMSGSEND", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_MSG_RECEIVE)] = { "TMSGRECEIVE", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_JOIN)] = { "TJOIN", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SLEEP)] = { "TSLEEP", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SEM_CREATE)] = { "TSEMCREATE", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SEM_WAIT)] = { "TSEMWAIT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SEM_POST)] = { "TSEMPOST", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_CREATE)] = { "TCREATE", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_INIT)] = { "INITC", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_DESTROY)] = { "DESTROYC", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_EXIT)] = { "TEXIT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_GETNUM)] = { "GETNUMC", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_UPB)] = { "UPB", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_SEND_INT)] = { "SEND_INT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_SEND_FLOAT)] = { "SEND_FLOAT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_SEND_STRING)] = { "SEND_STRING", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_RECEIVE_INT)] = { "RECEIVE_INT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_RECEIVE_FLOAT)] = { "RECEIVE_FLOAT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_RECEIVE_STRING)] = { "RECEIVE_STRING", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ASSERT)] = { "ASSERT", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ABSI)] = { "ABSI", 0, 0 },
+	[INSTRUCTION_INDEX(IC_FREAD_CHARS)] = { "FREADCHARS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_FWRITE_CHARS)] = { "FWRITECHARS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_FREAD_INTS)] = { "FREADINTS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_FWRITE_INTS)] = { "FWRITEINTS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_FGETLINE)] = { "FGETLINE", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ATOMIC_ADD)] = { "ATOMICADD", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ATOMIC_CAS)] = { "ATOMICCAS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ATOMIC_LOAD)] = { "ATOMICLOAD", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ATOMIC_STORE)] = { "ATOMICSTORE", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_PARALLEL_FOR)] = { "PARALLELFOR", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_CHAN_SEND)] = { "CHANSEND", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_CHAN_RECEIVE)] = { "CHANRECEIVE", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_RECEIVE_INTS)] = { "RECEIVE_INTS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_ROBOT_RECEIVE_FLOATS)] = { "RECEIVE_FLOATS", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SET_PRIORITY)] = { "TSETPRIORITY", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_SET_AFFINITY)] = { "TSETAFFINITY", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_PERIOD_START)] = { "TPERIODSTART", 0, STACK_VARIABLE },
+	[INSTRUCTION_INDEX(IC_PERIOD_WAIT)] = { "TPERIODWAIT", 0, STACK_VARIABLE },
+};
+
+
+/**
+ *	Fill dense codes of instructions by their indexes in metadata table
+ *
+ *	@param	dense		Dense codes
+ *
+ *	@return	Number of dense codes
+ */
+static size_t dense_fill(size_t *const dense)
+{
+	// Плотный код команды равен числу известных команд с меньшими кодами
+	size_t amount = 0;
+	for (size_t i = 0; i < INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE); i++)
+	{
+		dense[i] = amount;
+		amount += INSTRUCTIONS[i].name != NULL ? 1 : 0;
+	}
+
+	return amount;
+}
+
+/**
+ *	Add item as zigzag LEB128 number, so small negative values are short too
+ *
+ *	@param	bytes		Compact codes
+ *	@param	value		Item
+ */
+static void compact_add(vector *const bytes, const item_t value)
+{
+	const int64_t number = (int64_t)value;
+	uint64_t rest = ((uint64_t)number << 1) ^ (number < 0 ? UINT64_MAX : 0);
+	do
+	{
+		vector_add(bytes, (item_t)((rest & 0x7F) | (rest > 0x7F ? 0x80 : 0)));
+		rest >>= 7;
+	} while (rest != 0);
+}
+
+/**
+ *	Read item as zigzag LEB128 number
+ *
+ *	@param	bytes		Compact codes
+ *	@param	size		Size of compact codes
+ *	@param	offset		Offset in compact codes to update
+ *	@param	value		Item
+ *
+ *	@return	@c 0 on success, @c -1 on truncated or too long number
+ */
+static int compact_get(const uint8_t *const bytes, const size_t size, size_t *const offset, item_t *const value)
+{
+	uint64_t rest = 0;
+	for (size_t shift = 0; ; shift += 7)
+	{
+		if (*offset >= size || shift >= 64)
+		{
+			return -1;
+		}
+
+		const uint8_t byte = bytes[(*offset)++];
+		rest |= (uint64_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	*value = (item_t)(int64_t)((rest >> 1) ^ ((rest & 1) != 0 ? UINT64_MAX : 0));
+	return 0;
+}
+
+/**
+ *	Add string literal as number of characters and characters in UTF-8
+ *
+ *	@param	bytes		Compact codes
+ *	@param	codes		Codes of virtual machine
+ *	@param	begin		Address of number of characters
+ *	@param	end			End of string literal
+ *
+ *	@return	@c 0 on success, @c -1 on wrong number of characters or character
+ */
+static int compact_add_text(vector *const bytes, const vector *const codes, const size_t begin, const size_t end)
+{
+	const item_t length = vector_get(codes, begin);
+	if (length < 0 || (size_t)length != end - begin - 1)
+	{
+		return -1;
+	}
+
+	compact_add(bytes, length);
+	for (size_t i = begin + 1; i < end; i++)
+	{
+		char buffer[8];
+		const size_t size = utf8_to_string(buffer, (char32_t)vector_get(codes, i));
+		if (size == 0)
+		{
+			return -1;
+		}
+
+		for (size_t j = 0; j < size; j++)
+		{
+			vector_add(bytes, (item_t)(uint8_t)buffer[j]);
+		}
+	}
+
+	return 0;
+}
+
+/**
+ *	Read string literal from number of characters and characters in UTF-8
+ *
+ *	@param	bytes		Compact codes
+ *	@param	size		Size of compact codes
+ *	@param	offset		Offset in compact codes to update
+ *	@param	codes		Codes of virtual machine
+ *
+ *	@return	@c 0 on success, @c -1 on truncated string literal
+ */
+static int compact_get_text(const uint8_t *const bytes, const size_t size, size_t *const offset, vector *const codes)
+{
+	item_t length;
+	if (compact_get(bytes, size, offset, &length) || length < 0)
+	{
+		return -1;
+	}
+
+	vector_add(codes, length);
+	for (item_t i = 0; i < length; i++)
+	{
+		if (*offset >= size || utf8_symbol_size((char)bytes[*offset]) > size - *offset)
+		{
+			return -1;
+		}
+
+		const char *const symbol = (const char *)&bytes[*offset];
+		vector_add(codes, (item_t)utf8_convert(symbol));
+		*offset += utf8_symbol_size(*symbol);
+	}
+
+	return 0;
+}
 
 
 instruction_t builtin_to_instruction(const builtin_t func)
@@ -62,10 +513,28 @@ instruction_t builtin_to_instruction(const builtin_t func)
 		case BI_ROBOT_RECEIVE_INT:		return IC_ROBOT_RECEIVE_INT;
 		case BI_ROBOT_RECEIVE_FLOAT:	return IC_ROBOT_RECEIVE_FLOAT;
 		case BI_ROBOT_RECEIVE_STRING:	return IC_ROBOT_RECEIVE_STRING;
+		case BI_ROBOT_RECEIVE_INTS:		return IC_ROBOT_RECEIVE_INTS;
+		case BI_ROBOT_RECEIVE_FLOATS:	return IC_ROBOT_RECEIVE_FLOATS;
 		case BI_FOPEN:					return IC_FOPEN;
 		case BI_FGETC:					return IC_FGETC;
 		case BI_FPUTC:					return IC_FPUTC;
 		case BI_FCLOSE:					return IC_FCLOSE;
+		case BI_FREAD_CHARS:			return IC_FREAD_CHARS;
+		case BI_FWRITE_CHARS:			return IC_FWRITE_CHARS;
+		case BI_FREAD_INTS:				return IC_FREAD_INTS;
+		case BI_FWRITE_INTS:			return IC_FWRITE_INTS;
+		case BI_FGETLINE:				return IC_FGETLINE;
+		case BI_ATOMIC_ADD:				return IC_ATOMIC_ADD;
+		case BI_ATOMIC_CAS:				return IC_ATOMIC_CAS;
+		case BI_ATOMIC_LOAD:			return IC_ATOMIC_LOAD;
+		case BI_ATOMIC_STORE:			return IC_ATOMIC_STORE;
+		case BI_PARALLEL_FOR:			return IC_PARALLEL_FOR;
+		case BI_CHAN_SEND:				return IC_CHAN_SEND;
+		case BI_CHAN_RECEIVE:			return IC_CHAN_RECEIVE;
+		case BI_T_SET_PRIORITY:			return IC_SET_PRIORITY;
+		case BI_T_SET_AFFINITY:			return IC_SET_AFFINITY;
+		case BI_T_PERIOD_START:			return IC_PERIOD_START;
+		case BI_T_PERIOD_WAIT:			return IC_PERIOD_WAIT;
 
 		default:
 			system_error(node_unexpected);
@@ -174,5 +643,196 @@ instruction_t instruction_to_void_ver(const instruction_t instruction)
 		|| (instruction >= IC_ASSIGN_R && instruction <= IC_DIV_ASSIGN_AT_R)
 		|| (instruction >= IC_POST_INC_R && instruction <= IC_PRE_DEC_AT_R)
 			? (instruction_t)((size_t)instruction + DISPL_TO_VOID)
-			: instruction;
+			: (instruction >= IC_ASSIGN_G && instruction <= IC_PRE_DEC_R_G)
+				? (instruction_t)((size_t)instruction + DISPL_GLOBAL_TO_VOID)
+				: instruction;
+}
+
+instruction_t instruction_to_global_ver(const instruction_t instruction)
+{
+	for (size_t i = 0; i < sizeof(GLOBAL_RANGES) / sizeof(GLOBAL_RANGES[0]); i++)
+	{
+		if (instruction >= GLOBAL_RANGES[i][0] && instruction <= GLOBAL_RANGES[i][1])
+		{
+			return (instruction_t)((size_t)GLOBAL_RANGES[i][2] + (size_t)(instruction - GLOBAL_RANGES[i][0]));
+		}
+	}
+
+	return instruction;
+}
+
+const instruction_info *instruction_get_info(const instruction_t instruction)
+{
+	if ((instruction < IC_GETID || instruction > IC_PRINTID)
+		&& (instruction <= MIN_INSTRUCTION_CODE || instruction >= MAX_INSTRUCTION_CODE))
+	{
+		return NULL;
+	}
+
+	const instruction_info *const info = &INSTRUCTIONS[INSTRUCTION_INDEX(instruction)];
+	return info->name != NULL ? info : NULL;
+}
+
+size_t instruction_dense_amount(void)
+{
+	size_t dense[INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE)];
+	return dense_fill(dense);
+}
+
+int instructions_to_dense(vector *const codes, const vector *const blocks)
+{
+	size_t dense[INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE)];
+	dense_fill(dense);
+
+	const size_t size = vector_size(codes);
+	size_t block = 0;
+	size_t i = 0;
+	while (i < size)
+	{
+		if (block < vector_size(blocks) && i == (size_t)vector_get(blocks, block))
+		{
+			i = (size_t)vector_get(blocks, block + 1);
+			block += 2;
+			continue;
+		}
+
+		const instruction_t instruction = (instruction_t)vector_get(codes, i);
+		const instruction_info *const info = instruction_get_info(instruction);
+		if (info == NULL)
+		{
+			return -1;
+		}
+
+		vector_set(codes, i, (item_t)dense[INSTRUCTION_INDEX(instruction)]);
+		i += info->argc + 1;
+	}
+
+	return i == size ? 0 : -1;
+}
+
+int instructions_compact(const vector *const codes, const vector *const blocks, const vector *const texts
+	, vector *const bytes)
+{
+	size_t dense[INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE)];
+	if (dense_fill(dense) > UINT8_MAX + 1)
+	{
+		return -1;
+	}
+
+	const size_t size = vector_size(codes);
+	size_t block = 0;
+	size_t text = 0;
+	size_t i = 0;
+	while (i < size)
+	{
+		if (block < vector_size(blocks) && i == (size_t)vector_get(blocks, block))
+		{
+			// Данные внутри кода не содержат команд
+			const size_t end = (size_t)vector_get(blocks, block + 1);
+			if (texts != NULL && text < vector_size(texts) && i == (size_t)vector_get(texts, text))
+			{
+				if (compact_add_text(bytes, codes, i, end))
+				{
+					return -1;
+				}
+
+				i = end;
+				text++;
+			}
+
+			for (; i < end; i++)
+			{
+				compact_add(bytes, vector_get(codes, i));
+			}
+
+			block += 2;
+			continue;
+		}
+
+		const instruction_t instruction = (instruction_t)vector_get(codes, i);
+		const instruction_info *const info = instruction_get_info(instruction);
+		if (info == NULL || i + info->argc >= size)
+		{
+			return -1;
+		}
+
+		vector_add(bytes, (item_t)dense[INSTRUCTION_INDEX(instruction)]);
+		for (size_t j = 1; j <= info->argc; j++)
+		{
+			compact_add(bytes, vector_get(codes, i + j));
+		}
+
+		i += info->argc + 1;
+	}
+
+	return i == size ? 0 : -1;
+}
+
+int instructions_expand(const uint8_t *const bytes, const size_t size, const vector *const blocks
+	, const vector *const texts, vector *const codes)
+{
+	size_t instructions[INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE)];
+	size_t amount = 0;
+	for (size_t i = 0; i < INSTRUCTION_INDEX(MAX_INSTRUCTION_CODE); i++)
+	{
+		if (INSTRUCTIONS[i].name != NULL)
+		{
+			instructions[amount++] = i;
+		}
+	}
+
+	size_t block = 0;
+	size_t text = 0;
+	size_t offset = 0;
+	while (offset < size)
+	{
+		const size_t position = vector_size(codes);
+		item_t value;
+		if (block < vector_size(blocks) && position == (size_t)vector_get(blocks, block))
+		{
+			const size_t end = (size_t)vector_get(blocks, block + 1);
+			if (texts != NULL && text < vector_size(texts) && position == (size_t)vector_get(texts, text))
+			{
+				if (compact_get_text(bytes, size, &offset, codes) || vector_size(codes) != end)
+				{
+					return -1;
+				}
+
+				text++;
+			}
+
+			for (size_t i = vector_size(codes); i < end; i++)
+			{
+				if (compact_get(bytes, size, &offset, &value))
+				{
+					return -1;
+				}
+
+				vector_add(codes, value);
+			}
+
+			block += 2;
+			continue;
+		}
+
+		const uint8_t opcode = bytes[offset++];
+		if (opcode >= amount)
+		{
+			return -1;
+		}
+
+		const instruction_t instruction = INSTRUCTION_BY_INDEX(instructions[opcode]);
+		vector_add(codes, (item_t)instruction);
+		for (size_t j = 0; j < INSTRUCTIONS[instructions[opcode]].argc; j++)
+		{
+			if (compact_get(bytes, size, &offset, &value))
+			{
+				return -1;
+			}
+
+			vector_add(codes, value);
+		}
+	}
+
+	return 0;
 }
@@ -16,13 +16,25 @@
 
 #pragma once
 
+#include <limits.h>
 #include "operations.h"
+#include "vector.h"
 
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Maximum number of instruction operands */
+#define MAX_INSTRUCTION_OPERANDS 7
+
+/** Stack effect of instruction, which depends on its operands or callee */
+#define STACK_VARIABLE INT_MIN
+
+/** Version of dense instruction codes, increased on every change of instructions set */
+#define DENSE_INSTRUCTION_VERSION 2
+
+
 typedef enum INSTURCTION
 {
 	IC_GETID = -27,				/**< 'GETID' instruction code */
@@ -198,6 +210,8 @@ typedef enum INSTURCTION
 	IC_BEG_INIT = 9481,			/**< 'BEGINIT' instruction code */
 	IC_ROWING,					/**< 'ROWING' instruction code */
 	IC_ROWING_D,				/**< 'ROWINGD' instruction code */
+	IC_TAIL_CALL,				/**< 'TAILCALL' instruction code */
+	IC_FUNC_BEG_LEAF,			/**< 'FUNCBEGLEAF' instruction code */
 
 	IC_COPY00 = 9300,			/**< 'COPY00' instruction code */
 	IC_COPY01,					/**< 'COPY01' instruction code */
@@ -209,6 +223,58 @@ typedef enum INSTURCTION
 	IC_COPY1ST_ASSIGN,			/**< 'COPY1STASS' instruction code */
 	IC_COPYST,					/**< 'COPYST' instruction code */
 
+	IC_REM_ASSIGN_G = 9311,		/**< '%=G' instruction code */
+	IC_SHL_ASSIGN_G,			/**< '<<=G' instruction code */
+	IC_SHR_ASSIGN_G,			/**< '>>=G' instruction code */
+	IC_AND_ASSIGN_G,			/**< '&=G' instruction code */
+	IC_XOR_ASSIGN_G,			/**< '^=G' instruction code */
+	IC_OR_ASSIGN_G,				/**< '|=G' instruction code */
+	IC_ASSIGN_G,				/**< '=G' instruction code */
+	IC_ADD_ASSIGN_G,			/**< '+=G' instruction code */
+	IC_SUB_ASSIGN_G,			/**< '-=G' instruction code */
+	IC_MUL_ASSIGN_G,			/**< '*=G' instruction code */
+	IC_DIV_ASSIGN_G,			/**< '/=G' instruction code */
+	IC_POST_INC_G,				/**< 'POSTINCG' instruction code */
+	IC_POST_DEC_G,				/**< 'POSTDECG' instruction code */
+	IC_PRE_INC_G,				/**< 'INCG' instruction code */
+	IC_PRE_DEC_G,				/**< 'DECG' instruction code */
+	IC_ASSIGN_R_G,				/**< '=fG' instruction code */
+	IC_ADD_ASSIGN_R_G,			/**< '+=fG' instruction code */
+	IC_SUB_ASSIGN_R_G,			/**< '-=fG' instruction code */
+	IC_MUL_ASSIGN_R_G,			/**< '*=fG' instruction code */
+	IC_DIV_ASSIGN_R_G,			/**< '/=fG' instruction code */
+	IC_POST_INC_R_G,			/**< 'POSTINCfG' instruction code */
+	IC_POST_DEC_R_G,			/**< 'POSTDECfG' instruction code */
+	IC_PRE_INC_R_G,				/**< 'INCfG' instruction code */
+	IC_PRE_DEC_R_G,				/**< 'DECfG' instruction code */
+	IC_REM_ASSIGN_V_G,			/**< '%=VG' instruction code */
+	IC_SHL_ASSIGN_V_G,			/**< '<<=VG' instruction code */
+	IC_SHR_ASSIGN_V_G,			/**< '>>=VG' instruction code */
+	IC_AND_ASSIGN_V_G,			/**< '&=VG' instruction code */
+	IC_XOR_ASSIGN_V_G,			/**< '^=VG' instruction code */
+	IC_OR_ASSIGN_V_G,			/**< '|=VG' instruction code */
+	IC_ASSIGN_V_G,				/**< '=VG' instruction code */
+	IC_ADD_ASSIGN_V_G,			/**< '+=VG' instruction code */
+	IC_SUB_ASSIGN_V_G,			/**< '-=VG' instruction code */
+	IC_MUL_ASSIGN_V_G,			/**< '*=VG' instruction code */
+	IC_DIV_ASSIGN_V_G,			/**< '/=VG' instruction code */
+	IC_POST_INC_V_G,			/**< 'POSTINCVG' instruction code */
+	IC_POST_DEC_V_G,			/**< 'POSTDECVG' instruction code */
+	IC_PRE_INC_V_G,				/**< 'INCVG' instruction code */
+	IC_PRE_DEC_V_G,				/**< 'DECVG' instruction code */
+	IC_ASSIGN_R_V_G,			/**< '=fVG' instruction code */
+	IC_ADD_ASSIGN_R_V_G,		/**< '+=fVG' instruction code */
+	IC_SUB_ASSIGN_R_V_G,		/**< '-=fVG' instruction code */
+	IC_MUL_ASSIGN_R_V_G,		/**< '*=fVG' instruction code */
+	IC_DIV_ASSIGN_R_V_G,		/**< '/=fVG' instruction code */
+	IC_POST_INC_R_V_G,			/**< 'POSTINCfVG' instruction code */
+	IC_POST_DEC_R_V_G,			/**< 'POSTDECfVG' instruction code */
+	IC_PRE_INC_R_V_G,			/**< 'INCfVG' instruction code */
+	IC_PRE_DEC_R_V_G,			/**< 'DECfVG' instruction code */
+	IC_LOAD_G,					/**< 'LOADG' instruction code */
+	IC_LOADD_G,					/**< 'LOADDG' instruction code */
+	IC_LA_G,					/**< 'LAG' instruction code */
+
 	IC_ABS	= 9534,				/**< 'ABS' instruction code */
 	IC_SQRT,					/**< 'SQRT' instruction code */
 	IC_EXP,						/**< 'EXP' instruction code */
@@ -256,11 +322,39 @@ typedef enum INSTURCTION
 	IC_FCLOSE,					/**< 'FCLOSE' instruction code */
 	IC_FGETC,					/**< 'FGETC' instruction code */
 	IC_FPUTC,					/**< 'FPUTC' instruction code */
+	IC_FREAD_CHARS,				/**< 'FREADCHARS' instruction code */
+	IC_FWRITE_CHARS,			/**< 'FWRITECHARS' instruction code */
+	IC_FREAD_INTS,				/**< 'FREADINTS' instruction code */
+	IC_FWRITE_INTS,				/**< 'FWRITEINTS' instruction code */
+	IC_FGETLINE,				/**< 'FGETLINE' instruction code */
+	IC_ATOMIC_ADD,				/**< 'ATOMICADD' instruction code */
+	IC_ATOMIC_CAS,				/**< 'ATOMICCAS' instruction code */
+	IC_ATOMIC_LOAD,				/**< 'ATOMICLOAD' instruction code */
+	IC_ATOMIC_STORE,			/**< 'ATOMICSTORE' instruction code */
+	IC_PARALLEL_FOR,			/**< 'PARALLELFOR' instruction code */
+	IC_CHAN_SEND,				/**< 'CHANSEND' instruction code */
+	IC_CHAN_RECEIVE,			/**< 'CHANRECEIVE' instruction code */
+	IC_ROBOT_RECEIVE_INTS,		/**< 'RECEIVE_INTS' instruction code */
+	IC_ROBOT_RECEIVE_FLOATS,	/**< 'RECEIVE_FLOATS' instruction code */
+	IC_SET_PRIORITY,			/**< 'TSETPRIORITY' instruction code */
+	IC_SET_AFFINITY,			/**< 'TSETAFFINITY' instruction code */
+	IC_PERIOD_START,			/**< 'TPERIODSTART' instruction code */
+	IC_PERIOD_WAIT,				/**< 'TPERIODWAIT' instruction code */
 
 	MAX_INSTRUCTION_CODE,
 } instruction_t;
 
 
+/** Instruction metadata */
+typedef struct instruction_info
+{
+	const char *name;									/**< Mnemonic */
+	size_t argc;										/**< Number of operands */
+	int stack;											/**< Change of operand stack depth in words */
+	const char *operands[MAX_INSTRUCTION_OPERANDS];		/**< Names of operands, @c NULL for unnamed */
+} instruction_info;
+
+
 /**
  *	Convert standard function id to corresponding function instruction
  *
@@ -316,6 +410,75 @@ instruction_t instruction_to_floating_ver(const instruction_t instruction);
  */
 instruction_t instruction_to_void_ver(const instruction_t instruction);
 
+/**
+ *	Convert instruction with variable displacement to corresponding global version,
+ *	which addresses global memory without checking sign of displacement
+ *
+ *	@param	instruction		Instruction
+ *
+ *	@return	Global version of instruction
+ */
+instruction_t instruction_to_global_ver(const instruction_t instruction);
+
+/**
+ *	Get instruction metadata
+ *
+ *	@param	instruction		Instruction
+ *
+ *	@return	Instruction metadata, @c NULL for unknown instruction
+ */
+const instruction_info *instruction_get_info(const instruction_t instruction);
+
+/**
+ *	Get number of dense instruction codes.
+ *	Dense codes number known instructions from @c 0 in order of their codes.
+ *
+ *	@return	Number of dense codes
+ */
+size_t instruction_dense_amount(void);
+
+/**
+ *	Replace instructions in codes of virtual machine with their dense codes
+ *
+ *	@param	codes			Codes of virtual machine
+ *	@param	blocks			Ascending pairs of begin and end of data embedded in codes
+ *
+ *	@return	@c 0 on success, @c -1 on unknown instruction
+ */
+int instructions_to_dense(vector *const codes, const vector *const blocks);
+
+/**
+ *	Encode codes of virtual machine in compact form:
+ *	instructions take one octet of dense code, operands and embedded data
+ *	are zigzag LEB128 numbers. String literals are packed: after number of
+ *	characters they hold characters in UTF-8, so ASCII text takes an octet per character.
+ *
+ *	@param	codes			Codes of virtual machine
+ *	@param	blocks			Ascending pairs of begin and end of data embedded in codes
+ *	@param	texts			Ascending beginnings of string literals among embedded data,
+ *							@c NULL if string literals are not packed
+ *	@param	bytes			Compact codes, one octet per item
+ *
+ *	@return	@c 0 on success, @c -1 on unknown instruction or malformed string literal
+ */
+int instructions_compact(const vector *const codes, const vector *const blocks, const vector *const texts
+	, vector *const bytes);
+
+/**
+ *	Decode codes of virtual machine from compact form
+ *
+ *	@param	bytes			Compact codes
+ *	@param	size			Size of compact codes
+ *	@param	blocks			Ascending pairs of begin and end of data embedded in codes
+ *	@param	texts			Ascending beginnings of string literals among embedded data,
+ *							@c NULL if string literals are not packed
+ *	@param	codes			Codes of virtual machine
+ *
+ *	@return	@c 0 on success, @c -1 on malformed compact codes
+ */
+int instructions_expand(const uint8_t *const bytes, const size_t size, const vector *const blocks
+	, const vector *const texts, vector *const codes);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
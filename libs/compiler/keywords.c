@@ -0,0 +1,213 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+
+#include "keywords.h"
+#include <stdint.h>
+#include <string.h>
+
+
+/** Number of slots of perfect hash table, power of two */
+#define KEYWORDS_SIZE 512
+/** Number of buckets of displacement table, power of two */
+#define KEYWORDS_BUCKETS 64
+
+
+/** Slot of perfect hash table */
+typedef struct keyword_slot
+{
+	const char *spelling;					/**< Keyword spelling */
+	size_t size;							/**< Size of spelling */
+	token_t token;							/**< Keyword token */
+} keyword_slot;
+
+
+/*
+ *	Tables are generated for keywords registered by repr_init() in syntax.c,
+ *	they must be regenerated if keyword set changes.
+ *	Keyword 'main' is not included, because it is resolved as identifier.
+ */
+
+static const uint8_t displacements[KEYWORDS_BUCKETS] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0,
+	1, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0,
+	0, 0, 0, 1, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0,
+};
+
+static const keyword_slot slots[KEYWORDS_SIZE] =
+{
+	[2] = { "WHILE", 5, TK_WHILE },
+	[6] = { "ложь", 8, TK_FALSE },
+	[7] = { "случай", 12, TK_CASE },
+	[8] = { "VOID", 4, TK_VOID },
+	[14] = { "FLOAT4", 6, TK_FLOAT4 },
+	[15] = { "ничто", 10, TK_NULL },
+	[17] = { "длин", 8, TK_LONG },
+	[24] = { "FLOAT", 5, TK_FLOAT },
+	[26] = { "иначе", 10, TK_ELSE },
+	[27] = { "TRUE", 4, TK_TRUE },
+	[28] = { "do", 2, TK_DO },
+	[30] = { "float4", 6, TK_FLOAT4 },
+	[31] = { "typedef", 7, TK_TYPEDEF },
+	[32] = { "ВЕЩ", 6, TK_FLOAT },
+	[35] = { "цел4", 7, TK_INT4 },
+	[38] = { "двойной", 14, TK_DOUBLE },
+	[39] = { "файл", 8, TK_FILE },
+	[53] = { "булево", 12, TK_BOOL },
+	[61] = { "FILE", 4, TK_FILE },
+	[72] = { "abs", 3, TK_ABS },
+	[76] = { "char", 4, TK_CHAR },
+	[78] = { "BOOL", 4, TK_BOOL },
+	[89] = { "FALSE", 5, TK_FALSE },
+	[91] = { "БУЛЕВО", 12, TK_BOOL },
+	[98] = { "вещ4", 7, TK_FLOAT4 },
+	[104] = { "ИНАЧЕ", 10, TK_ELSE },
+	[105] = { "СТРУКТУРА", 18, TK_STRUCT },
+	[117] = { "СЛУЧАЙ", 12, TK_CASE },
+	[119] = { "CASE", 4, TK_CASE },
+	[132] = { "ABS", 3, TK_ABS },
+	[136] = { "ENUM", 4, TK_ENUM },
+	[138] = { "upb", 3, TK_UPB },
+	[146] = { "#СТРОКА", 13, TK_LINE },
+	[147] = { "int4", 4, TK_INT4 },
+	[148] = { "bool", 4, TK_BOOL },
+	[160] = { "для", 6, TK_FOR },
+	[174] = { "ДЛИН", 8, TK_LONG },
+	[175] = { "RETURN", 6, TK_RETURN },
+	[181] = { "void", 4, TK_VOID },
+	[183] = { "умолчание", 18, TK_DEFAULT },
+	[189] = { "ПОКА", 8, TK_WHILE },
+	[191] = { "возврат", 14, TK_RETURN },
+	[194] = { "struct", 6, TK_STRUCT },
+	[195] = { "INT", 3, TK_INT },
+	[196] = { "float", 5, TK_FLOAT },
+	[198] = { "ПЕРЕЧИСЛЕНИЕ", 24, TK_ENUM },
+	[199] = { "ЕСЛИ", 8, TK_IF },
+	[222] = { "LONG", 4, TK_LONG },
+	[226] = { "DEFAULT", 7, TK_DEFAULT },
+	[228] = { "#строка", 13, TK_LINE },
+	[229] = { "SWITCH", 6, TK_SWITCH },
+	[232] = { "IF", 2, TK_IF },
+	[234] = { "file", 4, TK_FILE },
+	[235] = { "double", 6, TK_DOUBLE },
+	[236] = { "long", 4, TK_LONG },
+	[239] = { "выбор", 10, TK_SWITCH },
+	[242] = { "for", 3, TK_FOR },
+	[249] = { "ЛОЖЬ", 8, TK_FALSE },
+	[262] = { "null", 4, TK_NULL },
+	[263] = { "false", 5, TK_FALSE },
+	[264] = { "ЛИТЕРА", 12, TK_CHAR },
+	[266] = { "STRUCT", 6, TK_STRUCT },
+	[271] = { "ВЫХОД", 10, TK_BREAK },
+	[277] = { "пока", 8, TK_WHILE },
+	[280] = { "TYPEDEF", 7, TK_TYPEDEF },
+	[291] = { "ТИПОПР", 12, TK_TYPEDEF },
+	[292] = { "#LINE", 5, TK_LINE },
+	[293] = { "case", 4, TK_CASE },
+	[296] = { "ДВОЙНОЙ", 14, TK_DOUBLE },
+	[301] = { "BREAK", 5, TK_BREAK },
+	[306] = { "ВЫБОР", 10, TK_SWITCH },
+	[312] = { "if", 2, TK_IF },
+	[313] = { "CONTINUE", 8, TK_CONTINUE },
+	[314] = { "default", 7, TK_DEFAULT },
+	[328] = { "перечисление", 24, TK_ENUM },
+	[334] = { "ЦИКЛ", 8, TK_DO },
+	[339] = { "истина", 12, TK_TRUE },
+	[345] = { "цикл", 8, TK_DO },
+	[353] = { "абс", 6, TK_ABS },
+	[355] = { "выход", 10, TK_BREAK },
+	[356] = { "break", 5, TK_BREAK },
+	[357] = { "UPB", 3, TK_UPB },
+	[362] = { "ЦЕЛ", 6, TK_INT },
+	[364] = { "enum", 4, TK_ENUM },
+	[365] = { "цел", 6, TK_INT },
+	[366] = { "NULL", 4, TK_NULL },
+	[370] = { "continue", 8, TK_CONTINUE },
+	[381] = { "пусто", 10, TK_VOID },
+	[389] = { "ВОЗВРАТ", 14, TK_RETURN },
+	[391] = { "структура", 18, TK_STRUCT },
+	[408] = { "DOUBLE", 6, TK_DOUBLE },
+	[413] = { "ПРОДОЛЖИТЬ", 20, TK_CONTINUE },
+	[415] = { "CHAR", 4, TK_CHAR },
+	[424] = { "типопр", 12, TK_TYPEDEF },
+	[432] = { "АБС", 6, TK_ABS },
+	[434] = { "true", 4, TK_TRUE },
+	[444] = { "ВЕЩ4", 7, TK_FLOAT4 },
+	[445] = { "литера", 12, TK_CHAR },
+	[447] = { "else", 4, TK_ELSE },
+	[454] = { "while", 5, TK_WHILE },
+	[456] = { "НИЧТО", 10, TK_NULL },
+	[461] = { "FOR", 3, TK_FOR },
+	[462] = { "DO", 2, TK_DO },
+	[465] = { "#line", 5, TK_LINE },
+	[467] = { "кол_во", 11, TK_UPB },
+	[468] = { "УМОЛЧАНИЕ", 18, TK_DEFAULT },
+	[469] = { "КОЛ_ВО", 11, TK_UPB },
+	[470] = { "ПУСТО", 10, TK_VOID },
+	[471] = { "ФАЙЛ", 8, TK_FILE },
+	[473] = { "ДЛЯ", 6, TK_FOR },
+	[478] = { "продолжить", 20, TK_CONTINUE },
+	[480] = { "switch", 6, TK_SWITCH },
+	[484] = { "INT4", 4, TK_INT4 },
+	[486] = { "ЦЕЛ4", 7, TK_INT4 },
+	[488] = { "int", 3, TK_INT },
+	[489] = { "ИСТИНА", 12, TK_TRUE },
+	[494] = { "return", 6, TK_RETURN },
+	[495] = { "если", 8, TK_IF },
+	[499] = { "ELSE", 4, TK_ELSE },
+	[500] = { "вещ", 6, TK_FLOAT },
+};
+
+
+/** FNV-1a hash */
+static inline uint32_t kw_hash(const char *const spelling, const size_t size)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= (uint8_t)spelling[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+token_t kw_search(const char *const spelling, const size_t size)
+{
+	if (spelling == NULL || size == 0 || size > MAX_KEYWORD_SIZE)
+	{
+		return TK_IDENTIFIER;
+	}
+
+	const uint32_t hash = kw_hash(spelling, size);
+	const keyword_slot *const slot = &slots[((hash >> 16) ^ displacements[hash % KEYWORDS_BUCKETS]) & (KEYWORDS_SIZE - 1)];
+
+	return slot->size == size && memcmp(slot->spelling, spelling, size) == 0
+		? slot->token
+		: TK_IDENTIFIER;
+}
@@ -0,0 +1,45 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+
+#pragma once
+
+#include <stddef.h>
+#include "token.h"
+
+
+/** Maximum size of keyword spelling in bytes */
+#define MAX_KEYWORD_SIZE 24
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Get keyword by its UTF-8 spelling using perfect hash of fixed keyword set,
+ *	both english and russian spellings in lower and upper case are recognized
+ *
+ *	@param	spelling	Spelling, not necessarily null-terminated
+ *	@param	size		Size of spelling in bytes
+ *
+ *	@return	Keyword token, @c TK_IDENTIFIER if spelling is not keyword
+ */
+token_t kw_search(const char *const spelling, const size_t size);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -15,11 +15,63 @@
  */
 
 #include "lexer.h"
-#include <math.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "keywords.h"
+#include "scheduler.h"
 #include "uniscanner.h"
 
 
+/** Maximum number of significant digits of floating literal, enough for correct rounding */
+#define MAX_NUMBER_DIGITS 768
+/** Maximum number of significant digits that fit into 64-bit mantissa */
+#define MAX_MANTISSA_DIGITS 19
+/** Maximum absolute value of exponent of floating literal */
+#define MAX_EXPONENT 100000
+
+
+/** Decimal significand of floating literal */
+typedef struct decimal
+{
+	uint64_t mantissa;						/**< First significant digits as integer */
+	size_t digits;							/**< Number of stored significant digits */
+	int64_t exponent;						/**< Decimal exponent of stored digits */
+	bool is_truncated;						/**< Set, if non-zero digits were dropped */
+	char text[MAX_NUMBER_DIGITS + 32];		/**< Stored significant digits */
+} decimal;
+
+/** Token lexed speculatively by thread */
+typedef struct lexer_record
+{
+	token tk;								/**< Token, identifiers hold offset of spelling instead of representation */
+	size_t start;							/**< Offset of input where lexing of token has started */
+	bool is_deferred;						/**< Set, if token must be relexed on merge */
+} lexer_record;
+
+struct lexer_chunk
+{
+	lexer lxr;								/**< Speculative lexer of part */
+	size_t end;								/**< Offset of the end of part */
+	lexer_record *records;					/**< Tokens of part, the last one is the first token after part */
+	size_t records_size;					/**< Number of tokens */
+	size_t records_alloc;					/**< Allocated size of tokens */
+};
+
+
+/**
+ *	Get position of input after current character
+ *
+ *	@param	lxr			Lexer
+ *
+ *	@return	Position of input
+ */
+static inline size_t position(const lexer *const lxr)
+{
+	return in_get_position(&lxr->io) - lxr->ring_octets;
+}
+
 /**
  *	Emit an error from lexer
  *
@@ -28,8 +80,15 @@
  */
 static void lexer_error(lexer *const lxr, err_t num, ...)
 {
-	const size_t position = in_get_position(lxr->sx->io);
-	const range_location loc = { position, position + 1 };
+	if (lxr->is_speculative)
+	{
+		// Сообщение выдаётся при повторном разборе лексемы во время слияния
+		lxr->is_deferred = true;
+		return;
+	}
+
+	const size_t loc_begin = position(lxr);
+	const range_location loc = { loc_begin, loc_begin + 1 };
 
 	va_list args;
 	va_start(args, num);
@@ -40,7 +99,30 @@ static void lexer_error(lexer *const lxr, err_t num, ...)
 }
 
 /**
- *	Scan next character from io
+ *	Emit a warning from lexer
+ *
+ *	@param	lxr			Lexer
+ *	@param	loc			Warning location
+ *	@param	num			Warning code
+ */
+static void lexer_warning(lexer *const lxr, const range_location loc, warning_t num, ...)
+{
+	if (lxr->is_speculative)
+	{
+		lxr->is_deferred = true;
+		return;
+	}
+
+	va_list args;
+	va_start(args, num);
+
+	report_warning(&lxr->sx->rprt, lxr->sx->io, loc, num, args);
+
+	va_end(args);
+}
+
+/**
+ *	Scan next character from pushback ring or io
  *
  *	@param	lxr			Lexer
  *
@@ -48,12 +130,57 @@ static void lexer_error(lexer *const lxr, err_t num, ...)
  */
 static inline char32_t scan(lexer *const lxr)
 {
-	lxr->character = uni_scan_char(lxr->sx->io);
+	if (lxr->ring_size == 0)
+	{
+		lxr->character = uni_scan_char(&lxr->io);
+		return lxr->character;
+	}
+
+	lxr->character = lxr->ring[lxr->ring_begin];
+	lxr->ring_begin = (lxr->ring_begin + 1) & (LEXER_RING_SIZE - 1);
+	lxr->ring_size--;
+	lxr->ring_octets -= utf8_size(lxr->character);
 	return lxr->character;
 }
 
 /**
- *	Peek next character from io
+ *	Peek character after current without consuming it
+ *
+ *	@param	lxr			Lexer
+ *	@param	k			Distance from current character, from @c 1 to @c LEXER_RING_SIZE
+ *
+ *	@return	Peeked character
+ */
+static char32_t lookahead_k(lexer *const lxr, const size_t k)
+{
+	assert(k > 0 && k <= LEXER_RING_SIZE);
+
+	universal_io *const io = &lxr->io;
+	if (lxr->ring_size == 0 && in_is_buffer(io))
+	{
+		// Buffer input is peeked in place without moving position
+		const char *symbol = &in_get_buffer(io)[in_get_position(io)];
+		for (size_t i = 1; i < k && *symbol != '\0'; i++)
+		{
+			symbol += utf8_symbol_size(*symbol);
+		}
+
+		return *symbol != '\0' ? utf8_convert(symbol) : (char32_t)EOF;
+	}
+
+	while (lxr->ring_size < k)
+	{
+		const char32_t character = uni_scan_char(io);
+		lxr->ring[(lxr->ring_begin + lxr->ring_size) & (LEXER_RING_SIZE - 1)] = character;
+		lxr->ring_size++;
+		lxr->ring_octets += utf8_size(character);
+	}
+
+	return lxr->ring[(lxr->ring_begin + k - 1) & (LEXER_RING_SIZE - 1)];
+}
+
+/**
+ *	Peek next character after current
  *
  *	@param	lxr			Lexer
  *
@@ -61,10 +188,26 @@ static inline char32_t scan(lexer *const lxr)
  */
 static inline char32_t lookahead(lexer *const lxr)
 {
-	const size_t position = in_get_position(lxr->sx->io);
-	const char32_t result = uni_scan_char(lxr->sx->io);
-	in_set_position(lxr->sx->io, position);
-	return result;
+	return lookahead_k(lxr, 1);
+}
+
+/**
+ *	Return current character to input and drop pushback ring,
+ *	so that io is positioned at the beginning of current character
+ *
+ *	@param	lxr			Lexer
+ */
+static inline void unscan(lexer *const lxr)
+{
+	if (lxr->ring_size == 0)
+	{
+		uni_unscan_char(&lxr->io, lxr->character);
+		return;
+	}
+
+	in_set_position(&lxr->io, position(lxr) - utf8_size(lxr->character));
+	lxr->ring_size = 0;
+	lxr->ring_octets = 0;
 }
 
 /**
@@ -74,6 +217,25 @@ static inline char32_t lookahead(lexer *const lxr)
  */
 static inline void skip_whitespace(lexer *const lxr)
 {
+	universal_io *const io = &lxr->io;
+	if (lxr->ring_size == 0 && in_is_buffer(io)
+		&& (lxr->character == '\n' || lxr->character == '\r' || lxr->character == '\t' || lxr->character == ' '))
+	{
+		// Whitespace of buffer input is skipped on raw octets
+		const char *const buffer = in_get_buffer(io);
+		const size_t size = in_get_size(io);
+		size_t i = in_get_position(io);
+
+		while (i < size && (buffer[i] == '\n' || buffer[i] == '\r' || buffer[i] == '\t' || buffer[i] == ' '))
+		{
+			i++;
+		}
+
+		in_set_position(io, i);
+		scan(lxr);
+		return;
+	}
+
 	while (lxr->character == '\n' || lxr->character == '\r'
 		|| lxr->character == '\t' || lxr->character == ' ')
 	{
@@ -88,6 +250,19 @@ static inline void skip_whitespace(lexer *const lxr)
  */
 static inline void skip_line_comment(lexer *const lxr)
 {
+	universal_io *const io = &lxr->io;
+	if (lxr->ring_size == 0 && in_is_buffer(io) && lxr->character != '\n' && lxr->character != (char32_t)EOF)
+	{
+		// Line markers of preprocessor make most of comments, so they are skipped without decoding
+		const char *const buffer = in_get_buffer(io);
+		const size_t begin = in_get_position(io);
+		const char *const end = memchr(&buffer[begin], '\n', in_get_size(io) - begin);
+
+		in_set_position(io, end != NULL ? (size_t)(end - buffer) : in_get_size(io));
+		scan(lxr);
+		return;
+	}
+
 	while (lxr->character != '\n' && lxr->character != (char32_t)EOF)
 	{
 		scan(lxr);
@@ -115,6 +290,54 @@ static inline void skip_block_comment(lexer *const lxr)
 	scan(lxr);
 }
 
+/**
+ *	Get size of identifier spelling in buffer, but not much more than keyword size
+ *
+ *	@param	spelling	Identifier spelling
+ *
+ *	@return	Size of spelling in bytes
+ */
+static inline size_t spelling_size(const char *const spelling)
+{
+	const unsigned char *const octets = (const unsigned char *)spelling;
+	size_t size = octets[0] == '#' ? 1 : 0;
+
+	while (size <= MAX_KEYWORD_SIZE)
+	{
+		if (octets[size] < 0x80 && (utf8_octet_class[octets[size]] & (UTF8_LETTER | UTF8_DIGIT)) != 0)
+		{
+			size++;
+		}
+		else if ((octets[size] == 0xD0 || octets[size] == 0xD1) && (octets[size + 1] & 0xC0) == 0x80
+			&& utf8_is_letter(utf8_convert(&spelling[size])))
+		{
+			// Only 2-byte cyrillic letters are not ASCII
+			size += 2;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return size;
+}
+
+/**
+ *	Get size of identifier spelling in buffer
+ *
+ *	@param	spelling	Identifier spelling
+ *	@param	size		Size of the rest of buffer
+ *
+ *	@return	Size of spelling in bytes
+ */
+static inline size_t identifier_size(const char *const spelling, const size_t size)
+{
+	// Хвост идентификатора пропускается блоками ASCII и кириллицы
+	const size_t first = utf8_symbol_size(spelling[0]);
+	return first < size ? first + utf8_span(&spelling[first], size - first, UTF8_LETTER | UTF8_DIGIT) : size;
+}
+
 /**
  *	Lex identifier or keyword
  *
@@ -125,12 +348,49 @@ static inline void skip_block_comment(lexer *const lxr)
 static token lex_identifier_or_keyword(lexer *const lxr)
 {
 	assert(utf8_is_letter(lxr->character) || lxr->character == '#');
-	const size_t loc_begin = in_get_position(lxr->sx->io);
+	const size_t loc_begin = position(lxr);
+
+	unscan(lxr);
+
+	universal_io *const io = &lxr->io;
+	if (in_is_buffer(io))
+	{
+		// Keywords are recognized on raw octets without identifier map
+		const size_t begin = in_get_position(io);
+		const char *const spelling = &in_get_buffer(io)[begin];
+		const size_t size = spelling_size(spelling);
+		const token_t keyword = kw_search(spelling, size);
+
+		if (keyword != TK_IDENTIFIER)
+		{
+			in_set_position(io, begin + size);
+			scan(lxr);
 
-	uni_unscan_char(lxr->sx->io, lxr->character);
-	const size_t repr = repr_reserve(lxr->sx, &lxr->character);
+			const size_t loc_end = position(lxr);
+			return token_keyword((range_location){ loc_begin, loc_end }, keyword);
+		}
+
+		const size_t identifier = identifier_size(spelling, in_get_size(io) - begin);
+		in_set_position(io, begin + identifier);
+		scan(lxr);
+
+		const size_t loc_end = position(lxr);
+		if (lxr->is_speculative)
+		{
+			// Представление добавляется в таблицу при слиянии, чтобы номера не зависели от потоков
+			return token_identifier((range_location){ loc_begin, loc_end }, begin);
+		}
+
+		const size_t repr = repr_reserve_by_span(lxr->sx, spelling, identifier);
+		const item_t ref = repr_get_reference(lxr->sx, repr);
+		return ref >= 0
+			? token_identifier((range_location){ loc_begin, loc_end }, repr)
+			: token_keyword((range_location){ loc_begin, loc_end }, (token_t)ref);
+	}
+
+	const size_t repr = repr_reserve(lxr->sx, &lxr->io, &lxr->character);
 
-	const size_t loc_end = in_get_position(lxr->sx->io);
+	const size_t loc_end = position(lxr);
 	const item_t ref = repr_get_reference(lxr->sx, repr);
 
 	if (ref >= 0)
@@ -141,6 +401,76 @@ static token lex_identifier_or_keyword(lexer *const lxr)
 	return token_keyword((range_location){ loc_begin, loc_end }, (token_t)ref);
 }
 
+/**
+ *	Add next decimal digit to significand
+ *
+ *	@param	dec			Decimal significand
+ *	@param	digit		Digit value
+ *	@param	is_fraction	Set, if digit is after decimal point
+ */
+static inline void decimal_add_digit(decimal *const dec, const uint8_t digit, const bool is_fraction)
+{
+	if (dec->digits == 0 && digit == 0)
+	{
+		// Leading zeros only shift exponent
+		dec->exponent -= is_fraction ? 1 : 0;
+		return;
+	}
+
+	if (dec->digits < MAX_NUMBER_DIGITS)
+	{
+		dec->mantissa = dec->digits < MAX_MANTISSA_DIGITS ? dec->mantissa * 10 + digit : dec->mantissa;
+		dec->text[dec->digits++] = (char)('0' + digit);
+		dec->exponent -= is_fraction ? 1 : 0;
+		return;
+	}
+
+	dec->is_truncated = dec->is_truncated || digit != 0;
+	dec->exponent += is_fraction ? 0 : 1;
+}
+
+/**
+ *	Convert decimal significand to correctly rounded double
+ *
+ *	@param	dec			Decimal significand
+ *	@param	power		Explicit decimal exponent
+ *
+ *	@return	Floating value
+ */
+static double decimal_to_double(decimal *const dec, const int64_t power)
+{
+	// Exact powers of ten representable in double
+	static const double powers[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	if (dec->digits == 0)
+	{
+		return 0.0;
+	}
+
+	const int64_t exponent = dec->exponent + power;
+	if (dec->digits <= MAX_MANTISSA_DIGITS && dec->mantissa <= (UINT64_C(1) << 53)
+		&& exponent >= -22 && exponent <= 22)
+	{
+		// Both operands are exact, so single operation is correctly rounded
+		const double value = (double)dec->mantissa;
+		return exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+	}
+
+	size_t size = dec->digits;
+	if (dec->is_truncated)
+	{
+		// Sticky digit keeps rounding direction of dropped tail
+		dec->text[size++] = '1';
+	}
+
+	sprintf(&dec->text[size], "e%" PRId64, exponent);
+	return strtod(dec->text, NULL);
+}
+
 /**
  *	Lex numeric literal
  *
@@ -151,7 +481,7 @@ static token lex_identifier_or_keyword(lexer *const lxr)
 static token lex_numeric_literal(lexer *const lxr)
 {
 	assert(utf8_is_digit(lxr->character) || lxr->character == '.');
-	const size_t loc_begin = in_get_position(lxr->sx->io);
+	const size_t loc_begin = position(lxr);
 
 	// Основание по умолчанию - 10
 	uint8_t base = 10;
@@ -197,6 +527,7 @@ static token lex_numeric_literal(lexer *const lxr)
 	double float_value = 0.0;
 	bool is_in_range = true;
 	bool is_integer = true;
+	decimal dec = { .mantissa = 0, .digits = 0, .exponent = 0, .is_truncated = false };
 
 	while (utf8_is_hexa_digit(lxr->character))
 	{
@@ -217,7 +548,7 @@ static token lex_numeric_literal(lexer *const lxr)
 				scan(lxr);
 			}
 
-			const size_t loc_end = in_get_position(lxr->sx->io);
+			const size_t loc_end = position(lxr);
 			return token_int_literal((range_location){ loc_begin, loc_end }, int_value);
 		}
 
@@ -240,25 +571,23 @@ static token lex_numeric_literal(lexer *const lxr)
 			float_value = float_value * base + digit;
 		}
 
+		if (base == 10)
+		{
+			decimal_add_digit(&dec, digit, false);
+		}
+
 		scan(lxr);
 	}
 
 	// Дробная часть разрешена только для чисел без спецификаторов
 	if (lxr->character == '.' && !was_modifier)
 	{
-		if (is_integer)
-		{
-			float_value = (double)int_value;
-		}
-
 		is_integer = false;
-		double position_mult = 0.1;
 		// Читаем только десятичные цифры
 		// Все остальное относится к следюущим токенам
 		while (utf8_is_digit(scan(lxr)))
 		{
-			float_value += utf8_to_number(lxr->character) * position_mult;
-			position_mult *= 0.1;
+			decimal_add_digit(&dec, utf8_to_number(lxr->character), true);
 		}
 	}
 
@@ -271,11 +600,6 @@ static token lex_numeric_literal(lexer *const lxr)
 
 		if (lxr->character == '-')
 		{
-			if (is_integer)
-			{
-				float_value = (double)int_value;
-			}
-
 			is_integer = false;
 			scan(lxr);
 			sign = -1;
@@ -290,35 +614,43 @@ static token lex_numeric_literal(lexer *const lxr)
 			// Ошибка - после экспоненты должны быть цифры
 			lexer_error(lxr, exponent_has_no_digits);
 			// Пропустим все лишнее
-			while (utf8_is_letter(lxr->character) || utf8_is_digit(lxr->character)
+			while ((utf8_get_class(lxr->character) & (UTF8_LETTER | UTF8_DIGIT)) != 0
 				|| lxr->character == '+' || lxr->character == '-')
 			{
 				scan(lxr);
 			}
 
-			const size_t loc_end = in_get_position(lxr->sx->io);
+			const size_t loc_end = position(lxr);
 			return token_float_literal((range_location){ loc_begin, loc_end }, DBL_MAX);
 		}
 
 		while (utf8_is_digit(lxr->character))
 		{
-			power = power * 10 + utf8_to_number(lxr->character);
+			power = power < MAX_EXPONENT ? power * 10 + utf8_to_number(lxr->character) : power;
 			scan(lxr);
 		}
 
-		if (is_integer)
+		for (int64_t i = 0; is_integer && i < power; i++)
 		{
-			for (int64_t i = 0; i < power; i++)
+			if (int_value >= 0x1000000000000000)
 			{
-				int_value *= 10;
+				// Переполнение хранилища - конвертируем в double
+				is_in_range = false;
+				is_integer = false;
 			}
+
+			int_value *= 10;
 		}
 
-		float_value *= pow(10.0, sign * (double)power);
+		float_value = decimal_to_double(&dec, sign * power);
+	}
+	else if (!is_integer && base == 10)
+	{
+		float_value = decimal_to_double(&dec, 0);
 	}
 
 	// Формируем результат
-	const size_t loc_end = in_get_position(lxr->sx->io);
+	const size_t loc_end = position(lxr);
 	if (is_integer)
 	{
 		return token_int_literal((range_location){ loc_begin, loc_end }, int_value);
@@ -328,7 +660,7 @@ static token lex_numeric_literal(lexer *const lxr)
 		if (!is_in_range)
 		{
 			// Вышли за пределы целого - конвертируем в double
-			warning(lxr->sx->io, too_long_int);
+			lexer_warning(lxr, (range_location){ loc_begin, loc_end }, too_long_int);
 		}
 
 		return token_float_literal((range_location){ loc_begin, loc_end }, float_value);
@@ -377,14 +709,14 @@ static inline char32_t get_next_string_elem(lexer *const lxr)
 static token lex_char_literal(lexer *const lxr)
 {
 	assert(lxr->character == '\'');
-	const size_t loc_begin = in_get_position(lxr->sx->io);
+	const size_t loc_begin = position(lxr);
 
 	if (scan(lxr) == '\'')
 	{
 		lexer_error(lxr, empty_character_literal);
 		scan(lxr);
 
-		const size_t loc_end = in_get_position(lxr->sx->io);
+		const size_t loc_end = position(lxr);
 		return token_char_literal((range_location){ loc_begin, loc_end }, '\0');
 	}
 
@@ -399,7 +731,7 @@ static token lex_char_literal(lexer *const lxr)
 		lexer_error(lxr, missing_terminating_apost_char);
 	}
 
-	const size_t loc_end = in_get_position(lxr->sx->io);
+	const size_t loc_end = position(lxr);
 	return token_char_literal((range_location){ loc_begin, loc_end }, value);
 }
 
@@ -413,7 +745,42 @@ static token lex_char_literal(lexer *const lxr)
 static token lex_string_literal(lexer *const lxr)
 {
 	assert(lxr->character == '"');
-	const size_t loc_begin = in_get_position(lxr->sx->io);
+	const size_t loc_begin = position(lxr);
+	// Строки добавляются в таблицу при слиянии
+	lxr->is_deferred = lxr->is_deferred || lxr->is_speculative;
+
+	universal_io *const io = &lxr->io;
+	if (lxr->ring_size == 0 && in_is_buffer(io))
+	{
+		// Литерал без управляющих последовательностей копируется из буфера без декодирования
+		const char *const buffer = in_get_buffer(io);
+		const size_t size = in_get_size(io);
+		const size_t begin = in_get_position(io);
+		size_t end = begin;
+		while (end < size && buffer[end] != '"' && buffer[end] != '\\' && buffer[end] != '\n' && buffer[end] != '\0')
+		{
+			end++;
+		}
+
+		if (end < size && buffer[end] == '"')
+		{
+			in_set_position(io, end + 1);
+			scan(lxr);
+			skip_whitespace(lxr);
+
+			if (lxr->character != '"')
+			{
+				const size_t index = lxr->is_speculative ? 0 : string_add_by_range(lxr->sx, &buffer[begin], end - begin);
+				return token_string_literal((range_location){ loc_begin, position(lxr) }, index);
+			}
+
+			// Следующие части склеиваемого литерала разбираются посимвольно
+			for (size_t i = begin; i < end; i += utf8_symbol_size(buffer[i]))
+			{
+				vector_add(&lxr->lexstr, utf8_convert(&buffer[i]));
+			}
+		}
+	}
 
 	while (lxr->character == '"')
 	{
@@ -435,52 +802,27 @@ static token lex_string_literal(lexer *const lxr)
 		skip_whitespace(lxr);
 	}
 
-	const size_t loc_end = in_get_position(lxr->sx->io);
-	const size_t index = string_add(lxr->sx, &lxr->lexstr);
+	const size_t loc_end = position(lxr);
+	const size_t index = lxr->is_speculative ? 0 : string_add(lxr->sx, &lxr->lexstr);
 	vector_resize(&lxr->lexstr, 0);
 
 	return token_string_literal((range_location){ loc_begin, loc_end }, index);
 }
 
 
-/*
- *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
- *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
- *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
- *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
- *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+/**
+ *	Lex next token from io
+ *
+ *	@param	lxr			Lexer
+ *
+ *	@return	Lexed token
  */
-
-
-lexer lexer_create(syntax *const sx)
+static token lex_token(lexer *const lxr)
 {
-	lexer lxr;
-
-	lxr.sx = sx;
-	lxr.lexstr = vector_create(MAX_STRING_LENGTH);
-
-	scan(&lxr);
-
-	return lxr;
-}
-
-int lexer_clear(lexer *const lxr)
-{
-	return vector_clear(&lxr->lexstr);
-}
-
-
-token lex(lexer *const lxr)
-{
-	if (lxr == NULL)
-	{
-		return token_eof();
-	}
-
 	while (true)
 	{
 		skip_whitespace(lxr);
-		const size_t loc_begin = in_get_position(lxr->sx->io);
+		const size_t loc_begin = position(lxr);
 		token_t punctuator_kind;
 
 		switch (lxr->character)
@@ -804,17 +1146,451 @@ token lex(lexer *const lxr)
 				break;
 		}
 
-		const size_t loc_end = in_get_position(lxr->sx->io);
+		const size_t loc_end = position(lxr);
 		return token_punctuator((range_location){ loc_begin, loc_end }, punctuator_kind);
 	}
 }
 
+/**
+ *	Append token to the end of token buffer
+ *
+ *	@param	lxr			Lexer
+ *	@param	tk			Token
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int tokens_push(lexer *const lxr, const token tk)
+{
+	if (lxr->tokens_size == lxr->tokens_alloc)
+	{
+		const size_t alloc_new = lxr->tokens_alloc != 0 ? 2 * lxr->tokens_alloc : LEXER_TOKENS_SIZE;
+		token *const tokens_new = malloc(alloc_new * sizeof(token));
+		if (tokens_new == NULL)
+		{
+			return -1;
+		}
+
+		// Unwrap ring into the beginning of new buffer
+		for (size_t i = 0; i < lxr->tokens_size; i++)
+		{
+			tokens_new[i] = lxr->tokens[(lxr->tokens_begin + i) % lxr->tokens_alloc];
+		}
+
+		free(lxr->tokens);
+		lxr->tokens = tokens_new;
+		lxr->tokens_alloc = alloc_new;
+		lxr->tokens_begin = 0;
+	}
+
+	lxr->tokens[(lxr->tokens_begin + lxr->tokens_size) % lxr->tokens_alloc] = tk;
+	lxr->tokens_size++;
+	return 0;
+}
+
+
+/**
+ *	Get offset of input where current character starts
+ *
+ *	@param	lxr			Lexer
+ *
+ *	@return	Offset of current character
+ */
+static inline size_t offset(const lexer *const lxr)
+{
+	return lxr->character != (char32_t)EOF ? position(lxr) - utf8_size(lxr->character) : position(lxr);
+}
+
+/**
+ *	Move lexer to offset of input, dropping pushback ring
+ *
+ *	@param	lxr			Lexer
+ *	@param	start		Offset of input
+ */
+static inline void seek(lexer *const lxr, const size_t start)
+{
+	in_set_position(&lxr->io, start);
+	lxr->ring_size = 0;
+	lxr->ring_octets = 0;
+	scan(lxr);
+}
+
+/**
+ *	Append speculative token to the end of part
+ *
+ *	@param	chk			Part of input
+ *	@param	record		Speculative token
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int chunk_push(lexer_chunk *const chk, const lexer_record record)
+{
+	if (chk->records_size == chk->records_alloc)
+	{
+		const size_t alloc_new = chk->records_alloc != 0 ? 2 * chk->records_alloc : LEXER_CHUNK_SIZE / 16;
+		lexer_record *const records_new = realloc(chk->records, alloc_new * sizeof(lexer_record));
+		if (records_new == NULL)
+		{
+			return -1;
+		}
+
+		chk->records = records_new;
+		chk->records_alloc = alloc_new;
+	}
+
+	chk->records[chk->records_size++] = record;
+	return 0;
+}
+
+/**
+ *	Lex part of input until the first token after its end
+ *
+ *	@param	context		Parts of input
+ *	@param	index		Index of part
+ */
+static void chunk_lex(void *const context, const size_t index)
+{
+	lexer_chunk *const chk = &((lexer_chunk *)context)[index];
+	lexer *const lxr = &chk->lxr;
+
+	while (true)
+	{
+		const size_t start = offset(lxr);
+		lxr->is_deferred = false;
+
+		const token tk = lex_token(lxr);
+		if (chunk_push(chk, (lexer_record){ .tk = tk, .start = start, .is_deferred = lxr->is_deferred }))
+		{
+			// Часть без лексем разбирается заново при слиянии
+			free(chk->records);
+			chk->records = NULL;
+			chk->records_size = 0;
+			return;
+		}
+
+		if (token_is(&tk, TK_EOF) || token_get_location(&tk).begin > chk->end)
+		{
+			return;
+		}
+	}
+}
+
+/**
+ *	Find speculative token of part by its location
+ *
+ *	@param	chk			Part of input
+ *	@param	loc_begin	Beginning of token location
+ *
+ *	@return	Index of token, @c SIZE_MAX if part has no such token
+ */
+static size_t chunk_search(const lexer_chunk *const chk, const size_t loc_begin)
+{
+	size_t left = 0;
+	size_t right = chk->records_size;
+	while (left < right)
+	{
+		const size_t middle = left + (right - left) / 2;
+		if (token_get_location(&chk->records[middle].tk).begin < loc_begin)
+		{
+			left = middle + 1;
+		}
+		else
+		{
+			right = middle;
+		}
+	}
+
+	return left < chk->records_size && token_get_location(&chk->records[left].tk).begin == loc_begin
+		? left
+		: SIZE_MAX;
+}
+
+/**
+ *	Make token of lexer from speculative token
+ *
+ *	@param	lxr			Lexer
+ *	@param	record		Speculative token
+ *
+ *	@return	Token
+ */
+static token record_resolve(lexer *const lxr, const lexer_record *const record)
+{
+	if (record->is_deferred)
+	{
+		seek(lxr, record->start);
+		return lex_token(lxr);
+	}
+
+	if (!token_is(&record->tk, TK_IDENTIFIER))
+	{
+		return record->tk;
+	}
+
+	const size_t begin = token_get_ident_name(&record->tk);
+	const char *const spelling = &in_get_buffer(&lxr->io)[begin];
+	const size_t size = identifier_size(spelling, in_get_size(&lxr->io) - begin);
+
+	const size_t repr = repr_reserve_by_span(lxr->sx, spelling, size);
+	const item_t ref = repr_get_reference(lxr->sx, repr);
+	return ref >= 0
+		? token_identifier(token_get_location(&record->tk), repr)
+		: token_keyword(token_get_location(&record->tk), (token_t)ref);
+}
+
+/**
+ *	Get next token from parts lexed ahead, relexing parts with mispredicted start
+ *
+ *	@param	lxr			Lexer
+ *
+ *	@return	Next token
+ */
+static token chunks_next(lexer *const lxr)
+{
+	lexer_chunk *chk = &lxr->chunks[lxr->chunk];
+	if (lxr->is_resyncing)
+	{
+		const token tk = lex_token(lxr);
+
+		// Разбор по порядку продолжается до лексемы, которая есть в следующей части
+		while (!token_is(&tk, TK_EOF) && token_get_location(&tk).begin > chk->end
+			&& lxr->chunk + 1 < lxr->chunks_num)
+		{
+			chk = &lxr->chunks[++lxr->chunk];
+			const size_t index = token_get_location(&tk).begin > chk->end
+				? SIZE_MAX
+				: chunk_search(chk, token_get_location(&tk).begin);
+
+			if (index != SIZE_MAX)
+			{
+				lxr->chunk_token = index + 1;
+				lxr->is_resyncing = false;
+				break;
+			}
+		}
+
+		return tk;
+	}
+
+	const lexer_record *const record = &chk->records[lxr->chunk_token];
+	if (token_is(&record->tk, TK_EOF))
+	{
+		return token_eof();
+	}
+
+	if (lxr->chunk_token + 1 < chk->records_size)
+	{
+		lxr->chunk_token++;
+		return record_resolve(lxr, record);
+	}
+
+	// Последняя лексема части должна совпасть с одной из лексем следующей части
+	lexer_chunk *const next = &lxr->chunks[lxr->chunk + 1];
+	const size_t index = token_get_location(&record->tk).begin > next->end
+		? SIZE_MAX
+		: chunk_search(next, token_get_location(&record->tk).begin);
+
+	if (index == SIZE_MAX)
+	{
+		// Часть началась внутри комментария или литерала
+		seek(lxr, record->start);
+		lxr->is_resyncing = true;
+		return chunks_next(lxr);
+	}
+
+	// Сообщения перед лексемой выдаются по записи текущей части, которая начата раньше
+	next->records[index] = *record;
+	lxr->chunk++;
+	lxr->chunk_token = index;
+	return chunks_next(lxr);
+}
+
+/**
+ *	Lex next token from io or from parts lexed ahead
+ *
+ *	@param	lxr			Lexer
+ *
+ *	@return	Lexed token
+ */
+static inline token lex_next(lexer *const lxr)
+{
+	return lxr->chunks != NULL ? chunks_next(lxr) : lex_token(lxr);
+}
+
+/**
+ *	Free parts lexed ahead
+ *
+ *	@param	lxr			Lexer
+ */
+static void chunks_clear(lexer *const lxr)
+{
+	for (size_t i = 0; i < lxr->chunks_num; i++)
+	{
+		free(lxr->chunks[i].records);
+	}
+
+	free(lxr->chunks);
+	lxr->chunks = NULL;
+	lxr->chunks_num = 0;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+lexer lexer_create(syntax *const sx, const size_t position)
+{
+	lexer lxr;
+
+	lxr.sx = sx;
+	lxr.io = io_create();
+	source_open(&sx->src, &lxr.io, position);
+
+	lxr.ring_begin = 0;
+	lxr.ring_size = 0;
+	lxr.ring_octets = 0;
+
+	lxr.tokens = NULL;
+	lxr.tokens_begin = 0;
+	lxr.tokens_size = 0;
+	lxr.tokens_alloc = 0;
+
+	lxr.lexstr = vector_create(MAX_STRING_LENGTH);
+
+	lxr.chunks = NULL;
+	lxr.chunks_num = 0;
+	lxr.chunk = 0;
+	lxr.chunk_token = 0;
+	lxr.is_resyncing = false;
+
+	lxr.is_speculative = false;
+	lxr.is_deferred = false;
+
+	scan(&lxr);
+
+	return lxr;
+}
+
+int lexer_clear(lexer *const lxr)
+{
+	free(lxr->tokens);
+	lxr->tokens = NULL;
+	lxr->tokens_size = 0;
+	lxr->tokens_alloc = 0;
+	chunks_clear(lxr);
+
+	in_clear(&lxr->io);
+	return vector_clear(&lxr->lexstr);
+}
+
+
+token lex(lexer *const lxr)
+{
+	if (lxr == NULL)
+	{
+		return token_eof();
+	}
+
+	if (lxr->tokens_size == 0)
+	{
+		return lex_next(lxr);
+	}
+
+	const token tk = lxr->tokens[lxr->tokens_begin];
+	lxr->tokens_begin = (lxr->tokens_begin + 1) % lxr->tokens_alloc;
+	lxr->tokens_size--;
+	return tk;
+}
+
+
+int lex_parallel(lexer *const lxr)
+{
+	if (lxr == NULL || lxr->chunks != NULL || lxr->is_speculative || !in_is_buffer(&lxr->io))
+	{
+		return -1;
+	}
+
+	const char *const buffer = in_get_buffer(&lxr->io);
+	const size_t size = in_get_size(&lxr->io);
+	const size_t begin = offset(lxr);
+	const size_t jobs = scheduler_get_jobs();
+
+	size_t num = (size - begin) / LEXER_CHUNK_SIZE;
+	num = jobs < num ? jobs : num;
+	if (num < 2)
+	{
+		return -1;
+	}
+
+	lexer_chunk *const chunks = malloc(num * sizeof(lexer_chunk));
+	if (chunks == NULL)
+	{
+		return -1;
+	}
+
+	// Части разбиваются по переводам строк, чтобы лексемы не разрывались
+	size_t amount = 0;
+	for (size_t chunk_begin = begin; chunk_begin < size; amount++)
+	{
+		size_t end = amount + 1 < num ? begin + (size - begin) / num * (amount + 1) : size;
+		end = end > chunk_begin ? end : chunk_begin;
+
+		const char *const newline = memchr(&buffer[end], '\n', size - end);
+		end = newline != NULL && amount + 1 < num ? (size_t)(newline - buffer) + 1 : size;
+
+		chunks[amount] = (lexer_chunk){ .lxr = lexer_create(lxr->sx, chunk_begin), .end = end };
+		chunks[amount].lxr.is_speculative = true;
+		chunk_begin = end;
+	}
+
+	scheduler_for(&chunk_lex, chunks, amount);
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		lexer_clear(&chunks[i].lxr);
+	}
+
+	lxr->chunks = chunks;
+	lxr->chunks_num = amount;
+	lxr->chunk = 0;
+	lxr->chunk_token = 0;
+	lxr->is_resyncing = false;
+
+	// Первая часть начата с верной позиции, поэтому без неё вся работа потоков бесполезна
+	if (chunks[0].records_size == 0)
+	{
+		chunks_clear(lxr);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+token peek_ahead(lexer *const lxr, const size_t k)
+{
+	if (lxr == NULL || k == 0)
+	{
+		return token_eof();
+	}
+
+	while (lxr->tokens_size < k)
+	{
+		if (tokens_push(lxr, lex_next(lxr)))
+		{
+			return token_eof();
+		}
+	}
+
+	return lxr->tokens[(lxr->tokens_begin + k - 1) % lxr->tokens_alloc];
+}
+
 token_t peek(lexer *const lxr)
 {
-	const size_t position = in_get_position(lxr->sx->io);
-	const char32_t character = lxr->character;
-	const token peek_token = lex(lxr);
-	lxr->character = character;
-	in_set_position(lxr->sx->io, position);
-	return token_get_kind(&peek_token);
+	const token tk = peek_ahead(lxr, 1);
+	return token_get_kind(&tk);
 }
@@ -28,23 +28,57 @@
 extern "C" {
 #endif
 
+/** Size of lexer pushback ring, power of two */
+#define LEXER_RING_SIZE 4
+
+/** Initial size of lexer token buffer */
+#define LEXER_TOKENS_SIZE 8
+
+/** Minimal size of source text part lexed by separate thread */
+#define LEXER_CHUNK_SIZE (512 * 1024)
+
+/** Part of source text lexed ahead by separate thread */
+typedef struct lexer_chunk lexer_chunk;
+
 /** Lexer structure */
 typedef struct lexer
 {
 	syntax *sx;								/**< Syntax structure */
+	universal_io io;						/**< Reader of source text with own position */
 
 	char32_t character;						/**< Current character */
+
+	char32_t ring[LEXER_RING_SIZE];			/**< Pushback ring of decoded characters after current */
+	size_t ring_begin;						/**< Index of first character in ring */
+	size_t ring_size;						/**< Number of characters in ring */
+	size_t ring_octets;						/**< Number of octets of characters in ring */
+
+	token *tokens;							/**< Ring buffer of tokens lexed ahead */
+	size_t tokens_begin;					/**< Index of next token in ring buffer */
+	size_t tokens_size;						/**< Number of tokens in ring buffer */
+	size_t tokens_alloc;					/**< Allocated size of ring buffer */
+
 	vector lexstr;							/**< Representation of the read string literal */
+
+	lexer_chunk *chunks;					/**< Parts of source text lexed ahead by threads */
+	size_t chunks_num;						/**< Number of parts */
+	size_t chunk;							/**< Index of current part */
+	size_t chunk_token;						/**< Index of next token in current part */
+	bool is_resyncing;						/**< Set, if current part is relexed, as its start was mispredicted */
+
+	bool is_speculative;					/**< Set, if lexer must not change syntax structure */
+	bool is_deferred;						/**< Set, if speculative token must be relexed on merge */
 } lexer;
 
 /**
  *	Create lexer structure
  *
- *	@param	sx		Syntax structure
+ *	@param	sx			Syntax structure
+ *	@param	position	Position in source text to start from
  *
  *	@return	Lexer
  */
-lexer lexer_create(syntax *const sx);
+lexer lexer_create(syntax *const sx, const size_t position);
 
 /**
  *	Lex next token from io
@@ -55,6 +89,32 @@ lexer lexer_create(syntax *const sx);
  */
 token lex(lexer *const lxr);
 
+/**
+ *	Lex large rest of input ahead by several threads, so that following
+ *	calls of @ref lex() merge tokens of parts in order.
+ *
+ *	Input is split at newlines and every part is lexed as if it started
+ *	outside of comments and literals. Identifiers are added to representations table,
+ *	string literals and diagnostics are relexed on merge, so results are the same
+ *	as of sequential lexing. Part whose first token differs from the token where
+ *	the previous part has stopped is relexed sequentially.
+ *
+ *	@param	lxr		Lexer
+ *
+ *	@return	@c 0 on success, @c -1 on failure or on small input
+ */
+int lex_parallel(lexer *const lxr);
+
+/**
+ *	Peek token ahead without consuming it
+ *
+ *	@param	lxr		Lexer
+ *	@param	k		Distance from next token, @c 1 for token returned by next @ref lex()
+ *
+ *	@return	Peeked token
+ */
+token peek_ahead(lexer *const lxr, const size_t k);
+
 /**
  *	Peek next token from io
  *
@@ -15,22 +15,62 @@
  */
 
 #include "llvmgen.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "AST.h"
+#include "commenter.h"
+#include "counters.h"
+#include "effects.h"
 #include "errors.h"
 #include "hash.h"
+#include "numbering.h"
+#include "parser.h"
+#include "partitioner.h"
 #include "uniprinter.h"
+#include "visitor.h"
+
+#ifdef RUC_LLVM_BITCODE
+	#include <llvm-c/BitWriter.h>
+	#include <llvm-c/Core.h>
+	#include <llvm-c/Error.h>
+	#include <llvm-c/IRReader.h>
+	#include <llvm-c/Linker.h>
+	#include <llvm-c/LLJIT.h>
+	#include <llvm-c/Orc.h>
+	#include <llvm-c/Target.h>
+	#include <llvm-c/Transforms/PassBuilder.h>
+
+	#ifndef _WIN32
+		#include "threads.h"
+	#endif
+#endif
 
 
 #define MAX_FUNCTION_ARGS 128
 #define MAX_PRINTF_ARGS 128
-#define MAX_CASES 4096
 #define MAX_NAME 4096
 
 
 static const size_t HASH_TABLE_SIZE = 1024;
+static const size_t CASES_SIZE = 64;
+static const size_t BITCODE_BUFFER_SIZE = 1 << 16;
+static const size_t FUNCTION_BUFFER_SIZE = 1 << 12;
+static const size_t DEBUG_BUFFER_SIZE = 1 << 12;
+static const size_t CONSTANTS_BUFFER_SIZE = 1 << 12;
+static const size_t INITIALIZER_LENGTH = 16;
+static const size_t MIN_BULK_INITIALIZATION = 8;
+static const size_t PROFILE_BUFFER_SIZE = 1 << 12;
+static const size_t CHUNKS_PER_THREAD = 4;
+static const size_t CHANNELS = 16;
+static const size_t CHANNEL_CAPACITY = 64;
+static const char *const DEFAULT_EXECUTION_PROFILE = "execution_profile.txt";
+static const char *const MANIFEST_SUFFIX = ".parts";
 static const size_t IS_STATIC = 0;
+static const size_t TBAA_ROOT = 1;
 static const size_t MAX_DIMENSIONS = SIZE_MAX - 2;		// Из-за OP_SLICE
+static const size_t DYNAMIC_STACK_LIMIT = 1 << 16;		// Больший динамический массив берётся из кучи
+static const size_t ARENA_HEADER_SIZE = 16;
 
 
 typedef enum ANSWER
@@ -43,6 +83,37 @@ typedef enum ANSWER
 	ANULL,								/**< Ответ является null */
 } answer_t;
 
+typedef enum TBAA
+{
+	TBAA_CHARACTER,						/**< Символьный тип, совпадает по памяти с любым другим */
+	TBAA_BOOLEAN,						/**< Логический тип */
+	TBAA_INTEGER,						/**< Целый тип и перечисления */
+	TBAA_FLOATING,						/**< Вещественный тип */
+	TBAA_POINTER,						/**< Любой указатель */
+	TBAA_NONE,							/**< Составной тип без метаданных */
+} tbaa_t;
+
+static const char *const TBAA_NAMES[] = { "omnipotent char", "bool", "int", "double", "any pointer" };
+
+typedef struct target
+{
+	const char *flag;					/**< Флаг выбора платформы */
+	const char *triple;					/**< Целевая тройка LLVM */
+	const char *datalayout;				/**< Разметка данных */
+	size_t pointer_size;				/**< Размер и выравнивание указателя */
+	size_t double_alignment;			/**< Выравнивание double */
+	item_status word;					/**< Машинное слово, тип long и size_t */
+} target;
+
+// Первая платформа используется по умолчанию
+static const target TARGETS[] =
+{
+	{ "--x86_64", "x86_64-pc-linux-gnu", "e-m:e-i64:64-f80:128-n8:16:32:64-S128", 8, 8, item_int64 },
+	{ "--mipsel", "mipsel", "e-m:m-p:32:32-i8:8:32-i16:16:32-i64:64-n32-S64", 4, 8, item_int32 },
+	{ "--aarch64", "aarch64-unknown-linux-gnu", "e-m:e-i8:8:32-i16:16:32-i64:64-i128:128-n32:64-S128", 8, 8, item_int64 },
+	{ "--riscv64", "riscv64-unknown-linux-gnu", "e-m:e-p:64:64-i64:64-i128:128-n64-S128", 8, 8, item_int64 },
+};
+
 typedef enum LOCATION
 {
 	LREG,								/**< Переменная находится в регистре */
@@ -59,6 +130,7 @@ typedef struct information
 	size_t label_num;						/**< Номер метки */
 	item_t init_num;						/**< Счётчик для инициализации */
 	item_t block_num;						/**< Номер блока */
+	item_t hoisted_block;					/**< Номер блока тела цикла, состояние стека которого сохранено до цикла */
 
 	size_t request_reg;						/**< Регистр на запрос */
 	location_t variable_location;			/**< Расположение переменной */
@@ -74,27 +146,92 @@ typedef struct information
 	size_t label_false;						/**< Метка перехода при false */
 	size_t label_break;						/**< Метка перехода для break */
 	size_t label_continue;					/**< Метка перехода для continue */
-	size_t label_ternary_end;				/**< Метка перехода в конец тернарного выражения */
-	size_t label_phi_previous;				/**< Метка перехода последнего использования phi */
-	size_t label_switch;					/**< Метка для switch */
+	size_t label_default;					/**< Метка default текущего switch, @c SIZE_MAX если её нет */
 
 	hash arrays;							/**< Хеш таблица с информацией о массивах:
 												@с key		 - смещение массива
 												@c value[0]	 - флаг статичности
 												@c value[1..MAX] - границы массива */
 
+	universal_io allocas;					/**< Буфер alloca для входного блока функции */
+	const target *target;					/**< Описание целевой платформы */
+	vector names;							/**< Идентификаторы, имена которых печатаются в printid и getid */
+	vector cases;							/**< Пары из выражения case и метки для разбираемых switch */
+	numbering numbers;						/**< Номера значений адресов в текущем операторе */
+	vector addresses;						/**< Регистры с вычисленными адресами общих значений */
+
+	bool is_debug;							/**< Истина, если выводится отладочная информация */
+	const comment_index *index;				/**< Индекс концов строк кода для отладочной информации */
+	const char *debug_path;					/**< Файл программы по умолчанию */
+	universal_io debug;						/**< Буфер отладочных метаданных и метаданных циклов */
+	universal_io constants;					/**< Буфер глобальных констант инициализации массивов */
+	size_t debug_unit;						/**< Номер метаданных DICompileUnit */
+	size_t debug_scope;						/**< Номер метаданных DISubprogram текущей функции */
+	size_t debug_num;						/**< Номер следующих отладочных метаданных */
+	size_t loop_hints;						/**< Номер первых общих метаданных подсказок циклам, @c 0 если их нет */
+
+	bool is_profiling;						/**< Истина, если в код вставляются счётчики исполнения */
+	bool is_fast_math;						/**< Истина, если вещественные операции можно переставлять */
+	bool is_separate;						/**< Истина, если модуль связывается с другими модулями программы */
+	bool is_streaming;						/**< Истина, если описания выводятся сразу после разбора */
+	bool is_folding;						/**< Истина, если одинаковые функции заменяются псевдонимами */
+	bool is_numbering;						/**< Истина, если одинаковые адреса в операторе вычисляются один раз */
+	map bodies;								/**< Нормализованные тела функций и id их первых определений */
+	bool is_reordering;						/**< Истина, если поля структур упорядочиваются по выравниванию */
+	hash fields;							/**< Позиции полей структур в типах LLVM и номера полей на позициях */
+	vector inits;							/**< Глобальные массивы с функциями инициализации при потоковом выводе */
+	size_t types;							/**< Размер таблицы типов с уже описанными структурами */
+	effects eff;							/**< Побочные эффекты функций для их атрибутов */
+	size_t counters;						/**< Количество счётчиков исполнения */
+	size_t function;						/**< id текущей функции для имён счётчиков */
+	universal_io profile;					/**< Буфер тела функции вывода счётчиков */
+
 	bool was_stack_functions;				/**< Истина, если использовались стековые функции */
 	bool was_dynamic;						/**< Истина, если в функции были динамические массивы */
+	bool was_arena;							/**< Истина, если большие динамические массивы брались из кучи */
 	bool was_file;							/**< Истина, если была работа с файлами */
 	bool was_abs;							/**< Истина, если был вызов abs */
 	bool was_fabs;							/**< Истина, если был вызов fabs */
+	bool was_assume;						/**< Истина, если использовался llvm.assume */
+	bool was_memcpy;						/**< Истина, если использовался llvm.memcpy */
+	bool was_memset;						/**< Истина, если использовался llvm.memset */
+	bool was_scanf;							/**< Истина, если использовался scanf */
 	bool was_function[BEGIN_USER_FUNC];		/**< Массив флагов библиотечных функций из builtin_t */
 	bool is_main;							/**< Истина, если обрабатывается main */
 	bool is_call;							/**< Истина, если обрабатывается вызов функции */
+	bool is_builtin;						/**< Истина, если выводится тип встроенной функции со структурами-значениями */
 
 	size_t func_ref;						/**< id функции */
+	item_t return_type;						/**< Тип возвращаемого значения текущей функции */
+	node function_body;						/**< Тело текущей функции */
 } information;
 
+/** Ответ, сохранённый до печати использующей его инструкции */
+typedef struct operand
+{
+	answer_t kind;							/**< Вид ответа */
+	size_t reg;								/**< Регистр с ответом */
+	item_t value;							/**< Константа с ответом */
+	double value_double;					/**< Константа с ответом типа double */
+	bool value_bool;						/**< Константа с ответом типа bool */
+} operand;
+
+/** Свойства тела счётного цикла для подсказок векторизации */
+typedef struct loop_form
+{
+	const syntax *sx;						/**< Структура syntax с таблицами */
+	size_t induction;						/**< id индукционной переменной */
+	hash writes;							/**< Переменные, изменяемые в теле цикла */
+	vector locals;							/**< Переменные, объявленные в теле цикла */
+	vector indexes;							/**< Переменные из индексов массивов */
+	vector stores;							/**< Массивы, элементы которых изменяются в теле цикла */
+	vector shifts;							/**< Массивы, из которых читаются элементы со сдвигом */
+	vector outer;							/**< Внешние переменные, изменяемые в теле цикла */
+	size_t conditions;						/**< Глубина вложенности условных конструкций */
+	bool is_fast_math;						/**< Истина, если вещественные операции можно переставлять */
+	bool is_simple;							/**< Истина, если тело подходит для векторизации */
+} loop_form;
+
 
 static void emit_statement(information *const info, const node *const nd);
 static void emit_compound_statement(information *const info, const node *const nd, const bool is_function_body);
@@ -103,7 +240,26 @@ static void emit_declaration(information *const info, const node *const nd, cons
 static void emit_one_dimension_initialization(information *const info, const node *const nd, const item_t id
 	, const item_t arr_type, const size_t cur_dimension, const item_t prev_slice, const bool is_local);
 static void emit_initialization(information *const info, const node *const nd, const item_t id, const item_t arr_type);
+static bool is_constant_initializer(information *const info, const node *const nd, const size_t index
+	, const size_t dimension, const item_t type);
+
+
+/**
+ *	Emit an error from LLVM generator
+ *
+ *	@param	info		Encoder
+ *	@param	loc			Error location
+ *	@param	num			Error code
+ */
+static void llvm_error(information *const info, const range_location loc, err_t num, ...)
+{
+	va_list args;
+	va_start(args, num);
 
+	report_error(&info->sx->rprt, info->sx->io, loc, num, args);
+
+	va_end(args);
+}
 
 static item_t array_get_type(information *const info, const item_t array_type)
 {
@@ -132,6 +288,29 @@ static size_t array_get_dim(information *const info, const item_t array_type)
 static void func_name_to_io(information *const info, const size_t func_ref)
 {
 	const char *name = ident_get_spelling(info->sx, func_ref);
+	if (func_ref == BI_STRLEN || func_ref == BI_STRSTR)
+	{
+		// Обёртки приводят результат библиотечной функции к int, поэтому имя отличается от библиотечного
+		uni_printf(info->sx->io, "ruc.%s", name);
+		return;
+	}
+
+	switch (func_ref)
+	{
+		case BI_COS:
+		case BI_SIN:
+		case BI_EXP:
+		case BI_LOG:
+		case BI_LOG10:
+		case BI_SQRT:
+			// Встроенные функции LLVM сворачиваются, векторизуются и заменяются командами процессора
+			uni_printf(info->sx->io, "llvm.%s.f64", name);
+			return;
+
+		default:
+			break;
+	}
+
 	if (func_ref < BEGIN_USER_FUNC)
 	{
 		uni_printf(info->sx->io, "%s", name);
@@ -143,6 +322,48 @@ static void func_name_to_io(information *const info, const size_t func_ref)
 	uni_printf(info->sx->io, "%s", modified_name);
 }
 
+/**
+ *	Check if values of type are passed through memory:
+ *	structures are passed by pointer to copy and returned by pointer to result,
+ *	builtin functions are external and take structures by value
+ *
+ *	@param	info	Encoder
+ *	@param	type	Type
+ *
+ *	@return	@c true on passing through memory
+ */
+static inline bool type_is_indirect(information *const info, const item_t type)
+{
+	return !info->is_builtin && type_get_class(info->sx, type) == TYPE_STRUCTURE;
+}
+
+/**
+ *	Check if function has parameters or return value passed through memory
+ *
+ *	@param	info		Encoder
+ *	@param	func_type	Function type
+ *
+ *	@return	@c true on indirect parameters or return value
+ */
+static bool function_is_indirect(information *const info, const item_t func_type)
+{
+	if (type_is_indirect(info, type_function_get_return_type(info->sx, func_type)))
+	{
+		return true;
+	}
+
+	const size_t parameters = type_function_get_parameter_amount(info->sx, func_type);
+	for (size_t i = 0; i < parameters; i++)
+	{
+		if (type_is_indirect(info, type_function_get_parameter_type(info->sx, func_type, i)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 static void type_to_io(information *const info, const item_t type)
 {
 	const type_t type_class = type_get_class(info->sx, type);
@@ -174,12 +395,22 @@ static void type_to_io(information *const info, const item_t type)
 			break;
 
 		case TYPE_STRUCTURE:
+		case TYPE_VECTOR:
 			uni_printf(info->sx->io, "%%struct_opt.%" PRIitem, type);
 			break;
 
 		case TYPE_POINTER:
 		{
-			type_to_io(info, type_pointer_get_element_type(info->sx, type));
+			// В LLVM нет указателей на void, вместо них используются i8*
+			const item_t element_type = type_pointer_get_element_type(info->sx, type);
+			if (type_is_void(element_type))
+			{
+				uni_printf(info->sx->io, "i8");
+			}
+			else
+			{
+				type_to_io(info, element_type);
+			}
 			uni_printf(info->sx->io, "*");
 		}
 		break;
@@ -200,10 +431,19 @@ static void type_to_io(information *const info, const item_t type)
 
 		case TYPE_FUNCTION:
 		{
-			type_to_io(info, type_function_get_return_type(info->sx, type));
+			// Структура возвращается через указатель на результат, передаваемый первым
+			const item_t return_type = type_function_get_return_type(info->sx, type);
+			const bool is_indirect = type_is_indirect(info, return_type);
+			type_to_io(info, is_indirect ? TYPE_VOID : return_type);
 			uni_printf(info->sx->io, " (");
 
 			const size_t parameter_amount = type_function_get_parameter_amount(info->sx, type);
+			if (is_indirect)
+			{
+				type_to_io(info, return_type);
+				uni_printf(info->sx->io, parameter_amount != 0 ? "*, " : "*");
+			}
+
 			for (size_t i = 0; i < parameter_amount; i++)
 			{
 				item_t type_parameter = type_function_get_parameter_type(info->sx, type, i);
@@ -217,7 +457,7 @@ static void type_to_io(information *const info, const item_t type)
 
 				type_to_io(info, type_parameter);
 
-				if (type_is_function(info->sx, type_parameter))
+				if (type_is_function(info->sx, type_parameter) || type_is_indirect(info, type_parameter))
 				{
 					uni_printf(info->sx->io, "*");
 				}
@@ -241,6 +481,188 @@ static void type_to_io(information *const info, const item_t type)
 	}
 }
 
+static size_t type_get_alignment(information *const info, const item_t type)
+{
+	switch (type_get_class(info->sx, type))
+	{
+		case TYPE_BOOLEAN:
+		case TYPE_CHARACTER:
+			return 1;
+
+		case TYPE_INTEGER:
+		case TYPE_ENUM:
+			return 4;
+
+		case TYPE_FLOATING:
+			return info->target->double_alignment;
+
+		case TYPE_STRUCTURE:
+		case TYPE_VECTOR:
+		{
+			size_t alignment = 1;
+			const size_t fields = type_structure_get_member_amount(info->sx, type);
+			for (size_t i = 0; i < fields; i++)
+			{
+				const size_t field = type_get_alignment(info, type_structure_get_member_type(info->sx, type, i));
+				alignment = field > alignment ? field : alignment;
+			}
+
+			return alignment;
+		}
+
+		default:
+			// Массивы, функции и файлы представлены указателями
+			return info->target->pointer_size;
+	}
+}
+
+/**
+ *	Get position of structure member in LLVM type
+ *
+ *	@param	info		Encoder
+ *	@param	type		Structure type
+ *	@param	index		Member index
+ *	@param	is_member	Set, if index is position and number of member on it is requested
+ *
+ *	@return	Position of member or member on position
+ */
+static size_t type_get_field(information *const info, const item_t type, const size_t index, const bool is_member)
+{
+	// Элементы векторов соответствуют дорожкам векторных регистров и не переставляются
+	if (!info->is_reordering || !type_is_structure(info->sx, type) || type_is_vector(info->sx, type))
+	{
+		return index;
+	}
+
+	const size_t fields = type_structure_get_member_amount(info->sx, type);
+	size_t record = hash_get_index(&info->fields, type);
+	if (record == SIZE_MAX)
+	{
+		record = hash_add(&info->fields, type, 2 * fields);
+
+		// Устойчивая сортировка по убыванию выравнивания, так поля одного выравнивания сохраняют порядок,
+		// а мелкие поля собираются в конце без заполнения между ними
+		for (size_t i = 0; i < fields; i++)
+		{
+			const size_t alignment = type_get_alignment(info, type_structure_get_member_type(info->sx, type, i));
+			size_t position = i;
+			while (position > 0)
+			{
+				const size_t previous = (size_t)hash_get_by_index(&info->fields, record, fields + position - 1);
+				if (type_get_alignment(info, type_structure_get_member_type(info->sx, type, previous)) >= alignment)
+				{
+					break;
+				}
+
+				hash_set_by_index(&info->fields, record, fields + position, (item_t)previous);
+				position--;
+			}
+			hash_set_by_index(&info->fields, record, fields + position, (item_t)i);
+		}
+
+		for (size_t i = 0; i < fields; i++)
+		{
+			const size_t member = (size_t)hash_get_by_index(&info->fields, record, fields + i);
+			hash_set_by_index(&info->fields, record, member, (item_t)i);
+		}
+	}
+
+	return (size_t)hash_get_by_index(&info->fields, record, is_member ? fields + index : index);
+}
+
+static tbaa_t type_get_tbaa(information *const info, const item_t type)
+{
+	switch (type_get_class(info->sx, type))
+	{
+		case TYPE_BOOLEAN:
+			return TBAA_BOOLEAN;
+
+		case TYPE_CHARACTER:
+			return TBAA_CHARACTER;
+
+		case TYPE_INTEGER:
+		case TYPE_ENUM:
+			return TBAA_INTEGER;
+
+		case TYPE_FLOATING:
+			return TBAA_FLOATING;
+
+		case TYPE_POINTER:
+		case TYPE_ARRAY:
+			return TBAA_POINTER;
+
+		default:
+			return TBAA_NONE;
+	}
+}
+
+static inline void alignment_to_io(information *const info, const item_t type)
+{
+	uni_printf(info->sx->io, ", align %zu\n", type_get_alignment(info, type));
+}
+
+/**
+ *	Emit pointer to value passed through memory with its attributes
+ *
+ *	@param	info		Encoder
+ *	@param	type		Structure type
+ *	@param	is_result	Set, if pointer is to return value
+ */
+static void indirect_to_io(information *const info, const item_t type, const bool is_result)
+{
+	type_to_io(info, type);
+	uni_printf(info->sx->io, is_result ? "* noalias sret(" : "* byval(");
+	type_to_io(info, type);
+	uni_printf(info->sx->io, ") align %zu", type_get_alignment(info, type));
+}
+
+/**
+ *	Emit parameters of function definition or declaration,
+ *	pointer to returned structure goes first
+ *
+ *	@param	info		Encoder
+ *	@param	func_type	Function type
+ */
+static void parameters_to_io(information *const info, const item_t func_type)
+{
+	const item_t return_type = type_function_get_return_type(info->sx, func_type);
+	const bool is_indirect = type_is_indirect(info, return_type);
+	uni_printf(info->sx->io, "(");
+	if (is_indirect)
+	{
+		indirect_to_io(info, return_type, true);
+	}
+
+	const size_t parameters = type_function_get_parameter_amount(info->sx, func_type);
+	for (size_t i = 0; i < parameters; i++)
+	{
+		uni_printf(info->sx->io, i == 0 && !is_indirect ? "" : ", ");
+
+		const item_t parameter_type = type_function_get_parameter_type(info->sx, func_type, i);
+		if (type_is_indirect(info, parameter_type))
+		{
+			indirect_to_io(info, parameter_type, false);
+		}
+		else
+		{
+			type_to_io(info, parameter_type);
+		}
+	}
+	uni_printf(info->sx->io, ")");
+}
+
+static void access_to_io(information *const info, const item_t type)
+{
+	uni_printf(info->sx->io, ", align %zu", type_get_alignment(info, type));
+
+	const tbaa_t tbaa = type_get_tbaa(info, type);
+	if (tbaa != TBAA_NONE)
+	{
+		uni_printf(info->sx->io, ", !tbaa !%zu", TBAA_ROOT + 1 + TBAA_NONE + tbaa);
+	}
+	uni_printf(info->sx->io, "\n");
+}
+
 static void operation_to_io(information *const info, const binary_t operation_type, const item_t type)
 {
 	switch (operation_type)
@@ -314,7 +736,15 @@ static void operation_to_io(information *const info, const binary_t operation_ty
 			uni_printf(info->sx->io, type_is_integer(info->sx, type) ? "icmp sge" : "fcmp oge");
 			break;
 		default:
-			break;
+			return;
+	}
+
+	// Флаги разрешают переассоциацию вещественных сумм и векторизацию циклов с ними
+	if (info->is_fast_math && type_is_floating(type) && (operation_type == BIN_ADD || operation_type == BIN_SUB
+		|| operation_type == BIN_MUL || operation_type == BIN_DIV || operation_type == BIN_ADD_ASSIGN
+		|| operation_type == BIN_SUB_ASSIGN || operation_type == BIN_MUL_ASSIGN || operation_type == BIN_DIV_ASSIGN))
+	{
+		uni_printf(info->sx->io, " fast");
 	}
 }
 
@@ -405,10 +835,11 @@ static void to_code_load(information *const info, const size_t result, const siz
 	{
 		uni_printf(info->sx->io, "* @");
 		func_name_to_io(info, info->func_ref);
-		uni_printf(info->sx->io, ", align 4\n");
+		alignment_to_io(info, type);
 		return;
 	}
-	uni_printf(info->sx->io, "* %s%s.%zu, align 4\n", is_local ? "%" : "@", is_array ? "" : "var", id);
+	uni_printf(info->sx->io, "* %s%s.%zu", is_local ? "%" : "@", is_array ? "" : "var", id);
+	access_to_io(info, type);
 }
 
 static void to_code_store_reg(information *const info, const size_t reg, const size_t id, const item_t type
@@ -418,7 +849,8 @@ static void to_code_store_reg(information *const info, const size_t reg, const s
 	type_to_io(info, type);
 	uni_printf(info->sx->io, " %s%s.%zu, ", /*ident_is_local(info->sx, reg)*/true ? "%" : "@", is_pointer ? "var" : "", reg);
 	type_to_io(info, type);
-	uni_printf(info->sx->io, "* %s%s.%zu, align 4\n", is_local ? "%" : "@", is_array ? "" : "var", id);
+	uni_printf(info->sx->io, "* %s%s.%zu", is_local ? "%" : "@", is_array ? "" : "var", id);
+	access_to_io(info, type);
 }
 
 static inline void to_code_store_const_integer(information *const info, const item_t arg, const size_t id
@@ -428,21 +860,24 @@ static inline void to_code_store_const_integer(information *const info, const it
 	type_to_io(info, type);
 	uni_printf(info->sx->io, " %" PRIitem ", ", arg);
 	type_to_io(info, type);
-	uni_printf(info->sx->io, "* %s%s.%zu, align 4\n", is_local ? "%" : "@", is_array ? "" : "var", id);
+	uni_printf(info->sx->io, "* %s%s.%zu", is_local ? "%" : "@", is_array ? "" : "var", id);
+	access_to_io(info, type);
 }
 
 static inline void to_code_store_const_bool(information *const info, const bool arg, const size_t id
 	, const bool is_array, const bool is_local)
 {
-	uni_printf(info->sx->io, " store i1 %s, i1* %s%s.%zu, align 4\n"
+	uni_printf(info->sx->io, " store i1 %s, i1* %s%s.%zu"
 		, arg ? "true" : "false", is_local ? "%" : "@", is_array ? "" : "var", id);
+	access_to_io(info, TYPE_BOOLEAN);
 }
 
 static inline void to_code_store_const_double(information *const info, const double arg, const size_t id
 	, const bool is_array, const bool is_local)
 {
-	uni_printf(info->sx->io, " store double %f, double* %s%s.%zu, align 4\n"
+	uni_printf(info->sx->io, " store double %f, double* %s%s.%zu"
 		, arg, is_local ? "%" : "@", is_array ? "" : "var", id);
+	access_to_io(info, TYPE_FLOATING);
 }
 
 static void to_code_store_null(information *const info, const size_t id, const item_t type)
@@ -451,7 +886,8 @@ static void to_code_store_null(information *const info, const size_t id, const i
 	type_to_io(info, type);
 	uni_printf(info->sx->io, " null, ");
 	type_to_io(info, type);
-	uni_printf(info->sx->io, "* %%var.%zu, align 4\n", id);
+	uni_printf(info->sx->io, "* %%var.%zu", id);
+	access_to_io(info, type);
 }
 
 static inline void to_code_label(information *const info, const size_t label_num)
@@ -470,123 +906,361 @@ static inline void to_code_conditional_branch(information *const info)
 		, info->answer_reg, info->label_true, info->label_false);
 }
 
-static void to_code_stack_save(information *const info, const item_t index)
+static inline void to_code_alloca_begin(information *const info)
 {
-	// команды сохранения состояния стека
-	uni_printf(info->sx->io, " %%dyn.%" PRIitem " = alloca i8*, align 4\n", index);
-	uni_printf(info->sx->io, " %%.%zu = call i8* @llvm.stacksave()\n", info->register_num);
-	uni_printf(info->sx->io, " store i8* %%.%zu, i8** %%dyn.%" PRIitem ", align 4\n"
-		, info->register_num, index);
-	info->register_num++;
-
-	info->was_stack_functions = true;
+	// alloca копятся в отдельном буфере и выводятся во входном блоке функции,
+	// иначе mem2reg и SROA не поднимут локальные переменные на регистры
+	out_swap(info->sx->io, &info->allocas);
 }
 
-static void to_code_stack_load(information *const info, const item_t index)
+static inline void to_code_alloca_end(information *const info)
 {
-	// команды восстановления состояния стека
-	uni_printf(info->sx->io, " %%.%zu = load i8*, i8** %%dyn.%" PRIitem ", align 4\n"
-		, info->register_num, index);
-	uni_printf(info->sx->io, " call void @llvm.stackrestore(i8* %%.%zu)\n", info->register_num);
-	info->register_num++;
-
-	info->was_stack_functions = true;
+	out_swap(info->sx->io, &info->allocas);
 }
 
-static void to_code_alloc_array_static(information *const info, const size_t index, const item_t type, const bool is_local)
+static void debug_string_to_io(universal_io *const io, const char *const str)
 {
-	if (is_local)
+	for (size_t i = 0; str[i] != '\0'; i++)
 	{
-		uni_printf(info->sx->io, " %%arr.%" PRIitem " = alloca ", hash_get_key(&info->arrays, index));
+		if (str[i] == '"' || str[i] == '\\')
+		{
+			uni_printf(io, "\\%02X", (unsigned char)str[i]);
+		}
+		else
+		{
+			uni_printf(io, "%c", str[i]);
+		}
 	}
-	else
+}
+
+static void to_code_location(information *const info, const range_location loc)
+{
+	// Позиция оператора объявления не задана, если он ещё не достроен
+	if (!info->is_debug || loc.begin == (size_t)ITEM_MAX)
 	{
-		uni_printf(info->sx->io, "@arr.%" PRIitem " = common global ", hash_get_key(&info->arrays, index));
+		return;
 	}
 
-	const size_t dim = hash_get_amount_by_index(&info->arrays, index) - 1;
-	if (dim == 0 || dim > MAX_DIMENSIONS)
+	// Метка заменяется вложением !dbg у следующих инструкций при выводе функции
+	const comment cmt = cmt_index_search(info->index, loc.begin);
+	const size_t location = info->debug_num++;
+	uni_printf(&info->debug, "!%zu = !DILocation(line: %zu, column: %zu, scope: !%zu)\n"
+		, location, cmt_get_line(&cmt), cmt_get_symbol(&cmt) + 1, info->debug_scope);
+	uni_printf(info->sx->io, " ;dbg %zu\n", location);
+}
+
+/**
+ *	Emit increment of execution counter of current function or its block
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Statement of block, @c NULL for function entry
+ */
+static void to_code_counter(information *const info, const node *const nd)
+{
+	if (!info->is_profiling)
 	{
-		system_error(such_array_is_not_supported);
 		return;
 	}
 
-	for (size_t i = 1; i <= dim; i++)
+	char name[MAX_NAME];
+	const char *const spelling = ident_get_spelling(info->sx, info->function);
+	if (nd == NULL)
 	{
-		uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get_by_index(&info->arrays, index, i));
+		sprintf(name, "%s", spelling);
 	}
-	type_to_io(info, type);
-
-	for (size_t i = 1; i <= dim; i++)
+	else
 	{
-		uni_printf(info->sx->io, "]");
+		const comment cmt = cmt_index_search(info->index, node_get_location(nd).begin);
+		sprintf(name, "%s:%zu", spelling, cmt_get_line(&cmt));
 	}
-	uni_printf(info->sx->io, "%s, align 4\n", is_local ? "" : " zeroinitializer");
+
+	const size_t counter = info->counters++;
+	const size_t length = strlen(name) + 1;
+	uni_printf(&info->constants, "@.prof.%zu = internal global i64 0, align 8\n", counter);
+	uni_printf(&info->constants, "@.prof.name.%zu = private unnamed_addr constant [%zu x i8] c\"%s\\00\", align 1\n"
+		, counter, length, name);
+
+	uni_printf(info->sx->io, " %%.%zu = load i64, i64* @.prof.%zu, align 8\n", info->register_num, counter);
+	uni_printf(info->sx->io, " %%.%zu = add i64 %%.%zu, 1\n", info->register_num + 1, info->register_num);
+	uni_printf(info->sx->io, " store i64 %%.%zu, i64* @.prof.%zu, align 8\n", info->register_num + 1, counter);
+	info->register_num += 2;
+
+	uni_printf(&info->profile, " %%count.%zu = load i64, i64* @.prof.%zu, align 8\n", counter, counter);
+	uni_printf(&info->profile, " call i32 (%%struct._IO_FILE*, i8*, ...) @fprintf(%%struct._IO_FILE* %%file"
+		", i8* getelementptr inbounds ([9 x i8], [9 x i8]* @.prof.format, i32 0, i32 0), i64 %%count.%zu"
+		", i8* getelementptr inbounds ([%zu x i8], [%zu x i8]* @.prof.name.%zu, i32 0, i32 0))\n"
+		, counter, length, length, counter);
 }
 
-static void to_code_alloc_array_dynamic(information *const info, const size_t index, const item_t type)
+static void to_code_subprogram(information *const info, const node *const nd, const size_t func_ref)
 {
-	// выделение памяти на стеке
-	item_t to_alloc = hash_get_by_index(&info->arrays, index, 1);
-
-	const size_t dim = hash_get_amount_by_index(&info->arrays, index) - 1;
-	if (dim == 0 || dim > MAX_DIMENSIONS)
+	const comment cmt = cmt_index_search(info->index, node_get_location(nd).begin);
+	const size_t line = cmt_get_line(&cmt);
+	info->debug_scope = info->debug_num++;
+
+	// Файл функции известен из меток препроцессора, иначе это файл программы
+	size_t file = info->debug_unit + 1;
+	char path[MAX_NAME];
+	if (cmt_get_path(&cmt, path) != 0)
 	{
-		system_error(such_array_is_not_supported);
-		return;
+		file = info->debug_num++;
+		uni_printf(&info->debug, "!%zu = !DIFile(filename: \"", file);
+		debug_string_to_io(&info->debug, path);
+		uni_printf(&info->debug, "\", directory: \"\")\n");
 	}
 
-	for (size_t i = 2; i <= dim; i++)
+	uni_printf(&info->debug, "!%zu = distinct !DISubprogram(name: \"", info->debug_scope);
+	if (func_ref == info->sx->ref_main)
 	{
-		uni_printf(info->sx->io, " %%.%zu = mul nuw i32 %%.%" PRIitem ", %%.%" PRIitem "\n"
-			, info->register_num, to_alloc, hash_get_by_index(&info->arrays, index, i));
-		to_alloc = info->register_num++;
+		uni_printf(&info->debug, "main");
 	}
-	uni_printf(info->sx->io, " %%dynarr.%" PRIitem " = alloca ", hash_get_key(&info->arrays, index));
-	type_to_io(info, type);
-	uni_printf(info->sx->io, ", i32 %%.%" PRIitem ", align 4\n", to_alloc);
+	else
+	{
+		out_swap(info->sx->io, &info->debug);
+		func_name_to_io(info, func_ref);
+		out_swap(info->sx->io, &info->debug);
+	}
+	uni_printf(&info->debug, "\", scope: !%zu, file: !%zu, line: %zu, type: !%zu, scopeLine: %zu"
+		", spFlags: DISPFlagDefinition, unit: !%zu)\n", file, file, line, info->debug_unit + 2, line, info->debug_unit);
 }
 
-static void to_code_slice(information *const info, const item_t id, const size_t cur_dimension
-	, const item_t prev_slice, const item_t type, const bool is_local)
+static void function_to_io(information *const info, const char *const text)
 {
-	uni_printf(info->sx->io, " %%.%zu = getelementptr inbounds ", info->register_num);
-	const size_t dimensions = hash_get_amount(&info->arrays, id) - 1;
-
-	if (dimensions == SIZE_MAX)
+	if (!info->is_debug)
 	{
+		out_write(info->sx->io, text, strlen(text));
 		return;
 	}
 
-	if (hash_get(&info->arrays, id, IS_STATIC))
+	// Инструкции занимают по одной строке, метки блоков заканчиваются двоеточием
+	size_t location = SIZE_MAX;
+	const char *line = text;
+	while (*line != '\0')
 	{
-		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
-		{
-			uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get(&info->arrays, id, i));
-		}
-		type_to_io(info, type);
+		const char *end = strchr(line, '\n');
+		end = end != NULL ? end : line + strlen(line);
+		const size_t size = (size_t)(end - line);
 
-		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		if (strncmp(line, " ;dbg ", 6) == 0)
 		{
-			uni_printf(info->sx->io, "]");
+			location = strtoul(&line[6], NULL, 10);
 		}
-		uni_printf(info->sx->io, ", ");
-
-		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		else if (location == SIZE_MAX || size < 2 || line[0] != ' ' || end[-1] == ':')
 		{
-			uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get(&info->arrays, id, i));
+			out_write(info->sx->io, line, size);
+			uni_printf(info->sx->io, "\n");
 		}
-		type_to_io(info, type);
-
-		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		else
 		{
-			uni_printf(info->sx->io, "]");
+			out_write(info->sx->io, line, size);
+			uni_printf(info->sx->io, ", !dbg !%zu\n", location);
 		}
 
-		if (cur_dimension == dimensions - 1)
-		{
-			uni_printf(info->sx->io, "* %sarr.%" PRIitem ", i32 0", is_local ? "%" : "@", id);
-		}
+		line = *end != '\0' ? end + 1 : end;
+	}
+}
+
+static void to_code_stack_save(information *const info, const item_t index)
+{
+	// команды сохранения состояния стека и вершины кучи динамических массивов
+	to_code_alloca_begin(info);
+	uni_printf(info->sx->io, " %%dyn.%" PRIitem " = alloca i8*, align %zu\n", index, info->target->pointer_size);
+	if (index >= 0)
+	{
+		uni_printf(info->sx->io, " %%dynmark.%" PRIitem " = alloca i8*, align %zu\n", index, info->target->pointer_size);
+	}
+	to_code_alloca_end(info);
+	uni_printf(info->sx->io, " %%.%zu = call i8* @llvm.stacksave()\n", info->register_num);
+	uni_printf(info->sx->io, " store i8* %%.%zu, i8** %%dyn.%" PRIitem ", align %zu\n"
+		, info->register_num, index, info->target->pointer_size);
+	info->register_num++;
+
+	// На уровне функции куча освобождается целиком, поэтому вершина не нужна
+	if (index >= 0)
+	{
+		uni_printf(info->sx->io, " %%.%zu = load i8*, i8** %%arena, align %zu\n"
+			, info->register_num, info->target->pointer_size);
+		uni_printf(info->sx->io, " store i8* %%.%zu, i8** %%dynmark.%" PRIitem ", align %zu\n"
+			, info->register_num, index, info->target->pointer_size);
+		info->register_num++;
+	}
+
+	info->was_stack_functions = true;
+}
+
+static void to_code_stack_load(information *const info, const item_t index)
+{
+	// команды восстановления состояния стека и освобождения массивов из кучи, взятых после сохранения
+	uni_printf(info->sx->io, " %%.%zu = load i8*, i8** %%dyn.%" PRIitem ", align %zu\n"
+		, info->register_num, index, info->target->pointer_size);
+	uni_printf(info->sx->io, " call void @llvm.stackrestore(i8* %%.%zu)\n", info->register_num);
+	info->register_num++;
+
+	if (index >= 0)
+	{
+		uni_printf(info->sx->io, " %%.%zu = load i8*, i8** %%dynmark.%" PRIitem ", align %zu\n"
+			, info->register_num, index, info->target->pointer_size);
+		uni_printf(info->sx->io, " call void @ruc.arena_reset(i8** %%arena, i8* %%.%zu)\n", info->register_num);
+		info->register_num++;
+	}
+	else
+	{
+		uni_printf(info->sx->io, " call void @ruc.arena_reset(i8** %%arena, i8* null)\n");
+	}
+
+	info->was_stack_functions = true;
+}
+
+static void to_code_alloc_array_static(information *const info, const size_t index, const item_t type, const bool is_local)
+{
+	const size_t dim = hash_get_amount_by_index(&info->arrays, index) - 1;
+	if (dim == 0 || dim > MAX_DIMENSIONS)
+	{
+		system_error(such_array_is_not_supported);
+		return;
+	}
+
+	if (is_local)
+	{
+		to_code_alloca_begin(info);
+		uni_printf(info->sx->io, " %%arr.%" PRIitem " = alloca ", hash_get_key(&info->arrays, index));
+	}
+	else
+	{
+		uni_printf(info->sx->io, "@arr.%" PRIitem " = internal global ", hash_get_key(&info->arrays, index));
+	}
+
+	for (size_t i = 1; i <= dim; i++)
+	{
+		uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get_by_index(&info->arrays, index, i));
+	}
+	type_to_io(info, type);
+
+	for (size_t i = 1; i <= dim; i++)
+	{
+		uni_printf(info->sx->io, "]");
+	}
+	uni_printf(info->sx->io, "%s", is_local ? "" : " zeroinitializer");
+	alignment_to_io(info, type);
+
+	if (is_local)
+	{
+		to_code_alloca_end(info);
+	}
+}
+
+static void to_code_alloc_array_dynamic(information *const info, const size_t index, const item_t type)
+{
+	// выделение памяти на стеке, а для больших массивов в куче, чтобы не переполнить стек
+	item_t to_alloc = hash_get_by_index(&info->arrays, index, 1);
+
+	const size_t dim = hash_get_amount_by_index(&info->arrays, index) - 1;
+	if (dim == 0 || dim > MAX_DIMENSIONS)
+	{
+		system_error(such_array_is_not_supported);
+		return;
+	}
+
+	for (size_t i = 2; i <= dim; i++)
+	{
+		uni_printf(info->sx->io, " %%.%zu = mul nuw i32 %%.%" PRIitem ", %%.%" PRIitem "\n"
+			, info->register_num, to_alloc, hash_get_by_index(&info->arrays, index, i));
+		to_alloc = info->register_num++;
+	}
+
+	// Размер элемента вычисляется константным выражением от типа
+	const size_t word = info->target->word == item_int64 ? 64 : 32;
+	const size_t count = info->register_num++;
+	const size_t size = info->register_num++;
+	uni_printf(info->sx->io, " %%.%zu = zext i32 %%.%" PRIitem " to i%zu\n", count, to_alloc, word);
+	uni_printf(info->sx->io, " %%.%zu = mul nuw i%zu %%.%zu, ptrtoint (", size, word, count);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "* getelementptr (");
+	type_to_io(info, type);
+	uni_printf(info->sx->io, ", ");
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "* null, i32 1) to i%zu)\n", word);
+	uni_printf(info->sx->io, " %%.%zu = icmp ule i%zu %%.%zu, %zu\n", info->register_num, word, size, DYNAMIC_STACK_LIMIT);
+
+	const size_t label_stack = info->label_num++;
+	const size_t label_heap = info->label_num++;
+	const size_t label_end = info->label_num++;
+	uni_printf(info->sx->io, " br i1 %%.%zu, label %%label%zu, label %%label%zu\n"
+		, info->register_num++, label_stack, label_heap);
+
+	to_code_label(info, label_stack);
+	const size_t stack = info->register_num++;
+	uni_printf(info->sx->io, " %%.%zu = alloca ", stack);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, ", i32 %%.%" PRIitem, to_alloc);
+	alignment_to_io(info, type);
+	to_code_unconditional_branch(info, label_end);
+
+	to_code_label(info, label_heap);
+	const size_t memory = info->register_num++;
+	const size_t heap = info->register_num++;
+	uni_printf(info->sx->io, " %%.%zu = call i8* @ruc.arena_alloc(i8** %%arena, i%zu %%.%zu)\n", memory, word, size);
+	uni_printf(info->sx->io, " %%.%zu = bitcast i8* %%.%zu to ", heap, memory);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "*\n");
+	to_code_unconditional_branch(info, label_end);
+
+	to_code_label(info, label_end);
+	uni_printf(info->sx->io, " %%dynarr.%" PRIitem " = phi ", hash_get_key(&info->arrays, index));
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "* [ %%.%zu, %%label%zu ], [ %%.%zu, %%label%zu ]\n", stack, label_stack, heap, label_heap);
+	info->was_arena = true;
+}
+
+static void to_code_slice(information *const info, const item_t id, const size_t cur_dimension
+	, const item_t prev_slice, const item_t type, const bool is_local)
+{
+	const size_t dimensions = hash_get_amount(&info->arrays, id) - 1;
+	if (dimensions != SIZE_MAX && hash_get(&info->arrays, id, IS_STATIC) && info->answer_kind == AREG)
+	{
+		// Проверок границ в коде нет, но известный диапазон индекса помогает развёртке и векторизации циклов
+		uni_printf(info->sx->io, " %%.%zu = icmp ult i32 %%.%zu, %" PRIitem "\n"
+			, info->register_num, info->answer_reg, hash_get(&info->arrays, id, dimensions - cur_dimension));
+		uni_printf(info->sx->io, " call void @llvm.assume(i1 %%.%zu)\n", info->register_num);
+		info->register_num++;
+		info->was_assume = true;
+	}
+
+	uni_printf(info->sx->io, " %%.%zu = getelementptr inbounds ", info->register_num);
+	if (dimensions == SIZE_MAX)
+	{
+		return;
+	}
+
+	if (hash_get(&info->arrays, id, IS_STATIC))
+	{
+		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		{
+			uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get(&info->arrays, id, i));
+		}
+		type_to_io(info, type);
+
+		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		{
+			uni_printf(info->sx->io, "]");
+		}
+		uni_printf(info->sx->io, ", ");
+
+		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		{
+			uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get(&info->arrays, id, i));
+		}
+		type_to_io(info, type);
+
+		for (size_t i = dimensions - cur_dimension; i <= dimensions; i++)
+		{
+			uni_printf(info->sx->io, "]");
+		}
+
+		if (cur_dimension == dimensions - 1)
+		{
+			uni_printf(info->sx->io, "* %sarr.%" PRIitem ", i32 0", is_local ? "%" : "@", id);
+		}
 		else
 		{
 			uni_printf(info->sx->io, "* %%.%" PRIitem ", i32 0", prev_slice);
@@ -631,6 +1305,140 @@ static void to_code_char_to_int(information *const info, const size_t reg)
 	info->register_num++;
 }
 
+static void vector_type_to_io(information *const info, const item_t type)
+{
+	uni_printf(info->sx->io, "<%zu x ", type_structure_get_member_amount(info->sx, type));
+	type_to_io(info, type_vector_get_element_type(info->sx, type));
+	uni_printf(info->sx->io, ">");
+}
+
+static size_t to_code_struct_to_vector(information *const info, const size_t reg, const item_t type)
+{
+	// Векторы хранятся в памяти как структуры, а вычисляются в векторных регистрах
+	const size_t amount = type_structure_get_member_amount(info->sx, type);
+	for (size_t i = 0; i < amount; i++)
+	{
+		uni_printf(info->sx->io, " %%.%zu = extractvalue %%struct_opt.%" PRIitem " %%.%zu, %zu\n"
+			, info->register_num, type, reg, i);
+
+		uni_printf(info->sx->io, " %%.%zu = insertelement ", info->register_num + 1);
+		vector_type_to_io(info, type);
+		if (i == 0)
+		{
+			uni_printf(info->sx->io, " undef, ");
+		}
+		else
+		{
+			uni_printf(info->sx->io, " %%.%zu, ", info->register_num - 1);
+		}
+		type_to_io(info, type_vector_get_element_type(info->sx, type));
+		uni_printf(info->sx->io, " %%.%zu, i32 %zu\n", info->register_num, i);
+
+		info->register_num += 2;
+	}
+
+	return info->register_num - 1;
+}
+
+static size_t to_code_vector_to_struct(information *const info, const size_t reg, const item_t type)
+{
+	const size_t amount = type_structure_get_member_amount(info->sx, type);
+	for (size_t i = 0; i < amount; i++)
+	{
+		uni_printf(info->sx->io, " %%.%zu = extractelement ", info->register_num);
+		vector_type_to_io(info, type);
+		uni_printf(info->sx->io, " %%.%zu, i32 %zu\n", reg, i);
+
+		uni_printf(info->sx->io, " %%.%zu = insertvalue %%struct_opt.%" PRIitem, info->register_num + 1, type);
+		if (i == 0)
+		{
+			uni_printf(info->sx->io, " undef, ");
+		}
+		else
+		{
+			uni_printf(info->sx->io, " %%.%zu, ", info->register_num - 1);
+		}
+		type_to_io(info, type_vector_get_element_type(info->sx, type));
+		uni_printf(info->sx->io, " %%.%zu, %zu\n", info->register_num, i);
+
+		info->register_num += 2;
+	}
+
+	return info->register_num - 1;
+}
+
+
+static operand operand_save(const information *const info)
+{
+	const operand op = { info->answer_kind, info->answer_reg, info->answer_const
+		, info->answer_const_double, info->answer_const_bool };
+	return op;
+}
+
+static void operand_to_io(information *const info, const operand *const op, const item_t type)
+{
+	if (op->kind == AREG || op->kind == ALOGIC)
+	{
+		uni_printf(info->sx->io, "%%.%zu", op->reg);
+	}
+	else if (op->kind == ANULL)
+	{
+		uni_printf(info->sx->io, "null");
+	}
+	else if (type_is_floating(type))
+	{
+		uni_printf(info->sx->io, "%f", op->value_double);
+	}
+	else if (type_is_boolean(type))
+	{
+		uni_printf(info->sx->io, op->value_bool ? "true" : "false");
+	}
+	else
+	{
+		uni_printf(info->sx->io, "%" PRIitem, op->value);
+	}
+}
+
+/**
+ *	Convert answer to logical value in register
+ *
+ *	@param	info	Encoder
+ *	@param	type	Type of answer
+ */
+static void to_code_condition(information *const info, const item_t type)
+{
+	// Сравнения и переменные типа bool уже имеют тип i1
+	if (info->answer_kind == ALOGIC || (info->answer_kind == AREG && type_is_boolean(type)))
+	{
+		info->answer_kind = ALOGIC;
+		return;
+	}
+
+	if (info->answer_kind == ACONST)
+	{
+		const operand op = operand_save(info);
+		uni_printf(info->sx->io, " %%.%zu = %s ", info->register_num, type_is_floating(type) ? "fcmp une" : "icmp ne");
+		type_to_io(info, type);
+		uni_printf(info->sx->io, " ");
+		operand_to_io(info, &op, type);
+		uni_printf(info->sx->io, ", %s\n", type_is_floating(type) ? "0.0" : type_is_boolean(type) ? "false" : "0");
+	}
+	else if (type_is_integer(info->sx, type))
+	{
+		to_code_operation_reg_const_integer(info, BIN_NE, info->answer_reg, 0, type);
+	}
+	else if (type_is_floating(type))
+	{
+		to_code_operation_reg_const_double(info, BIN_NE, info->answer_reg, 0);
+	}
+	else if (type_is_pointer(info->sx, type))
+	{
+		to_code_operation_reg_null(info, BIN_NE, info->answer_reg, type);
+	}
+
+	info->answer_kind = ALOGIC;
+	info->answer_reg = info->register_num++;
+}
 
 static void check_type_and_branch(information *const info, const item_t type)
 {
@@ -652,63 +1460,138 @@ static void check_type_and_branch(information *const info, const item_t type)
 			}
 		}
 		break;
+		case ANULL:
+			to_code_unconditional_branch(info, info->label_false);
+			break;
 		case AREG:
-		{
-			if (type_is_integer(info->sx, type))
-			{
-				to_code_operation_reg_const_integer(info, BIN_NE, info->answer_reg, 0, TYPE_INTEGER);
-			}
-			else if (type_is_boolean(type))
-			{
-				to_code_operation_reg_const_bool(info, BIN_NE, info->answer_reg, false, TYPE_BOOLEAN);
-			}
-			else if (type_is_floating(type))
-			{
-				to_code_operation_reg_const_double(info, BIN_NE, info->answer_reg, 0);
-			}
-			else if (type_is_pointer(info->sx, type))
-			{
-				to_code_operation_reg_null(info, BIN_NE, info->answer_reg, type);
-			}
-			info->answer_reg = info->register_num++;
-		}
 		case ALOGIC:
-			if (info->variable_location == LNOLOG)
+			to_code_condition(info, type);
+			to_code_conditional_branch(info);
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ *	Emit expression in condition context.
+ *	Logical operators and comparisons branch to label_true and label_false directly,
+ *	without computing intermediate values.
+ *
+ *	@param	info	Encoder
+ *	@param	nd		Node in AST
+ */
+static void emit_condition(information *const info, const node *const nd)
+{
+	const size_t old_label_true = info->label_true;
+	const size_t old_label_false = info->label_false;
+
+	if (expression_get_class(nd) == EXPR_BINARY)
+	{
+		const binary_t operator = expression_binary_get_operator(nd);
+		if (operator == BIN_LOG_AND || operator == BIN_LOG_OR)
+		{
+			const size_t label_next = info->label_num++;
+			if (operator == BIN_LOG_AND)
 			{
-				to_code_unconditional_branch(info, info->label_false);
+				info->label_true = label_next;
 			}
 			else
 			{
-				to_code_conditional_branch(info);
+				info->label_false = label_next;
 			}
-			break;
-		default:
-			break;
+
+			const node LHS = expression_binary_get_LHS(nd);
+			emit_condition(info, &LHS);
+
+			info->label_true = old_label_true;
+			info->label_false = old_label_false;
+			to_code_label(info, label_next);
+
+			const node RHS = expression_binary_get_RHS(nd);
+			emit_condition(info, &RHS);
+			return;
+		}
+	}
+	else if (expression_get_class(nd) == EXPR_UNARY && expression_unary_get_operator(nd) == UN_LOGNOT)
+	{
+		info->label_true = old_label_false;
+		info->label_false = old_label_true;
+
+		const node operand = expression_unary_get_operand(nd);
+		emit_condition(info, &operand);
+
+		info->label_true = old_label_true;
+		info->label_false = old_label_false;
+		return;
+	}
+
+	info->variable_location = LFREE;
+	emit_expression(info, nd);
+	check_type_and_branch(info, expression_get_type(nd));
+}
+
+
+/**
+ *	Check that global declaration needs initialization in main
+ *
+ *	@param	info		Encoder
+ *	@param	nd			External declaration
+ *
+ *	@return	@c true on array with non-constant initializer, @c false otherwise
+ */
+static bool has_global_initialization(information *const info, const node *const nd)
+{
+	if (declaration_get_class(nd) != DECL_VAR || !declaration_variable_has_initializer(nd))
+	{
+		return false;
 	}
+
+	const size_t id = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(info->sx, id);
+	if (!type_is_array(info->sx, type))
+	{
+		return false;
+	}
+
+	// Константные массивы инициализированы в описании глобала
+	const node initializer = declaration_variable_get_initializer(nd);
+	const size_t index = hash_get_index(&info->arrays, (item_t)id);
+	return !is_constant_initializer(info, &initializer, index, 1, array_get_type(info, type));
 }
 
+/**
+ *	Emit initialization of global array
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Declaration of array
+ */
+static void emit_global_initialization(information *const info, const node *const nd)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(info->sx, id);
+	const node initializer = declaration_variable_get_initializer(nd);
+	emit_one_dimension_initialization(info, &initializer, (item_t)id, type, array_get_dim(info, type) - 1, 0, false);
+}
 
 static void global_initialization(information *const info)
 {
+	// Описания уже освобождены, поэтому вызываются функции, выведенные при их разборе
+	if (info->is_streaming)
+	{
+		uni_printf(info->sx->io, " call void @.init()\n");
+		return;
+	}
+
 	const node root = node_get_root(&info->sx->tree);
 
 	const size_t size = translation_unit_get_size(&root);
 	for (size_t i = 0; i < size; i++)
 	{
 		const node decl = translation_unit_get_declaration(&root, i);
-
-		if (declaration_get_class(&decl) == DECL_VAR)
+		if (has_global_initialization(info, &decl))
 		{
-			const size_t id = declaration_variable_get_id(&decl);
-			const bool has_init = declaration_variable_has_initializer(&decl);
-			const item_t type = ident_get_type(info->sx, id);
-
-			if (type_is_array(info->sx, type) && has_init)
-			{
-				const size_t dimensions = array_get_dim(info, type);
-				const node initializer = declaration_variable_get_initializer(&decl);
-				emit_one_dimension_initialization(info, &initializer, id, type, dimensions - 1, 0, false);
-			}
+			emit_global_initialization(info, &decl);
 		}
 	}
 }
@@ -904,81 +1787,488 @@ static void emit_one_dimension_subscript(information *const info, const node *co
 }
 
 /**
- *	Emit initialization of lvalue
+ *	Emit initialization of lvalue
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_subscript_expression(information *const info, const node *const nd)
+{
+	node base = node_get_type(nd) == OP_SLICE ? expression_subscript_get_base(nd) : node_broken();
+
+	if (expression_get_class(&base) == EXPR_LITERAL) // вырезка из строки
+	{
+		emit_expression(info, &base);
+
+		const char *string = string_get(info->sx, info->answer_string);
+		const size_t length = strings_length(info->sx, info->answer_string);
+
+		const node index = expression_subscript_get_index(nd);
+		emit_expression(info, &index);
+
+		if (info->answer_kind == ACONST)
+		{
+			if (info->answer_const >= 0 && info->answer_const < (item_t)length)
+			{
+				info->answer_const = string[info->answer_const];
+			}
+			else
+			{
+				uni_printf(info->sx->io, " call void @exit(i32 1)");
+				info->answer_const = ITEM_MAX;
+			}
+		}
+
+		return;
+	}
+
+	if (expression_get_class(&base) == EXPR_MEMBER) // массив в структуре
+	{
+		return;
+	}
+
+	size_t subscript_num = 0;
+	while (expression_get_class(&base) == EXPR_SUBSCRIPT)
+	{
+		subscript_num++;
+		base = node_get_type(&base) == OP_SLICE ? expression_subscript_get_base(&base) : node_broken();
+	}
+
+	const size_t id = node_get_type(&base) == OP_IDENTIFIER ? expression_identifier_get_id(&base) : SIZE_MAX;
+	location_t location = info->variable_location;
+	const size_t dimensions = hash_get_amount(&info->arrays, id) - 1;
+
+	const size_t number = numbering_get(&info->numbers, nd);
+	item_t address = vector_get(&info->addresses, number);
+	if (address == ITEM_MAX)
+	{
+		emit_one_dimension_subscript(info, nd, id, dimensions - subscript_num - 1);
+
+		if (dimensions - subscript_num - 1 != 0)
+		{
+			const item_t arr_type = ident_get_type(info->sx, id);
+			const item_t type = array_get_type(info, arr_type);
+			const bool is_local = ident_is_local(info->sx, id);
+			info->answer_kind = ACONST;
+			info->answer_const = 0;
+			to_code_slice(info, id, 0, info->register_num - 1, type, is_local);
+		}
+
+		address = (item_t)info->register_num - 1;
+		vector_set(&info->addresses, number, address);
+	}
+
+	if (dimensions - subscript_num - 1 != 0)
+	{
+		location = LMEM;
+	}
+
+	if (location != LMEM)
+	{
+		const item_t arr_type = ident_get_type(info->sx, id);
+		const item_t type = array_get_type(info, arr_type);
+
+		to_code_load(info, info->register_num, (size_t)address, type, true, true);
+		address = (item_t)info->register_num++;
+	}
+
+	info->answer_reg = (size_t)address;
+	info->answer_kind = AREG;
+}
+
+static inline void to_code_format(information *const info, const char *const name, const size_t size)
+{
+	uni_printf(info->sx->io, "i8* getelementptr inbounds ([%zu x i8], [%zu x i8]* @.fmt.%s, i32 0, i32 0)"
+		, size, size, name);
+}
+
+static void to_code_print_name(information *const info, const size_t id)
+{
+	const size_t length = strlen(ident_get_spelling(info->sx, id)) + 2;
+	uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(i8* getelementptr inbounds "
+		"([%zu x i8], [%zu x i8]* @.name.%zu, i32 0, i32 0))\n", length, length, id);
+
+	const size_t amount = vector_size(&info->names);
+	for (size_t i = 0; i < amount; i++)
+	{
+		if ((size_t)vector_get(&info->names, i) == id)
+		{
+			return;
+		}
+	}
+	vector_add(&info->names, (item_t)id);
+}
+
+/**
+ *	Check that value of type is printed by scalar conversion
+ *
+ *	@param	info		Encoder
+ *	@param	type		Type of value
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static bool is_printed_scalar(information *const info, const item_t type)
+{
+	const type_t type_class = type_get_class(info->sx, type);
+	return type_class == TYPE_INTEGER || type_class == TYPE_ENUM || type_class == TYPE_FLOATING
+		|| type_class == TYPE_BOOLEAN || type_class == TYPE_CHARACTER;
+}
+
+/**
+ *	Check that structure is printed field by field
+ *
+ *	@param	info		Encoder
+ *	@param	type		Structure type
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static bool is_printed_structure(information *const info, const item_t type)
+{
+	const size_t amount = type_structure_get_member_amount(info->sx, type);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const item_t member_type = type_structure_get_member_type(info->sx, type, i);
+		if (!is_printed_scalar(info, member_type)
+			&& !(type_is_structure(info->sx, member_type) && is_printed_structure(info, member_type)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ *	Check that array is printed element by element
+ *
+ *	@param	info		Encoder
+ *	@param	id			Array identifier
+ *	@param	type		Element type
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static bool is_printed_array(information *const info, const size_t id, const item_t type)
+{
+	if (!is_printed_scalar(info, type) || hash_get_amount(&info->arrays, id) != 2)
+	{
+		return false;
+	}
+
+	// Границы массивов-параметров не передаются, поэтому они неизвестны
+	const item_t bound = hash_get(&info->arrays, id, 1);
+	return hash_get(&info->arrays, id, IS_STATIC) ? bound != ITEM_MAX : bound != 0;
+}
+
+/**
+ *	Print scalar value, which has been already emitted, by its type
+ *
+ *	@param	info		Encoder
+ *	@param	type		Type of value
+ */
+static void to_code_print_scalar(information *const info, const item_t type)
+{
+	const type_t type_class = type_get_class(info->sx, type);
+	if ((info->answer_kind == AREG || info->answer_kind == ALOGIC)
+		&& (type_class == TYPE_BOOLEAN || type_class == TYPE_CHARACTER))
+	{
+		// Аргументы вариативной функции расширяются до int
+		uni_printf(info->sx->io, " %%.%zu = zext %s %%.%zu to i32\n"
+			, info->register_num, type_class == TYPE_BOOLEAN ? "i1" : "i8", info->answer_reg);
+		info->answer_reg = info->register_num++;
+	}
+
+	uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+	to_code_format(info, type_class == TYPE_FLOATING ? "f" : type_class == TYPE_CHARACTER ? "c" : "i", 3);
+
+	if (info->answer_kind == AREG || info->answer_kind == ALOGIC)
+	{
+		uni_printf(info->sx->io, ", %s %%.%zu)\n", type_class == TYPE_FLOATING ? "double" : "i32", info->answer_reg);
+	}
+	else if (type_class == TYPE_FLOATING)
+	{
+		uni_printf(info->sx->io, ", double %f)\n", info->answer_const_double);
+	}
+	else if (type_class == TYPE_BOOLEAN)
+	{
+		uni_printf(info->sx->io, ", i32 %i)\n", info->answer_const_bool ? 1 : 0);
+	}
+	else
+	{
+		uni_printf(info->sx->io, ", i32 %" PRIitem ")\n", info->answer_const);
+	}
+}
+
+/**
+ *	Print structure in register as in virtual machine: fields in braces separated by commas
+ *
+ *	@param	info		Encoder
+ *	@param	type		Structure type
+ *	@param	reg			Register with structure
+ */
+static void to_code_print_structure(information *const info, const item_t type, const size_t reg)
+{
+	uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+	to_code_format(info, "lb", 2);
+	uni_printf(info->sx->io, ")\n");
+
+	const size_t amount = type_structure_get_member_amount(info->sx, type);
+	for (size_t i = 0; i < amount; i++)
+	{
+		if (i != 0)
+		{
+			uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+			to_code_format(info, "cm", 3);
+			uni_printf(info->sx->io, ")\n");
+		}
+
+		const item_t member_type = type_structure_get_member_type(info->sx, type, i);
+		const size_t member = info->register_num++;
+		uni_printf(info->sx->io, " %%.%zu = extractvalue %%struct_opt.%" PRIitem " %%.%zu, %zu\n"
+			, member, type, reg, type_get_field(info, type, i, false));
+
+		if (type_is_structure(info->sx, member_type))
+		{
+			to_code_print_structure(info, member_type, member);
+		}
+		else
+		{
+			info->answer_kind = AREG;
+			info->answer_reg = member;
+			to_code_print_scalar(info, member_type);
+		}
+	}
+
+	uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+	to_code_format(info, "rb", 2);
+	uni_printf(info->sx->io, ")\n");
+}
+
+/**
+ *	Print one-dimensional array as in virtual machine: elements followed by spaces
+ *
+ *	@param	info		Encoder
+ *	@param	id			Array identifier
+ *	@param	type		Element type
+ *	@param	reg			Register with address of the first element
+ */
+static void to_code_print_array(information *const info, const size_t id, const item_t type, const size_t reg)
+{
+	const size_t label_condition = info->label_num++;
+	const size_t label_body = info->label_num++;
+	const size_t label_end = info->label_num++;
+
+	// Счётчик именованный, так как alloca выводятся во входном блоке вне нумерации регистров
+	to_code_alloca_begin(info);
+	uni_printf(info->sx->io, " %%print.%zu = alloca i32\n", label_condition);
+	to_code_alloca_end(info);
+
+	uni_printf(info->sx->io, " store i32 0, i32* %%print.%zu\n", label_condition);
+	to_code_unconditional_branch(info, label_condition);
+	to_code_label(info, label_condition);
+
+	const size_t index = info->register_num++;
+	uni_printf(info->sx->io, " %%.%zu = load i32, i32* %%print.%zu\n", index, label_condition);
+	if (hash_get(&info->arrays, id, IS_STATIC))
+	{
+		uni_printf(info->sx->io, " %%.%zu = icmp slt i32 %%.%zu, %" PRIitem "\n"
+			, info->register_num, index, hash_get(&info->arrays, id, 1));
+	}
+	else
+	{
+		uni_printf(info->sx->io, " %%.%zu = icmp slt i32 %%.%zu, %%.%" PRIitem "\n"
+			, info->register_num, index, hash_get(&info->arrays, id, 1));
+	}
+	uni_printf(info->sx->io, " br i1 %%.%zu, label %%label%zu, label %%label%zu\n"
+		, info->register_num++, label_body, label_end);
+
+	to_code_label(info, label_body);
+	uni_printf(info->sx->io, " %%.%zu = getelementptr inbounds ", info->register_num);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, ", ");
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "* %%.%zu, i32 %%.%zu\n", reg, index);
+	info->register_num++;
+
+	uni_printf(info->sx->io, " %%.%zu = load ", info->register_num);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, ", ");
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "* %%.%zu\n", info->register_num - 1);
+	info->answer_kind = AREG;
+	info->answer_reg = info->register_num++;
+	to_code_print_scalar(info, type);
+
+	uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+	to_code_format(info, "sp", 2);
+	uni_printf(info->sx->io, ")\n");
+
+	uni_printf(info->sx->io, " %%.%zu = add nsw i32 %%.%zu, 1\n", info->register_num, index);
+	uni_printf(info->sx->io, " store i32 %%.%zu, i32* %%print.%zu\n", info->register_num++, label_condition);
+	to_code_unconditional_branch(info, label_condition);
+	to_code_label(info, label_end);
+}
+
+/**
+ *	Print value of expression, which has been already emitted, by its type
  *
  *	@param	info		Encoder
- *	@param	nd			Node in AST
+ *	@param	nd			Printed expression
  */
-static void emit_subscript_expression(information *const info, const node *const nd)
+static void to_code_print_value(information *const info, const node *const nd)
 {
-	node base = node_get_type(nd) == OP_SLICE ? expression_subscript_get_base(nd) : node_broken();
-
-	if (expression_get_class(&base) == EXPR_LITERAL) // вырезка из строки
+	const item_t type = expression_get_type(nd);
+	if (info->answer_kind == ASTR)
 	{
-		emit_expression(info, &base);
-
-		const char *string = string_get(info->sx, info->answer_string);
-		const size_t length = strings_length(info->sx, info->answer_string);
-
-		const node index = expression_subscript_get_index(nd);
-		emit_expression(info, &index);
+		const size_t length = strings_length(info->sx, info->answer_string) + 1;
+		uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+		to_code_format(info, "s", 3);
+		uni_printf(info->sx->io, ", i8* getelementptr inbounds ([%zu x i8], [%zu x i8]* @.str%zu, i32 0, i32 0))\n"
+			, length, length, info->answer_string);
+		return;
+	}
 
-		if (info->answer_kind == ACONST)
+	if (type_is_array(info->sx, type) && info->answer_kind == AREG)
+	{
+		const item_t element_type = type_array_get_element_type(info->sx, type);
+		if (type_get_class(info->sx, element_type) == TYPE_CHARACTER)
 		{
-			if (info->answer_const >= 0 && info->answer_const < (item_t)length)
-			{
-				info->answer_const = string[info->answer_const];
-			}
-			else
-			{
-				uni_printf(info->sx->io, " call void @exit(i32 1)");
-				info->answer_const = ITEM_MAX;
-			}
+			uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+			to_code_format(info, "s", 3);
+			uni_printf(info->sx->io, ", i8* %%.%zu)\n", info->answer_reg);
+		}
+		else if (expression_get_class(nd) == EXPR_IDENTIFIER
+			&& is_printed_array(info, expression_identifier_get_id(nd), element_type))
+		{
+			to_code_print_array(info, expression_identifier_get_id(nd), element_type, info->answer_reg);
+		}
+		else
+		{
+			// Печатаются только одномерные массивы значений с известной границей, выбираемые по имени
+			llvm_error(info, node_get_location(nd), llvm_construction_not_supported);
 		}
-
 		return;
 	}
 
-	if (expression_get_class(&base) == EXPR_MEMBER) // массив в структуре
+	if (type_is_structure(info->sx, type) && info->answer_kind == AREG && is_printed_structure(info, type))
 	{
+		to_code_print_structure(info, type, info->answer_reg);
 		return;
 	}
 
-	size_t subscript_num = 0;
-	while (expression_get_class(&base) == EXPR_SUBSCRIPT)
+	if (!is_printed_scalar(info, type))
 	{
-		subscript_num++;
-		base = node_get_type(&base) == OP_SLICE ? expression_subscript_get_base(&base) : node_broken();
+		llvm_error(info, node_get_location(nd), llvm_construction_not_supported);
+		return;
 	}
 
-	const size_t id = node_get_type(&base) == OP_IDENTIFIER ? expression_identifier_get_id(&base) : SIZE_MAX;
-	location_t location = info->variable_location;
-	const size_t dimensions = hash_get_amount(&info->arrays, id) - 1;
+	to_code_print_scalar(info, type);
+}
+
+static void to_code_msg_receive(information *const info, const item_t type)
+{
+	// Структуры возвращаются по-разному в LLVM и в ABI языка C, поэтому сообщение упаковано в i64:
+	// номер нити в младших 32 битах, данные в старших
+	const size_t message = info->register_num++;
+	uni_printf(info->sx->io, " %%.%zu = call i64 @t_msg_receive()\n", message);
+	uni_printf(info->sx->io, " %%.%zu = trunc i64 %%.%zu to i32\n", info->register_num++, message);
+	uni_printf(info->sx->io, " %%.%zu = lshr i64 %%.%zu, 32\n", info->register_num++, message);
+	uni_printf(info->sx->io, " %%.%zu = trunc i64 %%.%zu to i32\n", info->register_num, info->register_num - 1);
+	info->register_num++;
 
-	emit_one_dimension_subscript(info, nd, id, dimensions - subscript_num - 1);
+	uni_printf(info->sx->io, " %%.%zu = insertvalue ", info->register_num);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, " undef, i32 %%.%zu, 0\n", message + 1);
+	info->register_num++;
 
-	if (dimensions - subscript_num - 1 != 0)
+	uni_printf(info->sx->io, " %%.%zu = insertvalue ", info->register_num);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, " %%.%zu, i32 %%.%zu, 1\n", info->register_num - 1, message + 3);
+
+	info->answer_kind = AREG;
+	info->answer_reg = info->register_num++;
+	info->was_function[BI_MSG_RECEIVE] = true;
+}
+
+/**
+ *	Emit print expression
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_print_expression(information *const info, const node *const nd)
+{
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < argc; i++)
 	{
-		const item_t arr_type = ident_get_type(info->sx, id);
-		const item_t type = array_get_type(info, arr_type);
-		const bool is_local = ident_is_local(info->sx, id);
-		info->answer_kind = ACONST;
-		info->answer_const = 0;
-		to_code_slice(info, id, 0, info->register_num - 1, type, is_local);
-		location = LMEM;
+		info->variable_location = LFREE;
+		const node argument = expression_call_get_argument(nd, i);
+		emit_expression(info, &argument);
+		to_code_print_value(info, &argument);
 	}
+}
 
-	if (location != LMEM)
+/**
+ *	Emit printid expression
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_printid_expression(information *const info, const node *const nd)
+{
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < argc; i++)
 	{
-		const item_t arr_type = ident_get_type(info->sx, id);
-		const item_t type = array_get_type(info, arr_type);
+		const node argument = expression_call_get_argument(nd, i);
+		to_code_print_name(info, expression_identifier_get_id(&argument));
 
-		to_code_load(info, info->register_num, info->register_num - 1, type, true, true);
-		info->register_num++;
+		info->variable_location = LFREE;
+		emit_expression(info, &argument);
+		to_code_print_value(info, &argument);
+
+		uni_printf(info->sx->io, " call i32 (i8*, ...) @printf(");
+		to_code_format(info, "nl", 2);
+		uni_printf(info->sx->io, ")\n");
 	}
+}
 
-	info->answer_reg = info->register_num - 1;
-	info->answer_kind = AREG;
+/**
+ *	Emit getid expression
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_getid_expression(information *const info, const node *const nd)
+{
+	const size_t argc = expression_call_get_arguments_amount(nd);
+	for (size_t i = 0; i < argc; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		const size_t id = expression_identifier_get_id(&argument);
+		const item_t type = ident_get_type(info->sx, id);
+		const type_t type_class = type_get_class(info->sx, type);
+
+		if (type_class != TYPE_INTEGER && type_class != TYPE_ENUM
+			&& type_class != TYPE_FLOATING && type_class != TYPE_CHARACTER)
+		{
+			llvm_error(info, node_get_location(&argument), llvm_construction_not_supported);
+			continue;
+		}
+
+		to_code_print_name(info, id);
+		uni_printf(info->sx->io, " call i32 (i8*, ...) @scanf(");
+		if (type_class == TYPE_FLOATING || type_class == TYPE_CHARACTER)
+		{
+			to_code_format(info, type_class == TYPE_FLOATING ? "lf" : "sc", 4);
+		}
+		else
+		{
+			to_code_format(info, "i", 3);
+		}
+		uni_printf(info->sx->io, ", ");
+		type_to_io(info, type);
+		uni_printf(info->sx->io, "* %svar.%zu)\n", ident_is_local(info->sx, id) ? "%" : "@", id);
+		info->was_scanf = true;
+	}
 }
 
 /**
@@ -1007,11 +2297,42 @@ static void emit_call_expression(information *const info, const node *const nd)
 
 	// FIXME: а если это не функция, а указатель на функцию?
 	const size_t func_ref = expression_identifier_get_id(&callee);
+	switch (func_ref)
+	{
+		case BI_PRINT:
+			emit_print_expression(info, nd);
+			return;
+		case BI_PRINTID:
+			emit_printid_expression(info, nd);
+			return;
+		case BI_GETID:
+			emit_getid_expression(info, nd);
+			return;
+		case BI_MSG_RECEIVE:
+			to_code_msg_receive(info, func_type);
+			return;
+	}
+
+	// Длина строкового литерала известна при компиляции
+	if (func_ref == BI_STRLEN)
+	{
+		const node argument = expression_call_get_argument(nd, 0);
+		if (expression_get_class(&argument) == EXPR_LITERAL)
+		{
+			info->answer_kind = ACONST;
+			info->answer_const = (item_t)strings_length(info->sx, expression_literal_get_string(&argument));
+			return;
+		}
+	}
+
 	if (func_ref < BEGIN_USER_FUNC)
 	{
 		info->was_function[func_ref] = true;
 	}
 
+	// Встроенные функции внешние, их структуры передаются значениями
+	const bool is_user = func_ref >= BEGIN_USER_FUNC;
+
 	size_t func_reg = 0;
 	if (!ident_is_local(info->sx, func_ref))
 	{
@@ -1024,6 +2345,15 @@ static void emit_call_expression(information *const info, const node *const nd)
 		info->variable_location = LFREE;
 		const node argument = expression_call_get_argument(nd, i);
 		arguments_value_type[i] = expression_get_type(&argument);
+		const bool is_indirect = is_user && type_is_indirect(info, arguments_value_type[i]);
+		if (is_indirect && expression_get_class(&argument) == EXPR_IDENTIFIER)
+		{
+			// Структура-переменная передаётся своим адресом без загрузки значения
+			arguments_type[i] = AMEM;
+			arguments[i] = (item_t)expression_identifier_get_id(&argument);
+			continue;
+		}
+
 		if (!type_is_function(info->sx, arguments_value_type[i]))
 		{
 			emit_expression(info, &argument);
@@ -1031,7 +2361,29 @@ static void emit_call_expression(information *const info, const node *const nd)
 		// TODO: сделать параметры других типов (логическое)
 		arguments_type[i] = info->answer_kind;
 
-		if (info->answer_kind == AREG || info->answer_kind == ALOGIC)
+		if (is_indirect)
+		{
+			// Значение структуры сохраняется во временную память, адрес которой передаётся
+			const size_t memory = info->register_num++;
+			to_code_alloca_begin(info);
+			uni_printf(info->sx->io, " %%.%zu = alloca ", memory);
+			type_to_io(info, arguments_value_type[i]);
+			alignment_to_io(info, arguments_value_type[i]);
+			to_code_alloca_end(info);
+
+			uni_printf(info->sx->io, " store ");
+			type_to_io(info, arguments_value_type[i]);
+			uni_printf(info->sx->io, " %%.%zu, ", info->answer_reg);
+			type_to_io(info, arguments_value_type[i]);
+			uni_printf(info->sx->io, "* %%.%zu", memory);
+			alignment_to_io(info, arguments_value_type[i]);
+
+			arguments_type[i] = AREG;
+			arguments[i] = (item_t)memory;
+			continue;
+		}
+
+		if (info->answer_kind == AREG || info->answer_kind == ALOGIC || info->answer_kind == AMEM)
 		{
 			arguments[i] = info->answer_reg;
 		}
@@ -1053,7 +2405,19 @@ static void emit_call_expression(information *const info, const node *const nd)
 		}
 	}
 
-	if (!type_is_void(func_type))
+	// Структура возвращается через временную память, адрес которой передаётся первым
+	const bool is_indirect = is_user && type_is_indirect(info, func_type);
+	size_t result = 0;
+	if (is_indirect)
+	{
+		result = info->register_num++;
+		to_code_alloca_begin(info);
+		uni_printf(info->sx->io, " %%.%zu = alloca ", result);
+		type_to_io(info, func_type);
+		alignment_to_io(info, func_type);
+		to_code_alloca_end(info);
+	}
+	else if (!type_is_void(func_type))
 	{
 		uni_printf(info->sx->io, " %%.%zu =", info->register_num);
 		info->answer_kind = AREG;
@@ -1069,7 +2433,9 @@ static void emit_call_expression(information *const info, const node *const nd)
 	else
 	{
 		info->is_call = true;
+		info->is_builtin = !is_user;
 		type_to_io(info, expression_get_type(&callee));
+		info->is_builtin = false;
 		info->is_call = false;
 		if (ident_is_local(info->sx, func_ref))
 		{
@@ -1083,13 +2449,28 @@ static void emit_call_expression(information *const info, const node *const nd)
 		uni_printf(info->sx->io, "(");
 	}
 
+	if (is_indirect)
+	{
+		indirect_to_io(info, func_type, true);
+		uni_printf(info->sx->io, " %%.%zu", result);
+	}
+
 	for (size_t i = 0; i < args; i++)
 	{
-		if (i != 0)
+		if (i != 0 || is_indirect)
 		{
 			uni_printf(info->sx->io, ", ");
 		}
 
+		if (is_user && type_is_indirect(info, arguments_value_type[i]))
+		{
+			const size_t argument = (size_t)arguments[i];
+			indirect_to_io(info, arguments_value_type[i], false);
+			uni_printf(info->sx->io, " %s.%zu", arguments_type[i] == AREG ? "%"
+				: ident_is_local(info->sx, argument) ? "%var" : "@var", argument);
+			continue;
+		}
+
 		if (arguments_type[i] == ASTR)
 		{
 			const size_t index = (size_t)arguments[i];
@@ -1136,6 +2517,16 @@ static void emit_call_expression(information *const info, const node *const nd)
 		{
 			uni_printf(info->sx->io, " %%.%" PRIitem, arguments[i]);
 		}
+		else if (arguments_type[i] == AMEM)
+		{
+			// Адрес переменной передаётся без загрузки её значения, адрес элемента уже лежит в регистре
+			const node argument = expression_call_get_argument(nd, i);
+			const node operand = expression_unary_get_operand(&argument);
+			const bool is_variable = expression_get_class(&operand) == EXPR_IDENTIFIER;
+			uni_printf(info->sx->io, " %s%s.%" PRIitem
+				, is_variable && !ident_is_local(info->sx, (size_t)arguments[i]) ? "@" : "%"
+				, is_variable ? "var" : "", arguments[i]);
+		}
 		else if (arguments_type[i] == ASTR)
 		{
 			const size_t index = (size_t)arguments[i];
@@ -1162,6 +2553,18 @@ static void emit_call_expression(information *const info, const node *const nd)
 	}
 	uni_printf(info->sx->io, ")\n");
 
+	if (is_indirect)
+	{
+		uni_printf(info->sx->io, " %%.%zu = load ", info->register_num);
+		type_to_io(info, func_type);
+		uni_printf(info->sx->io, ", ");
+		type_to_io(info, func_type);
+		uni_printf(info->sx->io, "* %%.%zu", result);
+		alignment_to_io(info, func_type);
+		info->answer_kind = AREG;
+		info->answer_reg = info->register_num++;
+	}
+
 	if (func_ref == BI_ROUND)
 	{
 		uni_printf(info->sx->io, " %%.%zu = fptosi double %%.%zu to i32\n", info->register_num, info->answer_reg);
@@ -1169,6 +2572,24 @@ static void emit_call_expression(information *const info, const node *const nd)
 	}
 }
 
+/**
+ *	Emit load of member by its address, if value is requested
+ *
+ *	@param	info	Encoder
+ *	@param	address	Register with member address
+ *	@param	type	Member type
+ */
+static void emit_member_load(information *const info, const item_t address, const item_t type)
+{
+	info->answer_reg = (size_t)address;
+	if (info->variable_location != LMEM)
+	{
+		to_code_load(info, info->register_num, (size_t)address, type, true, true);
+		info->answer_kind = AREG;
+		info->answer_reg = info->register_num++;
+	}
+}
+
 /**
  *	Emit member expression
  *
@@ -1185,6 +2606,14 @@ static void emit_member_expression(information *const info, const node *const nd
 	item_t type = expression_get_type(&base);
 	const size_t id = node_get_type(&base) == OP_IDENTIFIER ? expression_identifier_get_id(&base) : SIZE_MAX;
 
+	const size_t number = numbering_get(&info->numbers, nd);
+	item_t address = vector_get(&info->addresses, number);
+	if (address != ITEM_MAX)
+	{
+		emit_member_load(info, address, elem_type);
+		return;
+	}
+
 	bool is_complex = false;
 	if (type_is_pointer(info->sx, type))
 	{
@@ -1219,25 +2648,21 @@ static void emit_member_expression(information *const info, const node *const nd
 		is_complex = true;
 		info->variable_location = loc;
 
-		uni_printf(info->sx->io, " %%.%zu = extractvalue %%struct_opt.%" PRIitem " %%.%zu, %" PRIitem "\n"
-			, info->register_num, type, info->register_num - 1, place);
+		uni_printf(info->sx->io, " %%.%zu = extractvalue %%struct_opt.%" PRIitem " %%.%zu, %zu\n"
+			, info->register_num, type, info->register_num - 1, type_get_field(info, type, (size_t)place, false));
 
 		info->answer_reg = info->register_num++;
 		return;
 	}
 
 	uni_printf(info->sx->io, " %%.%zu = getelementptr inbounds %%struct_opt.%" PRIitem ", " 
-		"%%struct_opt.%" PRIitem "* %s.%zu, i32 0, i32 %" PRIitem "\n", info->register_num, type, type
-		, is_complex ? "%" : (ident_is_local(info->sx, id) ? "%var" : "@var"), is_complex ? info->register_num - 1 : id, place);
-
-	if (info->variable_location != LMEM)
-	{
-		info->register_num++;
-		to_code_load(info, info->register_num, info->register_num - 1, elem_type, true, true);
-		info->answer_kind = AREG;
-	}
+		"%%struct_opt.%" PRIitem "* %s.%zu, i32 0, i32 %zu\n", info->register_num, type, type
+		, is_complex ? "%" : (ident_is_local(info->sx, id) ? "%var" : "@var"), is_complex ? info->register_num - 1 : id
+		, type_get_field(info, type, (size_t)place, false));
 
-	info->answer_reg = info->register_num++;
+	address = (item_t)info->register_num++;
+	vector_set(&info->addresses, number, address);
+	emit_member_load(info, address, elem_type);
 }
 
 /**
@@ -1346,29 +2771,13 @@ static void emit_unary_expression(information *const info, const node *const nd)
 
 		case UN_LOGNOT:
 		{
-			const size_t temp = info->label_true;
-			info->label_true =  info->label_false;
-			info->label_false = temp;
-
+			info->variable_location = LFREE;
 			emit_expression(info, &operand);
+			to_code_condition(info, expression_get_type(&operand));
 
-			if (info->answer_kind == AREG)
-			{
-				if (type_is_pointer(info->sx, expression_get_type(&operand)))
-				{
-					to_code_operation_reg_null(info, BIN_NE, info->answer_reg, expression_get_type(&operand));
-				}
-				else
-				{
-					if (type_is_integer(info->sx, expression_get_type(&operand)))
-					{
-						check_type_and_branch(info, expression_get_type(&operand));
-					}
-					to_code_operation_reg_const_bool(info, BIN_XOR, info->answer_reg, true, TYPE_BOOLEAN);
-				}
-				info->answer_reg = info->register_num++;
-			}
-
+			to_code_operation_reg_const_bool(info, BIN_XOR, info->answer_reg, true, TYPE_BOOLEAN);
+			info->answer_kind = ALOGIC;
+			info->answer_reg = info->register_num++;
 			return;
 		}
 
@@ -1411,19 +2820,14 @@ static void emit_unary_expression(information *const info, const node *const nd)
 			uni_printf(info->sx->io, " %%.%zu = call ", info->register_num);
 			type_to_io(info, type);
 
-			if (type_is_integer(info->sx, type))
-			{
-				uni_printf(info->sx->io, " @abs(");
-				info->was_abs = true;
-			}
-			else
-			{
-				uni_printf(info->sx->io, " @llvm.fabs.f64(");
-				info->was_fabs = true;
-			}
+			// Модуль минимального целого остаётся им же, как и у abs из библиотеки
+			const bool is_integer = type_is_integer(info->sx, type);
+			uni_printf(info->sx->io, is_integer ? " @llvm.abs.i32(" : " @llvm.fabs.f64(");
+			info->was_abs = info->was_abs || is_integer;
+			info->was_fabs = info->was_fabs || !is_integer;
 
 			type_to_io(info, type);
-			uni_printf(info->sx->io, " %%.%zu)\n", info->answer_reg);
+			uni_printf(info->sx->io, " %%.%zu%s)\n", info->answer_reg, is_integer ? ", i1 false" : "");
 
 			info->answer_kind = AREG;
 			info->answer_reg = info->register_num++;
@@ -1563,6 +2967,36 @@ static void emit_integral_expression(information *const info, const node *const
 	info->answer_kind = kind;
 }
 
+/**
+ *	Emit binary expression of vectors
+ *
+ *	@param	info	Encoder
+ *	@param	nd		Node in AST
+ */
+static void emit_vector_expression(information *const info, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+
+	info->variable_location = LFREE;
+	const node LHS = expression_binary_get_LHS(nd);
+	emit_expression(info, &LHS);
+	const size_t left_reg = to_code_struct_to_vector(info, info->answer_reg, type);
+
+	info->variable_location = LFREE;
+	const node RHS = expression_binary_get_RHS(nd);
+	emit_expression(info, &RHS);
+	const size_t right_reg = to_code_struct_to_vector(info, info->answer_reg, type);
+
+	uni_printf(info->sx->io, " %%.%zu = ", info->register_num);
+	operation_to_io(info, expression_binary_get_operator(nd), type_vector_get_element_type(info->sx, type));
+	uni_printf(info->sx->io, " ");
+	vector_type_to_io(info, type);
+	uni_printf(info->sx->io, " %%.%zu, %%.%zu\n", left_reg, right_reg);
+
+	info->answer_reg = to_code_vector_to_struct(info, info->register_num++, type);
+	info->answer_kind = AREG;
+}
+
 /**
  *	Emit assignment expression
  *
@@ -1680,6 +3114,12 @@ static void emit_binary_expression(information *const info, const node *const nd
 {
 	const binary_t operator = expression_binary_get_operator(nd);
 
+	if (operator != BIN_COMMA && type_is_vector(info->sx, expression_get_type(nd)))
+	{
+		emit_vector_expression(info, nd);
+		return;
+	}
+
 	switch (operator)
 	{
 		case BIN_MUL:
@@ -1702,91 +3142,32 @@ static void emit_binary_expression(information *const info, const node *const nd
 		case BIN_EQ:
 		case BIN_NE:
 			emit_integral_expression(info, nd, ALOGIC);
-			return;
-
-		// TODO: протестировать и при необходимости реализовать случай, когда && и || есть в арифметических выражениях
-		case BIN_LOG_OR:
-		case BIN_LOG_AND:
-		{
-			const bool is_logic = info->variable_location != LNOLOG;
-			if (!is_logic)
-			{
-				info->label_true = info->label_num++;
-				info->label_false = info->label_num++;
-			}
-
-			const size_t label_next = info->label_num++;
-			const size_t old_label_true = info->label_true;
-			const size_t old_label_false = info->label_false;
-
-			if (operator == BIN_LOG_OR)
-			{
-				info->label_false = label_next;
-
-				if (!is_logic)
-				{
-					info->label_true = old_label_false;
-				}
-			}
-			else // (operator == OP_LOG_AND)
-			{
-				info->label_true = label_next;
-			}
-
-			const node LHS = expression_binary_get_LHS(nd);
-			info->variable_location = is_logic ? LFREE : LNOLOG;
-			emit_expression(info, &LHS);
-
-			if (!is_logic)
-			{
-				info->label_true = old_label_true;
-				info->label_false = old_label_false;
-
-				if (operator == BIN_LOG_OR)
-				{
-					info->label_false = label_next;
-
-					if (!is_logic)
-					{
-						info->label_true = old_label_false;
-					}
-				}
-				else // (operator == OP_LOG_AND)
-				{
-					info->label_true = label_next;
-				}
-			}
-
-			info->variable_location = LFREE;
-			check_type_and_branch(info, expression_get_type(&LHS));
-
-			to_code_label(info, label_next);
-			info->label_true = old_label_true;
-			info->label_false = old_label_false;
+			return;
 
-			const node RHS = expression_binary_get_RHS(nd);
-			info->variable_location = is_logic ? LFREE : LNOLOG;
-			emit_expression(info, &RHS);
+		case BIN_LOG_OR:
+		case BIN_LOG_AND:
+		{
+			// Значение собирается из двух входов, в которые ведут переходы вычисления условия
+			const size_t old_label_true = info->label_true;
+			const size_t old_label_false = info->label_false;
+			info->label_true = info->label_num++;
+			info->label_false = info->label_num++;
+			const size_t label_end = info->label_num++;
 
-			info->variable_location = is_logic ? LFREE : LNOLOG;
-			check_type_and_branch(info, expression_get_type(&RHS));
+			emit_condition(info, nd);
 
-			if (!is_logic)
-			{
-				to_code_label(info, info->label_false);
-				uni_printf(info->sx->io, " %%.%zu = phi i1 [ %s, %%%s%zu ], [ %%.%zu, %%label%zu ]\n", info->register_num
-					, operator == BIN_LOG_OR ? "true" : "false", info->label_phi_previous == 0 ? "" : "label"
-					, info->label_phi_previous, info->register_num - 1, label_next);
+			to_code_label(info, info->label_true);
+			to_code_unconditional_branch(info, label_end);
+			to_code_label(info, info->label_false);
+			to_code_unconditional_branch(info, label_end);
+			to_code_label(info, label_end);
+			uni_printf(info->sx->io, " %%.%zu = phi i1 [ true, %%label%zu ], [ false, %%label%zu ]\n"
+				, info->register_num, info->label_true, info->label_false);
 
-				info->label_phi_previous = info->label_false;
-				info->answer_reg = info->register_num;
-				info->answer_kind = AREG;
-				info->register_num++;
-			}
-			else
-			{
-				info->answer_kind = ALOGIC;
-			}
+			info->answer_kind = ALOGIC;
+			info->answer_reg = info->register_num++;
+			info->label_true = old_label_true;
+			info->label_false = old_label_false;
 			return;
 		}
 
@@ -1806,78 +3187,108 @@ static void emit_binary_expression(information *const info, const node *const nd
 	}
 }
 
+static bool ternary_is_select(information *const info, const node *const nd)
+{
+	// Ветви без побочных эффектов и переходов можно вычислить обе
+	const item_t type = expression_get_type(nd);
+	if (!type_is_scalar(info->sx, type))
+	{
+		return false;
+	}
+
+	const node LHS = expression_ternary_get_LHS(nd);
+	const node RHS = expression_ternary_get_RHS(nd);
+	return (expression_get_class(&LHS) == EXPR_LITERAL || expression_get_class(&LHS) == EXPR_IDENTIFIER)
+		&& (expression_get_class(&RHS) == EXPR_LITERAL || expression_get_class(&RHS) == EXPR_IDENTIFIER)
+		&& expression_get_type(&LHS) == type && expression_get_type(&RHS) == type;
+}
+
 /**
- *	Emit ternary expression
+ *	Emit ternary expression.
+ *	Simple branches are selected by select instruction, others are joined by phi.
  *
  *	@param	info	Encoder
  *	@param	nd		Node in AST
  */
 static void emit_ternary_expression(information *const info, const node *const nd)
 {
+	const item_t type = expression_get_type(nd);
+	const node condition = expression_ternary_get_condition(nd);
+	const node LHS = expression_ternary_get_LHS(nd);
+	const node RHS = expression_ternary_get_RHS(nd);
+
+	if (ternary_is_select(info, nd))
+	{
+		info->variable_location = LFREE;
+		emit_expression(info, &condition);
+		to_code_condition(info, expression_get_type(&condition));
+		const size_t condition_reg = info->answer_reg;
+
+		info->variable_location = LFREE;
+		emit_expression(info, &LHS);
+		const operand then_operand = operand_save(info);
+
+		info->variable_location = LFREE;
+		emit_expression(info, &RHS);
+		const operand else_operand = operand_save(info);
+
+		uni_printf(info->sx->io, " %%.%zu = select i1 %%.%zu, ", info->register_num, condition_reg);
+		type_to_io(info, type);
+		uni_printf(info->sx->io, " ");
+		operand_to_io(info, &then_operand, type);
+		uni_printf(info->sx->io, ", ");
+		type_to_io(info, type);
+		uni_printf(info->sx->io, " ");
+		operand_to_io(info, &else_operand, type);
+		uni_printf(info->sx->io, "\n");
+
+		info->answer_kind = AREG;
+		info->answer_reg = info->register_num++;
+		return;
+	}
+
 	const size_t old_label_true = info->label_true;
 	const size_t old_label_false = info->label_false;
-	size_t label_then = info->label_num++;
-	size_t label_else = info->label_num++;
+	const size_t label_then = info->label_num++;
+	const size_t label_else = info->label_num++;
+	const size_t label_then_end = info->label_num++;
+	const size_t label_else_end = info->label_num++;
 	const size_t label_end = info->label_num++;
 
 	info->label_true = label_then;
 	info->label_false = label_else;
+	emit_condition(info, &condition);
+	info->label_true = old_label_true;
+	info->label_false = old_label_false;
 
-	info->variable_location = LFREE;
-	const node condition = expression_ternary_get_condition(nd);
-	emit_expression(info, &condition);
-
-	check_type_and_branch(info, expression_get_type(&condition));
-
+	// Ветви могут содержать переходы, поэтому в phi указываются отдельные блоки их концов
 	to_code_label(info, label_then);
-
 	info->variable_location = LFREE;
-	const node LHS = expression_ternary_get_LHS(nd);
-	const bool then_is_ternary = expression_get_class(&LHS) == EXPR_TERNARY;
 	emit_expression(info, &LHS);
-
-	const answer_t then_answer = info->answer_kind;
-	const item_t then_reg = info->answer_reg;
-	const item_t then_const = info->answer_const;
-
-	if (then_is_ternary)
-	{
-		label_then = info->label_ternary_end;
-	}
-
+	const operand then_operand = operand_save(info);
+	to_code_unconditional_branch(info, label_then_end);
+	to_code_label(info, label_then_end);
 	to_code_unconditional_branch(info, label_end);
-	to_code_label(info, label_else);
 
+	to_code_label(info, label_else);
 	info->variable_location = LFREE;
-	const node RHS = expression_ternary_get_RHS(nd);
-	const bool else_is_ternary = expression_get_class(&RHS) == EXPR_TERNARY;
 	emit_expression(info, &RHS);
-
-	const answer_t else_answer = info->answer_kind;
-	const item_t else_reg = info->answer_reg;
-	const item_t else_const = info->answer_const;
-
-	if (else_is_ternary)
-	{
-		label_else = info->label_ternary_end;
-	}
-
+	const operand else_operand = operand_save(info);
+	to_code_unconditional_branch(info, label_else_end);
+	to_code_label(info, label_else_end);
 	to_code_unconditional_branch(info, label_end);
-	to_code_label(info, label_end);
 
+	to_code_label(info, label_end);
 	uni_printf(info->sx->io, " %%.%zu = phi ", info->register_num);
-	type_to_io(info, expression_get_type(nd));
-	uni_printf(info->sx->io, " [ %s%" PRIitem ", %%label%zu ]", then_answer == AREG ? "%." : ""
-		, then_answer == AREG ? then_reg : then_const, label_then);
-	uni_printf(info->sx->io, ", [ %s%" PRIitem ", %%label%zu ]\n", else_answer == AREG ? "%." : ""
-		, else_answer == AREG ? else_reg : else_const, label_else);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, " [ ");
+	operand_to_io(info, &then_operand, type);
+	uni_printf(info->sx->io, ", %%label%zu ], [ ", label_then_end);
+	operand_to_io(info, &else_operand, type);
+	uni_printf(info->sx->io, ", %%label%zu ]\n", label_else_end);
 
 	info->answer_kind = AREG;
 	info->answer_reg = info->register_num++;
-
-	info->label_true = old_label_true;
-	info->label_false = old_label_false;
-	info->label_ternary_end = label_end;
 }
 
 /**
@@ -1902,7 +3313,7 @@ static void emit_initializer_expression(information *const info, const node *con
 
 			uni_printf(info->sx->io, " %%.%zu = getelementptr inbounds %%struct_opt.%zu, " 
 			"%%struct_opt.%zu* %%.%zu, i32 0, i32 %zu\n", info->register_num
-				, structure_type, structure_type, slice_reg, i);
+				, structure_type, structure_type, slice_reg, type_get_field(info, (item_t)structure_type, i, false));
 
 			to_code_store_const_integer(info, info->answer_const, info->register_num, true, true
 				, expression_get_type(&initializer));
@@ -1960,86 +3371,423 @@ static void emit_expression(information *const info, const node *const nd)
 			emit_member_expression(info, nd);
 			return;
 
-		case EXPR_UNARY:
-			emit_unary_expression(info, nd);
-			return;
+		case EXPR_UNARY:
+			emit_unary_expression(info, nd);
+			return;
+
+		case EXPR_BINARY:
+			emit_binary_expression(info, nd);
+			return;
+
+		case EXPR_TERNARY:
+			emit_ternary_expression(info, nd);
+			return;
+
+		case EXPR_ASSIGNMENT:
+			emit_assignment_expression(info, nd);
+			return;
+
+		case EXPR_INITIALIZER:
+			emit_initializer_expression(info, nd);
+			return;
+
+		default:
+			// TODO: генерация оставшихся выражений
+			return;
+	}
+}
+
+/**
+ *	Emit initialization of lvalue
+ *
+ *	@param	info			Encoder
+ *	@param	nd				Node in AST
+ *	@param	id				Identifier of target lvalue
+ *	@param	arr_type		Array type of target lvalue
+ *	@param	cur_dimension	Current dimension of slice
+ *	@param	prev_slice		Register of previous slice, if it exists
+ *	@param	is_local		Is array local or global
+ */
+static void emit_one_dimension_initialization(information *const info, const node *const nd, const item_t id
+	, const item_t arr_type, const size_t cur_dimension, const item_t prev_slice, const bool is_local)
+{
+	const size_t size = node_get_type(nd) == OP_INITIALIZER ? expression_initializer_get_size(nd) : SIZE_MAX;
+	const item_t type = array_get_type(info, arr_type);
+
+	for (size_t i = 0; i < size && size != SIZE_MAX; i++)
+	{
+		info->answer_const = (item_t)i;
+		info->answer_kind = ACONST;
+		const size_t slice_reg = (size_t)info->register_num;
+
+		to_code_slice(info, id, cur_dimension, prev_slice, type, is_local);
+
+		info->variable_location = LFREE;
+		if (expression_initializer_is_packed(nd))
+		{
+			// Упакованные значения уже приведены к типу элементов
+			if (type_is_integer(info->sx, type))
+			{
+				to_code_store_const_integer(info, (item_t)expression_initializer_get_integer(nd, i), slice_reg
+					, true, true, type);
+			}
+			else
+			{
+				to_code_store_const_double(info, expression_initializer_get_floating(nd, i), slice_reg, true, true);
+			}
+			continue;
+		}
+
+		const node initializer = expression_initializer_get_subexpr(nd, i);
+
+		// последнее измерение
+		if (cur_dimension == 0)
+		{
+			emit_expression(info, &initializer);
+
+			if (info->answer_kind == AREG)
+			{
+				to_code_store_reg(info, info->answer_reg, slice_reg, type, true, false, is_local);
+			}
+			// константа типа int
+			else if (type_is_integer(info->sx, type))
+			{
+				to_code_store_const_integer(info, info->answer_const, slice_reg, true, true, type);
+			}
+			// константа типа double
+			else
+			{
+				to_code_store_const_double(info, info->answer_const_double, slice_reg, true, true);
+			}
+		}
+		else
+		{
+			emit_one_dimension_initialization(info, &initializer, id, arr_type, cur_dimension - 1
+				, (item_t)slice_reg, true);
+		}
+	}
+}
+
+/**
+ *	Get bit representation of double
+ *
+ *	@param	value		Value
+ *
+ *	@return	Bits of value
+ */
+static uint64_t double_to_bits(const double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+/**
+ *	Get integer value of constant list element
+ *
+ *	@param	nd			Initializer
+ *	@param	index		Index of element
+ *	@param	type		Element type
+ *
+ *	@return	Value of element
+ */
+static int64_t element_get_integer(const node *const nd, const size_t index, const item_t type)
+{
+	if (expression_initializer_is_packed(nd))
+	{
+		return expression_initializer_get_integer(nd, index);
+	}
+
+	const node element = expression_initializer_get_subexpr(nd, index);
+	return type == TYPE_CHARACTER
+		? (int64_t)expression_literal_get_character(&element)
+		: expression_literal_get_integer(&element);
+}
+
+/**
+ *	Get floating value of constant list element
+ *
+ *	@param	nd			Initializer
+ *	@param	index		Index of element
+ *
+ *	@return	Value of element
+ */
+static double element_get_floating(const node *const nd, const size_t index)
+{
+	if (expression_initializer_is_packed(nd))
+	{
+		return expression_initializer_get_floating(nd, index);
+	}
+
+	const node element = expression_initializer_get_subexpr(nd, index);
+	return expression_literal_get_floating(&element);
+}
+
+/**
+ *	Emit constant list element
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Initializer
+ *	@param	index		Index of element
+ *	@param	type		Element type
+ */
+static void element_to_io(information *const info, const node *const nd, const size_t index, const item_t type)
+{
+	if (type == TYPE_FLOATING)
+	{
+		// Шестнадцатеричная запись сохраняет значение без округления
+		uni_printf(info->sx->io, " 0x%016" PRIX64, double_to_bits(element_get_floating(nd, index)));
+	}
+	else
+	{
+		uni_printf(info->sx->io, " %" PRIi64, element_get_integer(nd, index, type));
+	}
+}
+
+/**
+ *	Check that literal can be stored into array element by constant initializer
+ *
+ *	@param	nd			Initializer subexpression
+ *	@param	type		Element type
+ *
+ *	@return	@c true on suitable literal, @c false otherwise
+ */
+static bool is_bulk_element(const node *const nd, const item_t type)
+{
+	if (expression_get_class(nd) != EXPR_LITERAL || expression_get_type(nd) != type)
+	{
+		return false;
+	}
+
+	// Литеры вне ASCII не помещаются в i8
+	return type != TYPE_CHARACTER || expression_literal_get_character(nd) < 128;
+}
+
+/**
+ *	Emit copy of constant array from global memory or fill of array by zeros
+ *
+ *	@param	info		Encoder
+ *	@param	id			Identifier of array
+ *	@param	source		Global constant, @c NULL for zero fill
+ *	@param	size		Size of array in bytes
+ *	@param	type		Element type
+ */
+static void to_code_bulk_initialization(information *const info, const item_t id, const char *const source
+	, const size_t size, const item_t type)
+{
+	const size_t length = (size_t)hash_get(&info->arrays, id, 1);
+	const size_t alignment = type_get_alignment(info, type);
+
+	uni_printf(info->sx->io, " %%.%zu = bitcast [%zu x ", info->register_num, length);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "]* %%arr.%" PRIitem " to i8*\n", id);
+
+	if (source == NULL)
+	{
+		uni_printf(info->sx->io, " call void @llvm.memset.p0i8.i64(i8* align %zu %%.%zu, i8 0, i64 %zu, i1 false)\n"
+			, alignment, info->register_num, size);
+		info->was_memset = true;
+	}
+	else
+	{
+		uni_printf(info->sx->io, " call void @llvm.memcpy.p0i8.p0i8.i64(i8* align %zu %%.%zu, i8* align %zu %s, i64 %zu"
+			", i1 false)\n", alignment, info->register_num, alignment, source, size);
+		info->was_memcpy = true;
+	}
+
+	info->register_num++;
+}
+
+/**
+ *	Emit initialization of one-dimensional local array by constant list as one block operation
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Initializer
+ *	@param	id			Identifier of array
+ *	@param	type		Element type
+ *
+ *	@return	@c true on emitted initialization, @c false if list is not constant
+ */
+static bool emit_bulk_initialization(information *const info, const node *const nd, const item_t id, const item_t type)
+{
+	const size_t length = expression_initializer_get_size(nd);
+	if (length < MIN_BULK_INITIALIZATION
+		|| (type != TYPE_INTEGER && type != TYPE_CHARACTER && type != TYPE_FLOATING))
+	{
+		return false;
+	}
+
+	const bool is_packed = expression_initializer_is_packed(nd);
+	if (is_packed && expression_initializer_get_literal_type(nd) != type)
+	{
+		return false;
+	}
+
+	bool is_zero = true;
+	for (size_t i = 0; i < length; i++)
+	{
+		if (!is_packed)
+		{
+			const node element = expression_initializer_get_subexpr(nd, i);
+			if (!is_bulk_element(&element, type))
+			{
+				return false;
+			}
+		}
+
+		is_zero = is_zero && (type == TYPE_FLOATING
+			? double_to_bits(element_get_floating(nd, i)) == 0
+			: element_get_integer(nd, i, type) == 0);
+	}
+
+	const size_t size = length * type_get_alignment(info, type);
+	if (is_zero)
+	{
+		to_code_bulk_initialization(info, id, NULL, size, type);
+		return true;
+	}
+
+	// Значения лежат в глобальной константе, которая копируется одним вызовом
+	out_swap(info->sx->io, &info->constants);
+	uni_printf(info->sx->io, "@.init.%" PRIitem " = private unnamed_addr constant [%zu x ", id, length);
+	type_to_io(info, type);
+	uni_printf(info->sx->io, "] [");
+	for (size_t i = 0; i < length; i++)
+	{
+		uni_printf(info->sx->io, i == 0 ? "" : ", ");
+		type_to_io(info, type);
+		element_to_io(info, nd, i, type);
+	}
+	uni_printf(info->sx->io, "]");
+	alignment_to_io(info, type);
+	out_swap(info->sx->io, &info->constants);
+
+	char source[MAX_NAME];
+	sprintf(source, "bitcast ([%zu x %s]* @.init.%" PRIitem " to i8*)", length
+		, type == TYPE_CHARACTER ? "i8" : type == TYPE_FLOATING ? "double" : "i32", id);
+	to_code_bulk_initialization(info, id, source, size, type);
+	return true;
+}
 
-		case EXPR_BINARY:
-			emit_binary_expression(info, nd);
-			return;
+/**
+ *	Check that initializer of global array consists of literals only and fills array completely
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Initializer
+ *	@param	index		Index of array in arrays table
+ *	@param	dimension	Current dimension, starting from @c 1
+ *	@param	type		Element type
+ *
+ *	@return	@c true on constant initializer, @c false otherwise
+ */
+static bool is_constant_initializer(information *const info, const node *const nd, const size_t index
+	, const size_t dimension, const item_t type)
+{
+	if (type != TYPE_INTEGER && type != TYPE_CHARACTER && type != TYPE_FLOATING)
+	{
+		return false;
+	}
 
-		case EXPR_TERNARY:
-			emit_ternary_expression(info, nd);
-			return;
+	const size_t dimensions = hash_get_amount_by_index(&info->arrays, index) - 1;
+	if (dimension > dimensions)
+	{
+		return is_bulk_element(nd, type);
+	}
 
-		case EXPR_ASSIGNMENT:
-			emit_assignment_expression(info, nd);
-			return;
+	// Границы взяты из первых списков, более короткие или длинные списки заполняются по элементам
+	if (node_get_type(nd) != OP_INITIALIZER
+		|| (item_t)expression_initializer_get_size(nd) != hash_get_by_index(&info->arrays, index, dimension))
+	{
+		return false;
+	}
 
-		case EXPR_INITIALIZER:
-			emit_initializer_expression(info, nd);
-			return;
+	if (expression_initializer_is_packed(nd))
+	{
+		return dimension == dimensions && expression_initializer_get_literal_type(nd) == type;
+	}
 
-		default:
-			// TODO: генерация оставшихся выражений
-			return;
+	const size_t size = expression_initializer_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node element = expression_initializer_get_subexpr(nd, i);
+		if (!is_constant_initializer(info, &element, index, dimension + 1, type))
+		{
+			return false;
+		}
 	}
+
+	return true;
 }
 
 /**
- *	Emit initialization of lvalue
+ *	Emit type of global array starting from dimension
  *
- *	@param	info			Encoder
- *	@param	nd				Node in AST
- *	@param	id				Identifier of target lvalue
- *	@param	arr_type		Array type of target lvalue
- *	@param	cur_dimension	Current dimension of slice
- *	@param	prev_slice		Register of previous slice, if it exists
- *	@param	is_local		Is array local or global
+ *	@param	info		Encoder
+ *	@param	index		Index of array in arrays table
+ *	@param	dimension	First dimension, starting from @c 1
+ *	@param	type		Element type
  */
-static void emit_one_dimension_initialization(information *const info, const node *const nd, const item_t id
-	, const item_t arr_type, const size_t cur_dimension, const item_t prev_slice, const bool is_local)
+static void array_type_to_io(information *const info, const size_t index, const size_t dimension, const item_t type)
 {
-	const size_t size = node_get_type(nd) == OP_INITIALIZER ? expression_initializer_get_size(nd) : SIZE_MAX;
-	const item_t type = array_get_type(info, arr_type);
-
-	for (size_t i = 0; i < size && size != SIZE_MAX; i++)
+	const size_t dimensions = hash_get_amount_by_index(&info->arrays, index) - 1;
+	for (size_t i = dimension; i <= dimensions; i++)
 	{
-		info->answer_const = (item_t)i;
-		info->answer_kind = ACONST;
-		const size_t slice_reg = (size_t)info->register_num;
+		uni_printf(info->sx->io, "[%" PRIitem " x ", hash_get_by_index(&info->arrays, index, i));
+	}
+	type_to_io(info, type);
 
-		to_code_slice(info, id, cur_dimension, prev_slice, type, is_local);
+	for (size_t i = dimension; i <= dimensions; i++)
+	{
+		uni_printf(info->sx->io, "]");
+	}
+}
 
-		info->variable_location = LFREE;
-		const node initializer = expression_initializer_get_subexpr(nd, i);
+/**
+ *	Emit constant value of global array, initializer should be checked by @c is_constant_initializer
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Initializer
+ *	@param	index		Index of array in arrays table
+ *	@param	dimension	Current dimension, starting from @c 1
+ *	@param	type		Element type
+ */
+static void constant_initializer_to_io(information *const info, const node *const nd, const size_t index
+	, const size_t dimension, const item_t type)
+{
+	array_type_to_io(info, index, dimension, type);
 
-		// последнее измерение
-		if (cur_dimension == 0)
+	if (dimension > hash_get_amount_by_index(&info->arrays, index) - 1)
+	{
+		if (type == TYPE_FLOATING)
 		{
-			emit_expression(info, &initializer);
-
-			if (info->answer_kind == AREG)
-			{
-				to_code_store_reg(info, info->answer_reg, slice_reg, type, true, false, is_local);
-			}
-			// константа типа int
-			else if (type_is_integer(info->sx, type))
-			{
-				to_code_store_const_integer(info, info->answer_const, slice_reg, true, true, type);
-			}
-			// константа типа double
-			else
-			{
-				to_code_store_const_double(info, info->answer_const_double, slice_reg, true, true);
-			}
+			// Шестнадцатеричная запись сохраняет значение без округления
+			uni_printf(info->sx->io, " 0x%016" PRIX64, double_to_bits(expression_literal_get_floating(nd)));
 		}
 		else
 		{
-			emit_one_dimension_initialization(info, &initializer, id, arr_type, cur_dimension - 1
-				, (item_t)slice_reg, true);
+			uni_printf(info->sx->io, " %" PRIi64, type == TYPE_CHARACTER
+				? (int64_t)expression_literal_get_character(nd)
+				: expression_literal_get_integer(nd));
+		}
+		return;
+	}
+
+	uni_printf(info->sx->io, " [");
+	const size_t size = expression_initializer_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		uni_printf(info->sx->io, i == 0 ? "" : ", ");
+		if (expression_initializer_is_packed(nd))
+		{
+			type_to_io(info, type);
+			element_to_io(info, nd, i, type);
+			continue;
 		}
+
+		const node element = expression_initializer_get_subexpr(nd, i);
+		constant_initializer_to_io(info, &element, index, dimension + 1, type);
 	}
+	uni_printf(info->sx->io, "]");
 }
 
 /**
@@ -2063,7 +3811,8 @@ static void emit_initialization(information *const info, const node *const nd, c
 			hash_set_by_index(&info->arrays, index, 1 + i
 				, node_get_type(&list_expression) == OP_INITIALIZER 
 				? (item_t)expression_initializer_get_size(&list_expression) : ITEM_MAX);
-			list_expression = node_get_type(&list_expression) == OP_INITIALIZER 
+			list_expression = node_get_type(&list_expression) == OP_INITIALIZER
+				&& !expression_initializer_is_packed(&list_expression)
 				? expression_initializer_get_subexpr(&list_expression, 0) : node_broken();
 		}
 
@@ -2075,7 +3824,17 @@ static void emit_initialization(information *const info, const node *const nd, c
 		if (is_local)
 		{
 			to_code_alloc_array_static(info, index, type, true);
-			emit_one_dimension_initialization(info, nd, id, arr_type, dimensions - 1, 0, is_local);
+			if (dimensions != 1 || !emit_bulk_initialization(info, nd, id, type))
+			{
+				emit_one_dimension_initialization(info, nd, id, arr_type, dimensions - 1, 0, is_local);
+			}
+		}
+		else if (is_constant_initializer(info, nd, index, 1, type))
+		{
+			// Значения попадают в секцию данных, поэтому при запуске ничего не записывается
+			uni_printf(info->sx->io, "@arr.%" PRIitem " = internal global ", id);
+			constant_initializer_to_io(info, nd, index, 1, type);
+			alignment_to_io(info, type);
 		}
 		else
 		{
@@ -2095,6 +3854,16 @@ static void emit_initialization(information *const info, const node *const nd, c
 		const item_t type = array_get_type(info, arr_type);
 		to_code_alloc_array_static(info, index, type, true);
 
+		// Строка вместе с завершающим нулём уже лежит в глобальной константе
+		if (type == TYPE_CHARACTER)
+		{
+			char source[MAX_NAME];
+			sprintf(source, "getelementptr inbounds ([%zu x i8], [%zu x i8]* @.str%zu, i32 0, i32 0)"
+				, length + 1, length + 1, expression_literal_get_string(nd));
+			to_code_bulk_initialization(info, id, source, length + 1, type);
+			return;
+		}
+
 		for (size_t i = 0; i < length; i++)
 		{
 			info->answer_const = (item_t)i;
@@ -2124,7 +3893,7 @@ static void emit_initialization(information *const info, const node *const nd, c
 				const size_t member_reg = (size_t)info->register_num;
 				uni_printf(info->sx->io, " %%.%zu = getelementptr inbounds %%struct_opt.%" PRIitem
 					", %%struct_opt.%" PRIitem "* %%var.%" PRIitem ", i32 0, i32 %zu\n"
-					, info->register_num, arr_type, arr_type, id, i);
+					, info->register_num, arr_type, arr_type, id, type_get_field(info, arr_type, i, false));
 				info->register_num++;
 
 				emit_expression(info, &initializer);
@@ -2147,11 +3916,12 @@ static void emit_initialization(information *const info, const node *const nd, c
 		}
 		else
 		{
-			uni_printf(info->sx->io, "global %%struct_opt.%" PRIitem " { ", arr_type);
+			uni_printf(info->sx->io, "internal global %%struct_opt.%" PRIitem " { ", arr_type);
 
+			// Константа перечисляет поля в порядке их размещения
 			for (size_t i = 0; i < N && N != SIZE_MAX; i++)
 			{
-				const node initializer = expression_initializer_get_subexpr(nd, i);
+				const node initializer = expression_initializer_get_subexpr(nd, type_get_field(info, arr_type, i, true));
 				const item_t type = expression_get_type(&initializer);
 
 				emit_expression(info, &initializer);
@@ -2173,10 +3943,12 @@ static void emit_initialization(information *const info, const node *const nd, c
 				}
 			}
 
-			uni_printf(info->sx->io, " }, align 4\n");
+			uni_printf(info->sx->io, " }");
+			alignment_to_io(info, arr_type);
 		}
 	}
-	else if (expression_get_class(nd) == EXPR_CALL && type_is_structure(info->sx, expression_get_type(nd)))
+	else if ((expression_get_class(nd) == EXPR_CALL || expression_get_class(nd) == EXPR_BINARY)
+		&& type_is_structure(info->sx, expression_get_type(nd)))
 	{
 		info->variable_location = LFREE;
 		emit_expression(info, nd);
@@ -2209,9 +3981,11 @@ static void emit_variable_declaration(information *const info, const node *const
 
 	if (!type_is_array(info->sx, type) && is_local) // обычная переменная int a; или struct point p;
 	{
+		to_code_alloca_begin(info);
 		uni_printf(info->sx->io, " %%var.%zu = alloca ", id);
 		type_to_io(info, type);
-		uni_printf(info->sx->io, ", align 4\n");
+		alignment_to_io(info, type);
+		to_code_alloca_end(info);
 
 		if (declaration_variable_has_initializer(nd))
 		{
@@ -2309,21 +4083,22 @@ static void emit_variable_declaration(information *const info, const node *const
 
 			if (info->answer_kind == ACONST)
 			{
-				uni_printf(info->sx->io, "global ");
+				uni_printf(info->sx->io, "internal global ");
 				type_to_io(info, type);
 				if (type_is_integer(info->sx, type))
 				{
-					uni_printf(info->sx->io, " %" PRIitem ", align 4\n", info->answer_const);
+					uni_printf(info->sx->io, " %" PRIitem, info->answer_const);
 				}
 				else
 				{
-					uni_printf(info->sx->io, " %f, align 4\n", info->answer_const_double);
+					uni_printf(info->sx->io, " %f", info->answer_const_double);
 				}
+				alignment_to_io(info, type);
 			}
 		}
 		else
 		{
-			uni_printf(info->sx->io, "common global ");
+			uni_printf(info->sx->io, "internal global ");
 			type_to_io(info, type);
 
 			if (type_is_integer(info->sx, type))
@@ -2346,7 +4121,7 @@ static void emit_variable_declaration(information *const info, const node *const
 			{
 				uni_printf(info->sx->io, " null");
 			}
-			uni_printf(info->sx->io, ", align 4\n");
+			alignment_to_io(info, type);
 		}
 	}
 	else // массив
@@ -2411,6 +4186,160 @@ static void emit_variable_declaration(information *const info, const node *const
 	}
 }
 
+/**
+ *	Emit attributes of function definition proven by effects analysis
+ *
+ *	@param	info		Encoder
+ *	@param	function	Identifier of function
+ */
+static void attributes_to_io(information *const info, const size_t function)
+{
+	const int flags = effects_get_function(&info->eff, function);
+	if ((flags & EFFECT_RECURSION) == 0)
+	{
+		uni_printf(info->sx->io, " norecurse");
+	}
+
+	// В RuC нет исключений, поэтому раскрутка стека невозможна
+	uni_printf(info->sx->io, " nounwind");
+
+	// main инициализирует глобальные переменные, а счётчики профилирования пишутся в память,
+	// структуры передаются через память
+	if (function != info->sx->ref_main && !info->is_profiling
+		&& !function_is_indirect(info, ident_get_type(info->sx, function)))
+	{
+		if ((flags & (EFFECT_READ | EFFECT_WRITE)) == 0)
+		{
+			uni_printf(info->sx->io, " readnone");
+		}
+		else if ((flags & EFFECT_WRITE) == 0)
+		{
+			uni_printf(info->sx->io, " readonly");
+		}
+	}
+
+	if ((flags & EFFECT_DIVERGENCE) == 0)
+	{
+		uni_printf(info->sx->io, " willreturn");
+	}
+}
+
+/**
+ *	Print function code, in which local names with identifiers are renumbered in order of their appearance,
+ *	so codes of functions, which differ only in identifiers of variables, are printed equally.
+ *	Metadata of loops is created for each loop, so its numbers are omitted.
+ *
+ *	@param	io			Universal io structure
+ *	@param	names		Numbers of already met local names
+ *	@param	text		Function code
+ */
+static void normalized_to_io(universal_io *const io, map *const names, const char *const text)
+{
+	static const char *const LOCAL_NAMES[] = { "%var.", "%arr.", "%dyn.", "%dynarr.", "%dynmark.", "!llvm.loop !" };
+	static const size_t LOCAL_NAMES_AMOUNT = sizeof(LOCAL_NAMES) / sizeof(LOCAL_NAMES[0]);
+
+	const char *begin = text;
+	const char *current = strpbrk(text, "%!");
+	while (current != NULL)
+	{
+		size_t prefix = 0;
+		size_t size = 0;
+		for (size_t i = 0; i < LOCAL_NAMES_AMOUNT && size == 0; i++)
+		{
+			prefix = strlen(LOCAL_NAMES[i]);
+			if (strncmp(current, LOCAL_NAMES[i], prefix) == 0 && current[prefix] >= '0' && current[prefix] <= '9')
+			{
+				size = prefix;
+				while (current[size] >= '0' && current[size] <= '9')
+				{
+					size++;
+				}
+			}
+		}
+
+		if (size == 0)
+		{
+			current = strpbrk(current + 1, "%!");
+			continue;
+		}
+
+		// Имя заменяется номером первого появления, но его вид сохраняется
+		out_write(io, begin, (size_t)(current - begin) + prefix);
+		if (*current == '%')
+		{
+			size_t index = map_get_index_by_span(names, current, size);
+			if (index == SIZE_MAX)
+			{
+				index = map_add_by_span(names, current, size, 0);
+			}
+			uni_printf(io, "#%zu", index);
+		}
+
+		begin = current + size;
+		current = strpbrk(begin, "%!");
+	}
+
+	out_write(io, begin, strlen(begin));
+}
+
+/**
+ *	Replace function definition by alias of already defined function with the same code
+ *
+ *	@param	info		Encoder
+ *	@param	function	Function identifier
+ *	@param	allocas		Allocations of function
+ *	@param	text		Function body
+ *
+ *	@return	@c true on function replaced by alias, @c false otherwise
+ */
+static bool function_fold(information *const info, const size_t function, const char *const allocas, const char *const text)
+{
+	// Потоковый вывод не откладывает функции, а main должна остаться определением
+	if (!info->is_folding || info->is_streaming || function == info->sx->ref_main)
+	{
+		return false;
+	}
+
+	// Атрибуты следуют из тела, поэтому совпадение функций определяется типом и телом
+	const item_t type = ident_get_type(info->sx, function);
+	universal_io io = io_create();
+	out_set_buffer(&io, FUNCTION_BUFFER_SIZE);
+	uni_printf(&io, "%" PRIitem "\n", type);
+
+	map names = map_create(0);
+	normalized_to_io(&io, &names, allocas);
+	normalized_to_io(&io, &names, text);
+	map_clear(&names);
+
+	char *const code = out_extract_buffer(&io);
+	io_erase(&io);
+
+	const size_t index = map_get_index(&info->bodies, code);
+	if (index == SIZE_MAX)
+	{
+		map_add(&info->bodies, code, (item_t)function);
+		free(code);
+		return false;
+	}
+	free(code);
+
+	uni_printf(info->sx->io, "@");
+	func_name_to_io(info, function);
+	uni_printf(info->sx->io, " = %s alias ", info->is_separate ? "dso_local" : "internal");
+
+	// Тип псевдонима – тип самой функции, как в инструкции вызова
+	const bool is_call = info->is_call;
+	info->is_call = true;
+	type_to_io(info, type);
+	uni_printf(info->sx->io, ", ");
+	type_to_io(info, type);
+	info->is_call = is_call;
+	uni_printf(info->sx->io, "* @");
+	func_name_to_io(info, (size_t)map_get_by_index(&info->bodies, index));
+	uni_printf(info->sx->io, "\n\n");
+	return true;
+}
+
 /**
  * Emit function definition
  *
@@ -2423,46 +4352,84 @@ static void emit_function_definition(information *const info, const node *const
 	const item_t func_type = ident_get_type(info->sx, ref_ident);
 	const item_t ret_type = ref_ident != info->sx->ref_main ? type_function_get_return_type(info->sx, func_type) : TYPE_INTEGER;
 	const size_t parameters = type_function_get_parameter_amount(info->sx, func_type);
+	const node body = declaration_function_get_body(nd);
 	info->was_dynamic = false;
-
-	uni_printf(info->sx->io, "define ");
-	type_to_io(info, ret_type);
+	info->return_type = ret_type;
+	info->function_body = body;
+
+	// Номера регистров и меток локальны для функции, их вывод не зависит от других функций
+	info->register_num = 1;
+	info->label_num = 1;
+
+	// Заголовок не выводится, если тело функции совпадёт с телом уже выведенной функции
+	universal_io header = io_create();
+	out_set_buffer(&header, FUNCTION_BUFFER_SIZE);
+	out_swap(info->sx->io, &header);
+
+	// Программа на RuC замкнута, поэтому снаружи модуля виден только main,
+	// а при раздельной компиляции функции могут вызываться из других модулей
+	uni_printf(info->sx->io, "define %s ", ref_ident == info->sx->ref_main || info->is_separate ? "dso_local" : "internal");
+	type_to_io(info, type_is_indirect(info, ret_type) ? TYPE_VOID : ret_type);
 	
 	if (ref_ident == info->sx->ref_main)
 	{
-		uni_printf(info->sx->io, " @main(");
+		uni_printf(info->sx->io, " @main");
 		info->is_main = true;
 	}
 	else
 	{
 		uni_printf(info->sx->io, " @");
 		func_name_to_io(info, ref_ident);
-		uni_printf(info->sx->io, "(");
 	}
 
-	for (size_t i = 0; i < parameters; i++)
-	{
-		uni_printf(info->sx->io, i == 0 ? "" : ", ");
+	parameters_to_io(info, func_type);
+	attributes_to_io(info, ref_ident);
 
-		const item_t param_type = type_function_get_parameter_type(info->sx, func_type, i);
-		type_to_io(info, param_type);
+	if (info->is_debug)
+	{
+		to_code_subprogram(info, &body, ref_ident);
+		uni_printf(info->sx->io, " !dbg !%zu", info->debug_scope);
 	}
-	uni_printf(info->sx->io, ") {\n");
+	uni_printf(info->sx->io, " {\n");
+	out_swap(info->sx->io, &header);
+
+	// Тело выводится после всех alloca, поэтому собирается в буфере
+	universal_io buffer = io_create();
+	out_set_buffer(&buffer, FUNCTION_BUFFER_SIZE);
+	out_swap(info->sx->io, &buffer);
 
+	info->allocas = io_create();
+	out_set_buffer(&info->allocas, FUNCTION_BUFFER_SIZE);
+	to_code_location(info, node_get_location(&body));
+
+	// Указатель на результат занимает первый аргумент
+	const size_t first = type_is_indirect(info, ret_type) ? 1 : 0;
 	for (size_t i = 0; i < parameters; i++)
 	{
 		const size_t id = declaration_function_get_parameter(nd, i);
 		const item_t param_type = ident_get_type(info->sx, id);
 
+		// Копия структуры уже сделана вызывающей функцией, её адрес используется как адрес параметра
+		if (type_is_indirect(info, param_type))
+		{
+			uni_printf(info->sx->io, " %%var.%zu = getelementptr inbounds ", id);
+			type_to_io(info, param_type);
+			uni_printf(info->sx->io, ", ");
+			type_to_io(info, param_type);
+			uni_printf(info->sx->io, "* %%%zu, i32 0\n", first + i);
+			continue;
+		}
+
 		uni_printf(info->sx->io, " %%var.%zu = alloca ", id);
 		type_to_io(info, param_type);
-		uni_printf(info->sx->io, ", align 4\n");
+		alignment_to_io(info, param_type);
 
 		uni_printf(info->sx->io, " store ");
 		type_to_io(info, param_type);
-		uni_printf(info->sx->io, " %%%zu, ", i);
+		uni_printf(info->sx->io, " %%%zu, ", first + i);
 		type_to_io(info, param_type);
-		uni_printf(info->sx->io, "* %%var.%zu, align 4\n", id);
+		uni_printf(info->sx->io, "* %%var.%zu", id);
+		access_to_io(info, param_type);
 
 		if (type_is_array(info->sx, param_type))
 		{
@@ -2470,7 +4437,8 @@ static void emit_function_definition(information *const info, const node *const
 			type_to_io(info, param_type);
 			uni_printf(info->sx->io, ", ");
 			type_to_io(info, param_type);
-			uni_printf(info->sx->io, "* %%var.%zu, align 4\n", id);
+			uni_printf(info->sx->io, "* %%var.%zu", id);
+			access_to_io(info, param_type);
 
 			const size_t dimensions = array_get_dim(info, param_type);
 			const size_t index = hash_add(&info->arrays, id, 1 + dimensions);
@@ -2483,7 +4451,8 @@ static void emit_function_definition(information *const info, const node *const
 		global_initialization(info);
 	}
 
-	const node body = declaration_function_get_body(nd);
+	info->function = ref_ident;
+	to_code_counter(info, NULL);
 	emit_compound_statement(info, &body, true);
 
 	if (type_is_void(ret_type))
@@ -2501,6 +4470,34 @@ static void emit_function_definition(information *const info, const node *const
 	}
 	uni_printf(info->sx->io, " unreachable\n");
 	uni_printf(info->sx->io, "}\n\n");
+
+	if (info->was_dynamic)
+	{
+		// Вершина кучи динамических массивов функции пуста до первого массива из кучи
+		to_code_alloca_begin(info);
+		uni_printf(info->sx->io, " %%arena = alloca i8*, align %zu\n", info->target->pointer_size);
+		uni_printf(info->sx->io, " store i8* null, i8** %%arena, align %zu\n", info->target->pointer_size);
+		to_code_alloca_end(info);
+	}
+
+	out_swap(info->sx->io, &buffer);
+	char *const head = out_extract_buffer(&header);
+	char *const allocas = out_extract_buffer(&info->allocas);
+	char *const text = out_extract_buffer(&buffer);
+
+	if (!function_fold(info, ref_ident, allocas, text))
+	{
+		out_write(info->sx->io, head, strlen(head));
+		out_write(info->sx->io, allocas, strlen(allocas));
+		function_to_io(info, text);
+	}
+
+	free(head);
+	free(allocas);
+	free(text);
+	io_erase(&header);
+	io_erase(&info->allocas);
+	io_erase(&buffer);
 }
 
 static void emit_declaration(information *const info, const node *const nd, const bool is_local)
@@ -2531,6 +4528,90 @@ static void emit_declaration(information *const info, const node *const nd, cons
  */
 
 
+/**
+ *	Check that compound statement declares dynamic arrays
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static bool compound_has_dynamic_array(information *const info, const node *const nd)
+{
+	const size_t size = statement_compound_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node substmt = statement_compound_get_substmt(nd, i);
+		if (statement_get_class(&substmt) != STMT_DECL)
+		{
+			continue;
+		}
+
+		const size_t amount = statement_declaration_get_size(&substmt);
+		for (size_t j = 0; j < amount; j++)
+		{
+			const node decl = statement_declaration_get_declarator(&substmt, j);
+			if (declaration_get_class(&decl) != DECL_VAR || declaration_variable_has_initializer(&decl)
+				|| !type_is_array(info->sx, ident_get_type(info->sx, declaration_variable_get_id(&decl))))
+			{
+				continue;
+			}
+
+			// Границы-константы свёрнуты в литералы, остальные вычисляются при выполнении
+			const size_t bounds = declaration_variable_get_bounds_amount(&decl);
+			for (size_t k = 0; k < bounds; k++)
+			{
+				const node bound = declaration_variable_get_bound(&decl, k);
+				if (expression_get_class(&bound) != EXPR_LITERAL)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+/**
+ *	Save stack state before loop whose body has dynamic arrays,
+ *	body restores it on each iteration end without saving it again
+ *
+ *	@param	info		Encoder
+ *	@param	body		Loop body
+ */
+static void loop_hoist_stack_save(information *const info, const node *const body)
+{
+	if (statement_get_class(body) != STMT_COMPOUND || !compound_has_dynamic_array(info, body))
+	{
+		return;
+	}
+
+	// Тело цикла получит следующий номер блока, выражения номеров не занимают
+	const item_t block = info->block_num;
+	to_code_stack_save(info, block);
+	info->hoisted_block = block;
+}
+
+/**
+ *	Emit expression statement, equal address computations of statement are emitted once
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ */
+static void emit_expression_statement(information *const info, const node *const nd)
+{
+	// Оператор без ветвлений находится в одном блоке, поэтому первый регистр с адресом доминирует над остальными
+	const size_t amount = info->is_numbering ? numbering_build(&info->numbers, nd) : 0;
+	for (size_t i = 0; i < amount; i++)
+	{
+		vector_add(&info->addresses, ITEM_MAX);
+	}
+
+	emit_expression(info, nd);
+	vector_resize(&info->addresses, 0);
+}
+
 /**
  *	Emit compound statement
  *
@@ -2540,7 +4621,8 @@ static void emit_declaration(information *const info, const node *const nd, cons
 static void emit_compound_statement(information *const info, const node *const nd, const bool is_function_body)
 {
 	const item_t block_num = info->block_num++;
-	if (!is_function_body)
+	const bool is_dynamic = !is_function_body && compound_has_dynamic_array(info, nd);
+	if (is_dynamic && block_num != info->hoisted_block)
 	{
 		to_code_stack_save(info, block_num);
 	}
@@ -2550,23 +4632,11 @@ static void emit_compound_statement(information *const info, const node *const n
 	{
 		const node substmt = statement_compound_get_substmt(nd, i);
 		emit_statement(info, &substmt);
+	}
 
-		if ((statement_get_class(&substmt) == STMT_CASE || statement_get_class(&substmt) == STMT_DEFAULT)
-			&& i == size - 1)
-		{
-			if (!is_function_body)
-			{
-				to_code_stack_load(info, block_num);
-			}
-			to_code_unconditional_branch(info, info->label_switch);
-		}
-		else if (i == size - 1)
-		{
-			if (!is_function_body)
-			{
-				to_code_stack_load(info, block_num);
-			}
-		}
+	if (is_dynamic)
+	{
+		to_code_stack_load(info, block_num);
 	}
 }
 
@@ -2587,15 +4657,13 @@ static void emit_if_statement(information *const info, const node *const nd)
 	info->label_true = label_if;
 	info->label_false = label_else;
 
-	info->variable_location = LFREE;
 	const node condition = statement_if_get_condition(nd);
-	emit_expression(info, &condition);
-
-	check_type_and_branch(info, expression_get_type(&condition));
+	emit_condition(info, &condition);
 
 	to_code_label(info, label_if);
 
 	const node then_substmt = statement_if_get_then_substmt(nd);
+	to_code_counter(info, &then_substmt);
 	emit_statement(info, &then_substmt);
 
 	to_code_unconditional_branch(info, label_end);
@@ -2604,6 +4672,7 @@ static void emit_if_statement(information *const info, const node *const nd)
 	if (statement_if_has_else_substmt(nd))
 	{
 		const node else_substmt = statement_if_get_else_substmt(nd);
+		to_code_counter(info, &else_substmt);
 		emit_statement(info, &else_substmt);
 	}
 
@@ -2635,18 +4704,18 @@ static void emit_while_statement(information *const info, const node *const nd)
 	info->label_break = label_end;
 	info->label_continue = label_body;
 
+	const node body = statement_while_get_body(nd);
+	loop_hoist_stack_save(info, &body);
+
 	to_code_unconditional_branch(info, label_condition);
 	to_code_label(info, label_condition);
 
-	info->variable_location = LFREE;
 	const node condition = statement_while_get_condition(nd);
-	emit_expression(info, &condition);
-
-	check_type_and_branch(info, expression_get_type(&condition));
+	emit_condition(info, &condition);
 
 	to_code_label(info, label_body);
 
-	const node body = statement_while_get_body(nd);
+	to_code_counter(info, &body);
 	emit_statement(info, &body);
 
 	to_code_unconditional_branch(info, label_condition);
@@ -2678,17 +4747,17 @@ static void emit_do_statement(information *const info, const node *const nd)
 	info->label_break = label_end;
 	info->label_continue = label_loop;
 
+	const node body = statement_do_get_body(nd);
+	loop_hoist_stack_save(info, &body);
+
 	to_code_unconditional_branch(info, label_loop);
 	to_code_label(info, label_loop);
 
-	const node body = statement_do_get_body(nd);
+	to_code_counter(info, &body);
 	emit_statement(info, &body);
 
-	info->variable_location = LFREE;
 	const node condition = statement_do_get_condition(nd);
-	emit_expression(info, &condition);
-
-	check_type_and_branch(info, expression_get_type(&condition));
+	emit_condition(info, &condition);
 
 	to_code_label(info, label_end);
 
@@ -2698,6 +4767,432 @@ static void emit_do_statement(information *const info, const node *const nd)
 	info->label_continue = old_label_continue;
 }
 
+static bool loop_is_member(const vector *const identifiers, const item_t identifier)
+{
+	for (size_t i = 0; i < vector_size(identifiers); i++)
+	{
+		if (vector_get(identifiers, i) == identifier)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static item_t loop_get_array(const node *const nd)
+{
+	node base = expression_subscript_get_base(nd);
+	while (expression_get_class(&base) == EXPR_SUBSCRIPT)
+	{
+		base = expression_subscript_get_base(&base);
+	}
+
+	return expression_get_class(&base) == EXPR_IDENTIFIER ? (item_t)expression_identifier_get_id(&base) : ITEM_MAX;
+}
+
+/**
+ *	Add modifiable expression of loop body
+ *
+ *	@param	lf			Loop form
+ *	@param	nd			Modifiable expression
+ *
+ *	@return	@c true on supported target, @c false otherwise
+ */
+static bool loop_add_target(loop_form *const lf, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	if (!type_is_integer(lf->sx, type) && !type_is_floating(type))
+	{
+		return false;
+	}
+
+	switch (expression_get_class(nd))
+	{
+		case EXPR_IDENTIFIER:
+		{
+			const size_t identifier = expression_identifier_get_id(nd);
+			if (identifier == lf->induction)
+			{
+				return false;
+			}
+
+			if (hash_get_index(&lf->writes, (item_t)identifier) == SIZE_MAX)
+			{
+				hash_add(&lf->writes, (item_t)identifier, 0);
+			}
+
+			if (loop_is_member(&lf->locals, (item_t)identifier))
+			{
+				return true;
+			}
+
+			// Внешняя переменная должна быть редукцией в регистре: локальной и изменяемой безусловно,
+			// вещественная редукция переставляет сложения
+			if (!ident_is_local(lf->sx, identifier) || lf->conditions != 0
+				|| (type_is_floating(type) && !lf->is_fast_math))
+			{
+				return false;
+			}
+
+			vector_add(&lf->outer, (item_t)identifier);
+			return true;
+		}
+
+		case EXPR_SUBSCRIPT:
+		{
+			// Запись допустима только в элемент с номером индукционной переменной
+			const node index = expression_subscript_get_index(nd);
+			vector_add(&lf->stores, loop_get_array(nd));
+			return expression_get_class(&index) == EXPR_IDENTIFIER
+				&& expression_identifier_get_id(&index) == lf->induction;
+		}
+
+		default:
+			return false;
+	}
+}
+
+/**
+ *	Add index of subscript in loop body
+ *
+ *	@param	lf			Loop form
+ *	@param	nd			Subscript expression
+ *
+ *	@return	@c true on index with constant stride, @c false otherwise
+ */
+static bool loop_add_index(loop_form *const lf, const node *const nd)
+{
+	node index = expression_subscript_get_index(nd);
+	if (expression_get_class(&index) == EXPR_BINARY)
+	{
+		const binary_t operator = expression_binary_get_operator(&index);
+		const node RHS = expression_binary_get_RHS(&index);
+		if ((operator != BIN_ADD && operator != BIN_SUB) || expression_get_class(&RHS) != EXPR_LITERAL)
+		{
+			return false;
+		}
+
+		index = expression_binary_get_LHS(&index);
+		vector_add(&lf->shifts, loop_get_array(nd));
+	}
+
+	switch (expression_get_class(&index))
+	{
+		case EXPR_LITERAL:
+			return true;
+
+		case EXPR_IDENTIFIER:
+			vector_add(&lf->indexes, (item_t)expression_identifier_get_id(&index));
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+static int loop_enter_node(void *const context, const node *const nd)
+{
+	loop_form *const lf = context;
+	switch (node_get_type(nd))
+	{
+		case OP_ASSIGNMENT:
+		{
+			const node LHS = expression_assignment_get_LHS(nd);
+			lf->is_simple = loop_add_target(lf, &LHS);
+			break;
+		}
+
+		case OP_UNARY:
+			switch (expression_unary_get_operator(nd))
+			{
+				case UN_POSTINC:
+				case UN_POSTDEC:
+				case UN_PREINC:
+				case UN_PREDEC:
+				{
+					const node operand = expression_unary_get_operand(nd);
+					lf->is_simple = loop_add_target(lf, &operand);
+					break;
+				}
+
+				case UN_ADDRESS:
+					lf->is_simple = false;
+					break;
+
+				default:
+					break;
+			}
+			break;
+
+		case OP_SLICE:
+			lf->is_simple = loop_add_index(lf, nd);
+			break;
+
+		case OP_DECL_VAR:
+		{
+			// Память массивов выделяется динамически
+			const size_t identifier = declaration_variable_get_id(nd);
+			lf->is_simple = !type_is_array(lf->sx, ident_get_type(lf->sx, identifier));
+			vector_add(&lf->locals, (item_t)identifier);
+			break;
+		}
+
+		case OP_BINARY:
+		{
+			const binary_t operator = expression_binary_get_operator(nd);
+			lf->conditions += operator == BIN_LOG_AND || operator == BIN_LOG_OR ? 1 : 0;
+			break;
+		}
+
+		case OP_IF:
+		case OP_TERNARY:
+			lf->conditions++;
+			break;
+
+		// Векторизуются только внутренние циклы с одним выходом и без вызовов
+		case OP_CALL:
+		case OP_WHILE:
+		case OP_DO:
+		case OP_FOR:
+		case OP_SWITCH:
+		case OP_BREAK:
+		case OP_RETURN:
+			lf->is_simple = false;
+			break;
+
+		default:
+			break;
+	}
+
+	return lf->is_simple ? 0 : -1;
+}
+
+static int loop_leave_node(void *const context, const node *const nd)
+{
+	loop_form *const lf = context;
+	if (node_get_type(nd) == OP_BINARY)
+	{
+		const binary_t operator = expression_binary_get_operator(nd);
+		lf->conditions -= operator == BIN_LOG_AND || operator == BIN_LOG_OR ? 1 : 0;
+	}
+	else
+	{
+		lf->conditions--;
+	}
+
+	return 0;
+}
+
+static bool loop_is_outer(const loop_form *const lf, const node *const nd)
+{
+	return expression_get_class(nd) == EXPR_IDENTIFIER
+		&& loop_is_member(&lf->outer, (item_t)expression_identifier_get_id(nd));
+}
+
+static int loop_find_address(void *const context, const node *const nd)
+{
+	loop_form *const lf = context;
+	if (node_get_type(nd) == OP_UNARY && expression_unary_get_operator(nd) == UN_ADDRESS)
+	{
+		const node operand = expression_unary_get_operand(nd);
+		lf->is_simple = !loop_is_outer(lf, &operand);
+	}
+	else if (node_get_type(nd) == OP_CALL)
+	{
+		// getid записывает значения в переданные переменные
+		const node callee = expression_call_get_callee(nd);
+		if (expression_get_class(&callee) == EXPR_IDENTIFIER && expression_identifier_get_id(&callee) == BI_GETID)
+		{
+			const size_t argc = expression_call_get_arguments_amount(nd);
+			for (size_t i = 0; i < argc && lf->is_simple; i++)
+			{
+				const node argument = expression_call_get_argument(nd, i);
+				lf->is_simple = !loop_is_outer(lf, &argument);
+			}
+		}
+	}
+
+	return lf->is_simple ? 0 : -1;
+}
+
+/**
+ *	Check that for statement is counted loop suitable for vectorization:
+ *	induction variable steps by constant towards bound, which does not change in loop,
+ *	and innermost body without calls and early exits writes only reductions and
+ *	elements indexed by induction variable
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Node in AST
+ *
+ *	@return	@c true on counted loop, @c false otherwise
+ */
+static bool loop_is_vectorizable(const information *const info, const node *const nd)
+{
+	// Счётчики исполнения записываются в глобальную память на каждой итерации
+	if (info->is_profiling || !statement_for_has_condition(nd) || !statement_for_has_increment(nd))
+	{
+		return false;
+	}
+
+	// Индукционная переменная изменяется инкрементом или прибавлением положительной константы
+	const node increment = statement_for_get_increment(nd);
+	node target = increment;
+	bool is_increasing = true;
+	bool is_unit = true;
+	if (expression_get_class(&increment) == EXPR_UNARY)
+	{
+		const unary_t operator = expression_unary_get_operator(&increment);
+		if (operator != UN_POSTINC && operator != UN_POSTDEC && operator != UN_PREINC && operator != UN_PREDEC)
+		{
+			return false;
+		}
+
+		target = expression_unary_get_operand(&increment);
+		is_increasing = operator == UN_POSTINC || operator == UN_PREINC;
+	}
+	else if (expression_get_class(&increment) == EXPR_ASSIGNMENT)
+	{
+		const binary_t operator = expression_assignment_get_operator(&increment);
+		const node step = expression_assignment_get_RHS(&increment);
+		if ((operator != BIN_ADD_ASSIGN && operator != BIN_SUB_ASSIGN) || expression_get_class(&step) != EXPR_LITERAL
+			|| expression_get_type(&step) != TYPE_INTEGER || expression_literal_get_integer(&step) <= 0)
+		{
+			return false;
+		}
+
+		target = expression_assignment_get_LHS(&increment);
+		is_increasing = operator == BIN_ADD_ASSIGN;
+		is_unit = expression_literal_get_integer(&step) == 1;
+	}
+	else
+	{
+		return false;
+	}
+
+	if (expression_get_class(&target) != EXPR_IDENTIFIER)
+	{
+		return false;
+	}
+
+	const size_t induction = expression_identifier_get_id(&target);
+	if (!ident_is_local(info->sx, induction) || ident_get_type(info->sx, induction) != TYPE_INTEGER)
+	{
+		return false;
+	}
+
+	// Условие сравнивает индукционную переменную с границей в направлении шага
+	const node condition = statement_for_get_condition(nd);
+	if (expression_get_class(&condition) != EXPR_BINARY)
+	{
+		return false;
+	}
+
+	const binary_t operator = expression_binary_get_operator(&condition);
+	const node variable = expression_binary_get_LHS(&condition);
+	const node bound = expression_binary_get_RHS(&condition);
+	const bool is_comparison = operator == BIN_NE
+		? is_unit
+		: is_increasing ? operator == BIN_LT || operator == BIN_LE : operator == BIN_GT || operator == BIN_GE;
+	if (!is_comparison || expression_get_class(&variable) != EXPR_IDENTIFIER
+		|| expression_identifier_get_id(&variable) != induction || expression_get_type(&bound) != TYPE_INTEGER
+		|| (expression_get_class(&bound) != EXPR_LITERAL && expression_get_class(&bound) != EXPR_IDENTIFIER))
+	{
+		return false;
+	}
+
+	loop_form lf = {
+		.sx = info->sx,
+		.induction = induction,
+		.writes = hash_create(0),
+		.locals = vector_create(0),
+		.indexes = vector_create(0),
+		.outer = vector_create(0),
+		.stores = vector_create(0),
+		.shifts = vector_create(0),
+		.conditions = 0,
+		.is_fast_math = info->is_fast_math,
+		.is_simple = true
+	};
+
+	visitor vis = visitor_create(&lf);
+	for (size_t i = 0; i < VISITOR_KINDS; i++)
+	{
+		visitor_set(&vis, (operation_t)i, &loop_enter_node, NULL);
+	}
+	visitor_set(&vis, OP_BINARY, &loop_enter_node, &loop_leave_node);
+	visitor_set(&vis, OP_IF, &loop_enter_node, &loop_leave_node);
+	visitor_set(&vis, OP_TERNARY, &loop_enter_node, &loop_leave_node);
+
+	const node body = statement_for_get_body(nd);
+	visitor_walk(&vis, &body);
+	visitor_clear(&vis);
+
+	// Граница и индексы не изменяются в цикле, поэтому число итераций и шаги адресов известны
+	vector_add(&lf.indexes, (item_t)induction);
+	if (expression_get_class(&bound) == EXPR_IDENTIFIER)
+	{
+		const size_t identifier = expression_identifier_get_id(&bound);
+		lf.is_simple = lf.is_simple && ident_is_local(info->sx, identifier);
+		vector_add(&lf.indexes, (item_t)identifier);
+	}
+
+	for (size_t i = 0; i < vector_size(&lf.indexes) && lf.is_simple; i++)
+	{
+		const item_t identifier = vector_get(&lf.indexes, i);
+		lf.is_simple = hash_get_index(&lf.writes, identifier) == SIZE_MAX;
+		vector_add(&lf.outer, identifier);
+	}
+
+	// Чтение со сдвигом из изменяемого массива переносит зависимость между итерациями
+	for (size_t i = 0; i < vector_size(&lf.shifts) && lf.is_simple; i++)
+	{
+		const item_t array = vector_get(&lf.shifts, i);
+		lf.is_simple = array != ITEM_MAX && !loop_is_member(&lf.stores, array);
+	}
+
+	// Переменные с взятым адресом не размещаются в регистрах
+	if (lf.is_simple)
+	{
+		visitor addresses = visitor_create(&lf);
+		visitor_set(&addresses, OP_UNARY, &loop_find_address, NULL);
+		visitor_set(&addresses, OP_CALL, &loop_find_address, NULL);
+		visitor_walk(&addresses, &info->function_body);
+		visitor_clear(&addresses);
+	}
+
+	hash_clear(&lf.writes);
+	vector_clear(&lf.locals);
+	vector_clear(&lf.indexes);
+	vector_clear(&lf.outer);
+	vector_clear(&lf.stores);
+	vector_clear(&lf.shifts);
+	return lf.is_simple;
+}
+
+/**
+ *	Emit metadata of vectorization hints for loop
+ *
+ *	@param	info		Encoder
+ *
+ *	@return	Number of loop metadata
+ */
+static size_t to_code_loop_hints(information *const info)
+{
+	// Подсказки общие для всех циклов модуля
+	if (info->loop_hints == 0)
+	{
+		info->loop_hints = info->debug_num;
+		info->debug_num += 2;
+		uni_printf(&info->debug, "!%zu = !{!\"llvm.loop.mustprogress\"}\n", info->loop_hints);
+		uni_printf(&info->debug, "!%zu = !{!\"llvm.loop.vectorize.enable\", i1 true}\n", info->loop_hints + 1);
+	}
+
+	const size_t loop = info->debug_num++;
+	uni_printf(&info->debug, "!%zu = distinct !{!%zu, !%zu, !%zu}\n", loop, loop, info->loop_hints, info->loop_hints + 1);
+	return loop;
+}
+
 /**
  *	Emit for statement
  *
@@ -2728,15 +5223,16 @@ static void emit_for_statement(information *const info, const node *const nd)
 		emit_statement(info, &inition);
 	}
 
+	const node body = statement_for_get_body(nd);
+	loop_hoist_stack_save(info, &body);
+
 	if (statement_for_has_condition(nd))
 	{
 		to_code_unconditional_branch(info, label_condition);
 		to_code_label(info, label_condition);
 
-		info->variable_location = LFREE;
 		const node condition = statement_for_get_condition(nd);
-		emit_expression(info, &condition);
-		check_type_and_branch(info, expression_get_type(&condition));
+		emit_condition(info, &condition);
 	}
 	else
 	{
@@ -2750,7 +5246,13 @@ static void emit_for_statement(information *const info, const node *const nd)
 		emit_expression(info, &increment);
 	}
 
-	if (statement_for_has_condition(nd))
+	if (loop_is_vectorizable(info, nd))
+	{
+		// Переход на условие замыкает цикл, к нему привязываются подсказки векторизации
+		const size_t hints = to_code_loop_hints(info);
+		uni_printf(info->sx->io, " br label %%label%zu, !llvm.loop !%zu\n", label_condition, hints);
+	}
+	else if (statement_for_has_condition(nd))
 	{
 		to_code_unconditional_branch(info, label_condition);
 	}
@@ -2760,7 +5262,7 @@ static void emit_for_statement(information *const info, const node *const nd)
 	}
 	to_code_label(info, label_body);
 
-	const node body = statement_for_get_body(nd);
+	to_code_counter(info, &body);
 	emit_statement(info, &body);
 
 	to_code_unconditional_branch(info, label_incr);
@@ -2798,7 +5300,13 @@ static void emit_return_statement(information *const info, const node *const nd)
 
 		// TODO: добавить обработку других ответов (ALOGIC)
 		const item_t answer_type = expression_get_type(&expression);
-		if (info->answer_kind == ACONST && type_is_integer(info->sx, answer_type))
+		if ((info->answer_kind == ACONST || info->answer_kind == ANULL) && type_is_pointer(info->sx, info->return_type))
+		{
+			uni_printf(info->sx->io, " ret ");
+			type_to_io(info, info->return_type);
+			uni_printf(info->sx->io, " null\n");
+		}
+		else if (info->answer_kind == ACONST && type_is_integer(info->sx, answer_type))
 		{
 			uni_printf(info->sx->io, " ret i32 %" PRIitem "\n", info->answer_const);
 		}
@@ -2806,6 +5314,17 @@ static void emit_return_statement(information *const info, const node *const nd)
 		{
 			uni_printf(info->sx->io, " ret double %f\n", info->answer_const_double);
 		}
+		else if (info->answer_kind == AREG && type_is_indirect(info, info->return_type))
+		{
+			// Результат записывается по указателю из первого аргумента
+			uni_printf(info->sx->io, " store ");
+			type_to_io(info, answer_type);
+			uni_printf(info->sx->io, " %%.%zu, ", info->answer_reg);
+			type_to_io(info, answer_type);
+			uni_printf(info->sx->io, "* %%0");
+			alignment_to_io(info, answer_type);
+			uni_printf(info->sx->io, " ret void\n");
+		}
 		else if (info->answer_kind == AREG)
 		{
 			uni_printf(info->sx->io, " ret ");
@@ -2820,18 +5339,19 @@ static void emit_return_statement(information *const info, const node *const nd)
 }
 
 /**
- *	Emit case statement
+ *	Emit default statement
  *
  *	@param	info		Encoder
  *	@param	nd			Node in AST
  */
 static void emit_default_statement(information *const info, const node *const nd)
 {
-	to_code_unconditional_branch(info, info->label_switch);
-	to_code_label(info, info->label_switch);
-	info->label_switch--;
+	info->label_default = info->label_num++;
+	to_code_unconditional_branch(info, info->label_default);
+	to_code_label(info, info->label_default);
 
 	const node substmt = statement_default_get_substmt(nd);
+	to_code_counter(info, &substmt);
 	emit_statement(info, &substmt);
 }
 
@@ -2843,69 +5363,117 @@ static void emit_default_statement(information *const info, const node *const nd
  */
 static void emit_case_statement(information *const info, const node *const nd)
 {
-	to_code_unconditional_branch(info, info->label_switch);
-	to_code_label(info, info->label_switch);
-	info->label_switch--;
+	const size_t label = info->label_num++;
+	const node expression = statement_case_get_expression(nd);
+	vector_add(&info->cases, (item_t)node_save(&expression));
+	vector_add(&info->cases, (item_t)label);
+
+	to_code_unconditional_branch(info, label);
+	to_code_label(info, label);
 
 	const node substmt = statement_case_get_substmt(nd);
+	to_code_counter(info, &substmt);
 	emit_statement(info, &substmt);
 }
 
 /**
- *	Emit switch statement
+ *	Emit switch statement.
+ *	Dispatch is emitted after body, when all case labels are known.
+ *	Literal cases go to single switch instruction, so LLVM can choose jump table itself,
+ *	others are compared one by one before it.
  *
  *	@param	info		Encoder
  *	@param	nd			Node in AST
  */
 static void emit_switch_statement(information *const info, const node *const nd)
 {
-	item_t case_values[MAX_CASES];
+	const size_t old_label_break = info->label_break;
+	const size_t old_label_default = info->label_default;
+	const size_t begin = vector_size(&info->cases);
+	const size_t label_dispatch = info->label_num++;
+	info->label_break = info->label_num++;
+	info->label_default = SIZE_MAX;
 
 	const node condition = statement_switch_get_condition(nd);
 	emit_expression(info, &condition);
 
+	// Значения case имеют тип int, поэтому условие типа char расширяется
+	size_t value = info->answer_reg;
+	if (info->answer_kind == ACONST)
+	{
+		uni_printf(info->sx->io, " %%.%zu = add i32 %" PRIitem ", 0\n", info->register_num, info->answer_const);
+		value = info->register_num++;
+	}
+	else if (type_get_class(info->sx, expression_get_type(&condition)) == TYPE_CHARACTER)
+	{
+		to_code_char_to_int(info, value);
+		value = info->register_num - 1;
+	}
+	to_code_unconditional_branch(info, label_dispatch);
+
+	// Тело не может сохранять стек, так как переход к меткам case его обходит
 	const node body = statement_switch_get_body(nd);
-	size_t case_num = 0;
-	int has_default = 0;
 	if (statement_get_class(&body) == STMT_COMPOUND)
 	{
-		const size_t size = statement_compound_get_size(&body);
-		for (size_t i = 0; i < size; i++)
+		emit_compound_statement(info, &body, true);
+	}
+	else
+	{
+		emit_statement(info, &body);
+	}
+	to_code_unconditional_branch(info, info->label_break);
+
+	to_code_label(info, label_dispatch);
+	const size_t end = vector_size(&info->cases);
+	size_t literals = 0;
+	for (size_t i = begin; i < end; i += 2)
+	{
+		const node expression = node_load(&info->sx->tree, (size_t)vector_get(&info->cases, i));
+		if (expression_get_class(&expression) == EXPR_LITERAL)
 		{
-			const node substmt = statement_compound_get_substmt(&body, i);
+			literals++;
+			continue;
+		}
 
-			if (statement_get_class(&substmt) == STMT_CASE)
+		emit_expression(info, &expression);
+		if (info->answer_kind == ACONST)
+		{
+			to_code_operation_reg_const_integer(info, BIN_EQ, value, info->answer_const, TYPE_INTEGER);
+		}
+		else
+		{
+			if (type_get_class(info->sx, expression_get_type(&expression)) == TYPE_CHARACTER)
 			{
-				const node expr = statement_case_get_expression(&substmt);
-				emit_expression(info, &expr);
-
-				case_values[case_num] = info->answer_const;
-				case_num++;
+				to_code_char_to_int(info, info->answer_reg);
+				info->answer_reg = info->register_num - 1;
 			}
-			else if (statement_get_class(&substmt) == STMT_DEFAULT)
-			{
-				has_default = 1;
-			}	
+			to_code_operation_reg_reg(info, BIN_EQ, value, info->answer_reg, TYPE_INTEGER);
 		}
+
+		const size_t label_next = info->label_num++;
+		uni_printf(info->sx->io, " br i1 %%.%zu, label %%label%zu, label %%label%zu\n"
+			, info->register_num++, (size_t)vector_get(&info->cases, i + 1), label_next);
+		to_code_label(info, label_next);
 	}
 
-	uni_printf(info->sx->io, " switch ");
-	type_to_io(info, expression_get_type(&condition));
-	uni_printf(info->sx->io, " %%.%zu, label %%label%zu [\n", info->answer_reg, info->label_switch - case_num - has_default);
-	for (size_t i = 0; i < case_num; i++)
+	const size_t label_default = info->label_default != SIZE_MAX ? info->label_default : info->label_break;
+	uni_printf(info->sx->io, " switch i32 %%.%zu, label %%label%zu [", value, label_default);
+	for (size_t i = begin; literals != 0 && i < end; i += 2)
 	{
-		uni_printf(info->sx->io, "  ");
-		type_to_io(info, expression_get_type(&condition));
-		uni_printf(info->sx->io, " %" PRIitem ", label %%label%zu\n", case_values[i], info->label_switch - i);
+		const node expression = node_load(&info->sx->tree, (size_t)vector_get(&info->cases, i));
+		if (expression_get_class(&expression) == EXPR_LITERAL)
+		{
+			uni_printf(info->sx->io, " i32 %" PRIi64 ", label %%label%zu"
+				, expression_literal_get_integer(&expression), (size_t)vector_get(&info->cases, i + 1));
+		}
 	}
 	uni_printf(info->sx->io, " ]\n");
 
-	info->label_break = info->label_switch - case_num - has_default;
-	if (statement_get_class(&body) == STMT_COMPOUND)
-	{
-		emit_compound_statement(info, &body, true);
-	}
 	to_code_label(info, info->label_break);
+	vector_resize(&info->cases, begin);
+
+	info->label_break = old_label_break;
+	info->label_default = old_label_default;
 }
 
 /**
@@ -2932,6 +5500,11 @@ static void emit_declaration_statement(information *const info, const node *cons
  */
 static void emit_statement(information *const info, const node *const nd)
 {
+	if (statement_get_class(nd) != STMT_COMPOUND)
+	{
+		to_code_location(info, node_get_location(nd));
+	}
+
 	switch (statement_get_class(nd))
 	{
 		case STMT_DECL:
@@ -2951,7 +5524,7 @@ static void emit_statement(information *const info, const node *const nd)
 			return;
 
 		case STMT_EXPR:
-			emit_expression(info, nd);
+			emit_expression_statement(info, nd);
 			return;
 
 		case STMT_NULL:
@@ -2995,6 +5568,68 @@ static void emit_statement(information *const info, const node *const nd)
 	}
 }
 
+/**
+ *	Emit definitions of heap arena for large dynamic arrays,
+ *	each block is linked to previous one through its header
+ *
+ *	@param	info		Encoder
+ */
+static void arena_definition(information *const info)
+{
+	const size_t word = info->target->word == item_int64 ? 64 : 32;
+	const size_t align = info->target->pointer_size;
+	uni_printf(info->sx->io, "declare i8* @malloc(i%zu)\n"
+		"declare void @free(i8*)\n", word);
+
+	uni_printf(info->sx->io, "define internal i8* @ruc.arena_alloc(i8** %%head, i%zu %%size) {\n"
+		"entry:\n"
+		" %%full = add i%zu %%size, %zu\n"
+		" %%block = call i8* @malloc(i%zu %%full)\n"
+		" %%old = load i8*, i8** %%head, align %zu\n"
+		" %%link = bitcast i8* %%block to i8**\n"
+		" store i8* %%old, i8** %%link, align %zu\n"
+		" store i8* %%block, i8** %%head, align %zu\n"
+		" %%memory = getelementptr inbounds i8, i8* %%block, i%zu %zu\n"
+		" ret i8* %%memory\n"
+		"}\n", word, word, ARENA_HEADER_SIZE, word, align, align, align, word, ARENA_HEADER_SIZE);
+
+	// Блоки освобождаются от вершины до отметки, сохранённой при входе в область
+	uni_printf(info->sx->io, "define internal void @ruc.arena_reset(i8** %%head, i8* %%mark) {\n"
+		"entry:\n"
+		" br label %%check\n"
+		"check:\n"
+		" %%block = load i8*, i8** %%head, align %zu\n"
+		" %%is_done = icmp eq i8* %%block, %%mark\n"
+		" br i1 %%is_done, label %%done, label %%release\n"
+		"release:\n"
+		" %%link = bitcast i8* %%block to i8**\n"
+		" %%next = load i8*, i8** %%link, align %zu\n"
+		" store i8* %%next, i8** %%head, align %zu\n"
+		" call void @free(i8* %%block)\n"
+		" br label %%check\n"
+		"done:\n"
+		" ret void\n"
+		"}\n", align, align, align);
+}
+
+/**
+ *	Move output of current part of translation unit to parts and start new part
+ *
+ *	@param	info		Encoder
+ *	@param	parts		Outputs of parts in order of declarations
+ */
+static void part_flush(information *const info, strings *const parts)
+{
+	char *const text = out_extract_buffer(info->sx->io);
+	if (text[0] != '\0')
+	{
+		strings_add(parts, text);
+	}
+
+	free(text);
+	out_set_buffer(info->sx->io, FUNCTION_BUFFER_SIZE);
+}
+
 /**
  *	Emit translation unit
  *
@@ -3003,12 +5638,40 @@ static void emit_statement(information *const info, const node *const nd)
  */
 static int emit_translation_unit(information *const info, const node *const nd)
 {
+	// Каждое определение функции выводится в свой буфер, буферы сливаются в порядке описаний
 	const size_t size = translation_unit_get_size(nd);
+	strings parts = strings_create(size + 1);
+	universal_io part = io_create();
+	out_set_buffer(&part, FUNCTION_BUFFER_SIZE);
+	out_swap(info->sx->io, &part);
+
 	for (size_t i = 0; i < size; i++)
 	{
 		const node decl = translation_unit_get_declaration(nd, i);
+		const bool is_function = declaration_get_class(&decl) == DECL_FUNC;
+		if (is_function)
+		{
+			part_flush(info, &parts);
+		}
+
 		emit_declaration(info, &decl, false);
+
+		if (is_function)
+		{
+			part_flush(info, &parts);
+		}
+	}
+
+	part_flush(info, &parts);
+	out_swap(info->sx->io, &part);
+	io_erase(&part);
+
+	for (size_t i = 0; i < strings_size(&parts); i++)
+	{
+		const char *const text = strings_get(&parts, i);
+		out_write(info->sx->io, text, strlen(text));
 	}
+	strings_clear(&parts);
 
 	// FIXME: если это тоже объявление функций, почему тут, а не в functions_declaration?
 	if (info->was_stack_functions)
@@ -3017,17 +5680,24 @@ static int emit_translation_unit(information *const info, const node *const nd)
 		uni_printf(info->sx->io, "declare void @llvm.stackrestore(i8*)\n");
 	}
 
+	if (info->was_arena)
+	{
+		arena_definition(info);
+	}
+
 	if (info->was_file)
 	{
+		// Размеры long и size_t, а с ними и хвост структуры, зависят от платформы
+		const size_t word = info->target->word == item_int64 ? 64 : 32;
 		uni_printf(info->sx->io, "%%struct._IO_FILE = type { i32, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, i8*, "
-			"%%struct._IO_marker*, %%struct._IO_FILE*, i32, i32, i64, i16, i8, [1 x i8], i8*, i64, i8*, i8*, i8*, i8*, "
-			"i64, i32, [20 x i8] }\n");
+			"%%struct._IO_marker*, %%struct._IO_FILE*, i32, i32, i%zu, i16, i8, [1 x i8], i8*, i64, i8*, i8*, i8*, i8*, "
+			"i%zu, i32, [%zu x i8] }\n", word, word, 15 * 4 - 5 * info->target->pointer_size);
 		uni_printf(info->sx->io, "%%struct._IO_marker = type { %%struct._IO_marker*, %%struct._IO_FILE*, i32 }\n");
 	}
 
 	if (info->was_abs)
 	{
-		uni_printf(info->sx->io, "declare i32 @abs(i32)\n");
+		uni_printf(info->sx->io, "declare i32 @llvm.abs.i32(i32, i1)\n");
 	}
 
 	if (info->was_fabs)
@@ -3035,33 +5705,94 @@ static int emit_translation_unit(information *const info, const node *const nd)
 		uni_printf(info->sx->io, "declare double @llvm.fabs.f64(double)\n");
 	}
 
+	if (info->was_assume)
+	{
+		uni_printf(info->sx->io, "declare void @llvm.assume(i1)\n");
+	}
+
+	if (info->was_memcpy)
+	{
+		uni_printf(info->sx->io, "declare void @llvm.memcpy.p0i8.p0i8.i64(i8*, i8*, i64, i1)\n");
+	}
+
+	if (info->was_memset)
+	{
+		uni_printf(info->sx->io, "declare void @llvm.memset.p0i8.i64(i8*, i8, i64, i1)\n");
+	}
+
+	char *const constants = out_extract_buffer(&info->constants);
+	out_write(info->sx->io, constants, strlen(constants));
+	free(constants);
+
 
 	#ifdef _WIN32
 		uni_printf(info->sx->io, "!llvm.linker.options = !{!0}\n");
 		uni_printf(info->sx->io, "!0 = !{!\"/STACK:268435456\"}\n");
 	#endif
 
-	return info->sx->rprt.errors != 0;
+	return reporter_get_errors_number(&info->sx->rprt) != 0;
+}
+
+static void architecture(const workspace *const ws, information *const info)
+{
+	info->target = &TARGETS[0];
+	for (size_t i = 1; i < sizeof(TARGETS) / sizeof(target); i++)
+	{
+		if (ws_has_flag(ws, TARGETS[i].flag))
+		{
+			info->target = &TARGETS[i];
+		}
+	}
+
+	uni_printf(info->sx->io, "target datalayout = \"%s\"\n", info->target->datalayout);
+	uni_printf(info->sx->io, "target triple = \"%s\"\n\n", info->target->triple);
 }
 
-static void architecture(const workspace *const ws, syntax *const sx)
+static void tbaa_declaration(information *const info)
 {
-	if (ws_has_flag(ws, "--mipsel"))
+	// Дерево типов: все типы вложены в char, который может совпадать по памяти с любым
+	uni_printf(info->sx->io, "\n!%zu = !{!\"RuC TBAA\"}\n", TBAA_ROOT);
+	for (size_t i = 0; i < TBAA_NONE; i++)
+	{
+		uni_printf(info->sx->io, "!%zu = !{!\"%s\", !%zu, i64 0}\n", TBAA_ROOT + 1 + i, TBAA_NAMES[i]
+			, i == TBAA_CHARACTER ? TBAA_ROOT : TBAA_ROOT + 1 + TBAA_CHARACTER);
+	}
+
+	for (size_t i = 0; i < TBAA_NONE; i++)
 	{
-		uni_printf(sx->io, "target datalayout = \"e-m:m-p:32:32-i8:8:32-i16:16:32-i64:64-n32-S64\"\n");
-		uni_printf(sx->io, "target triple = \"mipsel\"\n\n");
+		uni_printf(info->sx->io, "!%zu = !{!%zu, !%zu, i64 0}\n", TBAA_ROOT + 1 + TBAA_NONE + i
+			, TBAA_ROOT + 1 + i, TBAA_ROOT + 1 + i);
 	}
-	else // if (ws_has_flag(ws, "--x86_64"))
+}
+
+static void debug_declaration(information *const info)
+{
+	if (info->is_debug)
 	{
-		uni_printf(sx->io, "target datalayout = \"e-m:e-i64:64-f80:128-n8:16:32:64-S128\"\n");
-		uni_printf(sx->io, "target triple = \"x86_64-pc-linux-gnu\"\n\n");
+		uni_printf(info->sx->io, "\n!llvm.dbg.cu = !{!%zu}\n", info->debug_unit);
+		uni_printf(info->sx->io, "!llvm.module.flags = !{!%zu, !%zu}\n", info->debug_unit + 4, info->debug_unit + 5);
+
+		uni_printf(info->sx->io, "!%zu = distinct !DICompileUnit(language: DW_LANG_C99, file: !%zu, producer: \"RuC\""
+			", isOptimized: false, runtimeVersion: 0, emissionKind: LineTablesOnly)\n", info->debug_unit, info->debug_unit + 1);
+		uni_printf(info->sx->io, "!%zu = !DIFile(filename: \"", info->debug_unit + 1);
+		debug_string_to_io(info->sx->io, info->debug_path);
+		uni_printf(info->sx->io, "\", directory: \"\")\n");
+		uni_printf(info->sx->io, "!%zu = !DISubroutineType(types: !%zu)\n", info->debug_unit + 2, info->debug_unit + 3);
+		uni_printf(info->sx->io, "!%zu = !{}\n", info->debug_unit + 3);
+		uni_printf(info->sx->io, "!%zu = !{i32 7, !\"Dwarf Version\", i32 4}\n", info->debug_unit + 4);
+		uni_printf(info->sx->io, "!%zu = !{i32 2, !\"Debug Info Version\", i32 3}\n", info->debug_unit + 5);
 	}
+
+	// Метаданные циклов выводятся и без отладочной информации
+	char *const nodes = out_extract_buffer(&info->debug);
+	out_write(info->sx->io, nodes, strlen(nodes));
+	free(nodes);
 }
 
 static void structs_declaration(information *const info)
 {
 	const size_t types = vector_size(&info->sx->types);
-	for (size_t i = 0; i < types; i++)
+	for (size_t i = info->types; i < types; i++)
 	{
 		if (type_is_structure(info->sx, (item_t)i))
 		{
@@ -3071,7 +5802,8 @@ static void structs_declaration(information *const info)
 			for (size_t j = 0; j < fields; j++)
 			{
 				uni_printf(info->sx->io, j == 0 ? "" : ", ");
-				const item_t type_structure_field = type_structure_get_member_type(info->sx, (item_t)i, j);
+				const size_t member = type_get_field(info, (item_t)i, j, true);
+				const item_t type_structure_field = type_structure_get_member_type(info->sx, (item_t)i, member);
 
 				if (type_is_array(info->sx, type_structure_field))
 				{
@@ -3088,44 +5820,599 @@ static void structs_declaration(information *const info)
 			uni_printf(info->sx->io, " }\n");
 		}
 	}
-	uni_printf(info->sx->io, " \n");
+	uni_printf(info->sx->io, " \n");
+	info->types = types;
+}
+
+static void strings_declaration(information *const info)
+{
+	const size_t amount = strings_amount(info->sx);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const char *string = string_get(info->sx, i);
+		const size_t length = strings_length(info->sx, i);
+		uni_printf(info->sx->io, "@.str%zu = private unnamed_addr constant [%zu x i8] c\""
+			, i, length + 1);
+
+		for (size_t j = 0; j < length; j++)
+		{
+			// Кавычки, обратная косая черта и управляющие литеры записываются кодами
+			const unsigned char ch = (unsigned char)string[j];
+			if (ch < ' ' || ch == '"' || ch == '\\' || ch == 0x7F)
+			{
+				uni_printf(info->sx->io, "\\%02X", ch);
+			}
+			else
+			{
+				uni_printf(info->sx->io, "%c", ch);
+			}
+		}
+		uni_printf(info->sx->io, "\\00\", align 1\n");
+	}
+	uni_printf(info->sx->io, " \n");
+}
+
+/**
+ *	Emit function of global array initialization, which is called from main
+ *
+ *	@param	info		Encoder
+ *	@param	nd			Declaration of array
+ */
+static void emit_initialization_function(information *const info, const node *const nd)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	info->register_num = 1;
+	info->label_num = 1;
+	uni_printf(info->sx->io, "define internal void @.init.%zu() nounwind {\n", id);
+
+	universal_io buffer = io_create();
+	out_set_buffer(&buffer, FUNCTION_BUFFER_SIZE);
+	out_swap(info->sx->io, &buffer);
+
+	info->allocas = io_create();
+	out_set_buffer(&info->allocas, FUNCTION_BUFFER_SIZE);
+
+	emit_global_initialization(info, nd);
+	uni_printf(info->sx->io, " ret void\n");
+	uni_printf(info->sx->io, "}\n\n");
+
+	out_swap(info->sx->io, &buffer);
+	char *const allocas = out_extract_buffer(&info->allocas);
+	char *const text = out_extract_buffer(&buffer);
+
+	out_write(info->sx->io, allocas, strlen(allocas));
+	out_write(info->sx->io, text, strlen(text));
+
+	free(allocas);
+	free(text);
+	io_erase(&info->allocas);
+	io_erase(&buffer);
+}
+
+/**
+ *	Emit external declaration right after its parsing
+ *
+ *	@param	context		Encoder
+ *	@param	nd			External declaration
+ *
+ *	@return	@c 0 on success
+ */
+static int emit_streaming_declaration(void *const context, const node *const nd)
+{
+	information *const info = context;
+
+	// Структуры используются в инструкциях, поэтому описываются до них
+	if (info->types != vector_size(&info->sx->types))
+	{
+		structs_declaration(info);
+	}
+	emit_declaration(info, nd, false);
+
+	if (has_global_initialization(info, nd))
+	{
+		emit_initialization_function(info, nd);
+		vector_add(&info->inits, (item_t)declaration_variable_get_id(nd));
+	}
+
+	return 0;
+}
+
+/**
+ *	Emit function, which calls initialization functions of global arrays
+ *
+ *	@param	info		Encoder
+ */
+static void initialization_definition(information *const info)
+{
+	uni_printf(info->sx->io, "define internal void @.init() nounwind {\n");
+	for (size_t i = 0; i < vector_size(&info->inits); i++)
+	{
+		uni_printf(info->sx->io, " call void @.init.%" PRIitem "()\n", vector_get(&info->inits, i));
+	}
+	uni_printf(info->sx->io, " ret void\n}\n\n");
+}
+
+
+/**
+ *	Emit definition of block file function through C library one
+ *
+ *	@param	info		Encoder
+ *	@param	func		Block file function
+ */
+static void block_io_definition(information *const info, const size_t func)
+{
+	const size_t word = info->target->word == item_int64 ? 64 : 32;
+	const bool is_chars = func == BI_FREAD_CHARS || func == BI_FWRITE_CHARS;
+	const bool is_read = func == BI_FREAD_CHARS || func == BI_FREAD_INTS;
+
+	uni_printf(info->sx->io, "define internal i32 @");
+	func_name_to_io(info, func);
+	uni_printf(info->sx->io, "(%s %%buffer, i32 %%n, %%struct._IO_FILE* %%file) {\n", is_chars ? "i8*" : "i32*");
+	if (!is_chars)
+	{
+		uni_printf(info->sx->io, " %%bytes = bitcast i32* %%buffer to i8*\n");
+	}
+
+	if (word == 64)
+	{
+		uni_printf(info->sx->io, " %%count = sext i32 %%n to i64\n");
+	}
+
+	// Элементы переносятся одним вызовом библиотеки, а не по одной литере
+	uni_printf(info->sx->io, " %%done = call i%zu @%s(i8* %%%s, i%zu %zu, i%zu %%%s, %%struct._IO_FILE* %%file)\n"
+		, word, is_read ? "fread" : "fwrite", is_chars ? "buffer" : "bytes", word, is_chars ? (size_t)1 : (size_t)4
+		, word, word == 64 ? "count" : "n");
+	if (word == 64)
+	{
+		uni_printf(info->sx->io, " %%ret = trunc i64 %%done to i32\n ret i32 %%ret\n}\n");
+	}
+	else
+	{
+		uni_printf(info->sx->io, " ret i32 %%done\n}\n");
+	}
+}
+
+/**
+ *	Emit definition of line reading function, it returns length of read line
+ *
+ *	@param	info		Encoder
+ */
+static void fgetline_definition(information *const info)
+{
+	uni_printf(info->sx->io, "define internal i32 @");
+	func_name_to_io(info, BI_FGETLINE);
+	uni_printf(info->sx->io, "(i8* %%buffer, i32 %%n, %%struct._IO_FILE* %%file) {\n"
+		"entry:\n"
+		" %%line = call i8* @fgets(i8* %%buffer, i32 %%n, %%struct._IO_FILE* %%file)\n"
+		" %%is_eof = icmp eq i8* %%line, null\n"
+		" br i1 %%is_eof, label %%eof, label %%loop\n"
+		"loop:\n"
+		" %%i = phi i32 [ 0, %%entry ], [ %%next, %%loop ]\n"
+		" %%pointer = getelementptr inbounds i8, i8* %%buffer, i32 %%i\n"
+		" %%char = load i8, i8* %%pointer\n"
+		" %%next = add nsw i32 %%i, 1\n"
+		" %%is_end = icmp eq i8 %%char, 0\n"
+		" br i1 %%is_end, label %%end, label %%loop\n"
+		"end:\n"
+		" ret i32 %%i\n"
+		"eof:\n"
+		" ret i32 0\n"
+		"}\n");
+}
+
+/**
+ *	Emit definition of string function through C library one,
+ *	library functions scan strings by machine words
+ *
+ *	@param	info		Encoder
+ *	@param	func		String function
+ */
+static void string_definition(information *const info, const size_t func)
+{
+	const size_t word = info->target->word == item_int64 ? 64 : 32;
+	uni_printf(info->sx->io, "define internal i32 @");
+	func_name_to_io(info, func);
+
+	if (func == BI_STRLEN)
+	{
+		uni_printf(info->sx->io, "(i8* %%string) {\n"
+			" %%length = call i%zu @strlen(i8* %%string)\n", word);
+		uni_printf(info->sx->io, word == 64 ? " %%ret = trunc i64 %%length to i32\n ret i32 %%ret\n}\n"
+			: " ret i32 %%length\n}\n");
+		return;
+	}
+
+	// Вместо указателя на вхождение возвращается его индекс, при отсутствии вхождения -1
+	uni_printf(info->sx->io, "(i8* %%string, i8* %%substring) {\n"
+		"entry:\n"
+		" %%found = call i8* @strstr(i8* %%string, i8* %%substring)\n"
+		" %%is_null = icmp eq i8* %%found, null\n"
+		" br i1 %%is_null, label %%absent, label %%present\n"
+		"present:\n"
+		" %%begin = ptrtoint i8* %%string to i%zu\n"
+		" %%end = ptrtoint i8* %%found to i%zu\n"
+		" %%offset = sub i%zu %%end, %%begin\n", word, word, word);
+	uni_printf(info->sx->io, word == 64 ? " %%index = trunc i64 %%offset to i32\n ret i32 %%index\n"
+		: " ret i32 %%offset\n");
+	uni_printf(info->sx->io, "absent:\n"
+		" ret i32 -1\n"
+		"}\n");
+}
+
+/**
+ *	Emit function, which writes execution counters into profile file at exit of program
+ *
+ *	@param	info		Encoder
+ */
+static void profile_declaration(information *const info)
+{
+	if (!info->is_profiling)
+	{
+		return;
+	}
+
+	// Файловые функции объявлены, если их использует программа
+	if (!info->was_function[BI_FOPEN])
+	{
+		uni_printf(info->sx->io, "declare %%struct._IO_FILE* @fopen(i8*, i8*)\n");
+	}
+
+	if (!info->was_function[BI_FCLOSE])
+	{
+		uni_printf(info->sx->io, "declare i32 @fclose(%%struct._IO_FILE*)\n");
+	}
+
+	const size_t length = strlen(DEFAULT_EXECUTION_PROFILE) + 1;
+	uni_printf(info->sx->io, "declare i32 @fprintf(%%struct._IO_FILE*, i8*, ...)\n"
+		"@.prof.path = private unnamed_addr constant [%zu x i8] c\"%s\\00\", align 1\n"
+		"@.prof.mode = private unnamed_addr constant [2 x i8] c\"w\\00\", align 1\n"
+		"@.prof.format = private unnamed_addr constant [9 x i8] c\"%%lld %%s\\0A\\00\", align 1\n"
+		, length, DEFAULT_EXECUTION_PROFILE);
+
+	// Деструкторы модуля вызываются и при выходе через exit
+	uni_printf(info->sx->io, "@llvm.global_dtors = appending global [1 x { i32, void ()*, i8* }] "
+		"[{ i32, void ()*, i8* } { i32 65535, void ()* @.prof.dump, i8* null }]\n"
+		"define internal void @.prof.dump() {\n"
+		"entry:\n"
+		" %%file = call %%struct._IO_FILE* @fopen(i8* getelementptr inbounds ([%zu x i8], [%zu x i8]* @.prof.path"
+		", i32 0, i32 0), i8* getelementptr inbounds ([2 x i8], [2 x i8]* @.prof.mode, i32 0, i32 0))\n"
+		" %%is_null = icmp eq %%struct._IO_FILE* %%file, null\n"
+		" br i1 %%is_null, label %%end, label %%dump\n"
+		"dump:\n", length, length);
+
+	char *const counters = out_extract_buffer(&info->profile);
+	out_write(info->sx->io, counters, strlen(counters));
+	free(counters);
+
+	uni_printf(info->sx->io, " %%closed = call i32 @fclose(%%struct._IO_FILE* %%file)\n"
+		" br label %%end\n"
+		"end:\n"
+		" ret void\n"
+		"}\n");
+}
+
+/**
+ *	Emit definition of atomic function through atomic instruction
+ *
+ *	@param	info		Encoder
+ *	@param	func		Atomic function
+ */
+static void atomic_definition(information *const info, const size_t func)
+{
+	uni_printf(info->sx->io, "define internal %s @", func == BI_ATOMIC_STORE ? "void" : "i32");
+	func_name_to_io(info, func);
+
+	switch (func)
+	{
+		case BI_ATOMIC_ADD:
+			uni_printf(info->sx->io, "(i32* %%pointer, i32 %%value) {\n"
+				" %%old = atomicrmw add i32* %%pointer, i32 %%value seq_cst\n"
+				" ret i32 %%old\n"
+				"}\n");
+			return;
+
+		case BI_ATOMIC_CAS:
+			uni_printf(info->sx->io, "(i32* %%pointer, i32 %%expected, i32 %%desired) {\n"
+				" %%pair = cmpxchg i32* %%pointer, i32 %%expected, i32 %%desired seq_cst seq_cst\n"
+				" %%old = extractvalue { i32, i1 } %%pair, 0\n"
+				" ret i32 %%old\n"
+				"}\n");
+			return;
+
+		case BI_ATOMIC_LOAD:
+			uni_printf(info->sx->io, "(i32* %%pointer) {\n"
+				" %%value = load atomic i32, i32* %%pointer acquire, align 4\n"
+				" ret i32 %%value\n"
+				"}\n");
+			return;
+
+		default:
+			uni_printf(info->sx->io, "(i32* %%pointer, i32 %%value) {\n"
+				" store atomic i32 %%value, i32* %%pointer release, align 4\n"
+				" ret void\n"
+				"}\n");
+			return;
+	}
+}
+
+/**
+ *	Emit definition of parallel loop over range through POSIX threads.
+ *	Iterations are taken by chunks from shared atomic counter,
+ *	so threads, which finish early, take the rest of work.
+ *
+ *	@param	info		Encoder
+ */
+static void parallel_for_definition(information *const info)
+{
+	const size_t word = info->target->word == item_int64 ? 64 : 32;
+	uni_printf(info->sx->io, "%%struct.ruc_loop = type { void (i32)*, i32, i32, i32 }\n"
+		"declare i32 @pthread_create(i%zu*, i8*, i8* (i8*)*, i8*)\n"
+		"declare i32 @pthread_join(i%zu, i8**)\n"
+		"declare i32 @get_nprocs()\n", word, word);
+
+	uni_printf(info->sx->io, "define internal i8* @ruc.parallel_worker(i8* %%argument) {\n"
+		"entry:\n"
+		" %%loop = bitcast i8* %%argument to %%struct.ruc_loop*\n"
+		" %%body_pointer = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 0\n"
+		" %%body = load void (i32)*, void (i32)** %%body_pointer, align 8\n"
+		" %%next = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 1\n"
+		" %%end_pointer = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 2\n"
+		" %%end = load i32, i32* %%end_pointer, align 4\n"
+		" %%chunk_pointer = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 3\n"
+		" %%chunk = load i32, i32* %%chunk_pointer, align 4\n"
+		" br label %%take\n"
+		"take:\n"
+		" %%begin = atomicrmw add i32* %%next, i32 %%chunk monotonic\n"
+		" %%is_done = icmp sge i32 %%begin, %%end\n"
+		" br i1 %%is_done, label %%done, label %%bounds\n"
+		"bounds:\n"
+		" %%chunk_end = add nsw i32 %%begin, %%chunk\n"
+		" %%is_last = icmp sgt i32 %%chunk_end, %%end\n"
+		" %%stop = select i1 %%is_last, i32 %%end, i32 %%chunk_end\n"
+		" br label %%iteration\n"
+		"iteration:\n"
+		" %%i = phi i32 [ %%begin, %%bounds ], [ %%i_next, %%iteration ]\n"
+		" call void %%body(i32 %%i)\n"
+		" %%i_next = add nsw i32 %%i, 1\n"
+		" %%is_chunk_end = icmp sge i32 %%i_next, %%stop\n"
+		" br i1 %%is_chunk_end, label %%take, label %%iteration\n"
+		"done:\n"
+		" ret i8* null\n"
+		"}\n");
+
+	// Вызывающая нить тоже выполняет итерации, поэтому создаётся на одну нить меньше числа процессоров
+	uni_printf(info->sx->io, "define internal void @");
+	func_name_to_io(info, BI_PARALLEL_FOR);
+	uni_printf(info->sx->io, "(void (i32)* %%body, i32 %%begin, i32 %%end) {\n"
+		"entry:\n"
+		" %%loop = alloca %%struct.ruc_loop, align 8\n"
+		" %%body_pointer = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 0\n"
+		" store void (i32)* %%body, void (i32)** %%body_pointer, align 8\n"
+		" %%next = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 1\n"
+		" store i32 %%begin, i32* %%next, align 4\n"
+		" %%end_pointer = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 2\n"
+		" store i32 %%end, i32* %%end_pointer, align 4\n"
+		" %%processors = call i32 @get_nprocs()\n"
+		" %%is_parallel = icmp sgt i32 %%processors, 1\n"
+		" %%threads = select i1 %%is_parallel, i32 %%processors, i32 1\n"
+		" %%count = sub nsw i32 %%end, %%begin\n"
+		" %%chunks = mul nsw i32 %%threads, %zu\n"
+		" %%size = sdiv i32 %%count, %%chunks\n"
+		" %%is_small = icmp slt i32 %%size, 1\n"
+		" %%chunk = select i1 %%is_small, i32 1, i32 %%size\n"
+		" %%chunk_pointer = getelementptr inbounds %%struct.ruc_loop, %%struct.ruc_loop* %%loop, i32 0, i32 3\n"
+		" store i32 %%chunk, i32* %%chunk_pointer, align 4\n"
+		" %%argument = bitcast %%struct.ruc_loop* %%loop to i8*\n"
+		" %%helpers = sub nsw i32 %%threads, 1\n"
+		" %%ids = alloca i%zu, i32 %%helpers, align 8\n"
+		" br label %%create_check\n"
+		"create_check:\n"
+		" %%k = phi i32 [ 0, %%entry ], [ %%k_next, %%created ]\n"
+		" %%is_creating = icmp slt i32 %%k, %%helpers\n"
+		" br i1 %%is_creating, label %%create, label %%work\n"
+		"create:\n"
+		" %%id = getelementptr inbounds i%zu, i%zu* %%ids, i32 %%k\n"
+		" %%status = call i32 @pthread_create(i%zu* %%id, i8* null, i8* (i8*)* @ruc.parallel_worker, i8* %%argument)\n"
+		" %%k_next = add nsw i32 %%k, 1\n"
+		" %%is_created = icmp eq i32 %%status, 0\n"
+		" br i1 %%is_created, label %%created, label %%work\n"
+		"created:\n"
+		" br label %%create_check\n"
+		"work:\n"
+		" %%started = phi i32 [ %%k, %%create_check ], [ %%k, %%create ]\n"
+		" %%own = call i8* @ruc.parallel_worker(i8* %%argument)\n"
+		" br label %%join_check\n"
+		"join_check:\n"
+		" %%j = phi i32 [ 0, %%work ], [ %%j_next, %%join ]\n"
+		" %%is_joining = icmp slt i32 %%j, %%started\n"
+		" br i1 %%is_joining, label %%join, label %%finish\n"
+		"join:\n"
+		" %%joined_id = getelementptr inbounds i%zu, i%zu* %%ids, i32 %%j\n"
+		" %%joined = load i%zu, i%zu* %%joined_id, align 8\n"
+		" %%join_status = call i32 @pthread_join(i%zu %%joined, i8** null)\n"
+		" %%j_next = add nsw i32 %%j, 1\n"
+		" br label %%join_check\n"
+		"finish:\n"
+		" ret void\n"
+		"}\n", CHUNKS_PER_THREAD, word, word, word, word, word, word, word, word, word);
+}
+
+/**
+ *	Emit definitions of channel functions.
+ *	Each channel is a lock-free ring with single writer and single reader,
+ *	it passes integer handles, so bulk data stays in place and is not copied.
+ *
+ *	@param	info		Encoder
+ */
+static void channel_definition(information *const info)
+{
+	// Индексы чтения и записи разнесены по разным строкам кэша
+	uni_printf(info->sx->io, "%%struct.ruc_channel = type { i32, [15 x i32], i32, [15 x i32], [%zu x i32] }\n"
+		"@ruc.channels = %s global [%zu x %%struct.ruc_channel] zeroinitializer, align 64\n"
+		"declare i32 @sched_yield()\n", CHANNEL_CAPACITY, info->is_separate ? "common" : "internal", CHANNELS);
+
+	uni_printf(info->sx->io, "define internal void @");
+	func_name_to_io(info, BI_CHAN_SEND);
+	uni_printf(info->sx->io, "(i32 %%channel, i32 %%value) {\n"
+		"entry:\n"
+		" %%number = and i32 %%channel, %zu\n"
+		" %%head = getelementptr inbounds [%zu x %%struct.ruc_channel], [%zu x %%struct.ruc_channel]* @ruc.channels"
+		", i32 0, i32 %%number, i32 0\n"
+		" %%tail = getelementptr inbounds [%zu x %%struct.ruc_channel], [%zu x %%struct.ruc_channel]* @ruc.channels"
+		", i32 0, i32 %%number, i32 2\n"
+		" %%written = load atomic i32, i32* %%tail monotonic, align 4\n"
+		" br label %%wait\n"
+		"wait:\n"
+		" %%read = load atomic i32, i32* %%head acquire, align 4\n"
+		" %%size = sub i32 %%written, %%read\n"
+		" %%is_full = icmp uge i32 %%size, %zu\n"
+		" br i1 %%is_full, label %%yield, label %%write\n"
+		"yield:\n"
+		" %%yielded = call i32 @sched_yield()\n"
+		" br label %%wait\n"
+		"write:\n"
+		" %%index = and i32 %%written, %zu\n"
+		" %%slot = getelementptr inbounds [%zu x %%struct.ruc_channel], [%zu x %%struct.ruc_channel]* @ruc.channels"
+		", i32 0, i32 %%number, i32 4, i32 %%index\n"
+		" store i32 %%value, i32* %%slot, align 4\n"
+		" %%next = add i32 %%written, 1\n"
+		" store atomic i32 %%next, i32* %%tail release, align 4\n"
+		" ret void\n"
+		"}\n", CHANNELS - 1, CHANNELS, CHANNELS, CHANNELS, CHANNELS, CHANNEL_CAPACITY
+		, CHANNEL_CAPACITY - 1, CHANNELS, CHANNELS);
+
+	uni_printf(info->sx->io, "define internal i32 @");
+	func_name_to_io(info, BI_CHAN_RECEIVE);
+	uni_printf(info->sx->io, "(i32 %%channel) {\n"
+		"entry:\n"
+		" %%number = and i32 %%channel, %zu\n"
+		" %%head = getelementptr inbounds [%zu x %%struct.ruc_channel], [%zu x %%struct.ruc_channel]* @ruc.channels"
+		", i32 0, i32 %%number, i32 0\n"
+		" %%tail = getelementptr inbounds [%zu x %%struct.ruc_channel], [%zu x %%struct.ruc_channel]* @ruc.channels"
+		", i32 0, i32 %%number, i32 2\n"
+		" %%read = load atomic i32, i32* %%head monotonic, align 4\n"
+		" br label %%wait\n"
+		"wait:\n"
+		" %%written = load atomic i32, i32* %%tail acquire, align 4\n"
+		" %%is_empty = icmp eq i32 %%written, %%read\n"
+		" br i1 %%is_empty, label %%yield, label %%take\n"
+		"yield:\n"
+		" %%yielded = call i32 @sched_yield()\n"
+		" br label %%wait\n"
+		"take:\n"
+		" %%index = and i32 %%read, %zu\n"
+		" %%slot = getelementptr inbounds [%zu x %%struct.ruc_channel], [%zu x %%struct.ruc_channel]* @ruc.channels"
+		", i32 0, i32 %%number, i32 4, i32 %%index\n"
+		" %%value = load i32, i32* %%slot, align 4\n"
+		" %%next = add i32 %%read, 1\n"
+		" store atomic i32 %%next, i32* %%head release, align 4\n"
+		" ret i32 %%value\n"
+		"}\n", CHANNELS - 1, CHANNELS, CHANNELS, CHANNELS, CHANNELS, CHANNEL_CAPACITY - 1, CHANNELS, CHANNELS);
+}
+
+/**
+ *	Emit declarations of functions, which are defined in other modules of program
+ *
+ *	@param	info		Encoder
+ */
+static void prototypes_declaration(information *const info)
+{
+	if (!info->is_separate)
+	{
+		return;
+	}
+
+	// Прототипы без определений остаются в списке предописаний
+	for (size_t i = 0; i < vector_size(&info->sx->predef); i++)
+	{
+		const item_t repr = vector_get(&info->sx->predef, i);
+		if (repr == 0)
+		{
+			continue;
+		}
+
+		const size_t id = (size_t)repr_get_reference(info->sx, (size_t)repr);
+		const item_t func_type = ident_get_type(info->sx, id);
+		const item_t ret_type = type_function_get_return_type(info->sx, func_type);
+
+		uni_printf(info->sx->io, "declare ");
+		type_to_io(info, type_is_indirect(info, ret_type) ? TYPE_VOID : ret_type);
+		uni_printf(info->sx->io, " @");
+		func_name_to_io(info, id);
+		parameters_to_io(info, func_type);
+		uni_printf(info->sx->io, "\n");
+	}
 }
 
-static void strings_declaration(information *const info)
+static void builin_functions_declaration(information *const info)
 {
-	const size_t amount = strings_amount(info->sx);
-	for (size_t i = 0; i < amount; i++)
+	// Блочные файловые функции реализованы через fread, fwrite и fgets
+	const size_t word = info->target->word == item_int64 ? 64 : 32;
+	if (info->was_function[BI_FREAD_CHARS] || info->was_function[BI_FREAD_INTS])
 	{
-		const char *string = string_get(info->sx, i);
-		const size_t length = strings_length(info->sx, i);
-		uni_printf(info->sx->io, "@.str%zu = private unnamed_addr constant [%zu x i8] c\""
-			, i, length + 1);
+		uni_printf(info->sx->io, "declare i%zu @fread(i8*, i%zu, i%zu, %%struct._IO_FILE*)\n", word, word, word);
+	}
 
-		for (size_t j = 0; j < length; j++)
-		{
-			const char ch = string[j];
-			if (ch == '\n')
-			{
-				uni_printf(info->sx->io, "\\0A");
-			}
-			else
-			{
-				uni_printf(info->sx->io, "%c", ch);
-			}
-		}
-		uni_printf(info->sx->io, "\\00\", align 1\n");
+	if (info->was_function[BI_FWRITE_CHARS] || info->was_function[BI_FWRITE_INTS])
+	{
+		uni_printf(info->sx->io, "declare i%zu @fwrite(i8*, i%zu, i%zu, %%struct._IO_FILE*)\n", word, word, word);
 	}
-	uni_printf(info->sx->io, " \n");
-}
 
+	if (info->was_function[BI_FGETLINE])
+	{
+		uni_printf(info->sx->io, "declare i8* @fgets(i8*, i32, %%struct._IO_FILE*)\n");
+		fgetline_definition(info);
+	}
+
+	if (info->was_function[BI_STRLEN])
+	{
+		uni_printf(info->sx->io, "declare i%zu @strlen(i8*)\n", word);
+		string_definition(info, BI_STRLEN);
+	}
+
+	if (info->was_function[BI_STRSTR])
+	{
+		uni_printf(info->sx->io, "declare i8* @strstr(i8*, i8*)\n");
+		string_definition(info, BI_STRSTR);
+	}
+
+	if (info->was_function[BI_CHAN_SEND] || info->was_function[BI_CHAN_RECEIVE])
+	{
+		channel_definition(info);
+	}
 
-static void builin_functions_declaration(information *const info)
-{
 	for (size_t i = 0; i < BEGIN_USER_FUNC; i++)
 	{
 		// Пропускаем, так как эта функция не библиотечная, а реализована вручную в кодах llvm
-		if (i == BI_ASSERT || i == BI_PRINT || i == BI_PRINTID || i == BI_GETID)
+		if (i == BI_ASSERT || i == BI_PRINT || i == BI_PRINTID || i == BI_GETID || i == BI_FGETLINE
+			|| i == BI_STRLEN || i == BI_STRSTR || i == BI_CHAN_SEND || i == BI_CHAN_RECEIVE)
+		{
+			continue;
+		}
+
+		if ((i == BI_FREAD_CHARS || i == BI_FWRITE_CHARS || i == BI_FREAD_INTS || i == BI_FWRITE_INTS)
+			&& info->was_function[i])
+		{
+			block_io_definition(info, i);
+			continue;
+		}
+
+		// Атомарные функции раскрываются в одну атомарную инструкцию после встраивания
+		if (i >= BI_ATOMIC_ADD && i <= BI_ATOMIC_STORE && info->was_function[i])
+		{
+			atomic_definition(info, i);
+			continue;
+		}
+
+		if (i == BI_PARALLEL_FOR && info->was_function[i])
+		{
+			parallel_for_definition(info);
+			continue;
+		}
+
+		if (i == BI_MSG_RECEIVE && info->was_function[i])
 		{
+			uni_printf(info->sx->io, "declare i64 @t_msg_receive()\n");
 			continue;
 		}
 
@@ -3174,7 +6461,7 @@ static void runtime(information *const info)
 {
 	// assert
 	uni_printf(info->sx->io, "@.str = private unnamed_addr constant [3 x i8] c\"%%s\\00\", align 1\n"
-		"define void @assert(i1, i8*) {\n"
+		"define internal void @assert(i1, i8*) {\n"
 		" %%3 = alloca i1, align 4\n"
 		" %%4 = alloca i8*, align 8\n"
 		" store i1 %%0, i1* %%3, align 4\n"
@@ -3191,22 +6478,36 @@ static void runtime(information *const info)
 		"}\n"
 		"declare void @exit(i32)\n\n");
 
-	// TODO: тут пока заглушки
-	// print
-	uni_printf(info->sx->io, "define void @print(...) {\n"
-		" ret void\n"
-		"}\n");
-
-	// printid
-	uni_printf(info->sx->io, "define void @printid(...) {\n"
-		" ret void\n"
-		"}\n\n");
+	// print, printid и getid разворачиваются в вызовы printf и scanf с форматом по типу аргумента
+	uni_printf(info->sx->io, "@.fmt.i = private unnamed_addr constant [3 x i8] c\"%%i\\00\", align 1\n"
+		"@.fmt.c = private unnamed_addr constant [3 x i8] c\"%%c\\00\", align 1\n"
+		"@.fmt.f = private unnamed_addr constant [3 x i8] c\"%%f\\00\", align 1\n"
+		"@.fmt.s = private unnamed_addr constant [3 x i8] c\"%%s\\00\", align 1\n"
+		"@.fmt.lf = private unnamed_addr constant [4 x i8] c\"%%lf\\00\", align 1\n"
+		"@.fmt.sc = private unnamed_addr constant [4 x i8] c\" %%c\\00\", align 1\n"
+		"@.fmt.nl = private unnamed_addr constant [2 x i8] c\"\\0A\\00\", align 1\n"
+		"@.fmt.sp = private unnamed_addr constant [2 x i8] c\" \\00\", align 1\n"
+		"@.fmt.cm = private unnamed_addr constant [3 x i8] c\", \\00\", align 1\n"
+		"@.fmt.lb = private unnamed_addr constant [2 x i8] c\"{\\00\", align 1\n"
+		"@.fmt.rb = private unnamed_addr constant [2 x i8] c\"}\\00\", align 1\n\n");
 	info->was_function[BI_PRINTF] = true;
+}
 
-	// getid
-	uni_printf(info->sx->io, "define void @getid(...) {\n"
-		" ret void\n"
-		"}\n\n");
+static void names_declaration(information *const info)
+{
+	const size_t amount = vector_size(&info->names);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const size_t id = (size_t)vector_get(&info->names, i);
+		const char *const spelling = ident_get_spelling(info->sx, id);
+		uni_printf(info->sx->io, "@.name.%zu = private unnamed_addr constant [%zu x i8] c\"%s \\00\", align 1\n"
+			, id, strlen(spelling) + 2, spelling);
+	}
+
+	if (info->was_scanf)
+	{
+		uni_printf(info->sx->io, "declare i32 @scanf(i8*, ...)\n");
+	}
 }
 
 
@@ -3219,48 +6520,558 @@ static void runtime(information *const info)
  */
 
 
-int encode_to_llvm(const workspace *const ws, syntax *const sx)
+#ifdef RUC_LLVM_BITCODE
+/**
+ *	Optimize module by flags of workspace
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	module			LLVM module
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int optimize_module(const workspace *const ws, LLVMModuleRef module)
 {
-	if (!ws_is_correct(ws) || sx == NULL)
+	const char *const passes = ws_has_option(ws, OPT_O2) ? "default<O2>" : ws_has_option(ws, OPT_O1) ? "default<O1>" : NULL;
+	if (passes == NULL)
+	{
+		return 0;
+	}
+
+	LLVMPassBuilderOptionsRef options = LLVMCreatePassBuilderOptions();
+	LLVMErrorRef error = LLVMRunPasses(module, passes, NULL, options);
+	LLVMDisposePassBuilderOptions(options);
+
+	if (error != NULL)
+	{
+		char *const message = LLVMGetErrorMessage(error);
+		system_error(llvm_bitcode_error, message);
+		LLVMDisposeErrorMessage(message);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ *	Parse generated IR or bitcode in process and optimize it by flags of workspace
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	context			LLVM context
+ *	@param	code			Generated IR or bitcode
+ *	@param	size			Size of code
+ *
+ *	@return	Module on success, @c NULL on failure
+ */
+static LLVMModuleRef build_module(const workspace *const ws, LLVMContextRef context
+	, const char *const code, const size_t size)
+{
+	LLVMMemoryBufferRef input = LLVMCreateMemoryBufferWithMemoryRange(code, size, "ruc", false);
+	LLVMModuleRef module = NULL;
+	char *message = NULL;
+
+	// Разбор забирает буфер себе, текст после него больше не нужен
+	if (LLVMParseIRInContext(context, input, &module, &message))
+	{
+		system_error(llvm_bitcode_error, message);
+		LLVMDisposeMessage(message);
+		return NULL;
+	}
+
+	if (optimize_module(ws, module))
+	{
+		LLVMDisposeModule(module);
+		return NULL;
+	}
+
+	return module;
+}
+
+/**
+ *	Parse generated IR in process, optimize it and write bitcode
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	io				Output for bitcode
+ *	@param	text			Generated IR
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int write_bitcode(const workspace *const ws, universal_io *const io, const char *const text)
+{
+	LLVMContextRef context = LLVMContextCreate();
+	LLVMModuleRef module = build_module(ws, context, text, strlen(text));
+	if (module == NULL)
 	{
+		LLVMContextDispose(context);
 		return -1;
 	}
 
+	LLVMMemoryBufferRef output = LLVMWriteBitcodeToMemoryBuffer(module);
+	const size_t size = LLVMGetBufferSize(output);
+	const int ret = out_write(io, LLVMGetBufferStart(output), size) == (int)size ? 0 : -1;
+	LLVMDisposeMemoryBuffer(output);
+
+	LLVMDisposeModule(module);
+	LLVMContextDispose(context);
+	return ret;
+}
+
+/**
+ *	Report error of JIT and free it
+ *
+ *	@param	error			LLVM error
+ *
+ *	@return	@c -1
+ */
+static int jit_error(LLVMErrorRef error)
+{
+	char *const message = LLVMGetErrorMessage(error);
+	system_error(llvm_jit_error, message);
+	LLVMDisposeErrorMessage(message);
+	return -1;
+}
+
+/**
+ *	Register functions of threads runtime in JIT library,
+ *	so programs are run without linking runtime library separately
+ *
+ *	@param	jit				LLVM JIT
+ *	@param	library			JIT library of program
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int runtime_to_jit(LLVMOrcLLJITRef jit, LLVMOrcJITDylibRef library)
+{
+#ifndef _WIN32
+	const struct { const char *name; void (*address)(void); } functions[] =
+	{
+		{ "t_init", (void (*)(void))&t_init },
+		{ "t_destroy", (void (*)(void))&t_destroy },
+		{ "t_create", (void (*)(void))&t_create },
+		{ "t_getnum", (void (*)(void))&t_getnum },
+		{ "t_sleep", (void (*)(void))&t_sleep },
+		{ "t_set_priority", (void (*)(void))&t_set_priority },
+		{ "t_set_affinity", (void (*)(void))&t_set_affinity },
+		{ "t_period_start", (void (*)(void))&t_period_start },
+		{ "t_period_wait", (void (*)(void))&t_period_wait },
+		{ "t_join", (void (*)(void))&t_join },
+		{ "t_exit", (void (*)(void))&t_exit },
+		{ "t_sem_create", (void (*)(void))&t_sem_create },
+		{ "t_sem_wait", (void (*)(void))&t_sem_wait },
+		{ "t_sem_post", (void (*)(void))&t_sem_post },
+		{ "t_msg_send", (void (*)(void))&t_msg_send },
+		{ "t_msg_receive", (void (*)(void))&t_msg_receive },
+	};
+	const size_t amount = sizeof(functions) / sizeof(functions[0]);
+
+	LLVMJITCSymbolMapPair symbols[sizeof(functions) / sizeof(functions[0])];
+	for (size_t i = 0; i < amount; i++)
+	{
+		symbols[i].Name = LLVMOrcLLJITMangleAndIntern(jit, functions[i].name);
+		symbols[i].Sym.Address = (LLVMOrcExecutorAddress)(uintptr_t)functions[i].address;
+		symbols[i].Sym.Flags.GenericFlags = LLVMJITSymbolGenericFlagsExported | LLVMJITSymbolGenericFlagsCallable;
+		symbols[i].Sym.Flags.TargetFlags = 0;
+	}
+
+	LLVMErrorRef error = LLVMOrcJITDylibDefine(library, LLVMOrcAbsoluteSymbols(symbols, amount));
+	return error != NULL ? jit_error(error) : 0;
+#else
+	(void)jit;
+	(void)library;
+	return 0;
+#endif
+}
+#endif
+
+/**
+ *	Encode to LLVM textual IR
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	sx				Syntax structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int encode_to_llvm_text(const workspace *const ws, syntax *const sx)
+{
+	COUNTER_OUTPUT(COUNTER_PRINTF_LLVM);
 	information info;
 	info.sx = sx;
 	info.register_num = 1;
 	info.label_num = 1;
-	info.label_switch = 0;
+	info.label_default = SIZE_MAX;
 	info.init_num = 1;
 	info.block_num = 1;
+	info.hoisted_block = ITEM_MAX;
 	info.variable_location = LREG;
 	info.request_reg = 0;
 	info.answer_reg = 0;
+	info.answer_const = 0;
+	info.answer_const_double = 0;
+	info.answer_const_bool = false;
 	info.was_stack_functions = false;
 	info.was_dynamic = false;
+	info.was_arena = false;
 	info.was_file = false;
 	info.was_abs = false;
 	info.was_fabs = false;
+	info.was_assume = false;
+	info.was_memcpy = false;
+	info.was_memset = false;
+	info.was_scanf = false;
 	info.is_main = false;
 	info.is_call = false;
-	info.label_phi_previous = 0;
+	info.is_builtin = false;
 	for (size_t i = 0; i < BEGIN_USER_FUNC; i++)
 	{
 		info.was_function[i] = false;
 	}
 
 	info.arrays = hash_create(HASH_TABLE_SIZE);
-
-	architecture(ws, sx);
-	structs_declaration(&info);
-	strings_declaration(&info);
+	info.allocas = io_create();
+	info.names = vector_create(MAX_FUNCTION_ARGS);
+	info.cases = vector_create(CASES_SIZE);
+	info.numbers = numbering_create(sx);
+	info.eff = effects_create(sx);
+	info.addresses = vector_create(0);
+
+	info.is_debug = ws_has_option(ws, OPT_DEBUG);
+	info.is_profiling = ws_has_option(ws, OPT_PROFILE_GENERATE);
+	info.is_fast_math = ws_has_option(ws, OPT_FAST_MATH);
+	info.is_separate = ws_has_option(ws, OPT_COMPILE_ONLY);
+	info.is_streaming = sx->is_streaming;
+	// Псевдонимы функций из разных модулей не разделяются на определения и описания
+	info.is_folding = sx->is_optimized && !info.is_debug && !info.is_profiling && partition_get_amount(ws) == 0;
+	info.is_numbering = sx->is_optimized && !info.is_debug;
+	info.bodies = map_create(0);
+	info.is_reordering = ws_has_option(ws, OPT_REORDER_FIELDS);
+	info.fields = hash_create(0);
+	info.inits = vector_create(0);
+	info.types = 0;
+	info.was_file = info.is_profiling;
+	info.index = source_get_index(&sx->src);
+	info.debug_path = ws_get_files_num(ws) != 0 ? ws_get_file(ws, 0) : "";
+	info.debug = io_create();
+	out_set_buffer(&info.debug, DEBUG_BUFFER_SIZE);
+	info.constants = io_create();
+	// Глобальные константы инициализации печатаются по элементу на выражение инициализатора
+	out_set_buffer(&info.constants, CONSTANTS_BUFFER_SIZE + INITIALIZER_LENGTH * sx->initializer_amount);
+	info.debug_unit = TBAA_ROOT + 1 + 2 * TBAA_NONE;
+	info.debug_scope = info.debug_unit;
+	info.debug_num = info.debug_unit + 6;
+	info.loop_hints = 0;
+	info.counters = 0;
+	info.function = 0;
+	info.profile = io_create();
+	out_set_buffer(&info.profile, PROFILE_BUFFER_SIZE);
+
+	architecture(ws, &info);
+	if (!info.is_streaming)
+	{
+		structs_declaration(&info);
+		strings_declaration(&info);
+	}
 	runtime(&info);
 
+	// LLVM допускает ссылки вперёд на глобальные значения, поэтому строки при потоковом выводе описываются в конце
+	if (info.is_streaming && parse_by_declarations(sx, &emit_streaming_declaration, &info) == 0)
+	{
+		initialization_definition(&info);
+		strings_declaration(&info);
+	}
+
 	// TODO: нормальное получение корня
 	const node root = node_get_root(&info.sx->tree);
 	const int ret = emit_translation_unit(&info, &root);
 	builin_functions_declaration(&info);
+	prototypes_declaration(&info);
+	profile_declaration(&info);
+	names_declaration(&info);
+	tbaa_declaration(&info);
+	debug_declaration(&info);
 
 	hash_clear(&info.arrays);
+	vector_clear(&info.names);
+	vector_clear(&info.cases);
+	numbering_clear(&info.numbers);
+	effects_clear(&info.eff);
+	vector_clear(&info.addresses);
+	vector_clear(&info.inits);
+	map_clear(&info.bodies);
+	hash_clear(&info.fields);
+	io_erase(&info.debug);
+	io_erase(&info.constants);
+	io_erase(&info.profile);
+	COUNTER_OUTPUT(COUNTER_PRINTF);
+	return ret;
+}
+
+/**
+ *	Write module as IR or as bitcode by flags of workspace
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	io				Output
+ *	@param	text			Generated IR
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int write_module(const workspace *const ws, universal_io *const io, const char *const text)
+{
+	if (!ws_has_option(ws, OPT_BITCODE))
+	{
+		const size_t size = strlen(text);
+		return out_write(io, text, size) == (int)size ? 0 : -1;
+	}
+
+#ifdef RUC_LLVM_BITCODE
+	return write_bitcode(ws, io, text);
+#else
+	system_error(llvm_bitcode_is_not_supported);
+	return -1;
+#endif
+}
+
+/**
+ *	Write generated IR as several modules and manifest with their paths,
+ *	the first module goes to output of encoder, others go to files with number suffixes
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	io				Output of the first module
+ *	@param	text			Generated IR
+ *	@param	amount			Number of modules
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int write_partitions(const workspace *const ws, universal_io *const io, const char *const text, size_t amount)
+{
+	// Отладочные метаданные и счётчики профиля описываются в модуле один раз
+	if (ws_has_option(ws, OPT_DEBUG) || ws_has_option(ws, OPT_PROFILE_GENERATE))
+	{
+		amount = 1;
+	}
+
+	universal_io *const modules = malloc(amount * sizeof(universal_io));
+	if (modules == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		modules[i] = io_create();
+		out_set_buffer(&modules[i], BITCODE_BUFFER_SIZE);
+	}
+
+	const char *const output = ws_get_output(ws);
+	char *const path = malloc(strlen(output) + MAX_NAME);
+	int ret = path == NULL || partition_module(text, modules, amount);
+
+	universal_io manifest = io_create();
+	if (!ret)
+	{
+		sprintf(path, "%s%s", output, MANIFEST_SUFFIX);
+		ret = out_set_file(&manifest, path);
+	}
+
+	for (size_t i = 0; i < amount && !ret; i++)
+	{
+		char *const module = out_extract_buffer(&modules[i]);
+		if (i == 0)
+		{
+			ret = module == NULL || write_module(ws, io, module);
+			uni_printf(&manifest, "%s\n", output);
+		}
+		else
+		{
+			universal_io file = io_create();
+			sprintf(path, "%s.%zu", output, i);
+			ret = module == NULL || out_set_file(&file, path) || write_module(ws, &file, module);
+			uni_printf(&manifest, "%s\n", path);
+			io_erase(&file);
+		}
+
+		free(module);
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		io_erase(&modules[i]);
+	}
+
+	io_erase(&manifest);
+	free(modules);
+	free(path);
+	return ret ? -1 : 0;
+}
+
+int encode_to_llvm(const workspace *const ws, syntax *const sx)
+{
+	if (!ws_is_correct(ws) || sx == NULL)
+	{
+		return -1;
+	}
+
+	const size_t partitions = ws_get_output(ws) != NULL ? partition_get_amount(ws) : 0;
+	if (!ws_has_option(ws, OPT_BITCODE) && partitions == 0)
+	{
+		return encode_to_llvm_text(ws, sx);
+	}
+
+#ifndef RUC_LLVM_BITCODE
+	if (ws_has_option(ws, OPT_BITCODE))
+	{
+		system_error(llvm_bitcode_is_not_supported);
+		return -1;
+	}
+#endif
+
+	// Текст собирается в памяти и сразу разбирается LLVM или делится на модули, без промежуточного файла
+	universal_io buffer = io_create();
+	out_set_buffer(&buffer, BITCODE_BUFFER_SIZE);
+	out_swap(sx->io, &buffer);
+
+	int ret = encode_to_llvm_text(ws, sx);
+	out_swap(sx->io, &buffer);
+
+	char *const text = out_extract_buffer(&buffer);
+	ret = ret || text == NULL
+		|| (partitions != 0 ? write_partitions(ws, sx->io, text, partitions) : write_module(ws, sx->io, text));
+
+	free(text);
+	io_erase(&buffer);
+	return ret ? -1 : 0;
+}
+
+int run_llvm(const workspace *const ws, const char *const code, const size_t size, int *const result)
+{
+	if (!ws_is_correct(ws) || code == NULL || result == NULL)
+	{
+		return -1;
+	}
+
+#ifdef RUC_LLVM_BITCODE
+	LLVMInitializeNativeTarget();
+	LLVMInitializeNativeAsmPrinter();
+
+	// Модуль принадлежит JIT вместе с контекстом, поэтому контекст создаётся потокобезопасным
+	LLVMOrcThreadSafeContextRef context = LLVMOrcCreateNewThreadSafeContext();
+	LLVMModuleRef module = build_module(ws, LLVMOrcThreadSafeContextGetContext(context), code, size);
+	if (module == NULL)
+	{
+		LLVMOrcDisposeThreadSafeContext(context);
+		return -1;
+	}
+
+	LLVMOrcLLJITRef jit = NULL;
+	LLVMErrorRef error = LLVMOrcCreateLLJIT(&jit, NULL);
+	if (error != NULL)
+	{
+		LLVMDisposeModule(module);
+		LLVMOrcDisposeThreadSafeContext(context);
+		return jit_error(error);
+	}
+
+	// Разметка данных задаётся для целевой платформы, а исполняется модуль на машине компилятора
+	LLVMSetDataLayout(module, LLVMOrcLLJITGetDataLayoutStr(jit));
+
+	// Функции библиотеки C ищутся среди символов процесса компилятора
+	LLVMOrcJITDylibRef library = LLVMOrcLLJITGetMainJITDylib(jit);
+	LLVMOrcDefinitionGeneratorRef generator = NULL;
+	error = LLVMOrcCreateDynamicLibrarySearchGeneratorForProcess(&generator, LLVMOrcLLJITGetGlobalPrefix(jit), NULL, NULL);
+	if (error == NULL)
+	{
+		LLVMOrcJITDylibAddGenerator(library, generator);
+		error = LLVMOrcLLJITAddLLVMIRModule(jit, library, LLVMOrcCreateNewThreadSafeModule(module, context));
+	}
+	else
+	{
+		LLVMDisposeModule(module);
+	}
+	LLVMOrcDisposeThreadSafeContext(context);
+
+	LLVMOrcExecutorAddress address = 0;
+	int ret = error != NULL ? jit_error(error) : runtime_to_jit(jit, library);
+	if (!ret)
+	{
+		error = LLVMOrcLLJITLookup(jit, &address, "main");
+		ret = error != NULL ? jit_error(error) : 0;
+	}
+
+	if (!ret)
+	{
+		int (*const main_func)(void) = (int (*)(void))(uintptr_t)address;
+		*result = main_func();
+		fflush(stdout);
+	}
+
+	error = LLVMOrcDisposeLLJIT(jit);
+	return error != NULL ? jit_error(error) : ret;
+#else
+	(void)size;
+	system_error(llvm_bitcode_is_not_supported);
+	return -1;
+#endif
+}
+
+int link_llvm(const workspace *const ws)
+{
+	if (!ws_is_correct(ws) || ws_get_files_num(ws) == 0)
+	{
+		return -1;
+	}
+
+#ifdef RUC_LLVM_BITCODE
+	LLVMContextRef context = LLVMContextCreate();
+	LLVMModuleRef program = NULL;
+	int ret = 0;
+
+	for (size_t i = 0; i < ws_get_files_num(ws) && !ret; i++)
+	{
+		LLVMMemoryBufferRef input = NULL;
+		LLVMModuleRef module = NULL;
+		char *message = NULL;
+
+		if (LLVMCreateMemoryBufferWithContentsOfFile(ws_get_file(ws, i), &input, &message)
+			|| LLVMParseIRInContext(context, input, &module, &message))
+		{
+			system_error(llvm_bitcode_error, message);
+			LLVMDisposeMessage(message);
+			ret = -1;
+		}
+		else if (program == NULL)
+		{
+			program = module;
+		}
+		// Присоединяемый модуль уничтожается при связывании
+		else if (LLVMLinkModules2(program, module))
+		{
+			system_error(llvm_bitcode_error, ws_get_file(ws, i));
+			ret = -1;
+		}
+	}
+
+	ret = ret || optimize_module(ws, program);
+	if (!ret && ws_has_option(ws, OPT_BITCODE))
+	{
+		ret = LLVMWriteBitcodeToFile(program, ws_get_output(ws)) ? -1 : 0;
+	}
+	else if (!ret)
+	{
+		char *message = NULL;
+		if (LLVMPrintModuleToFile(program, ws_get_output(ws), &message))
+		{
+			system_error(llvm_bitcode_error, message);
+			LLVMDisposeMessage(message);
+			ret = -1;
+		}
+	}
+
+	if (program != NULL)
+	{
+		LLVMDisposeModule(program);
+	}
+	LLVMContextDispose(context);
 	return ret;
+#else
+	system_error(llvm_bitcode_is_not_supported);
+	return -1;
+#endif
 }
@@ -34,6 +34,28 @@ extern "C" {
  */
 int encode_to_llvm(const workspace *const ws, syntax *const sx);
 
+/**
+ *	Link LLVM modules from files of workspace into one module,
+ *	modules are compiled separately with flag @c -c
+ *
+ *	@param	ws				Compiler workspace, output is written by its flags
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int link_llvm(const workspace *const ws);
+
+/**
+ *	Execute LLVM code in process by JIT, functions of threads runtime are registered in JIT
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	code			LLVM textual IR or bitcode
+ *	@param	size			Size of code
+ *	@param	result			Exit code of executed program
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int run_llvm(const workspace *const ws, const char *const code, const size_t size, int *const result);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
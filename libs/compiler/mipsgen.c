@@ -0,0 +1,3585 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "mipsgen.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "AST.h"
+#include "counters.h"
+#include "errors.h"
+#include "uniprinter.h"
+#include "utf8.h"
+
+
+#define VIRTUAL_FIELDS		6
+#define MACHINE_FIELDS		7
+#define MACHINE_REGISTERS	64
+#define MAX_REGION			128
+#define MAX_ACCESSES		6
+#define MAX_FUNCTION_NAME	4096
+
+
+static const item_t NONE = -1;
+
+static const size_t MAX_IMMEDIATE = 32767;			// Смещения кадра должны помещаться в 16 бит
+static const size_t ARGUMENT_REGISTERS = 4;			// Первые слова аргументов передаются в $a0-$a3
+static const size_t HOME_AREA = 16;					// Вызываемая функция может сохранить там $a0-$a3
+
+
+/** Machine registers, floating point registers follow general purpose ones */
+enum REGISTER
+{
+	R_ZERO = 0,
+	R_AT = 1,
+	R_V0 = 2,
+	R_A0 = 4,
+	R_T0 = 8,
+	R_S0 = 16,
+	R_T8 = 24,
+	R_T9 = 25,
+	R_SP = 29,
+	R_FP = 30,
+	R_RA = 31,
+
+	R_F0 = 32,
+	R_F12 = 44,
+	R_F16 = 48,
+	R_F18 = 50,
+
+	R_HILO = MACHINE_REGISTERS,			/**< Регистры HI и LO результата деления */
+	R_FCC,								/**< Флаг условия сопроцессора */
+};
+
+// Регистры $t8, $t9, $f16 и $f18 - для подкачки из кадра, $at и $v0 - для внутренних нужд инструкций
+static const size_t INTEGER_CALLER_SAVED[] = { 8, 9, 10, 11, 12, 13, 14, 15 };
+static const size_t INTEGER_CALLEE_SAVED[] = { 16, 17, 18, 19, 20, 21, 22, 23 };
+static const size_t FLOATING_CALLER_SAVED[] = { 34, 36, 38, 40, 42 };
+static const size_t FLOATING_CALLEE_SAVED[] = { 52, 54, 56, 58, 60, 62 };
+
+static const char *const REGISTER_NAMES[] =
+{
+	"$zero", "$at", "$v0", "$v1", "$a0", "$a1", "$a2", "$a3",
+	"$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+	"$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+	"$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra",
+};
+
+
+/** Instructions over virtual registers */
+typedef enum VIRTUAL_INSTRUCTION
+{
+	VI_LI,								/**< Загрузка целой константы */
+	VI_LID,								/**< Загрузка вещественной константы */
+	VI_LA,								/**< Загрузка адреса строки */
+	VI_MOV,								/**< Копирование регистра */
+	VI_PARAM,							/**< Получение параметра функции по номеру слова */
+	VI_LOAD,							/**< Загрузка глобальной переменной */
+	VI_STORE,							/**< Запись глобальной переменной */
+	VI_GLOBAL,							/**< Загрузка адреса глобального массива */
+	VI_ELEMENT,							/**< Вычисление адреса элемента массива */
+	VI_LOAD_AT,							/**< Загрузка по адресу со смещением */
+	VI_STORE_AT,						/**< Запись по адресу со смещением */
+	VI_CONVERT,							/**< Преобразование целого в вещественное */
+	VI_UNARY,							/**< Унарная операция */
+	VI_BINARY,							/**< Бинарная операция */
+	VI_LABEL,							/**< Метка */
+	VI_JUMP,							/**< Безусловный переход */
+	VI_BZ,								/**< Переход, если регистр равен нулю */
+	VI_BNZ,								/**< Переход, если регистр не равен нулю */
+	VI_ARG,								/**< Передача аргумента вызова по номеру слова */
+	VI_CALL,							/**< Вызов функции */
+	VI_MATH,							/**< Вызов математической функции от одного вещественного аргумента */
+	VI_ASSERT,							/**< Печать сообщения и завершение программы */
+	VI_RET,								/**< Возврат значения */
+	VI_RETV,							/**< Возврат без значения */
+	VI_ALLOCA,							/**< Выделение локального массива на стеке */
+	VI_SAVE,							/**< Сохранение указателя стека */
+	VI_RESTORE,							/**< Восстановление указателя стека */
+} virtual_instruction_t;
+
+/** Fields of virtual instruction */
+typedef enum VIRTUAL_FIELD
+{
+	VF_OPERATION,						/**< Код инструкции */
+	VF_DESTINATION,						/**< Регистр результата */
+	VF_FIRST,							/**< Первый регистр операнда */
+	VF_SECOND,							/**< Второй регистр операнда */
+	VF_ARGUMENT,						/**< Константа, смещение, метка, идентификатор или операция */
+	VF_FLOATING,						/**< Флаг вещественных операндов */
+} virtual_field_t;
+
+/** MIPS instructions */
+typedef enum MACHINE_INSTRUCTION
+{
+	MI_LABEL,
+	MI_NOP,
+
+	MI_ADDU,
+	MI_SUBU,
+	MI_MUL,
+	MI_AND,
+	MI_OR,
+	MI_XOR,
+	MI_NOR,
+	MI_SLT,
+	MI_SLTU,
+	MI_SLLV,
+	MI_SRAV,
+	MI_DIV,
+	MI_MFLO,
+	MI_MFHI,
+	MI_MOVE,
+
+	MI_ADDIU,
+	MI_ORI,
+	MI_XORI,
+	MI_SLTIU,
+	MI_SLL,
+	MI_SRA,
+	MI_SRL,
+	MI_LUI,
+
+	MI_LW,
+	MI_SW,
+	MI_LDC1,
+	MI_SDC1,
+
+	MI_BEQ,
+	MI_BNE,
+	MI_J,
+	MI_JAL,
+	MI_JR,
+
+	MI_ADD_D,
+	MI_SUB_D,
+	MI_MUL_D,
+	MI_DIV_D,
+	MI_NEG_D,
+	MI_ABS_D,
+	MI_MOV_D,
+	MI_SQRT_D,
+	MI_CVT_D_W,
+	MI_TRUNC_W_D,
+	MI_MTC1,
+	MI_MFC1,
+	MI_C_EQ_D,
+	MI_C_LT_D,
+	MI_C_LE_D,
+	MI_MOVF,
+	MI_MOVT,
+} machine_instruction_t;
+
+/** Fields of machine instruction */
+typedef enum MACHINE_FIELD
+{
+	MF_OPERATION,						/**< Код инструкции */
+	MF_FIRST,							/**< Первый регистр */
+	MF_SECOND,							/**< Второй регистр */
+	MF_THIRD,							/**< Третий регистр */
+	MF_IMMEDIATE,						/**< Непосредственное значение или смещение */
+	MF_SYMBOL,							/**< Вид символа вместо непосредственного значения */
+	MF_VALUE,							/**< Метка, идентификатор или номер символа */
+} machine_field_t;
+
+/** Kinds of symbols in machine instructions */
+typedef enum SYMBOL
+{
+	SYM_NONE,							/**< Нет символа */
+	SYM_LABEL,							/**< Метка функции */
+	SYM_GLOBAL,							/**< Глобальная переменная */
+	SYM_STRING,							/**< Строка */
+	SYM_CONSTANT,						/**< Вещественная константа */
+	SYM_FUNCTION,						/**< Функция */
+	SYM_EXIT,							/**< Библиотечная функция завершения программы */
+} symbol_t;
+
+/** Syntax of machine instruction */
+typedef enum FORMAT
+{
+	FORMAT_LABEL,						/**< Метка */
+	FORMAT_NONE,						/**< Без операндов */
+	FORMAT_R,							/**< Один регистр */
+	FORMAT_RR,							/**< Два регистра */
+	FORMAT_RRR,							/**< Три регистра */
+	FORMAT_RRI,							/**< Два регистра и непосредственное значение */
+	FORMAT_RI,							/**< Регистр и старшая половина значения */
+	FORMAT_MEMORY,						/**< Регистр и адрес памяти */
+	FORMAT_BRANCH,						/**< Два регистра и метка */
+	FORMAT_JUMP,						/**< Метка или функция */
+} format_t;
+
+/** Description of machine instruction */
+typedef struct description
+{
+	const char *name;					/**< Мнемоника */
+	format_t format;					/**< Синтаксис операндов */
+} description;
+
+static const description DESCRIPTIONS[] =
+{
+	[MI_LABEL] = { "", FORMAT_LABEL },
+	[MI_NOP] = { "nop", FORMAT_NONE },
+
+	[MI_ADDU] = { "addu", FORMAT_RRR },
+	[MI_SUBU] = { "subu", FORMAT_RRR },
+	[MI_MUL] = { "mul", FORMAT_RRR },
+	[MI_AND] = { "and", FORMAT_RRR },
+	[MI_OR] = { "or", FORMAT_RRR },
+	[MI_XOR] = { "xor", FORMAT_RRR },
+	[MI_NOR] = { "nor", FORMAT_RRR },
+	[MI_SLT] = { "slt", FORMAT_RRR },
+	[MI_SLTU] = { "sltu", FORMAT_RRR },
+	[MI_SLLV] = { "sllv", FORMAT_RRR },
+	[MI_SRAV] = { "srav", FORMAT_RRR },
+	[MI_DIV] = { "div", FORMAT_RRR },
+	[MI_MFLO] = { "mflo", FORMAT_R },
+	[MI_MFHI] = { "mfhi", FORMAT_R },
+	[MI_MOVE] = { "move", FORMAT_RR },
+
+	[MI_ADDIU] = { "addiu", FORMAT_RRI },
+	[MI_ORI] = { "ori", FORMAT_RRI },
+	[MI_XORI] = { "xori", FORMAT_RRI },
+	[MI_SLTIU] = { "sltiu", FORMAT_RRI },
+	[MI_SLL] = { "sll", FORMAT_RRI },
+	[MI_SRA] = { "sra", FORMAT_RRI },
+	[MI_SRL] = { "srl", FORMAT_RRI },
+	[MI_LUI] = { "lui", FORMAT_RI },
+
+	[MI_LW] = { "lw", FORMAT_MEMORY },
+	[MI_SW] = { "sw", FORMAT_MEMORY },
+	[MI_LDC1] = { "ldc1", FORMAT_MEMORY },
+	[MI_SDC1] = { "sdc1", FORMAT_MEMORY },
+
+	[MI_BEQ] = { "beq", FORMAT_BRANCH },
+	[MI_BNE] = { "bne", FORMAT_BRANCH },
+	[MI_J] = { "j", FORMAT_JUMP },
+	[MI_JAL] = { "jal", FORMAT_JUMP },
+	[MI_JR] = { "jr", FORMAT_R },
+
+	[MI_ADD_D] = { "add.d", FORMAT_RRR },
+	[MI_SUB_D] = { "sub.d", FORMAT_RRR },
+	[MI_MUL_D] = { "mul.d", FORMAT_RRR },
+	[MI_DIV_D] = { "div.d", FORMAT_RRR },
+	[MI_NEG_D] = { "neg.d", FORMAT_RR },
+	[MI_ABS_D] = { "abs.d", FORMAT_RR },
+	[MI_MOV_D] = { "mov.d", FORMAT_RR },
+	[MI_SQRT_D] = { "sqrt.d", FORMAT_RR },
+	[MI_CVT_D_W] = { "cvt.d.w", FORMAT_RR },
+	[MI_TRUNC_W_D] = { "trunc.w.d", FORMAT_RR },
+	[MI_MTC1] = { "mtc1", FORMAT_RR },
+	[MI_MFC1] = { "mfc1", FORMAT_RR },
+	[MI_C_EQ_D] = { "c.eq.d", FORMAT_RR },
+	[MI_C_LT_D] = { "c.lt.d", FORMAT_RR },
+	[MI_C_LE_D] = { "c.le.d", FORMAT_RR },
+	[MI_MOVF] = { "movf", FORMAT_RR },
+	[MI_MOVT] = { "movt", FORMAT_RR },
+};
+
+typedef struct generator
+{
+	syntax *sx;							/**< Структура syntax с таблицами */
+
+	vector code;						/**< Код текущей функции, по VIRTUAL_FIELDS элементов на инструкцию */
+	vector kinds;						/**< Флаги виртуальных регистров функции */
+	vector registers;					/**< Виртуальные регистры локальных переменных по идентификаторам */
+	vector constants;					/**< Вещественные константы */
+	vector cases;						/**< Пары из индекса выражения case и его метки */
+	vector arguments;					/**< Регистры вычисленных аргументов вызовов */
+	vector instructions;				/**< Машинный код текущей функции, по MACHINE_FIELDS элементов на инструкцию */
+
+	size_t function;					/**< Идентификатор текущей функции */
+	size_t label_num;					/**< Номер метки */
+	size_t label_break;					/**< Метка перехода для break */
+	size_t label_continue;				/**< Метка перехода для continue */
+	size_t label_default;				/**< Метка перехода для default */
+
+	bool is_scheduled;					/**< Истина, если машинный код переупорядочивается */
+	bool was_error;						/**< Истина, если встретилась неподдерживаемая конструкция */
+} generator;
+
+/** Flags of virtual register */
+typedef enum KIND
+{
+	KIND_VARIABLE = 1,					/**< Регистр переменной */
+	KIND_FLOATING = 2,					/**< Вещественный регистр */
+} kind_t;
+
+/** Left side of assignment */
+typedef struct lvalue
+{
+	item_t variable;					/**< Регистр локальной переменной */
+	item_t address;						/**< Регистр с адресом элемента массива */
+	size_t id;							/**< Идентификатор глобальной переменной */
+	bool is_floating;					/**< Истина, если значение вещественное */
+} lvalue;
+
+/** Live interval of virtual register */
+typedef struct interval
+{
+	size_t start;						/**< Первая инструкция с регистром */
+	size_t end;							/**< Последняя инструкция с регистром */
+	size_t reg;							/**< Виртуальный регистр */
+} interval;
+
+/** Kinds of memory accessed by machine instruction */
+typedef enum MEMORY
+{
+	MEM_NONE,							/**< Нет обращения к памяти */
+	MEM_CONSTANT,						/**< Константа, которая не изменяется */
+	MEM_GLOBAL,							/**< Глобальная переменная */
+	MEM_FRAME,							/**< Слот кадра по смещению от $fp */
+	MEM_OTHER,							/**< Массив или область относительно $sp */
+} memory_t;
+
+/** Registers and memory accessed by machine instruction */
+typedef struct access
+{
+	size_t uses[MAX_ACCESSES];			/**< Читаемые регистры */
+	size_t uses_amount;					/**< Количество читаемых регистров */
+	size_t defs[MAX_ACCESSES];			/**< Записываемые регистры */
+	size_t defs_amount;					/**< Количество записываемых регистров */
+	memory_t memory;					/**< Вид памяти */
+	item_t address;						/**< Идентификатор переменной или смещение в кадре */
+	item_t size;						/**< Размер читаемой или записываемой памяти */
+	bool is_store;						/**< Истина, если память записывается */
+	size_t latency;						/**< Задержка готовности результата */
+} access;
+
+/** Frame of function */
+typedef struct frame
+{
+	size_t outgoing;					/**< Размер области аргументов вызовов в начале кадра */
+	size_t size;						/**< Размер кадра */
+	size_t label_return;				/**< Метка эпилога */
+	bool is_saved[MACHINE_REGISTERS];	/**< Истина для сохраняемых в кадре регистров */
+} frame;
+
+
+static void emit_statement(generator *const gen, const node *const nd);
+static item_t emit_expression(generator *const gen, const node *const nd);
+
+
+static void unsupported(generator *const gen)
+{
+	if (!gen->was_error)
+	{
+		system_error(mips_construction_not_supported);
+	}
+
+	gen->was_error = true;
+}
+
+static inline bool type_is_supported(const syntax *const sx, const item_t type)
+{
+	return type_is_arithmetic(sx, type) || type_is_boolean(type);
+}
+
+static inline bool type_is_plain_array(const syntax *const sx, const item_t type)
+{
+	return type_is_array(sx, type) && type_is_supported(sx, type_array_get_element_type(sx, type));
+}
+
+static inline size_t value_size(const item_t type)
+{
+	return type_is_floating(type) ? 8 : 4;
+}
+
+static inline size_t label_create(generator *const gen)
+{
+	return gen->label_num++;
+}
+
+static inline item_t register_create(generator *const gen, const bool is_variable, const bool is_floating)
+{
+	return (item_t)vector_add(&gen->kinds, (is_variable ? KIND_VARIABLE : 0) | (is_floating ? KIND_FLOATING : 0));
+}
+
+static inline bool register_is_variable(const generator *const gen, const item_t reg)
+{
+	return reg != NONE && (vector_get(&gen->kinds, (size_t)reg) & KIND_VARIABLE) != 0;
+}
+
+static inline bool register_is_floating(const generator *const gen, const item_t reg)
+{
+	return reg != NONE && (vector_get(&gen->kinds, (size_t)reg) & KIND_FLOATING) != 0;
+}
+
+static inline item_t register_get(const generator *const gen, const size_t id)
+{
+	return vector_get(&gen->registers, id) - 1;
+}
+
+static inline void register_set(generator *const gen, const size_t id, const item_t reg)
+{
+	vector_set(&gen->registers, id, reg + 1);
+}
+
+
+static inline size_t code_amount(const generator *const gen)
+{
+	return vector_size(&gen->code) / VIRTUAL_FIELDS;
+}
+
+static inline item_t code_get(const generator *const gen, const size_t index, const virtual_field_t field)
+{
+	return vector_get(&gen->code, index * VIRTUAL_FIELDS + field);
+}
+
+static inline void code_set(generator *const gen, const size_t index, const virtual_field_t field, const item_t value)
+{
+	vector_set(&gen->code, index * VIRTUAL_FIELDS + field, value);
+}
+
+static void code_add(generator *const gen, const virtual_instruction_t operation, const item_t dst
+	, const item_t fst, const item_t snd, const item_t argument, const bool is_floating)
+{
+	vector_add(&gen->code, operation);
+	vector_add(&gen->code, dst);
+	vector_add(&gen->code, fst);
+	vector_add(&gen->code, snd);
+	vector_add(&gen->code, argument);
+	vector_add(&gen->code, is_floating ? 1 : 0);
+}
+
+static inline void code_label(generator *const gen, const size_t label)
+{
+	code_add(gen, VI_LABEL, NONE, NONE, NONE, (item_t)label, false);
+}
+
+static inline void code_jump(generator *const gen, const virtual_instruction_t operation, const item_t reg, const size_t label)
+{
+	code_add(gen, operation, NONE, reg, NONE, (item_t)label, false);
+}
+
+static void code_move(generator *const gen, const item_t dst, const item_t src)
+{
+	if (dst == src)
+	{
+		return;
+	}
+
+	const size_t last = code_amount(gen) - 1;
+	if (!register_is_variable(gen, src) && code_amount(gen) != 0 && code_get(gen, last, VF_OPERATION) != VI_LABEL
+		&& code_get(gen, last, VF_DESTINATION) == src)
+	{
+		// Временный регистр определяется только последней инструкцией, её результат пишется сразу в переменную
+		code_set(gen, last, VF_DESTINATION, dst);
+	}
+	else
+	{
+		code_add(gen, VI_MOV, dst, src, NONE, 0, register_is_floating(gen, dst));
+	}
+}
+
+
+static binary_t assignment_to_binary(const binary_t operation)
+{
+	switch (operation)
+	{
+		case BIN_MUL_ASSIGN:
+			return BIN_MUL;
+		case BIN_DIV_ASSIGN:
+			return BIN_DIV;
+		case BIN_REM_ASSIGN:
+			return BIN_REM;
+		case BIN_ADD_ASSIGN:
+			return BIN_ADD;
+		case BIN_SUB_ASSIGN:
+			return BIN_SUB;
+		case BIN_SHL_ASSIGN:
+			return BIN_SHL;
+		case BIN_SHR_ASSIGN:
+			return BIN_SHR;
+		case BIN_AND_ASSIGN:
+			return BIN_AND;
+		case BIN_XOR_ASSIGN:
+			return BIN_XOR;
+		default:
+			return BIN_OR;
+	}
+}
+
+static bool expression_has_side_effects(const node *const nd)
+{
+	switch (expression_get_class(nd))
+	{
+		case EXPR_CALL:
+		case EXPR_ASSIGNMENT:
+			return true;
+
+		case EXPR_UNARY:
+		{
+			const unary_t operation = expression_unary_get_operator(nd);
+			if (operation == UN_POSTINC || operation == UN_POSTDEC || operation == UN_PREINC || operation == UN_PREDEC)
+			{
+				return true;
+			}
+		}
+		break;
+
+		default:
+			break;
+	}
+
+	const size_t amount = node_get_amount(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node child = node_get_child(nd, i);
+		if (expression_has_side_effects(&child))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool statement_has_arrays(const syntax *const sx, const node *const nd)
+{
+	if (node_get_type(nd) == OP_DECL_VAR && type_is_array(sx, ident_get_type(sx, declaration_variable_get_id(nd))))
+	{
+		return true;
+	}
+
+	const size_t amount = node_get_amount(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node child = node_get_child(nd, i);
+		if (statement_has_arrays(sx, &child))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ *	 ______     __  __     ______   ______     ______     ______     ______     __     ______     __   __     ______
+ *	/\  ___\   /\_\_\_\   /\  == \ /\  == \   /\  ___\   /\  ___\   /\  ___\   /\ \   /\  __ \   /\ "-.\ \   /\  ___\
+ *	\ \  __\   \/_/\_\/_  \ \  _-/ \ \  __<   \ \  __\   \ \___  \  \ \___  \  \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
+ *	 \ \_____\   /\_\/\_\  \ \_\    \ \_\ \_\  \ \_____\  \/\_____\  \/\_____\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
+ *	  \/_____/   \/_/\/_/   \/_/     \/_/ /_/   \/_____/   \/_____/   \/_____/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+ */
+
+
+/**
+ *	Emit operand, which must keep its value until siblings are calculated
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	is_clobbered	Set, if siblings can change variables
+ *
+ *	@return	Register with value
+ */
+static item_t emit_operand(generator *const gen, const node *const nd, const bool is_clobbered)
+{
+	const item_t reg = emit_expression(gen, nd);
+	if (!is_clobbered || !register_is_variable(gen, reg))
+	{
+		return reg;
+	}
+
+	const item_t copy = register_create(gen, false, register_is_floating(gen, reg));
+	code_add(gen, VI_MOV, copy, reg, NONE, 0, register_is_floating(gen, reg));
+	return copy;
+}
+
+/**
+ *	Emit floating zero constant
+ *
+ *	@param	gen			Generator
+ *
+ *	@return	Register with zero
+ */
+static item_t emit_floating_zero(generator *const gen)
+{
+	const item_t zero = register_create(gen, false, true);
+	code_add(gen, VI_LID, zero, NONE, NONE, (item_t)vector_add_double(&gen->constants, 0.0), true);
+	return zero;
+}
+
+/**
+ *	Emit condition of branch, floating value is compared with zero
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Integer register with condition
+ */
+static item_t emit_condition(generator *const gen, const node *const nd)
+{
+	const item_t reg = emit_expression(gen, nd);
+	if (!register_is_floating(gen, reg))
+	{
+		return reg;
+	}
+
+	const item_t result = register_create(gen, false, false);
+	code_add(gen, VI_BINARY, result, reg, emit_floating_zero(gen), BIN_NE, true);
+	return result;
+}
+
+/**
+ *	Emit identifier expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_identifier_expression(generator *const gen, const node *const nd)
+{
+	const size_t id = expression_identifier_get_id(nd);
+	const item_t reg = register_get(gen, id);
+	if (reg != NONE)
+	{
+		// Локальная переменная или указатель на локальный массив уже находится в регистре
+		return reg;
+	}
+
+	const item_t type = ident_get_type(gen->sx, id);
+	if (type_is_plain_array(gen->sx, type))
+	{
+		const item_t result = register_create(gen, false, false);
+		code_add(gen, VI_GLOBAL, result, NONE, NONE, (item_t)id, false);
+		return result;
+	}
+
+	if (!type_is_supported(gen->sx, type))
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	const bool is_floating = type_is_floating(type);
+	const item_t result = register_create(gen, false, is_floating);
+	code_add(gen, VI_LOAD, result, NONE, NONE, (item_t)id, is_floating);
+	return result;
+}
+
+/**
+ *	Emit literal expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_literal_expression(generator *const gen, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const item_t result = register_create(gen, false, type_is_floating(type));
+
+	if (type_is_floating(type))
+	{
+		const size_t index = vector_add_double(&gen->constants, expression_literal_get_floating(nd));
+		code_add(gen, VI_LID, result, NONE, NONE, (item_t)index, true);
+	}
+	else if (type_is_boolean(type))
+	{
+		code_add(gen, VI_LI, result, NONE, NONE, expression_literal_get_boolean(nd) ? 1 : 0, false);
+	}
+	else if (type == TYPE_CHARACTER)
+	{
+		code_add(gen, VI_LI, result, NONE, NONE, (item_t)expression_literal_get_character(nd), false);
+	}
+	else if (type_is_integer(gen->sx, type))
+	{
+		code_add(gen, VI_LI, result, NONE, NONE, (item_t)expression_literal_get_integer(nd), false);
+	}
+	else
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	return result;
+}
+
+/**
+ *	Emit address of array element
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with address
+ */
+static item_t emit_element_address(generator *const gen, const node *const nd)
+{
+	const node base = expression_subscript_get_base(nd);
+	const node index = expression_subscript_get_index(nd);
+	if (!type_is_plain_array(gen->sx, expression_get_type(&base)))
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	const item_t array = emit_operand(gen, &base, expression_has_side_effects(&index));
+	const item_t offset = emit_expression(gen, &index);
+	if (array == NONE || offset == NONE)
+	{
+		return NONE;
+	}
+
+	const item_t result = register_create(gen, false, false);
+	code_add(gen, VI_ELEMENT, result, array, offset, (item_t)value_size(expression_get_type(nd)), false);
+	return result;
+}
+
+/**
+ *	Emit subscript expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_subscript_expression(generator *const gen, const node *const nd)
+{
+	const item_t address = emit_element_address(gen, nd);
+	if (address == NONE)
+	{
+		return NONE;
+	}
+
+	const bool is_floating = type_is_floating(expression_get_type(nd));
+	const item_t result = register_create(gen, false, is_floating);
+	code_add(gen, VI_LOAD_AT, result, address, NONE, 0, is_floating);
+	return result;
+}
+
+/**
+ *	Emit call of mathematical function
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	func		Function identifier
+ *
+ *	@return	Register with value
+ */
+static item_t emit_math_call(generator *const gen, const node *const nd, const size_t func)
+{
+	const node argument = expression_call_get_argument(nd, 0);
+	const item_t value = emit_expression(gen, &argument);
+	if (value == NONE)
+	{
+		return NONE;
+	}
+
+	const item_t result = register_create(gen, false, type_is_floating(expression_get_type(nd)));
+	code_add(gen, VI_MATH, result, value, NONE, (item_t)func, true);
+	return result;
+}
+
+/**
+ *	Emit call of assert, message is printed when condition is false
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	@c NONE
+ */
+static item_t emit_assert_call(generator *const gen, const node *const nd)
+{
+	const node message = expression_call_get_argument(nd, 1);
+	if (expression_get_class(&message) != EXPR_LITERAL)
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	const size_t label_end = label_create(gen);
+	const node condition = expression_call_get_argument(nd, 0);
+	code_jump(gen, VI_BNZ, emit_condition(gen, &condition), label_end);
+	code_add(gen, VI_ASSERT, NONE, NONE, NONE, (item_t)expression_literal_get_string(&message), false);
+	code_label(gen, label_end);
+	return NONE;
+}
+
+/**
+ *	Emit call expression.
+ *	Arguments are passed by words of o32 ABI: first four words in registers, others in stack.
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value, @c NONE for void function
+ */
+static item_t emit_call_expression(generator *const gen, const node *const nd)
+{
+	const node callee = expression_call_get_callee(nd);
+	if (expression_get_class(&callee) != EXPR_IDENTIFIER)
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	const size_t func = expression_identifier_get_id(&callee);
+	switch (func)
+	{
+		case BI_ASIN:
+		case BI_COS:
+		case BI_SIN:
+		case BI_EXP:
+		case BI_LOG:
+		case BI_LOG10:
+		case BI_SQRT:
+		case BI_ROUND:
+			return emit_math_call(gen, nd, func);
+
+		case BI_ASSERT:
+			return emit_assert_call(gen, nd);
+
+		case BI_PRINTF:
+			break;
+
+		default:
+			if (func < BEGIN_USER_FUNC)
+			{
+				unsupported(gen);
+				return NONE;
+			}
+			break;
+	}
+
+	const item_t type = expression_get_type(nd);
+	const size_t amount = expression_call_get_arguments_amount(nd);
+	const size_t begin = vector_size(&gen->arguments);
+	if (!type_is_void(type) && !type_is_supported(gen->sx, type))
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	// Все аргументы вычисляются до передачи, так как вложенные вызовы тоже передают аргументы
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		const item_t argument_type = expression_get_type(&argument);
+		if (func == BI_PRINTF && i == 0)
+		{
+			// Строка формата - всегда строковый литерал
+			const item_t format = register_create(gen, false, false);
+			code_add(gen, VI_LA, format, NONE, NONE, (item_t)expression_literal_get_string(&argument), false);
+			vector_add(&gen->arguments, format);
+			continue;
+		}
+
+		if (!type_is_supported(gen->sx, argument_type) && !type_is_plain_array(gen->sx, argument_type))
+		{
+			unsupported(gen);
+			vector_resize(&gen->arguments, begin);
+			return NONE;
+		}
+
+		bool is_clobbered = false;
+		for (size_t j = i + 1; j < amount && !is_clobbered; j++)
+		{
+			const node next = expression_call_get_argument(nd, j);
+			is_clobbered = expression_has_side_effects(&next);
+		}
+
+		vector_add(&gen->arguments, emit_operand(gen, &argument, is_clobbered));
+	}
+
+	size_t word = 0;
+	for (size_t i = 0; i < amount; i++)
+	{
+		const item_t reg = vector_get(&gen->arguments, begin + i);
+		const bool is_floating = register_is_floating(gen, reg);
+
+		// Вещественные аргументы выравниваются на чётное слово
+		word = is_floating ? (word + 1) & ~(size_t)1 : word;
+		code_add(gen, VI_ARG, NONE, reg, NONE, (item_t)word, is_floating);
+		word += is_floating ? 2 : 1;
+	}
+	vector_resize(&gen->arguments, begin);
+
+	const item_t result = type_is_void(type) ? NONE : register_create(gen, false, type_is_floating(type));
+	code_add(gen, VI_CALL, result, NONE, NONE, (item_t)func, type_is_floating(type));
+	return result;
+}
+
+/**
+ *	Emit cast expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_cast_expression(generator *const gen, const node *const nd)
+{
+	const node operand = expression_cast_get_operand(nd);
+	const item_t reg = emit_expression(gen, &operand);
+
+	const bool is_floating_target = type_is_floating(expression_get_type(nd));
+	const bool is_floating_source = type_is_floating(expression_cast_get_source_type(nd));
+	if (is_floating_target == is_floating_source || reg == NONE)
+	{
+		// Целые, символьные и логические значения представляются одинаково
+		return reg;
+	}
+
+	if (is_floating_source)
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	const item_t result = register_create(gen, false, true);
+	code_add(gen, VI_CONVERT, result, reg, NONE, 0, true);
+	return result;
+}
+
+/**
+ *	Emit left side of assignment
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	target		Left side
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int emit_lvalue(generator *const gen, const node *const nd, lvalue *const target)
+{
+	const item_t type = expression_get_type(nd);
+	if (!type_is_supported(gen->sx, type))
+	{
+		unsupported(gen);
+		return -1;
+	}
+
+	target->variable = NONE;
+	target->address = NONE;
+	target->id = SIZE_MAX;
+	target->is_floating = type_is_floating(type);
+
+	switch (expression_get_class(nd))
+	{
+		case EXPR_IDENTIFIER:
+			target->id = expression_identifier_get_id(nd);
+			target->variable = register_get(gen, target->id);
+			return 0;
+
+		case EXPR_SUBSCRIPT:
+			target->address = emit_element_address(gen, nd);
+			return target->address == NONE ? -1 : 0;
+
+		default:
+			unsupported(gen);
+			return -1;
+	}
+}
+
+/**
+ *	Load value of left side of assignment
+ *
+ *	@param	gen			Generator
+ *	@param	target		Left side
+ *
+ *	@return	Register with value
+ */
+static item_t lvalue_load(generator *const gen, const lvalue *const target)
+{
+	if (target->variable != NONE)
+	{
+		return target->variable;
+	}
+
+	const item_t result = register_create(gen, false, target->is_floating);
+	if (target->address != NONE)
+	{
+		code_add(gen, VI_LOAD_AT, result, target->address, NONE, 0, target->is_floating);
+	}
+	else
+	{
+		code_add(gen, VI_LOAD, result, NONE, NONE, (item_t)target->id, target->is_floating);
+	}
+
+	return result;
+}
+
+/**
+ *	Store value into memory of left side of assignment
+ *
+ *	@param	gen			Generator
+ *	@param	target		Left side
+ *	@param	value		Register with value
+ */
+static void lvalue_store(generator *const gen, const lvalue *const target, const item_t value)
+{
+	if (target->address != NONE)
+	{
+		code_add(gen, VI_STORE_AT, NONE, target->address, value, 0, target->is_floating);
+	}
+	else if (target->variable == NONE)
+	{
+		code_add(gen, VI_STORE, NONE, value, NONE, (item_t)target->id, target->is_floating);
+	}
+}
+
+/**
+ *	Emit increment or decrement expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_inc_dec_expression(generator *const gen, const node *const nd)
+{
+	const unary_t operation = expression_unary_get_operator(nd);
+	const node operand = expression_unary_get_operand(nd);
+
+	lvalue target;
+	if (emit_lvalue(gen, &operand, &target))
+	{
+		return NONE;
+	}
+
+	const bool is_floating = target.is_floating;
+	const item_t current = lvalue_load(gen, &target);
+	const item_t one = register_create(gen, false, is_floating);
+	if (is_floating)
+	{
+		code_add(gen, VI_LID, one, NONE, NONE, (item_t)vector_add_double(&gen->constants, 1.0), true);
+	}
+	else
+	{
+		code_add(gen, VI_LI, one, NONE, NONE, 1, false);
+	}
+
+	const bool is_postfix = operation == UN_POSTINC || operation == UN_POSTDEC;
+	const binary_t arithmetic = operation == UN_POSTINC || operation == UN_PREINC ? BIN_ADD : BIN_SUB;
+	item_t result = current;
+	if (is_postfix)
+	{
+		result = register_create(gen, false, is_floating);
+		code_add(gen, VI_MOV, result, current, NONE, 0, is_floating);
+	}
+
+	const item_t value = target.variable != NONE ? target.variable : register_create(gen, false, is_floating);
+	code_add(gen, VI_BINARY, value, current, one, arithmetic, is_floating);
+	lvalue_store(gen, &target, value);
+
+	return is_postfix ? result : value;
+}
+
+/**
+ *	Emit unary expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_unary_expression(generator *const gen, const node *const nd)
+{
+	const unary_t operation = expression_unary_get_operator(nd);
+	const node operand = expression_unary_get_operand(nd);
+	switch (operation)
+	{
+		case UN_POSTINC:
+		case UN_POSTDEC:
+		case UN_PREINC:
+		case UN_PREDEC:
+			return emit_inc_dec_expression(gen, nd);
+
+		case UN_MINUS:
+		case UN_NOT:
+		case UN_ABS:
+		{
+			const item_t reg = emit_expression(gen, &operand);
+			const bool is_floating = register_is_floating(gen, reg);
+			const item_t result = register_create(gen, false, is_floating);
+			code_add(gen, VI_UNARY, result, reg, NONE, operation, is_floating);
+			return result;
+		}
+
+		case UN_LOGNOT:
+		{
+			const item_t reg = emit_expression(gen, &operand);
+			const item_t result = register_create(gen, false, false);
+			if (register_is_floating(gen, reg))
+			{
+				code_add(gen, VI_BINARY, result, reg, emit_floating_zero(gen), BIN_EQ, true);
+			}
+			else
+			{
+				code_add(gen, VI_UNARY, result, reg, NONE, operation, false);
+			}
+			return result;
+		}
+
+		case UN_UPB:
+		{
+			if (!type_is_plain_array(gen->sx, expression_get_type(&operand)))
+			{
+				unsupported(gen);
+				return NONE;
+			}
+
+			// Количество элементов хранится в слове перед нулевым элементом
+			const item_t array = emit_expression(gen, &operand);
+			const item_t result = register_create(gen, false, false);
+			code_add(gen, VI_LOAD_AT, result, array, NONE, -4, false);
+			return result;
+		}
+
+		default:
+			unsupported(gen);
+			return NONE;
+	}
+}
+
+/**
+ *	Emit logical expression with short-circuit evaluation
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_logical_expression(generator *const gen, const node *const nd)
+{
+	const bool is_and = expression_binary_get_operator(nd) == BIN_LOG_AND;
+	const virtual_instruction_t skip = is_and ? VI_BZ : VI_BNZ;
+	const size_t label_end = label_create(gen);
+
+	const item_t result = register_create(gen, false, false);
+	code_add(gen, VI_LI, result, NONE, NONE, is_and ? 0 : 1, false);
+
+	const node LHS = expression_binary_get_LHS(nd);
+	code_jump(gen, skip, emit_condition(gen, &LHS), label_end);
+
+	const node RHS = expression_binary_get_RHS(nd);
+	code_jump(gen, skip, emit_condition(gen, &RHS), label_end);
+
+	code_add(gen, VI_LI, result, NONE, NONE, is_and ? 1 : 0, false);
+	code_label(gen, label_end);
+	return result;
+}
+
+/**
+ *	Emit binary expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_binary_expression(generator *const gen, const node *const nd)
+{
+	const binary_t operation = expression_binary_get_operator(nd);
+	const node LHS = expression_binary_get_LHS(nd);
+	const node RHS = expression_binary_get_RHS(nd);
+
+	switch (operation)
+	{
+		case BIN_COMMA:
+			emit_expression(gen, &LHS);
+			return emit_expression(gen, &RHS);
+
+		case BIN_LOG_AND:
+		case BIN_LOG_OR:
+			return emit_logical_expression(gen, nd);
+
+		default:
+		{
+			const item_t fst = emit_operand(gen, &LHS, expression_has_side_effects(&RHS));
+			const item_t snd = emit_expression(gen, &RHS);
+			const item_t result = register_create(gen, false, type_is_floating(expression_get_type(nd)));
+			code_add(gen, VI_BINARY, result, fst, snd, operation, type_is_floating(expression_get_type(&LHS)));
+			return result;
+		}
+	}
+}
+
+/**
+ *	Emit ternary expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_ternary_expression(generator *const gen, const node *const nd)
+{
+	const size_t label_else = label_create(gen);
+	const size_t label_end = label_create(gen);
+	const bool is_floating = type_is_floating(expression_get_type(nd));
+	const item_t result = register_create(gen, false, is_floating);
+
+	const node condition = expression_ternary_get_condition(nd);
+	code_jump(gen, VI_BZ, emit_condition(gen, &condition), label_else);
+
+	const node LHS = expression_ternary_get_LHS(nd);
+	code_add(gen, VI_MOV, result, emit_expression(gen, &LHS), NONE, 0, is_floating);
+	code_jump(gen, VI_JUMP, NONE, label_end);
+
+	code_label(gen, label_else);
+	const node RHS = expression_ternary_get_RHS(nd);
+	code_add(gen, VI_MOV, result, emit_expression(gen, &RHS), NONE, 0, is_floating);
+
+	code_label(gen, label_end);
+	return result;
+}
+
+/**
+ *	Emit assignment expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_assignment_expression(generator *const gen, const node *const nd)
+{
+	const node LHS = expression_assignment_get_LHS(nd);
+	lvalue target;
+	if (emit_lvalue(gen, &LHS, &target))
+	{
+		return NONE;
+	}
+
+	const binary_t operation = expression_assignment_get_operator(nd);
+	const node RHS = expression_assignment_get_RHS(nd);
+	item_t value = emit_expression(gen, &RHS);
+	if (value == NONE)
+	{
+		return NONE;
+	}
+
+	if (operation != BIN_ASSIGN)
+	{
+		const item_t current = lvalue_load(gen, &target);
+		const item_t result = target.variable != NONE ? target.variable : register_create(gen, false, target.is_floating);
+		code_add(gen, VI_BINARY, result, current, value, assignment_to_binary(operation), target.is_floating);
+		value = result;
+	}
+	else if (target.variable != NONE)
+	{
+		code_move(gen, target.variable, value);
+		value = target.variable;
+	}
+
+	lvalue_store(gen, &target, value);
+	return value;
+}
+
+/**
+ *	Emit expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value, @c NONE for void expression
+ */
+static item_t emit_expression(generator *const gen, const node *const nd)
+{
+	switch (expression_get_class(nd))
+	{
+		case EXPR_IDENTIFIER:
+			return emit_identifier_expression(gen, nd);
+
+		case EXPR_LITERAL:
+			return emit_literal_expression(gen, nd);
+
+		case EXPR_SUBSCRIPT:
+			return emit_subscript_expression(gen, nd);
+
+		case EXPR_CALL:
+			return emit_call_expression(gen, nd);
+
+		case EXPR_CAST:
+			return emit_cast_expression(gen, nd);
+
+		case EXPR_UNARY:
+			return emit_unary_expression(gen, nd);
+
+		case EXPR_BINARY:
+			return emit_binary_expression(gen, nd);
+
+		case EXPR_TERNARY:
+			return emit_ternary_expression(gen, nd);
+
+		case EXPR_ASSIGNMENT:
+			return emit_assignment_expression(gen, nd);
+
+		default:
+			unsupported(gen);
+			return NONE;
+	}
+}
+
+
+/*
+ *	 _____     ______     ______     __         ______     ______     ______     ______   __     ______     __   __     ______
+ *	/\  __-.  /\  ___\   /\  ___\   /\ \       /\  __ \   /\  == \   /\  __ \   /\__  _\ /\ \   /\  __ \   /\ "-.\ \   /\  ___\
+ *	\ \ \/\ \ \ \  __\   \ \ \____  \ \ \____  \ \  __ \  \ \  __<   \ \  __ \  \/_/\ \/ \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
+ *	 \ \____-  \ \_____\  \ \_____\  \ \_____\  \ \_\ \_\  \ \_\ \_\  \ \_\ \_\    \ \_\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
+ *	  \/____/   \/_____/   \/_____/   \/_____/   \/_/\/_/   \/_/ /_/   \/_/\/_/     \/_/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+ */
+
+
+/**
+ *	Emit local array declaration.
+ *	Array is allocated in stack, its size is stored in the word before the first element.
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	type		Array type
+ *
+ *	@return	Register with pointer to the first element
+ */
+static item_t emit_local_array_declaration(generator *const gen, const node *const nd, const item_t type)
+{
+	const item_t element_type = type_array_get_element_type(gen->sx, type);
+	const bool is_floating = type_is_floating(element_type);
+	const bool has_initializer = declaration_variable_has_initializer(nd);
+	const node initializer = has_initializer ? declaration_variable_get_initializer(nd) : node_broken();
+	if (has_initializer && expression_get_class(&initializer) != EXPR_INITIALIZER)
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	item_t count = NONE;
+	const node bound = declaration_variable_get_bound(nd, 0);
+	if (expression_get_class(&bound) != EXPR_EMPTY_BOUND)
+	{
+		count = emit_expression(gen, &bound);
+	}
+	else if (has_initializer)
+	{
+		count = register_create(gen, false, false);
+		code_add(gen, VI_LI, count, NONE, NONE, (item_t)expression_initializer_get_size(&initializer), false);
+	}
+
+	if (count == NONE)
+	{
+		unsupported(gen);
+		return NONE;
+	}
+
+	const item_t array = register_create(gen, true, false);
+	code_add(gen, VI_ALLOCA, array, count, NONE, (item_t)value_size(element_type), false);
+
+	const size_t size = has_initializer ? expression_initializer_get_size(&initializer) : 0;
+	const bool is_packed = has_initializer && expression_initializer_is_packed(&initializer);
+	for (size_t i = 0; i < size; i++)
+	{
+		item_t value = NONE;
+		if (is_packed && is_floating)
+		{
+			value = register_create(gen, false, true);
+			const size_t index = vector_add_double(&gen->constants, expression_initializer_get_floating(&initializer, i));
+			code_add(gen, VI_LID, value, NONE, NONE, (item_t)index, true);
+		}
+		else if (is_packed)
+		{
+			value = register_create(gen, false, false);
+			code_add(gen, VI_LI, value, NONE, NONE, (item_t)expression_initializer_get_integer(&initializer, i), false);
+		}
+		else
+		{
+			const node subexpr = expression_initializer_get_subexpr(&initializer, i);
+			value = emit_expression(gen, &subexpr);
+		}
+		code_add(gen, VI_STORE_AT, NONE, array, value, (item_t)(i * value_size(element_type)), is_floating);
+	}
+
+	return array;
+}
+
+/**
+ *	Emit local variable declaration
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_local_declaration(generator *const gen, const node *const nd)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(gen->sx, id);
+	if (declaration_variable_get_bounds_amount(nd) == 1 && type_is_plain_array(gen->sx, type))
+	{
+		register_set(gen, id, emit_local_array_declaration(gen, nd, type));
+		return;
+	}
+
+	if (declaration_variable_get_bounds_amount(nd) != 0 || !type_is_supported(gen->sx, type))
+	{
+		unsupported(gen);
+		return;
+	}
+
+	const item_t variable = register_create(gen, true, type_is_floating(type));
+	if (declaration_variable_has_initializer(nd))
+	{
+		const node initializer = declaration_variable_get_initializer(nd);
+		code_move(gen, variable, emit_expression(gen, &initializer));
+	}
+
+	// Регистр назначается после инициализатора, который ещё не видит переменную
+	register_set(gen, id, variable);
+}
+
+/**
+ *	Print literal as data of global variable
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Literal, possibly under cast
+ *	@param	type		Type of variable
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int literal_to_io(generator *const gen, const node *const nd, const item_t type)
+{
+	node literal = *nd;
+	if (expression_get_class(&literal) == EXPR_CAST)
+	{
+		literal = expression_cast_get_operand(&literal);
+	}
+
+	if (expression_get_class(&literal) != EXPR_LITERAL)
+	{
+		unsupported(gen);
+		return -1;
+	}
+
+	const item_t value_type = expression_get_type(&literal);
+	if (type_is_floating(value_type))
+	{
+		uni_printf(gen->sx->io, "\t.double\t%.17g\n", expression_literal_get_floating(&literal));
+	}
+	else if (type_is_floating(type))
+	{
+		uni_printf(gen->sx->io, "\t.double\t%" PRId64 "\n", expression_literal_get_integer(&literal));
+	}
+	else if (type_is_boolean(value_type))
+	{
+		uni_printf(gen->sx->io, "\t.word\t%i\n", expression_literal_get_boolean(&literal) ? 1 : 0);
+	}
+	else if (value_type == TYPE_CHARACTER)
+	{
+		uni_printf(gen->sx->io, "\t.word\t%" PRIu32 "\n", (uint32_t)expression_literal_get_character(&literal));
+	}
+	else
+	{
+		uni_printf(gen->sx->io, "\t.word\t%" PRId64 "\n", expression_literal_get_integer(&literal));
+	}
+
+	return 0;
+}
+
+/**
+ *	Emit global array declaration, bound must be constant or set by initializer
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	type		Array type
+ */
+static void emit_global_array_declaration(generator *const gen, const node *const nd, const item_t type)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	const item_t element_type = type_array_get_element_type(gen->sx, type);
+	const bool has_initializer = declaration_variable_has_initializer(nd);
+	const node initializer = has_initializer ? declaration_variable_get_initializer(nd) : node_broken();
+	const size_t size = has_initializer ? expression_initializer_get_size(&initializer) : 0;
+	if (has_initializer && expression_get_class(&initializer) != EXPR_INITIALIZER)
+	{
+		unsupported(gen);
+		return;
+	}
+
+	node bound = declaration_variable_get_bound(nd, 0);
+	if (expression_get_class(&bound) == EXPR_CAST)
+	{
+		bound = expression_cast_get_operand(&bound);
+	}
+
+	size_t count = size;
+	if (expression_get_class(&bound) == EXPR_LITERAL && type_is_integer(gen->sx, expression_get_type(&bound)))
+	{
+		const int64_t value = expression_literal_get_integer(&bound);
+		count = value > 0 ? (size_t)value : 0;
+	}
+	else if (expression_get_class(&bound) != EXPR_EMPTY_BOUND || !has_initializer)
+	{
+		unsupported(gen);
+		return;
+	}
+
+	// Перед массивом хранится количество элементов, нулевой элемент выровнен на двойное слово
+	uni_printf(gen->sx->io, "\n\t.data\n\t.align\t3\n\t.word\t0, %zu\nvar.%zu:\n", count, id);
+	// Упакованные значения уже приведены к типу элементов
+	const bool is_packed = size != 0 && expression_initializer_is_packed(&initializer);
+	for (size_t i = 0; i < size && is_packed; i++)
+	{
+		if (type_is_floating(element_type))
+		{
+			uni_printf(gen->sx->io, "\t.double\t%.17g\n", expression_initializer_get_floating(&initializer, i));
+		}
+		else
+		{
+			uni_printf(gen->sx->io, "\t.word\t%" PRId64 "\n", expression_initializer_get_integer(&initializer, i));
+		}
+	}
+
+	for (size_t i = 0; i < size && !is_packed; i++)
+	{
+		const node subexpr = expression_initializer_get_subexpr(&initializer, i);
+		if (literal_to_io(gen, &subexpr, element_type))
+		{
+			return;
+		}
+	}
+
+	if (count > size)
+	{
+		uni_printf(gen->sx->io, "\t.space\t%zu\n", (count - size) * value_size(element_type));
+	}
+}
+
+/**
+ *	Emit global variable declaration
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_global_declaration(generator *const gen, const node *const nd)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(gen->sx, id);
+	if (declaration_variable_get_bounds_amount(nd) == 1 && type_is_plain_array(gen->sx, type))
+	{
+		emit_global_array_declaration(gen, nd, type);
+		return;
+	}
+
+	if (declaration_variable_get_bounds_amount(nd) != 0 || !type_is_supported(gen->sx, type))
+	{
+		unsupported(gen);
+		return;
+	}
+
+	uni_printf(gen->sx->io, "\n\t.data\n\t.align\t%i\nvar.%zu:\n", type_is_floating(type) ? 3 : 2, id);
+	if (!declaration_variable_has_initializer(nd))
+	{
+		uni_printf(gen->sx->io, "\t.space\t%zu\n", value_size(type));
+		return;
+	}
+
+	const node initializer = declaration_variable_get_initializer(nd);
+	literal_to_io(gen, &initializer, type);
+}
+
+
+/*
+ *	 ______     __         __         ______     ______     ______     ______   __     ______     __   __
+ *	/\  __ \   /\ \       /\ \       /\  __ \   /\  ___\   /\  __ \   /\__  _\ /\ \   /\  __ \   /\ "-.\ \
+ *	\ \  __ \  \ \ \____  \ \ \____  \ \ \/\ \  \ \ \____  \ \  __ \  \/_/\ \/ \ \ \  \ \ \/\ \  \ \ \-.  \
+ *	 \ \_\ \_\  \ \_____\  \ \_____\  \ \_____\  \ \_____\  \ \_\ \_\    \ \_\  \ \_\  \ \_____\  \ \_\\"\_\
+ *	  \/_/\/_/   \/_____/   \/_____/   \/_____/   \/_____/   \/_/\/_/     \/_/   \/_/   \/_____/   \/_/ \/_/
+ */
+
+
+static int interval_cmp(const void *const fst, const void *const snd)
+{
+	const interval *const a = fst;
+	const interval *const b = snd;
+	return a->start < b->start ? -1 : a->start > b->start ? 1 : 0;
+}
+
+static inline void interval_use(interval *const intervals, const item_t reg, const size_t index)
+{
+	if (reg == NONE)
+	{
+		return;
+	}
+
+	interval *const current = &intervals[reg];
+	current->start = index < current->start ? index : current->start;
+	current->end = index > current->end ? index : current->end;
+}
+
+static inline bool instruction_is_call(const generator *const gen, const size_t index)
+{
+	const item_t operation = code_get(gen, index, VF_OPERATION);
+	return operation == VI_CALL || operation == VI_ASSERT
+		|| (operation == VI_MATH && code_get(gen, index, VF_ARGUMENT) != BI_SQRT);
+}
+
+/**
+ *	Calculate live intervals of virtual registers.
+ *	Variables live through the whole loop, if they are used inside it.
+ *
+ *	@param	gen			Generator
+ *	@param	intervals	Intervals by virtual registers
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int intervals_calculate(const generator *const gen, interval *const intervals)
+{
+	const size_t amount = code_amount(gen);
+	const size_t registers = vector_size(&gen->kinds);
+	for (size_t i = 0; i < registers; i++)
+	{
+		intervals[i] = (interval){ .start = SIZE_MAX, .end = 0, .reg = i };
+	}
+
+	size_t *const labels = malloc((gen->label_num + 1) * sizeof(size_t));
+	if (labels == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		if (code_get(gen, i, VF_OPERATION) == VI_LABEL)
+		{
+			labels[code_get(gen, i, VF_ARGUMENT)] = i;
+		}
+
+		interval_use(intervals, code_get(gen, i, VF_DESTINATION), i);
+		interval_use(intervals, code_get(gen, i, VF_FIRST), i);
+		interval_use(intervals, code_get(gen, i, VF_SECOND), i);
+	}
+
+	// Обратный переход продлевает переменные, которые используются между меткой и переходом
+	bool was_changed = true;
+	while (was_changed)
+	{
+		was_changed = false;
+		for (size_t i = 0; i < amount; i++)
+		{
+			const item_t operation = code_get(gen, i, VF_OPERATION);
+			if (operation != VI_JUMP && operation != VI_BZ && operation != VI_BNZ)
+			{
+				continue;
+			}
+
+			const size_t target = labels[code_get(gen, i, VF_ARGUMENT)];
+			if (target > i)
+			{
+				continue;
+			}
+
+			for (size_t j = 0; j < registers; j++)
+			{
+				interval *const current = &intervals[j];
+				if (register_is_variable(gen, (item_t)j) && current->start <= i && current->end >= target
+					&& (current->start > target || current->end < i))
+				{
+					current->start = current->start < target ? current->start : target;
+					current->end = current->end > i ? current->end : i;
+					was_changed = true;
+				}
+			}
+		}
+	}
+
+	free(labels);
+	return 0;
+}
+
+/**
+ *	Choose machine register for interval.
+ *	Interval crossing a call gets only callee-saved register.
+ *
+ *	@param	is_floating	Set for floating register
+ *	@param	is_crossing	Set, if interval crosses a call
+ *	@param	index		Index of candidate
+ *
+ *	@return	Machine register, @c SIZE_MAX after the last candidate
+ */
+static size_t register_candidate(const bool is_floating, const bool is_crossing, const size_t index)
+{
+	const size_t *const caller = is_floating ? FLOATING_CALLER_SAVED : INTEGER_CALLER_SAVED;
+	const size_t *const callee = is_floating ? FLOATING_CALLEE_SAVED : INTEGER_CALLEE_SAVED;
+	const size_t caller_amount = is_floating
+		? sizeof(FLOATING_CALLER_SAVED) / sizeof(size_t)
+		: sizeof(INTEGER_CALLER_SAVED) / sizeof(size_t);
+	const size_t callee_amount = is_floating
+		? sizeof(FLOATING_CALLEE_SAVED) / sizeof(size_t)
+		: sizeof(INTEGER_CALLEE_SAVED) / sizeof(size_t);
+
+	if (is_crossing)
+	{
+		return index < callee_amount ? callee[index] : SIZE_MAX;
+	}
+
+	if (index < caller_amount)
+	{
+		return caller[index];
+	}
+
+	return index - caller_amount < callee_amount ? callee[index - caller_amount] : SIZE_MAX;
+}
+
+/**
+ *	Allocate machine registers by linear scan.
+ *	Register with the furthest end of interval is spilled into frame slot.
+ *
+ *	@param	gen			Generator
+ *	@param	locations	Machine registers or negative frame slots by virtual registers
+ *	@param	spills		Number of frame slots
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int registers_allocate(const generator *const gen, item_t *const locations, size_t *const spills)
+{
+	const size_t amount = code_amount(gen);
+	const size_t registers = vector_size(&gen->kinds);
+	interval *const intervals = malloc((registers + 1) * sizeof(interval));
+	size_t *const calls = malloc((amount + 1) * sizeof(size_t));
+	if (intervals == NULL || calls == NULL || intervals_calculate(gen, intervals))
+	{
+		free(intervals);
+		free(calls);
+		return -1;
+	}
+
+	// Количество вызовов перед каждой инструкцией
+	calls[0] = 0;
+	for (size_t i = 0; i < amount; i++)
+	{
+		calls[i + 1] = calls[i] + (instruction_is_call(gen, i) ? 1 : 0);
+	}
+
+	qsort(intervals, registers, sizeof(interval), &interval_cmp);
+	for (size_t i = 0; i < registers; i++)
+	{
+		locations[i] = 0;
+	}
+
+	// Интервал, занимающий машинный регистр, плюс один
+	size_t owners[MACHINE_REGISTERS] = { 0 };
+
+	*spills = 0;
+	for (size_t i = 0; i < registers && intervals[i].start != SIZE_MAX; i++)
+	{
+		const interval *const current = &intervals[i];
+		const bool is_floating = register_is_floating(gen, (item_t)current->reg);
+		const bool is_crossing = current->end > current->start + 1 && calls[current->end] != calls[current->start + 1];
+
+		// Освобождение регистров, интервалы которых закончились
+		for (size_t j = 0; j < MACHINE_REGISTERS; j++)
+		{
+			if (owners[j] != 0 && intervals[owners[j] - 1].end < current->start)
+			{
+				owners[j] = 0;
+			}
+		}
+
+		size_t reg = SIZE_MAX;
+		size_t furthest = SIZE_MAX;
+		for (size_t j = 0; register_candidate(is_floating, is_crossing, j) != SIZE_MAX && reg == SIZE_MAX; j++)
+		{
+			const size_t candidate = register_candidate(is_floating, is_crossing, j);
+			if (owners[candidate] == 0)
+			{
+				reg = candidate;
+			}
+			else if (furthest == SIZE_MAX || intervals[owners[candidate] - 1].end > intervals[owners[furthest] - 1].end)
+			{
+				furthest = candidate;
+			}
+		}
+
+		if (reg != SIZE_MAX)
+		{
+			locations[current->reg] = (item_t)reg;
+			owners[reg] = i + 1;
+			continue;
+		}
+
+		const interval *const spilled = &intervals[owners[furthest] - 1];
+		if (spilled->end > current->end)
+		{
+			locations[current->reg] = (item_t)furthest;
+			locations[spilled->reg] = -(item_t)++*spills;
+			owners[furthest] = i + 1;
+		}
+		else
+		{
+			locations[current->reg] = -(item_t)++*spills;
+		}
+	}
+
+	free(intervals);
+	free(calls);
+	return 0;
+}
+
+
+/*
+ *	 __         ______     __     __     ______     ______     __     __   __     ______
+ *	/\ \       /\  __ \   /\ \  _ \ \   /\  ___\   /\  == \   /\ \   /\ "-.\ \   /\  ___\
+ *	\ \ \____  \ \ \/\ \  \ \ \/ ".\ \  \ \  __\   \ \  __<   \ \ \  \ \ \-.  \  \ \ \__ \
+ *	 \ \_____\  \ \_____\  \ \__/".~\_\  \ \_____\  \ \_\ \_\  \ \_\  \ \_\\"\_\  \ \_____\
+ *	  \/_____/   \/_____/   \/_/   \/_/   \/_____/   \/_/ /_/   \/_/   \/_/ \/_/   \/_____/
+ */
+
+
+static inline item_t machine_get(const generator *const gen, const size_t index, const machine_field_t field)
+{
+	return vector_get(&gen->instructions, index * MACHINE_FIELDS + field);
+}
+
+static void machine_add(generator *const gen, const machine_instruction_t operation
+	, const size_t fst, const size_t snd, const size_t thd, const item_t immediate)
+{
+	vector_add(&gen->instructions, operation);
+	vector_add(&gen->instructions, (item_t)fst);
+	vector_add(&gen->instructions, (item_t)snd);
+	vector_add(&gen->instructions, (item_t)thd);
+	vector_add(&gen->instructions, immediate);
+	vector_add(&gen->instructions, SYM_NONE);
+	vector_add(&gen->instructions, 0);
+}
+
+static void machine_symbol(generator *const gen, const machine_instruction_t operation
+	, const size_t fst, const size_t snd, const symbol_t symbol, const item_t value)
+{
+	vector_add(&gen->instructions, operation);
+	vector_add(&gen->instructions, (item_t)fst);
+	vector_add(&gen->instructions, (item_t)snd);
+	vector_add(&gen->instructions, R_ZERO);
+	vector_add(&gen->instructions, 0);
+	vector_add(&gen->instructions, symbol);
+	vector_add(&gen->instructions, value);
+}
+
+static inline void machine_jump(generator *const gen, const machine_instruction_t operation
+	, const size_t fst, const symbol_t symbol, const item_t value)
+{
+	machine_symbol(gen, operation, fst, R_ZERO, symbol, value);
+	machine_add(gen, MI_NOP, R_ZERO, R_ZERO, R_ZERO, 0);
+}
+
+static void machine_load_immediate(generator *const gen, const size_t reg, const item_t value)
+{
+	const int32_t word = (int32_t)value;
+	if (word >= -32768 && word <= 32767)
+	{
+		machine_add(gen, MI_ADDIU, reg, R_ZERO, R_ZERO, word);
+	}
+	else if (word >= 0 && word <= 65535)
+	{
+		machine_add(gen, MI_ORI, reg, R_ZERO, R_ZERO, word);
+	}
+	else
+	{
+		machine_add(gen, MI_LUI, reg, R_ZERO, R_ZERO, (item_t)(((uint32_t)word >> 16) & 0xFFFF));
+		if ((word & 0xFFFF) != 0)
+		{
+			machine_add(gen, MI_ORI, reg, reg, R_ZERO, word & 0xFFFF);
+		}
+	}
+}
+
+static inline void machine_move(generator *const gen, const size_t dst, const size_t src, const bool is_floating)
+{
+	if (dst != src)
+	{
+		machine_add(gen, is_floating ? MI_MOV_D : MI_MOVE, dst, src, R_ZERO, 0);
+	}
+}
+
+static inline item_t slot_offset(const frame *const fr, const item_t location)
+{
+	return (item_t)(fr->outgoing + 8 * (size_t)(-location - 1));
+}
+
+/**
+ *	Get machine register of operand, spilled operand is loaded into scratch register
+ *
+ *	@param	gen			Generator
+ *	@param	fr			Frame of function
+ *	@param	locations	Locations of virtual registers
+ *	@param	reg			Virtual register
+ *	@param	scratch		Number of scratch register
+ *
+ *	@return	Machine register
+ */
+static size_t operand_lower(generator *const gen, const frame *const fr, const item_t *const locations
+	, const item_t reg, const size_t scratch)
+{
+	const item_t location = locations[reg];
+	if (location >= 0)
+	{
+		return (size_t)location;
+	}
+
+	const bool is_floating = register_is_floating(gen, reg);
+	const size_t result = is_floating ? (scratch == 0 ? R_F16 : R_F18) : (scratch == 0 ? R_T8 : R_T9);
+	machine_add(gen, is_floating ? MI_LDC1 : MI_LW, result, R_FP, R_ZERO, slot_offset(fr, location));
+	return result;
+}
+
+static void unary_lower(generator *const gen, const unary_t operation, const size_t dst, const size_t src
+	, const bool is_floating)
+{
+	switch (operation)
+	{
+		case UN_MINUS:
+			machine_add(gen, is_floating ? MI_NEG_D : MI_SUBU, dst, is_floating ? src : R_ZERO, src, 0);
+			break;
+		case UN_NOT:
+			machine_add(gen, MI_NOR, dst, src, R_ZERO, 0);
+			break;
+		case UN_LOGNOT:
+			machine_add(gen, MI_SLTIU, dst, src, R_ZERO, 1);
+			break;
+		default:
+			if (is_floating)
+			{
+				machine_add(gen, MI_ABS_D, dst, src, R_ZERO, 0);
+				break;
+			}
+
+			// Модуль без ветвлений через маску знака
+			machine_add(gen, MI_SRA, R_AT, src, R_ZERO, 31);
+			machine_add(gen, MI_XOR, dst, src, R_AT, 0);
+			machine_add(gen, MI_SUBU, dst, dst, R_AT, 0);
+			break;
+	}
+}
+
+static void floating_binary_lower(generator *const gen, const binary_t operation, const size_t dst
+	, const size_t fst, const size_t snd)
+{
+	switch (operation)
+	{
+		case BIN_MUL:
+			machine_add(gen, MI_MUL_D, dst, fst, snd, 0);
+			return;
+		case BIN_DIV:
+			machine_add(gen, MI_DIV_D, dst, fst, snd, 0);
+			return;
+		case BIN_ADD:
+			machine_add(gen, MI_ADD_D, dst, fst, snd, 0);
+			return;
+		case BIN_SUB:
+			machine_add(gen, MI_SUB_D, dst, fst, snd, 0);
+			return;
+		default:
+			break;
+	}
+
+	// Сравнение устанавливает флаг сопроцессора, по которому обнуляется заготовленная единица
+	const bool is_swapped = operation == BIN_GT || operation == BIN_GE;
+	const machine_instruction_t compare = operation == BIN_LT || operation == BIN_GT
+		? MI_C_LT_D
+		: operation == BIN_LE || operation == BIN_GE
+			? MI_C_LE_D
+			: MI_C_EQ_D;
+
+	machine_add(gen, MI_ADDIU, dst, R_ZERO, R_ZERO, 1);
+	machine_add(gen, compare, is_swapped ? snd : fst, is_swapped ? fst : snd, R_ZERO, 0);
+	machine_add(gen, operation == BIN_NE ? MI_MOVT : MI_MOVF, dst, R_ZERO, R_ZERO, 0);
+}
+
+static void binary_lower(generator *const gen, const binary_t operation, const size_t dst
+	, const size_t fst, const size_t snd, const bool is_floating)
+{
+	if (is_floating)
+	{
+		floating_binary_lower(gen, operation, dst, fst, snd);
+		return;
+	}
+
+	switch (operation)
+	{
+		case BIN_MUL:
+			machine_add(gen, MI_MUL, dst, fst, snd, 0);
+			break;
+		case BIN_DIV:
+			machine_add(gen, MI_DIV, R_ZERO, fst, snd, 0);
+			machine_add(gen, MI_MFLO, dst, R_ZERO, R_ZERO, 0);
+			break;
+		case BIN_REM:
+			machine_add(gen, MI_DIV, R_ZERO, fst, snd, 0);
+			machine_add(gen, MI_MFHI, dst, R_ZERO, R_ZERO, 0);
+			break;
+		case BIN_ADD:
+			machine_add(gen, MI_ADDU, dst, fst, snd, 0);
+			break;
+		case BIN_SUB:
+			machine_add(gen, MI_SUBU, dst, fst, snd, 0);
+			break;
+		case BIN_SHL:
+			machine_add(gen, MI_SLLV, dst, fst, snd, 0);
+			break;
+		case BIN_SHR:
+			machine_add(gen, MI_SRAV, dst, fst, snd, 0);
+			break;
+		case BIN_LT:
+			machine_add(gen, MI_SLT, dst, fst, snd, 0);
+			break;
+		case BIN_GT:
+			machine_add(gen, MI_SLT, dst, snd, fst, 0);
+			break;
+		case BIN_LE:
+			machine_add(gen, MI_SLT, dst, snd, fst, 0);
+			machine_add(gen, MI_XORI, dst, dst, R_ZERO, 1);
+			break;
+		case BIN_GE:
+			machine_add(gen, MI_SLT, dst, fst, snd, 0);
+			machine_add(gen, MI_XORI, dst, dst, R_ZERO, 1);
+			break;
+		case BIN_EQ:
+			machine_add(gen, MI_XOR, dst, fst, snd, 0);
+			machine_add(gen, MI_SLTIU, dst, dst, R_ZERO, 1);
+			break;
+		case BIN_NE:
+			machine_add(gen, MI_XOR, dst, fst, snd, 0);
+			machine_add(gen, MI_SLTU, dst, R_ZERO, dst, 0);
+			break;
+		case BIN_AND:
+			machine_add(gen, MI_AND, dst, fst, snd, 0);
+			break;
+		case BIN_XOR:
+			machine_add(gen, MI_XOR, dst, fst, snd, 0);
+			break;
+		default:
+			machine_add(gen, MI_OR, dst, fst, snd, 0);
+			break;
+	}
+}
+
+static void argument_lower(generator *const gen, const size_t src, const size_t word, const bool is_floating)
+{
+	if (word >= ARGUMENT_REGISTERS)
+	{
+		machine_add(gen, is_floating ? MI_SDC1 : MI_SW, src, R_SP, R_ZERO, (item_t)(4 * word));
+	}
+	else if (is_floating)
+	{
+		// Младшее слово вещественного числа лежит в регистре с меньшим номером
+		machine_add(gen, MI_MFC1, R_A0 + word, src, R_ZERO, 0);
+		machine_add(gen, MI_MFC1, R_A0 + word + 1, src + 1, R_ZERO, 0);
+	}
+	else
+	{
+		machine_move(gen, R_A0 + word, src, false);
+	}
+}
+
+static void parameter_lower(generator *const gen, const frame *const fr, const size_t dst, const size_t word
+	, const bool is_floating)
+{
+	if (word >= ARGUMENT_REGISTERS)
+	{
+		machine_add(gen, is_floating ? MI_LDC1 : MI_LW, dst, R_FP, R_ZERO, (item_t)(fr->size + 4 * word));
+	}
+	else if (is_floating)
+	{
+		machine_add(gen, MI_MTC1, R_A0 + word, dst, R_ZERO, 0);
+		machine_add(gen, MI_MTC1, R_A0 + word + 1, dst + 1, R_ZERO, 0);
+	}
+	else
+	{
+		machine_move(gen, dst, R_A0 + word, false);
+	}
+}
+
+static void math_lower(generator *const gen, const size_t func, const size_t dst, const size_t src)
+{
+	if (func == BI_SQRT)
+	{
+		machine_add(gen, MI_SQRT_D, dst, src, R_ZERO, 0);
+		return;
+	}
+
+	// Библиотечные функции получают вещественный аргумент в $f12 и возвращают результат в $f0
+	machine_move(gen, R_F12, src, true);
+	machine_jump(gen, MI_JAL, R_ZERO, SYM_FUNCTION, (item_t)func);
+	if (func == BI_ROUND)
+	{
+		machine_add(gen, MI_TRUNC_W_D, R_F0, R_F0, R_ZERO, 0);
+		machine_add(gen, MI_MFC1, dst, R_F0, R_ZERO, 0);
+	}
+	else
+	{
+		machine_move(gen, dst, R_F0, true);
+	}
+}
+
+static void alloca_lower(generator *const gen, const frame *const fr, const size_t dst, const size_t count
+	, const size_t size)
+{
+	// Размер массива вместе со словами заголовка округляется до двойного слова
+	machine_add(gen, MI_SLL, R_AT, count, R_ZERO, size == 8 ? 3 : 2);
+	machine_add(gen, MI_ADDIU, R_AT, R_AT, R_ZERO, 15);
+	machine_add(gen, MI_SRL, R_AT, R_AT, R_ZERO, 3);
+	machine_add(gen, MI_SLL, R_AT, R_AT, R_ZERO, 3);
+	machine_add(gen, MI_SUBU, R_SP, R_SP, R_AT, 0);
+
+	// Область аргументов вызовов остаётся в начале кадра, массив располагается за ней
+	machine_add(gen, MI_SW, count, R_SP, R_ZERO, (item_t)(fr->outgoing + 4));
+	machine_add(gen, MI_ADDIU, dst, R_SP, R_ZERO, (item_t)(fr->outgoing + 8));
+}
+
+/**
+ *	Lower virtual instruction into machine instructions
+ *
+ *	@param	gen			Generator
+ *	@param	fr			Frame of function
+ *	@param	locations	Locations of virtual registers
+ *	@param	index		Index of instruction
+ */
+static void instruction_lower(generator *const gen, const frame *const fr, const item_t *const locations
+	, const size_t index)
+{
+	const virtual_instruction_t operation = (virtual_instruction_t)code_get(gen, index, VF_OPERATION);
+	const item_t dst = code_get(gen, index, VF_DESTINATION);
+	const item_t fst = code_get(gen, index, VF_FIRST);
+	const item_t snd = code_get(gen, index, VF_SECOND);
+	const item_t argument = code_get(gen, index, VF_ARGUMENT);
+	const bool is_floating = code_get(gen, index, VF_FLOATING) != 0;
+	const bool is_last = index + 1 == code_amount(gen);
+
+	const size_t first = fst != NONE ? operand_lower(gen, fr, locations, fst, 0) : R_ZERO;
+	const size_t second = snd != NONE ? operand_lower(gen, fr, locations, snd, 1) : R_ZERO;
+	const bool is_floating_result = register_is_floating(gen, dst);
+	const size_t result = dst == NONE
+		? R_ZERO
+		: locations[dst] >= 0
+			? (size_t)locations[dst]
+			: is_floating_result ? R_F16 : R_T8;
+
+	switch (operation)
+	{
+		case VI_LI:
+			machine_load_immediate(gen, result, argument);
+			break;
+		case VI_LID:
+			machine_symbol(gen, MI_LUI, R_AT, R_ZERO, SYM_CONSTANT, argument);
+			machine_symbol(gen, MI_LDC1, result, R_AT, SYM_CONSTANT, argument);
+			break;
+		case VI_LA:
+			machine_symbol(gen, MI_LUI, result, R_ZERO, SYM_STRING, argument);
+			machine_symbol(gen, MI_ADDIU, result, result, SYM_STRING, argument);
+			break;
+		case VI_MOV:
+			// Если оба регистра достались одному машинному регистру, копировать нечего
+			machine_move(gen, result, first, is_floating_result);
+			break;
+		case VI_PARAM:
+			parameter_lower(gen, fr, result, (size_t)argument, is_floating);
+			break;
+		case VI_LOAD:
+			machine_symbol(gen, MI_LUI, R_AT, R_ZERO, SYM_GLOBAL, argument);
+			machine_symbol(gen, is_floating ? MI_LDC1 : MI_LW, result, R_AT, SYM_GLOBAL, argument);
+			break;
+		case VI_STORE:
+			machine_symbol(gen, MI_LUI, R_AT, R_ZERO, SYM_GLOBAL, argument);
+			machine_symbol(gen, is_floating ? MI_SDC1 : MI_SW, first, R_AT, SYM_GLOBAL, argument);
+			break;
+		case VI_GLOBAL:
+			machine_symbol(gen, MI_LUI, result, R_ZERO, SYM_GLOBAL, argument);
+			machine_symbol(gen, MI_ADDIU, result, result, SYM_GLOBAL, argument);
+			break;
+		case VI_ELEMENT:
+			machine_add(gen, MI_SLL, R_AT, second, R_ZERO, argument == 8 ? 3 : 2);
+			machine_add(gen, MI_ADDU, result, first, R_AT, 0);
+			break;
+		case VI_LOAD_AT:
+			machine_add(gen, is_floating ? MI_LDC1 : MI_LW, result, first, R_ZERO, argument);
+			break;
+		case VI_STORE_AT:
+			machine_add(gen, is_floating ? MI_SDC1 : MI_SW, second, first, R_ZERO, argument);
+			break;
+		case VI_CONVERT:
+			machine_add(gen, MI_MTC1, first, result, R_ZERO, 0);
+			machine_add(gen, MI_CVT_D_W, result, result, R_ZERO, 0);
+			break;
+		case VI_UNARY:
+			unary_lower(gen, (unary_t)argument, result, first, is_floating);
+			break;
+		case VI_BINARY:
+			binary_lower(gen, (binary_t)argument, result, first, second, is_floating);
+			break;
+		case VI_LABEL:
+			machine_symbol(gen, MI_LABEL, R_ZERO, R_ZERO, SYM_LABEL, argument);
+			break;
+		case VI_JUMP:
+			machine_jump(gen, MI_J, R_ZERO, SYM_LABEL, argument);
+			break;
+		case VI_BZ:
+			machine_jump(gen, MI_BEQ, first, SYM_LABEL, argument);
+			break;
+		case VI_BNZ:
+			machine_jump(gen, MI_BNE, first, SYM_LABEL, argument);
+			break;
+		case VI_ARG:
+			argument_lower(gen, first, (size_t)argument, is_floating);
+			break;
+		case VI_CALL:
+			machine_jump(gen, MI_JAL, R_ZERO, SYM_FUNCTION, argument);
+			if (dst != NONE)
+			{
+				machine_move(gen, result, is_floating ? R_F0 : R_V0, is_floating);
+			}
+			break;
+		case VI_MATH:
+			math_lower(gen, (size_t)argument, result, first);
+			break;
+		case VI_ASSERT:
+			// Сообщение печатается через формат "%s", чтобы знаки процента в нём не обрабатывались
+			machine_symbol(gen, MI_LUI, R_A0, R_ZERO, SYM_STRING, NONE);
+			machine_symbol(gen, MI_ADDIU, R_A0, R_A0, SYM_STRING, NONE);
+			machine_symbol(gen, MI_LUI, R_A0 + 1, R_ZERO, SYM_STRING, argument);
+			machine_symbol(gen, MI_ADDIU, R_A0 + 1, R_A0 + 1, SYM_STRING, argument);
+			machine_jump(gen, MI_JAL, R_ZERO, SYM_FUNCTION, BI_PRINTF);
+			machine_add(gen, MI_ADDIU, R_A0, R_ZERO, R_ZERO, 1);
+			machine_jump(gen, MI_JAL, R_ZERO, SYM_EXIT, 0);
+			break;
+		case VI_RET:
+			machine_move(gen, register_is_floating(gen, fst) ? R_F0 : R_V0, first, register_is_floating(gen, fst));
+			if (!is_last)
+			{
+				machine_jump(gen, MI_J, R_ZERO, SYM_LABEL, (item_t)fr->label_return);
+			}
+			break;
+		case VI_RETV:
+			if (gen->function == gen->sx->ref_main)
+			{
+				// Программа без явного возврата завершается успешно
+				machine_move(gen, R_V0, R_ZERO, false);
+			}
+			if (!is_last)
+			{
+				machine_jump(gen, MI_J, R_ZERO, SYM_LABEL, (item_t)fr->label_return);
+			}
+			break;
+		case VI_ALLOCA:
+			alloca_lower(gen, fr, result, first, (size_t)argument);
+			break;
+		case VI_SAVE:
+			machine_move(gen, result, R_SP, false);
+			break;
+		case VI_RESTORE:
+			machine_move(gen, R_SP, first, false);
+			break;
+	}
+
+	if (dst != NONE && locations[dst] < 0)
+	{
+		machine_add(gen, is_floating_result ? MI_SDC1 : MI_SW, result, R_FP, R_ZERO, slot_offset(fr, locations[dst]));
+	}
+}
+
+/**
+ *	Calculate layout of frame.
+ *	Frame consists of area for arguments of calls, spill slots, saved registers, @c $fp and @c $ra.
+ *
+ *	@param	gen			Generator
+ *	@param	locations	Locations of virtual registers
+ *	@param	spills		Number of spill slots
+ *	@param	fr			Frame of function
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int frame_calculate(const generator *const gen, const item_t *const locations, const size_t spills
+	, frame *const fr)
+{
+	bool has_calls = false;
+	size_t words = 0;
+	const size_t amount = code_amount(gen);
+	for (size_t i = 0; i < amount; i++)
+	{
+		has_calls = has_calls || instruction_is_call(gen, i);
+		if (code_get(gen, i, VF_OPERATION) == VI_ARG)
+		{
+			const size_t end = (size_t)code_get(gen, i, VF_ARGUMENT) + (code_get(gen, i, VF_FLOATING) ? 2 : 1);
+			words = end > words ? end : words;
+		}
+	}
+
+	fr->outgoing = has_calls ? ((4 * words > HOME_AREA ? 4 * words : HOME_AREA) + 7) & ~(size_t)7 : 0;
+
+	for (size_t i = 0; i < MACHINE_REGISTERS; i++)
+	{
+		fr->is_saved[i] = false;
+	}
+
+	const size_t registers = vector_size(&gen->kinds);
+	size_t saved = 0;
+	for (size_t i = 0; i < registers; i++)
+	{
+		const size_t reg = (size_t)locations[i];
+		const bool is_callee_saved = (reg >= R_S0 && reg < R_S0 + 8) || reg >= FLOATING_CALLEE_SAVED[0];
+		if (locations[i] >= 0 && is_callee_saved && !fr->is_saved[reg])
+		{
+			fr->is_saved[reg] = true;
+			saved++;
+		}
+	}
+
+	// Каждый сохраняемый регистр занимает двойное слово, как и слоты подкачки
+	fr->size = fr->outgoing + 8 * spills + 8 * saved + 8;
+	return fr->size > MAX_IMMEDIATE ? -1 : 0;
+}
+
+static void prologue_lower(generator *const gen, const frame *const fr)
+{
+	machine_add(gen, MI_ADDIU, R_SP, R_SP, R_ZERO, -(item_t)fr->size);
+	machine_add(gen, MI_SW, R_RA, R_SP, R_ZERO, (item_t)fr->size - 4);
+	machine_add(gen, MI_SW, R_FP, R_SP, R_ZERO, (item_t)fr->size - 8);
+
+	size_t offset = fr->size - 8;
+	for (size_t i = 0; i < MACHINE_REGISTERS; i++)
+	{
+		if (fr->is_saved[i])
+		{
+			offset -= 8;
+			machine_add(gen, i >= R_F0 ? MI_SDC1 : MI_SW, i, R_SP, R_ZERO, (item_t)offset);
+		}
+	}
+
+	machine_add(gen, MI_MOVE, R_FP, R_SP, R_ZERO, 0);
+}
+
+static void epilogue_lower(generator *const gen, const frame *const fr)
+{
+	machine_symbol(gen, MI_LABEL, R_ZERO, R_ZERO, SYM_LABEL, (item_t)fr->label_return);
+
+	// Указатель стека восстанавливается из $fp, так как локальные массивы сдвигают его
+	machine_add(gen, MI_MOVE, R_SP, R_FP, R_ZERO, 0);
+
+	size_t offset = fr->size - 8;
+	for (size_t i = 0; i < MACHINE_REGISTERS; i++)
+	{
+		if (fr->is_saved[i])
+		{
+			offset -= 8;
+			machine_add(gen, i >= R_F0 ? MI_LDC1 : MI_LW, i, R_SP, R_ZERO, (item_t)offset);
+		}
+	}
+
+	machine_add(gen, MI_LW, R_RA, R_SP, R_ZERO, (item_t)fr->size - 4);
+	machine_add(gen, MI_LW, R_FP, R_SP, R_ZERO, (item_t)fr->size - 8);
+	machine_add(gen, MI_ADDIU, R_SP, R_SP, R_ZERO, (item_t)fr->size);
+	machine_add(gen, MI_JR, R_RA, R_ZERO, R_ZERO, 0);
+	machine_add(gen, MI_NOP, R_ZERO, R_ZERO, R_ZERO, 0);
+}
+
+
+/*
+ *	 ______     ______     __  __     ______     _____     __  __     __         __     __   __     ______
+ *	/\  ___\   /\  ___\   /\ \_\ \   /\  ___\   /\  __-.  /\ \/\ \   /\ \       /\ \   /\ "-.\ \   /\  ___\
+ *	\ \___  \  \ \ \____  \ \  __ \  \ \  __\   \ \ \/\ \ \ \ \_\ \  \ \ \____  \ \ \  \ \ \-.  \  \ \ \__ \
+ *	 \/\_____\  \ \_____\  \ \_\ \_\  \ \_____\  \ \____-  \ \_____\  \ \_____\  \ \_\  \ \_\\"\_\  \ \_____\
+ *	  \/_____/   \/_____/   \/_/\/_/   \/_____/   \/____/   \/_____/   \/_____/   \/_/   \/_/ \/_/   \/_____/
+ */
+
+
+static inline bool machine_is_control(const generator *const gen, const size_t index)
+{
+	switch (machine_get(gen, index, MF_OPERATION))
+	{
+		case MI_BEQ:
+		case MI_BNE:
+		case MI_J:
+		case MI_JAL:
+		case MI_JR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static void access_add(size_t *const registers, size_t *const amount, const item_t reg, const bool is_pair)
+{
+	if (reg == R_ZERO)
+	{
+		return;
+	}
+
+	// Вещественное число занимает пару регистров сопроцессора
+	registers[(*amount)++] = (size_t)reg;
+	if (is_pair)
+	{
+		registers[(*amount)++] = (size_t)reg + 1;
+	}
+}
+
+static size_t instruction_latency(const machine_instruction_t operation)
+{
+	switch (operation)
+	{
+		case MI_LW:
+		case MI_LDC1:
+		case MI_MTC1:
+		case MI_MFC1:
+		case MI_C_EQ_D:
+		case MI_C_LT_D:
+		case MI_C_LE_D:
+			return 2;
+		case MI_MUL:
+		case MI_ADD_D:
+		case MI_SUB_D:
+		case MI_MUL_D:
+		case MI_CVT_D_W:
+		case MI_TRUNC_W_D:
+			return 4;
+		case MI_DIV:
+			return 12;
+		case MI_DIV_D:
+		case MI_SQRT_D:
+			return 16;
+		default:
+			return 1;
+	}
+}
+
+/**
+ *	Collect registers and memory accessed by machine instruction
+ *
+ *	@param	gen			Generator
+ *	@param	index		Index of instruction
+ *
+ *	@return	Access of instruction
+ */
+static access instruction_access(const generator *const gen, const size_t index)
+{
+	const machine_instruction_t operation = (machine_instruction_t)machine_get(gen, index, MF_OPERATION);
+	const item_t fst = machine_get(gen, index, MF_FIRST);
+	const item_t snd = machine_get(gen, index, MF_SECOND);
+	const item_t thd = machine_get(gen, index, MF_THIRD);
+	const symbol_t symbol = (symbol_t)machine_get(gen, index, MF_SYMBOL);
+
+	access result = { .uses_amount = 0, .defs_amount = 0, .memory = MEM_NONE, .address = 0, .size = 0
+		, .is_store = false, .latency = instruction_latency(operation) };
+
+	switch (operation)
+	{
+		case MI_LABEL:
+		case MI_NOP:
+		case MI_J:
+			break;
+
+		case MI_DIV:
+			access_add(result.uses, &result.uses_amount, snd, false);
+			access_add(result.uses, &result.uses_amount, thd, false);
+			access_add(result.defs, &result.defs_amount, R_HILO, false);
+			break;
+		case MI_MFLO:
+		case MI_MFHI:
+			access_add(result.uses, &result.uses_amount, R_HILO, false);
+			access_add(result.defs, &result.defs_amount, fst, false);
+			break;
+
+		case MI_LUI:
+			access_add(result.defs, &result.defs_amount, fst, false);
+			break;
+
+		case MI_LW:
+		case MI_SW:
+		case MI_LDC1:
+		case MI_SDC1:
+		{
+			const bool is_pair = operation == MI_LDC1 || operation == MI_SDC1;
+			result.is_store = operation == MI_SW || operation == MI_SDC1;
+			result.size = is_pair ? 8 : 4;
+			result.address = symbol == SYM_NONE ? machine_get(gen, index, MF_IMMEDIATE) : machine_get(gen, index, MF_VALUE);
+			result.memory = symbol == SYM_CONSTANT
+				? MEM_CONSTANT
+				: symbol == SYM_GLOBAL
+					? MEM_GLOBAL
+					: snd == R_FP ? MEM_FRAME : MEM_OTHER;
+
+			access_add(result.uses, &result.uses_amount, snd, false);
+			access_add(result.is_store ? result.uses : result.defs
+				, result.is_store ? &result.uses_amount : &result.defs_amount, fst, is_pair);
+			break;
+		}
+
+		case MI_BEQ:
+		case MI_BNE:
+		case MI_JR:
+			access_add(result.uses, &result.uses_amount, fst, false);
+			break;
+		case MI_JAL:
+			// Аргументы вызова читаются уже после слота задержки
+			access_add(result.defs, &result.defs_amount, R_RA, false);
+			break;
+
+		case MI_ADD_D:
+		case MI_SUB_D:
+		case MI_MUL_D:
+		case MI_DIV_D:
+			access_add(result.uses, &result.uses_amount, snd, true);
+			access_add(result.uses, &result.uses_amount, thd, true);
+			access_add(result.defs, &result.defs_amount, fst, true);
+			break;
+		case MI_NEG_D:
+		case MI_ABS_D:
+		case MI_MOV_D:
+		case MI_SQRT_D:
+			access_add(result.uses, &result.uses_amount, snd, true);
+			access_add(result.defs, &result.defs_amount, fst, true);
+			break;
+		case MI_CVT_D_W:
+			access_add(result.uses, &result.uses_amount, snd, false);
+			access_add(result.defs, &result.defs_amount, fst, true);
+			break;
+		case MI_TRUNC_W_D:
+			access_add(result.uses, &result.uses_amount, snd, true);
+			access_add(result.defs, &result.defs_amount, fst, false);
+			break;
+		case MI_MTC1:
+			access_add(result.uses, &result.uses_amount, fst, false);
+			access_add(result.defs, &result.defs_amount, snd, false);
+			break;
+		case MI_C_EQ_D:
+		case MI_C_LT_D:
+		case MI_C_LE_D:
+			access_add(result.uses, &result.uses_amount, fst, true);
+			access_add(result.uses, &result.uses_amount, snd, true);
+			access_add(result.defs, &result.defs_amount, R_FCC, false);
+			break;
+		case MI_MOVF:
+		case MI_MOVT:
+			// Условное копирование сохраняет прежнее значение регистра
+			access_add(result.uses, &result.uses_amount, fst, false);
+			access_add(result.uses, &result.uses_amount, snd, false);
+			access_add(result.uses, &result.uses_amount, R_FCC, false);
+			access_add(result.defs, &result.defs_amount, fst, false);
+			break;
+
+		default:
+			// Остальные инструкции записывают первый регистр и читают второй и третий
+			access_add(result.uses, &result.uses_amount, snd, false);
+			access_add(result.uses, &result.uses_amount, thd, false);
+			access_add(result.defs, &result.defs_amount, fst, false);
+			break;
+	}
+
+	return result;
+}
+
+static bool registers_intersect(const size_t *const fst, const size_t fst_amount
+	, const size_t *const snd, const size_t snd_amount)
+{
+	for (size_t i = 0; i < fst_amount; i++)
+	{
+		for (size_t j = 0; j < snd_amount; j++)
+		{
+			if (fst[i] == snd[j])
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool memory_aliases(const access *const fst, const access *const snd)
+{
+	if (fst->memory != snd->memory || fst->memory == MEM_NONE || (!fst->is_store && !snd->is_store))
+	{
+		return false;
+	}
+
+	switch (fst->memory)
+	{
+		case MEM_GLOBAL:
+			return fst->address == snd->address;
+		case MEM_FRAME:
+			return fst->address < snd->address + snd->size && snd->address < fst->address + fst->size;
+		default:
+			// Массивы адресуются указателями, поэтому любые обращения к ним могут пересекаться
+			return true;
+	}
+}
+
+/**
+ *	Get latency of dependency between instructions
+ *
+ *	@param	fst			Access of earlier instruction
+ *	@param	snd			Access of later instruction
+ *
+ *	@return	Latency, @c -1 if instructions are independent
+ */
+static int dependency_latency(const access *const fst, const access *const snd)
+{
+	if (registers_intersect(fst->defs, fst->defs_amount, snd->uses, snd->uses_amount))
+	{
+		return (int)fst->latency;
+	}
+
+	if (registers_intersect(fst->defs, fst->defs_amount, snd->defs, snd->defs_amount)
+		|| (memory_aliases(fst, snd) && fst->is_store))
+	{
+		return 1;
+	}
+
+	if (registers_intersect(fst->uses, fst->uses_amount, snd->defs, snd->defs_amount) || memory_aliases(fst, snd))
+	{
+		return 0;
+	}
+
+	return -1;
+}
+
+/**
+ *	Order instructions of basic block by list scheduling.
+ *	Ready instruction with the longest path to the end of block goes first,
+ *	so uses of loads and long operations are moved away from them.
+ *
+ *	@param	accesses	Accesses of instructions
+ *	@param	size		Number of instructions
+ *	@param	order		Indexes of instructions in new order
+ */
+static void region_schedule(const access *const accesses, const size_t size, size_t *const order)
+{
+	signed char latency[MAX_REGION][MAX_REGION];
+	size_t height[MAX_REGION];
+	size_t ready[MAX_REGION];
+	size_t predecessors[MAX_REGION];
+	bool is_scheduled[MAX_REGION];
+
+	for (size_t i = size; i-- > 0;)
+	{
+		height[i] = accesses[i].latency;
+		ready[i] = 0;
+		predecessors[i] = 0;
+		is_scheduled[i] = false;
+
+		for (size_t j = i + 1; j < size; j++)
+		{
+			latency[i][j] = (signed char)dependency_latency(&accesses[i], &accesses[j]);
+			if (latency[i][j] >= 0)
+			{
+				const size_t path = (size_t)latency[i][j] + height[j];
+				height[i] = path > height[i] ? path : height[i];
+				predecessors[j]++;
+			}
+		}
+	}
+
+	size_t cycle = 0;
+	for (size_t k = 0; k < size; k++)
+	{
+		size_t best = SIZE_MAX;
+		for (size_t i = 0; i < size; i++)
+		{
+			if (is_scheduled[i] || predecessors[i] != 0)
+			{
+				continue;
+			}
+
+			if (best == SIZE_MAX)
+			{
+				best = i;
+				continue;
+			}
+
+			// Готовая инструкция предпочтительнее ожидающей, среди готовых - с самым длинным путём
+			const bool is_ready = ready[i] <= cycle;
+			const bool is_best_ready = ready[best] <= cycle;
+			if (is_ready != is_best_ready ? is_ready : is_ready ? height[i] > height[best] : ready[i] < ready[best])
+			{
+				best = i;
+			}
+		}
+
+		order[k] = best;
+		is_scheduled[best] = true;
+
+		const size_t issue = ready[best] > cycle ? ready[best] : cycle;
+		cycle = issue + 1;
+		for (size_t j = best + 1; j < size; j++)
+		{
+			if (latency[best][j] >= 0)
+			{
+				const size_t time = issue + (size_t)latency[best][j];
+				ready[j] = time > ready[j] ? time : ready[j];
+				predecessors[j]--;
+			}
+		}
+	}
+}
+
+static bool accesses_conflict(const access *const fst, const access *const snd)
+{
+	return dependency_latency(fst, snd) >= 0 || dependency_latency(snd, fst) >= 0;
+}
+
+/**
+ *	Find instruction of basic block, which can be moved into delay slot of its last jump
+ *
+ *	@param	accesses	Accesses of instructions
+ *	@param	order		Indexes of instructions in scheduled order
+ *	@param	size		Number of instructions
+ *	@param	jump		Access of jump
+ *
+ *	@return	Index of instruction, @c SIZE_MAX if there is none
+ */
+static size_t delay_slot_find(const access *const accesses, const size_t *const order, const size_t size
+	, const access *const jump)
+{
+	for (size_t k = size; k-- > 0;)
+	{
+		const access *const candidate = &accesses[order[k]];
+		bool is_independent = !accesses_conflict(candidate, jump);
+		for (size_t m = k + 1; m < size && is_independent; m++)
+		{
+			is_independent = !accesses_conflict(candidate, &accesses[order[m]]);
+		}
+
+		if (is_independent)
+		{
+			return order[k];
+		}
+	}
+
+	return SIZE_MAX;
+}
+
+static void machine_copy(const generator *const gen, vector *const instructions, const size_t index)
+{
+	for (size_t i = 0; i < MACHINE_FIELDS; i++)
+	{
+		vector_add(instructions, machine_get(gen, index, (machine_field_t)i));
+	}
+}
+
+/**
+ *	Reorder instructions of current function within basic blocks
+ *	and fill delay slots of jumps with preceding independent instructions
+ *
+ *	@param	gen			Generator
+ */
+static void instructions_schedule(generator *const gen)
+{
+	const size_t amount = vector_size(&gen->instructions) / MACHINE_FIELDS;
+	vector scheduled = vector_create(vector_size(&gen->instructions));
+	access accesses[MAX_REGION];
+	size_t order[MAX_REGION];
+
+	size_t begin = 0;
+	while (begin < amount)
+	{
+		if (machine_get(gen, begin, MF_OPERATION) == MI_LABEL)
+		{
+			machine_copy(gen, &scheduled, begin++);
+			continue;
+		}
+
+		// Длинные блоки разбиваются на участки, чтобы ограничить квадратичный подсчёт зависимостей
+		size_t end = begin;
+		while (end < amount && end - begin < MAX_REGION
+			&& machine_get(gen, end, MF_OPERATION) != MI_LABEL && !machine_is_control(gen, end))
+		{
+			accesses[end - begin] = instruction_access(gen, end);
+			end++;
+		}
+
+		const size_t size = end - begin;
+		region_schedule(accesses, size, order);
+
+		size_t slot = SIZE_MAX;
+		const bool has_jump = end + 1 < amount && machine_is_control(gen, end)
+			&& machine_get(gen, end + 1, MF_OPERATION) == MI_NOP;
+		if (has_jump)
+		{
+			const access jump = instruction_access(gen, end);
+			slot = delay_slot_find(accesses, order, size, &jump);
+		}
+
+		for (size_t k = 0; k < size; k++)
+		{
+			if (order[k] != slot)
+			{
+				machine_copy(gen, &scheduled, begin + order[k]);
+			}
+		}
+
+		if (has_jump)
+		{
+			machine_copy(gen, &scheduled, end);
+			machine_copy(gen, &scheduled, slot != SIZE_MAX ? begin + slot : end + 1);
+			end += 2;
+		}
+
+		begin = end;
+	}
+
+	vector_clear(&gen->instructions);
+	gen->instructions = scheduled;
+}
+
+
+/*
+ *	 ______     __  __     ______   ______   __  __     ______
+ *	/\  __ \   /\ \/\ \   /\__  _\ /\  == \ /\ \/\ \   /\__  _\
+ *	\ \ \/\ \  \ \ \_\ \  \/_/\ \/ \ \  _-/ \ \ \_\ \  \/_/\ \/
+ *	 \ \_____\  \ \_____\    \ \_\  \ \_\    \ \_____\    \ \_\
+ *	  \/_____/   \/_____/     \/_/   \/_/     \/_____/     \/_/
+ */
+
+
+static const char *register_to_string(const size_t reg)
+{
+	static const char *const FLOATING_NAMES[] =
+	{
+		"$f0", "$f1", "$f2", "$f3", "$f4", "$f5", "$f6", "$f7",
+		"$f8", "$f9", "$f10", "$f11", "$f12", "$f13", "$f14", "$f15",
+		"$f16", "$f17", "$f18", "$f19", "$f20", "$f21", "$f22", "$f23",
+		"$f24", "$f25", "$f26", "$f27", "$f28", "$f29", "$f30", "$f31",
+	};
+
+	return reg >= R_F0 ? FLOATING_NAMES[reg - R_F0] : REGISTER_NAMES[reg];
+}
+
+static void function_name_to_io(const generator *const gen, const size_t id)
+{
+	const char *const spelling = ident_get_spelling(gen->sx, id);
+	if (id < BEGIN_USER_FUNC)
+	{
+		uni_printf(gen->sx->io, "%s", spelling);
+		return;
+	}
+
+	if (strcmp(spelling, ident_get_spelling(gen->sx, gen->sx->ref_main)) == 0)
+	{
+		// Вызов до определения ссылается на прототип, поэтому функции различаются по имени
+		uni_printf(gen->sx->io, "main");
+		return;
+	}
+
+	char name[MAX_FUNCTION_NAME];
+	utf8_transliteration(spelling, name);
+	uni_printf(gen->sx->io, "%s", name);
+}
+
+static void symbol_to_io(const generator *const gen, const symbol_t symbol, const item_t value)
+{
+	switch (symbol)
+	{
+		case SYM_LABEL:
+			uni_printf(gen->sx->io, ".L%zu.%" PRIitem, gen->function, value);
+			break;
+		case SYM_GLOBAL:
+			uni_printf(gen->sx->io, "var.%" PRIitem, value);
+			break;
+		case SYM_STRING:
+			if (value == NONE)
+			{
+				uni_printf(gen->sx->io, ".Lstr.format");
+			}
+			else
+			{
+				uni_printf(gen->sx->io, ".Lstr.%" PRIitem, value);
+			}
+			break;
+		case SYM_CONSTANT:
+			uni_printf(gen->sx->io, ".Ldbl.%" PRIitem, value);
+			break;
+		case SYM_FUNCTION:
+			function_name_to_io(gen, (size_t)value);
+			break;
+		case SYM_EXIT:
+			uni_printf(gen->sx->io, "exit");
+			break;
+		case SYM_NONE:
+			break;
+	}
+}
+
+static void immediate_to_io(const generator *const gen, const size_t index, const char *const relocation)
+{
+	const symbol_t symbol = (symbol_t)machine_get(gen, index, MF_SYMBOL);
+	if (symbol == SYM_NONE)
+	{
+		uni_printf(gen->sx->io, "%" PRIitem, machine_get(gen, index, MF_IMMEDIATE));
+		return;
+	}
+
+	uni_printf(gen->sx->io, "%s(", relocation);
+	symbol_to_io(gen, symbol, machine_get(gen, index, MF_VALUE));
+	uni_printf(gen->sx->io, ")");
+}
+
+static void machine_to_io(const generator *const gen, const size_t index)
+{
+	universal_io *const io = gen->sx->io;
+	const machine_instruction_t operation = (machine_instruction_t)machine_get(gen, index, MF_OPERATION);
+	const char *const first = register_to_string((size_t)machine_get(gen, index, MF_FIRST));
+	const char *const second = register_to_string((size_t)machine_get(gen, index, MF_SECOND));
+	const char *const third = register_to_string((size_t)machine_get(gen, index, MF_THIRD));
+	const description *const desc = &DESCRIPTIONS[operation];
+
+	switch (desc->format)
+	{
+		case FORMAT_LABEL:
+			symbol_to_io(gen, SYM_LABEL, machine_get(gen, index, MF_VALUE));
+			uni_printf(io, ":\n");
+			return;
+		case FORMAT_NONE:
+			uni_printf(io, "\t%s\n", desc->name);
+			return;
+		case FORMAT_R:
+			uni_printf(io, "\t%s\t%s\n", desc->name, first);
+			return;
+		case FORMAT_RR:
+			uni_printf(io, "\t%s\t%s, %s%s\n", desc->name, first, second
+				, operation == MI_MOVF || operation == MI_MOVT ? ", $fcc0" : "");
+			return;
+		case FORMAT_RRR:
+			uni_printf(io, "\t%s\t%s, %s, %s\n", desc->name, first, second, third);
+			return;
+		case FORMAT_RRI:
+			uni_printf(io, "\t%s\t%s, %s, ", desc->name, first, second);
+			immediate_to_io(gen, index, "%lo");
+			uni_printf(io, "\n");
+			return;
+		case FORMAT_RI:
+			uni_printf(io, "\t%s\t%s, ", desc->name, first);
+			immediate_to_io(gen, index, "%hi");
+			uni_printf(io, "\n");
+			return;
+		case FORMAT_MEMORY:
+			uni_printf(io, "\t%s\t%s, ", desc->name, first);
+			immediate_to_io(gen, index, "%lo");
+			uni_printf(io, "(%s)\n", second);
+			return;
+		case FORMAT_BRANCH:
+			uni_printf(io, "\t%s\t%s, $zero, ", desc->name, first);
+			symbol_to_io(gen, SYM_LABEL, machine_get(gen, index, MF_VALUE));
+			uni_printf(io, "\n");
+			return;
+		case FORMAT_JUMP:
+			uni_printf(io, "\t%s\t", desc->name);
+			symbol_to_io(gen, (symbol_t)machine_get(gen, index, MF_SYMBOL), machine_get(gen, index, MF_VALUE));
+			uni_printf(io, "\n");
+			return;
+	}
+}
+
+/**
+ *	Allocate registers, lower and print code of current function
+ *
+ *	@param	gen			Generator
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int function_to_io(generator *const gen)
+{
+	const size_t registers = vector_size(&gen->kinds);
+	item_t *const locations = malloc((registers + 1) * sizeof(item_t));
+	size_t spills = 0;
+	if (locations == NULL || registers_allocate(gen, locations, &spills))
+	{
+		free(locations);
+		return -1;
+	}
+
+	frame fr;
+	fr.label_return = label_create(gen);
+	if (frame_calculate(gen, locations, spills, &fr))
+	{
+		free(locations);
+		unsupported(gen);
+		return 0;
+	}
+
+	vector_resize(&gen->instructions, 0);
+	prologue_lower(gen, &fr);
+
+	const size_t amount = code_amount(gen);
+	for (size_t i = 0; i < amount; i++)
+	{
+		instruction_lower(gen, &fr, locations, i);
+	}
+	epilogue_lower(gen, &fr);
+	free(locations);
+
+	if (gen->is_scheduled)
+	{
+		instructions_schedule(gen);
+	}
+
+	universal_io *const io = gen->sx->io;
+	uni_printf(io, "\n\t.text\n\t.align\t2\n");
+	if (gen->function == gen->sx->ref_main)
+	{
+		uni_printf(io, "\t.globl\tmain\n");
+	}
+
+	uni_printf(io, "\t.ent\t");
+	function_name_to_io(gen, gen->function);
+	uni_printf(io, "\n\t.type\t");
+	function_name_to_io(gen, gen->function);
+	uni_printf(io, ", @function\n");
+	function_name_to_io(gen, gen->function);
+	uni_printf(io, ":\n\t.frame\t$fp, %zu, $ra\n\t.set\tnoreorder\n\t.set\tnomacro\n", fr.size);
+
+	const size_t size = vector_size(&gen->instructions) / MACHINE_FIELDS;
+	for (size_t i = 0; i < size; i++)
+	{
+		machine_to_io(gen, i);
+	}
+
+	uni_printf(io, "\t.set\tmacro\n\t.set\treorder\n\t.end\t");
+	function_name_to_io(gen, gen->function);
+	uni_printf(io, "\n\t.size\t");
+	function_name_to_io(gen, gen->function);
+	uni_printf(io, ", .-");
+	function_name_to_io(gen, gen->function);
+	uni_printf(io, "\n");
+	return 0;
+}
+
+static void strings_to_io(const generator *const gen)
+{
+	universal_io *const io = gen->sx->io;
+	uni_printf(io, ".Lstr.format:\n\t.asciiz\t\"%%s\"\n");
+
+	const size_t amount = strings_amount(gen->sx);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const char *const string = string_get(gen->sx, i);
+		const size_t length = strings_length(gen->sx, i);
+		uni_printf(io, ".Lstr.%zu:\n\t.asciiz\t\"", i);
+
+		for (size_t j = 0; j < length; j++)
+		{
+			const unsigned char ch = (unsigned char)string[j];
+			if (ch == '"' || ch == '\\')
+			{
+				uni_printf(io, "\\%c", ch);
+			}
+			else if (ch < ' ' || ch >= 0x7F)
+			{
+				// Управляющие символы и байты UTF-8 записываются восьмеричными кодами
+				uni_printf(io, "\\%03o", ch);
+			}
+			else
+			{
+				uni_printf(io, "%c", ch);
+			}
+		}
+		uni_printf(io, "\"\n");
+	}
+}
+
+static void constants_to_io(const generator *const gen)
+{
+	const size_t amount = vector_size(&gen->constants);
+	for (size_t i = 0; i < amount; i++)
+	{
+		uni_printf(gen->sx->io, ".Ldbl.%zu:\n\t.double\t%.17g\n", i, vector_get_double(&gen->constants, i));
+	}
+}
+
+
+/*
+ *	 ______     ______   ______     ______   ______     __    __     ______     __   __     ______   ______
+ *	/\  ___\   /\__  _\ /\  __ \   /\__  _\ /\  ___\   /\ "-./  \   /\  ___\   /\ "-.\ \   /\__  _\ /\  ___\
+ *	\ \___  \  \/_/\ \/ \ \  __ \  \/_/\ \/ \ \  __\   \ \ \-./\ \  \ \  __\   \ \ \-.  \  \/_/\ \/ \ \___  \
+ *	 \/\_____\    \ \_\  \ \_\ \_\    \ \_\  \ \_____\  \ \_\ \ \_\  \ \_____\  \ \_\\"\_\    \ \_\  \/\_____\
+ *	  \/_____/     \/_/   \/_/\/_/     \/_/   \/_____/   \/_/  \/_/   \/_____/   \/_/ \/_/     \/_/   \/_____/
+ */
+
+
+/**
+ *	Emit declaration statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_declaration_statement(generator *const gen, const node *const nd)
+{
+	const size_t size = statement_declaration_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = statement_declaration_get_declarator(nd, i);
+		if (declaration_get_class(&decl) == DECL_VAR)
+		{
+			emit_local_declaration(gen, &decl);
+		}
+	}
+}
+
+/**
+ *	Emit if statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_if_statement(generator *const gen, const node *const nd)
+{
+	const size_t label_else = label_create(gen);
+	const node condition = statement_if_get_condition(nd);
+	code_jump(gen, VI_BZ, emit_condition(gen, &condition), label_else);
+
+	const node then_substmt = statement_if_get_then_substmt(nd);
+	emit_statement(gen, &then_substmt);
+
+	if (statement_if_has_else_substmt(nd))
+	{
+		const size_t label_end = label_create(gen);
+		code_jump(gen, VI_JUMP, NONE, label_end);
+		code_label(gen, label_else);
+
+		const node else_substmt = statement_if_get_else_substmt(nd);
+		emit_statement(gen, &else_substmt);
+		code_label(gen, label_end);
+	}
+	else
+	{
+		code_label(gen, label_else);
+	}
+}
+
+/**
+ *	Save stack pointer before statement, which declares local arrays
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Statement
+ *
+ *	@return	Register with stack pointer, @c NONE if statement declares no arrays
+ */
+static item_t emit_stack_save(generator *const gen, const node *const nd)
+{
+	if (!statement_has_arrays(gen->sx, nd))
+	{
+		return NONE;
+	}
+
+	const item_t stack = register_create(gen, true, false);
+	code_add(gen, VI_SAVE, stack, NONE, NONE, 0, false);
+	return stack;
+}
+
+/**
+ *	Restore stack pointer, so arrays of every iteration reuse the same memory
+ *
+ *	@param	gen			Generator
+ *	@param	stack		Register with stack pointer
+ */
+static void emit_stack_restore(generator *const gen, const item_t stack)
+{
+	if (stack != NONE)
+	{
+		code_add(gen, VI_RESTORE, NONE, stack, NONE, 0, false);
+	}
+}
+
+/**
+ *	Emit loop with condition before body
+ *
+ *	@param	gen			Generator
+ *	@param	condition	Condition, @c NULL for infinite loop
+ *	@param	body		Loop body
+ *	@param	increment	Increment, @c NULL for none
+ */
+static void emit_loop(generator *const gen, const node *const condition, const node *const body
+	, const node *const increment)
+{
+	const size_t old_break = gen->label_break;
+	const size_t old_continue = gen->label_continue;
+	const size_t label_begin = label_create(gen);
+	gen->label_break = label_create(gen);
+	gen->label_continue = increment != NULL ? label_create(gen) : label_begin;
+
+	const item_t stack = emit_stack_save(gen, body);
+	code_label(gen, label_begin);
+	emit_stack_restore(gen, stack);
+	if (condition != NULL)
+	{
+		code_jump(gen, VI_BZ, emit_condition(gen, condition), gen->label_break);
+	}
+
+	emit_statement(gen, body);
+
+	if (increment != NULL)
+	{
+		code_label(gen, gen->label_continue);
+		emit_expression(gen, increment);
+	}
+
+	code_jump(gen, VI_JUMP, NONE, label_begin);
+	code_label(gen, gen->label_break);
+	emit_stack_restore(gen, stack);
+
+	gen->label_break = old_break;
+	gen->label_continue = old_continue;
+}
+
+/**
+ *	Emit do statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_do_statement(generator *const gen, const node *const nd)
+{
+	const size_t old_break = gen->label_break;
+	const size_t old_continue = gen->label_continue;
+	const size_t label_begin = label_create(gen);
+	gen->label_break = label_create(gen);
+	gen->label_continue = label_create(gen);
+
+	const node body = statement_do_get_body(nd);
+	const item_t stack = emit_stack_save(gen, &body);
+	code_label(gen, label_begin);
+	emit_stack_restore(gen, stack);
+	emit_statement(gen, &body);
+
+	code_label(gen, gen->label_continue);
+	const node condition = statement_do_get_condition(nd);
+	code_jump(gen, VI_BNZ, emit_condition(gen, &condition), label_begin);
+	code_label(gen, gen->label_break);
+	emit_stack_restore(gen, stack);
+
+	gen->label_break = old_break;
+	gen->label_continue = old_continue;
+}
+
+/**
+ *	Emit for statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_for_statement(generator *const gen, const node *const nd)
+{
+	if (statement_for_has_inition(nd))
+	{
+		const node inition = statement_for_get_inition(nd);
+		emit_statement(gen, &inition);
+	}
+
+	const bool has_condition = statement_for_has_condition(nd);
+	const bool has_increment = statement_for_has_increment(nd);
+	const node body = statement_for_get_body(nd);
+	const node condition = has_condition ? statement_for_get_condition(nd) : body;
+	const node increment = has_increment ? statement_for_get_increment(nd) : body;
+
+	emit_loop(gen, has_condition ? &condition : NULL, &body, has_increment ? &increment : NULL);
+}
+
+/**
+ *	Emit switch statement.
+ *	Comparisons with cases are emitted after body, when all labels are known.
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_switch_statement(generator *const gen, const node *const nd)
+{
+	const size_t old_break = gen->label_break;
+	const size_t old_default = gen->label_default;
+	const size_t begin = vector_size(&gen->cases);
+	const size_t label_dispatch = label_create(gen);
+	gen->label_break = label_create(gen);
+	gen->label_default = SIZE_MAX;
+
+	const node condition = statement_switch_get_condition(nd);
+	const item_t value = emit_expression(gen, &condition);
+	const node body = statement_switch_get_body(nd);
+	const item_t stack = emit_stack_save(gen, &body);
+	code_jump(gen, VI_JUMP, NONE, label_dispatch);
+
+	emit_statement(gen, &body);
+	code_jump(gen, VI_JUMP, NONE, gen->label_break);
+
+	code_label(gen, label_dispatch);
+	const size_t end = vector_size(&gen->cases);
+	for (size_t i = begin; i < end; i += 2)
+	{
+		const node expression = node_load(&gen->sx->tree, (size_t)vector_get(&gen->cases, i));
+		const item_t constant = emit_expression(gen, &expression);
+		const item_t result = register_create(gen, false, false);
+		code_add(gen, VI_BINARY, result, value, constant, BIN_EQ, false);
+		code_jump(gen, VI_BNZ, result, (size_t)vector_get(&gen->cases, i + 1));
+	}
+
+	code_jump(gen, VI_JUMP, NONE, gen->label_default != SIZE_MAX ? gen->label_default : gen->label_break);
+	code_label(gen, gen->label_break);
+	emit_stack_restore(gen, stack);
+	vector_resize(&gen->cases, begin);
+
+	gen->label_break = old_break;
+	gen->label_default = old_default;
+}
+
+/**
+ *	Emit return statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_return_statement(generator *const gen, const node *const nd)
+{
+	if (statement_return_has_expression(nd))
+	{
+		const node expression = statement_return_get_expression(nd);
+		code_add(gen, VI_RET, NONE, emit_expression(gen, &expression), NONE, 0, false);
+	}
+	else
+	{
+		code_add(gen, VI_RETV, NONE, NONE, NONE, 0, false);
+	}
+}
+
+/**
+ *	Emit statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_statement(generator *const gen, const node *const nd)
+{
+	switch (statement_get_class(nd))
+	{
+		case STMT_DECL:
+			emit_declaration_statement(gen, nd);
+			return;
+
+		case STMT_CASE:
+		{
+			const size_t label = label_create(gen);
+			const node expression = statement_case_get_expression(nd);
+			vector_add(&gen->cases, (item_t)node_save(&expression));
+			vector_add(&gen->cases, (item_t)label);
+			code_label(gen, label);
+
+			const node substmt = statement_case_get_substmt(nd);
+			emit_statement(gen, &substmt);
+			return;
+		}
+
+		case STMT_DEFAULT:
+		{
+			gen->label_default = label_create(gen);
+			code_label(gen, gen->label_default);
+
+			const node substmt = statement_default_get_substmt(nd);
+			emit_statement(gen, &substmt);
+			return;
+		}
+
+		case STMT_COMPOUND:
+		{
+			const size_t size = statement_compound_get_size(nd);
+			for (size_t i = 0; i < size; i++)
+			{
+				const node substmt = statement_compound_get_substmt(nd, i);
+				emit_statement(gen, &substmt);
+			}
+			return;
+		}
+
+		case STMT_EXPR:
+			emit_expression(gen, nd);
+			return;
+
+		case STMT_NULL:
+			return;
+
+		case STMT_IF:
+			emit_if_statement(gen, nd);
+			return;
+
+		case STMT_SWITCH:
+			emit_switch_statement(gen, nd);
+			return;
+
+		case STMT_WHILE:
+		{
+			const node condition = statement_while_get_condition(nd);
+			const node body = statement_while_get_body(nd);
+			emit_loop(gen, &condition, &body, NULL);
+			return;
+		}
+
+		case STMT_DO:
+			emit_do_statement(gen, nd);
+			return;
+
+		case STMT_FOR:
+			emit_for_statement(gen, nd);
+			return;
+
+		case STMT_CONTINUE:
+			code_jump(gen, VI_JUMP, NONE, gen->label_continue);
+			return;
+
+		case STMT_BREAK:
+			code_jump(gen, VI_JUMP, NONE, gen->label_break);
+			return;
+
+		case STMT_RETURN:
+			emit_return_statement(gen, nd);
+			return;
+	}
+}
+
+/**
+ *	Emit function definition
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int emit_function_definition(generator *const gen, const node *const nd)
+{
+	// Номера регистров и меток локальны для функции
+	vector_resize(&gen->code, 0);
+	vector_resize(&gen->kinds, 0);
+	gen->label_num = 0;
+	gen->function = declaration_function_get_id(nd);
+
+	const item_t return_type = type_function_get_return_type(gen->sx, ident_get_type(gen->sx, gen->function));
+	if (!type_is_void(return_type) && !type_is_supported(gen->sx, return_type))
+	{
+		unsupported(gen);
+		return 0;
+	}
+
+	size_t word = 0;
+	const size_t parameters = declaration_function_get_parameters_amount(nd);
+	for (size_t i = 0; i < parameters; i++)
+	{
+		const size_t parameter = declaration_function_get_parameter(nd, i);
+		const item_t type = ident_get_type(gen->sx, parameter);
+		if (!type_is_supported(gen->sx, type) && !type_is_plain_array(gen->sx, type))
+		{
+			unsupported(gen);
+			return 0;
+		}
+
+		// Массивы передаются указателем на нулевой элемент
+		const bool is_floating = type_is_floating(type);
+		word = is_floating ? (word + 1) & ~(size_t)1 : word;
+
+		const item_t variable = register_create(gen, true, is_floating);
+		register_set(gen, parameter, variable);
+		code_add(gen, VI_PARAM, variable, NONE, NONE, (item_t)word, is_floating);
+		word += is_floating ? 2 : 1;
+	}
+
+	const node body = declaration_function_get_body(nd);
+	emit_statement(gen, &body);
+
+	const size_t amount = code_amount(gen);
+	const item_t last = amount != 0 ? code_get(gen, amount - 1, VF_OPERATION) : VI_LABEL;
+	if (last != VI_RET && last != VI_RETV)
+	{
+		code_add(gen, VI_RETV, NONE, NONE, NONE, 0, false);
+	}
+
+	return gen->was_error ? 0 : function_to_io(gen);
+}
+
+static int emit_translation_unit(generator *const gen, const node *const nd)
+{
+	uni_printf(gen->sx->io, "\t.abicalls\n\t.option\tpic0\n\t.set\tnoat\n");
+
+	const size_t size = translation_unit_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(nd, i);
+		switch (declaration_get_class(&decl))
+		{
+			case DECL_VAR:
+				emit_global_declaration(gen, &decl);
+				break;
+
+			case DECL_FUNC:
+				if (emit_function_definition(gen, &decl))
+				{
+					return -1;
+				}
+				break;
+
+			default:
+				// С объявлением типа ничего делать не нужно
+				break;
+		}
+	}
+
+	uni_printf(gen->sx->io, "\n\t.rdata\n\t.align\t3\n");
+	constants_to_io(gen);
+	strings_to_io(gen);
+	return gen->was_error ? -1 : 0;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int encode_to_mips(const workspace *const ws, syntax *const sx)
+{
+	if (!ws_is_correct(ws) || sx == NULL)
+	{
+		return -1;
+	}
+
+	COUNTER_OUTPUT(COUNTER_PRINTF_MIPS);
+	generator gen;
+	gen.sx = sx;
+	gen.code = vector_create(VIRTUAL_FIELDS * 256);
+	gen.kinds = vector_create(256);
+	gen.registers = vector_create(vector_size(&sx->identifiers));
+	gen.constants = vector_create(64);
+	gen.cases = vector_create(64);
+	gen.arguments = vector_create(64);
+	gen.instructions = vector_create(MACHINE_FIELDS * 512);
+	gen.function = 0;
+	gen.label_num = 0;
+	gen.label_break = SIZE_MAX;
+	gen.label_continue = SIZE_MAX;
+	gen.label_default = SIZE_MAX;
+	gen.is_scheduled = !ws_has_option(ws, OPT_NO_SCHEDULE);
+	gen.was_error = false;
+
+	vector_increase(&gen.registers, vector_size(&sx->identifiers));
+
+	const node root = node_get_root(&sx->tree);
+	const int ret = emit_translation_unit(&gen, &root);
+
+	vector_clear(&gen.code);
+	vector_clear(&gen.kinds);
+	vector_clear(&gen.registers);
+	vector_clear(&gen.constants);
+	vector_clear(&gen.cases);
+	vector_clear(&gen.arguments);
+	vector_clear(&gen.instructions);
+	COUNTER_OUTPUT(COUNTER_PRINTF);
+	return ret;
+}
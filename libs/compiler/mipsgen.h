@@ -0,0 +1,43 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "syntax.h"
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Encode to MIPS assembly for o32 ABI.
+ *	Local scalar variables, array pointers and temporaries live in virtual registers,
+ *	which are mapped to machine registers or frame slots by linear scan allocation.
+ *	Machine instructions are scheduled within basic blocks and fill delay slots of jumps,
+ *	unless @c -fno-schedule-insns flag is set.
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	sx				Syntax structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int encode_to_mips(const workspace *const ws, syntax *const sx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
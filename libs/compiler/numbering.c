@@ -0,0 +1,267 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "numbering.h"
+#include "AST.h"
+
+
+#define MAX_CANDIDATES 64
+#define NUMBERS_SIZE 64
+
+
+static const item_t EXCLUDED = 0;
+
+
+static bool is_address_operation(const node *const nd)
+{
+	switch (node_get_type(nd))
+	{
+		case OP_SELECT:
+		case OP_SLICE:
+			return true;
+
+		case OP_UNARY:
+			return expression_unary_get_operator(nd) == UN_INDIRECTION;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ *	Check that expressions compute the same value
+ *
+ *	@param	fst			First expression
+ *	@param	snd			Second expression
+ *
+ *	@return	@c true on equal expressions, @c false otherwise
+ */
+static bool is_equal(const node *const fst, const node *const snd)
+{
+	const size_t argc = node_get_argc(fst);
+	const size_t amount = node_get_amount(fst);
+	if (node_get_type(fst) != node_get_type(snd) || argc != node_get_argc(snd) || amount != node_get_amount(snd))
+	{
+		return false;
+	}
+
+	// Последние аргументы выражения — его позиция в коде
+	for (size_t i = 0; i + LOCATION_SIZE < argc; i++)
+	{
+		if (node_get_arg(fst, i) != node_get_arg(snd, i))
+		{
+			return false;
+		}
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node fst_child = node_get_child(fst, i);
+		const node snd_child = node_get_child(snd, i);
+		if (!is_equal(&fst_child, &snd_child))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ *	Collect nested address expressions in pre-order
+ *
+ *	@param	nb			Value numbering
+ *	@param	nd			Expression
+ *
+ *	@return	Number of address operations in expression, @c SIZE_MAX if it has branches or side effects
+ */
+static size_t collect(numbering *const nb, const node *const nd)
+{
+	switch (node_get_type(nd))
+	{
+		case OP_CALL:
+		case OP_TERNARY:
+		case OP_ASSIGNMENT:
+			return SIZE_MAX;
+
+		case OP_UNARY:
+		{
+			const unary_t operator = expression_unary_get_operator(nd);
+			if (operator == UN_POSTINC || operator == UN_POSTDEC || operator == UN_PREINC || operator == UN_PREDEC)
+			{
+				return SIZE_MAX;
+			}
+			break;
+		}
+
+		case OP_BINARY:
+		{
+			const binary_t operator = expression_binary_get_operator(nd);
+			if (operator == BIN_LOG_AND || operator == BIN_LOG_OR)
+			{
+				return SIZE_MAX;
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	const bool is_address = is_address_operation(nd);
+	const size_t position = vector_size(&nb->candidates);
+	if (is_address)
+	{
+		vector_add(&nb->candidates, (item_t)nd->index);
+		vector_add(&nb->candidates, EXCLUDED);
+	}
+
+	size_t operations = is_address ? 1 : 0;
+	const size_t amount = node_get_amount(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node child = node_get_child(nd, i);
+		const size_t child_operations = collect(nb, &child);
+		if (child_operations == SIZE_MAX)
+		{
+			return SIZE_MAX;
+		}
+
+		operations += child_operations;
+	}
+
+	// Одиночное вычисление адреса не дороже загрузки сохранённого значения
+	if (is_address && operations > 1)
+	{
+		vector_set(&nb->candidates, position + 1, (item_t)vector_size(&nb->candidates) / 2);
+	}
+
+	return operations;
+}
+
+/** Exclude nested candidates of expression from numbering */
+static void exclude_nested(numbering *const nb, const size_t index)
+{
+	const size_t end = (size_t)vector_get(&nb->candidates, 2 * index + 1);
+	for (size_t i = index + 1; i < end; i++)
+	{
+		vector_set(&nb->candidates, 2 * i + 1, EXCLUDED);
+	}
+}
+
+/** Set value number of expression */
+static void set_number(numbering *const nb, const size_t index)
+{
+	const item_t key = vector_get(&nb->candidates, 2 * index);
+	hash_add(&nb->numbers, key, 1);
+	hash_set(&nb->numbers, key, 0, (item_t)nb->amount);
+	exclude_nested(nb, index);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+numbering numbering_create(syntax *const sx)
+{
+	return (numbering){ .sx = sx, .numbers = hash_create(NUMBERS_SIZE)
+		, .candidates = vector_create(2 * MAX_CANDIDATES), .amount = 0 };
+}
+
+size_t numbering_build(numbering *const nb, const node *const nd)
+{
+	for (size_t i = 0; i < vector_size(&nb->candidates); i += 2)
+	{
+		hash_remove(&nb->numbers, vector_get(&nb->candidates, i));
+	}
+
+	vector_resize(&nb->candidates, 0);
+	nb->amount = 0;
+
+	// Внешнее присваивание выполняется после вычисления всех адресов оператора
+	size_t operations = 0;
+	if (node_get_type(nd) == OP_ASSIGNMENT)
+	{
+		const node LHS = expression_assignment_get_LHS(nd);
+		const node RHS = expression_assignment_get_RHS(nd);
+		operations = collect(nb, &LHS);
+		operations = operations != SIZE_MAX ? collect(nb, &RHS) : SIZE_MAX;
+	}
+	else
+	{
+		operations = collect(nb, nd);
+	}
+
+	const size_t size = vector_size(&nb->candidates) / 2;
+	if (operations == SIZE_MAX || size > MAX_CANDIDATES)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		const item_t end = vector_get(&nb->candidates, 2 * i + 1);
+		const item_t key = vector_get(&nb->candidates, 2 * i);
+		if (end == EXCLUDED || hash_get_index(&nb->numbers, key) != SIZE_MAX)
+		{
+			continue;
+		}
+
+		// Сначала нумеруются внешние выражения, вложенные в них уже не вычисляются повторно
+		const node fst = node_load(&nb->sx->tree, (size_t)key);
+		bool is_shared = false;
+		for (size_t j = (size_t)end; j < size; j++)
+		{
+			const node snd = node_load(&nb->sx->tree, (size_t)vector_get(&nb->candidates, 2 * j));
+			if (vector_get(&nb->candidates, 2 * j + 1) != EXCLUDED && is_equal(&fst, &snd))
+			{
+				set_number(nb, j);
+				is_shared = true;
+			}
+		}
+
+		if (is_shared)
+		{
+			set_number(nb, i);
+			nb->amount++;
+		}
+	}
+
+	return nb->amount;
+}
+
+size_t numbering_get(const numbering *const nb, const node *const nd)
+{
+	if (nb->amount == 0)
+	{
+		return SIZE_MAX;
+	}
+
+	const item_t number = hash_get(&nb->numbers, (item_t)nd->index, 0);
+	return number != ITEM_MAX ? (size_t)number : SIZE_MAX;
+}
+
+void numbering_clear(numbering *const nb)
+{
+	hash_clear(&nb->numbers);
+	vector_clear(&nb->candidates);
+}
@@ -0,0 +1,84 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "hash.h"
+#include "syntax.h"
+#include "tree.h"
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Local value numbering of address computations.
+ *
+ *	Equal nested subscript, member and indirection expressions of one expression
+ *	statement get the same value number, so backend computes their address once.
+ *	Statement is numbered only if it is evaluated without branches, calls and writes
+ *	except its outer assignment, which is performed after all address computations.
+ */
+typedef struct numbering
+{
+	syntax *sx;				/**< Syntax structure */
+	hash numbers;				/**< Value numbers of address expressions by node index */
+	vector candidates;			/**< Pairs of node index and number of nested candidates */
+	size_t amount;				/**< Number of values in current statement */
+} numbering;
+
+
+/**
+ *	Create value numbering
+ *
+ *	@param	sx				Syntax structure
+ *
+ *	@return	Value numbering
+ */
+numbering numbering_create(syntax *const sx);
+
+/**
+ *	Number address computations of expression statement, previous numbers are dropped
+ *
+ *	@param	nb				Value numbering
+ *	@param	nd				Expression statement
+ *
+ *	@return	Number of values shared by several expressions
+ */
+size_t numbering_build(numbering *const nb, const node *const nd);
+
+/**
+ *	Get value number of address expression
+ *
+ *	@param	nb				Value numbering
+ *	@param	nd				Expression
+ *
+ *	@return	Value number, @c SIZE_MAX if address is not shared
+ */
+size_t numbering_get(const numbering *const nb, const node *const nd);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	nb				Value numbering
+ */
+void numbering_clear(numbering *const nb);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -15,9 +15,81 @@
  */
 
 #include "operations.h"
+#include <stdint.h>
 #include "errors.h"
 
 
+/** Index of token in operators table, negative tokens go first, then non-negative ones */
+#define TOKEN_INDEX(token) ((token) < 0 \
+	? (size_t)((token) - TK_EOF) \
+	: (size_t)(TK_GREATER_GREATER_EQUAL - TK_EOF) + 1 + (size_t)(token))
+
+#define TOKENS_AMOUNT (TOKEN_INDEX(TK_SEMICOLON) + 1)
+
+
+/** Properties of binary or ternary operator token */
+typedef struct operator_info
+{
+	uint8_t precedence;					/**< Precedence, @c PREC_UNKNOWN for other tokens */
+	uint8_t binary;						/**< Binary operator */
+	bool is_right_associative;			/**< Set, if operator groups right to left */
+} operator_info;
+
+
+// Таблица строится при компиляции, поэтому разбор выражения обходится без переключателей по токенам
+static const operator_info OPERATORS[TOKENS_AMOUNT] =
+{
+	[TOKEN_INDEX(TK_COMMA)]						= { PREC_COMMA, BIN_COMMA, false },
+
+	[TOKEN_INDEX(TK_EQUAL)]						= { PREC_ASSIGNMENT, BIN_ASSIGN, true },
+	[TOKEN_INDEX(TK_STAR_EQUAL)]				= { PREC_ASSIGNMENT, BIN_MUL_ASSIGN, true },
+	[TOKEN_INDEX(TK_SLASH_EQUAL)]				= { PREC_ASSIGNMENT, BIN_DIV_ASSIGN, true },
+	[TOKEN_INDEX(TK_PERCENT_EQUAL)]				= { PREC_ASSIGNMENT, BIN_REM_ASSIGN, true },
+	[TOKEN_INDEX(TK_PLUS_EQUAL)]				= { PREC_ASSIGNMENT, BIN_ADD_ASSIGN, true },
+	[TOKEN_INDEX(TK_MINUS_EQUAL)]				= { PREC_ASSIGNMENT, BIN_SUB_ASSIGN, true },
+	[TOKEN_INDEX(TK_LESS_LESS_EQUAL)]			= { PREC_ASSIGNMENT, BIN_SHL_ASSIGN, true },
+	[TOKEN_INDEX(TK_GREATER_GREATER_EQUAL)]		= { PREC_ASSIGNMENT, BIN_SHR_ASSIGN, true },
+	[TOKEN_INDEX(TK_AMP_EQUAL)]					= { PREC_ASSIGNMENT, BIN_AND_ASSIGN, true },
+	[TOKEN_INDEX(TK_CARET_EQUAL)]				= { PREC_ASSIGNMENT, BIN_XOR_ASSIGN, true },
+	[TOKEN_INDEX(TK_PIPE_EQUAL)]				= { PREC_ASSIGNMENT, BIN_OR_ASSIGN, true },
+
+	[TOKEN_INDEX(TK_QUESTION)]					= { PREC_CONDITIONAL, 0, true },
+
+	[TOKEN_INDEX(TK_PIPE_PIPE)]					= { PREC_LOGICAL_OR, BIN_LOG_OR, false },
+	[TOKEN_INDEX(TK_AMP_AMP)]					= { PREC_LOGICAL_AND, BIN_LOG_AND, false },
+	[TOKEN_INDEX(TK_PIPE)]						= { PREC_OR, BIN_OR, false },
+	[TOKEN_INDEX(TK_CARET)]						= { PREC_XOR, BIN_XOR, false },
+	[TOKEN_INDEX(TK_AMP)]						= { PREC_AND, BIN_AND, false },
+
+	[TOKEN_INDEX(TK_EQUAL_EQUAL)]				= { PREC_EQUALITY, BIN_EQ, false },
+	[TOKEN_INDEX(TK_EXCLAIM_EQUAL)]				= { PREC_EQUALITY, BIN_NE, false },
+
+	[TOKEN_INDEX(TK_GREATER_EQUAL)]				= { PREC_RELATIONAL, BIN_GE, false },
+	[TOKEN_INDEX(TK_LESS_EQUAL)]				= { PREC_RELATIONAL, BIN_LE, false },
+	[TOKEN_INDEX(TK_GREATER)]					= { PREC_RELATIONAL, BIN_GT, false },
+	[TOKEN_INDEX(TK_LESS)]						= { PREC_RELATIONAL, BIN_LT, false },
+
+	[TOKEN_INDEX(TK_LESS_LESS)]					= { PREC_SHIFT, BIN_SHL, false },
+	[TOKEN_INDEX(TK_GREATER_GREATER)]			= { PREC_SHIFT, BIN_SHR, false },
+
+	[TOKEN_INDEX(TK_PLUS)]						= { PREC_ADDITIVE, BIN_ADD, false },
+	[TOKEN_INDEX(TK_MINUS)]						= { PREC_ADDITIVE, BIN_SUB, false },
+
+	[TOKEN_INDEX(TK_STAR)]						= { PREC_MULTIPLICATIVE, BIN_MUL, false },
+	[TOKEN_INDEX(TK_SLASH)]						= { PREC_MULTIPLICATIVE, BIN_DIV, false },
+	[TOKEN_INDEX(TK_PERCENT)]					= { PREC_MULTIPLICATIVE, BIN_REM, false },
+};
+
+
+static inline const operator_info *get_operator_info(const token_t token)
+{
+	static const operator_info unknown = { PREC_UNKNOWN, 0, false };
+
+	const size_t index = TOKEN_INDEX(token);
+	return index < TOKENS_AMOUNT ? &OPERATORS[index] : &unknown;
+}
+
+
 unary_t token_to_unary(const token_t token)
 {
 	switch (token)
@@ -40,109 +112,24 @@ unary_t token_to_unary(const token_t token)
 
 binary_t token_to_binary(const token_t token)
 {
-	switch (token)
+	const operator_info *const info = get_operator_info(token);
+	if (info->precedence == PREC_UNKNOWN || info->precedence == PREC_CONDITIONAL)
 	{
-		case TK_PLUS:					return BIN_ADD;
-		case TK_MINUS:					return BIN_SUB;
-		case TK_STAR:					return BIN_MUL;
-		case TK_SLASH:					return BIN_DIV;
-		case TK_PERCENT:				return BIN_REM;
-		case TK_CARET:					return BIN_XOR;
-		case TK_PIPE:					return BIN_OR;
-		case TK_AMP:					return BIN_AND;
-		case TK_EQUAL:					return BIN_ASSIGN;
-		case TK_LESS:					return BIN_LT;
-		case TK_GREATER:				return BIN_GT;
-		case TK_PLUS_EQUAL:				return BIN_ADD_ASSIGN;
-		case TK_MINUS_EQUAL:			return BIN_SUB_ASSIGN;
-		case TK_STAR_EQUAL:				return BIN_MUL_ASSIGN;
-		case TK_SLASH_EQUAL:			return BIN_DIV_ASSIGN;
-		case TK_PERCENT_EQUAL:			return BIN_REM_ASSIGN;
-		case TK_EXCLAIM_EQUAL:			return BIN_NE;
-		case TK_CARET_EQUAL:			return BIN_XOR_ASSIGN;
-		case TK_PIPE_EQUAL:				return BIN_OR_ASSIGN;
-		case TK_PIPE_PIPE:				return BIN_LOG_OR;
-		case TK_AMP_EQUAL:				return BIN_AND_ASSIGN;
-		case TK_AMP_AMP:				return BIN_LOG_AND;
-		case TK_EQUAL_EQUAL:			return BIN_EQ;
-		case TK_LESS_EQUAL:				return BIN_LE;
-		case TK_LESS_LESS:				return BIN_SHL;
-		case TK_GREATER_EQUAL:			return BIN_GE;
-		case TK_GREATER_GREATER:		return BIN_SHR;
-		case TK_LESS_LESS_EQUAL:		return BIN_SHL_ASSIGN;
-		case TK_GREATER_GREATER_EQUAL:	return BIN_SHR_ASSIGN;
-		case TK_COMMA:					return BIN_COMMA;
-
-		default:
-			system_error(node_unexpected);
-			return 0;
+		system_error(node_unexpected);
+		return 0;
 	}
+
+	return (binary_t)info->binary;
 }
 
 precedence_t get_operator_precedence(const token_t token)
 {
-	switch (token)
-	{
-		case TK_COMMA:
-			return PREC_COMMA;
-
-		case TK_EQUAL:
-		case TK_STAR_EQUAL:
-		case TK_SLASH_EQUAL:
-		case TK_PERCENT_EQUAL:
-		case TK_PLUS_EQUAL:
-		case TK_MINUS_EQUAL:
-		case TK_LESS_LESS_EQUAL:
-		case TK_GREATER_GREATER_EQUAL:
-		case TK_AMP_EQUAL:
-		case TK_CARET_EQUAL:
-		case TK_PIPE_EQUAL:
-			return PREC_ASSIGNMENT;
-
-		case TK_QUESTION:
-			return PREC_CONDITIONAL;
-
-		case TK_PIPE_PIPE:
-			return PREC_LOGICAL_OR;
-
-		case TK_AMP_AMP:
-			return PREC_LOGICAL_AND;
-
-		case TK_PIPE:
-			return PREC_OR;
-
-		case TK_CARET:
-			return PREC_XOR;
-
-		case TK_AMP:
-			return PREC_AND;
-
-		case TK_EQUAL_EQUAL:
-		case TK_EXCLAIM_EQUAL:
-			return PREC_EQUALITY;
-
-		case TK_GREATER_EQUAL:
-		case TK_LESS_EQUAL:
-		case TK_GREATER:
-		case TK_LESS:
-			return PREC_RELATIONAL;
-
-		case TK_LESS_LESS:
-		case TK_GREATER_GREATER:
-			return PREC_SHIFT;
-
-		case TK_PLUS:
-		case TK_MINUS:
-			return PREC_ADDITIVE;
-
-		case TK_STAR:
-		case TK_SLASH:
-		case TK_PERCENT:
-			return PREC_MULTIPLICATIVE;
+	return (precedence_t)get_operator_info(token)->precedence;
+}
 
-		default:
-			return PREC_UNKNOWN;
-	}
+bool operator_is_right_associative(const token_t token)
+{
+	return get_operator_info(token)->is_right_associative;
 }
 
 bool operation_is_assignment(const binary_t op)
@@ -189,36 +189,57 @@ typedef enum builtin
 	BI_ROBOT_RECEIVE_INT	= 86,
 	BI_ROBOT_RECEIVE_FLOAT	= 90,
 	BI_ROBOT_RECEIVE_STRING	= 94,
+	BI_ROBOT_RECEIVE_INTS	= 98,
+	BI_ROBOT_RECEIVE_FLOATS	= 102,
 
 	// Thread functions
-	BI_T_CREATE				= 98,
-	BI_T_GETNUM				= 102,
-	BI_T_SLEEP				= 106,
-	BI_T_JOIN				= 110,
-	BI_T_EXIT				= 114,
-	BI_T_INIT				= 118,
-	BI_T_DESTROY			= 122,
-
-	BI_SEM_CREATE			= 126,
-	BI_SEM_WAIT				= 130,
-	BI_SEM_POST				= 134,
-
-	BI_MSG_SEND				= 138,
-	BI_MSG_RECEIVE			= 142,
-
-	BI_FOPEN				= 146,
-	BI_FGETC				= 150,
-	BI_FPUTC				= 154,
-	BI_FCLOSE				= 158,
-
-	BI_EXIT					= 162,
-
-	BI_PRINTF				= 166,
-	BI_PRINT				= 170,
-	BI_PRINTID				= 174,
-	BI_GETID				= 178,
-
-	BEGIN_USER_FUNC			= 182,
+	BI_T_CREATE				= 106,
+	BI_T_GETNUM				= 110,
+	BI_T_SLEEP				= 114,
+	BI_T_JOIN				= 118,
+	BI_T_EXIT				= 122,
+	BI_T_INIT				= 126,
+	BI_T_DESTROY			= 130,
+
+	BI_SEM_CREATE			= 134,
+	BI_SEM_WAIT				= 138,
+	BI_SEM_POST				= 142,
+
+	BI_MSG_SEND				= 146,
+	BI_MSG_RECEIVE			= 150,
+	BI_CHAN_SEND			= 154,
+	BI_CHAN_RECEIVE			= 158,
+
+	BI_ATOMIC_ADD			= 162,
+	BI_ATOMIC_CAS			= 166,
+	BI_ATOMIC_LOAD			= 170,
+	BI_ATOMIC_STORE			= 174,
+
+	BI_PARALLEL_FOR			= 178,
+
+	BI_T_SET_PRIORITY		= 182,
+	BI_T_SET_AFFINITY		= 186,
+	BI_T_PERIOD_START		= 190,
+	BI_T_PERIOD_WAIT		= 194,
+
+	BI_FOPEN				= 198,
+	BI_FGETC				= 202,
+	BI_FPUTC				= 206,
+	BI_FCLOSE				= 210,
+	BI_FREAD_CHARS			= 214,
+	BI_FWRITE_CHARS			= 218,
+	BI_FREAD_INTS			= 222,
+	BI_FWRITE_INTS			= 226,
+	BI_FGETLINE				= 230,
+
+	BI_EXIT					= 234,
+
+	BI_PRINTF				= 238,
+	BI_PRINT				= 242,
+	BI_PRINTID				= 246,
+	BI_GETID				= 250,
+
+	BEGIN_USER_FUNC			= 254,
 } builtin_t;
 
 
@@ -249,6 +270,15 @@ binary_t token_to_binary(const token_t token);
  */
 precedence_t get_operator_precedence(const token_t token);
 
+/**
+ *	Check if the specified binary/ternary operator token groups right to left
+ *
+ *	@param	token		Token
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+bool operator_is_right_associative(const token_t token);
+
 /**
  *	Check if operator is assignment
  *
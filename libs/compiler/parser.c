@@ -16,13 +16,67 @@
 
 #include "parser.h"
 #include <stdbool.h>
+#include <stdlib.h>
 #include "builder.h"
+#include "evaluator.h"
 #include "lexer.h"
-#include "writer.h"
 
 
-static const char *const DEFAULT_TREE = "tree.txt";
+/** Number of items in record of postponed function body */
+#define BODY_ITEMS 5
 
+/** Initial size of postponed bodies tokens buffer */
+#define BODY_TOKENS_SIZE 256
+
+/** Initial size of expression frames buffer */
+#define EXPRESSION_FRAMES_SIZE 64
+
+/**
+ *	Group of diagnostics reported at stored token:
+ *	@c 1 for lexer, @c 2 for parsing of postponed body, @c 3 for following declarations
+ */
+#define REPORT_GROUP(token, kind) (4 * (token) + (kind))
+
+/** Closing tokens of nested constructions indexed from '[' to '?' */
+static const uint8_t NESTED_CLOSING[] = { TK_R_SQUARE, TK_R_PAREN, TK_R_BRACE, TK_COLON };
+
+/** Tokens on which error recovery may stop */
+static const uint8_t RECOVERY_STOPS = TK_R_SQUARE | TK_R_PAREN | TK_R_BRACE | TK_COLON | TK_SEMICOLON;
+
+
+/** Kinds of postponed steps of expression parsing */
+typedef enum FRAME
+{
+	FRAME_UNARY,						/**< Prefix operator waiting for its operand */
+	FRAME_PAREN,						/**< Parenthesized expression waiting for closing paren */
+	FRAME_SUBSCRIPT,					/**< Subscript expression waiting for its index */
+	FRAME_CALL,							/**< Call expression waiting for its argument */
+	FRAME_BINARY,						/**< Left operand waiting for operators of minimal precedence or higher */
+	FRAME_MIDDLE,						/**< Conditional operator waiting for its middle operand */
+	FRAME_RIGHT,						/**< Binary operator waiting for its right operand */
+	FRAME_BUILD,						/**< Binary operator waiting for end of its right operand */
+} frame_t;
+
+/** States of expression parsing between steps */
+typedef enum STATE
+{
+	STATE_OPERAND,						/**< Unary expression is expected */
+	STATE_POSTFIX,						/**< Postfix operators may follow value */
+	STATE_RETURN,						/**< Value is complete for the top frame */
+	STATE_FAILURE,						/**< Frames allocation failed */
+} state_t;
+
+/** Postponed step of expression parsing */
+typedef struct expression_frame
+{
+	frame_t kind;						/**< Frame kind */
+	token_t operator;					/**< Operator token */
+	precedence_t min_prec;				/**< Minimal precedence of binary operators */
+	range_location loc;					/**< Location of operator or opening bracket */
+	node operand;						/**< Left operand, subscripted expression or callee */
+	node middle;						/**< Middle operand of conditional operator */
+	node_vector args;					/**< Arguments of call expression */
+} expression_frame;
 
 /** Parser */
 typedef struct parser
@@ -35,6 +89,9 @@ typedef struct parser
 
 	size_t array_dimensions;			/**< Array dimensions counter */
 
+	item_t packed_type;					/**< Element type of array with packed innermost initializer lists */
+	size_t packed_depth;				/**< Nesting of lists up to packed one, @c 0 if lists are not packed */
+
 	int func_def;						/**< @c 0 for function without arguments,
 											@c 1 for function definition,
 											@c 2 for function declaration,
@@ -47,6 +104,17 @@ typedef struct parser
 
 	bool was_return;					/**< Set, if was return in parsed function */
 	bool was_type_def;					/**< Set, if was type definition */
+
+	vector bodies;						/**< Node, function, global scope mark and tokens of postponed bodies */
+	token *tokens;						/**< Tokens of postponed bodies */
+	size_t tokens_size;					/**< Number of stored tokens */
+	size_t tokens_alloc;				/**< Allocated size of stored tokens */
+	size_t replay;						/**< Index of next replayed token, @c SIZE_MAX for lexer input */
+	size_t replay_end;					/**< End of replayed tokens */
+
+	expression_frame *frames;			/**< Postponed steps of expression parsing */
+	size_t frames_size;					/**< Number of postponed steps */
+	size_t frames_alloc;				/**< Allocated size of postponed steps */
 } parser;
 
 
@@ -71,17 +139,29 @@ static node parse_statement(parser *const prs);
  *	Create parser
  *
  *	@param	sx			Syntax structure
+ *	@param	position	Position in source text to start from
  *
  *	@return	Parser
  */
-static inline parser parser_create(syntax *const sx)
+static inline parser parser_create(syntax *const sx, const size_t position)
 {
-	parser prs = { .sx = sx, .lxr = lexer_create(sx) };
+	parser prs = { .sx = sx, .lxr = lexer_create(sx, position) };
 	prs.bld = builder_create(sx);
 
 	prs.is_in_loop = false;
 	prs.is_in_switch = false;
 
+	prs.bodies = vector_create(BODY_ITEMS * 16);
+	prs.tokens = NULL;
+	prs.tokens_size = 0;
+	prs.tokens_alloc = 0;
+	prs.replay = SIZE_MAX;
+	prs.replay_end = 0;
+
+	prs.frames = NULL;
+	prs.frames_size = 0;
+	prs.frames_alloc = 0;
+
 	consume_token(&prs);
 
 	return prs;
@@ -95,6 +175,9 @@ static inline parser parser_create(syntax *const sx)
 static inline void parser_clear(parser *const prs)
 {
 	lexer_clear(&prs->lxr);
+	vector_clear(&prs->bodies);
+	free(prs->tokens);
+	free(prs->frames);
 }
 
 /**
@@ -125,7 +208,16 @@ static void parser_error(parser *const prs, err_t num, ...)
 static range_location consume_token(parser *const prs)
 {
 	range_location prev_loc = token_get_location(&prs->tk);
-	prs->tk = lex(&prs->lxr);
+	if (prs->replay == SIZE_MAX)
+	{
+		prs->tk = lex(&prs->lxr);
+	}
+	else
+	{
+		prs->tk = prs->replay < prs->replay_end ? prs->tokens[prs->replay++] : token_eof();
+		reporter_set_group(&prs->sx->rprt, REPORT_GROUP(prs->replay, 2));
+	}
+
 	return prev_loc;
 }
 
@@ -138,7 +230,66 @@ static range_location consume_token(parser *const prs)
  */
 static inline token_t peek_token(parser *const prs)
 {
-	return peek(&prs->lxr);
+	if (prs->replay == SIZE_MAX)
+	{
+		return peek(&prs->lxr);
+	}
+
+	return prs->replay < prs->replay_end ? token_get_kind(&prs->tokens[prs->replay]) : TK_EOF;
+}
+
+/**
+ *	Store the current 'peek token' for replay
+ *
+ *	@param	prs			Parser
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int store_token(parser *const prs)
+{
+	if (prs->tokens_size == prs->tokens_alloc)
+	{
+		const size_t alloc_new = prs->tokens_alloc != 0 ? 2 * prs->tokens_alloc : BODY_TOKENS_SIZE;
+		token *const tokens_new = realloc(prs->tokens, alloc_new * sizeof(token));
+		if (tokens_new == NULL)
+		{
+			return -1;
+		}
+
+		prs->tokens = tokens_new;
+		prs->tokens_alloc = alloc_new;
+	}
+
+	prs->tokens[prs->tokens_size++] = prs->tk;
+	return 0;
+}
+
+/**
+ *	Push new postponed step of expression parsing
+ *
+ *	@param	prs			Parser
+ *	@param	kind		Frame kind
+ *
+ *	@return	Pushed frame, @c NULL on failure
+ */
+static expression_frame *push_frame(parser *const prs, const frame_t kind)
+{
+	if (prs->frames_size == prs->frames_alloc)
+	{
+		const size_t alloc_new = prs->frames_alloc != 0 ? 2 * prs->frames_alloc : EXPRESSION_FRAMES_SIZE;
+		expression_frame *const frames_new = realloc(prs->frames, alloc_new * sizeof(expression_frame));
+		if (frames_new == NULL)
+		{
+			return NULL;
+		}
+
+		prs->frames = frames_new;
+		prs->frames_alloc = alloc_new;
+	}
+
+	expression_frame *const frame = &prs->frames[prs->frames_size++];
+	frame->kind = kind;
+	return frame;
 }
 
 /**
@@ -206,41 +357,20 @@ static void skip_until(parser *const prs, const uint8_t tokens)
 {
 	while (token_is_not(&prs->tk, TK_EOF))
 	{
-		switch (token_get_kind(&prs->tk))
+		const token_t kind = token_get_kind(&prs->tk);
+		if (kind >= TK_L_SQUARE && kind <= TK_QUESTION)
 		{
-			case TK_L_PAREN:
-				consume_token(prs);
-				skip_until(prs, TK_R_PAREN);
-				break;
-
-			case TK_L_SQUARE:
-				consume_token(prs);
-				skip_until(prs, TK_R_SQUARE);
-				break;
-
-			case TK_L_BRACE:
-				consume_token(prs);
-				skip_until(prs, TK_R_BRACE);
-				break;
-
-			case TK_QUESTION:
-				consume_token(prs);
-				skip_until(prs, TK_COLON);
-				break;
-
-			case TK_R_PAREN:
-			case TK_R_SQUARE:
-			case TK_R_BRACE:
-			case TK_COLON:
-			case TK_SEMICOLON:
-				if (has_token_set(tokens, token_get_kind(&prs->tk)))
-				{
-					return;
-				}
-
-			default:
-				consume_token(prs);
-				break;
+			// Вложенная конструкция пропускается до своей закрывающей лексемы
+			consume_token(prs);
+			skip_until(prs, NESTED_CLOSING[kind - TK_L_SQUARE]);
+		}
+		else if (kind > 0 && has_token_set(tokens & RECOVERY_STOPS, kind))
+		{
+			return;
+		}
+		else
+		{
+			consume_token(prs);
 		}
 	}
 }
@@ -286,7 +416,7 @@ static size_t to_identab(parser *const prs, const size_t repr, const item_t type
 
 
 /**
- *	Parse primary expression
+ *	Parse primary expression, parenthesized expressions are postponed by parse_unary_prefix
  *
  *	primary-expression:
  *		identifier
@@ -320,7 +450,7 @@ static node parse_primary_expression(parser *const prs)
 
 		case TK_INT_LITERAL:
 		{
-			const item_t value = (item_t)token_get_int_value(&prs->tk);
+			const int64_t value = (int64_t)token_get_int_value(&prs->tk);
 			const range_location loc = consume_token(prs);
 
 			return build_integer_literal_expression(&prs->bld, value, loc);
@@ -351,20 +481,6 @@ static node parse_primary_expression(parser *const prs)
 		case TK_FALSE:
 			return build_boolean_literal_expression(&prs->bld, false, consume_token(prs));
 
-		case TK_L_PAREN:
-		{
-			const range_location l_loc = consume_token(prs);
-			const node subexpr = parse_expression(prs);
-
-			if (!try_consume_token(prs, TK_R_PAREN))
-			{
-				parser_error(prs, expected_r_paren, l_loc);
-				return node_broken();
-			}
-
-			return subexpr;
-		}
-
 		default:
 			parser_error(prs, expected_expression);
 			return node_broken();
@@ -384,7 +500,7 @@ static node parse_primary_expression(parser *const prs)
  */
 static node_vector parse_initializer_list(parser *const prs)
 {
-	node_vector result = node_vector_create();
+	node_vector result = node_vector_create_by_arena(prs->sx->memory);
 
 	do
 	{
@@ -396,7 +512,125 @@ static node_vector parse_initializer_list(parser *const prs)
 }
 
 /**
- *	Parse postfix expression
+ *	Start initializer inside expression, its assignment expression is parsed by frames
+ *
+ *	@param	prs			Parser
+ *	@param	value		Initializer list
+ *
+ *	@return	Next state
+ */
+static state_t parse_initializer_prefix(parser *const prs, node *const value)
+{
+	if (token_is(&prs->tk, TK_L_BRACE))
+	{
+		*value = parse_initializer(prs);
+		return STATE_RETURN;
+	}
+
+	expression_frame *const frame = push_frame(prs, FRAME_BINARY);
+	if (frame == NULL)
+	{
+		return STATE_FAILURE;
+	}
+
+	frame->min_prec = PREC_ASSIGNMENT;
+	return STATE_OPERAND;
+}
+
+/**
+ *	Start right operand of binary or conditional operator
+ *
+ *	@param	prs			Parser
+ *	@param	value		Initializer list
+ *
+ *	@return	Next state
+ */
+static state_t parse_right_operand_prefix(parser *const prs, node *const value)
+{
+	if (token_is(&prs->tk, TK_L_BRACE))
+	{
+		*value = parse_initializer(prs);
+		return STATE_RETURN;
+	}
+
+	return STATE_OPERAND;
+}
+
+/**
+ *	Parse unary expression up to its primary expression,
+ *	prefix operators and opening parens are postponed in frames
+ *
+ *	unary-expression:
+ *		postfix-expression
+ *		`++` unary-expression
+ *		`--` unary-expression
+ *		unary-operator unary-expression
+ *
+ *	unary-operator: one of
+ *		`&`, `*`, `-`, `~`, `!`, `abs`, `upb`
+ *
+ *	@param	prs			Parser
+ *	@param	value		Primary expression
+ *
+ *	@return	Next state
+ */
+static state_t parse_unary_prefix(parser *const prs, node *const value)
+{
+	while (true)
+	{
+		switch (token_get_kind(&prs->tk))
+		{
+			default:
+				*value = parse_primary_expression(prs);
+				return STATE_POSTFIX;
+
+			case TK_PLUS_PLUS:
+			case TK_MINUS_MINUS:
+			case TK_AMP:
+			case TK_STAR:
+			case TK_MINUS:
+			case TK_TILDE:
+			case TK_EXCLAIM:
+			case TK_ABS:
+			case TK_UPB:
+			{
+				expression_frame *const frame = push_frame(prs, FRAME_UNARY);
+				if (frame == NULL)
+				{
+					return STATE_FAILURE;
+				}
+
+				frame->operator = token_get_kind(&prs->tk);
+				frame->loc = consume_token(prs);
+				continue;
+			}
+
+			case TK_L_PAREN:
+			{
+				expression_frame *frame = push_frame(prs, FRAME_PAREN);
+				if (frame == NULL)
+				{
+					return STATE_FAILURE;
+				}
+
+				frame->loc = consume_token(prs);
+
+				frame = push_frame(prs, FRAME_BINARY);
+				if (frame == NULL)
+				{
+					return STATE_FAILURE;
+				}
+
+				frame->min_prec = PREC_COMMA;
+				continue;
+			}
+		}
+	}
+}
+
+/**
+ *	Parse postfix operators of expression,
+ *	subscripts and arguments of calls are postponed in frames
  *
  *	postfix-expression:
  *		primary-expression
@@ -408,39 +642,38 @@ static node_vector parse_initializer_list(parser *const prs)
  *		postfix-expression `--`
  *
  *	@param	prs			Parser
+ *	@param	value		Operand of postfix operators
  *
- *	@return	Postfix expression
+ *	@return	Next state
  */
-static node parse_postfix_expression(parser *const prs)
+static state_t parse_postfix_suffix(parser *const prs, node *const value)
 {
-	node operand = parse_primary_expression(prs);
-
 	while (true)
 	{
 		switch (token_get_kind(&prs->tk))
 		{
 			default:
-				return operand;
+				return STATE_RETURN;
 
 			case TK_L_SQUARE:
 			{
-				const range_location l_loc = consume_token(prs);
-				node index = parse_expression(prs);
-
-				if (token_is(&prs->tk, TK_R_SQUARE))
+				expression_frame *frame = push_frame(prs, FRAME_SUBSCRIPT);
+				if (frame == NULL)
 				{
-					const range_location r_loc = consume_token(prs);
-					operand = build_subscript_expression(&prs->bld, &operand, &index, l_loc, r_loc);
+					return STATE_FAILURE;
 				}
-				else
+
+				frame->operand = *value;
+				frame->loc = consume_token(prs);
+
+				frame = push_frame(prs, FRAME_BINARY);
+				if (frame == NULL)
 				{
-					parser_error(prs, expected_r_square, l_loc);
-					skip_until(prs, TK_R_SQUARE | TK_SEMICOLON);
-					try_consume_token(prs, TK_R_SQUARE);
-					operand = node_broken();
+					return STATE_FAILURE;
 				}
 
-				continue;
+				frame->min_prec = PREC_COMMA;
+				return STATE_OPERAND;
 			}
 
 			case TK_L_PAREN:
@@ -450,27 +683,21 @@ static node parse_postfix_expression(parser *const prs)
 				if (token_is(&prs->tk, TK_R_PAREN))
 				{
 					const range_location r_loc = consume_token(prs);
-					operand = build_call_expression(&prs->bld, &operand, NULL, l_loc, r_loc);
+					*value = build_call_expression(&prs->bld, value, NULL, l_loc, r_loc);
 
 					continue;
 				}
 
-				node_vector args = parse_initializer_list(prs);
-				if (token_is(&prs->tk, TK_R_PAREN))
+				expression_frame *const frame = push_frame(prs, FRAME_CALL);
+				if (frame == NULL)
 				{
-					const range_location r_loc = consume_token(prs);
-					operand = build_call_expression(&prs->bld, &operand, &args, l_loc, r_loc);
-				}
-				else
-				{
-					parser_error(prs, expected_r_paren, l_loc);
-					skip_until(prs, TK_R_PAREN | TK_SEMICOLON);
-					try_consume_token(prs, TK_R_PAREN);
-					operand = node_broken();
+					return STATE_FAILURE;
 				}
 
-				node_vector_clear(&args);
-				continue;
+				frame->operand = *value;
+				frame->loc = l_loc;
+				frame->args = node_vector_create_by_arena(prs->sx->memory);
+				return parse_initializer_prefix(prs, value);
 			}
 
 			case TK_PERIOD:
@@ -484,12 +711,12 @@ static node parse_postfix_expression(parser *const prs)
 					const size_t name = token_get_ident_name(&prs->tk);
 					const range_location id_loc = consume_token(prs);
 
-					operand = build_member_expression(&prs->bld, &operand, name, is_arrow, op_loc, id_loc);
+					*value = build_member_expression(&prs->bld, value, name, is_arrow, op_loc, id_loc);
 				}
 				else
 				{
 					parser_error(prs, expected_identifier_in_member_expr);
-					operand = node_broken();
+					*value = node_broken();
 				}
 
 				continue;
@@ -498,14 +725,14 @@ static node parse_postfix_expression(parser *const prs)
 			case TK_PLUS_PLUS:
 			{
 				const range_location op_loc = consume_token(prs);
-				operand = build_unary_expression(&prs->bld, &operand, UN_POSTINC, op_loc);
+				*value = build_unary_expression(&prs->bld, value, UN_POSTINC, op_loc);
 				continue;
 			}
 
 			case TK_MINUS_MINUS:
 			{
 				const range_location op_loc = consume_token(prs);
-				operand = build_unary_expression(&prs->bld, &operand, UN_POSTDEC, op_loc);
+				*value = build_unary_expression(&prs->bld, value, UN_POSTDEC, op_loc);
 				continue;
 			}
 		}
@@ -513,104 +740,227 @@ static node parse_postfix_expression(parser *const prs)
 }
 
 /**
- *	Parse unary expression
- *
- *	unary-expression:
- *		postfix-expression
- *		`++` unary-expression
- *		`--` unary-expression
- *		unary-operator unary-expression
- *
- *	unary-operator: one of
- *		`&`, `*`, `-`, `~`, `!`, `abs`, `upb`
+ *	Build binary or conditional expression of frame
  *
  *	@param	prs			Parser
+ *	@param	frame		Frame of operator
+ *	@param	value		Right operand
  *
- *	@return	Unary expression
+ *	@return	Next state
  */
-static node parse_unary_expression(parser *const prs)
+static state_t parse_operator_suffix(parser *const prs, expression_frame *const frame, node *const value)
 {
-	switch (token_get_kind(&prs->tk))
+	if (get_operator_precedence(frame->operator) != PREC_CONDITIONAL)
 	{
-		default:
-			return parse_postfix_expression(prs);
-
-		case TK_PLUS_PLUS:
-		case TK_MINUS_MINUS:
-		case TK_AMP:
-		case TK_STAR:
-		case TK_MINUS:
-		case TK_TILDE:
-		case TK_EXCLAIM:
-		case TK_ABS:
-		case TK_UPB:
-		{
-			const unary_t operator = token_to_unary(token_get_kind(&prs->tk));
-			const range_location op_loc = consume_token(prs);
-			node operand = parse_unary_expression(prs);
-
-			return build_unary_expression(&prs->bld, &operand, operator, op_loc);
-		}
+		const binary_t op_kind = token_to_binary(frame->operator);
+		*value = build_binary_expression(&prs->bld, &frame->operand, value, op_kind, frame->loc);
 	}
+	else
+	{
+		*value = build_ternary_expression(&prs->bld, &frame->operand, &frame->middle, value, frame->loc);
+	}
+
+	frame->kind = FRAME_BINARY;
+	return STATE_RETURN;
 }
 
 /**
- *	Parse right hand side of binary expression
+ *	Pass complete value to the top frame
  *
  *	@param	prs			Parser
- *	@param	LHS			Start of a binary expression
- *	@param	min_prec	Minimal precedence level
+ *	@param	value		Complete value
  *
- *	@return Binary expression
+ *	@return	Next state
  */
-static node parse_RHS_of_binary_expression(parser *const prs, node *const LHS, const precedence_t min_prec)
+static state_t parse_frame(parser *const prs, node *const value)
 {
-	precedence_t next_token_prec = get_operator_precedence(token_get_kind(&prs->tk));
-	while (next_token_prec >= min_prec)
+	expression_frame *const frame = &prs->frames[prs->frames_size - 1];
+	switch (frame->kind)
 	{
-		const token_t op_token_kind = token_get_kind(&prs->tk);
-		range_location op_loc = consume_token(prs);
+		case FRAME_UNARY:
+		{
+			const unary_t operator = token_to_unary(frame->operator);
+			*value = build_unary_expression(&prs->bld, value, operator, frame->loc);
+
+			prs->frames_size--;
+			return STATE_RETURN;
+		}
 
-		const bool is_binary = next_token_prec != PREC_CONDITIONAL;
-		node middle = node_broken();
-		if (!is_binary)
+		case FRAME_PAREN:
 		{
-			middle = parse_initializer(prs);
+			if (!try_consume_token(prs, TK_R_PAREN))
+			{
+				parser_error(prs, expected_r_paren, frame->loc);
+				*value = node_broken();
+			}
 
-			if (token_is(&prs->tk, TK_COLON))
+			prs->frames_size--;
+			return STATE_POSTFIX;
+		}
+
+		case FRAME_SUBSCRIPT:
+		{
+			if (token_is(&prs->tk, TK_R_SQUARE))
 			{
-				op_loc = consume_token(prs);
+				const range_location r_loc = consume_token(prs);
+				*value = build_subscript_expression(&prs->bld, &frame->operand, value, frame->loc, r_loc);
 			}
 			else
 			{
-				parser_error(prs, expected_colon_in_conditional_expr, op_loc);
+				parser_error(prs, expected_r_square, frame->loc);
+				skip_until(prs, TK_R_SQUARE | TK_SEMICOLON);
+				try_consume_token(prs, TK_R_SQUARE);
+				*value = node_broken();
 			}
+
+			prs->frames_size--;
+			return STATE_POSTFIX;
 		}
 
-		node RHS = token_is(&prs->tk, TK_L_BRACE) ? parse_initializer(prs) : parse_unary_expression(prs);
+		case FRAME_CALL:
+		{
+			node_vector_add(&frame->args, value);
+			if (try_consume_token(prs, TK_COMMA))
+			{
+				return parse_initializer_prefix(prs, value);
+			}
 
-		const precedence_t this_prec = next_token_prec;
-		next_token_prec = get_operator_precedence(token_get_kind(&prs->tk));
+			if (token_is(&prs->tk, TK_R_PAREN))
+			{
+				const range_location r_loc = consume_token(prs);
+				*value = build_call_expression(&prs->bld, &frame->operand, &frame->args, frame->loc, r_loc);
+			}
+			else
+			{
+				parser_error(prs, expected_r_paren, frame->loc);
+				skip_until(prs, TK_R_PAREN | TK_SEMICOLON);
+				try_consume_token(prs, TK_R_PAREN);
+				*value = node_broken();
+			}
+
+			node_vector_clear(&frame->args);
+			prs->frames_size--;
+			return STATE_POSTFIX;
+		}
 
-		const bool is_right_associative = this_prec == PREC_CONDITIONAL || this_prec == PREC_ASSIGNMENT;
-		if (this_prec < next_token_prec || (this_prec == next_token_prec && is_right_associative))
+		case FRAME_BINARY:
 		{
-			RHS = parse_RHS_of_binary_expression(prs, &RHS, (this_prec + !is_right_associative));
-			next_token_prec = get_operator_precedence((token_get_kind(&prs->tk)));
+			const token_t operator = token_get_kind(&prs->tk);
+			if (get_operator_precedence(operator) < frame->min_prec)
+			{
+				prs->frames_size--;
+				return STATE_RETURN;
+			}
+
+			frame->operator = operator;
+			frame->operand = *value;
+			frame->middle = node_broken();
+			frame->loc = consume_token(prs);
+
+			if (get_operator_precedence(operator) == PREC_CONDITIONAL)
+			{
+				frame->kind = FRAME_MIDDLE;
+				return parse_initializer_prefix(prs, value);
+			}
+
+			frame->kind = FRAME_RIGHT;
+			return parse_right_operand_prefix(prs, value);
 		}
 
-		if (is_binary)
+		case FRAME_MIDDLE:
 		{
-			const binary_t op_kind = token_to_binary(op_token_kind);
-			*LHS = build_binary_expression(&prs->bld, LHS, &RHS, op_kind, op_loc);
+			frame->middle = *value;
+			if (token_is(&prs->tk, TK_COLON))
+			{
+				frame->loc = consume_token(prs);
+			}
+			else
+			{
+				parser_error(prs, expected_colon_in_conditional_expr, frame->loc);
+			}
+
+			frame->kind = FRAME_RIGHT;
+			return parse_right_operand_prefix(prs, value);
 		}
-		else
+
+		case FRAME_RIGHT:
+		{
+			const precedence_t this_prec = get_operator_precedence(frame->operator);
+			const precedence_t next_prec = get_operator_precedence(token_get_kind(&prs->tk));
+			const bool is_right_associative = operator_is_right_associative(frame->operator);
+			if (this_prec > next_prec || (this_prec == next_prec && !is_right_associative))
+			{
+				return parse_operator_suffix(prs, frame, value);
+			}
+
+			// Правый операнд продолжается операторами старшего приоритета
+			frame->kind = FRAME_BUILD;
+
+			expression_frame *const next = push_frame(prs, FRAME_BINARY);
+			if (next == NULL)
+			{
+				return STATE_FAILURE;
+			}
+
+			next->min_prec = this_prec + !is_right_associative;
+			return STATE_RETURN;
+		}
+
+		case FRAME_BUILD:
+			return parse_operator_suffix(prs, frame, value);
+	}
+
+	return STATE_FAILURE;
+}
+
+/**
+ *	Parse expression with binary operators of minimal precedence or higher.
+ *	Nested constructions are postponed in frames of parser instead of native stack,
+ *	so nesting depth of expression is limited only by memory.
+ *
+ *	@param	prs			Parser
+ *	@param	min_prec	Minimal precedence level
+ *
+ *	@return	Expression
+ */
+static node parse_binary_expression(parser *const prs, const precedence_t min_prec)
+{
+	const size_t base = prs->frames_size;
+	expression_frame *const frame = push_frame(prs, FRAME_BINARY);
+	if (frame == NULL)
+	{
+		return node_broken();
+	}
+
+	frame->min_prec = min_prec;
+
+	node value = node_broken();
+	state_t state = STATE_OPERAND;
+	while (state != STATE_FAILURE && (state != STATE_RETURN || prs->frames_size != base))
+	{
+		switch (state)
 		{
-			*LHS = build_ternary_expression(&prs->bld, LHS, &middle, &RHS, op_loc);
+			case STATE_OPERAND:
+				state = parse_unary_prefix(prs, &value);
+				break;
+
+			case STATE_POSTFIX:
+				state = parse_postfix_suffix(prs, &value);
+				break;
+
+			default:
+				state = parse_frame(prs, &value);
+				break;
 		}
 	}
 
-	return *LHS;
+	if (state == STATE_FAILURE)
+	{
+		prs->frames_size = base;
+		return node_broken();
+	}
+
+	return value;
 }
 
 /**
@@ -629,8 +979,7 @@ static node parse_RHS_of_binary_expression(parser *const prs, node *const LHS, c
  */
 static node parse_assignment_expression(parser *const prs)
 {
-	node LHS = parse_unary_expression(prs);
-	return parse_RHS_of_binary_expression(prs, &LHS, PREC_ASSIGNMENT);
+	return parse_binary_expression(prs, PREC_ASSIGNMENT);
 }
 
 /**
@@ -646,8 +995,7 @@ static node parse_assignment_expression(parser *const prs)
  */
 static node parse_expression(parser *const prs)
 {
-	node LHS = parse_assignment_expression(prs);
-	return parse_RHS_of_binary_expression(prs, &LHS, PREC_COMMA);
+	return parse_binary_expression(prs, PREC_COMMA);
 }
 
 /**
@@ -662,10 +1010,8 @@ static node parse_expression(parser *const prs)
  */
 static node parse_constant_expression(parser *const prs)
 {
-	node LHS = parse_unary_expression(prs);
-	LHS = parse_RHS_of_binary_expression(prs, &LHS, PREC_CONDITIONAL);
-
-	return build_constant_expression(&prs->bld, &LHS);
+	node expr = parse_binary_expression(prs, PREC_CONDITIONAL);
+	return build_constant_expression(&prs->bld, &expr);
 }
 
 /**
@@ -691,11 +1037,23 @@ static node parse_initializer(parser *const prs)
 			return node_broken();
 		}
 
+		// Вложенные списки инициализируют следующее измерение массива
+		const size_t depth = prs->packed_depth;
+		const size_t size = vector_size(&prs->sx->tree);
+		prs->packed_depth = depth > 1 ? depth - 1 : 0;
 		node_vector inits = parse_initializer_list(prs);
+		prs->packed_depth = depth;
+
 		if (token_is(&prs->tk, TK_R_BRACE))
 		{
 			const range_location r_loc = consume_token(prs);
-			const node result = build_initializer(&prs->bld, &inits, l_loc, r_loc);
+			node result = depth == 1 && !prs->sx->is_checked_only
+				? build_packed_initializer(&prs->bld, &inits, prs->packed_type, size, l_loc, r_loc)
+				: node_broken();
+			if (!node_is_correct(&result))
+			{
+				result = build_initializer(&prs->bld, &inits, l_loc, r_loc);
+			}
 
 			node_vector_clear(&inits);
 			return result;
@@ -711,7 +1069,12 @@ static node parse_initializer(parser *const prs)
 		}
 	}
 
-	return parse_assignment_expression(prs);
+	// Списки в аргументах вызовов не упаковываются
+	const size_t depth = prs->packed_depth;
+	prs->packed_depth = 0;
+	const node result = parse_assignment_expression(prs);
+	prs->packed_depth = depth;
+	return result;
 }
 
 /**
@@ -774,6 +1137,8 @@ static node parse_condition(parser *const prs)
  *		`long`
  *		`float`
  *		`double`
+ *		`int4`
+ *		`float4`
  *		struct-specifier
  *		enum-specifier
  *		typedef-name
@@ -809,6 +1174,14 @@ static item_t parse_type_specifier(parser *const prs, const node *const parent)
 			consume_token(prs);
 			return TYPE_FLOATING;
 
+		case TK_INT4:
+			consume_token(prs);
+			return type_vector(prs->sx, TYPE_INTEGER);
+
+		case TK_FLOAT4:
+			consume_token(prs);
+			return type_vector(prs->sx, TYPE_FLOATING);
+
 		case TK_FILE:
 			consume_token(prs);
 			return TYPE_FILE;
@@ -817,7 +1190,7 @@ static item_t parse_type_specifier(parser *const prs, const node *const parent)
 		{
 			const size_t name = token_get_ident_name(&prs->tk);
 			const item_t id = repr_get_reference(prs->sx, name);
-			consume_token(prs);
+			const range_location loc = consume_token(prs);
 
 			if (id == ITEM_MAX || !ident_is_type_specifier(prs->sx, (size_t)id))
 			{
@@ -825,6 +1198,7 @@ static item_t parse_type_specifier(parser *const prs, const node *const parent)
 				return TYPE_UNDEFINED;
 			}
 
+			ident_add_occurrence(prs->sx, (size_t)id, false, loc.begin, loc.end);
 			return ident_get_type(prs->sx, (size_t)id);
 		}
 
@@ -854,8 +1228,9 @@ static item_t parse_type_specifier(parser *const prs, const node *const parent)
 			if (token_is(&prs->tk, TK_IDENTIFIER))
 			{
 				const size_t repr = token_get_ident_name(&prs->tk);
-				consume_token(prs);
-				to_identab(prs, repr, 1000, type);
+				const range_location loc = consume_token(prs);
+				const size_t id = to_identab(prs, repr, 1000, type);
+				ident_add_occurrence(prs->sx, id, true, loc.begin, loc.end);
 				prs->was_type_def = true;
 				if (token_is_not(&prs->tk, TK_SEMICOLON))
 				{
@@ -910,7 +1285,7 @@ static node parse_member_declaration(parser *const prs, const node *const parent
 	const size_t name = token_get_ident_name(&prs->tk);
 	const range_location ident_loc = consume_token(prs);
 
-	node_vector bounds = node_vector_create();
+	node_vector bounds = node_vector_create_by_arena(prs->sx->memory);
 	while (try_consume_token(prs, TK_L_SQUARE))
 	{
 		if (try_consume_token(prs, TK_R_SQUARE))
@@ -965,7 +1340,7 @@ static item_t parse_struct_declaration(parser *const prs, const node *const pare
 
 	node declaration = build_empty_struct_declaration(&prs->bld, name, struct_loc);
 
-	node_vector members = node_vector_create();
+	node_vector members = node_vector_create_by_arena(prs->sx->memory);
 	while (!try_consume_token(prs, TK_R_BRACE))
 	{
 		const node member = parse_member_declaration(prs, &declaration);
@@ -1008,11 +1383,19 @@ static item_t parse_struct_specifier(parser *const prs, const node *const parent
 		case TK_IDENTIFIER:
 		{
 			const size_t name = token_get_ident_name(&prs->tk);
-			consume_token(prs);
+			const range_location loc = consume_token(prs);
 
 			if (token_is(&prs->tk, TK_L_BRACE))
 			{
-				return parse_struct_declaration(prs, parent, struct_loc, name);
+				const item_t type = parse_struct_declaration(prs, parent, struct_loc, name);
+				if (!type_is_undefined(type))
+				{
+					// Описание структуры добавляет билдер, поэтому оно уже видно по представлению
+					const size_t id = (size_t)repr_get_reference(prs->sx, name);
+					ident_add_occurrence(prs->sx, id, true, loc.begin, loc.end);
+				}
+
+				return type;
 			}
 
 			const item_t id = repr_get_reference(prs->sx, name);
@@ -1022,6 +1405,7 @@ static item_t parse_struct_specifier(parser *const prs, const node *const parent
 				return TYPE_UNDEFINED;
 			}
 
+			ident_add_occurrence(prs->sx, (size_t)id, false, loc.begin, loc.end);
 			return ident_get_type(prs->sx, (size_t)id);
 		}
 
@@ -1031,10 +1415,12 @@ static item_t parse_struct_specifier(parser *const prs, const node *const parent
 	}
 }
 
-static void parse_init_enum_field_declarator(parser *const prs, item_t type, item_t number, size_t name)
+static void parse_init_enum_field_declarator(parser *const prs, item_t type, item_t number, size_t name
+	, const range_location loc)
 {
 	const size_t old_id = to_identab(prs, name, 0, type);
 	ident_set_displ(prs->sx, old_id, number);
+	ident_add_occurrence(prs->sx, old_id, true, loc.begin, loc.end);
 }
 
 static item_t parse_enum_declaration_list(parser *const prs, const node *const parent)
@@ -1061,7 +1447,7 @@ static item_t parse_enum_declaration_list(parser *const prs, const node *const p
 		}
 
 		const size_t name = token_get_ident_name(&prs->tk);
-		consume_token(prs);
+		const range_location loc = consume_token(prs);
 
 		if (token_is(&prs->tk, TK_EQUAL))
 		{
@@ -1075,7 +1461,7 @@ static item_t parse_enum_declaration_list(parser *const prs, const node *const p
 				continue;
 			}
 			const item_t type_expr = expression_get_type(&expr);
-			field_value = expression_literal_get_integer(&expr);
+			field_value = (item_t)expression_literal_get_integer(&expr);
 			node_remove(&expr);
 
 			if (field_value == INT_MAX || (type_expr != TYPE_INTEGER && type_expr != type))
@@ -1083,11 +1469,11 @@ static item_t parse_enum_declaration_list(parser *const prs, const node *const p
 				parser_error(prs, not_const_int_expr);
 				return TYPE_UNDEFINED;
 			}
-			parse_init_enum_field_declarator(prs, -type, field_value++, name);
+			parse_init_enum_field_declarator(prs, -type, field_value++, name, loc);
 		}
 		else
 		{
-			parse_init_enum_field_declarator(prs, -type, field_value++, name);
+			parse_init_enum_field_declarator(prs, -type, field_value++, name, loc);
 		}
 
 		local_modetab[local_md++] = field_value - 1;
@@ -1119,12 +1505,13 @@ static item_t parse_enum_specifier(parser *const prs, const node *const parent)
 		case TK_IDENTIFIER:
 		{
 			const size_t repr = token_get_ident_name(&prs->tk);
-			consume_token(prs);
+			const range_location loc = consume_token(prs);
 
 			if (token_is(&prs->tk, TK_L_BRACE))
 			{
 				const item_t type = parse_enum_declaration_list(prs, parent);
 				const size_t id = to_identab(prs, repr, 1000, type);
+				ident_add_occurrence(prs->sx, id, true, loc.begin, loc.end);
 				prs->was_type_def = true;
 				return ident_get_type(prs->sx, (size_t)id);
 			}
@@ -1137,6 +1524,8 @@ static item_t parse_enum_specifier(parser *const prs, const node *const parent)
 					parser_error(prs, ident_is_not_declared, repr_get_name(prs->sx, repr));
 					return TYPE_UNDEFINED;
 				}
+
+				ident_add_occurrence(prs->sx, (size_t)id, false, loc.begin, loc.end);
 				return ident_get_type(prs->sx, (size_t)id);
 			}
 		}
@@ -1179,7 +1568,7 @@ static node parse_init_declarator(parser *const prs, const item_t type)
 	const size_t name = token_get_ident_name(&prs->tk);
 	const range_location ident_loc = consume_token(prs);
 
-	node_vector bounds = node_vector_create();
+	node_vector bounds = node_vector_create_by_arena(prs->sx->memory);
 	while (try_consume_token(prs, TK_L_SQUARE))
 	{
 		if (token_is(&prs->tk, TK_R_SQUARE))
@@ -1209,7 +1598,11 @@ static node parse_init_declarator(parser *const prs, const item_t type)
 	node initializer = node_broken();
 	if (try_consume_token(prs, TK_EQUAL))
 	{
+		// Списки последнего измерения массива чисел хранят значения литералов без их узлов
+		prs->packed_type = type;
+		prs->packed_depth = was_star ? 0 : node_vector_size(&bounds);
 		initializer = parse_initializer(prs);
+		prs->packed_depth = 0;
 		if (!node_is_correct(&initializer))
 		{
 			skip_until(prs, TK_COMMA | TK_SEMICOLON);
@@ -1243,7 +1636,7 @@ static node parse_declaration(parser *const prs)
 	const range_location start_loc = token_get_location(&prs->tk);
 
 	const item_t type = parse_type_specifier(prs, &declaration);
-	node_vector declarators = node_vector_create();
+	node_vector declarators = node_vector_create_by_arena(prs->sx->memory);
 
 	if (token_is_not(&prs->tk, TK_SEMICOLON))
 	{
@@ -1286,6 +1679,8 @@ static bool is_declaration_specifier(parser *const prs)
 		case TK_LONG:
 		case TK_FLOAT:
 		case TK_DOUBLE:
+		case TK_INT4:
+		case TK_FLOAT4:
 		case TK_STRUCT:
 		case TK_ENUM:
 		case TK_FILE:
@@ -1395,7 +1790,7 @@ static node parse_compound_statement_body(parser *const prs)
 	assert(token_is(&prs->tk, TK_L_BRACE));
 	const range_location l_loc = consume_token(prs);
 
-	node_vector stmts = node_vector_create();
+	node_vector stmts = node_vector_create_by_arena(prs->sx->memory);
 	while (token_is_not(&prs->tk, TK_R_BRACE) && token_is_not(&prs->tk, TK_EOF))
 	{
 		const node stmt = is_declaration_specifier(prs) ? parse_declaration(prs) : parse_statement(prs);
@@ -1994,7 +2389,8 @@ static item_t parse_function_declarator(parser *const prs, const int level, int
 }
 
 /**
- *	Parse function definition
+ *	Parse function definition.
+ *	Tokens of function body are stored, body is parsed after all external declarations
  *
  *	@param	prs			Parser structure
  *	@param	parent		Parent node in AST
@@ -2010,16 +2406,13 @@ static void parse_function_definition(parser *const prs, node *const parent, con
 		return;
 	}
 
-	prs->bld.func_type = ident_get_type(prs->sx, function_id);
+	const item_t func_type = ident_get_type(prs->sx, function_id);
 	const size_t function_number = (size_t)ident_get_displ(prs->sx, function_id);
-	const size_t param_number = type_function_get_parameter_amount(prs->sx, prs->bld.func_type);
-
-	prs->was_return = 0;
 
 	const size_t prev = ident_get_prev(prs->sx, function_id);
 	if (prev > 1 && prev != ITEM_MAX - 1) // Был прототип
 	{
-		if (prs->bld.func_type != ident_get_type(prs->sx, prev))
+		if (func_type != ident_get_type(prs->sx, prev))
 		{
 			parser_error(prs, decl_and_def_have_diff_type);
 			skip_until(prs, TK_R_BRACE);
@@ -2033,6 +2426,69 @@ static void parse_function_definition(parser *const prs, node *const parent, con
 	node_add_arg(&nd, (item_t)function_id);
 	node_add_arg(&nd, 0); // for max_displ
 
+	func_set(prs->sx, function_number, (item_t)node_save(&nd)); // Ссылка на расположение в дереве
+
+	vector_add(&prs->bodies, (item_t)node_save(&nd));
+	vector_add(&prs->bodies, (item_t)function_id);
+	vector_add(&prs->bodies, (item_t)scope_global_get_mark(prs->sx));
+	vector_add(&prs->bodies, (item_t)prs->tokens_size);
+
+	// Тело до парной скобки сохраняется вместе со следующей лексемой, на которой закончился бы разбор
+	size_t depth = 0;
+	do
+	{
+		if (token_is(&prs->tk, TK_L_BRACE))
+		{
+			depth++;
+		}
+		else if (token_is(&prs->tk, TK_R_BRACE))
+		{
+			depth--;
+		}
+
+		store_token(prs);
+
+		// Сообщения лексера выводятся перед сообщениями разбора следующей лексемы
+		reporter_set_group(&prs->sx->rprt, REPORT_GROUP(prs->tokens_size + 1, 1));
+		consume_token(prs);
+	} while (depth != 0 && token_is_not(&prs->tk, TK_EOF));
+
+	store_token(prs);
+	vector_add(&prs->bodies, (item_t)prs->tokens_size);
+
+	// Сообщения об описаниях после тела выводятся после сообщений о нём
+	reporter_set_group(&prs->sx->rprt, REPORT_GROUP(prs->tokens_size, 3));
+}
+
+/**
+ *	Parse postponed function body
+ *
+ *	@param	prs			Parser structure
+ *	@param	index		Index of postponed body
+ *	@param	mark		Mark of visible global declarations
+ *
+ *	@return	Mark of global declarations visible in function body
+ */
+static size_t parse_function_body(parser *const prs, const size_t index, const size_t mark)
+{
+	const size_t record = BODY_ITEMS * index;
+	node nd = node_load(&prs->sx->tree, (size_t)vector_get(&prs->bodies, record));
+	const size_t function_id = (size_t)vector_get(&prs->bodies, record + 1);
+	const size_t body_mark = (size_t)vector_get(&prs->bodies, record + 2);
+
+	// Тело видит только глобальные описания, сделанные до него
+	scope_global_move(prs->sx, mark, body_mark);
+
+	prs->replay = (size_t)vector_get(&prs->bodies, record + 3);
+	prs->replay_end = (size_t)vector_get(&prs->bodies, record + 4);
+	consume_token(prs);
+
+	prs->bld.func_type = ident_get_type(prs->sx, function_id);
+	const size_t function_number = (size_t)ident_get_displ(prs->sx, function_id);
+	const size_t param_number = type_function_get_parameter_amount(prs->sx, prs->bld.func_type);
+
+	prs->was_return = 0;
+
 	const item_t old_displ = scope_func_enter(prs->sx);
 
 	for (size_t i = 0; i < param_number; i++)
@@ -2055,8 +2511,6 @@ static void parse_function_definition(parser *const prs, node *const parent, con
 		node_add_arg(&param, false);		// has init
 	}
 
-	func_set(prs->sx, function_number, (item_t)node_save(&nd)); // Ссылка на расположение в дереве
-
 	node_copy(&prs->bld.context, &nd);
 	node body = parse_compound_statement_body(prs);
 
@@ -2071,6 +2525,120 @@ static void parse_function_definition(parser *const prs, node *const parent, con
 
 	const item_t max_displ = scope_func_exit(prs->sx, old_displ);
 	node_set_arg(&nd, 1, max_displ);
+
+	return body_mark;
+}
+
+/**
+ *	Add bodies of functions referenced since the last call to worklist
+ *
+ *	@param	prs			Parser structure
+ *	@param	numbers		Body index plus one by function number, @c 0 for absent or queued body
+ *	@param	worklist	Indexes of bodies waiting for parsing
+ */
+static void queue_referenced_bodies(parser *const prs, vector *const numbers, vector *const worklist)
+{
+	for (size_t i = 0; i < vector_size(prs->bld.references); i++)
+	{
+		const size_t id = (size_t)vector_get(prs->bld.references, i);
+		const size_t number = (size_t)ident_get_displ(prs->sx, id);
+		const item_t body = vector_get(numbers, number);
+		if (body == 0 || body == ITEM_MAX)
+		{
+			continue;
+		}
+
+		// Номера встроенных функций совпадают с номерами пользовательских, поэтому подходят только
+		// само определение и его прототип
+		const size_t function_id = (size_t)vector_get(&prs->bodies, BODY_ITEMS * (size_t)(body - 1) + 1);
+		if (id == function_id || ident_get_repr(prs->sx, id) < 0)
+		{
+			vector_add(worklist, body - 1);
+			vector_set(numbers, number, 0);
+		}
+	}
+
+	vector_resize(prs->bld.references, 0);
+}
+
+/**
+ *	Parse bodies of functions reachable from main, other function definitions are removed
+ *
+ *	@param	prs			Parser structure
+ *	@param	mark		Mark of visible global declarations
+ *
+ *	@return	Mark of global declarations visible after parsing
+ */
+static size_t parse_reachable_bodies(parser *const prs, size_t mark)
+{
+	const size_t amount = vector_size(&prs->bodies) / BODY_ITEMS;
+	vector numbers = vector_create(vector_size(&prs->sx->functions));
+	vector_increase(&numbers, vector_size(&prs->sx->functions));
+	vector worklist = vector_create(amount);
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		const size_t function_id = (size_t)vector_get(&prs->bodies, BODY_ITEMS * i + 1);
+		const size_t number = (size_t)ident_get_displ(prs->sx, function_id);
+		vector_set(&numbers, number, (item_t)i + 1);
+
+		if (function_id == prs->sx->ref_main)
+		{
+			vector_add(&worklist, (item_t)i);
+			vector_set(&numbers, number, 0);
+		}
+	}
+
+	// Функции из инициализаторов глобальных переменных тоже достижимы
+	queue_referenced_bodies(prs, &numbers, &worklist);
+	while (vector_size(&worklist) != 0)
+	{
+		mark = parse_function_body(prs, (size_t)vector_remove(&worklist), mark);
+		queue_referenced_bodies(prs, &numbers, &worklist);
+	}
+
+	for (size_t i = 0; i < vector_size(&numbers); i++)
+	{
+		const item_t body = vector_get(&numbers, i);
+		if (body != 0)
+		{
+			node nd = node_load(&prs->sx->tree, (size_t)vector_get(&prs->bodies, BODY_ITEMS * (size_t)(body - 1)));
+			node_remove(&nd);
+			func_set(prs->sx, i, 0);
+		}
+	}
+
+	vector_clear(&numbers);
+	vector_clear(&worklist);
+	return mark;
+}
+
+/**
+ *	Parse postponed function bodies against complete global scope
+ *
+ *	@param	prs			Parser structure
+ */
+static void parse_function_bodies(parser *const prs)
+{
+	const size_t global_mark = scope_global_get_mark(prs->sx);
+	const token last = prs->tk;
+
+	size_t mark = global_mark;
+	if (prs->bld.references != NULL && prs->sx->ref_main != 0)
+	{
+		mark = parse_reachable_bodies(prs, mark);
+	}
+	else
+	{
+		for (size_t i = 0; i < vector_size(&prs->bodies) / BODY_ITEMS; i++)
+		{
+			mark = parse_function_body(prs, i, mark);
+		}
+	}
+
+	scope_global_move(prs->sx, mark, global_mark);
+	prs->replay = SIZE_MAX;
+	prs->tk = last;
 }
 
 /**
@@ -2085,7 +2653,7 @@ static void parse_function_declaration(parser *const prs, node *const parent, co
 	const size_t function_num = func_reserve(prs->sx);
 	const size_t function_repr = token_get_ident_name(&prs->tk);
 
-	consume_token(prs);	// TK_IDENTIFIER
+	const range_location function_loc = consume_token(prs);	// TK_IDENTIFIER
 	consume_token(prs);	// TK_L_PAREN
 	const item_t function_mode = parse_function_declarator(prs, 1, 3, type);
 
@@ -2127,6 +2695,7 @@ static void parse_function_declaration(parser *const prs, node *const parent, co
 	}
 
 	const size_t function_id = to_identab(prs, function_repr, (item_t)function_num, function_mode);
+	ident_add_occurrence(prs->sx, function_id, true, function_loc.begin, function_loc.end);
 
 	if (token_is(&prs->tk, TK_L_BRACE))
 	{
@@ -2213,12 +2782,12 @@ static void parse_external_definition(parser *const prs, node *const root)
  *	@param	prs			Parser
  *	@param	root		Root node
  */
-static void parse_translation_unit(parser *const prs, node *const root)
+static void parse_translation_unit(parser *const prs, node *const root, const size_t end)
 {
 	do
 	{
 		parse_external_definition(prs, root);
-	} while (token_is_not(&prs->tk, TK_EOF));
+	} while (token_is_not(&prs->tk, TK_EOF) && token_get_location(&prs->tk).begin < end);
 }
 
 
@@ -2232,23 +2801,113 @@ static void parse_translation_unit(parser *const prs, node *const root)
 
 
 int parse(syntax *const sx)
+{
+	return parse_range(sx, 0, SIZE_MAX);
+}
+
+int parse_range(syntax *const sx, const size_t begin, const size_t end)
 {
 	if (sx == NULL)
 	{
 		return -1;
 	}
 
-	parser prs = parser_create(sx);
+	parser prs = parser_create(sx, begin);
 	node root = node_get_root(&sx->tree);
 	node_copy(&prs.bld.context, &root);
 
-	parse_translation_unit(&prs, &root);
+	if (sx->is_parallel && end == SIZE_MAX)
+	{
+		lex_parallel(&prs.lxr);
+	}
+
+	vector references = vector_create(sx->is_lazy ? 64 : 0);
+	prs.bld.references = sx->is_lazy ? &references : NULL;
+
+	parse_translation_unit(&prs, &root, end);
+	parse_function_bodies(&prs);
 
-#ifndef NDEBUG
-	write_tree(DEFAULT_TREE, sx);
-#endif
+	// Сжатие и заморозка дерева нужны только кодогенераторам
+	if (!sx->is_checked_only)
+	{
+		// Тела всех функций уже разобраны, поэтому вызовы чистых функций в глобальных описаниях вычисляются
+		evaluate_global_declarations(sx);
+
+		// Удаление мусора после свёртки выражений, ссылки на функции пересчитываются
+		if (!node_compact(&sx->tree))
+		{
+			for (size_t i = 0; i < node_get_amount(&root); i++)
+			{
+				const node nd = node_get_child(&root, i);
+				if (node_get_type(&nd) == OP_FUNC_DEF)
+				{
+					const size_t function_id = (size_t)node_get_arg(&nd, 0);
+					func_set(sx, (size_t)ident_get_displ(sx, function_id), (item_t)node_save(&nd));
+				}
+			}
+		}
+		node_freeze(&root);
+	}
 
+	vector_clear(&references);
 	parser_clear(&prs);
 	// Временное решение - парсер не проверяет таблицы
-	return sx->rprt.errors == 0 ? 0 : -1;
+	return reporter_get_errors_number(&sx->rprt) == 0 ? 0 : -1;
+}
+
+int parse_by_declarations(syntax *const sx, const declaration_handler handler, void *const context)
+{
+	if (sx == NULL || handler == NULL)
+	{
+		return -1;
+	}
+
+	parser prs = parser_create(sx, 0);
+	node root = node_get_root(&sx->tree);
+
+	if (sx->is_parallel)
+	{
+		lex_parallel(&prs.lxr);
+	}
+
+	const size_t amount = node_get_amount(&root);
+	const size_t size = vector_size(&sx->tree);
+
+	int ret = 0;
+	do
+	{
+		// Тело предыдущей функции уже освобождено, поэтому выражения строятся в корне
+		node_copy(&prs.bld.context, &root);
+
+		// Тело функции видит только предшествующие описания, поэтому разбирается сразу
+		parse_external_definition(&prs, &root);
+		parse_function_bodies(&prs);
+		vector_resize(&prs.bodies, 0);
+		prs.tokens_size = 0;
+
+		// Номера лексем в группах сообщений начинаются заново, поэтому сообщения выводятся сразу
+		reporter_flush(&sx->rprt, sx->io);
+
+		for (size_t i = amount; i < node_get_amount(&root) && reporter_get_errors_number(&sx->rprt) == 0 && !ret; i++)
+		{
+			const node nd = node_get_child(&root, i);
+			node_freeze(&nd);
+			ret = handler(context, &nd);
+		}
+
+		// Поддерево описания освобождается, ссылки на функции из него больше не нужны
+		for (size_t i = amount; i < node_get_amount(&root); i++)
+		{
+			const node nd = node_get_child(&root, i);
+			if (node_get_type(&nd) == OP_FUNC_DEF)
+			{
+				const size_t function_id = (size_t)node_get_arg(&nd, 0);
+				func_set(sx, (size_t)ident_get_displ(sx, function_id), 0);
+			}
+		}
+		node_truncate(&root, amount, size);
+	} while (token_is_not(&prs.tk, TK_EOF));
+
+	parser_clear(&prs);
+	return reporter_get_errors_number(&sx->rprt) == 0 && !ret ? 0 : -1;
 }
@@ -26,7 +26,11 @@ extern "C" {
 #endif
 
 /**
- *	Parse source code to generate syntax tree
+ *	Parse source code to generate syntax tree.
+ *	External declarations are parsed first, then function bodies are parsed
+ *	with global declarations, made before each of them.
+ *	With @c --lazy flag only bodies of functions reachable from main are parsed,
+ *	definitions of other functions are removed from the tree.
  *
  *	@param	sx		Syntax structure
  *
@@ -34,6 +38,36 @@ extern "C" {
  */
 int parse(syntax *const sx);
 
+/**
+ *	Parse external declarations, which begin in range of source code, and their bodies.
+ *	Range must start with external declaration, and tables and tree must already hold
+ *	declarations made before it, so precompiled header is continued by the rest of code.
+ *
+ *	@param	sx			Syntax structure
+ *	@param	begin		Position of the first declaration
+ *	@param	end			Position after the last declaration, @c SIZE_MAX for end of code
+ *
+ *	@return	@c 0 on success, @c 1 on failure
+ */
+int parse_range(syntax *const sx, const size_t begin, const size_t end);
+
+/** Handler of parsed external declaration, nonzero result stops code generation */
+typedef int (*declaration_handler)(void *const context, const node *const nd);
+
+/**
+ *	Parse source code by external declarations.
+ *	Each declaration is passed to handler right after parsing of it and its function body,
+ *	then its subtree is released, so tree holds only one declaration at a time.
+ *	Handler is not called after errors.
+ *
+ *	@param	sx			Syntax structure
+ *	@param	handler		Handler of declarations
+ *	@param	context		Context of handler
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int parse_by_declarations(syntax *const sx, const declaration_handler handler, void *const context);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
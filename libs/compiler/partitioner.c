@@ -0,0 +1,471 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "partitioner.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include "map.h"
+#include "uniprinter.h"
+#include "vector.h"
+
+
+static const char *const PARTITIONS_FLAG = "--llvm-partitions=";
+static const char *const DEFINE = "define ";
+static const char *const INTERNAL = "internal ";
+static const char *const INTERNAL_GLOBAL = " = internal global ";
+
+static const size_t ENTITY_SIZE = 5;
+
+
+/** Kinds of top-level entities of module */
+typedef enum ENTITY
+{
+	ENTITY_SHARED,					/**< Entity copied to every module */
+	ENTITY_FUNCTION,				/**< Function definition */
+	ENTITY_GLOBAL,					/**< Internal global variable */
+} entity_t;
+
+/** Top-level entities of module text and their references */
+typedef struct layout
+{
+	const char *const text;			/**< Module text */
+	vector entities;				/**< Kind, begin, end, name begin and name size of each entity */
+	map symbols;					/**< Numbers of entities by names of functions and global variables */
+	vector references;				/**< Numbers of functions and global variables referred by entities */
+	vector starts;					/**< Beginnings of references of each entity, then their end */
+	vector parts;					/**< Module of each entity, @c -1 if not chosen yet */
+} layout;
+
+
+static inline bool is_name_char(const char c)
+{
+	return isalnum((unsigned char)c) || c == '_' || c == '.' || c == '$' || c == '-';
+}
+
+static inline item_t entity_get(const layout *const lt, const size_t entity, const size_t field)
+{
+	return vector_get(&lt->entities, entity * ENTITY_SIZE + field);
+}
+
+static inline entity_t entity_get_kind(const layout *const lt, const size_t entity)
+{
+	return (entity_t)entity_get(lt, entity, 0);
+}
+
+static inline const char *entity_get_text(const layout *const lt, const size_t entity)
+{
+	return &lt->text[entity_get(lt, entity, 1)];
+}
+
+static inline size_t entity_get_size(const layout *const lt, const size_t entity)
+{
+	return (size_t)(entity_get(lt, entity, 2) - entity_get(lt, entity, 1));
+}
+
+static inline const char *entity_get_name(const layout *const lt, const size_t entity)
+{
+	return &lt->text[entity_get(lt, entity, 3)];
+}
+
+static inline size_t entity_get_name_size(const layout *const lt, const size_t entity)
+{
+	return (size_t)entity_get(lt, entity, 4);
+}
+
+static inline size_t entities_amount(const layout *const lt)
+{
+	return vector_size(&lt->entities) / ENTITY_SIZE;
+}
+
+static void entity_add(layout *const lt, const entity_t kind, const size_t begin, const size_t end, const size_t name)
+{
+	size_t name_size = 0;
+	while (kind != ENTITY_SHARED && is_name_char(lt->text[name + name_size]))
+	{
+		name_size++;
+	}
+
+	if (kind != ENTITY_SHARED)
+	{
+		map_add_by_span(&lt->symbols, &lt->text[name], name_size, (item_t)entities_amount(lt));
+	}
+
+	vector_add(&lt->entities, kind);
+	vector_add(&lt->entities, (item_t)begin);
+	vector_add(&lt->entities, (item_t)end);
+	vector_add(&lt->entities, (item_t)name);
+	vector_add(&lt->entities, (item_t)name_size);
+}
+
+/**
+ *	Get size of type in the beginning of text
+ *
+ *	@param	type		Text of type
+ *
+ *	@return	Size of type
+ */
+static size_t type_get_size(const char *const type)
+{
+	size_t i = 0;
+	size_t depth = 0;
+	for (; type[i] != '\0'; i++)
+	{
+		if (strchr("([{<", type[i]) != NULL)
+		{
+			depth++;
+		}
+		else if (depth != 0 && strchr(")]}>", type[i]) != NULL)
+		{
+			if (--depth == 0)
+			{
+				i++;
+				break;
+			}
+		}
+		else if (depth == 0 && (type[i] == ' ' || type[i] == ',' || type[i] == '*'))
+		{
+			break;
+		}
+	}
+
+	// За основой типа могут следовать звёздочки указателей и параметры функции
+	while (true)
+	{
+		if (type[i] == '*')
+		{
+			i++;
+		}
+		else if (type[i] == ' ' && type[i + 1] == '(')
+		{
+			i += 1 + type_get_size(&type[i + 1]);
+		}
+		else
+		{
+			return i;
+		}
+	}
+}
+
+/**
+ *	Split module text into top-level entities and find their references
+ *
+ *	@param	text		Module text
+ *
+ *	@return	Layout of module
+ */
+static layout layout_create(const char *const text)
+{
+	layout lt = { .text = text, .entities = vector_create(0), .symbols = map_create(0)
+		, .references = vector_create(0), .starts = vector_create(0), .parts = vector_create(0) };
+
+	for (size_t i = 0; text[i] != '\0';)
+	{
+		const char *const line = &text[i];
+		const char *const line_end = strchr(line, '\n');
+		size_t end = line_end != NULL ? (size_t)(line_end - text) + 1 : i + strlen(line);
+
+		if (strncmp(line, DEFINE, strlen(DEFINE)) == 0)
+		{
+			// Тело функции заканчивается строкой из одной закрывающей скобки
+			const char *close = strstr(line, "\n}");
+			while (close != NULL && close[2] != '\n' && close[2] != '\0')
+			{
+				close = strstr(&close[2], "\n}");
+			}
+
+			end = close != NULL ? (size_t)(close - text) + 2 + (close[2] == '\n' ? 1 : 0) : i + strlen(line);
+			entity_add(&lt, ENTITY_FUNCTION, i, end, (size_t)(strchr(line, '@') - text) + 1);
+		}
+		else if (line[0] == '@')
+		{
+			size_t name_size = 1;
+			while (is_name_char(line[name_size]))
+			{
+				name_size++;
+			}
+
+			const bool is_global = strncmp(&line[name_size], INTERNAL_GLOBAL, strlen(INTERNAL_GLOBAL)) == 0;
+			entity_add(&lt, is_global ? ENTITY_GLOBAL : ENTITY_SHARED, i, end, i + 1);
+		}
+		else
+		{
+			entity_add(&lt, ENTITY_SHARED, i, end, i);
+		}
+
+		i = end;
+	}
+
+	const size_t amount = entities_amount(&lt);
+	for (size_t i = 0; i < amount; i++)
+	{
+		vector_add(&lt.starts, (item_t)vector_size(&lt.references));
+		vector_add(&lt.parts, -1);
+
+		const char *const entity = entity_get_text(&lt, i);
+		const size_t size = entity_get_size(&lt, i);
+		for (size_t j = 0; j < size; j++)
+		{
+			if (entity[j] != '@')
+			{
+				continue;
+			}
+
+			size_t name_size = 0;
+			while (j + 1 + name_size < size && is_name_char(entity[j + 1 + name_size]))
+			{
+				name_size++;
+			}
+
+			const item_t reference = map_get_by_span(&lt.symbols, &entity[j + 1], name_size);
+			if (reference != ITEM_MAX && (size_t)reference != i)
+			{
+				vector_add(&lt.references, reference);
+			}
+			j += name_size;
+		}
+	}
+	vector_add(&lt.starts, (item_t)vector_size(&lt.references));
+
+	return lt;
+}
+
+static void layout_clear(layout *const lt)
+{
+	vector_clear(&lt->entities);
+	map_clear(&lt->symbols);
+	vector_clear(&lt->references);
+	vector_clear(&lt->starts);
+	vector_clear(&lt->parts);
+}
+
+/**
+ *	Choose modules of functions and global variables
+ *
+ *	@param	lt			Layout of module
+ *	@param	amount		Number of modules
+ */
+static void layout_partition(layout *const lt, const size_t amount)
+{
+	const size_t entities = entities_amount(lt);
+	vector order = vector_create(entities);
+	vector is_visited = vector_create(entities);
+	vector stack = vector_create(0);
+	vector_increase(&is_visited, entities);
+
+	// Вызываемые функции следуют за вызывающими, поэтому попадают в тот же модуль
+	size_t total = 0;
+	for (size_t i = 0; i < entities; i++)
+	{
+		if (entity_get_kind(lt, i) != ENTITY_FUNCTION)
+		{
+			continue;
+		}
+
+		total += entity_get_size(lt, i);
+		vector_add(&stack, (item_t)i);
+		while (vector_size(&stack) != 0)
+		{
+			const size_t entity = (size_t)vector_remove(&stack);
+			if (vector_get(&is_visited, entity))
+			{
+				continue;
+			}
+
+			vector_set(&is_visited, entity, true);
+			vector_add(&order, (item_t)entity);
+
+			const size_t begin = (size_t)vector_get(&lt->starts, entity);
+			for (size_t j = (size_t)vector_get(&lt->starts, entity + 1); j > begin; j--)
+			{
+				const size_t callee = (size_t)vector_get(&lt->references, j - 1);
+				if (entity_get_kind(lt, callee) == ENTITY_FUNCTION && !vector_get(&is_visited, callee))
+				{
+					vector_add(&stack, (item_t)callee);
+				}
+			}
+		}
+	}
+
+	size_t offset = 0;
+	for (size_t i = 0; i < vector_size(&order); i++)
+	{
+		const size_t entity = (size_t)vector_get(&order, i);
+		vector_set(&lt->parts, entity, (item_t)(offset * amount / total));
+		offset += entity_get_size(lt, entity);
+	}
+
+	// Глобальная переменная определяется в модуле своего первого пользователя
+	for (size_t i = 0; i < vector_size(&order); i++)
+	{
+		const size_t entity = (size_t)vector_get(&order, i);
+		const size_t end = (size_t)vector_get(&lt->starts, entity + 1);
+		for (size_t j = (size_t)vector_get(&lt->starts, entity); j < end; j++)
+		{
+			const size_t reference = (size_t)vector_get(&lt->references, j);
+			if (entity_get_kind(lt, reference) == ENTITY_GLOBAL && vector_get(&lt->parts, reference) == -1)
+			{
+				vector_set(&lt->parts, reference, vector_get(&lt->parts, entity));
+			}
+		}
+	}
+
+	for (size_t i = 0; i < entities; i++)
+	{
+		if (vector_get(&lt->parts, i) == -1)
+		{
+			vector_set(&lt->parts, i, 0);
+		}
+	}
+
+	vector_clear(&order);
+	vector_clear(&is_visited);
+	vector_clear(&stack);
+}
+
+/** Write definition, internal one becomes hidden to be reachable from other modules */
+static void definition_to_io(const layout *const lt, universal_io *const io, const size_t entity)
+{
+	const char *const text = entity_get_text(lt, entity);
+	const size_t size = entity_get_size(lt, entity);
+
+	if (entity_get_kind(lt, entity) == ENTITY_GLOBAL)
+	{
+		const size_t name_size = 1 + entity_get_name_size(lt, entity);
+		const size_t prefix = name_size + strlen(INTERNAL_GLOBAL);
+		out_write(io, text, name_size);
+		uni_printf(io, " = hidden global ");
+		out_write(io, &text[prefix], size - prefix);
+		return;
+	}
+
+	const size_t prefix = strlen(DEFINE) + strlen(INTERNAL);
+	if (strncmp(&text[strlen(DEFINE)], INTERNAL, strlen(INTERNAL)) == 0)
+	{
+		uni_printf(io, "%shidden ", DEFINE);
+		out_write(io, &text[prefix], size - prefix);
+	}
+	else
+	{
+		out_write(io, text, size);
+	}
+}
+
+/** Write external declaration of definition from other module */
+static void declaration_to_io(const layout *const lt, universal_io *const io, const size_t entity)
+{
+	const char *const text = entity_get_text(lt, entity);
+	const char *const name = entity_get_name(lt, entity);
+	const size_t name_size = entity_get_name_size(lt, entity);
+
+	if (entity_get_kind(lt, entity) == ENTITY_GLOBAL)
+	{
+		const char *const type = &name[name_size + strlen(INTERNAL_GLOBAL)];
+		uni_printf(io, "@");
+		out_write(io, name, name_size);
+		uni_printf(io, " = external hidden global ");
+		out_write(io, type, type_get_size(type));
+		uni_printf(io, "\n");
+		return;
+	}
+
+	// Заголовок определения: define, связывание, тип результата, имя и параметры
+	const char *const linkage = &text[strlen(DEFINE)];
+	const char *const result = strchr(linkage, ' ') + 1;
+	const char *const parameters = &name[name_size];
+	uni_printf(io, "declare %s", strncmp(linkage, INTERNAL, strlen(INTERNAL)) == 0 ? "hidden " : "");
+	out_write(io, result, (size_t)(name - result));
+	out_write(io, name, name_size);
+	out_write(io, parameters, type_get_size(parameters));
+	uni_printf(io, "\n");
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+size_t partition_get_amount(const workspace *const ws)
+{
+	const char *const value = ws_get_flag_value(ws, PARTITIONS_FLAG);
+	if (value == NULL)
+	{
+		return 0;
+	}
+
+	char *end = NULL;
+	const unsigned long amount = strtoul(value, &end, 10);
+	return end != value && *end == '\0' ? (size_t)amount : 0;
+}
+
+int partition_module(const char *const text, universal_io *const modules, const size_t amount)
+{
+	if (text == NULL || modules == NULL || amount == 0)
+	{
+		return -1;
+	}
+
+	layout lt = layout_create(text);
+	layout_partition(&lt, amount);
+
+	const size_t entities = entities_amount(&lt);
+	vector is_needed = vector_create(entities);
+	vector_increase(&is_needed, entities);
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		// Отметка – номер модуля плюс один, поэтому её не нужно сбрасывать
+		const item_t mark = (item_t)i + 1;
+		for (size_t j = 0; j < entities; j++)
+		{
+			if (entity_get_kind(&lt, j) != ENTITY_SHARED && vector_get(&lt.parts, j) != (item_t)i)
+			{
+				continue;
+			}
+
+			const size_t end = (size_t)vector_get(&lt.starts, j + 1);
+			for (size_t k = (size_t)vector_get(&lt.starts, j); k < end; k++)
+			{
+				vector_set(&is_needed, (size_t)vector_get(&lt.references, k), mark);
+			}
+		}
+
+		for (size_t j = 0; j < entities; j++)
+		{
+			if (entity_get_kind(&lt, j) == ENTITY_SHARED)
+			{
+				out_write(&modules[i], entity_get_text(&lt, j), entity_get_size(&lt, j));
+			}
+			else if (vector_get(&lt.parts, j) == (item_t)i)
+			{
+				definition_to_io(&lt, &modules[i], j);
+			}
+			else if (vector_get(&is_needed, j) == mark)
+			{
+				declaration_to_io(&lt, &modules[i], j);
+			}
+		}
+	}
+
+	vector_clear(&is_needed);
+	layout_clear(&lt);
+	return 0;
+}
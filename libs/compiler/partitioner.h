@@ -0,0 +1,55 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "uniio.h"
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Get number of LLVM modules from flag @c --llvm-partitions=N
+ *
+ *	@param	ws			Compiler workspace
+ *
+ *	@return	Number of modules, @c 0 if output is one module without manifest
+ */
+size_t partition_get_amount(const workspace *const ws);
+
+/**
+ *	Split LLVM module generated by compiler into modules, which are optimized and compiled in parallel.
+ *
+ *	Functions are ordered by depth-first traversal of call graph, so callees follow their callers,
+ *	and this order is cut into parts of close size. Global variables are defined in the module
+ *	of their first user. Internal definitions become hidden, modules refer to definitions
+ *	of other modules by external declarations. Types, constants, declarations and metadata
+ *	are copied to every module.
+ *
+ *	@param	text		Module text
+ *	@param	modules		Outputs of modules
+ *	@param	amount		Number of modules
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int partition_module(const char *const text, universal_io *const modules, const size_t amount);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
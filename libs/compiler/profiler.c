@@ -0,0 +1,239 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "arena.h"
+#include "counters.h"
+#include "logger.h"
+
+#ifndef _WIN32
+	#include <sys/resource.h>
+	#include <sys/time.h>
+#endif
+
+
+#define MAX_REPORT_SIZE MAX_ARG_SIZE * 6 + 1024
+
+
+static const char *const TAG_REPORT = "time-report";
+
+static const char *const PHASE_NAMES[PHASE_AMOUNT] = { "macro", "parse", "link", "codegen" };
+
+
+static double get_wall_time(void)
+{
+	struct timespec time;
+#ifndef _WIN32
+	clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+	timespec_get(&time, TIME_UTC);
+#endif
+	return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
+
+static double get_cpu_time(void)
+{
+#ifndef _WIN32
+	// Время потока не включает задания, которые параллельно выполняют другие потоки
+	struct timespec time;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/** Get peak resident set size of process in kilobytes, @c 0 if unknown */
+static size_t get_peak_memory(void)
+{
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+	{
+		return 0;
+	}
+
+	#ifdef __APPLE__
+		return (size_t)usage.ru_maxrss / 1024;
+	#else
+		return (size_t)usage.ru_maxrss;
+	#endif
+#else
+	return 0;
+#endif
+}
+
+/** Write string as JSON literal, return its size */
+static size_t print_json_string(char *const buffer, const char *const str)
+{
+	size_t size = 0;
+	buffer[size++] = '"';
+	for (size_t i = 0; str[i] != '\0'; i++)
+	{
+		const unsigned char ch = (unsigned char)str[i];
+		if (ch == '"' || ch == '\\')
+		{
+			buffer[size++] = '\\';
+			buffer[size++] = (char)ch;
+		}
+		else if (ch < ' ')
+		{
+			size += (size_t)sprintf(&buffer[size], "\\u%04x", ch);
+		}
+		else
+		{
+			buffer[size++] = (char)ch;
+		}
+	}
+
+	buffer[size++] = '"';
+	buffer[size] = '\0';
+	return size;
+}
+
+static void report_json(const profiler *const prof, const workspace *const ws)
+{
+	char buffer[MAX_REPORT_SIZE];
+	size_t size = (size_t)sprintf(buffer, "{\"output\": ");
+	size += print_json_string(&buffer[size], ws_get_output(ws) != NULL ? ws_get_output(ws) : "");
+
+	size += (size_t)sprintf(&buffer[size], ", \"phases\": {");
+	for (size_t i = 0; i < PHASE_AMOUNT; i++)
+	{
+		size += (size_t)sprintf(&buffer[size], "%s\"%s\": {\"wall\": %.6f, \"cpu\": %.6f}"
+			, i == 0 ? "" : ", ", PHASE_NAMES[i], prof->wall[i], prof->cpu[i]);
+	}
+
+	size += (size_t)sprintf(&buffer[size], "}, \"peak_rss_kb\": %zu, \"allocs\": %zu, \"arena_bytes\": %zu"
+		, get_peak_memory(), prof->allocs, prof->memory);
+	sprintf(&buffer[size], ", \"tables\": {\"tree\": %zu, \"identifiers\": %zu, \"types\": %zu"
+		", \"representations\": %zu, \"functions\": %zu, \"strings\": %zu}}"
+		, prof->tree, prof->identifiers, prof->types, prof->representations, prof->functions, prof->strings);
+
+	log_report(TAG_REPORT, buffer);
+}
+
+static void report_text(const profiler *const prof)
+{
+	char buffer[MAX_REPORT_SIZE];
+	double wall = 0;
+	double cpu = 0;
+
+	for (size_t i = 0; i < PHASE_AMOUNT; i++)
+	{
+		sprintf(buffer, "%-8s wall %10.6f s, cpu %10.6f s", PHASE_NAMES[i], prof->wall[i], prof->cpu[i]);
+		log_report(TAG_REPORT, buffer);
+
+		wall += prof->wall[i];
+		cpu += prof->cpu[i];
+	}
+
+	sprintf(buffer, "%-8s wall %10.6f s, cpu %10.6f s", "total", wall, cpu);
+	log_report(TAG_REPORT, buffer);
+
+	sprintf(buffer, "peak RSS %zu KB, arena %zu allocations, %zu bytes", get_peak_memory(), prof->allocs, prof->memory);
+	log_report(TAG_REPORT, buffer);
+
+	sprintf(buffer, "tree %zu, identifiers %zu, types %zu, representations %zu, functions %zu, strings %zu"
+		, prof->tree, prof->identifiers, prof->types, prof->representations, prof->functions, prof->strings);
+	log_report(TAG_REPORT, buffer);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+profiler prof_create(const workspace *const ws)
+{
+	profiler prof;
+	memset(&prof, 0, sizeof(profiler));
+
+	prof.is_json = ws_has_option(ws, OPT_TIME_REPORT_JSON);
+	prof.is_enabled = prof.is_json || ws_has_option(ws, OPT_TIME_REPORT);
+	prof.is_counters = ws_has_option(ws, OPT_COUNTERS);
+	return prof;
+}
+
+void prof_begin(profiler *const prof)
+{
+	if (!prof->is_enabled)
+	{
+		return;
+	}
+
+	prof->wall_start = get_wall_time();
+	prof->cpu_start = get_cpu_time();
+}
+
+void prof_end(profiler *const prof, const phase_t phase)
+{
+	if (!prof->is_enabled)
+	{
+		return;
+	}
+
+	prof->wall[phase] += get_wall_time() - prof->wall_start;
+	prof->cpu[phase] += get_cpu_time() - prof->cpu_start;
+}
+
+void prof_tables(profiler *const prof, const syntax *const sx)
+{
+	if (!prof->is_enabled)
+	{
+		return;
+	}
+
+	prof->allocs = arena_get_allocs(sx->memory);
+	prof->memory = arena_get_reserved(sx->memory);
+
+	prof->tree = vector_size(&sx->tree);
+	prof->identifiers = vector_size(&sx->identifiers);
+	prof->types = vector_size(&sx->types);
+	prof->representations = sx->representations.values_size;
+	prof->functions = vector_size(&sx->functions);
+	prof->strings = strings_size(&sx->string_literals);
+}
+
+void prof_report(const profiler *const prof, const workspace *const ws)
+{
+	if (prof->is_counters)
+	{
+		counters_report();
+	}
+
+	if (!prof->is_enabled)
+	{
+		return;
+	}
+
+	if (prof->is_json)
+	{
+		report_json(prof, ws);
+	}
+	else
+	{
+		report_text(prof);
+	}
+}
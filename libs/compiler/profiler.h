@@ -0,0 +1,108 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "syntax.h"
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Compilation phases */
+typedef enum PHASE
+{
+	PHASE_MACRO,				/**< Preprocessing */
+	PHASE_PARSE,				/**< Parsing or loading of tables snapshot */
+	PHASE_LINK,					/**< Check of syntax tables */
+	PHASE_CODEGEN,				/**< Code generation */
+
+	PHASE_AMOUNT,
+} phase_t;
+
+/** Statistics of compilation */
+typedef struct profiler
+{
+	bool is_enabled;			/**< Set, if report is requested */
+	bool is_json;				/**< Set, if report is printed as JSON */
+	bool is_counters;			/**< Set, if hot path counters are printed */
+
+	double wall[PHASE_AMOUNT];	/**< Wall time of phases in seconds */
+	double cpu[PHASE_AMOUNT];	/**< CPU time of phases in seconds */
+	double wall_start;			/**< Wall time on start of current phase */
+	double cpu_start;			/**< CPU time on start of current phase */
+
+	size_t allocs;				/**< Number of allocations from tables arena */
+	size_t memory;				/**< Size of tables arena */
+
+	size_t tree;				/**< Size of tree table */
+	size_t identifiers;			/**< Size of identifiers table */
+	size_t types;				/**< Size of types table */
+	size_t representations;		/**< Number of representations */
+	size_t functions;			/**< Size of functions table */
+	size_t strings;				/**< Number of string literals */
+} profiler;
+
+
+/**
+ *	Create profiler.
+ *	Flag @c -ftime-report enables text report, @c -ftime-report=json enables JSON one.
+ *	Flag @c --counters adds values of hot path counters to report.
+ *
+ *	@param	ws		Compiler workspace
+ *
+ *	@return	Profiler
+ */
+profiler prof_create(const workspace *const ws);
+
+/**
+ *	Start measuring of phase
+ *
+ *	@param	prof	Profiler
+ */
+void prof_begin(profiler *const prof);
+
+/**
+ *	Finish measuring of phase, its time is added to previous runs of the same phase
+ *
+ *	@param	prof	Profiler
+ *	@param	phase	Phase
+ */
+void prof_end(profiler *const prof, const phase_t phase);
+
+/**
+ *	Remember sizes of syntax tables, should be called before their clearing
+ *
+ *	@param	prof	Profiler
+ *	@param	sx		Syntax structure
+ */
+void prof_tables(profiler *const prof, const syntax *const sx);
+
+/**
+ *	Print report through report logger
+ *
+ *	@param	prof	Profiler
+ *	@param	ws		Compiler workspace
+ */
+void prof_report(const profiler *const prof, const workspace *const ws);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,1662 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "regvmgen.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include "AST.h"
+#include "counters.h"
+#include "errors.h"
+#include "uniprinter.h"
+
+
+#define RVM_FIELDS		6
+#define RVM_REGISTERS	16
+#define RVM_SCRATCH		2
+
+
+static const item_t RVM_NONE = -1;
+static const size_t RVM_ALLOCATABLE = RVM_REGISTERS - RVM_SCRATCH;	// Последние регистры - для подкачки из кадра
+
+
+/** Register virtual machine instructions */
+typedef enum RVM_INSTRUCTION
+{
+	RI_LI,								/**< Загрузка целой константы */
+	RI_LID,								/**< Загрузка вещественной константы */
+	RI_MOV,								/**< Копирование регистра */
+	RI_PARAM,							/**< Получение параметра функции */
+	RI_LOAD,							/**< Загрузка глобальной переменной */
+	RI_STORE,							/**< Запись глобальной переменной */
+	RI_CONVERT,							/**< Преобразование целого в вещественное */
+	RI_UNARY,							/**< Унарная операция */
+	RI_BINARY,							/**< Бинарная операция */
+	RI_LABEL,							/**< Метка */
+	RI_JUMP,							/**< Безусловный переход */
+	RI_BZ,								/**< Переход, если регистр равен нулю */
+	RI_BNZ,								/**< Переход, если регистр не равен нулю */
+	RI_ARG,								/**< Передача аргумента вызова */
+	RI_CALL,							/**< Вызов функции */
+	RI_RET,								/**< Возврат значения */
+	RI_RETV,							/**< Возврат без значения */
+} rvm_instruction_t;
+
+/** Fields of instruction */
+typedef enum RVM_FIELD
+{
+	RF_OPERATION,						/**< Код инструкции */
+	RF_DESTINATION,						/**< Регистр результата */
+	RF_FIRST,							/**< Первый регистр операнда */
+	RF_SECOND,							/**< Второй регистр операнда */
+	RF_ARGUMENT,						/**< Константа, метка, идентификатор или операция */
+	RF_FLOATING,						/**< Флаг вещественной операции */
+} rvm_field_t;
+
+typedef struct generator
+{
+	syntax *sx;							/**< Структура syntax с таблицами */
+
+	vector code;						/**< Код текущей функции, по RVM_FIELDS элементов на инструкцию */
+	vector kinds;						/**< Флаги переменных для виртуальных регистров функции */
+	vector registers;					/**< Виртуальные регистры локальных переменных по идентификаторам */
+	vector constants;					/**< Вещественные константы */
+	vector cases;						/**< Пары из индекса выражения case и его метки */
+	vector arguments;					/**< Регистры вычисленных аргументов вызовов */
+
+	size_t label_num;					/**< Номер метки */
+	size_t label_break;					/**< Метка перехода для break */
+	size_t label_continue;				/**< Метка перехода для continue */
+	size_t label_default;				/**< Метка перехода для default */
+
+	bool was_error;						/**< Истина, если встретилась неподдерживаемая конструкция */
+} generator;
+
+/** Live interval of virtual register */
+typedef struct interval
+{
+	size_t start;						/**< Первая инструкция с регистром */
+	size_t end;							/**< Последняя инструкция с регистром */
+	size_t reg;							/**< Виртуальный регистр */
+} interval;
+
+
+static void emit_statement(generator *const gen, const node *const nd);
+static item_t emit_expression(generator *const gen, const node *const nd);
+
+
+/**
+ *	Emit an error from register virtual machine generator
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	num			Error code
+ */
+static void generator_error(generator *const gen, const node *const nd, err_t num, ...)
+{
+	va_list args;
+	va_start(args, num);
+
+	report_error(&gen->sx->rprt, gen->sx->io, node_get_location(nd), num, args);
+	gen->was_error = true;
+
+	va_end(args);
+}
+
+static inline void unsupported(generator *const gen, const node *const nd)
+{
+	generator_error(gen, nd, construction_not_supported);
+}
+
+static inline bool type_is_supported(const syntax *const sx, const item_t type)
+{
+	return type_is_arithmetic(sx, type) || type_is_boolean(type);
+}
+
+static inline size_t label_create(generator *const gen)
+{
+	return gen->label_num++;
+}
+
+static inline item_t register_create(generator *const gen, const bool is_variable)
+{
+	return (item_t)vector_add(&gen->kinds, is_variable ? 1 : 0);
+}
+
+static inline bool register_is_variable(const generator *const gen, const item_t reg)
+{
+	return reg != RVM_NONE && vector_get(&gen->kinds, (size_t)reg) != 0;
+}
+
+static inline item_t register_get(const generator *const gen, const size_t id)
+{
+	return vector_get(&gen->registers, id) - 1;
+}
+
+static inline void register_set(generator *const gen, const size_t id, const item_t reg)
+{
+	vector_set(&gen->registers, id, reg + 1);
+}
+
+
+static inline size_t code_amount(const generator *const gen)
+{
+	return vector_size(&gen->code) / RVM_FIELDS;
+}
+
+static inline item_t code_get(const generator *const gen, const size_t index, const rvm_field_t field)
+{
+	return vector_get(&gen->code, index * RVM_FIELDS + field);
+}
+
+static inline void code_set(generator *const gen, const size_t index, const rvm_field_t field, const item_t value)
+{
+	vector_set(&gen->code, index * RVM_FIELDS + field, value);
+}
+
+static void code_add(generator *const gen, const rvm_instruction_t operation, const item_t dst
+	, const item_t fst, const item_t snd, const item_t argument, const bool is_floating)
+{
+	vector_add(&gen->code, operation);
+	vector_add(&gen->code, dst);
+	vector_add(&gen->code, fst);
+	vector_add(&gen->code, snd);
+	vector_add(&gen->code, argument);
+	vector_add(&gen->code, is_floating ? 1 : 0);
+}
+
+static inline void code_label(generator *const gen, const size_t label)
+{
+	code_add(gen, RI_LABEL, RVM_NONE, RVM_NONE, RVM_NONE, (item_t)label, false);
+}
+
+static inline void code_jump(generator *const gen, const rvm_instruction_t operation, const item_t reg, const size_t label)
+{
+	code_add(gen, operation, RVM_NONE, reg, RVM_NONE, (item_t)label, false);
+}
+
+static void code_move(generator *const gen, const item_t dst, const item_t src)
+{
+	if (dst == src)
+	{
+		return;
+	}
+
+	const size_t last = code_amount(gen) - 1;
+	if (!register_is_variable(gen, src) && code_amount(gen) != 0 && code_get(gen, last, RF_OPERATION) != RI_LABEL
+		&& code_get(gen, last, RF_DESTINATION) == src)
+	{
+		// Временный регистр определяется только последней инструкцией, её результат пишется сразу в переменную
+		code_set(gen, last, RF_DESTINATION, dst);
+	}
+	else
+	{
+		code_add(gen, RI_MOV, dst, src, RVM_NONE, 0, false);
+	}
+}
+
+
+static binary_t assignment_to_binary(const binary_t operation)
+{
+	switch (operation)
+	{
+		case BIN_MUL_ASSIGN:
+			return BIN_MUL;
+		case BIN_DIV_ASSIGN:
+			return BIN_DIV;
+		case BIN_REM_ASSIGN:
+			return BIN_REM;
+		case BIN_ADD_ASSIGN:
+			return BIN_ADD;
+		case BIN_SUB_ASSIGN:
+			return BIN_SUB;
+		case BIN_SHL_ASSIGN:
+			return BIN_SHL;
+		case BIN_SHR_ASSIGN:
+			return BIN_SHR;
+		case BIN_AND_ASSIGN:
+			return BIN_AND;
+		case BIN_XOR_ASSIGN:
+			return BIN_XOR;
+		default:
+			return BIN_OR;
+	}
+}
+
+static bool expression_has_side_effects(const node *const nd)
+{
+	switch (expression_get_class(nd))
+	{
+		case EXPR_CALL:
+		case EXPR_ASSIGNMENT:
+			return true;
+
+		case EXPR_UNARY:
+		{
+			const unary_t operation = expression_unary_get_operator(nd);
+			if (operation == UN_POSTINC || operation == UN_POSTDEC || operation == UN_PREINC || operation == UN_PREDEC)
+			{
+				return true;
+			}
+		}
+		break;
+
+		default:
+			break;
+	}
+
+	const size_t amount = node_get_amount(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node child = node_get_child(nd, i);
+		if (expression_has_side_effects(&child))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/*
+ *	 ______     __  __     ______   ______     ______     ______     ______     __     ______     __   __     ______
+ *	/\  ___\   /\_\_\_\   /\  == \ /\  == \   /\  ___\   /\  ___\   /\  ___\   /\ \   /\  __ \   /\ "-.\ \   /\  ___\
+ *	\ \  __\   \/_/\_\/_  \ \  _-/ \ \  __<   \ \  __\   \ \___  \  \ \___  \  \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
+ *	 \ \_____\   /\_\/\_\  \ \_\    \ \_\ \_\  \ \_____\  \/\_____\  \/\_____\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
+ *	  \/_____/   \/_/\/_/   \/_/     \/_/ /_/   \/_____/   \/_____/   \/_____/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+ */
+
+
+/**
+ *	Emit operand, which must keep its value until siblings are calculated
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *	@param	is_clobbered	Set, if siblings can change variables
+ *
+ *	@return	Register with value
+ */
+static item_t emit_operand(generator *const gen, const node *const nd, const bool is_clobbered)
+{
+	const item_t reg = emit_expression(gen, nd);
+	if (!is_clobbered || !register_is_variable(gen, reg))
+	{
+		return reg;
+	}
+
+	const item_t copy = register_create(gen, false);
+	code_add(gen, RI_MOV, copy, reg, RVM_NONE, 0, false);
+	return copy;
+}
+
+/**
+ *	Emit identifier expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_identifier_expression(generator *const gen, const node *const nd)
+{
+	const size_t id = expression_identifier_get_id(nd);
+	const item_t reg = register_get(gen, id);
+	if (reg != RVM_NONE)
+	{
+		// Локальная переменная уже находится в регистре
+		return reg;
+	}
+
+	if (!type_is_supported(gen->sx, ident_get_type(gen->sx, id)))
+	{
+		unsupported(gen, nd);
+		return RVM_NONE;
+	}
+
+	const item_t result = register_create(gen, false);
+	code_add(gen, RI_LOAD, result, RVM_NONE, RVM_NONE, (item_t)id, false);
+	return result;
+}
+
+/**
+ *	Emit literal expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_literal_expression(generator *const gen, const node *const nd)
+{
+	const item_t type = expression_get_type(nd);
+	const item_t result = register_create(gen, false);
+
+	if (type_is_floating(type))
+	{
+		const size_t index = vector_add_double(&gen->constants, expression_literal_get_floating(nd));
+		code_add(gen, RI_LID, result, RVM_NONE, RVM_NONE, (item_t)index, true);
+	}
+	else if (type_is_boolean(type))
+	{
+		code_add(gen, RI_LI, result, RVM_NONE, RVM_NONE, expression_literal_get_boolean(nd) ? 1 : 0, false);
+	}
+	else if (type == TYPE_CHARACTER)
+	{
+		code_add(gen, RI_LI, result, RVM_NONE, RVM_NONE, (item_t)expression_literal_get_character(nd), false);
+	}
+	else if (type_is_integer(gen->sx, type))
+	{
+		code_add(gen, RI_LI, result, RVM_NONE, RVM_NONE, (item_t)expression_literal_get_integer(nd), false);
+	}
+	else
+	{
+		unsupported(gen, nd);
+		return RVM_NONE;
+	}
+
+	return result;
+}
+
+/**
+ *	Emit call expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value, @c RVM_NONE for void function
+ */
+static item_t emit_call_expression(generator *const gen, const node *const nd)
+{
+	const node callee = expression_call_get_callee(nd);
+	if (expression_get_class(&callee) != EXPR_IDENTIFIER)
+	{
+		unsupported(gen, &callee);
+		return RVM_NONE;
+	}
+
+	const size_t func = expression_identifier_get_id(&callee);
+	const size_t amount = expression_call_get_arguments_amount(nd);
+	const size_t begin = vector_size(&gen->arguments);
+
+	// Все аргументы вычисляются до передачи, так как вложенные вызовы тоже передают аргументы
+	for (size_t i = 0; i < amount; i++)
+	{
+		const node argument = expression_call_get_argument(nd, i);
+		if (!type_is_supported(gen->sx, expression_get_type(&argument)))
+		{
+			unsupported(gen, &argument);
+			vector_resize(&gen->arguments, begin);
+			return RVM_NONE;
+		}
+
+		bool is_clobbered = false;
+		for (size_t j = i + 1; j < amount && !is_clobbered; j++)
+		{
+			const node next = expression_call_get_argument(nd, j);
+			is_clobbered = expression_has_side_effects(&next);
+		}
+
+		vector_add(&gen->arguments, emit_operand(gen, &argument, is_clobbered));
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		code_add(gen, RI_ARG, RVM_NONE, vector_get(&gen->arguments, begin + i), RVM_NONE, 0, false);
+	}
+	vector_resize(&gen->arguments, begin);
+
+	const item_t type = expression_get_type(nd);
+	const item_t result = type_is_void(type) ? RVM_NONE : register_create(gen, false);
+	code_add(gen, RI_CALL, result, RVM_NONE, RVM_NONE, (item_t)func, type_is_floating(type));
+	return result;
+}
+
+/**
+ *	Emit cast expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_cast_expression(generator *const gen, const node *const nd)
+{
+	const node operand = expression_cast_get_operand(nd);
+	const item_t reg = emit_expression(gen, &operand);
+
+	if (!type_is_floating(expression_get_type(nd)) || type_is_floating(expression_cast_get_source_type(nd)))
+	{
+		// Целые, символьные и логические значения представляются одинаково
+		return reg;
+	}
+
+	const item_t result = register_create(gen, false);
+	code_add(gen, RI_CONVERT, result, reg, RVM_NONE, 0, true);
+	return result;
+}
+
+/**
+ *	Emit increment or decrement expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_inc_dec_expression(generator *const gen, const node *const nd)
+{
+	const unary_t operation = expression_unary_get_operator(nd);
+	const node operand = expression_unary_get_operand(nd);
+	if (expression_get_class(&operand) != EXPR_IDENTIFIER)
+	{
+		unsupported(gen, &operand);
+		return RVM_NONE;
+	}
+
+	const bool is_floating = type_is_floating(expression_get_type(nd));
+	const size_t id = expression_identifier_get_id(&operand);
+	const item_t variable = emit_identifier_expression(gen, &operand);
+	if (variable == RVM_NONE)
+	{
+		return RVM_NONE;
+	}
+
+	const item_t one = register_create(gen, false);
+	if (is_floating)
+	{
+		code_add(gen, RI_LID, one, RVM_NONE, RVM_NONE, (item_t)vector_add_double(&gen->constants, 1.0), true);
+	}
+	else
+	{
+		code_add(gen, RI_LI, one, RVM_NONE, RVM_NONE, 1, false);
+	}
+
+	const bool is_postfix = operation == UN_POSTINC || operation == UN_POSTDEC;
+	const binary_t arithmetic = operation == UN_POSTINC || operation == UN_PREINC ? BIN_ADD : BIN_SUB;
+	item_t result = variable;
+	if (is_postfix)
+	{
+		result = register_create(gen, false);
+		code_add(gen, RI_MOV, result, variable, RVM_NONE, 0, false);
+	}
+
+	const item_t value = register_is_variable(gen, variable) ? variable : register_create(gen, false);
+	code_add(gen, RI_BINARY, value, variable, one, arithmetic, is_floating);
+
+	if (!register_is_variable(gen, variable))
+	{
+		code_add(gen, RI_STORE, RVM_NONE, value, RVM_NONE, (item_t)id, false);
+	}
+
+	return is_postfix ? result : value;
+}
+
+/**
+ *	Emit unary expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_unary_expression(generator *const gen, const node *const nd)
+{
+	const unary_t operation = expression_unary_get_operator(nd);
+	switch (operation)
+	{
+		case UN_POSTINC:
+		case UN_POSTDEC:
+		case UN_PREINC:
+		case UN_PREDEC:
+			return emit_inc_dec_expression(gen, nd);
+
+		case UN_MINUS:
+		case UN_NOT:
+		case UN_LOGNOT:
+		case UN_ABS:
+		{
+			const node operand = expression_unary_get_operand(nd);
+			const item_t reg = emit_expression(gen, &operand);
+			const item_t result = register_create(gen, false);
+			code_add(gen, RI_UNARY, result, reg, RVM_NONE, operation, type_is_floating(expression_get_type(&operand)));
+			return result;
+		}
+
+		default:
+			unsupported(gen, nd);
+			return RVM_NONE;
+	}
+}
+
+/**
+ *	Emit logical expression with short-circuit evaluation
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_logical_expression(generator *const gen, const node *const nd)
+{
+	const bool is_and = expression_binary_get_operator(nd) == BIN_LOG_AND;
+	const rvm_instruction_t skip = is_and ? RI_BZ : RI_BNZ;
+	const size_t label_end = label_create(gen);
+
+	// Результат - 0 или 1, как у логических операций виртуальной машины
+	const item_t result = register_create(gen, false);
+	code_add(gen, RI_LI, result, RVM_NONE, RVM_NONE, is_and ? 0 : 1, false);
+
+	const node LHS = expression_binary_get_LHS(nd);
+	code_jump(gen, skip, emit_expression(gen, &LHS), label_end);
+
+	const node RHS = expression_binary_get_RHS(nd);
+	code_jump(gen, skip, emit_expression(gen, &RHS), label_end);
+
+	code_add(gen, RI_LI, result, RVM_NONE, RVM_NONE, is_and ? 1 : 0, false);
+	code_label(gen, label_end);
+	return result;
+}
+
+/**
+ *	Emit binary expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_binary_expression(generator *const gen, const node *const nd)
+{
+	const binary_t operation = expression_binary_get_operator(nd);
+	const node LHS = expression_binary_get_LHS(nd);
+	const node RHS = expression_binary_get_RHS(nd);
+
+	switch (operation)
+	{
+		case BIN_COMMA:
+			emit_expression(gen, &LHS);
+			return emit_expression(gen, &RHS);
+
+		case BIN_LOG_AND:
+		case BIN_LOG_OR:
+			return emit_logical_expression(gen, nd);
+
+		default:
+		{
+			const item_t fst = emit_operand(gen, &LHS, expression_has_side_effects(&RHS));
+			const item_t snd = emit_expression(gen, &RHS);
+			const item_t result = register_create(gen, false);
+			code_add(gen, RI_BINARY, result, fst, snd, operation, type_is_floating(expression_get_type(&LHS)));
+			return result;
+		}
+	}
+}
+
+/**
+ *	Emit ternary expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_ternary_expression(generator *const gen, const node *const nd)
+{
+	const size_t label_else = label_create(gen);
+	const size_t label_end = label_create(gen);
+	const item_t result = register_create(gen, false);
+
+	const node condition = expression_ternary_get_condition(nd);
+	code_jump(gen, RI_BZ, emit_expression(gen, &condition), label_else);
+
+	const node LHS = expression_ternary_get_LHS(nd);
+	code_add(gen, RI_MOV, result, emit_expression(gen, &LHS), RVM_NONE, 0, false);
+	code_jump(gen, RI_JUMP, RVM_NONE, label_end);
+
+	code_label(gen, label_else);
+	const node RHS = expression_ternary_get_RHS(nd);
+	code_add(gen, RI_MOV, result, emit_expression(gen, &RHS), RVM_NONE, 0, false);
+
+	code_label(gen, label_end);
+	return result;
+}
+
+/**
+ *	Emit assignment expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value
+ */
+static item_t emit_assignment_expression(generator *const gen, const node *const nd)
+{
+	const node LHS = expression_assignment_get_LHS(nd);
+	if (expression_get_class(&LHS) != EXPR_IDENTIFIER || !type_is_supported(gen->sx, expression_get_type(&LHS)))
+	{
+		unsupported(gen, &LHS);
+		return RVM_NONE;
+	}
+
+	const size_t id = expression_identifier_get_id(&LHS);
+	const binary_t operation = expression_assignment_get_operator(nd);
+	const bool is_floating = type_is_floating(expression_get_type(&LHS));
+	const item_t variable = register_get(gen, id);
+
+	const node RHS = expression_assignment_get_RHS(nd);
+	item_t value = emit_expression(gen, &RHS);
+	if (value == RVM_NONE)
+	{
+		return RVM_NONE;
+	}
+
+	if (operation != BIN_ASSIGN)
+	{
+		const item_t current = emit_identifier_expression(gen, &LHS);
+		const item_t result = variable != RVM_NONE ? variable : register_create(gen, false);
+		code_add(gen, RI_BINARY, result, current, value, assignment_to_binary(operation), is_floating);
+		value = result;
+	}
+	else if (variable != RVM_NONE)
+	{
+		code_move(gen, variable, value);
+		value = variable;
+	}
+
+	if (variable == RVM_NONE)
+	{
+		code_add(gen, RI_STORE, RVM_NONE, value, RVM_NONE, (item_t)id, false);
+	}
+
+	return value;
+}
+
+/**
+ *	Emit expression
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	Register with value, @c RVM_NONE for void expression
+ */
+static item_t emit_expression(generator *const gen, const node *const nd)
+{
+	switch (expression_get_class(nd))
+	{
+		case EXPR_IDENTIFIER:
+			return emit_identifier_expression(gen, nd);
+
+		case EXPR_LITERAL:
+			return emit_literal_expression(gen, nd);
+
+		case EXPR_CALL:
+			return emit_call_expression(gen, nd);
+
+		case EXPR_CAST:
+			return emit_cast_expression(gen, nd);
+
+		case EXPR_UNARY:
+			return emit_unary_expression(gen, nd);
+
+		case EXPR_BINARY:
+			return emit_binary_expression(gen, nd);
+
+		case EXPR_TERNARY:
+			return emit_ternary_expression(gen, nd);
+
+		case EXPR_ASSIGNMENT:
+			return emit_assignment_expression(gen, nd);
+
+		default:
+			unsupported(gen, nd);
+			return RVM_NONE;
+	}
+}
+
+
+/*
+ *	 _____     ______     ______     __         ______     ______     ______     ______   __     ______     __   __     ______
+ *	/\  __-.  /\  ___\   /\  ___\   /\ \       /\  __ \   /\  == \   /\  __ \   /\__  _\ /\ \   /\  __ \   /\ "-.\ \   /\  ___\
+ *	\ \ \/\ \ \ \  __\   \ \ \____  \ \ \____  \ \  __ \  \ \  __<   \ \  __ \  \/_/\ \/ \ \ \  \ \ \/\ \  \ \ \-.  \  \ \___  \
+ *	 \ \____-  \ \_____\  \ \_____\  \ \_____\  \ \_\ \_\  \ \_\ \_\  \ \_\ \_\    \ \_\  \ \_\  \ \_____\  \ \_\\"\_\  \/\_____\
+ *	  \/____/   \/_____/   \/_____/   \/_____/   \/_/\/_/   \/_/ /_/   \/_/\/_/     \/_/   \/_/   \/_____/   \/_/ \/_/   \/_____/
+ */
+
+
+/**
+ *	Emit local variable declaration
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_local_declaration(generator *const gen, const node *const nd)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	if (declaration_variable_get_bounds_amount(nd) != 0 || !type_is_supported(gen->sx, ident_get_type(gen->sx, id)))
+	{
+		unsupported(gen, nd);
+		return;
+	}
+
+	const item_t variable = register_create(gen, true);
+	if (declaration_variable_has_initializer(nd))
+	{
+		const node initializer = declaration_variable_get_initializer(nd);
+		code_move(gen, variable, emit_expression(gen, &initializer));
+	}
+
+	// Регистр назначается после инициализатора, который ещё не видит переменную
+	register_set(gen, id, variable);
+}
+
+/**
+ *	Emit global variable declaration
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_global_declaration(generator *const gen, const node *const nd)
+{
+	const size_t id = declaration_variable_get_id(nd);
+	const item_t type = ident_get_type(gen->sx, id);
+	if (declaration_variable_get_bounds_amount(nd) != 0 || !type_is_supported(gen->sx, type))
+	{
+		unsupported(gen, nd);
+		return;
+	}
+
+	if (!declaration_variable_has_initializer(nd))
+	{
+		uni_printf(gen->sx->io, "global %s\n", ident_get_spelling(gen->sx, id));
+		return;
+	}
+
+	node initializer = declaration_variable_get_initializer(nd);
+	if (expression_get_class(&initializer) == EXPR_CAST)
+	{
+		initializer = expression_cast_get_operand(&initializer);
+	}
+
+	if (expression_get_class(&initializer) != EXPR_LITERAL)
+	{
+		unsupported(gen, &initializer);
+		return;
+	}
+
+	const item_t value_type = expression_get_type(&initializer);
+	uni_printf(gen->sx->io, "global %s = ", ident_get_spelling(gen->sx, id));
+	if (type_is_floating(value_type))
+	{
+		uni_printf(gen->sx->io, "%.17g\n", expression_literal_get_floating(&initializer));
+	}
+	else if (type_is_floating(type))
+	{
+		uni_printf(gen->sx->io, "%" PRId64 ".0\n", expression_literal_get_integer(&initializer));
+	}
+	else if (type_is_boolean(value_type))
+	{
+		uni_printf(gen->sx->io, "%i\n", expression_literal_get_boolean(&initializer) ? 1 : 0);
+	}
+	else if (value_type == TYPE_CHARACTER)
+	{
+		uni_printf(gen->sx->io, "%" PRIu32 "\n", (uint32_t)expression_literal_get_character(&initializer));
+	}
+	else
+	{
+		uni_printf(gen->sx->io, "%" PRId64 "\n", expression_literal_get_integer(&initializer));
+	}
+}
+
+
+/*
+ *	 ______     __         __         ______     ______     ______     ______   __     ______     __   __
+ *	/\  __ \   /\ \       /\ \       /\  __ \   /\  ___\   /\  __ \   /\__  _\ /\ \   /\  __ \   /\ "-.\ \
+ *	\ \  __ \  \ \ \____  \ \ \____  \ \ \/\ \  \ \ \____  \ \  __ \  \/_/\ \/ \ \ \  \ \ \/\ \  \ \ \-.  \
+ *	 \ \_\ \_\  \ \_____\  \ \_____\  \ \_____\  \ \_____\  \ \_\ \_\    \ \_\  \ \_\  \ \_____\  \ \_\\"\_\
+ *	  \/_/\/_/   \/_____/   \/_____/   \/_____/   \/_____/   \/_/\/_/     \/_/   \/_/   \/_____/   \/_/ \/_/
+ */
+
+
+static int interval_cmp(const void *const fst, const void *const snd)
+{
+	const interval *const a = fst;
+	const interval *const b = snd;
+	return a->start < b->start ? -1 : a->start > b->start ? 1 : 0;
+}
+
+static inline void interval_use(interval *const intervals, const item_t reg, const size_t index)
+{
+	if (reg == RVM_NONE)
+	{
+		return;
+	}
+
+	interval *const current = &intervals[reg];
+	current->start = index < current->start ? index : current->start;
+	current->end = index > current->end ? index : current->end;
+}
+
+/**
+ *	Calculate live intervals of virtual registers.
+ *	Variables live through the whole loop, if they are used inside it.
+ *
+ *	@param	gen			Generator
+ *	@param	intervals	Intervals by virtual registers
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int intervals_calculate(const generator *const gen, interval *const intervals)
+{
+	const size_t amount = code_amount(gen);
+	const size_t registers = vector_size(&gen->kinds);
+	for (size_t i = 0; i < registers; i++)
+	{
+		intervals[i] = (interval){ .start = SIZE_MAX, .end = 0, .reg = i };
+	}
+
+	size_t *const labels = malloc((gen->label_num + 1) * sizeof(size_t));
+	if (labels == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		if (code_get(gen, i, RF_OPERATION) == RI_LABEL)
+		{
+			labels[code_get(gen, i, RF_ARGUMENT)] = i;
+		}
+
+		interval_use(intervals, code_get(gen, i, RF_DESTINATION), i);
+		interval_use(intervals, code_get(gen, i, RF_FIRST), i);
+		interval_use(intervals, code_get(gen, i, RF_SECOND), i);
+	}
+
+	// Обратный переход продлевает переменные, которые используются между меткой и переходом
+	bool was_changed = true;
+	while (was_changed)
+	{
+		was_changed = false;
+		for (size_t i = 0; i < amount; i++)
+		{
+			const item_t operation = code_get(gen, i, RF_OPERATION);
+			if (operation != RI_JUMP && operation != RI_BZ && operation != RI_BNZ)
+			{
+				continue;
+			}
+
+			const size_t target = labels[code_get(gen, i, RF_ARGUMENT)];
+			if (target > i)
+			{
+				continue;
+			}
+
+			for (size_t j = 0; j < registers; j++)
+			{
+				interval *const current = &intervals[j];
+				if (register_is_variable(gen, (item_t)j) && current->start <= i && current->end >= target
+					&& (current->start > target || current->end < i))
+				{
+					current->start = current->start < target ? current->start : target;
+					current->end = current->end > i ? current->end : i;
+					was_changed = true;
+				}
+			}
+		}
+	}
+
+	free(labels);
+	return 0;
+}
+
+/**
+ *	Allocate machine registers by linear scan.
+ *	Register with the furthest end of interval is spilled into frame slot.
+ *
+ *	@param	gen			Generator
+ *	@param	locations	Machine registers or negative frame slots by virtual registers
+ *	@param	frame		Number of frame slots
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int registers_allocate(const generator *const gen, item_t *const locations, size_t *const frame)
+{
+	const size_t registers = vector_size(&gen->kinds);
+	interval *const intervals = malloc((registers + 1) * sizeof(interval));
+	if (intervals == NULL || intervals_calculate(gen, intervals))
+	{
+		free(intervals);
+		return -1;
+	}
+
+	qsort(intervals, registers, sizeof(interval), &interval_cmp);
+	for (size_t i = 0; i < registers; i++)
+	{
+		locations[i] = 0;
+	}
+
+	size_t active[RVM_REGISTERS];
+	size_t active_amount = 0;
+	bool is_free[RVM_REGISTERS];
+	for (size_t i = 0; i < RVM_ALLOCATABLE; i++)
+	{
+		is_free[i] = true;
+	}
+
+	*frame = 0;
+	for (size_t i = 0; i < registers && intervals[i].start != SIZE_MAX; i++)
+	{
+		const interval *const current = &intervals[i];
+
+		// Освобождение регистров, интервалы которых закончились
+		size_t kept = 0;
+		for (size_t j = 0; j < active_amount; j++)
+		{
+			const interval *const other = &intervals[active[j]];
+			if (other->end < current->start)
+			{
+				is_free[locations[other->reg]] = true;
+			}
+			else
+			{
+				active[kept++] = active[j];
+			}
+		}
+		active_amount = kept;
+
+		if (active_amount < RVM_ALLOCATABLE)
+		{
+			size_t reg = 0;
+			while (!is_free[reg])
+			{
+				reg++;
+			}
+
+			is_free[reg] = false;
+			locations[current->reg] = (item_t)reg;
+			active[active_amount++] = i;
+			continue;
+		}
+
+		size_t furthest = 0;
+		for (size_t j = 1; j < active_amount; j++)
+		{
+			furthest = intervals[active[j]].end > intervals[active[furthest]].end ? j : furthest;
+		}
+
+		const interval *const spilled = &intervals[active[furthest]];
+		if (spilled->end > current->end)
+		{
+			locations[current->reg] = locations[spilled->reg];
+			locations[spilled->reg] = -(item_t)++*frame;
+			active[furthest] = i;
+		}
+		else
+		{
+			locations[current->reg] = -(item_t)++*frame;
+		}
+	}
+
+	free(intervals);
+	return 0;
+}
+
+
+/*
+ *	 ______     __  __     ______   ______   __  __     ______
+ *	/\  __ \   /\ \/\ \   /\__  _\ /\  == \ /\ \/\ \   /\__  _\
+ *	\ \ \/\ \  \ \ \_\ \  \/_/\ \/ \ \  _-/ \ \ \_\ \  \/_/\ \/
+ *	 \ \_____\  \ \_____\    \ \_\  \ \_\    \ \_____\    \ \_\
+ *	  \/_____/   \/_____/     \/_/   \/_/     \/_____/     \/_/
+ */
+
+
+static const char *unary_to_string(const unary_t operation)
+{
+	switch (operation)
+	{
+		case UN_MINUS:
+			return "neg";
+		case UN_NOT:
+			return "not";
+		case UN_LOGNOT:
+			return "lnot";
+		default:
+			return "abs";
+	}
+}
+
+static const char *binary_to_string(const binary_t operation)
+{
+	switch (operation)
+	{
+		case BIN_MUL:
+			return "mul";
+		case BIN_DIV:
+			return "div";
+		case BIN_REM:
+			return "rem";
+		case BIN_ADD:
+			return "add";
+		case BIN_SUB:
+			return "sub";
+		case BIN_SHL:
+			return "shl";
+		case BIN_SHR:
+			return "shr";
+		case BIN_LT:
+			return "lt";
+		case BIN_GT:
+			return "gt";
+		case BIN_LE:
+			return "le";
+		case BIN_GE:
+			return "ge";
+		case BIN_EQ:
+			return "eq";
+		case BIN_NE:
+			return "ne";
+		case BIN_AND:
+			return "and";
+		case BIN_XOR:
+			return "xor";
+		default:
+			return "or";
+	}
+}
+
+/**
+ *	Get machine register of operand, spilled operand is loaded into scratch register
+ *
+ *	@param	gen			Generator
+ *	@param	locations	Locations of virtual registers
+ *	@param	reg			Virtual register
+ *	@param	scratch		Number of scratch register
+ *
+ *	@return	Machine register
+ */
+static size_t operand_to_io(const generator *const gen, const item_t *const locations, const item_t reg, const size_t scratch)
+{
+	const item_t location = locations[reg];
+	if (location >= 0)
+	{
+		return (size_t)location;
+	}
+
+	uni_printf(gen->sx->io, "\tr%zu = ld s%" PRId64 "\n", RVM_ALLOCATABLE + scratch, -location - 1);
+	return RVM_ALLOCATABLE + scratch;
+}
+
+static void instruction_to_io(const generator *const gen, const item_t *const locations, const size_t index)
+{
+	universal_io *const io = gen->sx->io;
+	const rvm_instruction_t operation = (rvm_instruction_t)code_get(gen, index, RF_OPERATION);
+	const item_t dst = code_get(gen, index, RF_DESTINATION);
+	const item_t fst = code_get(gen, index, RF_FIRST);
+	const item_t snd = code_get(gen, index, RF_SECOND);
+	const item_t argument = code_get(gen, index, RF_ARGUMENT);
+	const char *const suffix = code_get(gen, index, RF_FLOATING) ? "f" : "";
+
+	const size_t first = fst != RVM_NONE ? operand_to_io(gen, locations, fst, 0) : 0;
+	const size_t second = snd != RVM_NONE ? operand_to_io(gen, locations, snd, 1) : 0;
+	const size_t result = dst == RVM_NONE || locations[dst] < 0 ? RVM_ALLOCATABLE : (size_t)locations[dst];
+
+	switch (operation)
+	{
+		case RI_LI:
+			uni_printf(io, "\tr%zu = li %" PRId64 "\n", result, (int64_t)argument);
+			break;
+		case RI_LID:
+			uni_printf(io, "\tr%zu = lid %.17g\n", result, vector_get_double(&gen->constants, (size_t)argument));
+			break;
+		case RI_MOV:
+			if (result != first)
+			{
+				// Если оба регистра достались одному машинному регистру, копировать нечего,
+				// но выгруженный результат всё равно сохраняется в кадр
+				uni_printf(io, "\tr%zu = r%zu\n", result, first);
+			}
+			break;
+		case RI_PARAM:
+			uni_printf(io, "\tr%zu = param %" PRId64 "\n", result, (int64_t)argument);
+			break;
+		case RI_LOAD:
+			uni_printf(io, "\tr%zu = ldg %s\n", result, ident_get_spelling(gen->sx, (size_t)argument));
+			break;
+		case RI_STORE:
+			uni_printf(io, "\tstg %s, r%zu\n", ident_get_spelling(gen->sx, (size_t)argument), first);
+			break;
+		case RI_CONVERT:
+			uni_printf(io, "\tr%zu = itof r%zu\n", result, first);
+			break;
+		case RI_UNARY:
+			uni_printf(io, "\tr%zu = %s%s r%zu\n", result, unary_to_string((unary_t)argument), suffix, first);
+			break;
+		case RI_BINARY:
+			uni_printf(io, "\tr%zu = %s%s r%zu, r%zu\n", result, binary_to_string((binary_t)argument), suffix
+				, first, second);
+			break;
+		case RI_LABEL:
+			uni_printf(io, "L%" PRId64 ":\n", (int64_t)argument);
+			break;
+		case RI_JUMP:
+			uni_printf(io, "\tjmp L%" PRId64 "\n", (int64_t)argument);
+			break;
+		case RI_BZ:
+			uni_printf(io, "\tbz r%zu, L%" PRId64 "\n", first, (int64_t)argument);
+			break;
+		case RI_BNZ:
+			uni_printf(io, "\tbnz r%zu, L%" PRId64 "\n", first, (int64_t)argument);
+			break;
+		case RI_ARG:
+			uni_printf(io, "\targ r%zu\n", first);
+			break;
+		case RI_CALL:
+			if (dst != RVM_NONE)
+			{
+				uni_printf(io, "\tr%zu = ", result);
+			}
+			else
+			{
+				uni_printf(io, "\t");
+			}
+			uni_printf(io, "call %s\n", ident_get_spelling(gen->sx, (size_t)argument));
+			break;
+		case RI_RET:
+			uni_printf(io, "\tret r%zu\n", first);
+			break;
+		case RI_RETV:
+			uni_printf(io, "\tret\n");
+			break;
+	}
+
+	if (dst != RVM_NONE && locations[dst] < 0)
+	{
+		uni_printf(io, "\tst s%" PRId64 ", r%zu\n", -locations[dst] - 1, result);
+	}
+}
+
+/**
+ *	Allocate registers and print code of current function
+ *
+ *	@param	gen			Generator
+ *	@param	id			Function identifier
+ *	@param	parameters	Number of parameters
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int function_to_io(const generator *const gen, const size_t id, const size_t parameters)
+{
+	const size_t registers = vector_size(&gen->kinds);
+	item_t *const locations = malloc((registers + 1) * sizeof(item_t));
+	size_t frame = 0;
+	if (locations == NULL || registers_allocate(gen, locations, &frame))
+	{
+		free(locations);
+		return -1;
+	}
+
+	size_t used = 0;
+	for (size_t i = 0; i < registers; i++)
+	{
+		used = locations[i] >= 0 && (size_t)locations[i] >= used ? (size_t)locations[i] + 1 : used;
+	}
+
+	uni_printf(gen->sx->io, "\nfunc %s params %zu regs %zu frame %zu\n", ident_get_spelling(gen->sx, id)
+		, parameters, frame != 0 ? RVM_REGISTERS : used, frame);
+
+	const size_t amount = code_amount(gen);
+	for (size_t i = 0; i < amount; i++)
+	{
+		instruction_to_io(gen, locations, i);
+	}
+	uni_printf(gen->sx->io, "end\n");
+
+	free(locations);
+	return 0;
+}
+
+
+/*
+ *	 ______     ______   ______     ______   ______     __    __     ______     __   __     ______   ______
+ *	/\  ___\   /\__  _\ /\  __ \   /\__  _\ /\  ___\   /\ "-./  \   /\  ___\   /\ "-.\ \   /\__  _\ /\  ___\
+ *	\ \___  \  \/_/\ \/ \ \  __ \  \/_/\ \/ \ \  __\   \ \ \-./\ \  \ \  __\   \ \ \-.  \  \/_/\ \/ \ \___  \
+ *	 \/\_____\    \ \_\  \ \_\ \_\    \ \_\  \ \_____\  \ \_\ \ \_\  \ \_____\  \ \_\\"\_\    \ \_\  \/\_____\
+ *	  \/_____/     \/_/   \/_/\/_/     \/_/   \/_____/   \/_/  \/_/   \/_____/   \/_/ \/_/     \/_/   \/_____/
+ */
+
+
+/**
+ *	Emit declaration statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_declaration_statement(generator *const gen, const node *const nd)
+{
+	const size_t size = statement_declaration_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = statement_declaration_get_declarator(nd, i);
+		if (declaration_get_class(&decl) == DECL_VAR)
+		{
+			emit_local_declaration(gen, &decl);
+		}
+	}
+}
+
+/**
+ *	Emit if statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_if_statement(generator *const gen, const node *const nd)
+{
+	const size_t label_else = label_create(gen);
+	const node condition = statement_if_get_condition(nd);
+	code_jump(gen, RI_BZ, emit_expression(gen, &condition), label_else);
+
+	const node then_substmt = statement_if_get_then_substmt(nd);
+	emit_statement(gen, &then_substmt);
+
+	if (statement_if_has_else_substmt(nd))
+	{
+		const size_t label_end = label_create(gen);
+		code_jump(gen, RI_JUMP, RVM_NONE, label_end);
+		code_label(gen, label_else);
+
+		const node else_substmt = statement_if_get_else_substmt(nd);
+		emit_statement(gen, &else_substmt);
+		code_label(gen, label_end);
+	}
+	else
+	{
+		code_label(gen, label_else);
+	}
+}
+
+/**
+ *	Emit loop with condition before body
+ *
+ *	@param	gen			Generator
+ *	@param	condition	Condition, @c NULL for infinite loop
+ *	@param	body		Loop body
+ *	@param	increment	Increment, @c NULL for none
+ */
+static void emit_loop(generator *const gen, const node *const condition, const node *const body
+	, const node *const increment)
+{
+	const size_t old_break = gen->label_break;
+	const size_t old_continue = gen->label_continue;
+	const size_t label_begin = label_create(gen);
+	gen->label_break = label_create(gen);
+	gen->label_continue = increment != NULL ? label_create(gen) : label_begin;
+
+	code_label(gen, label_begin);
+	if (condition != NULL)
+	{
+		code_jump(gen, RI_BZ, emit_expression(gen, condition), gen->label_break);
+	}
+
+	emit_statement(gen, body);
+
+	if (increment != NULL)
+	{
+		code_label(gen, gen->label_continue);
+		emit_expression(gen, increment);
+	}
+
+	code_jump(gen, RI_JUMP, RVM_NONE, label_begin);
+	code_label(gen, gen->label_break);
+
+	gen->label_break = old_break;
+	gen->label_continue = old_continue;
+}
+
+/**
+ *	Emit do statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_do_statement(generator *const gen, const node *const nd)
+{
+	const size_t old_break = gen->label_break;
+	const size_t old_continue = gen->label_continue;
+	const size_t label_begin = label_create(gen);
+	gen->label_break = label_create(gen);
+	gen->label_continue = label_create(gen);
+
+	code_label(gen, label_begin);
+	const node body = statement_do_get_body(nd);
+	emit_statement(gen, &body);
+
+	code_label(gen, gen->label_continue);
+	const node condition = statement_do_get_condition(nd);
+	code_jump(gen, RI_BNZ, emit_expression(gen, &condition), label_begin);
+	code_label(gen, gen->label_break);
+
+	gen->label_break = old_break;
+	gen->label_continue = old_continue;
+}
+
+/**
+ *	Emit for statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_for_statement(generator *const gen, const node *const nd)
+{
+	if (statement_for_has_inition(nd))
+	{
+		const node inition = statement_for_get_inition(nd);
+		emit_statement(gen, &inition);
+	}
+
+	const bool has_condition = statement_for_has_condition(nd);
+	const bool has_increment = statement_for_has_increment(nd);
+	const node body = statement_for_get_body(nd);
+	const node condition = has_condition ? statement_for_get_condition(nd) : body;
+	const node increment = has_increment ? statement_for_get_increment(nd) : body;
+
+	emit_loop(gen, has_condition ? &condition : NULL, &body, has_increment ? &increment : NULL);
+}
+
+/**
+ *	Emit switch statement.
+ *	Comparisons with cases are emitted after body, when all labels are known.
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_switch_statement(generator *const gen, const node *const nd)
+{
+	const size_t old_break = gen->label_break;
+	const size_t old_default = gen->label_default;
+	const size_t begin = vector_size(&gen->cases);
+	const size_t label_dispatch = label_create(gen);
+	gen->label_break = label_create(gen);
+	gen->label_default = SIZE_MAX;
+
+	const node condition = statement_switch_get_condition(nd);
+	const item_t value = emit_expression(gen, &condition);
+	code_jump(gen, RI_JUMP, RVM_NONE, label_dispatch);
+
+	const node body = statement_switch_get_body(nd);
+	emit_statement(gen, &body);
+	code_jump(gen, RI_JUMP, RVM_NONE, gen->label_break);
+
+	code_label(gen, label_dispatch);
+	const size_t end = vector_size(&gen->cases);
+	for (size_t i = begin; i < end; i += 2)
+	{
+		const node expression = node_load(&gen->sx->tree, (size_t)vector_get(&gen->cases, i));
+		const item_t constant = emit_expression(gen, &expression);
+		const item_t result = register_create(gen, false);
+		code_add(gen, RI_BINARY, result, value, constant, BIN_EQ, false);
+		code_jump(gen, RI_BNZ, result, (size_t)vector_get(&gen->cases, i + 1));
+	}
+
+	code_jump(gen, RI_JUMP, RVM_NONE, gen->label_default != SIZE_MAX ? gen->label_default : gen->label_break);
+	code_label(gen, gen->label_break);
+	vector_resize(&gen->cases, begin);
+
+	gen->label_break = old_break;
+	gen->label_default = old_default;
+}
+
+/**
+ *	Emit return statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_return_statement(generator *const gen, const node *const nd)
+{
+	if (statement_return_has_expression(nd))
+	{
+		const node expression = statement_return_get_expression(nd);
+		code_add(gen, RI_RET, RVM_NONE, emit_expression(gen, &expression), RVM_NONE, 0, false);
+	}
+	else
+	{
+		code_add(gen, RI_RETV, RVM_NONE, RVM_NONE, RVM_NONE, 0, false);
+	}
+}
+
+/**
+ *	Emit statement
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ */
+static void emit_statement(generator *const gen, const node *const nd)
+{
+	switch (statement_get_class(nd))
+	{
+		case STMT_DECL:
+			emit_declaration_statement(gen, nd);
+			return;
+
+		case STMT_CASE:
+		{
+			const size_t label = label_create(gen);
+			const node expression = statement_case_get_expression(nd);
+			vector_add(&gen->cases, (item_t)node_save(&expression));
+			vector_add(&gen->cases, (item_t)label);
+			code_label(gen, label);
+
+			const node substmt = statement_case_get_substmt(nd);
+			emit_statement(gen, &substmt);
+			return;
+		}
+
+		case STMT_DEFAULT:
+		{
+			gen->label_default = label_create(gen);
+			code_label(gen, gen->label_default);
+
+			const node substmt = statement_default_get_substmt(nd);
+			emit_statement(gen, &substmt);
+			return;
+		}
+
+		case STMT_COMPOUND:
+		{
+			const size_t size = statement_compound_get_size(nd);
+			for (size_t i = 0; i < size; i++)
+			{
+				const node substmt = statement_compound_get_substmt(nd, i);
+				emit_statement(gen, &substmt);
+			}
+			return;
+		}
+
+		case STMT_EXPR:
+			emit_expression(gen, nd);
+			return;
+
+		case STMT_NULL:
+			return;
+
+		case STMT_IF:
+			emit_if_statement(gen, nd);
+			return;
+
+		case STMT_SWITCH:
+			emit_switch_statement(gen, nd);
+			return;
+
+		case STMT_WHILE:
+		{
+			const node condition = statement_while_get_condition(nd);
+			const node body = statement_while_get_body(nd);
+			emit_loop(gen, &condition, &body, NULL);
+			return;
+		}
+
+		case STMT_DO:
+			emit_do_statement(gen, nd);
+			return;
+
+		case STMT_FOR:
+			emit_for_statement(gen, nd);
+			return;
+
+		case STMT_CONTINUE:
+			code_jump(gen, RI_JUMP, RVM_NONE, gen->label_continue);
+			return;
+
+		case STMT_BREAK:
+			code_jump(gen, RI_JUMP, RVM_NONE, gen->label_break);
+			return;
+
+		case STMT_RETURN:
+			emit_return_statement(gen, nd);
+			return;
+	}
+}
+
+/**
+ *	Emit function definition
+ *
+ *	@param	gen			Generator
+ *	@param	nd			Node in AST
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int emit_function_definition(generator *const gen, const node *const nd)
+{
+	// Номера регистров и меток локальны для функции
+	vector_resize(&gen->code, 0);
+	vector_resize(&gen->kinds, 0);
+	gen->label_num = 0;
+
+	const size_t id = declaration_function_get_id(nd);
+	const item_t return_type = type_function_get_return_type(gen->sx, ident_get_type(gen->sx, id));
+	if (!type_is_void(return_type) && !type_is_supported(gen->sx, return_type))
+	{
+		unsupported(gen, nd);
+		return 0;
+	}
+
+	const size_t parameters = declaration_function_get_parameters_amount(nd);
+	for (size_t i = 0; i < parameters; i++)
+	{
+		const size_t parameter = declaration_function_get_parameter(nd, i);
+		if (!type_is_supported(gen->sx, ident_get_type(gen->sx, parameter)))
+		{
+			unsupported(gen, nd);
+			return 0;
+		}
+
+		const item_t variable = register_create(gen, true);
+		register_set(gen, parameter, variable);
+		code_add(gen, RI_PARAM, variable, RVM_NONE, RVM_NONE, (item_t)i, false);
+	}
+
+	const node body = declaration_function_get_body(nd);
+	emit_statement(gen, &body);
+
+	const size_t amount = code_amount(gen);
+	const item_t last = amount != 0 ? code_get(gen, amount - 1, RF_OPERATION) : RI_LABEL;
+	if (last != RI_RET && last != RI_RETV)
+	{
+		code_add(gen, RI_RETV, RVM_NONE, RVM_NONE, RVM_NONE, 0, false);
+	}
+
+	return gen->was_error ? 0 : function_to_io(gen, id, parameters);
+}
+
+static int emit_translation_unit(generator *const gen, const node *const nd)
+{
+	uni_printf(gen->sx->io, "; RuC register virtual machine code\n");
+
+	const size_t size = translation_unit_get_size(nd);
+	for (size_t i = 0; i < size; i++)
+	{
+		const node decl = translation_unit_get_declaration(nd, i);
+		switch (declaration_get_class(&decl))
+		{
+			case DECL_VAR:
+				emit_global_declaration(gen, &decl);
+				break;
+
+			case DECL_FUNC:
+				if (emit_function_definition(gen, &decl))
+				{
+					return -1;
+				}
+				break;
+
+			default:
+				// С объявлением типа ничего делать не нужно
+				break;
+		}
+	}
+
+	uni_printf(gen->sx->io, "\nentry %s\n", ident_get_spelling(gen->sx, gen->sx->ref_main));
+	return gen->was_error ? -1 : 0;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int encode_to_rvm(const workspace *const ws, syntax *const sx)
+{
+	if (!ws_is_correct(ws) || sx == NULL)
+	{
+		return -1;
+	}
+
+	COUNTER_OUTPUT(COUNTER_PRINTF_RVM);
+	generator gen;
+	gen.sx = sx;
+	gen.code = vector_create(RVM_FIELDS * 256);
+	gen.kinds = vector_create(256);
+	gen.registers = vector_create(vector_size(&sx->identifiers));
+	gen.constants = vector_create(64);
+	gen.cases = vector_create(64);
+	gen.arguments = vector_create(64);
+	gen.label_num = 0;
+	gen.label_break = SIZE_MAX;
+	gen.label_continue = SIZE_MAX;
+	gen.label_default = SIZE_MAX;
+	gen.was_error = false;
+
+	vector_increase(&gen.registers, vector_size(&sx->identifiers));
+
+	const node root = node_get_root(&sx->tree);
+	const int ret = emit_translation_unit(&gen, &root);
+
+	vector_clear(&gen.code);
+	vector_clear(&gen.kinds);
+	vector_clear(&gen.registers);
+	vector_clear(&gen.constants);
+	vector_clear(&gen.cases);
+	vector_clear(&gen.arguments);
+	COUNTER_OUTPUT(COUNTER_PRINTF);
+	return ret;
+}
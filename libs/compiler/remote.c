@@ -0,0 +1,347 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "remote.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "errors.h"
+#include "logger.h"
+#include "partitioner.h"
+
+#ifndef _WIN32
+	#include <netdb.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+
+#define MAX_HOST_SIZE 256
+
+
+#ifndef _WIN32
+static const char *const REMOTE_FLAG = "--remote=";
+
+static const uint64_t HASH_BASIS = 14695981039346656037ULL;
+static const uint64_t HASH_PRIME = 1099511628211ULL;
+
+
+/** Get list of compile servers from flags, @c NULL if compilation is local */
+static const char *remote_get_hosts(const workspace *const ws)
+{
+	return ws_get_flag_value(ws, REMOTE_FLAG);
+}
+
+/** Copy host with index from list to buffer */
+static int remote_get_host(const char *const hosts, const size_t index, char *const buffer)
+{
+	const char *begin = hosts;
+	for (size_t i = 0; i < index; i++)
+	{
+		begin = strchr(begin, ',') + 1;
+	}
+
+	const char *const end = strchr(begin, ',');
+	const size_t size = end != NULL ? (size_t)(end - begin) : strlen(begin);
+	if (size == 0 || size >= MAX_HOST_SIZE)
+	{
+		return -1;
+	}
+
+	memcpy(buffer, begin, size);
+	buffer[size] = '\0';
+	return 0;
+}
+
+/** Connect to host with port by TCP or to Unix socket by path */
+static int remote_connect(char *const host)
+{
+	char *const colon = strrchr(host, ':');
+	if (colon == NULL)
+	{
+		struct sockaddr_un address;
+		if (strlen(host) >= sizeof(address.sun_path))
+		{
+			return -1;
+		}
+
+		const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd == -1)
+		{
+			return -1;
+		}
+
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, host);
+		if (connect(fd, (struct sockaddr *)&address, sizeof(address)))
+		{
+			close(fd);
+			return -1;
+		}
+
+		return fd;
+	}
+
+	*colon = '\0';
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	struct addrinfo *addresses;
+	if (getaddrinfo(host, &colon[1], &hints, &addresses))
+	{
+		return -1;
+	}
+
+	int fd = -1;
+	for (struct addrinfo *address = addresses; address != NULL && fd == -1; address = address->ai_next)
+	{
+		fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (fd != -1 && connect(fd, address->ai_addr, address->ai_addrlen))
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	freeaddrinfo(addresses);
+	return fd;
+}
+
+static int remote_send(const int fd, const char *const data, const size_t size)
+{
+	for (size_t sent = 0; sent < size; )
+	{
+		const ssize_t ret = write(fd, &data[sent], size - sent);
+		if (ret <= 0)
+		{
+			return -1;
+		}
+
+		sent += (size_t)ret;
+	}
+
+	return 0;
+}
+
+/** Send request with flags and code, then close it by empty request */
+static int remote_request(const int fd, const workspace *const ws, const char *const code)
+{
+	size_t size = 0;
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		size += strlen(ws_get_flag(ws, i)) + 1;
+	}
+
+	char *const args = malloc(size + 1);
+	if (args == NULL)
+	{
+		return -1;
+	}
+
+	// Сервер не должен пересылать запрос дальше, поэтому список серверов не передаётся
+	size = 0;
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		const char *const flag = ws_get_flag(ws, i);
+		if (strncmp(flag, REMOTE_FLAG, strlen(REMOTE_FLAG)) != 0)
+		{
+			strcpy(&args[size], flag);
+			size += strlen(flag) + 1;
+		}
+	}
+
+	char header[64];
+	const size_t code_size = strlen(code);
+	sprintf(header, "%zu %zu\n", size, code_size);
+
+	const int ret = remote_send(fd, header, strlen(header))
+		|| remote_send(fd, args, size)
+		|| remote_send(fd, code, code_size)
+		|| remote_send(fd, "0\n", 2);
+	free(args);
+	return ret ? -1 : 0;
+}
+
+/** Report diagnostics from response, malformed tail is ignored */
+static void remote_report(const char *const diagnostics, const size_t size)
+{
+	for (size_t i = 0; i < size; )
+	{
+		char kind;
+		size_t tag_size;
+		size_t msg_size;
+		int length;
+		if (sscanf(&diagnostics[i], "%c %zu %zu\n%n", &kind, &tag_size, &msg_size, &length) != 3
+			|| size - i - (size_t)length < tag_size + msg_size)
+		{
+			return;
+		}
+
+		i += (size_t)length;
+		char *const tag = malloc(tag_size + 1);
+		char *const msg = malloc(msg_size + 1);
+		if (tag != NULL && msg != NULL)
+		{
+			memcpy(tag, &diagnostics[i], tag_size);
+			tag[tag_size] = '\0';
+			memcpy(msg, &diagnostics[i + tag_size], msg_size);
+			msg[msg_size] = '\0';
+
+			if (kind == 'e')
+			{
+				log_relayed_error(tag, msg);
+			}
+			else
+			{
+				log_relayed_warning(tag, msg);
+			}
+		}
+
+		free(tag);
+		free(msg);
+		i += tag_size + msg_size;
+	}
+}
+
+/**
+ *	Read response and write its output
+ *
+ *	@return	Status code, @c -1 on failure of connection
+ */
+static int remote_response(const int fd, const char *const output)
+{
+	FILE *const input = fdopen(fd, "rb");
+	if (input == NULL)
+	{
+		close(fd);
+		return -1;
+	}
+
+	size_t number;
+	int status;
+	size_t size;
+	size_t diagnostics_size;
+	if (fscanf(input, "%zu %i %zu %zu", &number, &status, &size, &diagnostics_size) != 4
+		|| fgetc(input) != '\n')
+	{
+		fclose(input);
+		return -1;
+	}
+
+	char *const buffer = malloc(size + diagnostics_size + 1);
+	if (buffer == NULL || fread(buffer, 1, size + diagnostics_size, input) != size + diagnostics_size)
+	{
+		free(buffer);
+		fclose(input);
+		return -1;
+	}
+	fclose(input);
+	buffer[size + diagnostics_size] = '\0';
+
+	// Результат сохраняется только после успешного приёма всего ответа
+	if (status == 0 && output != NULL)
+	{
+		FILE *const file = fopen(output, "wb");
+		if (file == NULL || fwrite(buffer, 1, size, file) != size)
+		{
+			error_msg("не удалось записать результат удалённой компиляции");
+			status = 1;
+		}
+
+		if (file != NULL)
+		{
+			fclose(file);
+		}
+	}
+
+	remote_report(&buffer[size], diagnostics_size);
+	free(buffer);
+	return status;
+}
+#endif
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int remote_compile(const workspace *const ws, const char *const code)
+{
+#ifndef _WIN32
+	// Ответ сервера содержит один модуль, поэтому деление на модули выполняется локально
+	const char *const hosts = remote_get_hosts(ws);
+	if (hosts == NULL || code == NULL || ws_has_option(ws, OPT_BITCODE) || partition_get_amount(ws) != 0)
+	{
+		return -1;
+	}
+
+	size_t num = 1;
+	for (const char *comma = strchr(hosts, ','); comma != NULL; comma = strchr(&comma[1], ','))
+	{
+		num++;
+	}
+
+	// Один и тот же модуль отправляется на один и тот же сервер
+	uint64_t hash = HASH_BASIS;
+	const char *const output = ws_get_output(ws);
+	for (size_t i = 0; output != NULL && output[i] != '\0'; i++)
+	{
+		hash = (hash ^ (uint8_t)output[i]) * HASH_PRIME;
+	}
+
+	for (size_t i = 0; i < num; i++)
+	{
+		char host[MAX_HOST_SIZE];
+		if (remote_get_host(hosts, (size_t)((hash + i) % num), host))
+		{
+			continue;
+		}
+
+		const int fd = remote_connect(host);
+		if (fd == -1)
+		{
+			continue;
+		}
+
+		if (remote_request(fd, ws, code))
+		{
+			close(fd);
+			continue;
+		}
+
+		const int status = remote_response(fd, output);
+		if (status != -1)
+		{
+			return status;
+		}
+	}
+#else
+	(void)ws;
+	(void)code;
+#endif
+
+	return -1;
+}
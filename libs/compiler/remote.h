@@ -0,0 +1,43 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Compile preprocessed unit by one of compile servers from flag @c --remote=HOSTS.
+ *
+ *	Hosts are separated by commas, host with port is connected by TCP,
+ *	others are paths of Unix sockets. The first host is chosen by output path,
+ *	so units are spread between servers, unavailable hosts are skipped.
+ *	Output is written to output file of workspace, diagnostics are reported by current loggers.
+ *
+ *	@param	ws		Compiler workspace
+ *	@param	code	Preprocessed code
+ *
+ *	@return	Status code of compilation, @c -1 if unit should be compiled locally
+ */
+int remote_compile(const workspace *const ws, const char *const code);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -15,52 +15,544 @@
  */
 
 #include "reporter.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "logger.h"
+
+
+#define MAX_DIAGNOSTIC_SIZE MAX_MSG_SIZE * 2 + MAX_ARG_SIZE * 2 + 256
+
+#define DIAGNOSTIC_ITEMS	6
+#define BATCH_SIZE			64
+
+// Общие счётчики меняют задачи планировщика, атомарность обеспечивается только для GCC и Clang
+#if defined(__GNUC__) || defined(__clang__)
+	#define counter_add(counter)	__atomic_add_fetch(counter, 1, __ATOMIC_RELAXED)
+	#define counter_load(counter)	__atomic_load_n(counter, __ATOMIC_RELAXED)
+#else
+	#define counter_add(counter)	(++*(counter))
+	#define counter_load(counter)	(*(counter))
+#endif
+
+
+static const char *const TAG_RUC = "ruc";
+static const char *const TAG_DIAGNOSTICS = "diagnostics";
+
+static const char *const FLAG_FORMAT = "-fdiagnostics-format=";
+static const char *const FLAG_MAX_ERRORS = "-fmax-errors=";
+
+static const char *const FORMAT_JSON = "json";
+static const char *const FORMAT_SARIF = "sarif";
+
+static const char *const SARIF_BEGIN = "{\"version\": \"2.1.0\""
+	", \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\""
+	", \"runs\": [{\"tool\": {\"driver\": {\"name\": \"RuC\"}}, \"results\": [";
+
+static const char *const SEVERITY_NAMES[] = { "error", "warning" };
+
+
+/** Severity of diagnostic */
+typedef enum SEVERITY
+{
+	SEVERITY_ERROR,
+	SEVERITY_WARNING,
+} severity_t;
+
+/** Buffered diagnostic in order of output */
+typedef struct diagnostic
+{
+	size_t group;							/**< Group of diagnostic */
+	size_t index;							/**< Index in buffer */
+} diagnostic;
+
+/** Position in source file */
+typedef struct position
+{
+	char path[MAX_ARG_SIZE];				/**< File path */
+	size_t line;							/**< Line number */
+	size_t column;							/**< Column in symbols */
+} position;
+
+
+/** Write string as JSON literal, return its size */
+static size_t print_json_string(char *const buffer, const char *const str)
+{
+	size_t size = 0;
+	buffer[size++] = '"';
+	for (size_t i = 0; str[i] != '\0'; i++)
+	{
+		const unsigned char ch = (unsigned char)str[i];
+		if (ch == '"' || ch == '\\')
+		{
+			buffer[size++] = '\\';
+			buffer[size++] = (char)ch;
+		}
+		else if (ch < ' ')
+		{
+			size += (size_t)sprintf(&buffer[size], "\\u%04x", ch);
+		}
+		else
+		{
+			buffer[size++] = (char)ch;
+		}
+	}
+
+	buffer[size++] = '"';
+	buffer[size] = '\0';
+	return size;
+}
+
+static int diagnostic_compare(const void *const fst, const void *const snd)
+{
+	const diagnostic *const left = fst;
+	const diagnostic *const right = snd;
+
+	if (left->group != right->group)
+	{
+		return left->group < right->group ? -1 : 1;
+	}
+
+	return left->index < right->index ? -1 : left->index > right->index ? 1 : 0;
+}
+
+/** Get indexes of buffered diagnostics in order of groups, @c NULL on failure */
+static diagnostic *get_order(const reporter *const rprt, const size_t amount)
+{
+	diagnostic *const order = malloc(amount * sizeof(diagnostic));
+	if (order == NULL)
+	{
+		return NULL;
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		order[i].group = (size_t)vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * i + 4);
+		order[i].index = i;
+	}
+
+	qsort(order, amount, sizeof(diagnostic), &diagnostic_compare);
+	return order;
+}
+
+/** Move buffered diagnostics in order of groups to another reporter, all of them get its group */
+static void move_buffered(reporter *const rprt, reporter *const target)
+{
+	const size_t amount = strings_size(&rprt->messages);
+	diagnostic *const order = amount != 0 && amount != SIZE_MAX ? get_order(rprt, amount) : NULL;
+	if (order == NULL)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < amount; i++)
+	{
+		const size_t index = order[i].index;
+		for (size_t j = 0; j < DIAGNOSTIC_ITEMS; j++)
+		{
+			vector_add(&target->buffered, j == 4
+				? (item_t)target->group
+				: vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + j));
+		}
+
+		strings_add(&target->messages, strings_get(&rprt->messages, index));
+	}
+
+	free(order);
+}
+
+/** Check that diagnostics are held till the end of group or joining of worker */
+static inline bool is_held(const reporter *const rprt)
+{
+	return rprt->is_grouped || rprt->shared != NULL;
+}
+
+/** Get reporter with common counters */
+static inline reporter *get_shared(reporter *const rprt)
+{
+	return rprt->shared != NULL ? rprt->shared : rprt;
+}
+
+static comment get_comment(reporter *const rprt, universal_io *const io, const size_t index)
+{
+	if (!rprt->is_indexed)
+	{
+		rprt->index = cmt_index_create_by_map(in_get_buffer(io), in_get_locations(io));
+		rprt->is_indexed = true;
+	}
+
+	return cmt_index_search(&rprt->index, index);
+}
+
+static position get_position(reporter *const rprt, universal_io *const io, const size_t index)
+{
+	position pos;
+	const comment cmt = get_comment(rprt, io, index);
+	if (cmt_get_path(&cmt, pos.path) == 0 && in_get_path(io, pos.path) == 0)
+	{
+		pos.path[0] = '\0';
+	}
+
+	pos.line = cmt_get_line(&cmt);
+	pos.column = cmt_index_get_column(&rprt->index, &cmt);
+	return pos;
+}
+
+static void write_json(reporter *const rprt, universal_io *const io, const size_t index)
+{
+	const severity_t severity = (severity_t)vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index);
+	const item_t code = vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + 1);
+	const position begin = get_position(rprt, io, (size_t)vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + 2));
+	const position end = get_position(rprt, io, (size_t)vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + 3));
+
+	char buffer[MAX_DIAGNOSTIC_SIZE];
+	size_t size = 0;
+	if (rprt->format == DIAG_JSON)
+	{
+		size += (size_t)sprintf(&buffer[size], "{\"severity\": \"%s\", \"code\": %" PRIitem ", \"message\": "
+			, SEVERITY_NAMES[severity], code);
+		size += print_json_string(&buffer[size], strings_get(&rprt->messages, index));
+		size += (size_t)sprintf(&buffer[size], ", \"file\": ");
+		size += print_json_string(&buffer[size], begin.path);
+		sprintf(&buffer[size], ", \"begin\": {\"line\": %zu, \"column\": %zu}, \"end\": {\"line\": %zu, \"column\": %zu}}"
+			, begin.line, begin.column, end.line, end.column);
+
+		log_report(TAG_DIAGNOSTICS, buffer);
+		return;
+	}
+
+	size += (size_t)sprintf(&buffer[size], "{\"ruleId\": \"%c%" PRIitem "\", \"level\": \"%s\", \"message\": {\"text\": "
+		, severity == SEVERITY_ERROR ? 'E' : 'W', code, SEVERITY_NAMES[severity]);
+	size += print_json_string(&buffer[size], strings_get(&rprt->messages, index));
+	size += (size_t)sprintf(&buffer[size], "}, \"locations\": [{\"physicalLocation\": {\"artifactLocation\": {\"uri\": ");
+	size += print_json_string(&buffer[size], begin.path);
+	sprintf(&buffer[size], "}, \"region\": {\"startLine\": %zu, \"startColumn\": %zu, \"endLine\": %zu, \"endColumn\": %zu}}}]}"
+		, begin.line, begin.column, end.line, end.column);
+
+	// SARIF требует единого документа, поэтому результаты выводятся при освобождении
+	strings_add(&rprt->results, buffer);
+}
+
+static void write_text(reporter *const rprt, universal_io *const io, const size_t index)
+{
+	const size_t begin = (size_t)vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + 2);
+	const char *const msg = strings_get(&rprt->messages, index);
+	const bool is_error = vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index) == SEVERITY_ERROR;
+
+	// Позиция ищется по индексу строк, а не обратным проходом по коду до метки файла
+	const comment cmt = get_comment(rprt, io, begin);
+	if (!cmt_is_correct(&cmt))
+	{
+		in_set_position(io, begin);
+		if (is_error)
+		{
+			error_at(io, msg);
+		}
+		else
+		{
+			warning_at(io, msg);
+		}
+		return;
+	}
+
+	char tag[MAX_ARG_SIZE + 64];
+	const size_t size = cmt_get_path(&cmt, tag);
+	sprintf(&tag[size], ":%zu:%zu", cmt_get_line(&cmt), cmt_index_get_column(&rprt->index, &cmt));
+
+	// Строка кода читается до её конца прямо из буфера
+	if (is_error)
+	{
+		log_error(tag, msg, cmt.code, cmt_get_symbol(&cmt));
+	}
+	else
+	{
+		log_warning(tag, msg, cmt.code, cmt_get_symbol(&cmt));
+	}
+}
+
+static void write_sarif(reporter *const rprt)
+{
+	char tail[MAX_DIAGNOSTIC_SIZE];
+	if (rprt->suppressed != 0)
+	{
+		sprintf(tail, "], \"properties\": {\"suppressed\": %zu}}]}", rprt->suppressed);
+	}
+	else
+	{
+		sprintf(tail, "]}]}");
+	}
+
+	const size_t results = strings_size(&rprt->results);
+	size_t size = strlen(SARIF_BEGIN) + strlen(tail) + 1;
+	for (size_t i = 0; i < results; i++)
+	{
+		size += strings_get_length(&rprt->results, i) + 2;
+	}
+
+	char *const buffer = malloc(size);
+	if (buffer == NULL)
+	{
+		return;
+	}
+
+	size_t length = (size_t)sprintf(buffer, "%s", SARIF_BEGIN);
+	for (size_t i = 0; i < results; i++)
+	{
+		length += (size_t)sprintf(&buffer[length], "%s%s", i == 0 ? "" : ", ", strings_get(&rprt->results, i));
+	}
+
+	sprintf(&buffer[length], "%s", tail);
+	log_report(TAG_DIAGNOSTICS, buffer);
+	free(buffer);
+}
+
+static void report(reporter *const rprt, universal_io *const io, const range_location loc, const severity_t severity
+	, const item_t code, const char *const msg)
+{
+	// Позиция за концом кода заменяется концом, общий поток ввода при этом не изменяется
+	const size_t begin = in_is_buffer(io) && loc.begin > in_get_size(io) ? in_get_size(io) : loc.begin;
+
+	vector_add(&rprt->buffered, (item_t)severity);
+	vector_add(&rprt->buffered, code);
+	vector_add(&rprt->buffered, (item_t)begin);
+	vector_add(&rprt->buffered, (item_t)loc.end);
+	vector_add(&rprt->buffered, (item_t)rprt->group);
+	vector_add(&rprt->buffered, (item_t)loc.begin);
+	strings_add(&rprt->messages, msg);
+
+	if (!is_held(rprt) && strings_size(&rprt->messages) >= BATCH_SIZE)
+	{
+		reporter_flush(rprt, io);
+	}
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
 
 
 reporter reporter_create(const workspace *const ws)
 {
 	reporter rprt;
-	rprt.is_recovery_disabled = ws_has_flag(ws, "-Wno");
+	rprt.is_recovery_disabled = ws_has_option(ws, OPT_NO_RECOVERY);
 	rprt.errors = 0;
 	rprt.warnings = 0;
+	rprt.shared = NULL;
+
+	rprt.format = DIAG_TEXT;
+	rprt.max_errors = 0;
+	rprt.suppressed = 0;
+	rprt.last_code = ITEM_MAX;
+	rprt.last_begin = SIZE_MAX;
+
+	rprt.shown = 0;
+
+	rprt.group = 0;
+	rprt.is_grouped = false;
+
+	const size_t format_size = strlen(FLAG_FORMAT);
+	const size_t max_errors_size = strlen(FLAG_MAX_ERRORS);
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		const char *const flag = ws_get_flag(ws, i);
+		if (strncmp(flag, FLAG_FORMAT, format_size) == 0)
+		{
+			rprt.format = strcmp(&flag[format_size], FORMAT_JSON) == 0
+				? DIAG_JSON
+				: strcmp(&flag[format_size], FORMAT_SARIF) == 0 ? DIAG_SARIF : DIAG_TEXT;
+		}
+		else if (strncmp(flag, FLAG_MAX_ERRORS, max_errors_size) == 0)
+		{
+			rprt.max_errors = (size_t)strtoul(&flag[max_errors_size], NULL, 10);
+		}
+	}
+
+	rprt.buffered = vector_create(DIAGNOSTIC_ITEMS * BATCH_SIZE);
+	rprt.messages = strings_create(BATCH_SIZE);
+	rprt.results = strings_create(rprt.format == DIAG_SARIF ? BATCH_SIZE : 1);
+	rprt.is_indexed = false;
 
 	return rprt;
 }
 
-size_t reporter_get_errors_number(reporter *const rprt)
+reporter reporter_create_worker(reporter *const rprt)
 {
-	return rprt->errors;
+	reporter worker = *rprt;
+	worker.shared = get_shared(rprt);
+	worker.group = 0;
+	worker.is_grouped = false;
+
+	worker.buffered = vector_create(DIAGNOSTIC_ITEMS * BATCH_SIZE);
+	worker.messages = strings_create(BATCH_SIZE);
+	worker.results = strings_create(1);
+	worker.is_indexed = false;
+
+	return worker;
 }
 
-void report_error(reporter *const rprt, universal_io *const io, const range_location loc, const err_t num, va_list args)
+void reporter_join(reporter *const rprt, reporter *const worker)
+{
+	move_buffered(worker, rprt);
+
+	vector_clear(&worker->buffered);
+	strings_clear(&worker->messages);
+	strings_clear(&worker->results);
+}
+
+void reporter_set_group(reporter *const rprt, const size_t group)
 {
-	if (rprt->is_recovery_disabled && rprt->errors != 0)
+	rprt->group = group;
+	rprt->is_grouped = true;
+}
+
+void reporter_flush(reporter *const rprt, universal_io *const io)
+{
+	const size_t amount = strings_size(&rprt->messages);
+	rprt->group = 0;
+	rprt->is_grouped = false;
+	if (amount == 0 || amount == SIZE_MAX)
+	{
+		return;
+	}
+
+	if (rprt->shared != NULL)
+	{
+		// Порядок групп закрепляется, чтобы последующие диагностики шли после уже накопленных
+		reporter sorted = reporter_create_worker(rprt);
+		move_buffered(rprt, &sorted);
+
+		vector_clear(&rprt->buffered);
+		strings_clear(&rprt->messages);
+		strings_clear(&sorted.results);
+		rprt->buffered = sorted.buffered;
+		rprt->messages = sorted.messages;
+		return;
+	}
+
+	diagnostic *const order = get_order(rprt, amount);
+	if (order == NULL)
 	{
 		return;
 	}
 
-	const size_t prev_loc = in_get_position(io);
-	in_set_position(io, loc.begin);
+	const size_t position = in_get_position(io);
+	bool is_stopped = false;
+	for (size_t i = 0; i < amount && !is_stopped; i++)
+	{
+		// Восстановление после ошибки часто повторяет то же сообщение на той же позиции
+		const size_t index = order[i].index;
+		const item_t key = vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + 1) * 2
+			+ vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index);
+		const size_t begin = (size_t)vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index + 5);
+		if (rprt->last_code == key && rprt->last_begin == begin)
+		{
+			continue;
+		}
+
+		rprt->last_code = key;
+		rprt->last_begin = begin;
 
-	verror(io, num, args);
-	rprt->errors++;
+		const bool is_error = vector_get(&rprt->buffered, DIAGNOSTIC_ITEMS * index) == SEVERITY_ERROR;
+		if (is_error && rprt->max_errors != 0 && rprt->shown >= rprt->max_errors)
+		{
+			rprt->suppressed++;
+			continue;
+		}
+
+		// Без восстановления выводится только первая по порядку групп ошибка
+		rprt->shown += is_error ? 1 : 0;
+		is_stopped = rprt->is_recovery_disabled && is_error;
+
+		if (rprt->format == DIAG_TEXT)
+		{
+			write_text(rprt, io, index);
+		}
+		else
+		{
+			write_json(rprt, io, index);
+		}
+	}
 
-	in_set_position(io, prev_loc);
+	free(order);
+	in_set_position(io, position);
+	vector_resize(&rprt->buffered, 0);
+	strings_clear(&rprt->messages);
+	rprt->messages = strings_create(BATCH_SIZE);
 }
 
-void report_warning(reporter *const rprt, universal_io *const io, const range_location loc, const warning_t num, va_list args)
+void reporter_clear(reporter *const rprt, universal_io *const io)
+{
+	reporter_flush(rprt, io);
+
+	if (rprt->format == DIAG_SARIF)
+	{
+		write_sarif(rprt);
+	}
+	else if (rprt->suppressed != 0)
+	{
+		char buffer[MAX_DIAGNOSTIC_SIZE];
+		if (rprt->format == DIAG_JSON)
+		{
+			sprintf(buffer, "{\"suppressed\": %zu}", rprt->suppressed);
+			log_report(TAG_DIAGNOSTICS, buffer);
+		}
+		else
+		{
+			sprintf(buffer, "не показано ошибок сверх ограничения: %zu", rprt->suppressed);
+			log_system_note(TAG_RUC, buffer);
+		}
+	}
+
+	vector_clear(&rprt->buffered);
+	strings_clear(&rprt->messages);
+	strings_clear(&rprt->results);
+	if (rprt->is_indexed)
+	{
+		cmt_index_clear(&rprt->index);
+		rprt->is_indexed = false;
+	}
+}
+
+size_t reporter_get_errors_number(const reporter *const rprt)
+{
+	return counter_load(rprt->shared != NULL ? &rprt->shared->errors : &rprt->errors);
+}
+
+void report_error(reporter *const rprt, universal_io *const io, const range_location loc, const err_t num, va_list args)
 {
-	if (rprt->is_recovery_disabled && rprt->errors != 0)
+	if (rprt->is_recovery_disabled && !is_held(rprt) && reporter_get_errors_number(rprt) != 0)
 	{
 		return;
 	}
 
-	const size_t prev_loc = in_get_position(io);
-	in_set_position(io, loc.begin);
+	const size_t errors = counter_add(&get_shared(rprt)->errors);
+	if (!is_held(rprt) && rprt->max_errors != 0 && errors > rprt->max_errors)
+	{
+		// Лишние ошибки только подсчитываются, текст для них не формируется
+		rprt->suppressed++;
+		return;
+	}
+
+	char msg[MAX_MSG_SIZE];
+	error_text(num, msg, args);
+	report(rprt, io, loc, SEVERITY_ERROR, (item_t)num, msg);
+}
+
+void report_warning(reporter *const rprt, universal_io *const io, const range_location loc, const warning_t num, va_list args)
+{
+	if (rprt->is_recovery_disabled && !is_held(rprt) && reporter_get_errors_number(rprt) != 0)
+	{
+		return;
+	}
 
-	vwarning(io, num, args);
-	rprt->warnings++;
+	counter_add(&get_shared(rprt)->warnings);
 
-	in_set_position(io, prev_loc);
+	char msg[MAX_MSG_SIZE];
+	warning_text(num, msg, args);
+	report(rprt, io, loc, SEVERITY_WARNING, (item_t)num, msg);
 }
@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include "commenter.h"
 #include "errors.h"
+#include "strings.h"
 #include "token.h"
+#include "vector.h"
 #include "workspace.h"
 
 
@@ -25,18 +28,46 @@
 extern "C" {
 #endif
 
+/** Output format of diagnostics */
+typedef enum DIAGNOSTICS_FORMAT
+{
+	DIAG_TEXT,								/**< Messages with code line for terminal */
+	DIAG_JSON,								/**< JSON object per diagnostic */
+	DIAG_SARIF,								/**< SARIF log with all diagnostics */
+} diag_format_t;
+
 /** Reporter */
 typedef struct reporter
 {
-	size_t errors;							/**< Number of reported errors */
-	size_t warnings;						/**< Number of reported warnings */
+	size_t errors;							/**< Number of reported errors, changed atomically */
+	size_t warnings;						/**< Number of reported warnings, changed atomically */
+	struct reporter *shared;				/**< Reporter with common counters for worker, @c NULL otherwise */
 
 	bool is_recovery_disabled;				/**< Set, if error recovery & multiple output disabled */
+
+	diag_format_t format;					/**< Output format of diagnostics */
+	size_t max_errors;						/**< Maximum number of shown errors, @c 0 for unlimited */
+	size_t suppressed;						/**< Number of errors not shown due to limit */
+	size_t shown;							/**< Number of written errors */
+	item_t last_code;						/**< Severity and code of the last written diagnostic */
+	size_t last_begin;						/**< Reported position of the last written diagnostic */
+
+	size_t group;							/**< Group of reported diagnostics */
+	bool is_grouped;						/**< Set, if buffered diagnostics are written in order of groups */
+
+	vector buffered;						/**< Severity, code, begin, end, group and reported begin of diagnostics */
+	strings messages;						/**< Texts of diagnostics waiting for output */
+	strings results;						/**< SARIF results of written diagnostics */
+
+	comment_index index;					/**< Index of locations, built for the first written diagnostic */
+	bool is_indexed;						/**< Set, if index is built */
 } reporter;
 
 
 /**
- *	Create reporter
+ *	Create reporter.
+ *	Flag @c -fmax-errors=N limits number of shown errors,
+ *	@c -fdiagnostics-format=json and @c -fdiagnostics-format=sarif switch output to report log.
  *
  *	@param	ws		Compiler workspace
  *
@@ -44,15 +75,63 @@ typedef struct reporter
  */
 reporter reporter_create(const workspace *const ws);
 
+/**
+ *	Create reporter for parallel worker.
+ *	Worker shares counters with main reporter and holds its diagnostics till @ref reporter_join(),
+ *	so locations are resolved and diagnostics are written only by the thread of main reporter.
+ *
+ *	@param	rprt		Main reporter
+ *
+ *	@return	Worker reporter
+ */
+reporter reporter_create_worker(reporter *const rprt);
+
+/**
+ *	Move diagnostics of worker to main reporter and free worker memory.
+ *	Workers should be joined in source order of their parts, then diagnostics are written in the same order.
+ *
+ *	@param	rprt		Main reporter
+ *	@param	worker		Worker reporter
+ */
+void reporter_join(reporter *const rprt, reporter *const worker);
+
+/**
+ *	Set group of following diagnostics.
+ *	Diagnostics are held till the next @ref reporter_flush() and written in ascending order of groups,
+ *	so that a later phase can report diagnostics to the places of the earlier one.
+ *
+ *	@param	rprt		Reporter
+ *	@param	group		Group of diagnostics
+ */
+void reporter_set_group(reporter *const rprt, const size_t group);
+
+/**
+ *	Write buffered diagnostics.
+ *	Worker reporter only fixes order of its diagnostics, they are written after @ref reporter_join().
+ *
+ *	@param	rprt		Reporter
+ *	@param	io			Universal io, diagnostics were reported for
+ */
+void reporter_flush(reporter *const rprt, universal_io *const io);
+
+/**
+ *	Write buffered diagnostics and free allocated memory
+ *
+ *	@param	rprt		Reporter
+ *	@param	io			Universal io, diagnostics were reported for
+ */
+void reporter_clear(reporter *const rprt, universal_io *const io);
+
 /**
  *	Get reported error number
  *
  *	@param	rprt		Reporter
  */
-size_t reporter_get_errors_number(reporter *const rprt);
+size_t reporter_get_errors_number(const reporter *const rprt);
 
 /**
- *	Report an error
+ *	Report an error.
+ *	Diagnostics are buffered and written in batches, repeated diagnostic at the same position is skipped.
  *
  *	@param	rprt		Reporter
  *	@param	io			Universal io
@@ -0,0 +1,523 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "server.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compiler.h"
+#include "workspace.h"
+
+#ifndef _WIN32
+	#include <netdb.h>
+	#include <pthread.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+
+#define MAX_REQUEST_ARGS 256
+
+
+static const char *const SERVER_NAME = "ruc";
+
+
+typedef struct server server;
+
+/** Client connection */
+typedef struct connection
+{
+	server *srv;				/**< Server */
+	FILE *input;				/**< Requests stream */
+	FILE *output;				/**< Responses stream */
+	size_t pending;				/**< Number of unfinished requests */
+} connection;
+
+/** Compile request */
+typedef struct request
+{
+	connection *conn;			/**< Connection of request */
+	size_t number;				/**< Number of request in connection */
+	char *args;					/**< Arguments separated by zero characters */
+	size_t size;				/**< Size of arguments */
+	char *code;					/**< Preprocessed code of unit, @c NULL for common request */
+	struct request *next;		/**< Next request in queue */
+} request;
+
+/** Compile server with workers pool */
+struct server
+{
+	request *first;				/**< First request in queue */
+	request *last;				/**< Last request in queue */
+	bool is_stopped;			/**< Set, if workers should exit */
+
+#ifndef _WIN32
+	pthread_mutex_t lock;		/**< Lock of queue and connections */
+	pthread_cond_t has_request;	/**< Signaled on new request */
+	pthread_cond_t has_response;/**< Signaled on finished request */
+#endif
+};
+
+/** Diagnostics collected for client */
+typedef struct diagnostics
+{
+	char *buffer;				/**< Records of kind, sizes of tag and message, tag and message */
+	size_t size;				/**< Size of records */
+	size_t capacity;			/**< Allocated size */
+} diagnostics;
+
+
+/** Diagnostics of unit compiled by current thread */
+static _Thread_local diagnostics *current_diagnostics;
+
+
+static void diagnostics_add(const char kind, const char *const tag, const char *const msg)
+{
+	diagnostics *const diags = current_diagnostics;
+	const size_t tag_size = strlen(tag);
+	const size_t msg_size = strlen(msg);
+	const size_t size = diags->size + tag_size + msg_size + 64;
+	if (size > diags->capacity)
+	{
+		char *const buffer = realloc(diags->buffer, 2 * size);
+		if (buffer == NULL)
+		{
+			return;
+		}
+
+		diags->buffer = buffer;
+		diags->capacity = 2 * size;
+	}
+
+	diags->size += (size_t)sprintf(&diags->buffer[diags->size], "%c %zu %zu\n", kind, tag_size, msg_size);
+	memcpy(&diags->buffer[diags->size], tag, tag_size);
+	memcpy(&diags->buffer[diags->size + tag_size], msg, msg_size);
+	diags->size += tag_size + msg_size;
+}
+
+static void diagnostics_error(const char *const tag, const char *const msg)
+{
+	diagnostics_add('e', tag, msg);
+}
+
+static void diagnostics_warning(const char *const tag, const char *const msg)
+{
+	diagnostics_add('w', tag, msg);
+}
+
+/** Compile preprocessed unit, output and diagnostics are sent back to client */
+static int request_compile(request *const req, const int argc, const char *const *const argv
+	, char **const output, size_t *const size, diagnostics *const diags)
+{
+	workspace ws = ws_parse_args(argc, argv);
+	ws_set_log(&ws, &diagnostics_error, &diagnostics_warning);
+
+	current_diagnostics = diags;
+	const int ret = (int)compile_preprocessed_to_buffer(&ws, req->code, output, size);
+	current_diagnostics = NULL;
+
+	ws_clear(&ws);
+	return ret;
+}
+
+static void request_run(request *const req)
+{
+	const char *argv[MAX_REQUEST_ARGS];
+	int argc = 0;
+	argv[argc++] = SERVER_NAME;
+
+	for (size_t i = 0; i < req->size && argc < MAX_REQUEST_ARGS; i += strlen(&req->args[i]) + 1)
+	{
+		if (req->args[i] != '\0')
+		{
+			argv[argc++] = &req->args[i];
+		}
+	}
+
+	char *output = NULL;
+	size_t size = 0;
+	diagnostics diags = { .buffer = NULL, .size = 0, .capacity = 0 };
+	const int ret = req->code != NULL
+		? request_compile(req, argc, argv, &output, &size, &diags)
+		: auto_compile(argc, argv);
+
+	connection *const conn = req->conn;
+#ifndef _WIN32
+	pthread_mutex_lock(&conn->srv->lock);
+#endif
+	if (req->code != NULL)
+	{
+		size = output != NULL ? size : 0;
+		fprintf(conn->output, "%zu %i %zu %zu\n", req->number, ret, size, diags.size);
+		fwrite(output, 1, size, conn->output);
+		fwrite(diags.buffer, 1, diags.size, conn->output);
+	}
+	else
+	{
+		fprintf(conn->output, "%zu %i\n", req->number, ret);
+	}
+	fflush(conn->output);
+	conn->pending--;
+#ifndef _WIN32
+	pthread_cond_broadcast(&conn->srv->has_response);
+	pthread_mutex_unlock(&conn->srv->lock);
+#endif
+
+	free(output);
+	free(diags.buffer);
+	free(req->code);
+	free(req->args);
+	free(req);
+}
+
+static void server_submit(server *const srv, request *const req)
+{
+#ifndef _WIN32
+	pthread_mutex_lock(&srv->lock);
+	req->conn->pending++;
+
+	if (srv->last != NULL)
+	{
+		srv->last->next = req;
+	}
+	else
+	{
+		srv->first = req;
+	}
+	srv->last = req;
+
+	pthread_cond_signal(&srv->has_request);
+	pthread_mutex_unlock(&srv->lock);
+#else
+	(void)srv;
+	req->conn->pending++;
+	request_run(req);
+#endif
+}
+
+/** Read requests of connection until its end and wait for their responses */
+static void connection_serve(connection *const conn)
+{
+	size_t size;
+	for (size_t number = 0; fscanf(conn->input, "%zu", &size) == 1; number++)
+	{
+		// Вслед за аргументами может идти препроцессированный текст модуля, тогда аргументов может не быть
+		size_t code_size = 0;
+		int next = fgetc(conn->input);
+		const bool has_code = next == ' ';
+		if ((!has_code && size == 0)
+			|| (has_code && (fscanf(conn->input, "%zu", &code_size) != 1 || (next = fgetc(conn->input)) == EOF)))
+		{
+			break;
+		}
+
+		request *const req = malloc(sizeof(request));
+		char *const args = malloc(size + 1);
+		char *const code = has_code ? malloc(code_size + 1) : NULL;
+		if (next != '\n' || req == NULL || args == NULL || (has_code && code == NULL)
+			|| fread(args, 1, size, conn->input) != size
+			|| (has_code && fread(code, 1, code_size, conn->input) != code_size))
+		{
+			free(req);
+			free(args);
+			free(code);
+			break;
+		}
+
+		args[size] = '\0';
+		if (has_code)
+		{
+			code[code_size] = '\0';
+		}
+
+		*req = (request){ .conn = conn, .number = number, .args = args, .size = size, .code = code, .next = NULL };
+		server_submit(conn->srv, req);
+	}
+
+#ifndef _WIN32
+	pthread_mutex_lock(&conn->srv->lock);
+	while (conn->pending != 0)
+	{
+		pthread_cond_wait(&conn->srv->has_response, &conn->srv->lock);
+	}
+	pthread_mutex_unlock(&conn->srv->lock);
+#endif
+}
+
+
+#ifndef _WIN32
+static void *worker_run(void *arg)
+{
+	server *const srv = arg;
+	while (true)
+	{
+		pthread_mutex_lock(&srv->lock);
+		while (srv->first == NULL && !srv->is_stopped)
+		{
+			pthread_cond_wait(&srv->has_request, &srv->lock);
+		}
+
+		request *const req = srv->first;
+		if (req != NULL)
+		{
+			srv->first = req->next;
+			srv->last = srv->first != NULL ? srv->last : NULL;
+		}
+		pthread_mutex_unlock(&srv->lock);
+
+		if (req == NULL)
+		{
+			return NULL;
+		}
+
+		request_run(req);
+	}
+}
+
+static void *connection_run(void *arg)
+{
+	connection *const conn = arg;
+	connection_serve(conn);
+
+	fclose(conn->input);
+	fclose(conn->output);
+	free(conn);
+	return NULL;
+}
+
+/** Open listening Unix socket */
+static int server_open_unix(const char *const path)
+{
+	struct sockaddr_un address;
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd == -1)
+	{
+		return -1;
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+
+	unlink(path);
+	if (bind(fd, (struct sockaddr *)&address, sizeof(address)) || listen(fd, SOMAXCONN))
+	{
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/** Open listening TCP socket on address with port */
+static int server_open_tcp(const char *const path, const char *const colon)
+{
+	char host[256];
+	const size_t size = (size_t)(colon - path);
+	if (size >= sizeof(host))
+	{
+		return -1;
+	}
+
+	memcpy(host, path, size);
+	host[size] = '\0';
+
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_PASSIVE;
+
+	struct addrinfo *addresses;
+	if (getaddrinfo(size != 0 ? host : NULL, &colon[1], &hints, &addresses))
+	{
+		return -1;
+	}
+
+	int fd = -1;
+	for (struct addrinfo *address = addresses; address != NULL && fd == -1; address = address->ai_next)
+	{
+		fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+		if (fd == -1)
+		{
+			continue;
+		}
+
+		const int reuse = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		if (bind(fd, address->ai_addr, address->ai_addrlen) || listen(fd, SOMAXCONN))
+		{
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	freeaddrinfo(addresses);
+	return fd;
+}
+
+/** Accept clients of socket, each of them is read by its own thread */
+static int server_listen(server *const srv, const char *const path)
+{
+	// Адрес с портом открывается как TCP сокет, остальные пути - как сокеты Unix
+	const char *const colon = strrchr(path, ':');
+	const int fd = colon != NULL ? server_open_tcp(path, colon) : server_open_unix(path);
+	if (fd == -1)
+	{
+		return -1;
+	}
+
+	while (true)
+	{
+		const int client = accept(fd, NULL, NULL);
+		if (client == -1)
+		{
+			break;
+		}
+
+		const int duplicate = dup(client);
+		connection *const conn = malloc(sizeof(connection));
+		FILE *const input = fdopen(client, "rb");
+		FILE *const output = duplicate != -1 ? fdopen(duplicate, "wb") : NULL;
+
+		pthread_t thread;
+		if (conn == NULL || input == NULL || output == NULL)
+		{
+			free(conn);
+		}
+		else
+		{
+			*conn = (connection){ .srv = srv, .input = input, .output = output, .pending = 0 };
+			if (pthread_create(&thread, NULL, &connection_run, conn) == 0)
+			{
+				pthread_detach(thread);
+				continue;
+			}
+
+			free(conn);
+		}
+
+		// Соединение, которое не удалось обслужить, закрывается сразу
+		if (input != NULL)
+		{
+			fclose(input);
+		}
+		else
+		{
+			close(client);
+		}
+
+		if (output != NULL)
+		{
+			fclose(output);
+		}
+		else if (duplicate != -1)
+		{
+			close(duplicate);
+		}
+	}
+
+	close(fd);
+	if (colon == NULL)
+	{
+		unlink(path);
+	}
+	return -1;
+}
+#endif
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int compile_server(const char *const path)
+{
+	server srv = { .first = NULL, .last = NULL, .is_stopped = false };
+
+#ifndef _WIN32
+	pthread_mutex_init(&srv.lock, NULL);
+	pthread_cond_init(&srv.has_request, NULL);
+	pthread_cond_init(&srv.has_response, NULL);
+
+	const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	const size_t num = cores > 0 ? (size_t)cores : 1;
+	pthread_t *const workers = malloc(num * sizeof(pthread_t));
+	if (workers == NULL)
+	{
+		return -1;
+	}
+
+	size_t started = 0;
+	while (started < num && pthread_create(&workers[started], NULL, &worker_run, &srv) == 0)
+	{
+		started++;
+	}
+
+	int ret = -1;
+	if (started != 0)
+	{
+		if (path == NULL)
+		{
+			connection conn = { .srv = &srv, .input = stdin, .output = stdout, .pending = 0 };
+			connection_serve(&conn);
+			ret = 0;
+		}
+		else
+		{
+			ret = server_listen(&srv, path);
+		}
+	}
+
+	pthread_mutex_lock(&srv.lock);
+	srv.is_stopped = true;
+	pthread_cond_broadcast(&srv.has_request);
+	pthread_mutex_unlock(&srv.lock);
+
+	for (size_t i = 0; i < started; i++)
+	{
+		pthread_join(workers[i], NULL);
+	}
+
+	free(workers);
+	pthread_cond_destroy(&srv.has_response);
+	pthread_cond_destroy(&srv.has_request);
+	pthread_mutex_destroy(&srv.lock);
+	return ret;
+#else
+	// Без потоков запросы выполняются по очереди
+	if (path != NULL)
+	{
+		return -1;
+	}
+
+	connection conn = { .srv = &srv, .input = stdin, .output = stdout, .pending = 0 };
+	connection_serve(&conn);
+	return 0;
+#endif
+}
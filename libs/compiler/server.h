@@ -0,0 +1,52 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "dll.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Run compile server, which processes requests until end of input.
+ *
+ *	Request is a line with size of arguments, followed by arguments.
+ *	Arguments are the same as command line ones and are separated by zero characters.
+ *	Request with zero size closes connection.
+ *	Requests are compiled concurrently, response is a line with number of request
+ *	in connection starting from zero and status code of compilation.
+ *
+ *	Size of arguments may be followed by space and size of preprocessed code,
+ *	which comes after arguments. Such unit is compiled in memory and its response line
+ *	also contains sizes of output and diagnostics, which follow the line.
+ *	Each diagnostic is a line with kind @c e or @c w, sizes of tag and message,
+ *	followed by tag and message.
+ *
+ *	Relative paths are resolved from working directory of server,
+ *	so concurrent requests should set different output files.
+ *
+ *	@param	path	Path of Unix socket or address with port for clients, @c NULL for standard input and output
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int compile_server(const char *const path);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -15,11 +15,17 @@
  */
 
 #include "syntax.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "scheduler.h"
 #include "token.h"
 #include "tree.h"
 
+#ifndef _WIN32
+	#include <pthread.h>
+#endif
+
 
 static const size_t REPRESENTATIONS_SIZE = 10000;
 static const size_t IDENTIFIERS_SIZE = 10000;
@@ -27,6 +33,48 @@ static const size_t FUNCTIONS_SIZE = 100;
 static const size_t STRINGS_SIZE = 80;
 static const size_t TYPES_SIZE = 1000;
 static const size_t TREE_SIZE = 10000;
+static const size_t TYPE_TABLE_SIZE = 256;
+static const size_t OCCURRENCES_SIZE = 4096;
+
+static const char *const XREF_FLAG = "--xref=";
+
+/** Type class flags, so that type predicates are single mask tests */
+typedef enum TYPE_FLAG
+{
+	FLAG_INTEGER			= 0x01,		/**< Character, integer or enum */
+	FLAG_FLOATING			= 0x02,		/**< Floating */
+	FLAG_POINTER			= 0x04,		/**< Pointer */
+	FLAG_SCALAR				= 0x08,		/**< Boolean, integer, pointer or null pointer */
+	FLAG_ARRAY				= 0x10,		/**< Array */
+	FLAG_STRUCTURE			= 0x20,		/**< Structure or vector */
+	FLAG_STRING				= 0x40,		/**< Array of characters */
+	FLAG_STRUCT_POINTER		= 0x80,		/**< Pointer to structure */
+} type_flag_t;
+
+/** Class flags of base types from @c TYPE_VARARG to @c TYPE_UNDEFINED */
+static const uint8_t BASE_TYPE_FLAGS[] =
+{
+	0,								// TYPE_VARARG
+	FLAG_SCALAR,					// TYPE_NULL_POINTER
+	0,								// TYPE_FILE
+	0,								// TYPE_VOID
+	0,
+	FLAG_SCALAR,					// TYPE_BOOLEAN
+	FLAG_FLOATING,					// TYPE_FLOATING
+	FLAG_INTEGER | FLAG_SCALAR,		// TYPE_CHARACTER
+	FLAG_INTEGER | FLAG_SCALAR,		// TYPE_INTEGER
+	0,								// TYPE_UNDEFINED
+};
+
+static const char SNAPSHOT_MAGIC[4] = { 'R', 'u', 'C', 'S' };
+static const uint32_t SNAPSHOT_VERSION = 10;
+
+
+// Встроенные таблицы строятся один раз и копируются в каждую компиляцию
+static syntax builtins;
+#ifndef _WIN32
+	static pthread_once_t builtins_once = PTHREAD_ONCE_INIT;
+#endif
 
 
 static void repr_add_keyword(map *const reprtab, const char32_t *const eng, const char32_t *const rus, const token_t token)
@@ -59,6 +107,8 @@ static inline void repr_init(map *const reprtab)
 	repr_add_keyword(reprtab, U"double", U"двойной", TK_DOUBLE);
 	repr_add_keyword(reprtab, U"float", U"вещ", TK_FLOAT);
 	repr_add_keyword(reprtab, U"int", U"цел", TK_INT);
+	repr_add_keyword(reprtab, U"float4", U"вещ4", TK_FLOAT4);
+	repr_add_keyword(reprtab, U"int4", U"цел4", TK_INT4);
 	repr_add_keyword(reprtab, U"long", U"длин", TK_LONG);
 	repr_add_keyword(reprtab, U"struct", U"структура", TK_STRUCT);
 	repr_add_keyword(reprtab, U"enum", U"перечисление", TK_ENUM);
@@ -85,6 +135,158 @@ static inline void repr_init(map *const reprtab)
 }
 
 
+/**	Check if types are equal */
+static inline bool type_is_equal(const syntax *const sx, const size_t first, const size_t second)
+{
+	if (vector_get(&sx->types, first) != vector_get(&sx->types, second))
+	{
+		return false;
+	}
+
+	size_t length = 1;
+	const item_t type = vector_get(&sx->types, first);
+
+	// Определяем, сколько полей надо сравнивать для различных типов записей
+	if (type == TYPE_STRUCTURE || type == TYPE_VECTOR || type == TYPE_FUNCTION)
+	{
+		length = 2 + (size_t)vector_get(&sx->types, first + 2);
+	}
+
+	for (size_t i = 1; i <= length; i++)
+	{
+		if (vector_get(&sx->types, first + i) != vector_get(&sx->types, second + i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**	Get hash of type content, which is compared by type_is_equal */
+static inline size_t type_get_hash(const syntax *const sx, const size_t type)
+{
+	const item_t class = vector_get(&sx->types, type);
+	const size_t length = class == TYPE_STRUCTURE || class == TYPE_VECTOR || class == TYPE_FUNCTION
+		? 2 + (size_t)vector_get(&sx->types, type + 2)
+		: 1;
+
+	uint64_t hash = 14695981039346656037u;
+	for (size_t i = 0; i <= length; i++)
+	{
+		hash = (hash ^ (uint64_t)vector_get(&sx->types, type + i)) * 1099511628211u;
+	}
+
+	return (size_t)(hash ^ (hash >> 32));
+}
+
+/**	Find slot of type with equal content or free slot for it */
+static size_t type_find_slot(const syntax *const sx, const size_t type)
+{
+	const size_t mask = vector_size(&sx->type_table) - 1;
+	size_t slot = type_get_hash(sx, type) & mask;
+
+	while (vector_at(&sx->type_table, slot) != 0
+		&& !type_is_equal(sx, (size_t)vector_at(&sx->type_table, slot), type))
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+static void type_grow_table(syntax *const sx)
+{
+	const size_t size = 2 * vector_size(&sx->type_table);
+	vector table = vector_create_by_arena(sx->memory, size);
+	vector_increase(&table, size);
+
+	for (size_t i = 0; i < vector_size(&sx->type_table); i++)
+	{
+		const item_t type = vector_at(&sx->type_table, i);
+		if (type != 0)
+		{
+			size_t slot = type_get_hash(sx, (size_t)type) & (size - 1);
+			while (vector_at(&table, slot) != 0)
+			{
+				slot = (slot + 1) & (size - 1);
+			}
+
+			vector_put(&table, slot, type);
+		}
+	}
+
+	vector_clear(&sx->type_table);
+	sx->type_table = table;
+}
+
+/**	Set class flags of type by its record */
+static int type_set_flags(syntax *const sx, const size_t type)
+{
+	if (type >= sx->type_flags_alloc)
+	{
+		const size_t alloc_new = 2 * type > TYPES_SIZE ? 2 * type : TYPES_SIZE;
+		uint8_t *const flags_new = realloc(sx->type_flags, alloc_new);
+		if (flags_new == NULL)
+		{
+			return -1;
+		}
+
+		memset(&flags_new[sx->type_flags_alloc], 0, alloc_new - sx->type_flags_alloc);
+		sx->type_flags = flags_new;
+		sx->type_flags_alloc = alloc_new;
+	}
+
+	const item_t class = vector_get(&sx->types, type);
+	const item_t element = vector_get(&sx->types, type + 1);
+	switch (class)
+	{
+		case TYPE_ENUM:
+			sx->type_flags[type] = FLAG_INTEGER | FLAG_SCALAR;
+			break;
+		case TYPE_POINTER:
+			sx->type_flags[type] = FLAG_POINTER | FLAG_SCALAR
+				| (element > 0 && (vector_get(&sx->types, (size_t)element) == TYPE_STRUCTURE
+					|| vector_get(&sx->types, (size_t)element) == TYPE_VECTOR) ? FLAG_STRUCT_POINTER : 0);
+			break;
+		case TYPE_ARRAY:
+			sx->type_flags[type] = FLAG_ARRAY | (element == TYPE_CHARACTER ? FLAG_STRING : 0);
+			break;
+		case TYPE_STRUCTURE:
+		case TYPE_VECTOR:
+			sx->type_flags[type] = FLAG_STRUCTURE;
+			break;
+		default:
+			sx->type_flags[type] = 0;
+			break;
+	}
+
+	return 0;
+}
+
+/**	Get class flags of type */
+static inline uint8_t type_get_flags(const syntax *const sx, const item_t type)
+{
+	if (type >= TYPE_VARARG && type <= TYPE_UNDEFINED)
+	{
+		return BASE_TYPE_FLAGS[type - TYPE_VARARG];
+	}
+
+	const size_t index = type > 0 ? (size_t)type : (size_t)(-type);
+	if (sx == NULL || index >= sx->type_flags_alloc)
+	{
+		return 0;
+	}
+
+	if (type > 0)
+	{
+		return sx->type_flags[index];
+	}
+
+	// Отрицательный тип - поле перечисления, если ссылается на перечисление
+	return (sx->type_flags[index] & FLAG_INTEGER) != 0 ? FLAG_INTEGER | FLAG_SCALAR : 0;
+}
+
 static inline void type_init(syntax *const sx)
 {
 	vector_increase(&sx->types, 1);
@@ -97,6 +299,12 @@ static inline void type_init(syntax *const sx)
 	vector_add(&sx->types, (item_t)map_reserve(&sx->representations, "numTh"));
 	vector_add(&sx->types, TYPE_INTEGER);
 	vector_add(&sx->types, (item_t)map_reserve(&sx->representations, "data"));
+	type_set_flags(sx, sx->start_type + 1);
+
+	sx->type_table = vector_create_by_arena(sx->memory, TYPE_TABLE_SIZE);
+	vector_increase(&sx->type_table, TYPE_TABLE_SIZE);
+	vector_put(&sx->type_table, type_find_slot(sx, sx->start_type + 1), (item_t)sx->start_type + 1);
+	sx->type_amount = 1;
 }
 
 static inline item_t get_static(syntax *const sx, const item_t type)
@@ -116,34 +324,6 @@ static inline item_t get_static(syntax *const sx, const item_t type)
 	return old_displ;
 }
 
-/**	Check if types are equal */
-static inline bool type_is_equal(const syntax *const sx, const size_t first, const size_t second)
-{
-	if (vector_get(&sx->types, first) != vector_get(&sx->types, second))
-	{
-		return false;
-	}
-
-	size_t length = 1;
-	const item_t type = vector_get(&sx->types, first);
-
-	// Определяем, сколько полей надо сравнивать для различных типов записей
-	if (type == TYPE_STRUCTURE || type == TYPE_FUNCTION)
-	{
-		length = 2 + (size_t)vector_get(&sx->types, first + 2);
-	}
-
-	for (size_t i = 1; i <= length; i++)
-	{
-		if (vector_get(&sx->types, first + i) != vector_get(&sx->types, second + i))
-		{
-			return false;
-		}
-	}
-
-	return true;
-}
-
 static void builtin_add(syntax *const sx, const char32_t *const eng, const char32_t *const rus, const item_t type)
 {
 	// Добавляем одно из написаний в таблицу representations
@@ -201,6 +381,8 @@ static void ident_init(syntax *const sx)
 	builtin_add(sx, U"receive_int_from_robot", U"получить_цел_от_робота", type_function(sx, TYPE_INTEGER, "i"));
 	builtin_add(sx, U"receive_float_from_robot", U"получить_вещ_от_робота", type_function(sx, TYPE_FLOATING, "i"));
 	builtin_add(sx, U"receive_string_from_robot", U"получить_строку_от_робота", type_function(sx, TYPE_VOID, "i"));
+	builtin_add(sx, U"receive_ints_from_robot", U"получить_цел_массив_от_робота", type_function(sx, TYPE_VOID, "iI"));
+	builtin_add(sx, U"receive_floats_from_robot", U"получить_вещ_массив_от_робота", type_function(sx, TYPE_VOID, "iF"));
 
 	builtin_add(sx, U"t_create", U"н_создать", type_function(sx, TYPE_INTEGER, "T"));
 	builtin_add(sx, U"t_getnum", U"н_номер_нити", type_function(sx, TYPE_INTEGER, ""));
@@ -216,11 +398,30 @@ static void ident_init(syntax *const sx)
 
 	builtin_add(sx, U"t_msg_send", U"н_послать", type_function(sx, TYPE_VOID, "m"));
 	builtin_add(sx, U"t_msg_receive", U"н_получить", type_function(sx, TYPE_MSG_INFO, ""));
+	builtin_add(sx, U"t_chan_send", U"н_канал_послать", type_function(sx, TYPE_VOID, "ii"));
+	builtin_add(sx, U"t_chan_receive", U"н_канал_получить", type_function(sx, TYPE_INTEGER, "i"));
+
+	builtin_add(sx, U"t_atomic_add", U"н_атом_прибавить", type_function(sx, TYPE_INTEGER, "pi"));
+	builtin_add(sx, U"t_atomic_cas", U"н_атом_сравнить_обменять", type_function(sx, TYPE_INTEGER, "pii"));
+	builtin_add(sx, U"t_atomic_load", U"н_атом_прочитать", type_function(sx, TYPE_INTEGER, "p"));
+	builtin_add(sx, U"t_atomic_store", U"н_атом_записать", type_function(sx, TYPE_VOID, "pi"));
+
+	builtin_add(sx, U"t_parallel_for", U"н_параллельно", type_function(sx, TYPE_VOID, "Lii"));
+
+	builtin_add(sx, U"t_set_priority", U"н_приоритет", type_function(sx, TYPE_INTEGER, "ii"));
+	builtin_add(sx, U"t_set_affinity", U"н_ядро", type_function(sx, TYPE_INTEGER, "i"));
+	builtin_add(sx, U"t_period_start", U"н_период", type_function(sx, TYPE_VOID, "i"));
+	builtin_add(sx, U"t_period_wait", U"н_ждать_период", type_function(sx, TYPE_INTEGER, ""));
 
 	builtin_add(sx, U"fopen", U"фоткрыть", type_function(sx, type_pointer(sx, TYPE_FILE), "ss"));
 	builtin_add(sx, U"fgetc", U"фчитать_символ", type_function(sx, TYPE_INTEGER, "P"));
 	builtin_add(sx, U"fputc", U"фписать_символ", type_function(sx, TYPE_INTEGER, "iP"));
 	builtin_add(sx, U"fclose", U"фзакрыть", type_function(sx, TYPE_INTEGER, "P"));
+	builtin_add(sx, U"fread_chars", U"фчитать_литеры", type_function(sx, TYPE_INTEGER, "siP"));
+	builtin_add(sx, U"fwrite_chars", U"фписать_литеры", type_function(sx, TYPE_INTEGER, "siP"));
+	builtin_add(sx, U"fread_ints", U"фчитать_целые", type_function(sx, TYPE_INTEGER, "IiP"));
+	builtin_add(sx, U"fwrite_ints", U"фписать_целые", type_function(sx, TYPE_INTEGER, "IiP"));
+	builtin_add(sx, U"fgetline", U"фчитать_строку", type_function(sx, TYPE_INTEGER, "siP"));
 	builtin_add(sx, U"exit", U"выход", type_function(sx, TYPE_VOID, "i"));
 
 	builtin_add(sx, U"printf", U"печатьф", type_function(sx, TYPE_INTEGER, "s."));
@@ -229,54 +430,216 @@ static void ident_init(syntax *const sx)
 	builtin_add(sx, U"getid", U"читатьид", type_function(sx, TYPE_VOID, "."));
 }
 
+static inline void scope_restore(syntax *const sx)
+{
+	for (size_t i = vector_size(&sx->bindings); i > sx->cur_binding; i -= 2)
+	{
+		repr_set_reference(sx, (size_t)vector_at(&sx->bindings, i - 2), vector_at(&sx->bindings, i - 1));
+	}
+
+	vector_resize(&sx->bindings, sx->cur_binding);
+}
+
 static item_t type_get(const syntax *const sx, const size_t index)
 {
 	return sx != NULL ? vector_get(&sx->types, index) : ITEM_MAX;
 }
 
 
-/*
- *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
- *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
- *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
- *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
- *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
- */
-
-
-syntax sx_create(const workspace *const ws, universal_io *const io)
+static syntax sx_create_tables(universal_io *const io)
 {
 	syntax sx;
 	sx.io = io;
+	sx.src = source_create(io);
+	sx.memory = arena_create(ARENA_CHUNK_SIZE);
 
 	sx.string_literals = strings_create(STRINGS_SIZE);
 
-	sx.predef = vector_create(FUNCTIONS_SIZE);
-	sx.functions = vector_create(FUNCTIONS_SIZE);
+	sx.predef = vector_create_by_arena(sx.memory, FUNCTIONS_SIZE);
+	sx.functions = vector_create_by_arena(sx.memory, FUNCTIONS_SIZE);
 	vector_increase(&sx.functions, 2);
 
-	sx.tree = vector_create(TREE_SIZE);
+	sx.tree = vector_create_by_arena(sx.memory, TREE_SIZE);
 
-	sx.identifiers = vector_create(IDENTIFIERS_SIZE);
+	sx.identifiers = vector_create_by_arena(sx.memory, IDENTIFIERS_SIZE);
 	vector_increase(&sx.identifiers, 2);
 	sx.cur_id = 2;
 
-	sx.representations = map_create(REPRESENTATIONS_SIZE);
-	repr_init(&sx.representations);
+	sx.bindings = vector_create_by_arena(sx.memory, IDENTIFIERS_SIZE);
+	sx.cur_binding = 0;
 
-	sx.types = vector_create(TYPES_SIZE);
-	type_init(&sx);
+	sx.representations = map_create(REPRESENTATIONS_SIZE);
+	sx.occurrences = vector_create_by_arena(sx.memory, 0);
 
-	ident_init(&sx);
+	sx.types = vector_create_by_arena(sx.memory, TYPES_SIZE);
+	sx.type_flags = NULL;
+	sx.type_flags_alloc = 0;
+	sx.layouts = hash_create(TYPES_SIZE);
 
 	sx.max_displg = 3;
 	sx.ref_main = 0;
+	sx.initializer_amount = 0;
 
 	sx.max_displ = 3;
 	sx.displ = -3;
 	sx.lg = -1;
 
+	sx.is_optimized = false;
+	sx.is_lazy = false;
+	sx.is_checked_only = false;
+	sx.is_indexed = false;
+	sx.is_parallel = false;
+	return sx;
+}
+
+/** Build tables of keywords, base types and builtin functions shared by all compilations */
+static void builtins_init(void)
+{
+	builtins = sx_create_tables(NULL);
+	repr_init(&builtins.representations);
+	type_init(&builtins);
+	ident_init(&builtins);
+}
+
+/** Check if cross-reference index is requested by '--xref' or '--xref=<path>' flag */
+static bool xref_is_requested(const workspace *const ws)
+{
+	return ws_has_option(ws, OPT_XREF) || ws_get_flag_value(ws, XREF_FLAG) != NULL;
+}
+
+static inline void builtins_copy(vector *const dest, const vector *const src)
+{
+	vector_resize(dest, 0);
+	vector_append(dest, vector_data(src), vector_size(src));
+}
+
+
+static inline int snapshot_write(FILE *const file, const void *const data, const size_t size)
+{
+	return size == 0 || fwrite(data, 1, size, file) == size ? 0 : -1;
+}
+
+static inline int snapshot_read(FILE *const file, void *const data, const size_t size)
+{
+	return size == 0 || fread(data, 1, size, file) == size ? 0 : -1;
+}
+
+static int snapshot_write_size(FILE *const file, const size_t size)
+{
+	const uint64_t value = size;
+	return snapshot_write(file, &value, sizeof(value));
+}
+
+static size_t snapshot_read_size(FILE *const file)
+{
+	uint64_t value;
+	return !snapshot_read(file, &value, sizeof(value)) && value < SIZE_MAX ? (size_t)value : SIZE_MAX;
+}
+
+static int snapshot_write_vector(FILE *const file, const vector *const vec)
+{
+	const size_t size = vector_size(vec);
+	return snapshot_write_size(file, size) || snapshot_write(file, vector_data(vec), size * sizeof(item_t));
+}
+
+static int snapshot_read_vector(FILE *const file, vector *const vec)
+{
+	const size_t size = snapshot_read_size(file);
+	if (size == SIZE_MAX || vector_resize(vec, size))
+	{
+		return -1;
+	}
+
+	return snapshot_read(file, vector_data(vec), size * sizeof(item_t));
+}
+
+static int snapshot_write_string(FILE *const file, const char *const str, const size_t length)
+{
+	return snapshot_write_size(file, length) || snapshot_write(file, str, length);
+}
+
+static char *snapshot_read_string(FILE *const file, vector *const buffer)
+{
+	const size_t length = snapshot_read_size(file);
+	const size_t size = (length + sizeof(item_t)) / sizeof(item_t);
+	if (length == SIZE_MAX || vector_resize(buffer, size))
+	{
+		return NULL;
+	}
+
+	char *const str = (char *)vector_data(buffer);
+	str[length] = '\0';
+	return !snapshot_read(file, str, length) ? str : NULL;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+syntax sx_create(const workspace *const ws, universal_io *const io)
+{
+	syntax sx = sx_create_tables(io);
+
+#ifndef _WIN32
+	pthread_once(&builtins_once, &builtins_init);
+#else
+	if (builtins.memory == NULL)
+	{
+		builtins_init();
+	}
+#endif
+
+	map_clear(&sx.representations);
+	sx.representations = map_copy(&builtins.representations);
+
+	sx.type_table = vector_create_by_arena(sx.memory, vector_size(&builtins.type_table));
+	builtins_copy(&sx.predef, &builtins.predef);
+	builtins_copy(&sx.functions, &builtins.functions);
+	builtins_copy(&sx.identifiers, &builtins.identifiers);
+	builtins_copy(&sx.bindings, &builtins.bindings);
+	builtins_copy(&sx.types, &builtins.types);
+	builtins_copy(&sx.type_table, &builtins.type_table);
+
+	sx.type_flags = malloc(builtins.type_flags_alloc);
+	if (sx.type_flags != NULL)
+	{
+		memcpy(sx.type_flags, builtins.type_flags, builtins.type_flags_alloc);
+		sx.type_flags_alloc = builtins.type_flags_alloc;
+	}
+
+	sx.cur_id = builtins.cur_id;
+	sx.cur_binding = builtins.cur_binding;
+	sx.start_type = builtins.start_type;
+	sx.type_amount = builtins.type_amount;
+
 	sx.rprt = reporter_create(ws);
+	// При проверке синтаксиса нужны сообщения обо всём тексте, а не дерево для кодогенератора
+	sx.is_checked_only = ws_has_option(ws, OPT_SYNTAX_ONLY);
+	sx.is_optimized = ws_has_option(ws, OPT_O1) && !sx.is_checked_only;
+	// Индекс строится по всему тексту до кодогенерации
+	sx.is_indexed = xref_is_requested(ws);
+	if (sx.is_indexed)
+	{
+		sx.occurrences = vector_create_by_arena(sx.memory, OCCURRENCES_SIZE);
+	}
+
+	// Потоковая генерация есть только для LLVM, так как виртуальной машине нужна вся программа
+	sx.is_streaming = ws_has_option(ws, OPT_STREAM) && ws_has_option(ws, OPT_LLVM) && !sx.is_checked_only
+		&& !sx.is_indexed;
+	// Без компоновки любая функция может вызываться из других единиц трансляции
+	sx.is_lazy = ws_has_option(ws, OPT_LAZY) && !ws_has_option(ws, OPT_COMPILE_ONLY) && !sx.is_streaming
+		&& !sx.is_checked_only && !sx.is_indexed;
+	sx.is_parallel = ws_has_option(ws, OPT_PARALLEL);
+	if (sx.is_parallel)
+	{
+		scheduler_set_jobs(ws_get_jobs(ws));
+	}
 
 	return sx;
 }
@@ -314,24 +677,173 @@ int sx_clear(syntax *const sx)
 		return -1;
 	}
 
+	reporter_clear(&sx->rprt, sx->io);
+	source_clear(&sx->src);
+
 	strings_clear(&sx->string_literals);
+	map_clear(&sx->representations);
+	hash_clear(&sx->layouts);
+
+	free(sx->type_flags);
+	sx->type_flags = NULL;
+	sx->type_flags_alloc = 0;
+
+	arena_clear(sx->memory);
+	sx->memory = NULL;
+
+	return 0;
+}
+
 
-	vector_clear(&sx->predef);
-	vector_clear(&sx->functions);
+int sx_save(const syntax *const sx, const char *const path, const uint64_t key)
+{
+	if (sx == NULL || path == NULL)
+	{
+		return -1;
+	}
+
+	FILE *const file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		return -1;
+	}
 
-	vector_clear(&sx->tree);
+	const uint32_t item_size = sizeof(item_t);
+	const item_t scalars[] = { (item_t)sx->cur_id, (item_t)sx->start_type, (item_t)sx->type_amount
+		, sx->max_displ, sx->max_displg, (item_t)sx->ref_main, (item_t)sx->initializer_amount
+		, (item_t)sx->cur_binding, sx->displ, sx->lg };
+
+	int ret = snapshot_write(file, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC))
+		|| snapshot_write(file, &SNAPSHOT_VERSION, sizeof(SNAPSHOT_VERSION))
+		|| snapshot_write(file, &item_size, sizeof(item_size))
+		|| snapshot_write(file, &key, sizeof(key))
+		|| snapshot_write(file, scalars, sizeof(scalars))
+		|| snapshot_write_vector(file, &sx->predef)
+		|| snapshot_write_vector(file, &sx->functions)
+		|| snapshot_write_vector(file, &sx->tree)
+		|| snapshot_write_vector(file, &sx->identifiers)
+		|| snapshot_write_vector(file, &sx->bindings)
+		|| snapshot_write_vector(file, &sx->types)
+		|| snapshot_write_vector(file, &sx->type_table);
+
+	const size_t literals = strings_size(&sx->string_literals);
+	ret = ret || snapshot_write_size(file, literals);
+	for (size_t i = 0; i < literals && !ret; i++)
+	{
+		ret = snapshot_write_string(file, strings_get(&sx->string_literals, i), strings_get_length(&sx->string_literals, i));
+	}
+
+	const size_t reprs = sx->representations.values_size;
+	ret = ret || snapshot_write_size(file, reprs);
+	for (size_t i = 0; i < reprs && !ret; i++)
+	{
+		const char *const name = map_to_string(&sx->representations, i);
+		const item_t value = map_get_by_index(&sx->representations, i);
+		ret = snapshot_write_string(file, name, strlen(name)) || snapshot_write(file, &value, sizeof(value));
+	}
+
+	ret = fclose(file) || ret;
+	if (ret)
+	{
+		remove(path);
+	}
+
+	return ret ? -1 : 0;
+}
+
+int sx_load(syntax *const sx, const char *const path, const uint64_t key)
+{
+	if (sx == NULL || path == NULL)
+	{
+		return -1;
+	}
+
+	FILE *const file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	char magic[sizeof(SNAPSHOT_MAGIC)];
+	uint32_t version;
+	uint32_t item_size;
+	uint64_t saved;
+	if (snapshot_read(file, magic, sizeof(magic)) || memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0
+		|| snapshot_read(file, &version, sizeof(version)) || version != SNAPSHOT_VERSION
+		|| snapshot_read(file, &item_size, sizeof(item_size)) || item_size != sizeof(item_t)
+		|| snapshot_read(file, &saved, sizeof(saved)) || saved != key)
+	{
+		fclose(file);
+		return -1;
+	}
+
+	item_t scalars[10];
+	int ret = snapshot_read(file, scalars, sizeof(scalars))
+		|| snapshot_read_vector(file, &sx->predef)
+		|| snapshot_read_vector(file, &sx->functions)
+		|| snapshot_read_vector(file, &sx->tree)
+		|| snapshot_read_vector(file, &sx->identifiers)
+		|| snapshot_read_vector(file, &sx->bindings)
+		|| snapshot_read_vector(file, &sx->types)
+		|| snapshot_read_vector(file, &sx->type_table);
+
+	sx->cur_id = (size_t)scalars[0];
+	sx->start_type = (size_t)scalars[1];
+	sx->type_amount = (size_t)scalars[2];
+	sx->max_displ = scalars[3];
+	sx->max_displg = scalars[4];
+	sx->ref_main = (size_t)scalars[5];
+	sx->initializer_amount = (size_t)scalars[6];
+	sx->cur_binding = (size_t)scalars[7];
+	sx->displ = scalars[8];
+	sx->lg = scalars[9];
+
+	// Флаги классов не сохраняются, так как вычисляются по записям типов
+	for (size_t start = sx->start_type; !ret && start != 0; start = (size_t)vector_get(&sx->types, start))
+	{
+		ret = type_set_flags(sx, start + 1);
+	}
+
+	vector buffer = vector_create(MAX_STRING_LENGTH);
+
+	strings_clear(&sx->string_literals);
+	sx->string_literals = strings_create(STRINGS_SIZE);
+
+	const size_t literals = ret ? 0 : snapshot_read_size(file);
+	ret = ret || literals == SIZE_MAX;
+	for (size_t i = 0; i < literals && !ret; i++)
+	{
+		const char *const str = snapshot_read_string(file, &buffer);
+		ret = str == NULL || strings_intern(&sx->string_literals, str) != i;
+	}
 
-	vector_clear(&sx->identifiers);
-	vector_clear(&sx->types);
 	map_clear(&sx->representations);
+	sx->representations = map_create(REPRESENTATIONS_SIZE);
 
-	return 0;
+	const size_t reprs = ret ? 0 : snapshot_read_size(file);
+	ret = ret || reprs == SIZE_MAX;
+	for (size_t i = 0; i < reprs && !ret; i++)
+	{
+		const char *const name = snapshot_read_string(file, &buffer);
+		item_t value;
+		ret = name == NULL || snapshot_read(file, &value, sizeof(value))
+			|| map_add(&sx->representations, name, value) != i;
+	}
+
+	vector_clear(&buffer);
+	fclose(file);
+	return ret ? -1 : 0;
 }
 
 
 size_t string_add(syntax *const sx, const vector *const str)
 {
-	return strings_add_by_vector(&sx->string_literals, str);
+	return strings_intern_by_vector(&sx->string_literals, str);
+}
+
+size_t string_add_by_range(syntax *const sx, const char *const str, const size_t size)
+{
+	return strings_intern_by_range(&sx->string_literals, str, size);
 }
 
 const char* string_get(const syntax *const sx, const size_t index)
@@ -394,6 +906,8 @@ size_t ident_add(syntax *const sx, const size_t repr, const item_t kind, const i
 	{
 		// prev == 0 только для main, эту ссылку портить нельзя
 		// иначе это ссылка на текущее описание с этим представлением
+		vector_add(&sx->bindings, (item_t)repr);
+		vector_add(&sx->bindings, ref);
 		repr_set_reference(sx, repr, (item_t)last_id);
 	}
 
@@ -497,7 +1011,7 @@ int ident_set_displ(syntax *const sx, const size_t index, const item_t displ)
 	return sx != NULL ? vector_set(&sx->identifiers, index + 3, displ) : -1;
 }
 
-bool ident_is_type_specifier(syntax *const sx, const size_t index)
+bool ident_is_type_specifier(const syntax *const sx, const size_t index)
 {
 	return ident_get_displ(sx, index) >= 1000;
 }
@@ -507,6 +1021,21 @@ bool ident_is_local(const syntax *const sx, const size_t index)
 	return ident_get_displ(sx, index) > 0;
 }
 
+void ident_add_occurrence(syntax *const sx, const size_t index, const bool is_definition
+	, const size_t begin, const size_t end)
+{
+	// Неудачные описания в индекс не попадают
+	if (sx == NULL || !sx->is_indexed || index >= SIZE_MAX - 1)
+	{
+		return;
+	}
+
+	vector_add(&sx->occurrences, (item_t)index);
+	vector_add(&sx->occurrences, is_definition);
+	vector_add(&sx->occurrences, (item_t)begin);
+	vector_add(&sx->occurrences, (item_t)end);
+}
+
 
 item_t type_add(syntax *const sx, const item_t *const record, const size_t size)
 {
@@ -521,24 +1050,35 @@ item_t type_add(syntax *const sx, const item_t *const record, const size_t size)
 		vector_add(&sx->types, record[i]);
 	}
 
+	const size_t type = sx->start_type + 1;
+	if (type_set_flags(sx, type))
+	{
+		return ITEM_MAX;
+	}
+
+	if (size == 0 || record[0] == TYPE_ENUM)
+	{
+		// Перечисления различаются, даже если совпадают их поля
+		return (item_t)type;
+	}
+
 	// Checking mode duplicates
-	size_t old = (size_t)vector_get(&sx->types, sx->start_type);
-	while (old)
+	const size_t slot = type_find_slot(sx, type);
+	const item_t old = vector_at(&sx->type_table, slot);
+	if (old != 0)
 	{
-		if (type_is_equal(sx, sx->start_type + 1, old + 1))
-		{
-			const size_t start_type = sx->start_type;
-			sx->start_type = (size_t)vector_get(&sx->types, sx->start_type);
-			vector_resize(&sx->types, start_type);
-			return (item_t)old + 1;
-		}
-		else
-		{
-			old = (size_t)vector_get(&sx->types, old);
-		}
+		sx->start_type = (size_t)vector_get(&sx->types, sx->start_type);
+		vector_resize(&sx->types, type - 1);
+		return old;
 	}
 
-	return (item_t)sx->start_type + 1;
+	vector_put(&sx->type_table, slot, (item_t)type);
+	if (2 * ++sx->type_amount > vector_size(&sx->type_table))
+	{
+		type_grow_table(sx);
+	}
+
+	return (item_t)type;
 }
 
 item_t type_enum_add_fields(syntax *const sx, const item_t *const record, const size_t size)
@@ -584,7 +1124,7 @@ bool type_is_boolean(const item_t type)
 
 bool type_is_integer(const syntax *const sx, const item_t type)
 {
-	return type == TYPE_CHARACTER || type == TYPE_INTEGER || type_is_enum(sx, type) || type_is_enum_field(sx, type);
+	return (type_get_flags(sx, type) & FLAG_INTEGER) != 0;
 }
 
 bool type_is_floating(const item_t type)
@@ -594,7 +1134,7 @@ bool type_is_floating(const item_t type)
 
 bool type_is_arithmetic(const syntax *const sx, const item_t type)
 {
-	return type_is_integer(sx, type) || type_is_floating(type);
+	return (type_get_flags(sx, type) & (FLAG_INTEGER | FLAG_FLOATING)) != 0;
 }
 
 bool type_is_void(const item_t type)
@@ -609,12 +1149,17 @@ bool type_is_null_pointer(const item_t type)
 
 bool type_is_array(const syntax *const sx, const item_t type)
 {
-	return type > 0 && type_get(sx, (size_t)type) == TYPE_ARRAY;
+	return (type_get_flags(sx, type) & FLAG_ARRAY) != 0;
 }
 
 bool type_is_structure(const syntax *const sx, const item_t type)
 {
-	return type > 0 && type_get(sx, (size_t)type) == TYPE_STRUCTURE;
+	return (type_get_flags(sx, type) & FLAG_STRUCTURE) != 0;
+}
+
+bool type_is_vector(const syntax *const sx, const item_t type)
+{
+	return type > 0 && type_get(sx, (size_t)type) == TYPE_VECTOR;
 }
 
 bool type_is_enum(const syntax *const sx, const item_t type)
@@ -634,27 +1179,27 @@ bool type_is_function(const syntax *const sx, const item_t type)
 
 bool type_is_pointer(const syntax *const sx, const item_t type)
 {
-	return type > 0 && type_get(sx, (size_t)type) == TYPE_POINTER;
+	return (type_get_flags(sx, type) & FLAG_POINTER) != 0;
 }
 
 bool type_is_scalar(const syntax *const sx, const item_t type)
 {
-	return type_is_boolean(type) || type_is_integer(sx, type) || type_is_pointer(sx, type) || type_is_null_pointer(type);
+	return (type_get_flags(sx, type) & FLAG_SCALAR) != 0;
 }
 
 bool type_is_aggregate(const syntax *const sx, const item_t type)
 {
-	return type_is_array(sx, type) || type_is_structure(sx, type);
+	return (type_get_flags(sx, type) & (FLAG_ARRAY | FLAG_STRUCTURE)) != 0;
 }
 
 bool type_is_string(const syntax *const sx, const item_t type)
 {
-	return type_is_array(sx, type) && type_get(sx, (size_t)type + 1) == TYPE_CHARACTER;
+	return (type_get_flags(sx, type) & FLAG_STRING) != 0;
 }
 
 bool type_is_struct_pointer(const syntax *const sx, const item_t type)
 {
-	return type_is_pointer(sx, type) && type_is_structure(sx, type_get(sx, (size_t)type + 1));
+	return (type_get_flags(sx, type) & FLAG_STRUCT_POINTER) != 0;
 }
 
 bool type_is_file(const item_t type)
@@ -706,6 +1251,49 @@ item_t type_structure_get_member_type(const syntax *const sx, const item_t type,
 	return type_is_structure(sx, type) ? type_get(sx, (size_t)type + 3 + 2 * index) : ITEM_MAX;
 }
 
+size_t type_structure_get_member_offset(syntax *const sx, const item_t type, const size_t index)
+{
+	const size_t members = type_structure_get_member_amount(sx, type);
+	if (members == SIZE_MAX || index >= members)
+	{
+		return SIZE_MAX;
+	}
+
+	size_t layout = hash_get_index(&sx->layouts, type);
+	if (layout == SIZE_MAX)
+	{
+		layout = hash_add(&sx->layouts, type, members);
+
+		size_t displ = 0;
+		for (size_t i = 0; i < members; i++)
+		{
+			hash_set_by_index(&sx->layouts, layout, i, (item_t)displ);
+			displ += type_size(sx, type_structure_get_member_type(sx, type, i));
+		}
+	}
+
+	return (size_t)hash_get_by_index(&sx->layouts, layout, index);
+}
+
+
+item_t type_vector(syntax *const sx, const item_t type)
+{
+	// Вектор устроен как структура, поэтому копирование и доступ к полям общие
+	const size_t size = type_size(sx, type);
+	const size_t x = map_reserve(&sx->representations, "x");
+	const size_t y = map_reserve(&sx->representations, "y");
+	const size_t z = map_reserve(&sx->representations, "z");
+	const size_t w = map_reserve(&sx->representations, "w");
+
+	return type_add(sx, (item_t[]){ TYPE_VECTOR, (item_t)(4 * size), 8
+		, type, (item_t)x, type, (item_t)y, type, (item_t)z, type, (item_t)w }, 11);
+}
+
+item_t type_vector_get_element_type(const syntax *const sx, const item_t type)
+{
+	return type_is_vector(sx, type) ? type_get(sx, (size_t)type + 3) : ITEM_MAX;
+}
+
 
 item_t type_function_get_return_type(const syntax *const sx, const item_t type)
 {
@@ -750,12 +1338,14 @@ item_t get_enum_field_type(const syntax *const sx, const item_t type)
  *		s -> char[]
  *		S -> char[]*
  *		i -> int
+ *		p -> int*
  *		I -> int[]
  *		f -> float
  *		F -> float[]
  *		m -> msg_info
  *		P -> FILE*
  *		T -> void*(void*)
+ *		L -> void(int)
  *		. -> ...
  */
 item_t type_function(syntax *const sx, const item_t return_type, const char *const args)
@@ -790,6 +1380,9 @@ item_t type_function(syntax *const sx, const item_t return_type, const char *con
 				case 'i':
 					local_modetab[3 + i] = TYPE_INTEGER;
 					break;
+				case 'p':
+					local_modetab[3 + i] = type_pointer(sx, TYPE_INTEGER);
+					break;
 				case 'I':
 					local_modetab[3 + i] = type_array(sx, TYPE_INTEGER);
 					break;
@@ -808,6 +1401,9 @@ item_t type_function(syntax *const sx, const item_t return_type, const char *con
 				case 'T':
 					local_modetab[3 + i] = type_function(sx, type_pointer(sx, TYPE_VOID), "V");
 					break;
+				case 'L':
+					local_modetab[3 + i] = type_function(sx, TYPE_VOID, "i");
+					break;
 				case '.':
 					local_modetab[3 + i] = TYPE_VARARG;
 					break;
@@ -832,9 +1428,14 @@ bool type_is_undefined(const item_t type)
 }
 
 
-size_t repr_reserve(syntax *const sx, char32_t *const last)
+size_t repr_reserve(syntax *const sx, universal_io *const io, char32_t *const last)
 {
-	return map_reserve_by_io(&sx->representations, sx->io, last);
+	return map_reserve_by_io(&sx->representations, io, last);
+}
+
+size_t repr_reserve_by_span(syntax *const sx, const char *const spelling, const size_t size)
+{
+	return map_reserve_by_span(&sx->representations, spelling, size);
 }
 
 const char *repr_get_name(const syntax *const sx, const size_t index)
@@ -857,12 +1458,13 @@ scope scope_block_enter(syntax *const sx)
 {
 	if (sx == NULL)
 	{
-		return (scope){ ITEM_MAX, ITEM_MAX, SIZE_MAX };
+		return (scope){ ITEM_MAX, ITEM_MAX, SIZE_MAX, SIZE_MAX };
 	}
 
-	size_t prev_cur_id = sx->cur_id;
+	const scope scp = { sx->displ, sx->lg, sx->cur_id, sx->cur_binding };
 	sx->cur_id = vector_size(&sx->identifiers);
-	return (scope){ sx->displ, sx->lg, prev_cur_id };
+	sx->cur_binding = vector_size(&sx->bindings);
+	return scp;
 }
 
 int scope_block_exit(syntax *const sx, const scope scp)
@@ -872,15 +1474,12 @@ int scope_block_exit(syntax *const sx, const scope scp)
 		return -1;
 	}
 
-	for (size_t i = vector_size(&sx->identifiers) - 4; i >= sx->cur_id; i -= 4)
-	{
-		const item_t prev = ident_get_prev(sx, i);
-		repr_set_reference(sx, (size_t)ident_get_repr(sx, i), prev == ITEM_MAX - 1 ? ITEM_MAX : prev);
-	}
+	scope_restore(sx);
 
 	sx->displ = scp.displ;
 	sx->lg = scp.lg;
 	sx->cur_id = scp.cur_id;
+	sx->cur_binding = scp.cur_binding;
 	return 0;
 }
 
@@ -893,6 +1492,7 @@ item_t scope_func_enter(syntax *const sx)
 
 	const item_t displ = sx->displ;
 	sx->cur_id = vector_size(&sx->identifiers);
+	sx->cur_binding = vector_size(&sx->bindings);
 	sx->displ = 3;
 	sx->max_displ = 3;
 	sx->lg = 1;
@@ -907,19 +1507,48 @@ item_t scope_func_exit(syntax *const sx, const item_t displ)
 		return ITEM_MAX;
 	}
 
-	for (size_t i = vector_size(&sx->identifiers) - 4; i >= sx->cur_id; i -= 4)
-	{
-		const item_t prev = ident_get_prev(sx, i);
-		repr_set_reference(sx, (size_t)ident_get_repr(sx, i), prev == ITEM_MAX - 1 ? ITEM_MAX : prev);
-	}
+	scope_restore(sx);
 
 	sx->cur_id = 2;	// Все функции описываются на одном уровне
+	sx->cur_binding = 0;
 	sx->lg = -1;
 	sx->displ = displ;
 
 	return sx->max_displ;
 }
 
+size_t scope_global_get_mark(const syntax *const sx)
+{
+	return sx != NULL ? vector_size(&sx->bindings) : SIZE_MAX;
+}
+
+int scope_global_move(syntax *const sx, const size_t from, const size_t to)
+{
+	if (sx == NULL || from > vector_size(&sx->bindings) || to > vector_size(&sx->bindings))
+	{
+		return -1;
+	}
+
+	// Обмен сохранённой и текущей ссылок скрывает описание, повторный обмен возвращает его
+	for (size_t i = from; i > to; i -= 2)
+	{
+		const size_t repr = (size_t)vector_get(&sx->bindings, i - 2);
+		const item_t ref = repr_get_reference(sx, repr);
+		repr_set_reference(sx, repr, vector_get(&sx->bindings, i - 1));
+		vector_set(&sx->bindings, i - 1, ref);
+	}
+
+	for (size_t i = from; i < to; i += 2)
+	{
+		const size_t repr = (size_t)vector_get(&sx->bindings, i);
+		const item_t ref = repr_get_reference(sx, repr);
+		repr_set_reference(sx, repr, vector_get(&sx->bindings, i + 1));
+		vector_set(&sx->bindings, i + 1, ref);
+	}
+
+	return 0;
+}
+
 
 size_t strings_amount(const syntax *const sx)
 {
@@ -20,8 +20,10 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include "hash.h"
 #include "map.h"
 #include "reporter.h"
+#include "source.h"
 #include "strings.h"
 #include "tree.h"
 #include "vector.h"
@@ -53,6 +55,7 @@ typedef enum TYPE
 	TYPE_ARRAY,
 	TYPE_POINTER,
 	TYPE_ENUM,
+	TYPE_VECTOR,
 
 	BEGIN_USER_TYPE = 15,
 } type_t;
@@ -61,9 +64,12 @@ typedef enum TYPE
 /** Global vars definition */
 typedef struct syntax
 {
-	universal_io *io;			/**< Universal io structure */
+	universal_io *io;			/**< Universal io structure for output */
+	source src;					/**< Source text shared by readers */
 	reporter rprt;				/**< Reporter */
 
+	arena *memory;				/**< Arena of tables and temporary node vectors */
+
 	strings string_literals;	/**< String literals list */
 
 	vector predef;				/**< Predefined functions table */
@@ -74,11 +80,22 @@ typedef struct syntax
 	vector identifiers;			/**< Identifiers table */
 	size_t cur_id;				/**< Start of current scope in identifiers table */
 
+	vector bindings;			/**< Stack of shadowed references as pairs of representation and reference */
+	size_t cur_binding;			/**< Start of current scope in bindings stack */
+
 	vector types;				/**< Types table */
 	size_t start_type;			/**< Start of last record in types table */
+	vector type_table;			/**< Hash index from types content to type */
+	uint8_t *type_flags;		/**< Class flags of types by their offset, filled on adding type */
+	size_t type_flags_alloc;	/**< Allocated size of class flags */
+	size_t type_amount;			/**< Number of types in hash index */
+	hash layouts;				/**< Member displacements of structures, filled on demand */
 
 	map representations;		/**< Representations table */
 
+	vector occurrences;			/**< Occurrences of identifiers as records of identifier, flag of definition,
+									 beginning and end of range, filled only for cross-reference index */
+
 	item_t max_displ;			/**< Max displacement */
 	item_t max_displg;			/**< Max displacement */
 
@@ -86,6 +103,15 @@ typedef struct syntax
 	item_t lg;					/**< Displacement from l (+1) or g (-1) */
 
 	size_t ref_main;			/**< Main function reference */
+
+	size_t initializer_amount;	/**< Number of expressions in initializer lists, used to presize backend tables */
+
+	bool is_optimized;			/**< Set, if statements with constant conditions are pruned */
+	bool is_lazy;				/**< Set, if function bodies unreachable from main are not parsed */
+	bool is_streaming;			/**< Set, if code is generated right after each external declaration */
+	bool is_checked_only;		/**< Set, if only diagnostics are needed and tree is not passed to code generators */
+	bool is_indexed;			/**< Set, if occurrences of identifiers are recorded for cross-reference index */
+	bool is_parallel;			/**< Set, if large source text is lexed by several threads */
 } syntax;
 
 /** Scope */
@@ -94,6 +120,7 @@ typedef struct scope
 	item_t displ;
 	item_t lg;
 	size_t cur_id;
+	size_t cur_binding;
 } scope;
 
 
@@ -125,9 +152,32 @@ bool sx_is_correct(syntax *const sx);
  */
 int sx_clear(syntax *const sx);
 
+/**
+ *	Save tables and tree of parsed program to binary snapshot file
+ *
+ *	@param	sx				Syntax structure
+ *	@param	path			Snapshot file path
+ *	@param	key				Hash of input, from which structure was built
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int sx_save(const syntax *const sx, const char *const path, const uint64_t key);
 
 /**
- *	Add new dynamic UTF-8 string to string literal vector
+ *	Load tables and tree of parsed program from binary snapshot file.
+ *	Structure must be just created, on failure it must be recreated.
+ *
+ *	@param	sx				Syntax structure
+ *	@param	path			Snapshot file path
+ *	@param	key				Hash of current input
+ *
+ *	@return	@c 0 on success, @c -1 on failure or stale snapshot
+ */
+int sx_load(syntax *const sx, const char *const path, const uint64_t key);
+
+
+/**
+ *	Add new dynamic UTF-8 string to string literal vector, equal literals share index
  *
  *	@param	sx				Syntax structure
  *	@param	str				Dynamic UTF-8 string
@@ -136,6 +186,17 @@ int sx_clear(syntax *const sx);
  */
 size_t string_add(syntax *const sx, const vector *const str);
 
+/**
+ *	Add new string literal from range of UTF-8 characters, equal literals share index
+ *
+ *	@param	sx				Syntax structure
+ *	@param	str				Beginning of range
+ *	@param	size			Size of range
+ *
+ *	@return	Index, @c SIZE_MAX on failure
+ */
+size_t string_add_by_range(syntax *const sx, const char *const str, const size_t size);
+
 /**
  *	Get string
  *
@@ -319,7 +380,7 @@ int ident_set_displ(syntax *const sx, const size_t index, const item_t displ);
  *
  *	@return	@c 0 on true, @c 0 on false
  */
-bool ident_is_type_specifier(syntax *const sx, const size_t index);
+bool ident_is_type_specifier(const syntax *const sx, const size_t index);
 
 /**
  *	Check if identifier is local by index
@@ -331,6 +392,18 @@ bool ident_is_type_specifier(syntax *const sx, const size_t index);
  */
 bool ident_is_local(const syntax *const sx, const size_t index);
 
+/**
+ *	Record occurrence of identifier for cross-reference index, does nothing if index is not requested
+ *
+ *	@param	sx			Syntax structure
+ *	@param	index		Index of record in identifiers table
+ *	@param	is_definition	Set, if identifier is declared at this occurrence
+ *	@param	begin		Beginning of occurrence in source text
+ *	@param	end			End of occurrence in source text
+ */
+void ident_add_occurrence(syntax *const sx, const size_t index, const bool is_definition
+	, const size_t begin, const size_t end);
+
 
 /**
  *	Add a new record to types table
@@ -441,7 +514,7 @@ bool type_is_null_pointer(const item_t type);
 bool type_is_array(const syntax *const sx, const item_t type);
 
 /**
- *	Check if type is structure
+ *	Check if type is structure, vectors are structures with members x, y, z, w
  *
  *	@param	sx			Syntax structure
  *	@param	type		Type for check
@@ -450,6 +523,16 @@ bool type_is_array(const syntax *const sx, const item_t type);
  */
 bool type_is_structure(const syntax *const sx, const item_t type);
 
+/**
+ *	Check if type is vector
+ *
+ *	@param	sx			Syntax structure
+ *	@param	type		Type for check
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+bool type_is_vector(const syntax *const sx, const item_t type);
+
 /**
  *	Check if type is enum
  *
@@ -601,6 +684,37 @@ size_t type_structure_get_member_name(const syntax *const sx, const item_t type,
  */
 item_t type_structure_get_member_type(const syntax *const sx, const item_t type, const size_t index);
 
+/**
+ *	Get member displacement from the beginning of structure by index
+ *
+ *	@param	sx			Syntax structure
+ *	@param	type		Structure type
+ *	@param	index		Member number
+ *
+ *	@return	Member displacement, @c SIZE_MAX on failure
+ */
+size_t type_structure_get_member_offset(syntax *const sx, const item_t type, const size_t index);
+
+/**
+ *	Create vector type of four elements
+ *
+ *	@param	sx			Syntax structure
+ *	@param	type		Element type
+ *
+ *	@return	Vector type
+ */
+item_t type_vector(syntax *const sx, const item_t type);
+
+/**
+ *	Get element type
+ *
+ *	@param	sx			Syntax structure
+ *	@param	type		Vector type
+ *
+ *	@return	Element type, @c ITEM_MAX on failure
+ */
+item_t type_vector_get_element_type(const syntax *const sx, const item_t type);
+
 /**
  *	Get return type
  *
@@ -697,11 +811,23 @@ item_t type_pointer(syntax *const sx, const item_t type);
  *	Add a new record from io to representations table or return existing
  *
  *	@param	sx			Syntax structure
+ *	@param	io			Reader of source text
  *	@param	last		Next character after key
  *
  *	@return	Index of record, @c SIZE_MAX on failure
  */
-size_t repr_reserve(syntax *const sx, char32_t *const last);
+size_t repr_reserve(syntax *const sx, universal_io *const io, char32_t *const last);
+
+/**
+ *	Add a new record from spelling in source text to representations table or return existing
+ *
+ *	@param	sx			Syntax structure
+ *	@param	spelling	Spelling of identifier
+ *	@param	size		Size of spelling in bytes
+ *
+ *	@return	Index of record, @c SIZE_MAX on failure
+ */
+size_t repr_reserve_by_span(syntax *const sx, const char *const spelling, const size_t size);
 
 /**
  *	Get identifier name from representations table
@@ -773,6 +899,27 @@ item_t scope_func_enter(syntax *const sx);
  */
 item_t scope_func_exit(syntax *const sx, const item_t displ);
 
+/**
+ *	Get mark of global scope, which separates declarations made before and after it
+ *
+ *	@param	sx			Syntax structure
+ *
+ *	@return	Mark of global scope
+ */
+size_t scope_global_get_mark(const syntax *const sx);
+
+/**
+ *	Move visibility of global declarations from one mark to another,
+ *	declarations after the new mark become hidden
+ *
+ *	@param	sx			Syntax structure
+ *	@param	from		Current mark of visible declarations
+ *	@param	to			New mark of visible declarations
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int scope_global_move(syntax *const sx, const size_t from, const size_t to);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
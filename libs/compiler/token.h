@@ -47,9 +47,11 @@ typedef enum TOKEN
 	TK_FALSE,						/**< 'false' keyword */
 	TK_FILE,						/**< 'file' keyword */
 	TK_FLOAT,						/**< 'float' keyword */
+	TK_FLOAT4,						/**< 'float4' keyword */
 	TK_FOR,							/**< 'for' keyword */
 	TK_IF,							/**< 'if' keyword */
 	TK_INT,							/**< 'int' keyword */
+	TK_INT4,						/**< 'int4' keyword */
 	TK_LONG,						/**< 'long' keyword */
 	TK_NULL,						/**< 'null' keyword */
 	TK_RETURN,						/**< 'return' keyword */
@@ -0,0 +1,123 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Ilya Andreev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "visitor.h"
+
+
+static const size_t VISITOR_STACK_SIZE = 256;
+
+
+static inline int visitor_call(const visitor_func *const table, void *const context, const node *const nd)
+{
+	const item_t kind = node_get_type(nd);
+	if (kind < 0 || kind >= VISITOR_KINDS || table[kind] == NULL)
+	{
+		return 0;
+	}
+
+	return table[kind](context, nd);
+}
+
+static inline int visitor_enter(visitor *const vis, const node *const nd)
+{
+	const int result = visitor_call(vis->enter, vis->context, nd);
+	if (result == 0)
+	{
+		vector_add(&vis->stack, (item_t)nd->index);
+		vector_add(&vis->stack, 0);
+		return 0;
+	}
+
+	return result > 0 && visitor_call(vis->leave, vis->context, nd) >= 0 ? 0 : -1;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+visitor visitor_create(void *const context)
+{
+	visitor vis = { .context = context, .stack = vector_create(VISITOR_STACK_SIZE) };
+	return vis;
+}
+
+int visitor_set(visitor *const vis, const operation_t kind, const visitor_func enter, const visitor_func leave)
+{
+	if (vis == NULL || (size_t)kind >= VISITOR_KINDS)
+	{
+		return -1;
+	}
+
+	vis->enter[kind] = enter;
+	vis->leave[kind] = leave;
+	return 0;
+}
+
+int visitor_walk(visitor *const vis, const node *const nd)
+{
+	if (vis == NULL || !vector_is_correct(&vis->stack) || !node_is_correct(nd))
+	{
+		return -1;
+	}
+
+	const size_t bottom = vector_size(&vis->stack);
+	if (visitor_enter(vis, nd))
+	{
+		vector_resize(&vis->stack, bottom);
+		return -1;
+	}
+
+	while (vector_size(&vis->stack) > bottom)
+	{
+		const size_t top = vector_size(&vis->stack) - 2;
+		const node current = { nd->tree, (size_t)vector_at(&vis->stack, top) };
+		const size_t number = (size_t)vector_at(&vis->stack, top + 1);
+
+		if (number < node_get_amount(&current))
+		{
+			vector_put(&vis->stack, top + 1, (item_t)number + 1);
+
+			const node child = node_get_child(&current, number);
+			if (visitor_enter(vis, &child))
+			{
+				vector_resize(&vis->stack, bottom);
+				return -1;
+			}
+		}
+		else
+		{
+			vector_resize(&vis->stack, top);
+			if (visitor_call(vis->leave, vis->context, &current) < 0)
+			{
+				vector_resize(&vis->stack, bottom);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int visitor_clear(visitor *const vis)
+{
+	return vis != NULL ? vector_clear(&vis->stack) : -1;
+}
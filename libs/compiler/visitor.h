@@ -0,0 +1,98 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Ilya Andreev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "operations.h"
+#include "tree.h"
+#include "vector.h"
+
+
+#define VISITOR_KINDS	(OP_EMPTY_BOUND + 1)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Visitor callback
+ *
+ *	@param	context			User context
+ *	@param	nd				Current node
+ *
+ *	@return	@c 0 to continue traversal,
+ *			@c 1 to skip children of node, only for enter callback,
+ *			@c -1 to stop traversal
+ */
+typedef int (*visitor_func)(void *const context, const node *const nd);
+
+/** AST visitor */
+typedef struct visitor
+{
+	visitor_func enter[VISITOR_KINDS];	/**< Callbacks before children of node */
+	visitor_func leave[VISITOR_KINDS];	/**< Callbacks after children of node */
+
+	void *context;						/**< User context */
+
+	vector stack;						/**< Pairs of node index and next child number */
+} visitor;
+
+
+/**
+ *	Create AST visitor without callbacks
+ *
+ *	@param	context			User context
+ *
+ *	@return	AST visitor
+ */
+visitor visitor_create(void *const context);
+
+/**
+ *	Set callbacks for node kind
+ *
+ *	@param	vis				AST visitor
+ *	@param	kind			Node kind
+ *	@param	enter			Callback before children, @c NULL for none
+ *	@param	leave			Callback after children, @c NULL for none
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int visitor_set(visitor *const vis, const operation_t kind, const visitor_func enter, const visitor_func leave);
+
+/**
+ *	Traverse subtree in pre-order without recursion,
+ *	stack use does not depend on subtree depth
+ *
+ *	@param	vis				AST visitor
+ *	@param	nd				Root of subtree
+ *
+ *	@return	@c 0 on success, @c -1 on failure or stop
+ */
+int visitor_walk(visitor *const vis, const node *const nd);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	vis				AST visitor
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int visitor_clear(visitor *const vis);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
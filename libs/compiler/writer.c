@@ -15,16 +15,61 @@
  */
 
 #include "writer.h"
+#include <stdlib.h>
 #include <string.h>
 #include "AST.h"
+#include "commenter.h"
 #include "instructions.h"
-#include "locator.h"
 #include "uniprinter.h"
 
 
-#define MAX_ELEM_SIZE	32
 #define INDENT			"  "
 
+#define MAX_SEQUENCE_LENGTH		3
+#define MAX_SEQUENCE_REPORTED	32
+
+
+static const char *const DUMP_AST_FLAG = "--dump-ast=";
+static const char *const DUMP_VM_FLAG = "--dump-vm=";
+static const char *const XREF_FLAG = "--xref=";
+
+static const char *const DEFAULT_TREE = "tree.txt";
+static const char *const DEFAULT_TREE_BINARY = "tree.bin";
+static const char *const DEFAULT_CODES = "codes.txt";
+static const char *const DEFAULT_CODES_BINARY = "codes.bin";
+static const char *const DEFAULT_XREF = "xref.bin";
+
+static const char DUMP_TREE_MAGIC[4] = { 'R', 'u', 'C', 'T' };
+static const char DUMP_CODES_MAGIC[4] = { 'R', 'u', 'C', 'V' };
+static const char XREF_MAGIC[4] = { 'R', 'u', 'C', 'X' };
+static const uint32_t XREF_VERSION = 1;
+
+
+/** Kinds of symbols in cross-reference index */
+typedef enum xref_kind
+{
+	XREF_VARIABLE,
+	XREF_FUNCTION,
+	XREF_TYPE,
+	XREF_ENUM_CONSTANT,
+} xref_kind_t;
+
+/** Resolved location of occurrence */
+typedef struct xref_location
+{
+	size_t file;					/**< Index in files table */
+	size_t line;					/**< Line, counted from @c 1 */
+	size_t column;					/**< Column, counted from @c 1 */
+} xref_location;
+
+
+/** Sequence of instructions with its number of occurrences */
+typedef struct sequence
+{
+	uint64_t key;						/**< Packed instructions codes */
+	size_t count;						/**< Number of occurrences */
+} sequence;
+
 
 /** AST writer */
 typedef struct writer
@@ -32,6 +77,7 @@ typedef struct writer
 	const syntax *sx;					/**< Syntax structure */
 	universal_io *io;					/**< Output file */
 	size_t indent;						/**< Indentation count */
+	const comment_index *index;			/**< Index of location comments in code */
 } writer;
 
 
@@ -85,13 +131,9 @@ static inline void write_line(writer *const wrt, const char *const string)
  */
 static inline void write_location(writer *const wrt, const size_t io_index)
 {
-	const size_t prev_loc = in_get_position(wrt->sx->io);
-	in_set_position(wrt->sx->io, io_index);
-
-	const location loc = loc_search(wrt->sx->io);
-	in_set_position(wrt->sx->io, prev_loc);
-
-	uni_printf(wrt->io, "%zu:%zu", loc_get_line(&loc), loc_get_symbol(&loc));
+	// Каждый узел выводит две позиции, поэтому поиск назад до комментария заменён индексом
+	const comment cmt = cmt_index_search(wrt->index, io_index);
+	uni_printf(wrt->io, "%zu:%zu", cmt_get_line(&cmt), cmt_get_symbol(&cmt));
 }
 
 /**
@@ -349,7 +391,7 @@ static void write_literal_expression(writer *const wrt, const node *const nd)
 			break;
 
 		case TYPE_INTEGER:
-			uni_printf(wrt->io, "%" PRIitem, expression_literal_get_integer(nd));
+			uni_printf(wrt->io, "%" PRIi64, expression_literal_get_integer(nd));
 			break;
 
 		case TYPE_FLOATING:
@@ -555,6 +597,28 @@ static void write_initializer(writer *const wrt, const node *const nd)
 	write_expression_metadata(wrt, nd);
 
 	const size_t size = expression_initializer_get_size(nd);
+	if (expression_initializer_is_packed(nd))
+	{
+		const bool is_floating = type_is_floating(expression_initializer_get_literal_type(nd));
+
+		wrt->indent++;
+		write_line(wrt, "packed values");
+		for (size_t i = 0; i < size; i++)
+		{
+			if (is_floating)
+			{
+				uni_printf(wrt->io, " %f", expression_initializer_get_floating(nd, i));
+			}
+			else
+			{
+				uni_printf(wrt->io, " %" PRIi64, expression_initializer_get_integer(nd, i));
+			}
+		}
+		write(wrt, "\n");
+		wrt->indent--;
+		return;
+	}
+
 	for (size_t i = 0; i < size; i++)
 	{
 		const node subexpr = expression_initializer_get_subexpr(nd, i);
@@ -1123,964 +1187,364 @@ static void write_translation_unit(writer *const wrt, const node *const nd)
  */
 
 
-static size_t elem_get_name(const instruction_t elem, const size_t num, char *const buffer)
+/**
+ *	Write mnemonic of instruction, unknown instruction is written by its code
+ *
+ *	@param	io			Universal io structure
+ *	@param	type		Instruction
+ */
+static void write_instruction_name(universal_io *const io, const instruction_t type)
 {
-	if (buffer == NULL)
+	const instruction_info *const info = instruction_get_info(type);
+	if (info != NULL)
 	{
-		return 0;
+		uni_printf(io, "%s", info->name);
 	}
+	else
+	{
+		uni_printf(io, "%i", type);
+	}
+}
 
-	size_t argc = 0;
-	bool was_switch = false;
+static size_t write_instruction(universal_io *const io, const vector *const table, size_t i)
+{
+	const instruction_t type = (instruction_t)vector_get(table, i++);
+	write_instruction_name(io, type);
 
-	switch (elem)
+	if (type == IC_LID)
 	{
-		case IC_COPY01:
-			argc = 2;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY01");
-					break;
-				case 1:
-					sprintf(buffer, "displleft");
-					break;
-				case 2:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPY10:
-			argc = 2;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY10");
-					break;
-				case 1:
-					sprintf(buffer, "displright");
-					break;
-				case 2:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPY11:
-			argc = 1;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY11");
-					break;
-				case 1:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPY0ST:
-			argc = 2;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY0ST");
-					break;
-				case 1:
-					sprintf(buffer, "displleft");
-					break;
-				case 2:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPY1ST:
-			argc = 1;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY1ST");
-					break;
-				case 1:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPY0ST_ASSIGN:
-			argc = 2;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY0STASS");
-					break;
-				case 1:
-					sprintf(buffer, "displleft");
-					break;
-				case 2:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPY1ST_ASSIGN:
-			argc = 1;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY1STASS");
-					break;
-				case 1:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_COPYST:
-			argc = 3;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPYST");
-					break;
-				case 1:
-					sprintf(buffer, "displ");
-					break;
-				case 2:
-					sprintf(buffer, "length");
-					break;
-				case 3:
-					sprintf(buffer, "length1");
-					break;
-			}
-			break;
+		//uni_printf(io, " %f\n", vector_get_double(table, i));
 
-		case IC_CALL1:
-			sprintf(buffer, "CALL1");
-			break;
-		case IC_CALL2:
-			argc = 1;
-			sprintf(buffer, "CALL2");
-			break;
-		case IC_CREATE:
-			sprintf(buffer, "TCREATE");
-			break;
-		case IC_EXIT:
-			sprintf(buffer, "TEXIT");
-			break;
-		case IC_MSG_SEND:
-			sprintf(buffer, "TMSGSEND");
-			break;
-		case IC_MSG_RECEIVE:
-			sprintf(buffer, "TMSGRECEIVE");
-			break;
-		case IC_JOIN:
-			sprintf(buffer, "TJOIN");
-			break;
-		case IC_SLEEP:
-			sprintf(buffer, "TSLEEP");
-			break;
-		case IC_SEM_CREATE:
-			sprintf(buffer, "TSEMCREATE");
-			break;
-		case IC_SEM_WAIT:
-			sprintf(buffer, "TSEMWAIT");
-			break;
-		case IC_SEM_POST:
-			sprintf(buffer, "TSEMPOST");
-			break;
-		case IC_INIT:
-			sprintf(buffer, "INITC");
-			break;
-		case IC_DESTROY:
-			sprintf(buffer, "DESTROYC");
-			break;
-		case IC_GETNUM:
-			sprintf(buffer, "GETNUMC");
-			break;
+		const int64_t fst = (int64_t)vector_get(table, i) & 0x00000000ffffffff;
+		const int64_t snd = (int64_t)vector_get(table, i + 1) & 0x00000000ffffffff;
+		const int64_t num64 = (snd << 32) | fst;
 
-		case IC_PRINT:
-			argc = 1;
-			sprintf(buffer, "PRINT");
-			break;
-		case IC_PRINTID:
-			argc = 1;
-			sprintf(buffer, "PRINTID");
-			break;
-		case IC_PRINTF:
-			argc = 1;
-			sprintf(buffer, "PRINTF");
-			break;
-		case IC_GETID:
-			argc = 1;
-			sprintf(buffer, "GETID");
-			break;
+		double num;
+		memcpy(&num, &num64, sizeof(double));
+		uni_printf(io, " %f\n", num);
+		return i + 2;
+	}
 
-		case IC_ABS:
-			sprintf(buffer, "ABS");
-			break;
-		case IC_ABSI:
-			sprintf(buffer, "ABSI");
-			break;
-		case IC_SQRT:
-			sprintf(buffer, "SQRT");
-			break;
-		case IC_EXP:
-			sprintf(buffer, "EXP");
-			break;
-		case IC_SIN:
-			sprintf(buffer, "SIN");
-			break;
-		case IC_COS:
-			sprintf(buffer, "COS");
-			break;
-		case IC_LOG:
-			sprintf(buffer, "LOG");
-			break;
-		case IC_LOG10:
-			sprintf(buffer, "LOG10");
-			break;
-		case IC_ASIN:
-			sprintf(buffer, "ASIN");
-			break;
-		case IC_RAND:
-			sprintf(buffer, "RAND");
-			break;
-		case IC_ROUND:
-			sprintf(buffer, "ROUND");
-			break;
+	const instruction_info *const info = instruction_get_info(type);
+	const size_t argc = info != NULL ? info->argc : 0;
+	for (size_t j = 0; j < argc; j++)
+	{
+		if (info->operands[j] != NULL)
+		{
+			uni_printf(io, " %s=", info->operands[j]);
+		}
 
-		case IC_STRCPY:
-			sprintf(buffer, "STRCPY");
-			break;
-		case IC_STRNCPY:
-			sprintf(buffer, "STRNCPY");
-			break;
-		case IC_STRCAT:
-			sprintf(buffer, "STRCAT");
-			break;
-		case IC_STRNCAT:
-			sprintf(buffer, "STRNCAT");
-			break;
-		case IC_STRCMP:
-			sprintf(buffer, "STRCMP");
-			break;
-		case IC_STRNCMP:
-			sprintf(buffer, "STRNCMP");
-			break;
-		case IC_STRSTR:
-			sprintf(buffer, "STRSTR");
-			break;
-		case IC_STRLEN:
-			sprintf(buffer, "STRLENC");
-			break;
+		uni_printf(io, " %" PRIitem, vector_get(table, i++));
+	}
 
-		case IC_BEG_INIT:
-			argc = 1;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "BEGINIT");
-					break;
-				case 1:
-					sprintf(buffer, "n");
-					break;
-			}
-			break;
-		case IC_STRUCT_WITH_ARR:
-			argc = 2;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "STRUCTWITHARR");
-					break;
-				case 1:
-					sprintf(buffer, "displ");
-					break;
-				case 2:
-					sprintf(buffer, "iniproc");
-					break;
-			}
-			break;
-		case IC_DEFARR:
-			argc = 7;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "DEFARR");
-					break;
-				case 1:
-					sprintf(buffer, "N");
-					break;
-				case 2:
-					sprintf(buffer, "elem_len");
-					break;
-				case 3:
-					sprintf(buffer, "displ");
-					break;
-				case 4:
-					sprintf(buffer, "iniproc");
-					break;
-				case 5:
-					sprintf(buffer, "usual");
-					break;
-				case 6:
-					sprintf(buffer, "all");
-					break;
-				case 7:
-					sprintf(buffer, "instruct");
-					break;
-			}
-			break;
-		case IC_ARR_INIT:
-			argc = 4;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "ARRINIT");
-					break;
-				case 1:
-					sprintf(buffer, "N");
-					break;
-				case 2:
-					sprintf(buffer, "elem_len");
-					break;
-				case 3:
-					sprintf(buffer, "displ");
-					break;
-				case 4:
-					sprintf(buffer, "usual");
-					break;
-			}
-			break;
-		case IC_LI:
-			argc = 1;
-			sprintf(buffer, "LI");
-			break;
-		case IC_LID:
-			argc = 2;
-			sprintf(buffer, "LID");
-			break;
-		case IC_LOAD:
-			argc = 1;
-			sprintf(buffer, "LOAD");
-			break;
-		case IC_LOADD:
-			argc = 1;
-			sprintf(buffer, "LOADD");
-			break;
-		case IC_LAT:
-			sprintf(buffer, "L@");
-			break;
-		case IC_LATD:
-			sprintf(buffer, "L@f");
-			break;
-		case IC_LA:
-			argc = 1;
-			sprintf(buffer, "LA");
-			break;
+	uni_printf(io, "\n");
+	return i;
+}
 
-		case IC_STOP:
-			sprintf(buffer, "STOP");
-			break;
-		case IC_RETURN_VAL:
-			argc = 1;
-			sprintf(buffer, "RETURNVAL");
-			break;
-		case IC_RETURN_VOID:
-			sprintf(buffer, "RETURNVOID");
-			break;
-		case IC_B:
-			argc = 1;
-			sprintf(buffer, "B");
-			break;
-		case IC_BE0:
-			argc = 1;
-			sprintf(buffer, "BE0");
-			break;
-		case IC_BNE0:
-			argc = 1;
-			sprintf(buffer, "BNE0");
-			break;
-		case IC_SLICE:
-			argc = 1;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "SLICE");
-					break;
-				case 1:
-					sprintf(buffer, "d");
-					break;
-			}
-			break;
-		case IC_SELECT:
-			argc = 1;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "SELECT");
-					break;
-				case 1:
-					sprintf(buffer, "field_displ");
-					break;
-			}
-			break;
-		case IC_FUNC_BEG:
-			argc = 2;
-			was_switch = true;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "FUNCBEG");
-					break;
-				case 1:
-					sprintf(buffer, "maxdispl");
-					break;
-				case 2:
-					sprintf(buffer, "pc");
-					break;
-			}
-			break;
+static int sequence_compare_key(const void *const fst, const void *const snd)
+{
+	const uint64_t a = ((const sequence *)fst)->key;
+	const uint64_t b = ((const sequence *)snd)->key;
+	return a < b ? -1 : a > b ? 1 : 0;
+}
 
-		case IC_LOG_OR:
-			sprintf(buffer, "||");
-			break;
-		case IC_LOG_AND:
-			sprintf(buffer, "&&");
-			break;
+static int sequence_compare_count(const void *const fst, const void *const snd)
+{
+	const size_t a = ((const sequence *)fst)->count;
+	const size_t b = ((const sequence *)snd)->count;
+	return a > b ? -1 : a < b ? 1 : sequence_compare_key(fst, snd);
+}
 
-		case IC_OR_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "|=");
-			break;
-		case IC_OR_ASSIGN_AT:
-			sprintf(buffer, "|=@");
-			break;
-		case IC_OR_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "|=V");
-			break;
-		case IC_OR_ASSIGN_AT_V:
-			sprintf(buffer, "|=@V");
-			break;
-		case IC_OR:
-			sprintf(buffer, "|");
-			break;
+/**
+ *	Get path of dump from flags
+ *
+ *	@param	ws			Compiler workspace
+ *	@param	option		Flag, which enables dump with default path
+ *	@param	flag		Prefix of flag with dump path
+ *	@param	path		Default path
+ *
+ *	@return	Path of dump, @c NULL if dump is not requested
+ */
+static const char *dump_get_path(const workspace *const ws, const option_t option, const char *const flag
+	, const char *const path)
+{
+	const char *const value = ws_get_flag_value(ws, flag);
+	if (value != NULL)
+	{
+		return value;
+	}
 
-		case IC_XOR_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "^=");
-			break;
-		case IC_XOR_ASSIGN_AT:
-			sprintf(buffer, "^=@");
-			break;
-		case IC_XOR_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "^=V");
-			break;
-		case IC_XOR_ASSIGN_AT_V:
-			sprintf(buffer, "^=@V");
-			break;
-		case IC_XOR:
-			sprintf(buffer, "^");
-			break;
+	return ws_has_option(ws, option) ? path : NULL;
+}
 
-		case IC_AND_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "&=");
-			break;
-		case IC_AND_ASSIGN_AT:
-			sprintf(buffer, "&=@");
-			break;
-		case IC_AND_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "&=V");
-			break;
-		case IC_AND_ASSIGN_AT_V:
-			sprintf(buffer, "&=@V");
-			break;
-		case IC_AND:
-			sprintf(buffer, "&");
-			break;
+/**
+ *	Write table in compact binary form: magic, size of item, number of items and items themselves
+ *
+ *	@param	path		File path
+ *	@param	magic		Magic of dump kind
+ *	@param	table		Table
+ */
+static void write_binary(const char *const path, const char *const magic, const vector *const table)
+{
+	FILE *const file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		return;
+	}
 
-		case IC_EQ:
-			sprintf(buffer, "==");
-			break;
-		case IC_NE:
-			sprintf(buffer, "!=");
-			break;
-		case IC_LT:
-			sprintf(buffer, "<");
-			break;
-		case IC_GT:
-			sprintf(buffer, ">");
-			break;
-		case IC_LE:
-			sprintf(buffer, "<=");
-			break;
-		case IC_GE:
-			sprintf(buffer, ">=");
-			break;
-		case IC_EQ_R:
-			sprintf(buffer, "==f");
-			break;
-		case IC_NE_R:
-			sprintf(buffer, "!=f");
-			break;
-		case IC_LT_R:
-			sprintf(buffer, "<f");
-			break;
-		case IC_GT_R:
-			sprintf(buffer, ">f");
-			break;
-		case IC_LE_R:
-			sprintf(buffer, "<=f");
-			break;
-		case IC_GE_R:
-			sprintf(buffer, ">=f");
-			break;
+	const uint32_t item_size = sizeof(item_t);
+	const uint64_t size = vector_size(table);
+	fwrite(magic, sizeof(char), 4, file);
+	fwrite(&item_size, sizeof(item_size), 1, file);
+	fwrite(&size, sizeof(size), 1, file);
+	fwrite(vector_data(table), sizeof(item_t), (size_t)size, file);
+	fclose(file);
+}
 
-		case IC_SHR_ASSIGN:
-			argc = 1;
-			sprintf(buffer, ">>=");
-			break;
-		case IC_SHR_ASSIGN_AT:
-			sprintf(buffer, ">>=@");
-			break;
-		case IC_SHR_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, ">>=V");
-			break;
-		case IC_SHR_ASSIGN_AT_V:
-			sprintf(buffer, ">>=@V");
-			break;
-		case IC_SHR:
-			sprintf(buffer, ">>");
-			break;
+/**
+ *	Write the most frequent sequences of instructions
+ *
+ *	@param	io			Universal io structure
+ *	@param	codes		Instructions codes, @c 0 breaks sequence
+ *	@param	size		Number of instructions codes
+ *	@param	length		Length of sequences
+ */
+static void write_sequences(universal_io *const io, const instruction_t *const codes, const size_t size, const size_t length)
+{
+	sequence *const sequences = malloc(size * sizeof(sequence));
+	if (sequences == NULL)
+	{
+		return;
+	}
 
-		case IC_SHL_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "<<=");
-			break;
-		case IC_SHL_ASSIGN_AT:
-			sprintf(buffer, "<<=@");
-			break;
-		case IC_SHL_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "<<=V");
-			break;
-		case IC_SHL_ASSIGN_AT_V:
-			sprintf(buffer, "<<=@V");
-			break;
-		case IC_SHL:
-			sprintf(buffer, "<<");
-			break;
+	const uint64_t base = MAX_INSTRUCTION_CODE - MIN_INSTRUCTION_CODE;
+	size_t amount = 0;
+	for (size_t i = 0; i + length <= size; i++)
+	{
+		uint64_t key = 0;
+		size_t j = 0;
+		while (j < length && codes[i + j] != 0)
+		{
+			key = key * base + (uint64_t)(codes[i + j] - MIN_INSTRUCTION_CODE);
+			j++;
+		}
 
-		case IC_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "=");
-			break;
-		case IC_ASSIGN_AT:
-			sprintf(buffer, "=@");
-			break;
-		case IC_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "=V");
-			break;
-		case IC_ASSIGN_AT_V:
-			sprintf(buffer, "=@V");
-			break;
+		if (j == length)
+		{
+			sequences[amount++] = (sequence){ .key = key, .count = 1 };
+		}
+	}
 
-		case IC_ADD_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "+=");
-			break;
-		case IC_ADD_ASSIGN_AT:
-			sprintf(buffer, "+=@");
-			break;
-		case IC_ADD_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "+=V");
-			break;
-		case IC_ADD_ASSIGN_AT_V:
-			sprintf(buffer, "+=@V");
-			break;
-		case IC_ADD:
-			sprintf(buffer, "+");
-			break;
+	// Одинаковые последовательности после сортировки идут подряд
+	qsort(sequences, amount, sizeof(sequence), &sequence_compare_key);
+	size_t unique = 0;
+	for (size_t i = 0; i < amount; i++)
+	{
+		if (unique != 0 && sequences[unique - 1].key == sequences[i].key)
+		{
+			sequences[unique - 1].count++;
+		}
+		else
+		{
+			sequences[unique++] = sequences[i];
+		}
+	}
 
-		case IC_SUB_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "-=");
-			break;
-		case IC_SUB_ASSIGN_AT:
-			sprintf(buffer, "-=@");
-			break;
-		case IC_SUB_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "-=V");
-			break;
-		case IC_SUB_ASSIGN_AT_V:
-			sprintf(buffer, "-=@V");
-			break;
-		case IC_SUB:
-			sprintf(buffer, "-");
-			break;
+	qsort(sequences, unique, sizeof(sequence), &sequence_compare_count);
+	uni_printf(io, "sequences of %zu instructions\n", length);
+	for (size_t i = 0; i < unique && i < MAX_SEQUENCE_REPORTED; i++)
+	{
+		uni_printf(io, "%zu)", sequences[i].count);
 
-		case IC_MUL_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "*=");
-			break;
-		case IC_MUL_ASSIGN_AT:
-			sprintf(buffer, "*=@");
-			break;
-		case IC_MUL_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "*=V");
-			break;
-		case IC_MUL_ASSIGN_AT_V:
-			sprintf(buffer, "*=@V");
-			break;
-		case IC_MUL:
-			sprintf(buffer, "*");
-			break;
+		uint64_t divisor = 1;
+		for (size_t j = 1; j < length; j++)
+		{
+			divisor *= base;
+		}
 
-		case IC_DIV_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "/=");
-			break;
-		case IC_DIV_ASSIGN_AT:
-			sprintf(buffer, "/=@");
-			break;
-		case IC_DIV_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "/=V");
-			break;
-		case IC_DIV_ASSIGN_AT_V:
-			sprintf(buffer, "/=@V");
-			break;
-		case IC_DIV:
-			sprintf(buffer, "/");
-			break;
+		for (; divisor != 0; divisor /= base)
+		{
+			const instruction_t type = (instruction_t)((sequences[i].key / divisor) % base) + MIN_INSTRUCTION_CODE;
 
-		case IC_ASSIGN_R:
-			argc = 1;
-			sprintf(buffer, "=f");
-			break;
-		case IC_ASSIGN_R_V:
-			argc = 1;
-			sprintf(buffer, "=fV");
-			break;
-		case IC_ASSIGN_AT_R:
-			sprintf(buffer, "=@f");
-			break;
-		case IC_ASSIGN_AT_R_V:
-			sprintf(buffer, "=@fV");
-			break;
+			uni_printf(io, " ");
+			write_instruction_name(io, type);
+		}
 
-		case IC_ADD_ASSIGN_R:
-			argc = 1;
-			sprintf(buffer, "+=f");
-			break;
-		case IC_ADD_ASSIGN_AT_R:
-			sprintf(buffer, "+=@f");
-			break;
-		case IC_ADD_ASSIGN_R_V:
-			argc = 1;
-			sprintf(buffer, "+=fV");
-			break;
-		case IC_ADD_ASSIGN_AT_R_V:
-			sprintf(buffer, "+=@fV");
-			break;
-		case IC_ADD_R:
-			sprintf(buffer, "+f");
-			break;
+		uni_printf(io, "\n");
+	}
 
-		case IC_SUB_ASSIGN_R:
-			argc = 1;
-			sprintf(buffer, "-=f");
-			break;
-		case IC_SUB_ASSIGN_AT_R:
-			sprintf(buffer, "-=@f");
-			break;
-		case IC_SUB_ASSIGN_R_V:
-			argc = 1;
-			sprintf(buffer, "-=fV");
-			break;
-		case IC_SUB_ASSIGN_AT_R_V:
-			sprintf(buffer, "-=@fV");
-			break;
-		case IC_SUB_R:
-			sprintf(buffer, "-f");
-			break;
+	uni_printf(io, "\n");
+	free(sequences);
+}
 
-		case IC_MUL_ASSIGN_R:
-			argc = 1;
-			sprintf(buffer, "*=f");
-			break;
-		case IC_MUL_ASSIGN_AT_R:
-			sprintf(buffer, "*=@f");
-			break;
-		case IC_MUL_ASSIGN_R_V:
-			argc = 1;
-			sprintf(buffer, "*=fV");
-			break;
-		case IC_MUL_ASSIGN_AT_R_V:
-			sprintf(buffer, "*=@fV");
-			break;
-		case IC_MUL_R:
-			sprintf(buffer, "*f");
-			break;
+static void write_unsigned(FILE *const file, uint64_t value)
+{
+	// Беззнаковое LEB128: по семь бит, старший бит означает продолжение
+	do
+	{
+		const uint8_t byte = (uint8_t)(value & 0x7F);
+		value >>= 7;
+		fputc(value != 0 ? byte | 0x80 : byte, file);
+	} while (value != 0);
+}
 
-		case IC_DIV_ASSIGN_R:
-			argc = 1;
-			sprintf(buffer, "/=f");
-			break;
-		case IC_DIV_ASSIGN_AT_R:
-			sprintf(buffer, "/=@f");
-			break;
-		case IC_DIV_ASSIGN_R_V:
-			argc = 1;
-			sprintf(buffer, "/=fV");
-			break;
-		case IC_DIV_ASSIGN_AT_R_V:
-			sprintf(buffer, "/=@fV");
-			break;
-		case IC_DIV_R:
-			sprintf(buffer, "/f");
-			break;
+static inline void write_signed(FILE *const file, const int64_t value)
+{
+	write_unsigned(file, value < 0 ? ~((uint64_t)value << 1) : (uint64_t)value << 1);
+}
 
-		case IC_REM_ASSIGN:
-			argc = 1;
-			sprintf(buffer, "%%=");
-			break;
-		case IC_REM_ASSIGN_AT:
-			sprintf(buffer, "%%=@");
-			break;
-		case IC_REM_ASSIGN_V:
-			argc = 1;
-			sprintf(buffer, "%%=V");
-			break;
-		case IC_REM_ASSIGN_AT_V:
-			sprintf(buffer, "%%=@V");
-			break;
-		case IC_REM:
-			sprintf(buffer, "%%");
-			break;
-		case IC_POST_INC:
-			argc = 1;
-			sprintf(buffer, "POSTINC");
-			break;
-		case IC_POST_DEC:
-			argc = 1;
-			sprintf(buffer, "POSTDEC");
-			break;
-		case IC_PRE_INC_AT:
-			sprintf(buffer, "INC@");
-			break;
-		case IC_PRE_DEC_AT:
-			sprintf(buffer, "DEC@");
-			break;
-		case IC_POST_INC_AT:
-			sprintf(buffer, "POSTINC@");
-			break;
-		case IC_POST_DEC_AT:
-			sprintf(buffer, "POSTDEC@");
-			break;
-		case IC_PRE_INC_R:
-			argc = 1;
-			sprintf(buffer, "INCf");
-			break;
-		case IC_PRE_DEC_R:
-			argc = 1;
-			sprintf(buffer, "DECf");
-			break;
-		case IC_POST_INC_R:
-			argc = 1;
-			sprintf(buffer, "POSTINCf");
-			break;
-		case IC_POST_DEC_R:
-			argc = 1;
-			sprintf(buffer, "POSTDECf");
-			break;
-		case IC_PRE_INC_AT_R:
-			sprintf(buffer, "INC@f");
-			break;
-		case IC_PRE_DEC_AT_R:
-			sprintf(buffer, "DEC@f");
-			break;
-		case IC_POST_INC_AT_R:
-			sprintf(buffer, "POSTINC@f");
-			break;
-		case IC_POST_DEC_AT_R:
-			sprintf(buffer, "POSTDEC@f");
-			break;
-		case IC_PRE_INC_V:
-			argc = 1;
-			sprintf(buffer, "INCV");
-			break;
-		case IC_PRE_DEC_V:
-			argc = 1;
-			sprintf(buffer, "DECV");
-			break;
-		case IC_POST_INC_V:
-			argc = 1;
-			sprintf(buffer, "POSTINCV");
-			break;
-		case IC_POST_DEC_V:
-			argc = 1;
-			sprintf(buffer, "POSTDECV");
-			break;
-		case IC_PRE_INC_AT_V:
-			sprintf(buffer, "INC@V");
-			break;
-		case IC_PRE_DEC_AT_V:
-			sprintf(buffer, "DEC@V");
-			break;
-		case IC_POST_INC_AT_V:
-			sprintf(buffer, "POSTINC@V");
-			break;
-		case IC_POST_DEC_AT_V:
-			sprintf(buffer, "POSTDEC@V");
-			break;
-		case IC_PRE_INC_R_V:
-			argc = 1;
-			sprintf(buffer, "INCfV");
-			break;
-		case IC_PRE_DEC_R_V:
-			argc = 1;
-			sprintf(buffer, "DECfV");
-			break;
-		case IC_POST_INC_R_V:
-			argc = 1;
-			sprintf(buffer, "POSTINCfV");
-			break;
-		case IC_POST_DEC_R_V:
-			argc = 1;
-			sprintf(buffer, "POSTDECfV");
-			break;
-		case IC_PRE_INC_AT_R_V:
-			sprintf(buffer, "INC@fV");
-			break;
-		case IC_PRE_DEC_AT_R_V:
-			sprintf(buffer, "DEC@fV");
-			break;
-		case IC_POST_INC_AT_R_V:
-			sprintf(buffer, "POSTINC@fV");
-			break;
-		case IC_POST_DEC_AT_R_V:
-			sprintf(buffer, "POSTDEC@fV");
-			break;
-		case IC_NOP:
-			sprintf(buffer, "NOP");
-			break;
-		case IC_WIDEN:
-			sprintf(buffer, "WIDEN");
-			break;
-		case IC_WIDEN1:
-			sprintf(buffer, "WIDEN1");
-			break;
-		case IC_DUPLICATE:
-			sprintf(buffer, "DUPLICATE");
-			break;
-		case IC_COPY00:
-			argc = 3;
-			was_switch = 1;
-			switch (num)
-			{
-				case 0:
-					sprintf(buffer, "COPY00");
-					break;
-				case 1:
-					sprintf(buffer, "displleft");
-					break;
-				case 2:
-					sprintf(buffer, "displright");
-					break;
-				case 3:
-					sprintf(buffer, "length");
-					break;
-			}
-			break;
-		case IC_PRE_INC:
-			argc = 1;
-			sprintf(buffer, "INC");
-			break;
-		case IC_PRE_DEC:
-			argc = 1;
-			sprintf(buffer, "DEC");
-			break;
-		case IC_NOT:
-			sprintf(buffer, "BITNOT");
-			break;
-		case IC_LOG_NOT:
-			sprintf(buffer, "NOT");
-			break;
+static void write_xref_string(FILE *const file, const char *const str)
+{
+	const size_t length = strlen(str);
+	write_unsigned(file, length);
+	fwrite(str, sizeof(char), length, file);
+}
 
-		case IC_UNMINUS:
-			sprintf(buffer, "UNMINUS");
-			break;
-		case IC_UNMINUS_R:
-			sprintf(buffer, "UNMINUSf");
-			break;
-		default:
-			sprintf(buffer, "%i", elem);
-			break;
+static xref_kind_t xref_get_kind(const syntax *const sx, const size_t id)
+{
+	const item_t type = ident_get_type(sx, id);
+	if (ident_is_type_specifier(sx, id))
+	{
+		return XREF_TYPE;
+	}
+	else if (type_is_enum_field(sx, type))
+	{
+		return XREF_ENUM_CONSTANT;
 	}
 
-	if ((num != 0 && !was_switch) || argc < num)
+	// У функций в поле displ номер, у параметров-функций смещение в кадре
+	return type_is_function(sx, type) && ident_get_displ(sx, id) > 0 ? XREF_FUNCTION : XREF_VARIABLE;
+}
+
+/**
+ *	Resolve locations of occurrences to files, lines and columns
+ *
+ *	@param	sx			Syntax structure
+ *	@param	files		Paths of files in order of first occurrence
+ *	@param	locations	Resolved locations of occurrences
+ */
+static void xref_resolve(const syntax *const sx, strings *const files, xref_location *const locations)
+{
+	const size_t amount = vector_size(&sx->occurrences) / 4;
+	map lookup = map_create(16);
+
+	char path[MAX_ARG_SIZE];
+	for (size_t i = 0; i < amount; i++)
 	{
-		buffer[0] = '\0';
+		const size_t begin = (size_t)vector_get(&sx->occurrences, 4 * i + 2);
+		const comment cmt = source_search(&sx->src, begin);
+		if (cmt_get_path(&cmt, path) == 0)
+		{
+			sprintf(path, "%s", source_get_path(&sx->src));
+		}
+
+		item_t file = map_get(&lookup, path);
+		if (file == ITEM_MAX)
+		{
+			file = (item_t)strings_size(files);
+			strings_add(files, path);
+			map_add(&lookup, path, file);
+		}
+
+		locations[i].file = (size_t)file;
+		locations[i].line = cmt_get_line(&cmt);
+		locations[i].column = cmt_get_column(&cmt);
 	}
-	return argc;
+
+	map_clear(&lookup);
 }
 
-static size_t write_instruction(universal_io *const io, const vector *const table, size_t i)
+/**
+ *	Write cross-reference index: magic, version, table of files and symbols,
+ *	each symbol is name, kind, type and its occurrences with flag of definition, file, line, column and length.
+ *	All numbers after version are LEB128, type is signed.
+ *
+ *	@param	path		File path
+ *	@param	sx			Syntax structure
+ */
+static void write_xref(const char *const path, const syntax *const sx)
 {
-	const instruction_t type = (instruction_t)vector_get(table, i++);
+	const size_t amount = vector_size(&sx->occurrences) / 4;
+	const size_t identifiers = vector_size(&sx->identifiers);
+
+	// Вхождения группируются по идентификаторам подсчётом, порядок внутри группы как в тексте
+	size_t *const offsets = calloc(identifiers + 1, sizeof(size_t));
+	size_t *const order = malloc((amount + 1) * sizeof(size_t));
+	xref_location *const locations = malloc((amount + 1) * sizeof(xref_location));
+	FILE *const file = offsets != NULL && order != NULL && locations != NULL ? fopen(path, "wb") : NULL;
+	if (file == NULL)
+	{
+		free(offsets);
+		free(order);
+		free(locations);
+		return;
+	}
 
-	char buffer[MAX_ELEM_SIZE];
-	size_t argc = elem_get_name(type, 0, buffer);
-	uni_printf(io, "%s", buffer);
+	size_t symbols = 0;
+	for (size_t i = 0; i < amount; i++)
+	{
+		const size_t id = (size_t)vector_get(&sx->occurrences, 4 * i);
+		symbols += offsets[id + 1]++ == 0 ? 1 : 0;
+	}
 
-	if (type == IC_LID)
+	for (size_t id = 0; id < identifiers; id++)
 	{
-		//uni_printf(io, " %f\n", vector_get_double(table, i));
+		offsets[id + 1] += offsets[id];
+	}
 
-		const int64_t fst = (int64_t)vector_get(table, i) & 0x00000000ffffffff;
-		const int64_t snd = (int64_t)vector_get(table, i + 1) & 0x00000000ffffffff;
-		const int64_t num64 = (snd << 32) | fst;
+	for (size_t i = 0; i < amount; i++)
+	{
+		const size_t id = (size_t)vector_get(&sx->occurrences, 4 * i);
+		order[offsets[id]++] = i;
+	}
 
-		double num;
-		memcpy(&num, &num64, sizeof(double));
-		uni_printf(io, " %f\n", num);
-		return i + 2;
+	strings files = strings_create(16);
+	xref_resolve(sx, &files, locations);
+
+	fwrite(XREF_MAGIC, sizeof(char), 4, file);
+	fwrite(&XREF_VERSION, sizeof(XREF_VERSION), 1, file);
+
+	write_unsigned(file, strings_size(&files));
+	for (size_t i = 0; i < strings_size(&files); i++)
+	{
+		write_xref_string(file, strings_get(&files, i));
 	}
 
-	for (size_t j = 1; j <= argc; j++)
+	// После раскладки offsets[id] указывает на конец группы
+	write_unsigned(file, symbols);
+	size_t begin = 0;
+	for (size_t id = 0; id < identifiers; id++)
 	{
-		elem_get_name(type, j, buffer);
+		const size_t end = offsets[id];
+		if (end == begin)
+		{
+			continue;
+		}
+
+		write_xref_string(file, repr_get_name(sx, (size_t)llabs(ident_get_repr(sx, id))));
+		write_unsigned(file, xref_get_kind(sx, id));
+		write_signed(file, ident_get_type(sx, id));
+		write_unsigned(file, end - begin);
 
-		if (buffer[0] != '\0')
+		for (size_t j = begin; j < end; j++)
 		{
-			uni_printf(io, " %s=", buffer);
+			const size_t i = order[j];
+			const item_t *const record = &vector_data(&sx->occurrences)[4 * i];
+			write_unsigned(file, (uint64_t)record[1]);
+			write_unsigned(file, locations[i].file);
+			write_unsigned(file, locations[i].line);
+			write_unsigned(file, locations[i].column);
+			write_unsigned(file, (uint64_t)(record[3] - record[2]));
 		}
 
-		uni_printf(io, " %" PRIitem, vector_get(table, i++));
+		begin = end;
 	}
 
-	uni_printf(io, "\n");
-	return i;
+	fclose(file);
+	strings_clear(&files);
+	free(offsets);
+	free(order);
+	free(locations);
 }
 
 
@@ -2101,7 +1565,7 @@ void write_tree(const char *const path, syntax *const sx)
 		return;
 	}
 
-	writer wrt = { .sx = sx, .io = &io };
+	writer wrt = { .sx = sx, .io = &io, .index = source_get_index(&sx->src) };
 
 	const node root = node_get_root(&sx->tree);
 	write_translation_unit(&wrt, &root);
@@ -2182,6 +1646,12 @@ int write_type_spelling(const syntax *const sx, const item_t type, char *const b
 			return index;
 		}
 
+		case TYPE_VECTOR:
+		{
+			const item_t element_type = type_vector_get_element_type(sx, type);
+			return sprintf(buffer, type_is_floating(element_type) ? "float4" : "int4");
+		}
+
 		case TYPE_ARRAY:
 		{
 			const item_t element_type = type_array_get_element_type(sx, type);
@@ -2221,3 +1691,94 @@ void write_codes(const char *const path, const vector *const memory)
 
 	io_erase(&io);
 }
+
+void write_profile(const char *const path, const vector *const memory)
+{
+	universal_io io = io_create();
+	if (path == NULL || !vector_is_correct(memory) || out_set_file(&io, path))
+	{
+		return;
+	}
+
+	const size_t size = vector_size(memory);
+	instruction_t *const codes = malloc(size * sizeof(instruction_t));
+	if (codes == NULL)
+	{
+		io_erase(&io);
+		return;
+	}
+
+	size_t amount = 0;
+	size_t instructions = 0;
+	size_t i = 0;
+	while (i < size)
+	{
+		const instruction_t type = (instruction_t)vector_get(memory, i);
+		const bool is_instruction = type > MIN_INSTRUCTION_CODE && type < MAX_INSTRUCTION_CODE;
+		codes[amount++] = is_instruction ? type : 0;
+		instructions += is_instruction ? 1 : 0;
+
+		const instruction_info *const info = instruction_get_info(type);
+		i += !is_instruction ? 1 : type == IC_LID ? 3 : info != NULL ? info->argc + 1 : 1;
+	}
+
+	uni_printf(&io, "instructions %zu\n\n", instructions);
+	for (size_t length = 1; length <= MAX_SEQUENCE_LENGTH; length++)
+	{
+		write_sequences(&io, codes, amount, length);
+	}
+
+	free(codes);
+	io_erase(&io);
+}
+
+void write_tree_dump(const workspace *const ws, syntax *const sx)
+{
+	const bool is_binary = ws_has_option(ws, OPT_DUMP_BINARY);
+	const char *const path = dump_get_path(ws, OPT_DUMP_AST, DUMP_AST_FLAG
+		, is_binary ? DEFAULT_TREE_BINARY : DEFAULT_TREE);
+	if (path == NULL || sx == NULL)
+	{
+		return;
+	}
+
+	if (is_binary)
+	{
+		write_binary(path, DUMP_TREE_MAGIC, &sx->tree);
+	}
+	else
+	{
+		write_tree(path, sx);
+	}
+}
+
+void write_xref_dump(const workspace *const ws, syntax *const sx)
+{
+	const char *const path = dump_get_path(ws, OPT_XREF, XREF_FLAG, DEFAULT_XREF);
+	if (path == NULL || sx == NULL || !sx->is_indexed)
+	{
+		return;
+	}
+
+	write_xref(path, sx);
+}
+
+void write_codes_dump(const workspace *const ws, const vector *const memory)
+{
+	const bool is_binary = ws_has_option(ws, OPT_DUMP_BINARY);
+	const char *const path = dump_get_path(ws, OPT_DUMP_VM, DUMP_VM_FLAG
+		, is_binary ? DEFAULT_CODES_BINARY : DEFAULT_CODES);
+	if (path == NULL || !vector_is_correct(memory))
+	{
+		return;
+	}
+
+	if (is_binary)
+	{
+		write_binary(path, DUMP_CODES_MAGIC, memory);
+	}
+	else
+	{
+		write_codes(path, memory);
+	}
+}
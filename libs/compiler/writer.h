@@ -50,6 +50,39 @@ int write_type_spelling(const syntax *const sx, const item_t type, char *const b
  */
 void write_codes(const char *const path, const vector *const memory);
 
+/**
+ *	Write static profile of virtual machine codes:
+ *	the most frequent sequences of one, two and three instructions
+ *
+ *	@param	path			File path
+ *	@param	memory			Instructions table
+ */
+void write_profile(const char *const path, const vector *const memory);
+
+/**
+ *	Dump abstract syntax tree, if it is requested by '--dump-ast' or '--dump-ast=<path>' flag
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	sx				Syntax structure
+ */
+void write_tree_dump(const workspace *const ws, syntax *const sx);
+
+/**
+ *	Write symbol cross-reference index, if it is requested by '--xref' or '--xref=<path>' flag
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	sx				Syntax structure
+ */
+void write_xref_dump(const workspace *const ws, syntax *const sx);
+
+/**
+ *	Dump virtual machine codes, if it is requested by '--dump-vm' or '--dump-vm=<path>' flag
+ *
+ *	@param	ws				Compiler workspace
+ *	@param	memory			Instructions table
+ */
+void write_codes_dump(const workspace *const ws, const vector *const memory);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
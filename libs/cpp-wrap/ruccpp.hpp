@@ -0,0 +1,354 @@
+/*
+ *	Copyright 2022 Andrey Terekhov, Maxim Menshikov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+#include "compiler.h"
+#include "strings.h"
+#include "syntax.h"
+#include "tree.h"
+#include "uniio.h"
+#include "vector.h"
+#include "workspace.h"
+
+
+/**
+ *	C++ facade over RuC compiler.
+ *
+ *	Owners release C structures in destructors and are move-only.
+ *	Accessors return views into compiler tables and buffers without copying,
+ *	views are valid while their owner is alive and not modified.
+ */
+namespace ruc
+{
+
+/**
+ *	Get items of vector
+ *
+ *	@param	vec			Vector
+ *
+ *	@return	View of vector items
+ */
+inline std::span<const item_t> items(const ::vector &vec) noexcept
+{
+	return vector_is_correct(&vec) ? std::span<const item_t>(vector_data(&vec), vector_size(&vec))
+		: std::span<const item_t>();
+}
+
+/**
+ *	Get string from strings vector
+ *
+ *	@param	vec			Strings vector
+ *	@param	index		Index of string
+ *
+ *	@return	View of string, empty on failure
+ */
+inline std::string_view string(const ::strings &vec, const size_t index) noexcept
+{
+	const char *const str = strings_get(&vec, index);
+	return str != nullptr ? std::string_view(str, strings_get_length(&vec, index)) : std::string_view();
+}
+
+
+/**
+ *	Owner of allocated output buffer
+ */
+class buffer
+{
+public:
+	buffer() noexcept = default;
+
+	/**
+	 *	Take ownership of buffer allocated by @c malloc
+	 *
+	 *	@param	data		Buffer
+	 *	@param	size		Size of buffer content
+	 */
+	buffer(char *const data, const size_t size) noexcept : data_(data), size_(data != nullptr ? size : 0) {}
+
+	buffer(buffer &&other) noexcept : data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) {}
+	buffer &operator=(buffer &&other) noexcept
+	{
+		data_ = std::move(other.data_);
+		size_ = std::exchange(other.size_, 0);
+		return *this;
+	}
+
+	/** Get buffer content */
+	std::string_view view() const noexcept { return std::string_view(data_.get(), size_); }
+
+	/** Get buffer content as bytes */
+	std::span<const char> bytes() const noexcept { return std::span<const char>(data_.get(), size_); }
+
+	/** Give up ownership, buffer should be freed by caller */
+	char *release() noexcept { size_ = 0; return data_.release(); }
+
+	size_t size() const noexcept { return size_; }
+	bool empty() const noexcept { return size_ == 0; }
+
+private:
+	struct deleter
+	{
+		void operator()(char *const data) const noexcept;
+	};
+
+	std::unique_ptr<char, deleter> data_;
+	size_t size_ = 0;
+};
+
+
+/**
+ *	Owner of compiler workspace
+ */
+class workspace
+{
+public:
+	/** Create empty workspace */
+	workspace();
+
+	/**
+	 *	Create workspace from command line arguments
+	 *
+	 *	@param	argc		Number of command line arguments
+	 *	@param	argv		Command line arguments
+	 */
+	workspace(const int argc, const char *const *const argv);
+
+	workspace(workspace &&other) noexcept = default;
+	workspace &operator=(workspace &&other) noexcept = default;
+
+	workspace &add_file(const char *const path) { ws_add_file(ws_.get(), path); return *this; }
+	workspace &add_dir(const char *const path) { ws_add_dir(ws_.get(), path); return *this; }
+	workspace &add_flag(const char *const flag) { ws_add_flag(ws_.get(), flag); return *this; }
+	workspace &set_output(const char *const path) { ws_set_output(ws_.get(), path); return *this; }
+
+	std::string_view file(const size_t index) const noexcept { return string(ws_->files, index); }
+	size_t files() const noexcept { return ws_get_files_num(ws_.get()); }
+	std::string_view flag(const size_t index) const noexcept { return string(ws_->flags, index); }
+	size_t flags() const noexcept { return ws_get_flags_num(ws_.get()); }
+
+	bool has_option(const option_t opt) const noexcept { return ws_has_option(ws_.get(), opt); }
+	bool is_correct() const noexcept { return ws_is_correct(ws_.get()); }
+
+	::workspace *get() noexcept { return ws_.get(); }
+	const ::workspace *get() const noexcept { return ws_.get(); }
+
+private:
+	struct deleter
+	{
+		void operator()(::workspace *const ws) const noexcept;
+	};
+
+	// Рабочее пространство содержит имя выходного файла, поэтому перемещается только указатель
+	std::unique_ptr<::workspace, deleter> ws_;
+};
+
+
+/**
+ *	Owner of universal io
+ */
+class io
+{
+public:
+	io();
+
+	io(io &&other) noexcept = default;
+	io &operator=(io &&other) noexcept = default;
+
+	/**
+	 *	Set input buffer, it is not copied and should outlive io
+	 *
+	 *	@param	data		Null-terminated input buffer
+	 *
+	 *	@return	@c 0 on success, @c -1 on failure
+	 */
+	int set_input(const char *const data) noexcept { return in_set_buffer(io_.get(), data); }
+	int set_input_file(const char *const path) noexcept { return in_set_file(io_.get(), path); }
+	int set_output_file(const char *const path) noexcept { return out_set_file(io_.get(), path); }
+	int set_output_buffer(const size_t size) noexcept { return out_set_buffer(io_.get(), size); }
+
+	/** Get written part of output buffer */
+	std::string_view output() const noexcept;
+
+	/** Take output buffer */
+	buffer extract_output() noexcept;
+
+	universal_io *get() noexcept { return io_.get(); }
+	const universal_io *get() const noexcept { return io_.get(); }
+
+private:
+	struct deleter
+	{
+		void operator()(universal_io *const io) const noexcept;
+	};
+
+	// Структура разбора хранит указатель на ввод-вывод, поэтому адрес не меняется при перемещении
+	std::unique_ptr<universal_io, deleter> io_;
+};
+
+
+/**
+ *	Result of compilation into memory
+ */
+class result
+{
+public:
+	result(const status_t status, buffer &&output) noexcept : status_(status), output_(std::move(output)) {}
+
+	result(result &&other) noexcept = default;
+	result &operator=(result &&other) noexcept = default;
+
+	status_t status() const noexcept { return status_; }
+	explicit operator bool() const noexcept { return status_ == sts_success; }
+
+	/** Get generated code */
+	std::string_view output() const noexcept { return output_.view(); }
+
+	/** Take generated code */
+	buffer extract() noexcept { return std::move(output_); }
+
+private:
+	status_t status_;
+	buffer output_;
+};
+
+/**
+ *	Compile code from workspace into memory, target is chosen by flags
+ *
+ *	@param	ws			Compiler workspace
+ *
+ *	@return	Compilation result
+ */
+result compile(workspace &ws);
+
+
+/**
+ *	View of tree node
+ */
+class node_view
+{
+public:
+	/** Iterator over children of node */
+	class iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = node_view;
+		using reference = node_view;
+		using pointer = void;
+
+		iterator() noexcept = default;
+		iterator(const ::node &parent, const size_t index) noexcept : parent_(parent), index_(index) {}
+
+		node_view operator*() const noexcept { return node_view(node_get_child(&parent_, index_)); }
+
+		iterator &operator++() noexcept { index_++; return *this; }
+		iterator operator++(int) noexcept { iterator it = *this; index_++; return it; }
+
+		bool operator==(const iterator &other) const noexcept
+		{
+			return parent_.tree == other.parent_.tree && parent_.index == other.parent_.index
+				&& index_ == other.index_;
+		}
+
+	private:
+		::node parent_ = { nullptr, 0 };
+		size_t index_ = 0;
+	};
+
+	explicit node_view(const ::node &nd) noexcept : nd_(nd) {}
+
+	item_t type() const noexcept { return node_get_type(&nd_); }
+
+	/** Get arguments, they are stored in tree contiguously */
+	std::span<const item_t> arguments() const noexcept
+	{
+		return node_is_correct(&nd_) ? std::span<const item_t>(vector_data(nd_.tree) + nd_.index + 3, node_get_argc(&nd_))
+			: std::span<const item_t>();
+	}
+
+	item_t argument(const size_t index) const noexcept { return node_get_arg(&nd_, index); }
+
+	size_t amount() const noexcept { return node_get_amount(&nd_); }
+	node_view child(const size_t index) const noexcept { return node_view(node_get_child(&nd_, index)); }
+	node_view parent() const noexcept { return node_view(node_get_parent(&nd_)); }
+
+	iterator begin() const noexcept { return iterator(nd_, 0); }
+	iterator end() const noexcept { return iterator(nd_, amount()); }
+
+	bool is_correct() const noexcept { return node_is_correct(&nd_); }
+	const ::node &get() const noexcept { return nd_; }
+
+private:
+	::node nd_;
+};
+
+
+/**
+ *	Owner of parsed translation unit with its preprocessed text
+ */
+class syntax
+{
+public:
+	/**
+	 *	Preprocess and parse files of workspace
+	 *
+	 *	@param	ws			Compiler workspace, should outlive syntax
+	 */
+	explicit syntax(workspace &ws);
+
+	syntax(syntax &&other) noexcept = default;
+	syntax &operator=(syntax &&other) noexcept = default;
+
+	status_t status() const noexcept { return status_; }
+	explicit operator bool() const noexcept { return status_ == sts_success; }
+
+	/** Get root of tree, tree is frozen after parsing, so children are accessed in constant time */
+	node_view root() noexcept { return node_view(node_get_root(&sx_->tree)); }
+
+	std::string_view string_literal(const size_t index) const noexcept { return string(sx_->string_literals, index); }
+	size_t string_literals() const noexcept { return strings_size(&sx_->string_literals); }
+
+	std::span<const item_t> identifiers() const noexcept { return items(sx_->identifiers); }
+	std::span<const item_t> types() const noexcept { return items(sx_->types); }
+
+	/** Get text after preprocessing */
+	std::string_view preprocessed() const noexcept { return text_.view(); }
+
+	::syntax *get() noexcept { return sx_.get(); }
+	const ::syntax *get() const noexcept { return sx_.get(); }
+
+private:
+	struct deleter
+	{
+		void operator()(::syntax *const sx) const noexcept;
+	};
+
+	// Таблицы разбора ссылаются на текст и ввод-вывод, поэтому освобождаются раньше них
+	buffer text_;
+	io io_;
+	std::unique_ptr<::syntax, deleter> sx_;
+	status_t status_ = sts_success;
+};
+
+} // namespace ruc
@@ -14,6 +14,11 @@
  *	limitations under the License.
  */
 
+#include "ruccpp.hpp"
+#include <cstdlib>
+#include <cstring>
+#include "macro.h"
+
 /* compiler headers */
 #include "AST.h"
 #include "builder.h"
@@ -61,3 +66,91 @@
 #include "utf8.h"
 #include "vector.h"
 #include "workspace.h"
+
+
+namespace ruc
+{
+
+void buffer::deleter::operator()(char *const data) const noexcept
+{
+	free(data);
+}
+
+
+workspace::workspace() : ws_(new ::workspace(ws_create())) {}
+
+workspace::workspace(const int argc, const char *const *const argv) : ws_(new ::workspace(ws_parse_args(argc, argv))) {}
+
+void workspace::deleter::operator()(::workspace *const ws) const noexcept
+{
+	ws_clear(ws);
+	delete ws;
+}
+
+
+io::io() : io_(new universal_io(io_create())) {}
+
+std::string_view io::output() const noexcept
+{
+	return out_is_buffer(io_.get()) ? std::string_view(io_->out_buffer, out_get_position(io_.get())) : std::string_view();
+}
+
+buffer io::extract_output() noexcept
+{
+	const size_t size = out_get_position(io_.get());
+	return buffer(out_extract_buffer(io_.get()), size);
+}
+
+void io::deleter::operator()(universal_io *const io) const noexcept
+{
+	io_erase(io);
+	delete io;
+}
+
+
+result compile(workspace &ws)
+{
+	char *data = nullptr;
+	size_t size = 0;
+	const status_t status = compile_to_buffer(ws.get(), &data, &size);
+	return result(status, buffer(data, size));
+}
+
+
+syntax::syntax(workspace &ws)
+{
+	// Сообщения разбора идут в журналы рабочего пространства, как и при компиляции
+	const logger error_log = set_thread_error_log(ws.get()->error_log);
+	const logger warning_log = set_thread_warning_log(ws.get()->warning_log);
+
+	char *const preprocessing = macro(ws.get());
+	text_ = buffer(preprocessing, preprocessing != nullptr ? strlen(preprocessing) : 0);
+	io_.set_input(preprocessing);
+
+	sx_.reset(new ::syntax(sx_create(ws.get(), io_.get())));
+	if (preprocessing == nullptr)
+	{
+		status_ = sts_macro_error;
+	}
+	else
+	{
+		status_ = parse(sx_.get()) ? sts_parse_error : sts_success;
+		reporter_flush(&sx_->rprt, sx_->io);
+
+		if (status_ == sts_success && !ws.has_option(OPT_COMPILE_ONLY) && !sx_is_correct(sx_.get()))
+		{
+			status_ = sts_link_error;
+		}
+	}
+
+	set_thread_error_log(error_log);
+	set_thread_warning_log(warning_log);
+}
+
+void syntax::deleter::operator()(::syntax *const sx) const noexcept
+{
+	sx_clear(sx);
+	delete sx;
+}
+
+} // namespace ruc
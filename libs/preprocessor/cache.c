@@ -0,0 +1,265 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "cache.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+	#include <sys/stat.h>
+	#include <sys/types.h>
+#else
+	#include <direct.h>
+#endif
+
+
+#define MAX_CACHE_PATH MAX_ARG_SIZE + 32
+
+
+static const char *const CACHE_FLAG = "--macro-cache";
+static const char *const CACHE_DIR_FLAG = "--macro-cache=";
+static const char *const DEFAULT_CACHE_DIR = "macro_cache";
+static const char *const CACHE_SIGNATURE = "ruc-macro-cache 1";
+
+static const uint64_t HASH_BASIS = 14695981039346656037ULL;
+static const uint64_t HASH_PRIME = 1099511628211ULL;
+
+
+static inline uint64_t hash_bytes(uint64_t hash, const char *const bytes, const size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ (unsigned char)bytes[i]) * HASH_PRIME;
+	}
+
+	// Разделитель, чтобы склейка строк давала другой хеш
+	return hash * HASH_PRIME;
+}
+
+static inline uint64_t hash_string(const uint64_t hash, const char *const str)
+{
+	return hash_bytes(hash, str, strlen(str));
+}
+
+/** Hash file contents, @c 0 if file can not be read */
+static uint64_t hash_file(const char *const path)
+{
+	FILE *const file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return 0;
+	}
+
+	uint64_t hash = HASH_BASIS;
+	char buffer[4096];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ (unsigned char)buffer[i]) * HASH_PRIME;
+		}
+	}
+
+	fclose(file);
+	return hash != 0 ? hash : 1;
+}
+
+/** Get cache directory from flags, @c NULL if cache is disabled */
+static const char *cache_get_dir(const workspace *const ws)
+{
+	const char *const dir = ws_get_flag_value(ws, CACHE_DIR_FLAG);
+	if (dir != NULL)
+	{
+		return dir;
+	}
+
+	return ws_has_flag(ws, CACHE_FLAG) ? DEFAULT_CACHE_DIR : NULL;
+}
+
+static void cache_get_path(const workspace *const ws, const uint64_t key, char *const path)
+{
+	sprintf(path, "%.*s/%016" PRIx64 ".macro", MAX_ARG_SIZE, cache_get_dir(ws), key);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+bool cache_is_enabled(const workspace *const ws)
+{
+	return cache_get_dir(ws) != NULL;
+}
+
+uint64_t cache_key(const workspace *const ws)
+{
+	if (!cache_is_enabled(ws))
+	{
+		return 0;
+	}
+
+	uint64_t hash = HASH_BASIS;
+	for (size_t i = 0; i < ws_get_files_num(ws); i++)
+	{
+		const char *const path = ws_get_file(ws, i);
+		if (strcmp(path, STDIN_PATH) == 0)
+		{
+			// Стандартный ввод читается один раз, поэтому его нельзя проверить по кешу
+			return 0;
+		}
+
+		const uint64_t contents = hash_file(path);
+
+		hash = hash_string(hash, path);
+		hash = hash_bytes(hash, (const char *)&contents, sizeof(contents));
+	}
+
+	for (size_t i = 0; i < ws_get_dirs_num(ws); i++)
+	{
+		hash = hash_string(hash, ws_get_dir(ws, i));
+	}
+
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		hash = hash_string(hash, ws_get_flag(ws, i));
+	}
+
+	return hash != 0 ? hash : 1;
+}
+
+char *cache_load(workspace *const ws, const uint64_t key)
+{
+	if (key == 0)
+	{
+		return NULL;
+	}
+
+	char path[MAX_CACHE_PATH];
+	cache_get_path(ws, key, path);
+
+	FILE *const file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	char line[MAX_CACHE_PATH];
+	size_t files = 0;
+	bool is_actual = fgets(line, sizeof(line), file) != NULL && strncmp(line, CACHE_SIGNATURE, strlen(CACHE_SIGNATURE)) == 0
+		&& fscanf(file, "%zu\n", &files) == 1;
+
+	// Вывод актуален, только если не изменился ни один из прочитанных при препроцессировании файлов
+	strings headers = strings_create(files);
+	for (size_t i = 0; is_actual && i < files; i++)
+	{
+		uint64_t saved;
+		is_actual = fscanf(file, "%16" SCNx64 " ", &saved) == 1 && fgets(line, sizeof(line), file) != NULL;
+		if (is_actual)
+		{
+			line[strcspn(line, "\n")] = '\0';
+			is_actual = hash_file(line) == saved;
+			strings_add(&headers, line);
+		}
+	}
+
+	size_t size = 0;
+	char *buffer = NULL;
+	if (is_actual && fscanf(file, "%zu", &size) == 1 && fgetc(file) == '\n')
+	{
+		buffer = malloc(size + 1);
+		if (buffer != NULL && fread(buffer, 1, size, file) == size)
+		{
+			buffer[size] = '\0';
+		}
+		else
+		{
+			free(buffer);
+			buffer = NULL;
+		}
+	}
+
+	fclose(file);
+
+	for (size_t i = 0; buffer != NULL && i < strings_size(&headers); i++)
+	{
+		ws_add_file(ws, strings_get(&headers, i));
+	}
+
+	strings_clear(&headers);
+	return buffer;
+}
+
+void cache_save(const workspace *const ws, const uint64_t key, const char *const buffer)
+{
+	if (key == 0 || buffer == NULL)
+	{
+		return;
+	}
+
+	const char *const dir = cache_get_dir(ws);
+#ifndef _WIN32
+	mkdir(dir, 0777);
+#else
+	_mkdir(dir);
+#endif
+
+	char path[MAX_CACHE_PATH];
+	cache_get_path(ws, key, path);
+
+	// Запись во временный файл, чтобы параллельные сборки не прочитали его частично
+	char temp[MAX_CACHE_PATH + 8];
+	sprintf(temp, "%s.tmp", path);
+
+	FILE *const file = fopen(temp, "wb");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	const size_t files = ws_get_files_num(ws);
+	fprintf(file, "%s\n%zu\n", CACHE_SIGNATURE, files);
+	for (size_t i = 0; i < files; i++)
+	{
+		const char *const file_path = ws_get_file(ws, i);
+		fprintf(file, "%016" PRIx64 " %s\n", hash_file(file_path), file_path);
+	}
+
+	const size_t size = strlen(buffer);
+	fprintf(file, "%zu\n", size);
+	const bool is_written = fwrite(buffer, 1, size, file) == size;
+
+	if (fclose(file) || !is_written)
+	{
+		remove(temp);
+		return;
+	}
+
+#ifdef _WIN32
+	remove(path);
+#endif
+	if (rename(temp, path))
+	{
+		remove(temp);
+	}
+}
@@ -0,0 +1,70 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Check that workspace enables cache of preprocessed output.
+ *	Flag @c --macro-cache uses default directory, @c --macro-cache=dir sets it.
+ *
+ *	@param	ws		Workspace
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+bool cache_is_enabled(const workspace *const ws);
+
+/**
+ *	Get cache key from input files, their contents, include directories and flags.
+ *	Should be called before preprocessing, which adds headers to workspace.
+ *
+ *	@param	ws		Workspace
+ *
+ *	@return	Cache key, @c 0 if cache is disabled
+ */
+uint64_t cache_key(const workspace *const ws);
+
+/**
+ *	Load preprocessed output, if all files it was built from are unchanged.
+ *	Included files are added to workspace as after preprocessing.
+ *
+ *	@param	ws		Workspace
+ *	@param	key		Cache key
+ *
+ *	@return	Preprocessed string (need to use @c free() function), @c NULL if not found
+ */
+char *cache_load(workspace *const ws, const uint64_t key);
+
+/**
+ *	Save preprocessed output with hashes of all files from workspace
+ *
+ *	@param	ws		Workspace after preprocessing
+ *	@param	key		Cache key
+ *	@param	buffer	Preprocessed string
+ */
+void cache_save(const workspace *const ws, const uint64_t key, const char *const buffer);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -21,11 +21,16 @@
 #include "linker.h"
 #include "utils.h"
 #include <math.h>
+#include <string.h>
 
 
 #define STK_SIZE 32
 #define OPN_SIZE STK_SIZE
 
+#define CALC_NUMBER		-1
+#define CALC_MACRO		-2
+#define CALC_FAILED		-1
+
 
 double get_digit(environment *const env, int* error)// Временная замена
 {
@@ -248,7 +253,7 @@ void double_to_string(environment *const env, const double x, const int is_int)
 		sprintf(s, "%f", x);
 		for (env->calc_string_size = 0; env->calc_string_size < 20; env->calc_string_size++)
 		{
-			env->calc_string[env->calc_string_size] = s[env->calc_string_size];
+			storage_set(&env->calc_string, env->calc_string_size, s[env->calc_string_size]);
 
 			if (s[env->calc_string_size] == '.')
 			{
@@ -263,7 +268,7 @@ void double_to_string(environment *const env, const double x, const int is_int)
 		sprintf(s, "%.14lf", x);
 		for (env->calc_string_size = 0; env->calc_string_size < 20; env->calc_string_size++)
 		{
-			env->calc_string[env->calc_string_size] = s[env->calc_string_size];
+			storage_set(&env->calc_string, env->calc_string_size, s[env->calc_string_size]);
 
 			if (s[env->calc_string_size] != '0' && utf8_is_digit(s[env->calc_string_size]))
 			{
@@ -436,8 +441,443 @@ int additional_elements(environment *const env, double *const stack, int *const
 	return 2;
 }
 
+/**
+ *	Read number from storage the same way as @ref get_digit() does
+ *
+ *	@param	st			Storage with characters
+ *	@param	i			Index of first character, set to index after number
+ *	@param	value		Number
+ *	@param	is_int		Set, if number is integer
+ *
+ *	@return	@c 0 on success, @c -1 on malformed number
+ */
+static int calc_scan_number(const storage *const st, size_t *const i, double *const value, int *const is_int)
+{
+	int d = 1;
+	int num = 0;
+	double numdouble = 0.0;
+	*is_int = 1;
+
+	if (storage_get(st, *i) == '-')
+	{
+		d = -1;
+		(*i)++;
+	}
+
+	for (int c = storage_get(st, *i); utf8_is_digit(c); c = storage_get(st, ++*i))
+	{
+		numdouble = numdouble * 10 + (c - '0');
+		if (numdouble > (double)INT_MAX)
+		{
+			return -1;
+		}
+		num = num * 10 + (c - '0');
+	}
+
+	if (storage_get(st, *i) == '.')
+	{
+		*is_int = 0;
+		double k = 0.1;
+		for (int c = storage_get(st, ++*i); utf8_is_digit(c); c = storage_get(st, ++*i))
+		{
+			numdouble += (c - '0') * k;
+			k *= 0.1;
+		}
+	}
+
+	if (utf8_is_power(storage_get(st, *i)))
+	{
+		int power = 0;
+		int sign = 1;
+
+		const int c = storage_get(st, ++*i);
+		if (c == '-')
+		{
+			*is_int = 0;
+			sign = -1;
+			(*i)++;
+		}
+		else if (c == '+')
+		{
+			(*i)++;
+		}
+
+		if (!utf8_is_digit(storage_get(st, *i)))
+		{
+			return -1;
+		}
+
+		for (int c = storage_get(st, *i); utf8_is_digit(c); c = storage_get(st, ++*i))
+		{
+			power = power * 10 + c - '0';
+		}
+
+		if (*is_int)
+		{
+			for (int j = 1; j <= power; j++)
+			{
+				num *= 10;
+			}
+		}
+
+		numdouble *= pow(10.0, sign * power);
+	}
+
+	*value = *is_int ? num * d : numdouble * d;
+	return 0;
+}
+
+static inline int calc_emit(environment *const env, const int value)
+{
+	return storage_set(&env->calc_programs, env->calc_programs_size++, value);
+}
+
+static int calc_emit_number(environment *const env, const double value, const int is_int)
+{
+	int bits[sizeof(double) / sizeof(int)];
+	memcpy(bits, &value, sizeof(double));
+
+	int ret = calc_emit(env, CALC_NUMBER) || calc_emit(env, is_int);
+	for (size_t i = 0; i < sizeof(bits) / sizeof(int); i++)
+	{
+		ret = ret || calc_emit(env, bits[i]);
+	}
+
+	return ret;
+}
+
+/**
+ *	Compile expression to postfix program, following the steps of @ref calculate().
+ *	Identifiers become references to macros, which are read on each evaluation.
+ *	Program is a position after expression, a number of elements and elements:
+ *	numbers, macro references and operations.
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	st			Storage with expression
+ *	@param	size		Size of storage
+ *	@param	i			Index of current character
+ *	@param	type		Type of expression
+ *
+ *	@return	Index of program, @c CALC_FAILED if expression is not supported
+ */
+static int calc_compile(environment *const env, const storage *const st, const size_t size, size_t i, const int type)
+{
+	const size_t program = env->calc_programs_size;
+	env->calc_programs_size += 2;
+
+	char operation[OPN_SIZE];
+	int op_size = 0;
+	int stk_size = 0;
+	int locl_type = type;
+	int opration_flag = 0;
+
+	if (type == ARITHMETIC)
+	{
+		operation[op_size++] = '(';
+		i++;
+	}
+
+	while (storage_get(st, i) != '\n')
+	{
+		while (storage_get(st, i) == ' ' || storage_get(st, i) == '\t')
+		{
+			i++;
+		}
+
+		const int c = storage_get(st, i);
+		if (i + 1 >= size || op_size >= OPN_SIZE - 1 || stk_size >= STK_SIZE)
+		{
+			break;
+		}
+
+		if (c == '#' && locl_type == LOGIC && !opration_flag)
+		{
+			const int oldrepr = env->rp;
+			env->rp += 2;
+			do
+			{
+				storage_set(&env->reprtab, env->rp++, storage_get(st, i++));
+			} while (utf8_is_letter(storage_get(st, i)) || utf8_is_digit(storage_get(st, i)));
+
+			storage_set(&env->reprtab, env->rp++, 0);
+			const int r = reprtab_search(env, oldrepr);
+			env->rp = oldrepr;
+
+			if (!r || storage_get(&env->reprtab, r + 1) != SH_EVAL || storage_get(st, i) != '(')
+			{
+				break;
+			}
+
+			locl_type = ARITHMETIC;
+			operation[op_size++] = '[';
+			i++;
+		}
+		else if (utf8_is_letter(c))
+		{
+			env->msp = 0;
+			while (utf8_is_letter(storage_get(st, i)) || utf8_is_digit(storage_get(st, i)))
+			{
+				storage_set(&env->mstring, env->msp++, storage_get(st, i++));
+			}
+
+			// Значение макроса должно отделяться от текста после него, как при подстановке
+			const int next = storage_get(st, i);
+			const int r = mident_search(env);
+			if (opration_flag || !r || (next != ' ' && next != '\t' && next != '\n' && next != ')'
+				&& !get_opiration((char)next, (char)storage_get(st, i + 1))))
+			{
+				break;
+			}
+
+			calc_emit(env, CALC_MACRO);
+			calc_emit(env, r);
+			stk_size++;
+			opration_flag = 1;
+		}
+		else if (c == '(' && !opration_flag)
+		{
+			operation[op_size++] = '(';
+			i++;
+		}
+		else if (c == ')' && opration_flag)
+		{
+			while (op_size > 0 && operation[op_size - 1] != '(' && operation[op_size - 1] != '[' && stk_size >= 2)
+			{
+				calc_emit(env, operation[--op_size]);
+				stk_size--;
+			}
+
+			if (op_size == 0 || (operation[op_size - 1] != '(' && operation[op_size - 1] != '['))
+			{
+				break;
+			}
+
+			i++;
+			if (operation[--op_size] == '[')
+			{
+				locl_type = LOGIC;
+			}
+
+			if (op_size == 0 && locl_type == ARITHMETIC)
+			{
+				storage_set(&env->calc_programs, program, (int)i);
+				storage_set(&env->calc_programs, program + 1, (int)(env->calc_programs_size - program - 2));
+				return (int)program;
+			}
+		}
+		else if (!opration_flag && (utf8_is_digit(c) || (c == '-' && utf8_is_digit(storage_get(st, i + 1)))))
+		{
+			double value;
+			int is_int;
+			if (calc_scan_number(st, &i, &value, &is_int))
+			{
+				break;
+			}
+
+			calc_emit_number(env, value, is_int);
+			stk_size++;
+			opration_flag = 1;
+		}
+		else if (opration_flag && c != '\n')
+		{
+			const char op = get_opiration((char)c, (char)storage_get(st, i + 1));
+			const int prior = get_prior(op);
+			if (!op || (locl_type == LOGIC && prior > 3) || (locl_type == ARITHMETIC && prior <= 3))
+			{
+				break;
+			}
+
+			i += op == 'b' || op == 's' || op == '=' || op == '&' || op == '|' || op == '!' ? 2 : 1;
+			while (op_size != 0 && get_prior(operation[op_size - 1]) >= prior && stk_size >= 2)
+			{
+				calc_emit(env, operation[--op_size]);
+				stk_size--;
+			}
+
+			if (op_size != 0 && get_prior(operation[op_size - 1]) >= prior)
+			{
+				break;
+			}
+
+			operation[op_size++] = op;
+			opration_flag = 0;
+		}
+		else if (c != '\n')
+		{
+			break;
+		}
+	}
+
+	if (storage_get(st, i) == '\n' && locl_type == LOGIC)
+	{
+		while (op_size > 0 && operation[op_size - 1] != '(' && operation[op_size - 1] != '[' && stk_size >= 2)
+		{
+			calc_emit(env, operation[--op_size]);
+			stk_size--;
+		}
+
+		if (op_size == 0 && stk_size == 1)
+		{
+			storage_set(&env->calc_programs, program, (int)i);
+			storage_set(&env->calc_programs, program + 1, (int)(env->calc_programs_size - program - 2));
+			return (int)program;
+		}
+	}
+
+	// Неподдерживаемое выражение вычисляется посимвольно, там же выдаются ошибки
+	env->calc_programs_size = program;
+	return CALC_FAILED;
+}
+
+/**
+ *	Read macro value, which is a single number
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	r			Index of macro representation
+ *	@param	value		Number
+ *	@param	is_int		Set, if number is integer
+ *
+ *	@return	@c 0 on success, @c -1 if macro is not a number
+ */
+static int calc_macro_value(environment *const env, const int r, double *const value, int *const is_int)
+{
+	size_t i = (size_t)storage_get(&env->reprtab, r + 1);
+	if (storage_get(&env->macro_tab, i++) != MACRODEF)
+	{
+		return -1;
+	}
+
+	while (storage_get(&env->macro_tab, i) == ' ' || storage_get(&env->macro_tab, i) == '\t')
+	{
+		i++;
+	}
+
+	const int c = storage_get(&env->macro_tab, i);
+	if (!utf8_is_digit(c) && (c != '-' || !utf8_is_digit(storage_get(&env->macro_tab, i + 1))))
+	{
+		return -1;
+	}
+
+	if (calc_scan_number(&env->macro_tab, &i, value, is_int))
+	{
+		return -1;
+	}
+
+	while (storage_get(&env->macro_tab, i) == ' ' || storage_get(&env->macro_tab, i) == '\t')
+	{
+		i++;
+	}
+
+	return storage_get(&env->macro_tab, i) == MACROEND ? 0 : -1;
+}
+
+/**
+ *	Evaluate expression from loop text by its compiled program
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	type		Type of expression
+ *
+ *	@return	@c 0 on success, @c 1 if expression should be calculated by characters
+ */
+static int calc_compiled(environment *const env, const int type)
+{
+	const bool is_if = env->nextch_type == IFTYPE;
+	const storage *const st = is_if ? &env->if_string : &env->while_string;
+	const size_t size = is_if ? env->if_string_size : env->while_string_size;
+	storage *const index = is_if ? &env->if_calc : &env->while_calc;
+	const size_t position = env->nextp - 1;
+
+	int program = storage_get(index, position) - 1;
+	if (program == CALC_FAILED - 1)
+	{
+		return 1;
+	}
+	else if (program == -1)
+	{
+		program = calc_compile(env, st, size, position, type);
+		storage_set(index, position, program == CALC_FAILED ? CALC_FAILED : program + 1);
+		if (program == CALC_FAILED)
+		{
+			return 1;
+		}
+	}
+
+	double stack[STK_SIZE];
+	int is_int[STK_SIZE];
+	int stk_size = 0;
+
+	const size_t end = (size_t)storage_get(&env->calc_programs, (size_t)program);
+	const size_t elements = (size_t)program + 2 + (size_t)storage_get(&env->calc_programs, (size_t)program + 1);
+	for (size_t i = (size_t)program + 2; i < elements; i++)
+	{
+		const int element = storage_get(&env->calc_programs, i);
+		if (element == CALC_NUMBER)
+		{
+			int bits[sizeof(double) / sizeof(int)];
+			is_int[stk_size] = storage_get(&env->calc_programs, ++i);
+			for (size_t j = 0; j < sizeof(bits) / sizeof(int); j++)
+			{
+				bits[j] = storage_get(&env->calc_programs, ++i);
+			}
+
+			memcpy(&stack[stk_size++], bits, sizeof(double));
+		}
+		else if (element == CALC_MACRO)
+		{
+			// Макрос мог быть переопределен, поэтому его значение читается при каждом вычислении
+			const int r = storage_get(&env->calc_programs, ++i);
+			if (calc_macro_value(env, r, &stack[stk_size], &is_int[stk_size]))
+			{
+				return 1;
+			}
+
+			stk_size++;
+		}
+		else
+		{
+			is_int[stk_size - 2] = is_int[stk_size - 2] && is_int[stk_size - 1];
+			stack[stk_size - 2] = calc_count(stack[stk_size - 2], stack[stk_size - 1], (char)element, is_int[stk_size - 2]);
+			stk_size--;
+		}
+	}
+
+	if (type == LOGIC)
+	{
+		storage_set(&env->calc_string, 0, stack[0] != 0);
+	}
+	else
+	{
+		double_to_string(env, stack[0], is_int[0]);
+	}
+
+	env->flagint = is_int[0];
+	env->nextp = end + 1;
+	env->curchar = storage_get(st, end);
+	env->nextchar = storage_get(st, end + 1);
+	return 0;
+}
+
+
+void calc_reset(environment *const env)
+{
+	storage_clear(&env->if_calc);
+	storage_clear(&env->while_calc);
+	env->if_calc = storage_create(env->memory, STRING_SIZE);
+	env->while_calc = storage_create(env->memory, STRING_SIZE);
+	env->calc_programs_size = 0;
+}
+
 int calculate(environment *const env, const int type)
 {
+	if (env->nextch_type == IFTYPE || env->nextch_type == WHILETYPE)
+	{
+		const int res = calc_compiled(env, type);
+		if (res != 1)
+		{
+			return res;
+		}
+	}
+
 	int op_size = 0;
 	char operation[OPN_SIZE];
 	int locl_type = type;
@@ -498,11 +938,11 @@ int calculate(environment *const env, const int type)
 
 		if (stack[0] == 0)
 		{
-			env->calc_string[0] = 0;
+			storage_set(&env->calc_string, 0, 0);
 		}
 		else
 		{
-			env->calc_string[0] = 1;
+			storage_set(&env->calc_string, 0, 1);
 		}
 	}
 	else
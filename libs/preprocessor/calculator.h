@@ -37,6 +37,13 @@ extern "C" {
  */
 int calculate(environment *const env, const int type);
 
+/**
+ *	Drop expressions compiled for the text of previous loop
+ *
+ *	@param	env				Preprocessor environment
+ */
+void calc_reset(environment *const env);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
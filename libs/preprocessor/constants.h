@@ -18,12 +18,14 @@
 
 #define MACRODEBUG 1
 
-#define MAXTAB		100000
+#define TAB_SIZE	4096
 #define LONGSTR		10000
 #define STRING_SIZE	256
 #define HASH		256
 #define DEPTH			10
+#define MEMO_SIZE	256
 #define CONTROLSIZE 250
+#define OUTPUT_SIZE 4096
 
 #define END_PARAMETER	  -6
 #define MACROEND	  -5
@@ -38,6 +40,7 @@
 #define IFTYPE			  4
 #define WHILETYPE		  5
 #define FTYPE			  6
+#define MEMOTYPE		  7
 #define TEXTTYPE		  10
 #define PREPROCESS_STRING 11
 #define FILETYPE		  0
@@ -0,0 +1,108 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+
+#include "dependencies.h"
+#include <stdio.h>
+#include <string.h>
+
+
+#define MAX_DEPS_PATH MAX_ARG_SIZE + 8
+
+
+static const char *const DEPS_FLAG = "-MF=";
+static const char *const DEPS_SUFFIX = ".d";
+
+
+/** Get dependency file name from flags, @c NULL for default one */
+static const char *deps_get_flag(const workspace *const ws)
+{
+	return ws_get_flag_value(ws, DEPS_FLAG);
+}
+
+/** Write path escaping characters special for Make */
+static void deps_print_path(FILE *const file, const char *const path)
+{
+	for (size_t i = 0; path[i] != '\0'; i++)
+	{
+		if (path[i] == ' ' || path[i] == '#')
+		{
+			fputc('\\', file);
+		}
+		else if (path[i] == '$')
+		{
+			fputc('$', file);
+		}
+
+		fputc(path[i], file);
+	}
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+bool deps_is_enabled(const workspace *const ws)
+{
+	return ws_has_option(ws, OPT_DEPENDENCIES) || deps_get_flag(ws) != NULL;
+}
+
+int deps_save(const workspace *const ws, const size_t sources)
+{
+	const char *const target = ws_get_output(ws);
+	if (!deps_is_enabled(ws) || target == NULL)
+	{
+		return 0;
+	}
+
+	char path[MAX_DEPS_PATH];
+	const char *const name = deps_get_flag(ws);
+	sprintf(path, "%.*s%s", MAX_ARG_SIZE, name != NULL ? name : target, name != NULL ? "" : DEPS_SUFFIX);
+
+	FILE *const file = fopen(path, "w");
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	deps_print_path(file, target);
+	fputc(':', file);
+
+	const size_t files = ws_get_files_num(ws);
+	for (size_t i = 0; i < files; i++)
+	{
+		fputs(" \\\n ", file);
+		deps_print_path(file, ws_get_file(ws, i));
+	}
+	fputc('\n', file);
+
+	// Пустые правила для заголовков, чтобы удаление заголовка не останавливало сборку
+	for (size_t i = sources; i < files; i++)
+	{
+		fputc('\n', file);
+		deps_print_path(file, ws_get_file(ws, i));
+		fputs(":\n", file);
+	}
+
+	const bool is_written = !ferror(file);
+	return fclose(file) || !is_written ? -1 : 0;
+}
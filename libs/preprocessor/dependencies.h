@@ -0,0 +1,52 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Check that workspace requests dependency file.
+ *	Flag @c -MD writes it next to output with @c .d suffix, @c -MF=path sets its name.
+ *
+ *	@param	ws		Workspace
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+bool deps_is_enabled(const workspace *const ws);
+
+/**
+ *	Write Make rule with output depending on all files read while preprocessing.
+ *	Headers also get empty rules, so removed header does not break build.
+ *
+ *	@param	ws		Workspace after preprocessing
+ *	@param	sources	Number of source files, which were added before preprocessing
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int deps_save(const workspace *const ws, const size_t sources);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
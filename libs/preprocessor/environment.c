@@ -18,25 +18,84 @@
 #include "constants.h"
 #include "commenter.h"
 #include "error.h"
-#include "uniprinter.h"
+#include "utf8.h"
 #include "uniscanner.h"
 #include <string.h>
 
 
 #define MAX_CMT_SIZE MAX_ARG_SIZE + 32
+#define ARENA_SIZE (1 << 16)
 
 
-void env_init(environment *const env, linker *const lk, universal_io *const output)
+static const char *const MEMO_FLAG = "--macro-memo";
+
+
+extern int storage_get(const storage *const st, const size_t index);
+extern int storage_set(storage *const st, const size_t index, const int value);
+
+
+storage storage_create(arena *const memory, const size_t size)
+{
+	storage st;
+	st.memory = memory;
+	st.array = arena_alloc(memory, size * sizeof(int));
+	st.size = st.array != NULL ? size : 0;
+
+	if (st.array != NULL)
+	{
+		memset(st.array, 0, size * sizeof(int));
+	}
+	return st;
+}
+
+int storage_reserve(storage *const st, const size_t index)
+{
+	size_t size = st->size != 0 ? st->size : 1;
+	while (index >= size)
+	{
+		size *= 2;
+	}
+
+	int *const array = arena_realloc(st->memory, st->array, st->size * sizeof(int), size * sizeof(int));
+	if (array == NULL)
+	{
+		return -1;
+	}
+
+	memset(&array[st->size], 0, (size - st->size) * sizeof(int));
+	st->array = array;
+	st->size = size;
+	return 0;
+}
+
+void storage_clear(storage *const st)
+{
+	arena_free(st->memory, st->array, st->size * sizeof(int));
+	st->array = NULL;
+	st->size = 0;
+}
+
+
+int env_init(environment *const env, linker *const lk, universal_io *const output)
 {
 	env->output = output;
+	env->output_size = 0;
 
 	env->lk = lk;
 
+	env->memory = arena_create(ARENA_SIZE);
+	if (env->memory == NULL)
+	{
+		return -1;
+	}
+
 	env->rp = 1;
 	env->macro_tab_size = 1;
 	env->change_size = 0;
 	env->local_stack_size = 0;
 	env->calc_string_size = 0;
+	env->parameters_size = 0;
+	env->parameters_table_size = 0;
 	env->if_string_size = 0;
 	env->while_string_size = 0;
 	env->mfirstrp = -1;
@@ -51,50 +110,67 @@ void env_init(environment *const env, linker *const lk, universal_io *const outp
 	env->position = 0;
 	env->nested_if = 0;
 	env->flagint = 1;
-	env->error_string[0] = '\0';
 
 	env->was_error = 0;
-	env->disable_recovery = ws_has_flag(lk->ws, "-Wno");
-
-	for (size_t i = 0; i < HASH; i++)
-	{
-		env->hashtab[i] = 0;
-	}
-
-	for (size_t i = 0; i < MAXTAB; i++)
+	env->disable_recovery = ws_has_option(lk->ws, OPT_NO_RECOVERY);
+
+	// Таблицы растут по мере надобности, начальные размеры рассчитаны на обычную программу
+	env->hashtab = storage_create(env->memory, HASH);
+	env->hashtab_used = 0;
+	env->reprtab = storage_create(env->memory, TAB_SIZE);
+	env->macro_tab = storage_create(env->memory, TAB_SIZE);
+
+	env->mstring = storage_create(env->memory, STRING_SIZE);
+	env->change = storage_create(env->memory, STRING_SIZE);
+	env->localstack = storage_create(env->memory, STRING_SIZE);
+	env->calc_string = storage_create(env->memory, STRING_SIZE);
+
+	// Повторные вызовы функциональных макросов с теми же аргументами читают запомненный текст
+	env->is_memoizing = ws_has_flag(lk->ws, MEMO_FLAG);
+	env->expansions = storage_create(env->memory, STRING_SIZE);
+	env->expansions_size = 0;
+	if (env->is_memoizing)
 	{
-		env->reprtab[i] = 0;
+		env->expansion_keys = map_create(MEMO_SIZE);
 	}
 
-	for (size_t i = 0; i < STRING_SIZE; i++)
+	env->parameters = storage_create(env->memory, STRING_SIZE);
+	env->parameters_table = storage_create(env->memory, STRING_SIZE);
+	env->if_string = storage_create(env->memory, STRING_SIZE);
+	env->while_string = storage_create(env->memory, STRING_SIZE);
+	env->while_runs = storage_create(env->memory, STRING_SIZE);
+
+	env->calc_programs = storage_create(env->memory, STRING_SIZE);
+	env->calc_programs_size = 0;
+	env->if_calc = storage_create(env->memory, STRING_SIZE);
+	env->while_calc = storage_create(env->memory, STRING_SIZE);
+
+	env->oldcurchar = storage_create(env->memory, DEPTH);
+	env->oldnextchar = storage_create(env->memory, DEPTH);
+	env->oldnextch_type = storage_create(env->memory, DEPTH);
+	env->oldnextp = storage_create(env->memory, DEPTH);
+
+	env->error_string_size = STRING_SIZE;
+	env->error_string = arena_alloc(env->memory, env->error_string_size);
+	if (env->error_string == NULL)
 	{
-		env->mstring[i] = 0;
-		env->localstack[i] = 0;
-		env->calc_string[i] = 0;
+		env_clear(env);
+		return -1;
 	}
 
-	for (size_t i = 0; i < STRING_SIZE * 3; i++)
-	{
-		env->change[i] = 0;
-	}
-
-	for (size_t i = 0; i < STRING_SIZE * 2; i++)
-	{
-		env->if_string[i] = 0;
-	}
+	env->error_string[0] = '\0';
+	return 0;
+}
 
-	for (size_t i = 0; i < STRING_SIZE * 5; i++)
+void env_clear(environment *const env)
+{
+	if (env->is_memoizing)
 	{
-		env->while_string[i] = 0;
+		map_clear(&env->expansion_keys);
 	}
 
-	for (size_t i = 0; i < DEPTH; i++)
-	{
-		env->oldcurchar[i] = 0;
-		env->oldnextchar[i] = 0;
-		env->oldnextch_type[i] = 0;
-		env->oldnextp[i] = 0;
-	}
+	arena_clear(env->memory);
+	env->memory = NULL;
 }
 
 void env_clear_error_string(environment *const env)
@@ -109,7 +185,7 @@ void env_add_comment(environment *const env)
 	char buffer[MAX_CMT_SIZE];
 	cmt_to_string(&cmt, buffer);
 
-	uni_printf(env->output, "%s", buffer);
+	env_write(env, buffer, strlen(buffer));
 }
 
 size_t env_skip_str(environment *const env)
@@ -140,10 +216,10 @@ int get_depth(environment *const env)
 
 void m_change_nextch_type(environment *const env, int type, int p)
 {
-	env->oldcurchar[env->depth] = env->curchar;
-	env->oldnextchar[env->depth] = env->nextchar;
-	env->oldnextch_type[env->depth] = env->nextch_type;
-	env->oldnextp[env->depth] = (int)env->nextp;
+	storage_set(&env->oldcurchar, env->depth, env->curchar);
+	storage_set(&env->oldnextchar, env->depth, env->nextchar);
+	storage_set(&env->oldnextch_type, env->depth, env->nextch_type);
+	storage_set(&env->oldnextp, env->depth, (int)env->nextp);
 	env->nextp = p;
 	env->depth++;
 	env->nextch_type = type;
@@ -152,10 +228,10 @@ void m_change_nextch_type(environment *const env, int type, int p)
 void m_old_nextch_type(environment *const env)
 {
 	env->depth--;
-	env->curchar = env->oldcurchar[env->depth];
-	env->nextchar = env->oldnextchar[env->depth];
-	env->nextch_type = env->oldnextch_type[env->depth];
-	env->nextp = env->oldnextp[env->depth];
+	env->curchar = storage_get(&env->oldcurchar, env->depth);
+	env->nextchar = storage_get(&env->oldnextchar, env->depth);
+	env->nextch_type = storage_get(&env->oldnextch_type, env->depth);
+	env->nextp = storage_get(&env->oldnextp, env->depth);
 }
 
 void end_line(environment *const env)
@@ -178,7 +254,67 @@ void m_onemore(environment *const env)
 
 void m_fprintf(environment *const env, int a)
 {
-	uni_print_char(env->output, a);
+	// Символ занимает не больше 4 байт
+	if (env->output_size + 8 > OUTPUT_SIZE)
+	{
+		env_flush(env);
+	}
+
+	if (a >= 0 && a < 0x80)
+	{
+		env->output_buffer[env->output_size++] = (char)a;
+	}
+	else
+	{
+		env->output_size += utf8_to_string(&env->output_buffer[env->output_size], (char32_t)a);
+	}
+}
+
+void env_write(environment *const env, const char *const str, const size_t size)
+{
+	if (env->output_size + size > OUTPUT_SIZE)
+	{
+		env_flush(env);
+	}
+
+	// Длинные фрагменты записываются без копирования в буфер
+	if (size > OUTPUT_SIZE)
+	{
+		out_write(env->output, str, size);
+		return;
+	}
+
+	memcpy(&env->output_buffer[env->output_size], str, size);
+	env->output_size += size;
+}
+
+void env_flush(environment *const env)
+{
+	if (env->output_size != 0)
+	{
+		out_write(env->output, env->output_buffer, env->output_size);
+		env->output_size = 0;
+	}
+}
+
+static int env_error_string_reserve(environment *const env)
+{
+	// Символ занимает не больше 4 байт и завершающий ноль
+	if (env->position + 8 <= env->error_string_size)
+	{
+		return 0;
+	}
+
+	char *const error_string = arena_realloc(env->memory, env->error_string
+		, env->error_string_size, env->error_string_size * 2);
+	if (error_string == NULL)
+	{
+		return -1;
+	}
+
+	env->error_string = error_string;
+	env->error_string_size *= 2;
+	return 0;
 }
 
 void m_coment_skip(environment *const env)
@@ -229,7 +365,7 @@ void m_coment_skip(environment *const env)
 void m_nextch_cange(environment *const env)
 {
 	m_nextch(env);
-	m_change_nextch_type(env, FTYPE, env->localstack[env->curchar + env->local_stack_size]);
+	m_change_nextch_type(env, FTYPE, storage_get(&env->localstack, env->curchar + env->local_stack_size));
 	m_nextch(env);
 }
 
@@ -239,28 +375,28 @@ void m_nextch(environment *const env)
 	{
 		if (env->nextch_type == MTYPE && env->nextp < env->msp)
 		{
-			env->curchar = env->mstring[env->nextp++];
-			env->nextchar = env->mstring[env->nextp];
+			env->curchar = storage_get(&env->mstring, env->nextp++);
+			env->nextchar = storage_get(&env->mstring, env->nextp);
 		}
 		else if (env->nextch_type == CTYPE && env->nextp < env->calc_string_size)
 		{
-			env->curchar = env->calc_string[env->nextp++];
-			env->nextchar = env->calc_string[env->nextp];
+			env->curchar = storage_get(&env->calc_string, env->nextp++);
+			env->nextchar = storage_get(&env->calc_string, env->nextp);
 		}
 		else if (env->nextch_type == IFTYPE && env->nextp < env->if_string_size)
 		{
-			env->curchar = env->if_string[env->nextp++];
-			env->nextchar = env->if_string[env->nextp];
+			env->curchar = storage_get(&env->if_string, env->nextp++);
+			env->nextchar = storage_get(&env->if_string, env->nextp);
 		}
 		else if (env->nextch_type == WHILETYPE && env->nextp < env->while_string_size)
 		{
-			env->curchar = env->while_string[env->nextp++];
-			env->nextchar = env->while_string[env->nextp];
+			env->curchar = storage_get(&env->while_string, env->nextp++);
+			env->nextchar = storage_get(&env->while_string, env->nextp);
 		}
 		else if (env->nextch_type == TEXTTYPE && env->nextp < env->macro_tab_size)
 		{
-			env->curchar = env->macro_tab[env->nextp++];
-			env->nextchar = env->macro_tab[env->nextp];
+			env->curchar = storage_get(&env->macro_tab, env->nextp++);
+			env->nextchar = storage_get(&env->macro_tab, env->nextp);
 
 			if (env->curchar == '\n')
 			{
@@ -275,10 +411,24 @@ void m_nextch(environment *const env)
 				m_old_nextch_type(env);
 			}
 		}
+		else if (env->nextch_type == MEMOTYPE && env->nextp < env->expansions_size)
+		{
+			env->curchar = storage_get(&env->expansions, env->nextp++);
+			env->nextchar = storage_get(&env->expansions, env->nextp);
+
+			if (env->curchar == '\n')
+			{
+				env_add_comment(env);
+			}
+			else if (env->curchar == MACROEND)
+			{
+				m_old_nextch_type(env);
+			}
+		}
 		else if (env->nextch_type == FTYPE)
 		{
-			env->curchar = env->change[env->nextp++];
-			env->nextchar = env->change[env->nextp];
+			env->curchar = storage_get(&env->change, env->nextp++);
+			env->nextchar = storage_get(&env->change, env->nextp);
 
 			if (env->curchar == END_PARAMETER)
 			{
@@ -298,7 +448,10 @@ void m_nextch(environment *const env)
 
 		if (env->curchar != '\n' && env->curchar != EOF)
 		{
-			env->position += utf8_to_string(&env->error_string[env->position], env->curchar);
+			if (!env_error_string_reserve(env))
+			{
+				env->position += utf8_to_string(&env->error_string[env->position], env->curchar);
+			}
 		}
 		else
 		{
@@ -311,6 +464,87 @@ void m_nextch(environment *const env)
 	// env->curchar, env->curchar, env->nextchar, env->nextchar);
 }
 
+void env_skip_inactive(environment *const env)
+{
+	const char *const buffer = in_get_buffer(env->input);
+	if (env->nextch_type != FILETYPE || buffer == NULL || env->nextchar == EOF)
+	{
+		m_nextch(env);
+		return;
+	}
+
+	const size_t size = in_get_size(env->input);
+	const size_t start = in_get_position(env->input) - utf8_size((char32_t)env->nextchar);
+
+	// Чтение возобновляется с начала последней непустой строки, чтобы она осталась в строке ошибки
+	size_t line_start = start;
+	size_t line_lines = 0;
+	size_t resume = start;
+	size_t lines = 0;
+
+	// Байты многобайтовых символов не совпадают с ASCII, поэтому декодировать их не нужно
+	size_t i = start;
+	while (i < size && buffer[i] != '#')
+	{
+		if (buffer[i] == '\n')
+		{
+			line_start = ++i;
+			line_lines++;
+			continue;
+		}
+
+		if (buffer[i] != '\r')
+		{
+			resume = line_start;
+			lines = line_lines;
+		}
+
+		if (buffer[i] == '/' && i + 1 < size && buffer[i + 1] == '/')
+		{
+			const char *const end = memchr(&buffer[i], '\n', size - i);
+			i = end != NULL ? (size_t)(end - buffer) : size;
+		}
+		else if (buffer[i] == '/' && i + 1 < size && buffer[i + 1] == '*')
+		{
+			size_t j = i + 2;
+			size_t comment_lines = 0;
+			while (j + 1 < size && (buffer[j] != '*' || buffer[j + 1] != '/'))
+			{
+				comment_lines += buffer[j++] == '\n';
+			}
+
+			if (j + 1 >= size)
+			{
+				// Незакрытый комментарий читается посимвольно ради сообщения об ошибке
+				break;
+			}
+
+			i = j + 2;
+			if (comment_lines != 0)
+			{
+				line_start = i;
+				line_lines += comment_lines;
+			}
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	if (resume == start)
+	{
+		m_nextch(env);
+		return;
+	}
+
+	env->line += lines;
+	env_clear_error_string(env);
+	in_set_position(env->input, resume);
+	get_next_char(env);
+	m_nextch(env);
+}
+
 void env_error(environment *const env, const int num)
 {
 	const size_t position = env_skip_str(env);
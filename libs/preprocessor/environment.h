@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "arena.h"
 #include "constants.h"
 #include "uniio.h"
 #include "linker.h"
@@ -25,35 +26,63 @@
 extern "C" {
 #endif
 
+/** Growable array of characters and markers, elements after written ones are zero */
+typedef struct storage
+{
+	int *array;					/**< Elements */
+	size_t size;				/**< Number of allocated elements */
+	arena *memory;				/**< Arena of elements */
+} storage;
+
 typedef struct environment
 {
-	int hashtab[256];
-	int reprtab[MAXTAB];
+	arena *memory;
+
+	storage hashtab;
+	size_t hashtab_used;
+	storage reprtab;
 	int rp;
 
-	int macro_tab[MAXTAB];
+	storage macro_tab;
 	size_t macro_tab_size;
 
-	char error_string[STRING_SIZE];
+	char *error_string;
+	size_t error_string_size;
 	size_t position;
 
-	int mstring[STRING_SIZE];
+	storage mstring;
 	size_t msp;
 
-	int change[STRING_SIZE * 3];
+	storage change;
 	size_t change_size;
 
-	int localstack[STRING_SIZE];
+	storage localstack;
 	size_t local_stack_size;
 
-	int calc_string[STRING_SIZE];
+	storage calc_string;
 	size_t calc_string_size;
 
-	int if_string[STRING_SIZE * 2];
+	storage expansions;			/**< Memoized replacement texts of function-like macros */
+	size_t expansions_size;		/**< Size of memoized texts */
+	map expansion_keys;			/**< Offsets of memoized texts by macro definition and arguments */
+	int is_memoizing;			/**< Set, if replacement texts are memoized */
+
+	storage parameters;
+	size_t parameters_size;
+	storage parameters_table;
+	size_t parameters_table_size;
+
+	storage if_string;
 	size_t if_string_size;
 
-	int while_string[STRING_SIZE * 5];
+	storage while_string;
 	size_t while_string_size;
+	storage while_runs;
+
+	storage calc_programs;
+	size_t calc_programs_size;
+	storage if_calc;
+	storage while_calc;
 
 	int mfirstrp;
 
@@ -65,10 +94,10 @@ typedef struct environment
 
 	size_t nextp;
 
-	int oldcurchar[DEPTH];
-	int oldnextchar[DEPTH];
-	int oldnextch_type[DEPTH];
-	int oldnextp[DEPTH];
+	storage oldcurchar;
+	storage oldnextchar;
+	storage oldnextch_type;
+	storage oldnextp;
 	size_t depth;
 
 	int nested_if;
@@ -81,11 +110,93 @@ typedef struct environment
 	universal_io *output;
 	universal_io *input;
 
+	char output_buffer[OUTPUT_SIZE];	/**< Text collected before writing to output */
+	size_t output_size;					/**< Size of collected text */
+
 	int disable_recovery;
 	int was_error;
 } environment;
 
-void env_init(environment *const env, linker *const lk, universal_io *const output);
+
+/**
+ *	Create new storage
+ *
+ *	@param	memory	Arena of elements
+ *	@param	size	Initializer of allocated size
+ *
+ *	@return	Storage
+ */
+storage storage_create(arena *const memory, const size_t size);
+
+/**
+ *	Increase storage to contain index
+ *
+ *	@param	st		Storage
+ *	@param	index	Index
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int storage_reserve(storage *const st, const size_t index);
+
+/**
+ *	Get element, elements outside of storage are zero
+ *
+ *	@param	st		Storage
+ *	@param	index	Index
+ *
+ *	@return	Element
+ */
+inline int storage_get(const storage *const st, const size_t index)
+{
+	return index < st->size ? st->array[index] : 0;
+}
+
+/**
+ *	Set element, increasing storage if necessary
+ *
+ *	@param	st		Storage
+ *	@param	index	Index
+ *	@param	value	Element
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+inline int storage_set(storage *const st, const size_t index, const int value)
+{
+	if (index >= st->size && storage_reserve(st, index))
+	{
+		return -1;
+	}
+
+	st->array[index] = value;
+	return 0;
+}
+
+/**
+ *	Return storage memory to arena
+ *
+ *	@param	st		Storage
+ */
+void storage_clear(storage *const st);
+
+
+/**
+ *	Initialize preprocessor environment, its tables grow in own arena
+ *
+ *	@param	env		Preprocessor environment
+ *	@param	lk		Linker
+ *	@param	output	Output
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int env_init(environment *const env, linker *const lk, universal_io *const output);
+
+/**
+ *	Free preprocessor environment
+ *
+ *	@param	env		Preprocessor environment
+ */
+void env_clear(environment *const env);
+
 void env_clear_error_string(environment *const env);
 
 /**
@@ -102,8 +213,32 @@ int get_depth(environment *const env);
 int get_next_char(environment *const env);
 
 void m_fprintf(environment *const env, int a);
+
+/**
+ *	Write text fragment to the output
+ *
+ *	@param	env		Preprocessor environment
+ *	@param	str		Text fragment
+ *	@param	size	Size of fragment
+ */
+void env_write(environment *const env, const char *const str, const size_t size);
+
+/**
+ *	Write collected text to the output, it should be called before output position is used
+ *
+ *	@param	env		Preprocessor environment
+ */
+void env_flush(environment *const env);
 void m_nextch(environment *const env);
 
+/**
+ *	Skip text of inactive conditional block up to the next '#'.
+ *	Bytes of input buffer are scanned without decoding, comments are still skipped.
+ *
+ *	@param	env		Preprocessor environment
+ */
+void env_skip_inactive(environment *const env);
+
 void env_error(environment *const env, const int num);
 
 #ifdef __cplusplus
@@ -22,6 +22,7 @@
 #include "utils.h"
 #include "uniio.h"
 #include "uniprinter.h"
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -30,15 +31,132 @@ linker lk_create(workspace *const ws)
 	linker lk;
 
 	lk.ws = ws;
-	lk.current = MAX_PATHS;
+	lk.current = SIZE_MAX;
 	lk.count = ws_get_files_num(ws);
 
-	for (size_t i = 0; i < lk.count; i++)
+	lk.included = vector_create(lk.count + MAX_PATHS);
+	vector_increase(&lk.included, lk.count);
+
+	lk.paths = map_create(MAX_PATHS);
+	lk.segments = vector_create(3 * lk.count);
+
+	lk.sources = NULL;
+	lk.sources_size = 0;
+	lk.buffers = map_create(MAX_PATHS);
+
+	lk.resolver = NULL;
+	lk.resolver_data = NULL;
+	return lk;
+}
+
+void lk_clear(linker *const lk)
+{
+	vector_clear(&lk->included);
+	map_clear(&lk->paths);
+	vector_clear(&lk->segments);
+
+	for (size_t i = 0; i < lk->sources_size; i++)
 	{
-		lk.included[i] = 0;
+		free(lk->sources[i]);
 	}
 
-	return lk;
+	free(lk->sources);
+	lk->sources = NULL;
+	lk->sources_size = 0;
+	map_clear(&lk->buffers);
+}
+
+size_t lk_add_file(linker *const lk, const char *const path, const char *const code)
+{
+	const size_t index = code == NULL ? ws_add_file(lk->ws, path) : ws_add_virtual_file(lk->ws, path);
+	if (index == SIZE_MAX)
+	{
+		return SIZE_MAX;
+	}
+
+	if (index == lk->count)
+	{
+		vector_add(&lk->included, 0);
+		lk->count++;
+	}
+
+	if (code == NULL)
+	{
+		return index;
+	}
+
+	if (index >= lk->sources_size)
+	{
+		const size_t size = 2 * index + 1;
+		char **const sources = realloc(lk->sources, size * sizeof(char *));
+		if (sources == NULL)
+		{
+			return SIZE_MAX;
+		}
+
+		for (size_t i = lk->sources_size; i < size; i++)
+		{
+			sources[i] = NULL;
+		}
+
+		lk->sources = sources;
+		lk->sources_size = size;
+	}
+
+	char *const source = malloc(strlen(code) + 1);
+	if (source == NULL)
+	{
+		return SIZE_MAX;
+	}
+
+	free(lk->sources[index]);
+	lk->sources[index] = strcpy(source, code);
+
+	// Индекс файла по пути не меняется, поэтому повторное добавление пути не требуется
+	map_add(&lk->buffers, path, (item_t)index);
+	map_add(&lk->buffers, ws_get_file(lk->ws, index), (item_t)index);
+	return index;
+}
+
+/**
+ *	Open file from disk or standard input
+ *
+ *	@param	input	Input
+ *	@param	path	File path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static inline int lk_open_file(universal_io *const input, const char *const path)
+{
+	// Стандартный ввод читается по блокам, так как его нельзя отобразить в память
+	return strcmp(path, STDIN_PATH) == 0 ? in_set_stream(input, stdin) : in_set_mmap(input, path);
+}
+
+/**
+ *	Open file from memory, from resolver or from disk
+ *
+ *	@param	lk		Linker structure
+ *	@param	input	Input
+ *	@param	path	File path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int lk_open_path(linker *const lk, universal_io *const input, const char *const path)
+{
+	item_t index = map_get(&lk->buffers, path);
+	const char *const code = index == ITEM_MAX && lk->resolver != NULL ? lk->resolver(lk->resolver_data, path) : NULL;
+	if (code != NULL)
+	{
+		const size_t added = lk_add_file(lk, path, code);
+		if (added == SIZE_MAX)
+		{
+			return -1;
+		}
+
+		index = (item_t)added;
+	}
+
+	return index != ITEM_MAX ? in_set_buffer(input, lk->sources[index]) : lk_open_file(input, path);
 }
 
 void lk_make_path(char *const output, const char *const source, const char *const header, const int is_slash)
@@ -67,7 +185,17 @@ size_t lk_open_include(environment *const env, const char* const path)
 	char full_path[MAX_ARG_SIZE];
 	lk_make_path(full_path, lk_get_current(env->lk), path, 1);
 
-	if (in_set_file(env->input, full_path))
+	// Любой файл подключается один раз, поэтому повторное подключение не открывает файл
+	const item_t known = map_get(&env->lk->paths, full_path);
+	if (known != ITEM_MAX && vector_get(&env->lk->included, (size_t)known) != 0)
+	{
+		return SIZE_MAX;
+	}
+
+	char key[MAX_ARG_SIZE];
+	strcpy(key, full_path);
+
+	if (lk_open_path(env->lk, env->input, full_path))
 	{
 		size_t i = 0;
 		const char *dir;
@@ -76,7 +204,7 @@ size_t lk_open_include(environment *const env, const char* const path)
 		{
 			dir = ws_get_dir(env->lk->ws, i++);
 			lk_make_path(full_path, dir, path, 0);
-		} while (dir != NULL && in_set_file(env->input, full_path));
+		} while (dir != NULL && lk_open_path(env->lk, env->input, full_path));
 
 	}
 
@@ -87,12 +215,11 @@ size_t lk_open_include(environment *const env, const char* const path)
 		return SIZE_MAX - 1;
 	}
 
-	const size_t index = ws_add_file(env->lk->ws, full_path);
-	if (index == env->lk->count)
-	{
-		env->lk->included[env->lk->count++] = 0;
-	}
-	else if (env->lk->included[index])
+	const item_t buffer = map_get(&env->lk->buffers, full_path);
+	const size_t index = buffer != ITEM_MAX ? (size_t)buffer : lk_add_file(env->lk, full_path, NULL);
+
+	map_add(&env->lk->paths, key, (item_t)index);
+	if (vector_get(&env->lk->included, index) != 0)
 	{
 		in_clear(env->input);
 		return SIZE_MAX;
@@ -103,7 +230,10 @@ size_t lk_open_include(environment *const env, const char* const path)
 
 int lk_open_source(environment *const env, const size_t index)
 {
-	if (in_set_file(env->input, ws_get_file(env->lk->ws, index)))
+	const int ret = index < env->lk->sources_size && env->lk->sources[index] != NULL
+		? in_set_buffer(env->input, env->lk->sources[index])
+		: lk_open_file(env->input, ws_get_file(env->lk->ws, index));
+	if (ret)
 	{
 		macro_system_error(lk_get_current(env->lk), source_file_not_found);
 		return -1;
@@ -115,13 +245,19 @@ int lk_open_source(environment *const env, const size_t index)
 int lk_preprocess_file(environment *const env, const size_t number)
 {
 	env_clear_error_string(env);
-	env->lk->included[number]++;
+	vector_set(&env->lk->included, number, vector_get(&env->lk->included, number) + 1);
 
 	const size_t old_cur = env->lk->current;
 	const size_t old_line = env->line;
 	env->lk->current = number;
 	env->line = 1;
 
+	// Границы вывода файла нужны, чтобы при склейке пропустить уже выведенные заголовки
+	env_flush(env);
+	const size_t segment = vector_add(&env->lk->segments, (item_t)number);
+	vector_add(&env->lk->segments, (item_t)out_get_position(env->output));
+	vector_add(&env->lk->segments, 0);
+
 	get_next_char(env);
 	m_nextch(env);
 
@@ -137,6 +273,8 @@ int lk_preprocess_file(environment *const env, const size_t number)
 	}
 
 	m_fprintf(env, '\n');
+	env_flush(env);
+	vector_set(&env->lk->segments, segment + 2, (item_t)out_get_position(env->output));
 
 	env->line = old_line;
 	env->lk->current = old_cur;
@@ -230,7 +368,7 @@ int lk_preprocess_all(environment *const env)
 
 	for (size_t i = 0; i < env->lk->count; i++)
 	{
-		if (env->lk->included[i])
+		if (vector_get(&env->lk->included, i) != 0)
 		{
 			continue;
 		}
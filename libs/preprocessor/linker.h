@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include "map.h"
+#include "vector.h"
 #include "workspace.h"
 
 
@@ -25,14 +27,35 @@ extern "C" {
 
 typedef struct environment environment;
 
+/**
+ *	Function returning contents of file by its path
+ *
+ *	@param	data	User data
+ *	@param	path	File path
+ *
+ *	@return	File contents, @c NULL to read file from disk
+ */
+typedef const char *(*macro_resolver)(void *const data, const char *const path);
+
 /** Structure for connecting files */
 typedef struct linker
 {
 	workspace *ws;				/**< Initial arguments */
 
-	int included[MAX_PATHS];	/**< List of already added files */
+	vector included;			/**< Numbers of inclusions of added files */
 	size_t count; 				/**< Number of added files */
 
+	map paths;					/**< Indexes of headers by their paths relative to including files */
+
+	vector segments;			/**< Index, begin and end of output for each preprocessed file */
+
+	char **sources;				/**< Contents of files from memory by indexes, @c NULL for files on disk */
+	size_t sources_size;		/**< Size of sources array */
+	map buffers;				/**< Indexes of files from memory by their paths */
+
+	macro_resolver resolver;	/**< Function returning contents of included files */
+	void *resolver_data;		/**< User data of resolver */
+
 	size_t current; 			/**< Index of the current file */
 } linker;
 
@@ -46,6 +69,24 @@ typedef struct linker
  */
 linker lk_create(workspace *const ws);
 
+/**
+ *	Free linker structure
+ *
+ *	@param	lk		Linker structure
+ */
+void lk_clear(linker *const lk);
+
+/**
+ *	Add file to linker
+ *
+ *	@param	lk		Linker structure
+ *	@param	path	File path
+ *	@param	code	File contents, @c NULL for file on disk
+ *
+ *	@return	File index, @c SIZE_MAX on failure
+ */
+size_t lk_add_file(linker *const lk, const char *const path, const char *const code);
+
 /**
  *	Preprocess all files from workspace
  *
@@ -17,10 +17,130 @@
 #include "macro_load.h"
 #include "calculator.h"
 #include "constants.h"
+#include "counters.h"
 #include "environment.h"
 #include "error.h"
 #include "linker.h"
 #include "utils.h"
+#include "utf8.h"
+#include <stdio.h>
+
+
+#define MAX_MEMO_KEY_SIZE 1024
+
+// Байт 0xFF не встречается в UTF-8 и разделяет части ключа
+#define MEMO_KEY_SEPARATOR '\xFF'
+
+
+/**
+ *	Write normalised argument to memoization key: spaces and tabs outside of literals
+ *	are collapsed to one space and dropped at the ends
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	position	Position of argument in change buffer
+ *	@param	key			Key
+ *	@param	size		Size of key
+ *
+ *	@return	New size of key, @c SIZE_MAX if argument can not be memoized
+ */
+static size_t memo_key_argument(const environment *const env, size_t position, char *const key, size_t size)
+{
+	int quote = 0;
+	int was_space = 0;
+	for (int c = storage_get(&env->change, position++); c != END_PARAMETER; c = storage_get(&env->change, position++))
+	{
+		// Аргументы из нескольких строк сдвигают комментарии с номерами строк, они не запоминаются
+		if (c == '\n' || c <= 0 || size + 8 > MAX_MEMO_KEY_SIZE)
+		{
+			return SIZE_MAX;
+		}
+
+		if (quote == 0 && (c == ' ' || c == '\t'))
+		{
+			was_space = 1;
+			continue;
+		}
+
+		if (was_space && size != 0 && key[size - 1] != MEMO_KEY_SEPARATOR)
+		{
+			key[size++] = ' ';
+		}
+		was_space = 0;
+
+		if (quote != 0 && c == '\\')
+		{
+			key[size++] = (char)c;
+			c = storage_get(&env->change, position++);
+			if (c == '\n' || c <= 0)
+			{
+				return SIZE_MAX;
+			}
+		}
+		else if (c == '"' || c == '\'')
+		{
+			quote = quote == 0 ? c : quote == c ? 0 : quote;
+		}
+
+		size += utf8_to_string(&key[size], (char32_t)c);
+	}
+
+	key[size++] = MEMO_KEY_SEPARATOR;
+	return size;
+}
+
+/**
+ *	Find replacement text of function-like macro with collected arguments,
+ *	substitute arguments to macro body and memoize text if it is not found
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	body		Position of macro body in macro table
+ *	@param	parameters	Index of last macro parameter
+ *
+ *	@return	Position of text in memoized texts, @c SIZE_MAX if it can not be memoized
+ */
+static size_t memo_get(environment *const env, const size_t body, const size_t parameters)
+{
+	// Позиция тела отличает переопределённый макрос, аргументы сравниваются без лишних пробелов
+	char key[MAX_MEMO_KEY_SIZE];
+	size_t size = (size_t)sprintf(key, "%zu%c", body, MEMO_KEY_SEPARATOR);
+	for (size_t i = 0; i <= parameters; i++)
+	{
+		size = memo_key_argument(env, (size_t)storage_get(&env->localstack, i + env->local_stack_size), key, size);
+		if (size == SIZE_MAX)
+		{
+			return SIZE_MAX;
+		}
+	}
+
+	const item_t memoized = map_get_by_span(&env->expansion_keys, key, size);
+	if (memoized != ITEM_MAX)
+	{
+		COUNTER_INC(COUNTER_MACRO_MEMO_HITS);
+		return (size_t)memoized;
+	}
+
+	const size_t position = env->expansions_size;
+	for (size_t i = body; storage_get(&env->macro_tab, i) != MACROEND; i++)
+	{
+		const int c = storage_get(&env->macro_tab, i);
+		if (c != MACROCANGE)
+		{
+			storage_set(&env->expansions, env->expansions_size++, c);
+			continue;
+		}
+
+		const size_t index = (size_t)storage_get(&env->macro_tab, ++i);
+		size_t argument = (size_t)storage_get(&env->localstack, index + env->local_stack_size);
+		for (int a = storage_get(&env->change, argument); a != END_PARAMETER; a = storage_get(&env->change, ++argument))
+		{
+			storage_set(&env->expansions, env->expansions_size++, a);
+		}
+	}
+
+	storage_set(&env->expansions, env->expansions_size++, MACROEND);
+	map_add_by_span(&env->expansion_keys, key, size, (item_t)position);
+	return position;
+}
 
 
 int function_scope_collect(environment *const env, const size_t num, const size_t was_bracket)
@@ -41,7 +161,7 @@ int function_scope_collect(environment *const env, const size_t num, const size_
 					return -1;
 				}
 
-				int loc_change[STRING_SIZE];
+				storage loc_change = storage_create(env->memory, STRING_SIZE);
 				size_t loc_change_size = 0;
 				const int loc_depth = env->nextch_type == FTYPE
 				? get_depth(env) - 1
@@ -49,7 +169,7 @@ int function_scope_collect(environment *const env, const size_t num, const size_
 
 				while (get_depth(env) >= loc_depth) // 1 переход потому что есть префиксная замена
 				{
-					loc_change[loc_change_size++] = env->curchar;
+					storage_set(&loc_change, loc_change_size++, env->curchar);
 					m_nextch(env);
 				}
 
@@ -58,20 +178,21 @@ int function_scope_collect(environment *const env, const size_t num, const size_
 
 				for (size_t i = 0; i < loc_change_size; i++)
 				{
-					env->change[env->change_size++] = loc_change[i];
+					storage_set(&env->change, env->change_size++, storage_get(&loc_change, i));
 				}
+				storage_clear(&loc_change);
 			}
 			else
 			{
 				for (size_t i = 0; i < env->msp; i++)
 				{
-					env->change[env->change_size++] = env->mstring[i];
+					storage_set(&env->change, env->change_size++, storage_get(&env->mstring, i));
 				}
 			}
 		}
 		else if (env->curchar == '(')
 		{
-			env->change[env->change_size++] = env->curchar;
+			storage_set(&env->change, env->change_size++, env->curchar);
 			m_nextch(env);
 
 			if (function_scope_collect(env, num, 0))
@@ -83,7 +204,7 @@ int function_scope_collect(environment *const env, const size_t num, const size_
 		{
 			if (was_bracket == 0)
 			{
-				env->change[env->change_size++] = env->curchar;
+				storage_set(&env->change, env->change_size++, env->curchar);
 				m_nextch(env);
 			}
 
@@ -99,20 +220,20 @@ int function_scope_collect(environment *const env, const size_t num, const size_
 				}
 				for (size_t i = 0; i < env->calc_string_size; i++)
 				{
-					env->change[env->change_size++] = env->calc_string[i];
+					storage_set(&env->change, env->change_size++, storage_get(&env->calc_string, i));
 				}
 			}
 			else
 			{
-				for (size_t i = 0; i < (size_t)env->reprtab[env->rp]; i++)
+				for (size_t i = 0; i < (size_t)storage_get(&env->reprtab, env->rp); i++)
 				{
-					env->change[env->change_size++] = env->reprtab[env->rp + 2 + i];
+					storage_set(&env->change, env->change_size++, storage_get(&env->reprtab, env->rp + 2 + i));
 				}
 			}
 		}
 		else
 		{
-			env->change[env->change_size++] = env->curchar;
+			storage_set(&env->change, env->change_size++, env->curchar);
 			m_nextch(env);
 		}
 	}
@@ -132,7 +253,7 @@ int function_stack_create(environment *const env, const size_t parameters)
 	}
 
 	size_t num = 0;
-	env->localstack[num + env->local_stack_size] = (int)env->change_size;
+	storage_set(&env->localstack, num + env->local_stack_size, (int)env->change_size);
 
 	while (env->curchar != ')')
 	{
@@ -140,12 +261,12 @@ int function_stack_create(environment *const env, const size_t parameters)
 		{
 			return -1;
 		}
-		env->change[env->change_size++] = END_PARAMETER;
+		storage_set(&env->change, env->change_size++, END_PARAMETER);
 
 		if (env->curchar == ',')
 		{
 			num++;
-			env->localstack[num + env->local_stack_size] = (int)env->change_size;
+			storage_set(&env->localstack, num + env->local_stack_size, (int)env->change_size);
 
 			if (num > parameters)
 			{
@@ -168,7 +289,7 @@ int function_stack_create(environment *const env, const size_t parameters)
 			}
 			m_nextch(env);
 
-			env->change_size = env->localstack[env->local_stack_size];
+			env->change_size = storage_get(&env->localstack, env->local_stack_size);
 			return 0;
 		}
 	}
@@ -185,17 +306,27 @@ int macro_get(environment *const env, const size_t index)
 		return -1;
 	}
 
+	COUNTER_INC(COUNTER_MACRO_EXPANSIONS);
 	env->msp = 0;
 
-	int loc_macro_ptr = env->reprtab[index + 1];
-	if (env->macro_tab[loc_macro_ptr++] == MACROFUNCTION)
+	int loc_macro_ptr = storage_get(&env->reprtab, index + 1);
+	if (storage_get(&env->macro_tab, loc_macro_ptr++) == MACROFUNCTION)
 	{
-		if (env->macro_tab[loc_macro_ptr] > -1 && function_stack_create(env, env->macro_tab[loc_macro_ptr]))
+		const int parameters = storage_get(&env->macro_tab, loc_macro_ptr++);
+		if (parameters > -1 && function_stack_create(env, parameters))
 		{
 			return -1;
 		}
-		
-		loc_macro_ptr++;
+
+		const size_t memoized = parameters > -1 && env->is_memoizing
+			? memo_get(env, (size_t)loc_macro_ptr, (size_t)parameters)
+			: SIZE_MAX;
+		if (memoized != SIZE_MAX)
+		{
+			m_change_nextch_type(env, MEMOTYPE, (int)memoized);
+			m_nextch(env);
+			return 0;
+		}
 	}
 
 	m_change_nextch_type(env, TEXTTYPE, loc_macro_ptr);
@@ -203,3 +334,13 @@ int macro_get(environment *const env, const size_t index)
 
 	return 0;
 }
+
+void macro_forget(environment *const env)
+{
+	if (env->is_memoizing)
+	{
+		// Запомненные тексты остаются на месте, так как их может читать текущая подстановка
+		map_clear(&env->expansion_keys);
+		env->expansion_keys = map_create(MEMO_SIZE);
+	}
+}
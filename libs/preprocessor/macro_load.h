@@ -33,6 +33,14 @@ extern "C" {
  */
 int macro_get(environment *const env, const size_t index);
 
+/**
+ *	Forget memoized replacement texts of function-like macros,
+ *	used when macro definitions change
+ *
+ *	@param	env			Preprocessor environment
+ */
+void macro_forget(environment *const env);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -24,30 +24,76 @@
 #include "utils.h"
 
 
-size_t m_equal(environment *const env)
+static int equal_parameter(environment *const env, size_t i)
 {
-	size_t n = 1;
-	for (size_t i = 0; i < env->calc_string_size; i++)
+	size_t j = 0;
+	while (storage_get(&env->parameters, i) == storage_get(&env->mstring, j))
 	{
-		size_t j = 0;
-		while (env->calc_string[i + j] == env->mstring[j])
+		i++;
+		j++;
+		if (storage_get(&env->parameters, i) == '\0' && storage_get(&env->mstring, j) == MACROEND)
 		{
-			j++;
-			if (env->calc_string[i + j] == '\0' && env->mstring[j] == MACROEND)
-			{
-				return n;
-			}
+			return 1;
 		}
+	}
+
+	return 0;
+}
+
+static void parameters_index(environment *const env, const size_t amount)
+{
+	size_t size = 8;
+	while (size < amount * 2)
+	{
+		size *= 2;
+	}
 
-		i += j;
-		while (env->calc_string[i] != '\0')
+	// Номер параметра хранится за началом его имени
+	env->parameters_table_size = size;
+	for (size_t i = 0; i < 2 * size; i++)
+	{
+		storage_set(&env->parameters_table, i, 0);
+	}
+
+	size_t begin = 0;
+	for (size_t n = 1; n <= amount; n++)
+	{
+		const unsigned int hash = name_hash(&env->parameters, begin, '\0');
+		size_t i = hash & (size - 1);
+		while (storage_get(&env->parameters_table, 2 * i) != 0)
 		{
-			i++;
+			i = (i + 1) & (size - 1);
 		}
 
-		n++;
+		storage_set(&env->parameters_table, 2 * i, (int)begin + 1);
+		storage_set(&env->parameters_table, 2 * i + 1, (int)n);
+
+		while (storage_get(&env->parameters, begin) != '\0')
+		{
+			begin++;
+		}
+		begin++;
+	}
+}
+
+
+size_t m_equal(environment *const env)
+{
+	const size_t mask = env->parameters_table_size - 1;
+	for (size_t i = name_hash(&env->mstring, 0, MACROEND) & mask; ; i = (i + 1) & mask)
+	{
+		const int begin = storage_get(&env->parameters_table, 2 * i);
+		if (begin == 0)
+		{
+			return 0;
+		}
+
+		// При повторе имени первым находится первый параметр, он вставлен раньше
+		if (equal_parameter(env, (size_t)begin - 1))
+		{
+			return (size_t)storage_get(&env->parameters_table, 2 * i + 1);
+		}
 	}
-	return 0;
 }
 
 int func_check_macro(environment *const env, int flag_macro_directive)
@@ -58,8 +104,8 @@ int func_check_macro(environment *const env, int flag_macro_directive)
 	const int num = (int)m_equal(env);
 	if (num != 0)
 	{
-		env->macro_tab[env->macro_tab_size++] = MACROCANGE;
-		env->macro_tab[env->macro_tab_size++] = num - 1;
+		storage_set(&env->macro_tab, env->macro_tab_size++, MACROCANGE);
+		storage_set(&env->macro_tab, env->macro_tab_size++, num - 1);
 	}
 	else if (!flag_macro_directive && macro_ptr)
 	{
@@ -72,7 +118,7 @@ int func_check_macro(environment *const env, int flag_macro_directive)
 	{
 		for (size_t i = 0; i < env->msp; i++)
 		{
-			env->macro_tab[env->macro_tab_size++] = env->mstring[i];
+			storage_set(&env->macro_tab, env->macro_tab_size++, storage_get(&env->mstring, i));
 		}
 	}
 
@@ -82,7 +128,7 @@ int func_check_macro(environment *const env, int flag_macro_directive)
 int func_add_ident(environment *const env)
 {
 	int num = 0;
-	env->calc_string_size = 0;
+	env->parameters_size = 0;
 
 	while (env->curchar != ')')
 	{
@@ -92,10 +138,10 @@ int func_add_ident(environment *const env)
 		{
 			while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar))
 			{
-				env->calc_string[env->calc_string_size++] = env->curchar;
+				storage_set(&env->parameters, env->parameters_size++, env->curchar);
 				m_nextch(env);
 			}
-			env->calc_string[env->calc_string_size++] = '\0';
+			storage_set(&env->parameters, env->parameters_size++, '\0');
 		}
 		else
 		{
@@ -117,6 +163,7 @@ int func_add_ident(environment *const env)
 		}
 	}
 	
+	parameters_index(env, (size_t)num + 1);
 	m_nextch(env);
 	return num;
 }
@@ -125,12 +172,12 @@ int macro_tab_add_func(environment *const env)
 {
 	const int flag_macro_directive = env->cur == SH_MACRO;
 
-	env->macro_tab[env->macro_tab_size++] = MACROFUNCTION;
+	storage_set(&env->macro_tab, env->macro_tab_size++, MACROFUNCTION);
 	
 	int empty = 0;
 	if (env->curchar == ')')
 	{
-		env->macro_tab[env->macro_tab_size++] = -1;
+		storage_set(&env->macro_tab, env->macro_tab_size++, -1);
 		empty = 1;
 		m_nextch(env);
 	}
@@ -141,7 +188,7 @@ int macro_tab_add_func(environment *const env)
 		{
 			return -1;
 		}
-		env->macro_tab[env->macro_tab_size++] = res;
+		storage_set(&env->macro_tab, env->macro_tab_size++, res);
 	}
 	skip_separators(env);
 
@@ -166,27 +213,27 @@ int macro_tab_add_func(environment *const env)
 				}
 				for (size_t i = 0; i < env->calc_string_size; i++)
 				{
-					env->macro_tab[env->macro_tab_size++] = env->calc_string[i];
+					storage_set(&env->macro_tab, env->macro_tab_size++, storage_get(&env->calc_string, i));
 				}
 			}
 			else if (flag_macro_directive && env->cur == SH_ENDM)
 			{
 				m_nextch(env);
-				env->macro_tab[env->macro_tab_size++] = MACROEND;
+				storage_set(&env->macro_tab, env->macro_tab_size++, MACROEND);
 				return 0;
 			}
 			else
 			{
 				env->cur = 0;
-				for (size_t i = 0; i < (size_t)env->reprtab[env->rp]; i++)
+				for (size_t i = 0; i < (size_t)storage_get(&env->reprtab, env->rp); i++)
 				{
-					env->macro_tab[env->macro_tab_size++] = env->reprtab[env->rp + 2 + i];
+					storage_set(&env->macro_tab, env->macro_tab_size++, storage_get(&env->reprtab, env->rp + 2 + i));
 				}
 			}
 		}
 		else
 		{
-			env->macro_tab[env->macro_tab_size++] = env->curchar;
+			storage_set(&env->macro_tab, env->macro_tab_size++, env->curchar);
 			m_nextch(env);
 		}
 
@@ -204,12 +251,12 @@ int macro_tab_add_func(environment *const env)
 			{
 				return -1;
 			}
-			//env->macro_tab[env->macro_ptr++] = '\n';
+			//storage_get(&env->macro_tab, env->macro_ptr++) = '\n';
 			m_nextch(env);
 		}
 	}
 
-	env->macro_tab[env->macro_tab_size++] = MACROEND;
+	storage_set(&env->macro_tab, env->macro_tab_size++, MACROEND);
 	return 0;
 }
 
@@ -223,49 +270,38 @@ int define_add_to_reprtab(environment *const env)
 
 	
 	int oldrepr = env->rp;
-	int hash = 0;
 	env->rp += 2;
 
 	do
 	{
-		hash += env->curchar;
-		env->reprtab[env->rp++] = env->curchar;
+		storage_set(&env->reprtab, env->rp++, env->curchar);
 		m_nextch(env);
 	} while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar));
 
-	hash &= 255;
-	env->reprtab[env->rp++] = 0;
-	int r = env->hashtab[hash];
+	storage_set(&env->reprtab, env->rp++, 0);
 
-	while (r)
+	const int r = reprtab_search(env, oldrepr);
+	if (r)
 	{
-		if (equal_reprtab(r, oldrepr, env))
+		if (storage_get(&env->macro_tab, storage_get(&env->reprtab, r + 1)) == MACROUNDEF)
 		{
-			if (env->macro_tab[env->reprtab[r + 1]] == MACROUNDEF)
-			{
-				env->rp = oldrepr;
-				return r;
-			}
-			else
-			{
-				env_error(env, repeat_ident);
-				return -1;
-			}
+			env->rp = oldrepr;
+			return r;
 		}
-		r = env->reprtab[r];
+
+		env_error(env, repeat_ident);
+		return -1;
 	}
 
-	env->reprtab[oldrepr] = env->hashtab[hash];
-	env->reprtab[oldrepr + 1] = (int)env->macro_tab_size;
-	env->hashtab[hash] = oldrepr;
-	return 0;
+	storage_set(&env->reprtab, oldrepr + 1, (int)env->macro_tab_size);
+	return reprtab_add(env, oldrepr) ? -1 : 0;
 }
 
 int macro_tab_add_define(environment *const env, const int rep_ptr)
 {
 	int old_macro_tab_size = (int)env->macro_tab_size;
 
-	env->macro_tab[env->macro_tab_size++] = MACRODEF;
+	storage_set(&env->macro_tab, env->macro_tab_size++, MACRODEF);
 	if (env->curchar != '\n')
 	{
 		while (env->curchar != '\n')
@@ -293,14 +329,14 @@ int macro_tab_add_define(environment *const env, const int rep_ptr)
 
 					for (size_t i = 0; i < env->calc_string_size; i++)
 					{
-						env->macro_tab[env->macro_tab_size++] = env->calc_string[i];
+						storage_set(&env->macro_tab, env->macro_tab_size++, storage_get(&env->calc_string, i));
 					}
 				}
 				else
 				{
-					for (size_t i = 0; i < (size_t)env->reprtab[env->rp]; i++)
+					for (size_t i = 0; i < (size_t)storage_get(&env->reprtab, env->rp); i++)
 					{
-						env->macro_tab[env->macro_tab_size++] = env->reprtab[env->rp + 2 + i];
+						storage_set(&env->macro_tab, env->macro_tab_size++, storage_get(&env->reprtab, env->rp + 2 + i));
 					}
 				}
 			}
@@ -311,7 +347,7 @@ int macro_tab_add_define(environment *const env, const int rep_ptr)
 				{
 					return -1;
 				}
-				//env->macro_tab[env->macro_tab_size++] = '\n';
+				//storage_get(&env->macro_tab, env->macro_tab_size++) = '\n';
 				m_nextch(env);
 			}
 			else if (utf8_is_letter(env->curchar))
@@ -325,33 +361,33 @@ int macro_tab_add_define(environment *const env, const int rep_ptr)
 				{
 					for (size_t i = 0; i < env->msp; i++)
 					{
-						env->macro_tab[env->macro_tab_size++] = env->mstring[i];
+						storage_set(&env->macro_tab, env->macro_tab_size++, storage_get(&env->mstring, i));
 					}
 				}
 			}
 			else
 			{
-				env->macro_tab[env->macro_tab_size++] = env->curchar;
+				storage_set(&env->macro_tab, env->macro_tab_size++, env->curchar);
 				m_nextch(env);
 			}
 		}
 
-		while (env->macro_tab[env->macro_tab_size - 1] == ' ' || env->macro_tab[env->macro_tab_size - 1] == '\t')
+		while (storage_get(&env->macro_tab, env->macro_tab_size - 1) == ' ' || storage_get(&env->macro_tab, env->macro_tab_size - 1) == '\t')
 		{
-			env->macro_tab[env->macro_tab_size - 1] = MACROEND;
+			storage_set(&env->macro_tab, env->macro_tab_size - 1, MACROEND);
 			env->macro_tab_size--;
 		}
 	}
 	else
 	{
-		env->macro_tab[env->macro_tab_size++] = '0';
+		storage_set(&env->macro_tab, env->macro_tab_size++, '0');
 	}
 
-	env->macro_tab[env->macro_tab_size++] = MACROEND;
+	storage_set(&env->macro_tab, env->macro_tab_size++, MACROEND);
 
 	if (rep_ptr)
 	{
-		env->reprtab[rep_ptr + 1] = old_macro_tab_size;
+		storage_set(&env->reprtab, rep_ptr + 1, old_macro_tab_size);
 	}
 	return 0;
 }
@@ -394,7 +430,7 @@ int macro_set(environment *const env)
 	}
 
 	const int macro_ptr = collect_mident(env);	
-	if (env->macro_tab[env->reprtab[macro_ptr + 1]] == MACROFUNCTION)
+	if (storage_get(&env->macro_tab, storage_get(&env->reprtab, macro_ptr + 1)) == MACROFUNCTION)
 	{
 		env_error(env, functions_cannot_be_changed);
 		return -1;
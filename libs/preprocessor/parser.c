@@ -35,7 +35,7 @@ int if_check(environment *const env, int type_if)
 		{
 			return -1;
 		}
-		return env->calc_string[0];
+		return storage_get(&env->calc_string, 0);
 	}
 	else
 	{
@@ -91,7 +91,7 @@ int if_end(environment *const env)
 		}
 		else
 		{
-			m_nextch(env);
+			env_skip_inactive(env);
 		}
 	}
 
@@ -122,7 +122,7 @@ int if_false(environment *const env)
 		}
 		else
 		{
-			m_nextch(env);
+			env_skip_inactive(env);
 		}
 	}
 
@@ -246,16 +246,16 @@ int while_collect(environment *const env)
 {
 	const int oldwsp = (int)env->while_string_size;
 
-	env->while_string[env->while_string_size++] = WHILEBEGIN;
-	env->while_string[env->while_string_size++] = (int)env->if_string_size;
+	storage_set(&env->while_string, env->while_string_size++, WHILEBEGIN);
+	storage_set(&env->while_string, env->while_string_size++, (int)env->if_string_size);
 	env->while_string_size++;
 
 	while (env->curchar != '\n')
 	{
-		env->if_string[env->if_string_size++] = env->curchar;
+		storage_set(&env->if_string, env->if_string_size++, env->curchar);
 		m_nextch(env);
 	}
-	env->if_string[env->if_string_size++] = '\n';
+	storage_set(&env->if_string, env->if_string_size++, '\n');
 	m_nextch(env);
 
 	while (env->curchar != EOF)
@@ -270,21 +270,21 @@ int while_collect(environment *const env)
 			}
 			else if (env->cur == SH_ENDW)
 			{
-				env->while_string[env->while_string_size++] = ' ';
-				env->while_string[oldwsp + 2] = (int)env->while_string_size;
+				storage_set(&env->while_string, env->while_string_size++, ' ');
+				storage_set(&env->while_string, oldwsp + 2, (int)env->while_string_size);
 				env->cur = 0;
 
 				return 0;
 			}
 			else
 			{
-				for (size_t i = 0; i < (size_t)env->reprtab[env->rp]; i++)
+				for (size_t i = 0; i < (size_t)storage_get(&env->reprtab, env->rp); i++)
 				{
-					env->while_string[env->while_string_size++] = env->reprtab[env->rp + 2 + i];
+					storage_set(&env->while_string, env->while_string_size++, storage_get(&env->reprtab, env->rp + 2 + i));
 				}
 			}
 		}
-		env->while_string[env->while_string_size++] = env->curchar;
+		storage_set(&env->while_string, env->while_string_size++, env->curchar);
 		m_nextch(env);
 	}
 
@@ -292,17 +292,55 @@ int while_collect(environment *const env)
 	return -1;
 }
 
+static inline bool while_is_text(const int character)
+{
+	return character > 0 && character != '#' && character != '\'' && character != '\"' && character != '@'
+		&& !utf8_is_letter(character);
+}
+
+/**
+ *	Output text of loop body up to next directive, identifier or string.
+ *	End of each text fragment is found once and reused by next iterations.
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	end			Index after the end of loop body
+ */
+static void while_output(environment *const env, const size_t end)
+{
+	const size_t begin = env->nextp - 1;
+	size_t last = (size_t)storage_get(&env->while_runs, begin);
+	if (last == 0)
+	{
+		last = begin + 1;
+		while (last + 1 < end && while_is_text(storage_get(&env->while_string, last)))
+		{
+			last++;
+		}
+
+		storage_set(&env->while_runs, begin, (int)last);
+	}
+
+	for (size_t i = begin; i < last; i++)
+	{
+		m_fprintf(env, storage_get(&env->while_string, i));
+	}
+
+	env->nextp = last + 1;
+	env->curchar = storage_get(&env->while_string, last);
+	env->nextchar = storage_get(&env->while_string, last + 1);
+}
+
 int while_implementation(environment *const env)
 {
 	const int oldernextp = (int)env->nextp;
-	const size_t end = (size_t)env->while_string[oldernextp + 2];
+	const size_t end = (size_t)storage_get(&env->while_string, oldernextp + 2);
 	int error = 0;
 
 	env->cur = 0;
-	while (env->while_string[oldernextp] == WHILEBEGIN)
+	while (storage_get(&env->while_string, oldernextp) == WHILEBEGIN)
 	{
 		m_nextch(env);
-		m_change_nextch_type(env, IFTYPE, env->while_string[env->nextp]);
+		m_change_nextch_type(env, IFTYPE, storage_get(&env->while_string, env->nextp));
 		m_nextch(env);
 		if (calculate(env, LOGIC))
 		{
@@ -311,7 +349,7 @@ int while_implementation(environment *const env)
 		m_old_nextch_type(env);
 
 
-		if (env->calc_string[0] == 0)
+		if (storage_get(&env->calc_string, 0) == 0)
 		{
 			env->nextp = end;
 			m_nextch(env);
@@ -338,6 +376,10 @@ int while_implementation(environment *const env)
 				env_error(env, must_end_endw);
 				return -1;
 			}
+			else if (env->nextch_type == WHILETYPE && while_is_text(env->curchar))
+			{
+				while_output(env, end);
+			}
 			else
 			{
 				error = preprocess_token(env);
@@ -373,7 +415,8 @@ int preprocess_words(environment *const env)
 			const int macro_ptr = collect_mident(env);;
 			if (macro_ptr)
 			{
-				env->macro_tab[env->reprtab[macro_ptr + 1]] = MACROUNDEF;
+				storage_set(&env->macro_tab, storage_get(&env->reprtab, macro_ptr + 1), MACROUNDEF);
+				macro_forget(env);
 				return skip_line(env);
 			}
 			else
@@ -390,6 +433,7 @@ int preprocess_words(environment *const env)
 		}
 		case SH_SET:
 		{
+			macro_forget(env);
 			return macro_set(env);
 		}
 		case SH_ELSE:
@@ -415,6 +459,9 @@ int preprocess_words(environment *const env)
 		{
 			env->while_string_size = 0;
 			env->if_string_size = 0;
+			calc_reset(env);
+			storage_clear(&env->while_runs);
+			env->while_runs = storage_create(env->memory, STRING_SIZE);
 			if (while_collect(env))
 			{
 				return -1;
@@ -502,7 +549,7 @@ int preprocess_token(environment *const env)
 				{
 					for (size_t i = 0; i < env->msp; i++)
 					{
-						m_fprintf(env, env->mstring[i]);
+						m_fprintf(env, storage_get(&env->mstring, i));
 					}
 				}
 			}
@@ -15,24 +15,40 @@
  */
 
 #include "preprocessor.h"
+#include "cache.h"
 #include "constants.h"
+#include "dependencies.h"
 #include "environment.h"
 #include "error.h"
 #include "linker.h"
+#include "macro_save.h"
 #include "parser.h"
+#include "scheduler.h"
 #include "uniio.h"
 #include "uniprinter.h"
 #include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 const size_t SIZE_OUT_BUFFER = 1024;
 
 
+/** Input file preprocessed by its own environment */
+typedef struct unit
+{
+	workspace ws;				/**< Workspace with the only input file */
+	linker lk;					/**< Linker of unit */
+	char *buffer;				/**< Preprocessed text */
+	int ret;					/**< @c 0 on success, @c -1 on failure */
+} unit;
+
+
 void to_reprtab(environment *const env, const char str[], int num)
 {
 	int i = 0;
 	int oldrepr = env->rp;
-	int hash = 0;
 	//unsigned char firstchar;
 	//unsigned char secondchar;
 	//int p;
@@ -56,15 +72,12 @@ void to_reprtab(environment *const env, const char str[], int num)
 		c = utf8_convert(&str[i]);
 		i += (int)utf8_symbol_size(str[i]);
 
-		hash += c;
-		env->reprtab[env->rp++] = c;
+		storage_set(&env->reprtab, env->rp++, c);
 	}
 
-	hash &= 255;
-	env->reprtab[env->rp++] = 0;
-	env->reprtab[oldrepr] = env->hashtab[hash];
-	env->reprtab[oldrepr + 1] = num;
-	env->hashtab[hash] = oldrepr;
+	storage_set(&env->reprtab, env->rp++, 0);
+	storage_set(&env->reprtab, oldrepr + 1, num);
+	reprtab_add(env, oldrepr);
 }
 
 void to_reprtab_full(environment *const env, const char str1[], const char str2[], const char str3[], const char str4[], int num)
@@ -97,17 +110,197 @@ void add_keywods(environment *const env)
 	to_reprtab_full(env, "#INCLUDE", "#include", "#ДОБАВИТЬ", "#добавить", SH_INCLUDE);
 }
 
-int macro_form_io(workspace *const ws, universal_io *const output)
+/**
+ *	Add macro from definition string as @c #define does
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	definition	Macro name and value ending with new line
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int macro_predefine(environment *const env, const char *const definition)
 {
-	linker lk = lk_create(ws);
+	universal_io input = io_create();
+	if (in_set_buffer(&input, definition))
+	{
+		return -1;
+	}
 
+	env->input = &input;
+	env->prep_flag = 1;
+	env_clear_error_string(env);
+
+	get_next_char(env);
+	m_nextch(env);
+
+	const int ret = macro_add(env);
+	in_clear(&input);
+	return ret;
+}
+
+static int macro_form_linker(linker *const lk, const strings *const defines, universal_io *const output)
+{
 	environment env;
-	env_init(&env, &lk, output);
+	if (env_init(&env, lk, output))
+	{
+		return -1;
+	}
 
 	add_keywods(&env);
 	env.mfirstrp = env.rp;
 
-	return lk_preprocess_all(&env);
+	for (size_t i = 0; defines != NULL && i < strings_size(defines); i++)
+	{
+		if (macro_predefine(&env, strings_get(defines, i)))
+		{
+			env_clear(&env);
+			return -1;
+		}
+	}
+
+	const int ret = lk_preprocess_all(&env);
+	env_clear(&env);
+	return ret;
+}
+
+
+static void unit_preprocess(void *const context, const size_t index)
+{
+	unit *const u = &((unit *)context)[index];
+
+	universal_io io = io_create();
+	if (out_set_buffer(&io, SIZE_OUT_BUFFER))
+	{
+		u->ret = -1;
+		return;
+	}
+
+	u->ret = macro_form_linker(&u->lk, NULL, &io);
+	u->buffer = out_extract_buffer(&io);
+	io_erase(&io);
+}
+
+/**
+ *	Write output of file from unit segments, skipping files already written by previous files
+ *
+ *	@param	u		Unit
+ *	@param	written	Paths of written files
+ *	@param	output	Output
+ *	@param	index	Index of file segment
+ *	@param	is_skip	Set, if enclosing file is skipped
+ *
+ *	@return	Index of segment after nested ones
+ */
+static size_t unit_write(const unit *const u, map *const written, universal_io *const output
+	, const size_t index, bool is_skip)
+{
+	const vector *const segments = &u->lk.segments;
+	const char *const path = ws_get_file(&u->ws, (size_t)vector_get(segments, index));
+	const size_t end = (size_t)vector_get(segments, index + 2);
+
+	if (!is_skip && map_get(written, path) != ITEM_MAX)
+	{
+		is_skip = true;
+	}
+	else if (!is_skip)
+	{
+		map_add(written, path, 0);
+	}
+
+	size_t position = (size_t)vector_get(segments, index + 1);
+	size_t next = index + 3;
+	while (next < vector_size(segments) && (size_t)vector_get(segments, next + 1) < end)
+	{
+		if (!is_skip)
+		{
+			out_write(output, &u->buffer[position], (size_t)vector_get(segments, next + 1) - position);
+		}
+
+		position = (size_t)vector_get(segments, next + 2);
+		next = unit_write(u, written, output, next, is_skip);
+	}
+
+	if (!is_skip)
+	{
+		out_write(output, &u->buffer[position], end - position);
+	}
+
+	return next;
+}
+
+static int macro_form_io_parallel(workspace *const ws, universal_io *const output)
+{
+	const size_t num = ws_get_files_num(ws);
+	unit *const units = malloc(num * sizeof(unit));
+	if (units == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < num; i++)
+	{
+		units[i].ws = ws_create();
+		ws_add_file(&units[i].ws, ws_get_file(ws, i));
+		for (size_t j = 0; j < ws_get_dirs_num(ws); j++)
+		{
+			ws_add_dir(&units[i].ws, ws_get_dir(ws, j));
+		}
+		for (size_t j = 0; j < ws_get_flags_num(ws); j++)
+		{
+			ws_add_flag(&units[i].ws, ws_get_flag(ws, j));
+		}
+
+		units[i].lk = lk_create(&units[i].ws);
+		units[i].buffer = NULL;
+		units[i].ret = -1;
+	}
+
+	// Файлы обрабатываются общим планировщиком, поэтому вложенные задачи не занимают лишних ядер
+	scheduler_set_jobs(ws_get_jobs(ws));
+	scheduler_for(&unit_preprocess, units, num);
+
+	int ret = 0;
+	for (size_t i = 0; i < num; i++)
+	{
+		ret = ret || units[i].ret;
+	}
+
+	// Заголовок, подключенный несколькими файлами, выводится один раз, как и при общем окружении
+	map written = map_create(MAX_PATHS);
+	for (size_t i = 0; i < num; i++)
+	{
+		if (!ret && vector_size(&units[i].lk.segments) != 0)
+		{
+			unit_write(&units[i], &written, output, 0, false);
+		}
+
+		// Подключенные файлы попадают в общее рабочее пространство, как при последовательной обработке
+		for (size_t j = 1; j < ws_get_files_num(&units[i].ws); j++)
+		{
+			ws_add_file(ws, ws_get_file(&units[i].ws, j));
+		}
+
+		free(units[i].buffer);
+		lk_clear(&units[i].lk);
+		ws_clear(&units[i].ws);
+	}
+
+	map_clear(&written);
+	free(units);
+	return ret ? -1 : 0;
+}
+
+int macro_form_io(workspace *const ws, universal_io *const output)
+{
+	if (ws_has_option(ws, OPT_PARALLEL))
+	{
+		return macro_form_io_parallel(ws, output);
+	}
+
+	linker lk = lk_create(ws);
+	const int ret = macro_form_linker(&lk, NULL, output);
+	lk_clear(&lk);
+	return ret;
 }
 
 /*
@@ -126,6 +319,15 @@ char *macro(workspace *const ws)
 		return NULL;
 	}
 
+	const size_t sources = ws_get_files_num(ws);
+	const uint64_t key = cache_key(ws);
+	char *const cached = cache_load(ws, key);
+	if (cached != NULL)
+	{
+		deps_save(ws, sources);
+		return cached;
+	}
+
 	universal_io io = io_create();
 	if (out_set_buffer(&io, SIZE_OUT_BUFFER))
 	{
@@ -140,7 +342,10 @@ char *macro(workspace *const ws)
 	}
 
 	in_clear(&io);
-	return out_extract_buffer(&io);
+	char *const buffer = out_extract_buffer(&io);
+	cache_save(ws, key, buffer);
+	deps_save(ws, sources);
+	return buffer;
 }
 
 int macro_to_file(workspace *const ws, const char *const path)
@@ -151,12 +356,29 @@ int macro_to_file(workspace *const ws, const char *const path)
 	}
 
 	universal_io io = io_create();
+	if (cache_is_enabled(ws))
+	{
+		// Сохраняемый в кеше вывод нужен целиком, поэтому формируется в памяти
+		char *const buffer = macro(ws);
+		const int ret = buffer == NULL || out_set_file(&io, path)
+			|| out_write(&io, buffer, strlen(buffer)) < 0 ? -1 : 0;
+
+		free(buffer);
+		io_erase(&io);
+		return ret;
+	}
+
 	if (out_set_file(&io, path))
 	{
 		return -1;
 	}
 
+	const size_t sources = ws_get_files_num(ws);
 	int ret = macro_form_io(ws, &io);
+	if (!ret)
+	{
+		deps_save(ws, sources);
+	}
 
 	io_erase(&io);
 	return ret;
@@ -178,3 +400,110 @@ int auto_macro_to_file(const int argc, const char *const *const argv, const char
 	ws_clear(&ws);
 	return ret;
 }
+
+
+macro_context *macro_create(void)
+{
+	macro_context *const ctx = malloc(sizeof(macro_context));
+	if (ctx == NULL)
+	{
+		return NULL;
+	}
+
+	ctx->ws = ws_create();
+	ctx->lk = lk_create(&ctx->ws);
+	ctx->defines = strings_create(MAX_PATHS);
+	ctx->error_log = NULL;
+	return ctx;
+}
+
+int macro_add_file(macro_context *const ctx, const char *const path)
+{
+	return ctx == NULL || lk_add_file(&ctx->lk, path, NULL) == SIZE_MAX ? -1 : 0;
+}
+
+int macro_add_buffer(macro_context *const ctx, const char *const path, const char *const code)
+{
+	return ctx == NULL || code == NULL || lk_add_file(&ctx->lk, path, code) == SIZE_MAX ? -1 : 0;
+}
+
+int macro_add_dir(macro_context *const ctx, const char *const path)
+{
+	return ctx == NULL || ws_add_dir(&ctx->ws, path) == SIZE_MAX ? -1 : 0;
+}
+
+int macro_define(macro_context *const ctx, const char *const name, const char *const value)
+{
+	if (ctx == NULL || name == NULL || name[0] == '\0')
+	{
+		return -1;
+	}
+
+	const char *const text = value != NULL ? value : "";
+	char *const definition = malloc(strlen(name) + strlen(text) + 3);
+	if (definition == NULL)
+	{
+		return -1;
+	}
+
+	sprintf(definition, "%s %s\n", name, text);
+	const size_t index = strings_add(&ctx->defines, definition);
+	free(definition);
+	return index == SIZE_MAX ? -1 : 0;
+}
+
+void macro_set_resolver(macro_context *const ctx, const macro_resolver func, void *const data)
+{
+	if (ctx != NULL)
+	{
+		ctx->lk.resolver = func;
+		ctx->lk.resolver_data = data;
+	}
+}
+
+void macro_set_error_log(macro_context *const ctx, const logger func)
+{
+	if (ctx != NULL)
+	{
+		ctx->error_log = func;
+	}
+}
+
+char *macro_finish(macro_context *const ctx)
+{
+	if (ctx == NULL || !ws_is_correct(&ctx->ws) || ws_get_files_num(&ctx->ws) == 0)
+	{
+		return NULL;
+	}
+
+	universal_io io = io_create();
+	if (out_set_buffer(&io, SIZE_OUT_BUFFER))
+	{
+		return NULL;
+	}
+
+	const logger previous = set_thread_error_log(ctx->error_log);
+	const int ret = macro_form_linker(&ctx->lk, &ctx->defines, &io);
+	set_thread_error_log(previous);
+
+	if (ret)
+	{
+		io_erase(&io);
+		return NULL;
+	}
+
+	return out_extract_buffer(&io);
+}
+
+void macro_destroy(macro_context *const ctx)
+{
+	if (ctx == NULL)
+	{
+		return;
+	}
+
+	lk_clear(&ctx->lk);
+	strings_clear(&ctx->defines);
+	ws_clear(&ctx->ws);
+	free(ctx);
+}
@@ -18,6 +18,8 @@
 
 #include "environment.h"
 #include "dll.h"
+#include "logger.h"
+#include "strings.h"
 #include "workspace.h"
 
 
@@ -25,8 +27,23 @@
 extern "C" {
 #endif
 
+/** Preprocessing job with its own files, macros and error log */
+typedef struct macro_context
+{
+	workspace ws;				/**< Files and include directories */
+	linker lk;					/**< Linker of job */
+	strings defines;			/**< Predefined macros */
+	logger error_log;			/**< Error logging function, @c NULL for common one */
+} macro_context;
+
+
 /**
- *	Preprocess files from workspace
+ *	Preprocess files from workspace.
+ *	With @c --parallel flag each file is preprocessed by its own environment on a worker thread,
+ *	so macros are not shared between files, and headers are still written once.
+ *	With @c --macro-cache flag output is reused while files it was built from are unchanged.
+ *	With @c --macro-memo flag replacement texts of function-like macros are reused
+ *	for calls with the same arguments until @c #undef or @c #set.
  *
  *	@param	ws		Workspace
  *
@@ -66,6 +83,92 @@ EXPORTED char *auto_macro(const int argc, const char *const *const argv);
  */
 EXPORTED int auto_macro_to_file(const int argc, const char *const *const argv, const char *const path);
 
+
+/**
+ *	Create preprocessing job.
+ *	Jobs do not share state, so different threads may run their own jobs concurrently.
+ *
+ *	@return	Preprocessing job, @c NULL on failure
+ */
+EXPORTED macro_context *macro_create(void);
+
+/**
+ *	Add source file from disk
+ *
+ *	@param	ctx		Preprocessing job
+ *	@param	path	File path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int macro_add_file(macro_context *const ctx, const char *const path);
+
+/**
+ *	Add source file from memory, its path is used by includes and in error messages.
+ *	Contents are copied, so buffer may be freed after call.
+ *
+ *	@param	ctx		Preprocessing job
+ *	@param	path	File path
+ *	@param	code	File contents
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int macro_add_buffer(macro_context *const ctx, const char *const path, const char *const code);
+
+/**
+ *	Add include directory
+ *
+ *	@param	ctx		Preprocessing job
+ *	@param	path	Directory path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int macro_add_dir(macro_context *const ctx, const char *const path);
+
+/**
+ *	Define macro before preprocessing, as @c #define does
+ *
+ *	@param	ctx		Preprocessing job
+ *	@param	name	Macro name
+ *	@param	value	Macro value, @c NULL for empty one
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int macro_define(macro_context *const ctx, const char *const name, const char *const value);
+
+/**
+ *	Set function returning contents of included files.
+ *	It is called before reading file from disk, returned contents are copied.
+ *
+ *	@param	ctx		Preprocessing job
+ *	@param	func	Resolver, @c NULL to read files from disk only
+ *	@param	data	User data passed to resolver
+ */
+EXPORTED void macro_set_resolver(macro_context *const ctx, const macro_resolver func, void *const data);
+
+/**
+ *	Set error logging function of job, it is used by the thread running @ref macro_finish()
+ *
+ *	@param	ctx		Preprocessing job
+ *	@param	func	Custom logging function, @c NULL for common one
+ */
+EXPORTED void macro_set_error_log(macro_context *const ctx, const logger func);
+
+/**
+ *	Preprocess files of job, should be called once
+ *
+ *	@param	ctx		Preprocessing job
+ *
+ *	@return	Preprocessed string (need to use @c free() function), @c NULL on failure
+ */
+EXPORTED char *macro_finish(macro_context *const ctx);
+
+/**
+ *	Free preprocessing job
+ *
+ *	@param	ctx		Preprocessing job
+ */
+EXPORTED void macro_destroy(macro_context *const ctx);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
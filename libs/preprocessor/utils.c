@@ -27,17 +27,98 @@
 #include <string.h>
 
 
+#define HASH_OFFSET	2166136261u
+#define HASH_PRIME	16777619u
+
+
+static int hashtab_insert(storage *const table, const int r, const unsigned int hash)
+{
+	const size_t mask = table->size - 1;
+	size_t i = hash & mask;
+	while (storage_get(table, i) != 0)
+	{
+		i = (i + 1) & mask;
+	}
+
+	return storage_set(table, i, r);
+}
+
+static int hashtab_increase(environment *const env)
+{
+	storage table = storage_create(env->memory, env->hashtab.size * 2);
+	if (table.size == 0)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < env->hashtab.size; i++)
+	{
+		const int r = storage_get(&env->hashtab, i);
+		if (r != 0)
+		{
+			hashtab_insert(&table, r, (unsigned int)storage_get(&env->reprtab, r));
+		}
+	}
+
+	storage_clear(&env->hashtab);
+	env->hashtab = table;
+	return 0;
+}
+
+
+unsigned int name_hash(const storage *const st, size_t index, const int end)
+{
+	// FNV-1a по кодам символов
+	unsigned int hash = HASH_OFFSET;
+	for (int c = storage_get(st, index); c != end; c = storage_get(st, ++index))
+	{
+		hash = (hash ^ (unsigned int)c) * HASH_PRIME;
+	}
+
+	return hash;
+}
+
+int reprtab_search(environment *const env, const int r)
+{
+	const unsigned int hash = name_hash(&env->reprtab, (size_t)r + 2, 0);
+	const size_t mask = env->hashtab.size - 1;
+
+	for (size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		const int entry = storage_get(&env->hashtab, i);
+		if (entry == 0 || ((unsigned int)storage_get(&env->reprtab, entry) == hash && equal_reprtab(entry, r, env)))
+		{
+			return entry;
+		}
+	}
+}
+
+int reprtab_add(environment *const env, const int r)
+{
+	// Таблица заполнена не больше чем наполовину, поэтому поиск всегда находит пустое место
+	if ((env->hashtab_used + 1) * 2 > env->hashtab.size && hashtab_increase(env))
+	{
+		return -1;
+	}
+
+	// На месте бывшей ссылки по цепочке хранится хеш имени
+	const unsigned int hash = name_hash(&env->reprtab, (size_t)r + 2, 0);
+	storage_set(&env->reprtab, r, (int)hash);
+	env->hashtab_used++;
+	return hashtab_insert(&env->hashtab, r, hash);
+}
+
 int equal_reprtab(int i, int j, environment *const env)
 {
 	i += 2;
 	j += 2;
 
-	while (env->reprtab[i] == env->reprtab[j])
+	while (storage_get(&env->reprtab, i) == storage_get(&env->reprtab, j))
 	{
 		i++;
 		j++;
 
-		if (env->reprtab[i] == 0 && env->reprtab[j] == 0)
+		if (storage_get(&env->reprtab, i) == 0 && storage_get(&env->reprtab, j) == 0)
 		{
 			return 1;
 		}
@@ -48,24 +129,21 @@ int equal_reprtab(int i, int j, environment *const env)
 
 void output_keywords(environment *const env)
 {
-	for (size_t j = 0; j < (size_t)env->reprtab[env->rp]; j++)
+	for (size_t j = 0; j < (size_t)storage_get(&env->reprtab, env->rp); j++)
 	{
-		m_fprintf(env, env->reprtab[env->rp + 2 + j]);
+		m_fprintf(env, storage_get(&env->reprtab, env->rp + 2 + j));
 	}
 }
 
 int macro_keywords(environment *const env)
 {
 	int oldrepr = env->rp;
-	int r = 0;
 	int n = 0;
 
 	env->rp += 2;
-	int hash = 0;
 	do
 	{
-		hash += env->curchar;
-		env->reprtab[env->rp++] = env->curchar;
+		storage_set(&env->reprtab, env->rp++, env->curchar);
 		n++;
 		m_nextch(env);
 	} while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar));
@@ -77,29 +155,12 @@ int macro_keywords(environment *const env)
 		env_error(env, after_ident_must_be_space);
 	}*/
 
-	hash &= 255;
-	env->reprtab[env->rp++] = 0;
-	r = env->hashtab[hash];
-	if (r)
-	{
-		do
-		{
-			if (equal_reprtab(r, oldrepr, env))
-			{
-				env->rp = oldrepr;
-				env->reprtab[env->rp] = n;
-				return (env->reprtab[r + 1] < 0) ? env->reprtab[r + 1] : 0;
-			}
-			else
-			{
-				r = env->reprtab[r];
-			}
-		} while (r);
-	}
+	storage_set(&env->reprtab, env->rp++, 0);
+	const int r = reprtab_search(env, oldrepr);
 
 	env->rp = oldrepr;
-	env->reprtab[env->rp] = n;
-	return 0;
+	storage_set(&env->reprtab, env->rp, n);
+	return r && storage_get(&env->reprtab, r + 1) < 0 ? storage_get(&env->reprtab, r + 1) : 0;
 }
 
 int mf_equal(int i, environment *const env)
@@ -107,11 +168,11 @@ int mf_equal(int i, environment *const env)
 	int j = 0;
 	i += 2;
 
-	while (env->reprtab[i] == env->mstring[j])
+	while (storage_get(&env->reprtab, i) == storage_get(&env->mstring, j))
 	{
 		i++;
 		j++;
-		if (env->reprtab[i] == 0 && env->mstring[j] == MACROEND)
+		if (storage_get(&env->reprtab, i) == 0 && storage_get(&env->mstring, j) == MACROEND)
 		{
 			return 1;
 		}
@@ -122,32 +183,39 @@ int mf_equal(int i, environment *const env)
 
 int collect_mident(environment *const env)
 {
-	int r;
-	int hash = 0;
 	env->msp = 0;
 
 	while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar))
 	{
-		env->mstring[env->msp++] = env->curchar;
-		hash += env->curchar;
+		storage_set(&env->mstring, env->msp++, env->curchar);
 		m_nextch(env);
 	}
 
-	env->mstring[env->msp] = MACROEND;
-	hash &= 255;
-	r = env->hashtab[hash];
+	return mident_search(env);
+}
 
-	while (r)
+int mident_search(environment *const env)
+{
+	storage_set(&env->mstring, env->msp, MACROEND);
+
+	const unsigned int hash = name_hash(&env->mstring, 0, MACROEND);
+	const size_t mask = env->hashtab.size - 1;
+
+	for (size_t i = hash & mask; ; i = (i + 1) & mask)
 	{
-		if (r >= env->mfirstrp && mf_equal(r, env))
+		const int r = storage_get(&env->hashtab, i);
+		if (r == 0)
 		{
-			return (env->macro_tab[env->reprtab[r + 1]] != MACROUNDEF) ? r : 0;
+			return 0;
 		}
 
-		r = env->reprtab[r];
+		// Имена в таблице не повторяются, ключевые слова макросами не являются
+		if ((unsigned int)storage_get(&env->reprtab, r) == hash && mf_equal(r, env))
+		{
+			return r >= env->mfirstrp && storage_get(&env->macro_tab, storage_get(&env->reprtab, r + 1)) != MACROUNDEF
+				? r : 0;
+		}
 	}
-
-	return 0;
 }
 
 int skip_line(environment *const env)
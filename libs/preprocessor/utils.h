@@ -23,11 +23,51 @@
 extern "C" {
 #endif
 
+/**
+ *	Calculate hash of name
+ *
+ *	@param	st		Storage with name
+ *	@param	index	Index of first character
+ *	@param	end		Terminating element
+ *
+ *	@return	Hash
+ */
+unsigned int name_hash(const storage *const st, size_t index, const int end);
+
+/**
+ *	Find name in representations table
+ *
+ *	@param	env		Preprocessor environment
+ *	@param	r		Index of new representation with the name
+ *
+ *	@return	Index of representation, @c 0 if name is absent
+ */
+int reprtab_search(environment *const env, const int r);
+
+/**
+ *	Add representation to hash table, so that it can be found by name
+ *
+ *	@param	env		Preprocessor environment
+ *	@param	r		Index of representation
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int reprtab_add(environment *const env, const int r);
+
 int equal_reprtab(int i, int j, environment *const env);
 void output_keywords(environment *const env);
 int macro_keywords(environment *const env);
 int collect_mident(environment *const env);
 
+/**
+ *	Find defined macro by name collected in macro string
+ *
+ *	@param	env		Preprocessor environment
+ *
+ *	@return	Index of macro representation, @c 0 if macro is absent
+ */
+int mident_search(environment *const env);
+
 /**
  *	Skip all spaces and tabs to the end of the line
  *
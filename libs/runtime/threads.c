@@ -0,0 +1,607 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#ifdef __linux__
+	// Declare syscall and affinity functions beside POSIX ones
+	#define _GNU_SOURCE
+#endif
+
+#include "threads.h"
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef __linux__
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+
+/** Message in mailbox */
+typedef struct message
+{
+	_Atomic(struct message *) next;		/**< Next message in queue */
+	int32_t sender;						/**< Sender number */
+	int32_t data;						/**< Message data */
+} message;
+
+/** Intrusive MPSC queue of messages by D. Vyukov */
+typedef struct mailbox
+{
+	_Atomic(message *) head;			/**< Last pushed message, changed by senders */
+	message *tail;						/**< First message to pop, changed by receiver only */
+	message stub;						/**< Stub message, so that queue is never empty */
+	atomic_int pending;					/**< Number of pushed messages */
+} mailbox;
+
+/** RuC thread */
+typedef struct thread
+{
+	thread_func func;					/**< Thread function */
+	atomic_int is_done;					/**< Set when function has finished */
+	mailbox box;						/**< Incoming messages */
+} thread;
+
+/** Pool worker, which runs thread functions one by one */
+typedef struct worker
+{
+	pthread_t handle;					/**< System thread */
+	atomic_int task;					/**< Number of thread to run, @c 0 if idle, @c -1 to stop */
+	jmp_buf exit;						/**< Return point for t_exit */
+	struct worker *next;				/**< Next idle worker */
+} worker;
+
+/** Counting semaphore */
+typedef struct semaphore
+{
+	atomic_int value;					/**< Current value */
+	atomic_int waiters;					/**< Number of waiting threads */
+} semaphore;
+
+
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static thread threads[MAX_THREADS];
+static atomic_int threads_amount;
+
+static worker workers[MAX_THREADS];
+static size_t workers_amount;
+static worker *idle;
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static semaphore semaphores[MAX_SEMAPHORES];
+static atomic_int semaphores_amount;
+
+static _Thread_local int32_t current_num;
+static _Thread_local worker *current_worker;
+
+static _Thread_local bool is_realtime;
+static _Thread_local struct timespec period;
+static _Thread_local struct timespec deadline;
+
+
+static inline void futex_wait(atomic_int *const address, const int value)
+{
+#ifdef __linux__
+	syscall(SYS_futex, (int *)address, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+	// Без futex ожидающий поток просто уступает процессор
+	(void)address;
+	(void)value;
+	sched_yield();
+#endif
+}
+
+static inline void futex_wake(atomic_int *const address, const int amount)
+{
+#ifdef __linux__
+	syscall(SYS_futex, (int *)address, FUTEX_WAKE_PRIVATE, amount, NULL, NULL, 0);
+#else
+	(void)address;
+	(void)amount;
+#endif
+}
+
+
+static void mailbox_init(mailbox *const box)
+{
+	atomic_store(&box->stub.next, NULL);
+	atomic_store(&box->head, &box->stub);
+	box->tail = &box->stub;
+	atomic_store(&box->pending, 0);
+}
+
+static void mailbox_push(mailbox *const box, message *const msg)
+{
+	atomic_store(&msg->next, NULL);
+	message *const prev = atomic_exchange(&box->head, msg);
+	atomic_store(&prev->next, msg);
+}
+
+static message *mailbox_pop(mailbox *const box)
+{
+	message *tail = box->tail;
+	message *next = atomic_load(&tail->next);
+
+	if (tail == &box->stub)
+	{
+		if (next == NULL)
+		{
+			return NULL;
+		}
+
+		box->tail = next;
+		tail = next;
+		next = atomic_load(&tail->next);
+	}
+
+	if (next != NULL)
+	{
+		box->tail = next;
+		return tail;
+	}
+
+	// Отправитель уже занял место в очереди, но ещё не связал сообщение
+	if (tail != atomic_load(&box->head))
+	{
+		return NULL;
+	}
+
+	mailbox_push(box, &box->stub);
+	next = atomic_load(&tail->next);
+	if (next != NULL)
+	{
+		box->tail = next;
+		return tail;
+	}
+
+	return NULL;
+}
+
+
+static void timespec_add(struct timespec *const time, const struct timespec *const delta)
+{
+	time->tv_sec += delta->tv_sec;
+	time->tv_nsec += delta->tv_nsec;
+	if (time->tv_nsec >= 1000000000)
+	{
+		time->tv_sec++;
+		time->tv_nsec -= 1000000000;
+	}
+}
+
+static bool timespec_less(const struct timespec *const left, const struct timespec *const right)
+{
+	return left->tv_sec < right->tv_sec || (left->tv_sec == right->tv_sec && left->tv_nsec < right->tv_nsec);
+}
+
+/** Restore default scheduling of worker, so that next thread function does not inherit it */
+static void realtime_reset(void)
+{
+	if (!is_realtime)
+	{
+		return;
+	}
+
+	t_set_priority(0, 0);
+	t_set_affinity(-1);
+	period = (struct timespec){ 0, 0 };
+	is_realtime = false;
+}
+
+
+static void runtime_init(void)
+{
+	for (size_t i = 0; i < MAX_THREADS; i++)
+	{
+		threads[i].func = NULL;
+		atomic_store(&threads[i].is_done, 0);
+		mailbox_init(&threads[i].box);
+	}
+
+	// Нить с номером 0 — главная
+	atomic_store(&threads_amount, 1);
+	atomic_store(&semaphores_amount, 0);
+	workers_amount = 0;
+	idle = NULL;
+}
+
+static void *worker_loop(void *arg)
+{
+	worker *const wk = arg;
+	current_worker = wk;
+
+	while (true)
+	{
+		int task;
+		while ((task = atomic_load(&wk->task)) == 0)
+		{
+			futex_wait(&wk->task, 0);
+		}
+
+		if (task < 0)
+		{
+			return NULL;
+		}
+
+		current_num = task;
+		if (!setjmp(wk->exit))
+		{
+			threads[task].func(NULL);
+		}
+		realtime_reset();
+
+		atomic_store(&threads[task].is_done, 1);
+		futex_wake(&threads[task].is_done, INT_MAX);
+
+		atomic_store(&wk->task, 0);
+		pthread_mutex_lock(&pool_lock);
+		wk->next = idle;
+		idle = wk;
+		pthread_mutex_unlock(&pool_lock);
+	}
+}
+
+static worker *worker_acquire(void)
+{
+	pthread_mutex_lock(&pool_lock);
+
+	worker *wk = idle;
+	if (wk != NULL)
+	{
+		idle = wk->next;
+	}
+	else if (workers_amount < MAX_THREADS)
+	{
+		wk = &workers[workers_amount];
+		atomic_store(&wk->task, 0);
+
+		if (pthread_create(&wk->handle, NULL, &worker_loop, wk))
+		{
+			wk = NULL;
+		}
+		else
+		{
+			workers_amount++;
+		}
+	}
+
+	pthread_mutex_unlock(&pool_lock);
+	return wk;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+void t_init(void)
+{
+	pthread_once(&once, &runtime_init);
+}
+
+void t_destroy(void)
+{
+	t_init();
+
+	const int32_t amount = atomic_load(&threads_amount);
+	for (int32_t i = 1; i < amount && i < MAX_THREADS; i++)
+	{
+		t_join(i);
+	}
+
+	// Рабочий может ещё возвращаться в список свободных, поэтому без блокировки
+	pthread_mutex_lock(&pool_lock);
+	const size_t workers_used = workers_amount;
+	pthread_mutex_unlock(&pool_lock);
+
+	for (size_t i = 0; i < workers_used; i++)
+	{
+		atomic_store(&workers[i].task, -1);
+		futex_wake(&workers[i].task, 1);
+		pthread_join(workers[i].handle, NULL);
+	}
+
+	runtime_init();
+}
+
+
+int32_t t_create(const thread_func func)
+{
+	t_init();
+
+	const int32_t num = atomic_fetch_add(&threads_amount, 1);
+	if (num >= MAX_THREADS || func == NULL)
+	{
+		return -1;
+	}
+
+	threads[num].func = func;
+
+	worker *const wk = worker_acquire();
+	if (wk == NULL)
+	{
+		atomic_store(&threads[num].is_done, 1);
+		return -1;
+	}
+
+	atomic_store(&wk->task, num);
+	futex_wake(&wk->task, 1);
+	return num;
+}
+
+int32_t t_getnum(void)
+{
+	return current_num;
+}
+
+void t_sleep(const int32_t milliseconds)
+{
+	const struct timespec time = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000 };
+	nanosleep(&time, NULL);
+}
+
+int32_t t_set_priority(const int32_t policy, const int32_t priority)
+{
+	struct sched_param param = { .sched_priority = 0 };
+	int sched_policy = SCHED_OTHER;
+	if (policy == 1 || policy == 2)
+	{
+		sched_policy = policy == 1 ? SCHED_FIFO : SCHED_RR;
+
+		const int min = sched_get_priority_min(sched_policy);
+		const int max = sched_get_priority_max(sched_policy);
+		param.sched_priority = priority < min ? min : priority > max ? max : priority;
+	}
+	else if (policy != 0)
+	{
+		return -1;
+	}
+
+	// Без прав на политики реального времени нить остаётся с прежней
+	if (pthread_setschedparam(pthread_self(), sched_policy, &param))
+	{
+		return -1;
+	}
+
+	is_realtime = true;
+	return 0;
+}
+
+int32_t t_set_affinity(const int32_t cpu)
+{
+#ifdef __linux__
+	const long cores = sysconf(_SC_NPROCESSORS_CONF);
+	if (cpu < -1 || cpu >= CPU_SETSIZE || (cores > 0 && cpu >= cores))
+	{
+		return -1;
+	}
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int32_t i = 0; i < CPU_SETSIZE && (cores <= 0 || i < cores); i++)
+	{
+		if (cpu == -1 || cpu == i)
+		{
+			CPU_SET((size_t)i, &set);
+		}
+	}
+
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+	{
+		return -1;
+	}
+
+	is_realtime = true;
+	return 0;
+#else
+	// Привязка к ядру не поддерживается переносимо
+	(void)cpu;
+	return -1;
+#endif
+}
+
+void t_period_start(const int32_t microseconds)
+{
+	if (microseconds <= 0)
+	{
+		period = (struct timespec){ 0, 0 };
+		return;
+	}
+
+	period = (struct timespec){ microseconds / 1000000, (long)(microseconds % 1000000) * 1000 };
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	timespec_add(&deadline, &period);
+	is_realtime = true;
+}
+
+int32_t t_period_wait(void)
+{
+	if (period.tv_sec == 0 && period.tv_nsec == 0)
+	{
+		return 0;
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// Пропущенные периоды не догоняются, иначе нить выполнит их подряд без пауз
+	int32_t missed = 0;
+	while (!timespec_less(&now, &deadline))
+	{
+		timespec_add(&deadline, &period);
+		missed++;
+	}
+
+#ifdef TIMER_ABSTIME
+	// Абсолютный срок не накапливает задержку пробуждения от периода к периоду
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+	{
+		continue;
+	}
+#else
+	struct timespec rest = { deadline.tv_sec - now.tv_sec, deadline.tv_nsec - now.tv_nsec };
+	if (rest.tv_nsec < 0)
+	{
+		rest.tv_sec--;
+		rest.tv_nsec += 1000000000;
+	}
+	nanosleep(&rest, NULL);
+#endif
+
+	timespec_add(&deadline, &period);
+	return missed;
+}
+
+
+void t_join(const int32_t num)
+{
+	if (num <= 0 || num >= MAX_THREADS || num >= atomic_load(&threads_amount))
+	{
+		return;
+	}
+
+	while (!atomic_load(&threads[num].is_done))
+	{
+		futex_wait(&threads[num].is_done, 0);
+	}
+}
+
+void t_exit(void)
+{
+	if (current_worker == NULL)
+	{
+		exit(EXIT_SUCCESS);
+	}
+
+	longjmp(current_worker->exit, 1);
+}
+
+
+int32_t t_sem_create(const int32_t level)
+{
+	const int32_t num = atomic_fetch_add(&semaphores_amount, 1);
+	if (num >= MAX_SEMAPHORES)
+	{
+		return -1;
+	}
+
+	atomic_store(&semaphores[num].value, level);
+	atomic_store(&semaphores[num].waiters, 0);
+	return num;
+}
+
+void t_sem_wait(const int32_t num)
+{
+	if (num < 0 || num >= MAX_SEMAPHORES)
+	{
+		return;
+	}
+
+	semaphore *const sem = &semaphores[num];
+	while (true)
+	{
+		int value = atomic_load(&sem->value);
+		while (value > 0)
+		{
+			if (atomic_compare_exchange_weak(&sem->value, &value, value - 1))
+			{
+				return;
+			}
+		}
+
+		atomic_fetch_add(&sem->waiters, 1);
+		futex_wait(&sem->value, value);
+		atomic_fetch_sub(&sem->waiters, 1);
+	}
+}
+
+void t_sem_post(const int32_t num)
+{
+	if (num < 0 || num >= MAX_SEMAPHORES)
+	{
+		return;
+	}
+
+	semaphore *const sem = &semaphores[num];
+	atomic_fetch_add(&sem->value, 1);
+
+	// Без ожидающих системный вызов не нужен
+	if (atomic_load(&sem->waiters) > 0)
+	{
+		futex_wake(&sem->value, 1);
+	}
+}
+
+
+void t_msg_send(const int32_t num, const int32_t data)
+{
+	t_init();
+	if (num < 0 || num >= MAX_THREADS)
+	{
+		return;
+	}
+
+	message *const msg = malloc(sizeof(message));
+	if (msg == NULL)
+	{
+		return;
+	}
+
+	msg->sender = current_num;
+	msg->data = data;
+
+	mailbox *const box = &threads[num].box;
+	mailbox_push(box, msg);
+	atomic_fetch_add(&box->pending, 1);
+	futex_wake(&box->pending, 1);
+}
+
+int64_t t_msg_receive(void)
+{
+	t_init();
+	mailbox *const box = &threads[current_num].box;
+
+	while (true)
+	{
+		while (atomic_load(&box->pending) == 0)
+		{
+			futex_wait(&box->pending, 0);
+		}
+
+		message *const msg = mailbox_pop(box);
+		if (msg != NULL)
+		{
+			atomic_fetch_sub(&box->pending, 1);
+
+			const int64_t result = (int64_t)((uint64_t)(uint32_t)msg->sender | (uint64_t)(uint32_t)msg->data << 32);
+			free(msg);
+			return result;
+		}
+	}
+}
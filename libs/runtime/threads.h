@@ -0,0 +1,164 @@
+/*
+ *	Copyright 2021 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+
+#define MAX_THREADS		128
+#define MAX_SEMAPHORES	128
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Thread function of RuC program
+ *
+ *	@param	arg			Thread argument, always @c NULL
+ *
+ *	@return	Thread result, ignored
+ */
+typedef void *(*thread_func)(void *arg);
+
+
+/**
+ *	Prepare runtime, called implicitly on first use
+ */
+void t_init(void);
+
+/**
+ *	Stop idle pool workers and release runtime
+ */
+void t_destroy(void);
+
+
+/**
+ *	Start function in a new thread.
+ *	Thread is taken from a pool of workers, which finished their previous functions.
+ *
+ *	@param	func		Thread function
+ *
+ *	@return	Thread number, starting from @c 1, @c -1 on failure
+ */
+int32_t t_create(const thread_func func);
+
+/**
+ *	Get number of current thread
+ *
+ *	@return	Thread number, @c 0 for main thread
+ */
+int32_t t_getnum(void);
+
+/**
+ *	Suspend current thread
+ *
+ *	@param	milliseconds	Sleep time
+ */
+void t_sleep(const int32_t milliseconds);
+
+/**
+ *	Set scheduling policy of current thread.
+ *	Thread pool restores default scheduling after thread function.
+ *
+ *	@param	policy		Policy: @c 0 for default, @c 1 for FIFO, @c 2 for round robin
+ *	@param	priority	Priority, clamped to range of policy
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int32_t t_set_priority(const int32_t policy, const int32_t priority);
+
+/**
+ *	Bind current thread to processor
+ *
+ *	@param	cpu			Processor number, @c -1 for all processors
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int32_t t_set_affinity(const int32_t cpu);
+
+/**
+ *	Start period of current thread from now
+ *
+ *	@param	microseconds	Period, @c 0 to stop it
+ */
+void t_period_start(const int32_t microseconds);
+
+/**
+ *	Suspend current thread until end of its period by absolute deadline
+ *
+ *	@return	Number of missed periods
+ */
+int32_t t_period_wait(void);
+
+/**
+ *	Wait for thread function to finish
+ *
+ *	@param	num			Thread number
+ */
+void t_join(const int32_t num);
+
+/**
+ *	Finish function of current thread
+ */
+void t_exit(void);
+
+
+/**
+ *	Create counting semaphore
+ *
+ *	@param	level		Initial value
+ *
+ *	@return	Semaphore number, @c -1 on failure
+ */
+int32_t t_sem_create(const int32_t level);
+
+/**
+ *	Decrement semaphore, waiting while it is zero
+ *
+ *	@param	num			Semaphore number
+ */
+void t_sem_wait(const int32_t num);
+
+/**
+ *	Increment semaphore, waking one waiting thread
+ *
+ *	@param	num			Semaphore number
+ */
+void t_sem_post(const int32_t num);
+
+
+/**
+ *	Send message to thread.
+ *	Message structure is passed by LLVM as two separate integers.
+ *
+ *	@param	num			Receiver number
+ *	@param	data		Message data
+ */
+void t_msg_send(const int32_t num, const int32_t data);
+
+/**
+ *	Receive message for current thread, waiting while there are none
+ *
+ *	@return	Sender number in low 32 bits, message data in high 32 bits
+ */
+int64_t t_msg_receive(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
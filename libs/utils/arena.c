@@ -0,0 +1,330 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+#define ARENA_ALIGNMENT 16
+
+
+/** Chunk of arena memory */
+typedef struct chunk
+{
+	struct chunk *prev;			/**< Previous chunk */
+	struct chunk *next;			/**< Next chunk, used for large blocks only */
+	size_t size;				/**< Size of chunk data */
+	size_t used;				/**< Size of used data */
+} chunk;
+
+struct arena
+{
+	chunk *current;				/**< Current chunk for small blocks */
+	chunk *large;				/**< List of chunks with large blocks */
+	size_t chunk_size;			/**< Size of chunk for small blocks */
+
+	size_t allocs;				/**< Number of allocated blocks */
+	size_t reserved;			/**< Size of memory taken by chunks */
+};
+
+
+static inline size_t align_size(const size_t size)
+{
+	return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static inline char *chunk_data(const chunk *const ch)
+{
+	return (char *)ch + align_size(sizeof(chunk));
+}
+
+static inline chunk *chunk_of_large(void *const ptr)
+{
+	return (chunk *)((char *)ptr - align_size(sizeof(chunk)));
+}
+
+static inline bool is_large(const arena *const ar, const size_t size)
+{
+	return size > ar->chunk_size / 4;
+}
+
+static inline bool is_last(const arena *const ar, const void *const ptr, const size_t size)
+{
+	const chunk *const ch = ar->current;
+	return ch != NULL && (const char *)ptr + align_size(size) == chunk_data(ch) + ch->used;
+}
+
+
+static chunk *chunk_create(const size_t size)
+{
+	chunk *const ch = malloc(align_size(sizeof(chunk)) + size);
+	if (ch == NULL)
+	{
+		return NULL;
+	}
+
+	ch->prev = NULL;
+	ch->next = NULL;
+	ch->size = size;
+	ch->used = 0;
+	return ch;
+}
+
+static void *alloc_small(arena *const ar, const size_t size)
+{
+	const size_t aligned = align_size(size);
+	chunk *ch = ar->current;
+
+	if (ch == NULL || ch->size - ch->used < aligned)
+	{
+		ch = chunk_create(ar->chunk_size);
+		if (ch == NULL)
+		{
+			return NULL;
+		}
+
+		ch->prev = ar->current;
+		ar->current = ch;
+		ar->reserved += ar->chunk_size;
+	}
+
+	void *const ptr = chunk_data(ch) + ch->used;
+	ch->used += aligned;
+	return ptr;
+}
+
+static void *alloc_large(arena *const ar, const size_t size)
+{
+	chunk *const ch = chunk_create(size);
+	if (ch == NULL)
+	{
+		return NULL;
+	}
+
+	ch->used = size;
+	ar->reserved += size;
+	ch->next = ar->large;
+	if (ar->large != NULL)
+	{
+		ar->large->prev = ch;
+	}
+
+	ar->large = ch;
+	return chunk_data(ch);
+}
+
+static void *realloc_large(arena *const ar, void *const ptr, const size_t size)
+{
+	chunk *const prev = chunk_of_large(ptr)->prev;
+	chunk *const next = chunk_of_large(ptr)->next;
+	const size_t size_old = chunk_of_large(ptr)->size;
+
+	chunk *const ch = realloc(chunk_of_large(ptr), align_size(sizeof(chunk)) + size);
+	if (ch == NULL)
+	{
+		return NULL;
+	}
+
+	ch->size = size;
+	ch->used = size;
+	ar->reserved = ar->reserved - size_old + size;
+
+	if (prev != NULL)
+	{
+		prev->next = ch;
+	}
+	else
+	{
+		ar->large = ch;
+	}
+
+	if (next != NULL)
+	{
+		next->prev = ch;
+	}
+
+	return chunk_data(ch);
+}
+
+static void free_large(arena *const ar, void *const ptr)
+{
+	chunk *const ch = chunk_of_large(ptr);
+
+	if (ch->prev != NULL)
+	{
+		ch->prev->next = ch->next;
+	}
+	else
+	{
+		ar->large = ch->next;
+	}
+
+	if (ch->next != NULL)
+	{
+		ch->next->prev = ch->prev;
+	}
+
+	ar->reserved -= ch->size;
+	free(ch);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+arena *arena_create(const size_t size)
+{
+	arena *const ar = malloc(sizeof(arena));
+	if (ar == NULL)
+	{
+		return NULL;
+	}
+
+	ar->current = NULL;
+	ar->large = NULL;
+	ar->chunk_size = size != 0 ? align_size(size) : ARENA_CHUNK_SIZE;
+	ar->allocs = 0;
+	ar->reserved = 0;
+	return ar;
+}
+
+
+void *arena_alloc(arena *const ar, const size_t size)
+{
+	if (!arena_is_correct(ar))
+	{
+		return NULL;
+	}
+
+	ar->allocs++;
+	return is_large(ar, size) ? alloc_large(ar, size) : alloc_small(ar, size);
+}
+
+void *arena_realloc(arena *const ar, void *const ptr, const size_t size_old, const size_t size_new)
+{
+	if (!arena_is_correct(ar))
+	{
+		return NULL;
+	}
+
+	if (ptr == NULL)
+	{
+		return arena_alloc(ar, size_new);
+	}
+
+	const bool is_large_old = is_large(ar, size_old);
+	const bool is_large_new = is_large(ar, size_new);
+
+	if (is_large_old && is_large_new)
+	{
+		return realloc_large(ar, ptr, size_new);
+	}
+
+	if (!is_large_old && !is_large_new)
+	{
+		chunk *const ch = ar->current;
+		if (is_last(ar, ptr, size_old) && ch->size - (ch->used - align_size(size_old)) >= align_size(size_new))
+		{
+			ch->used = ch->used - align_size(size_old) + align_size(size_new);
+			return ptr;
+		}
+
+		if (size_new <= size_old)
+		{
+			return ptr;
+		}
+	}
+
+	void *const ptr_new = arena_alloc(ar, size_new);
+	if (ptr_new == NULL)
+	{
+		return NULL;
+	}
+
+	memcpy(ptr_new, ptr, size_old < size_new ? size_old : size_new);
+	arena_free(ar, ptr, size_old);
+	return ptr_new;
+}
+
+int arena_free(arena *const ar, void *const ptr, const size_t size)
+{
+	if (!arena_is_correct(ar) || ptr == NULL)
+	{
+		return -1;
+	}
+
+	if (is_large(ar, size))
+	{
+		free_large(ar, ptr);
+	}
+	else if (is_last(ar, ptr, size))
+	{
+		ar->current->used -= align_size(size);
+	}
+
+	return 0;
+}
+
+
+bool arena_is_correct(const arena *const ar)
+{
+	return ar != NULL;
+}
+
+
+size_t arena_get_allocs(const arena *const ar)
+{
+	return arena_is_correct(ar) ? ar->allocs : 0;
+}
+
+size_t arena_get_reserved(const arena *const ar)
+{
+	return arena_is_correct(ar) ? ar->reserved : 0;
+}
+
+
+int arena_clear(arena *const ar)
+{
+	if (!arena_is_correct(ar))
+	{
+		return -1;
+	}
+
+	while (ar->current != NULL)
+	{
+		chunk *const prev = ar->current->prev;
+		free(ar->current);
+		ar->current = prev;
+	}
+
+	while (ar->large != NULL)
+	{
+		chunk *const next = ar->large->next;
+		free(ar->large);
+		ar->large = next;
+	}
+
+	free(ar);
+	return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "dll.h"
+
+
+#define ARENA_CHUNK_SIZE	(1 << 20)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Arena structure.
+ *	Memory is taken from large chunks by bumping a pointer and is released all at once,
+ *	blocks larger than a quarter of chunk get their own chunk, which can be resized in place.
+ */
+typedef struct arena arena;
+
+
+/**
+ *	Create new arena
+ *
+ *	@param	size			Chunk size, @c 0 for default
+ *
+ *	@return	Arena, @c NULL on failure
+ */
+EXPORTED arena *arena_create(const size_t size);
+
+
+/**
+ *	Allocate memory block
+ *
+ *	@param	ar				Arena
+ *	@param	size			Block size
+ *
+ *	@return	Memory block, @c NULL on failure
+ */
+EXPORTED void *arena_alloc(arena *const ar, const size_t size);
+
+/**
+ *	Change size of memory block, keeping its contents
+ *
+ *	@param	ar				Arena
+ *	@param	ptr				Memory block, @c NULL for new one
+ *	@param	size_old		Current block size
+ *	@param	size_new		New block size
+ *
+ *	@return	Memory block, @c NULL on failure
+ */
+EXPORTED void *arena_realloc(arena *const ar, void *const ptr, const size_t size_old, const size_t size_new);
+
+/**
+ *	Return memory block to arena.
+ *	Memory goes back for reuse if block is the last allocated one or has its own chunk.
+ *
+ *	@param	ar				Arena
+ *	@param	ptr				Memory block
+ *	@param	size			Block size
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int arena_free(arena *const ar, void *const ptr, const size_t size);
+
+
+/**
+ *	Check that arena is correct
+ *
+ *	@param	ar				Arena
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED bool arena_is_correct(const arena *const ar);
+
+
+/**
+ *	Get number of blocks allocated from arena
+ *
+ *	@param	ar				Arena
+ *
+ *	@return	Number of allocations
+ */
+EXPORTED size_t arena_get_allocs(const arena *const ar);
+
+/**
+ *	Get size of memory taken by arena from system
+ *
+ *	@param	ar				Arena
+ *
+ *	@return	Size of chunks
+ */
+EXPORTED size_t arena_get_reserved(const arena *const ar);
+
+
+/**
+ *	Free all memory of arena, including arena itself
+ *
+ *	@param	ar				Arena
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int arena_clear(arena *const ar);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -24,6 +24,12 @@
 static const char *const PREFIX = "// #";
 static const char SEPARATOR = ' ';
 
+static const size_t INDEX_LINES_SIZE = 1024;
+static const size_t INDEX_MARKERS_SIZE = 64;
+
+static const size_t MAP_PATHS_SIZE = 16;
+static const size_t MAP_FIELDS = 4;
+
 
 static inline void cmt_parse(comment *const cmt)
 {
@@ -98,6 +104,95 @@ static inline void cmt_reverse(comment *const cmt, const char *const code, const
 	}
 }
 
+/** Get number of indexed positions which are not greater than value */
+static size_t cmt_index_count(const vector *const positions, const size_t value)
+{
+	size_t left = 0;
+	size_t right = vector_size(positions);
+	while (left < right)
+	{
+		const size_t middle = left + (right - left) / 2;
+		if ((size_t)vector_at(positions, middle) <= value)
+		{
+			left = middle + 1;
+		}
+		else
+		{
+			right = middle;
+		}
+	}
+
+	return left;
+}
+
+/** Get number of markers of map which are placed not after value */
+static size_t cmt_map_count(const vector *const markers, const size_t value)
+{
+	size_t left = 0;
+	size_t right = vector_size(markers) / MAP_FIELDS;
+	while (left < right)
+	{
+		const size_t middle = left + (right - left) / 2;
+		if ((size_t)vector_at(markers, middle * MAP_FIELDS) <= value)
+		{
+			left = middle + 1;
+		}
+		else
+		{
+			right = middle;
+		}
+	}
+
+	return left;
+}
+
+/**
+ *	Read line marker written by @c cmt_to_string
+ *
+ *	@return	Size of marker with line end, @c 0 if text is not marker
+ */
+static size_t cmt_map_read(const char *const code, size_t *const path_size, size_t *const line, size_t *const symbol)
+{
+	const size_t size = strlen(PREFIX);
+	if (strncmp(code, PREFIX, size) != 0 || code[size] != SEPARATOR)
+	{
+		return 0;
+	}
+
+	const char *const path = &code[size + 1];
+	size_t i = 0;
+	while (path[i] != '\0' && path[i] != '\n' && path[i] != SEPARATOR)
+	{
+		i++;
+	}
+	*path_size = i;
+
+	// Номер строки и позиция в ней должны стоять до конца строки, иначе это текст программы
+	size_t numbers[2] = { 0, SIZE_MAX };
+	for (size_t j = 0; j < 2 && path[i] == SEPARATOR; j++)
+	{
+		if (path[++i] < '0' || path[i] > '9')
+		{
+			return 0;
+		}
+
+		numbers[j] = 0;
+		while (path[i] >= '0' && path[i] <= '9')
+		{
+			numbers[j] = numbers[j] * 10 + (size_t)(path[i++] - '0');
+		}
+	}
+
+	if (*path_size == 0 || path[*path_size] != SEPARATOR || path[i] != '\n')
+	{
+		return 0;
+	}
+
+	*line = numbers[0];
+	*symbol = numbers[1];
+	return size + 1 + i + 1;
+}
+
 
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
@@ -177,35 +272,242 @@ comment cmt_search(const char *const code, const size_t position)
 }
 
 
-bool cmt_is_correct(const comment *const cmt)
+comment_index cmt_index_create(const char *const code)
 {
-	return cmt != NULL && cmt->path != NULL;
+	return cmt_index_create_by_map(code, NULL);
 }
 
+comment_index cmt_index_create_by_map(const char *const code, const location_map *const map)
+{
+	comment_index index;
+	index.code = code;
+	index.newlines = vector_create(INDEX_LINES_SIZE);
+	index.markers = vector_create(map == NULL ? INDEX_MARKERS_SIZE : 0);
+	index.map = map;
+	index.line = NULL;
+	index.columns = vector_create(0);
 
-size_t cmt_get_tag(const comment *const cmt, char *const buffer)
+	if (code == NULL)
+	{
+		return index;
+	}
+
+	const size_t size = strlen(PREFIX);
+	for (size_t i = 0; code[i] != '\0'; i++)
+	{
+		if (code[i] == '\n')
+		{
+			vector_add(&index.newlines, (item_t)i);
+		}
+		else if (map == NULL && i + 1 >= size && code[i] == PREFIX[size - 1]
+			&& strncmp(&code[i + 1 - size], PREFIX, size) == 0)
+		{
+			vector_add(&index.markers, (item_t)i);
+		}
+	}
+
+	return index;
+}
+
+comment cmt_index_search(const comment_index *const index, const size_t position)
 {
-	size_t index = cmt_get_path(cmt, buffer);
+	comment cmt;
+	cmt.path = NULL;
+	cmt.line = 1;
+	cmt.symbol = SIZE_MAX;
+	cmt.code = NULL;
 
-	if (index == 0)
+	if (index == NULL || index->code == NULL)
+	{
+		return cmt;
+	}
+
+	// Start of line is next to the last line end before position
+	const size_t lines = cmt_index_count(&index->newlines, position == 0 ? 0 : position - 1);
+	const size_t start = position == 0 || lines == 0 ? 0 : (size_t)vector_at(&index->newlines, lines - 1) + 1;
+
+	cmt.code = &index->code[start];
+	cmt.symbol = position - start;
+
+	if (index->map != NULL)
+	{
+		const vector *const markers = &index->map->markers;
+		const size_t count = cmt_map_count(markers, start);
+		if (count == 0)
+		{
+			cmt.line += cmt_index_count(&index->newlines, start) - cmt_index_count(&index->newlines, 0);
+			return cmt;
+		}
+
+		// Строка маркера удалена из кода, поэтому считаются концы строк начиная с его места
+		const size_t i = (count - 1) * MAP_FIELDS;
+		const size_t marker = (size_t)vector_at(markers, i);
+		const size_t line = (size_t)vector_at(markers, i + 2);
+		const item_t symbol = vector_at(markers, i + 3);
+
+		cmt.path = strings_get(&index->map->paths, (size_t)vector_at(markers, i + 1));
+		cmt.line = line + cmt_index_count(&index->newlines, start)
+			- (marker == 0 ? 0 : cmt_index_count(&index->newlines, marker - 1));
+		if (symbol != ITEM_MAX)
+		{
+			cmt.line = line;
+			cmt.symbol = (size_t)symbol;
+		}
+
+		return cmt;
+	}
+
+	const size_t markers = cmt_index_count(&index->markers, start);
+	const size_t marker = markers != 0 ? (size_t)vector_at(&index->markers, markers - 1) : 0;
+
+	// Line ends between comment and start of line, the first symbol of code is never checked
+	const size_t first = cmt_index_count(&index->newlines, marker);
+	cmt.line += cmt_index_count(&index->newlines, start) - first;
+	if (markers != 0)
+	{
+		cmt.path = &index->code[marker + 2];
+		cmt_parse(&cmt);
+	}
+
+	return cmt;
+}
+
+size_t cmt_index_get_column(comment_index *const index, const comment *const cmt)
+{
+	if (index == NULL || cmt == NULL || cmt->code == NULL)
 	{
 		return 0;
 	}
 
-	index += (size_t)sprintf(&buffer[index], ":%zu", cmt->line);
+	// Продолжения многобайтового символа относятся к столбцу его первого байта
+	if (index->line != cmt->code)
+	{
+		vector_resize(&index->columns, 0);
 
-	const size_t first = utf8_to_first_byte(cmt->code, cmt->symbol);
-	size_t symbol = first;
+		size_t column = 0;
+		for (size_t i = 0; cmt->code[i] != '\0' && cmt->code[i] != '\n'; i++)
+		{
+			column += ((unsigned char)cmt->code[i] & 0xC0) != 0x80 ? 1 : 0;
+			vector_add(&index->columns, (item_t)column);
+		}
 
+		vector_add(&index->columns, (item_t)column + 1);
+		index->line = cmt->code;
+	}
+
+	// Позиция за концом строки отсчитывается от него по байтам
+	const size_t end = vector_size(&index->columns) - 1;
+	return cmt->symbol < end
+		? (size_t)vector_at(&index->columns, cmt->symbol)
+		: (size_t)vector_at(&index->columns, end) + cmt->symbol - end;
+}
+
+bool cmt_index_is_marked(const comment_index *const index, const size_t position)
+{
+	if (index == NULL || index->code == NULL)
+	{
+		return false;
+	}
+
+	if (index->map == NULL)
+	{
+		return strncmp(&index->code[position], PREFIX, strlen(PREFIX)) == 0;
+	}
+
+	const size_t count = cmt_map_count(&index->map->markers, position);
+	return count != 0 && (size_t)vector_at(&index->map->markers, (count - 1) * MAP_FIELDS) == position;
+}
+
+int cmt_index_clear(comment_index *const index)
+{
+	if (index == NULL)
+	{
+		return -1;
+	}
+
+	vector_clear(&index->newlines);
+	vector_clear(&index->markers);
+	vector_clear(&index->columns);
+	return 0;
+}
+
+
+location_map cmt_map_create(void)
+{
+	location_map map;
+	map.markers = vector_create(INDEX_MARKERS_SIZE * MAP_FIELDS);
+	map.paths = strings_create(MAP_PATHS_SIZE);
+	return map;
+}
+
+size_t cmt_map_extract(location_map *const map, char *const code)
+{
+	if (map == NULL || code == NULL)
+	{
+		return 0;
+	}
+
+	size_t size = 0;
 	size_t i = 0;
-	while (i < first)
+	while (code[i] != '\0')
 	{
-		const size_t size = utf8_symbol_size(cmt->code[i]);
-		symbol -= size - 1;
-		i += size;
+		size_t path_size;
+		size_t line;
+		size_t symbol;
+		const size_t marker_size = code[i] == PREFIX[0] ? cmt_map_read(&code[i], &path_size, &line, &symbol) : 0;
+		if (marker_size == 0)
+		{
+			code[size++] = code[i++];
+			continue;
+		}
+
+		// Маркер после текста строки оставляет её конец, иначе текст склеился бы со следующей строкой
+		if (size != 0 && code[size - 1] != '\n')
+		{
+			code[size++] = '\n';
+		}
+
+		const size_t path = strings_intern_by_range(&map->paths, &code[i + strlen(PREFIX) + 1], path_size);
+		vector_add(&map->markers, (item_t)size);
+		vector_add(&map->markers, (item_t)path);
+		vector_add(&map->markers, (item_t)line);
+		vector_add(&map->markers, symbol != SIZE_MAX ? (item_t)symbol : ITEM_MAX);
+		i += marker_size;
+	}
+
+	code[size] = '\0';
+	return size;
+}
+
+int cmt_map_clear(location_map *const map)
+{
+	if (map == NULL)
+	{
+		return -1;
 	}
 
-	return index + (size_t)sprintf(&buffer[index], ":%zu", symbol + 1);
+	vector_clear(&map->markers);
+	return strings_clear(&map->paths);
+}
+
+
+bool cmt_is_correct(const comment *const cmt)
+{
+	return cmt != NULL && cmt->path != NULL;
+}
+
+
+size_t cmt_get_tag(const comment *const cmt, char *const buffer)
+{
+	size_t index = cmt_get_path(cmt, buffer);
+
+	if (index == 0)
+	{
+		return 0;
+	}
+
+	index += (size_t)sprintf(&buffer[index], ":%zu", cmt->line);
+	return index + (size_t)sprintf(&buffer[index], ":%zu", cmt_get_column(cmt));
 }
 
 size_t cmt_get_code_line(const comment *const cmt, char *const buffer)
@@ -253,3 +555,24 @@ size_t cmt_get_symbol(const comment *const cmt)
 {
 	return cmt != NULL ? cmt->symbol : 0;
 }
+
+size_t cmt_get_column(const comment *const cmt)
+{
+	if (cmt == NULL || cmt->code == NULL)
+	{
+		return 0;
+	}
+
+	const size_t first = utf8_to_first_byte(cmt->code, cmt->symbol);
+	size_t symbol = first;
+
+	size_t i = 0;
+	while (i < first)
+	{
+		const size_t size = utf8_symbol_size(cmt->code[i]);
+		symbol -= size - 1;
+		i += size;
+	}
+
+	return symbol + 1;
+}
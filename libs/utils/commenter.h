@@ -19,6 +19,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "dll.h"
+#include "strings.h"
+#include "vector.h"
 
 
 #ifdef __cplusplus
@@ -35,6 +37,25 @@ typedef struct comment
 	const char *code;	/**< Current line in code */
 } comment;
 
+/** Line markers moved out of code */
+typedef struct location_map
+{
+	vector markers;		/**< Sorted markers: position in code, path index, line and position in line */
+	strings paths;		/**< Interned paths of files */
+} location_map;
+
+/** Index of line ends and comments in code for fast search */
+typedef struct comment_index
+{
+	const char *code;	/**< Indexed code */
+	vector newlines;	/**< Sorted positions of line ends */
+	vector markers;		/**< Sorted positions of comments */
+	const location_map *map;	/**< Line markers of code, @c NULL if they are comments in code */
+
+	const char *line;	/**< Last line with computed columns */
+	vector columns;		/**< Columns of bytes in last line and of its end */
+} comment_index;
+
 
 /**
  *	Create comment
@@ -80,6 +101,93 @@ EXPORTED size_t cmt_to_string(const comment *const cmt, char *const buffer);
 EXPORTED comment cmt_search(const char *const code, const size_t position);
 
 
+/**
+ *	Create index of code, code must stay unchanged while index is used
+ *
+ *	@param	code		Code
+ *
+ *	@return	Comment index
+ */
+EXPORTED comment_index cmt_index_create(const char *const code);
+
+/**
+ *	Create index of code with line markers moved to map.
+ *	Code and map must stay unchanged while index is used
+ *
+ *	@param	code		Code
+ *	@param	map			Line markers, @c NULL if they are comments in code
+ *
+ *	@return	Comment index
+ */
+EXPORTED comment_index cmt_index_create_by_map(const char *const code, const location_map *const map);
+
+/**
+ *	Find comment in code using index, same as @c cmt_search in logarithmic time
+ *
+ *	@param	index		Comment index
+ *	@param	position	Position in code after comment
+ *
+ *	@return	Comment structure
+ */
+EXPORTED comment cmt_index_search(const comment_index *const index, const size_t position);
+
+/**
+ *	Get column of position in line using index, same as @c cmt_get_column.
+ *	Columns of the last line are kept, so positions on the same line take constant time
+ *	@param	index		Comment index
+ *	@param	cmt			Comment found in indexed code
+ *	@return	Column, @c 0 if comment has no code
+ */
+EXPORTED size_t cmt_index_get_column(comment_index *const index, const comment *const cmt);
+
+/**
+ *	Check that line marker is placed at position
+ *
+ *	@param	index		Comment index
+ *	@param	position	Position in code
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED bool cmt_index_is_marked(const comment_index *const index, const size_t position);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	index		Comment index
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int cmt_index_clear(comment_index *const index);
+
+
+/**
+ *	Create empty map of line markers
+ *
+ *	@return	Map of line markers
+ */
+EXPORTED location_map cmt_map_create(void);
+
+/**
+ *	Move line markers from code to map, so that lexer and search of locations do not pass them.
+ *	Code is shortened in place, text which only looks like marker is kept
+ *
+ *	@param	map			Map of line markers
+ *	@param	code		Code with line markers
+ *
+ *	@return	Size of code without markers
+ */
+EXPORTED size_t cmt_map_extract(location_map *const map, char *const code);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	map			Map of line markers
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int cmt_map_clear(location_map *const map);
+
+
 /**
  *	Check that comment is correct
  *
@@ -138,6 +246,15 @@ EXPORTED size_t cmt_get_line(const comment *const cmt);
  */
 EXPORTED size_t cmt_get_symbol(const comment *const cmt);
 
+/**
+ *	Get column of position in line, counted in symbols from @c 1
+ *
+ *	@param	cmt			Comment
+ *
+ *	@return	Column, @c 0 if comment has no code
+ */
+EXPORTED size_t cmt_get_column(const comment *const cmt);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,123 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "counters.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "logger.h"
+
+
+#define MAX_REPORT_SIZE 256
+
+// Счётчики меняют задачи планировщика, атомарность обеспечивается только для GCC и Clang
+#if defined(__GNUC__) || defined(__clang__)
+	#define counter_add(counter, amount)	__atomic_add_fetch(counter, amount, __ATOMIC_RELAXED)
+	#define counter_load(counter)			__atomic_load_n(counter, __ATOMIC_RELAXED)
+	#define counter_store(counter, value)	__atomic_store_n(counter, value, __ATOMIC_RELAXED)
+#else
+	#define counter_add(counter, amount)	(*(counter) += (amount))
+	#define counter_load(counter)			(*(counter))
+	#define counter_store(counter, value)	(*(counter) = (value))
+#endif
+
+
+static const char *const TAG_COUNTERS = "counters";
+
+static const char *const COUNTER_NAMES[COUNTER_AMOUNT] =
+{
+	"uni_scan_char calls",
+	"map lookups",
+	"map probes",
+	"hash lookups",
+	"hash probes",
+	"node_get_child steps",
+	"vector reallocations",
+	"macro expansions",
+	"memoized macro expansions",
+	"uni_printf calls",
+	"uni_printf calls in VM",
+	"uni_printf calls in RVM",
+	"uni_printf calls in LLVM",
+	"uni_printf calls in MIPS",
+};
+
+
+static uint64_t counters[COUNTER_AMOUNT];
+
+// Каждый поток выводит через свой кодогенератор
+static _Thread_local counter_t output = COUNTER_PRINTF;
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+void counters_add(const counter_t counter, const size_t amount)
+{
+	counter_add(&counters[counter], (uint64_t)amount);
+}
+
+uint64_t counters_get(const counter_t counter)
+{
+	return counter_load(&counters[counter]);
+}
+
+void counters_set_output(const counter_t counter)
+{
+	output = counter;
+}
+
+counter_t counters_get_output(void)
+{
+	return output;
+}
+
+bool counters_is_enabled(void)
+{
+#ifdef RUC_COUNTERS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void counters_report(void)
+{
+	if (!counters_is_enabled())
+	{
+		log_report(TAG_COUNTERS, "counters are disabled, rebuild with RUC_COUNTERS");
+		return;
+	}
+
+	char buffer[MAX_REPORT_SIZE];
+	for (size_t i = 0; i < COUNTER_AMOUNT; i++)
+	{
+		const uint64_t value = counter_load(&counters[i]);
+		if (value != 0)
+		{
+			sprintf(buffer, "%-28s %" PRIu64, COUNTER_NAMES[i], value);
+			log_report(TAG_COUNTERS, buffer);
+		}
+
+		// Каждая компиляция в одном процессе получает собственный отчёт
+		counter_store(&counters[i], 0);
+	}
+}
@@ -0,0 +1,112 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "dll.h"
+
+
+/**
+ *	Counters are compiled in only with @c RUC_COUNTERS definition,
+ *	otherwise macros below expand to nothing and their arguments are not evaluated
+ */
+#ifdef RUC_COUNTERS
+	#define COUNTER_ADD(counter, amount)	counters_add(counter, amount)
+	#define COUNTER_OUTPUT(counter)			counters_set_output(counter)
+#else
+	#define COUNTER_ADD(counter, amount)	((void)0)
+	#define COUNTER_OUTPUT(counter)			((void)0)
+#endif
+
+#define COUNTER_INC(counter)				COUNTER_ADD(counter, 1)
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Counters of hot paths */
+typedef enum COUNTER
+{
+	COUNTER_SCAN_CHAR,				/**< Calls of @c uni_scan_char */
+	COUNTER_MAP_LOOKUPS,			/**< Searches of slots in map */
+	COUNTER_MAP_PROBES,				/**< Occupied slots passed by map searches */
+	COUNTER_HASH_LOOKUPS,			/**< Searches of slots in hash */
+	COUNTER_HASH_PROBES,			/**< Occupied slots passed by hash searches */
+	COUNTER_TREE_STEPS,				/**< Steps over siblings in @c node_get_child */
+	COUNTER_VECTOR_REALLOCS,		/**< Reallocations of vectors */
+	COUNTER_MACRO_EXPANSIONS,		/**< Calls of @c macro_get */
+	COUNTER_MACRO_MEMO_HITS,		/**< Expansions replayed from memoized replacement texts */
+	COUNTER_PRINTF,					/**< Calls of @c uni_printf outside of code generators */
+	COUNTER_PRINTF_VM,				/**< Calls of @c uni_printf by virtual machine code generator */
+	COUNTER_PRINTF_RVM,				/**< Calls of @c uni_printf by register virtual machine code generator */
+	COUNTER_PRINTF_LLVM,			/**< Calls of @c uni_printf by LLVM code generator */
+	COUNTER_PRINTF_MIPS,			/**< Calls of @c uni_printf by MIPS code generator */
+
+	COUNTER_AMOUNT,					/**< Number of counters */
+} counter_t;
+
+
+/**
+ *	Add amount to counter, use @c COUNTER_ADD macro instead
+ *
+ *	@param	counter			Counter
+ *	@param	amount			Amount
+ */
+EXPORTED void counters_add(const counter_t counter, const size_t amount);
+
+/**
+ *	Get value of counter
+ *
+ *	@param	counter			Counter
+ *
+ *	@return	Value of counter
+ */
+EXPORTED uint64_t counters_get(const counter_t counter);
+
+/**
+ *	Set counter for calls of @c uni_printf, use @c COUNTER_OUTPUT macro instead.
+ *	Code generators select their own counter and restore @c COUNTER_PRINTF at the end.
+ *
+ *	@param	counter			Counter
+ */
+EXPORTED void counters_set_output(const counter_t counter);
+
+/**
+ *	Get counter for calls of @c uni_printf
+ *
+ *	@return	Counter
+ */
+EXPORTED counter_t counters_get_output(void);
+
+/**
+ *	Check if counters are compiled in
+ *
+ *	@return	@c true on build with @c RUC_COUNTERS
+ */
+EXPORTED bool counters_is_enabled(void);
+
+/**
+ *	Print non-zero counters through report logger and reset all counters
+ */
+EXPORTED void counters_report(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -15,6 +15,8 @@
  */
 
 #include "hash.h"
+#include <stdlib.h>
+#include "counters.h"
 
 
 extern item_t hash_get_key(const hash *const hs, const size_t index);
@@ -31,12 +33,73 @@ extern size_t hash_set_int64_by_index(hash *const hs, const size_t index, const
 extern int hash_remove_by_index(hash *const hs, const size_t index);
 
 extern bool hash_is_correct(const hash *const hs);
-extern int hash_clear(hash *const hs);
 
 
-static inline size_t get_hash(const item_t key)
+static inline size_t get_hash(const item_t key, const size_t size)
 {
-	return (size_t)key % MAX_HASH;
+	// Fibonacci hashing spreads sequential keys over table
+	const uint64_t hash = (uint64_t)key * 0x9E3779B97F4A7C15u;
+	return (size_t)(hash ^ (hash >> 32)) & (size - 1);
+}
+
+static inline bool is_removed(const hash *const hs, const size_t index)
+{
+	return vector_at(&hs->records, index) == ITEM_MAX;
+}
+
+static int hash_alloc_table(hash *const hs, const size_t size)
+{
+	size_t *table = malloc(size * sizeof(size_t));
+	if (table == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		table[i] = SIZE_MAX;
+	}
+
+	free(hs->table);
+	hs->table = table;
+	hs->table_size = size;
+	hs->table_used = 0;
+	return 0;
+}
+
+static int hash_grow(hash *const hs)
+{
+	size_t *const table_old = hs->table;
+	const size_t size_old = hs->table_size;
+	hs->table = NULL;
+
+	const size_t size = 2 * size_old;
+	if (hash_alloc_table(hs, size))
+	{
+		hs->table = table_old;
+		hs->table_size = size_old;
+		return -1;
+	}
+
+	// Removed records are dropped from new table
+	for (size_t i = 0; i < size_old; i++)
+	{
+		const size_t index = table_old[i];
+		if (index != SIZE_MAX && !is_removed(hs, index))
+		{
+			size_t slot = get_hash(vector_at(&hs->records, index), size);
+			while (hs->table[slot] != SIZE_MAX)
+			{
+				slot = (slot + 1) & (size - 1);
+			}
+
+			hs->table[slot] = index;
+			hs->table_used++;
+		}
+	}
+
+	free(table_old);
+	return 0;
 }
 
 
@@ -51,8 +114,21 @@ static inline size_t get_hash(const item_t key)
 
 hash hash_create(const size_t alloc)
 {
-	hash hs = vector_create(MAX_HASH + alloc * (3 + VALUE_SIZE));
-	vector_increase(&hs, MAX_HASH);	// All set by zero
+	hash hs;
+	hs.records = vector_create(alloc * (2 + VALUE_SIZE));
+	hs.table = NULL;
+
+	size_t size = MAX_HASH;
+	while (size < 2 * alloc)
+	{
+		size *= 2;
+	}
+
+	if (hash_alloc_table(&hs, size))
+	{
+		vector_clear(&hs.records);
+	}
+
 	return hs;
 }
 
@@ -64,52 +140,52 @@ size_t hash_add(hash *const hs, const item_t key, const size_t amount)
 		return SIZE_MAX;
 	}
 
-	size_t prev = get_hash(key);
-	item_t index = vector_get(hs, prev);
-
-	if (index != 0)
+	// Load factor is kept under 1/2, removed records occupy slots until growth
+	if (2 * (hs->table_used + 1) > hs->table_size && hash_grow(hs))
 	{
-		item_t record = ITEM_MAX;
-		while (index != ITEM_MAX && index != 0)
-		{
-			const item_t temp = vector_get(hs, (size_t)index + 1);
-			if (record == ITEM_MAX && temp == ITEM_MAX && (size_t)vector_get(hs, (size_t)index + 2) == amount)
-			{
-				record = index;
-			}
-			else if (temp == key)
-			{
-				return SIZE_MAX;
-			}
+		return SIZE_MAX;
+	}
 
-			prev = (size_t)index;
-			index = vector_get(hs, prev);
-		}
+	const size_t mask = hs->table_size - 1;
+	size_t slot = get_hash(key, hs->table_size);
+	size_t reuse = SIZE_MAX;
 
-		if (record != ITEM_MAX)
+	COUNTER_INC(COUNTER_HASH_LOOKUPS);
+	for (; hs->table[slot] != SIZE_MAX; slot = (slot + 1) & mask)
+	{
+		COUNTER_INC(COUNTER_HASH_PROBES);
+		const size_t index = hs->table[slot];
+		if (vector_at(&hs->records, index) == key)
 		{
-			index = record;
-			for (size_t i = 0; i < amount; i++)
-			{
-				vector_set(hs, (size_t)index + 3 + i, 0);
-			}
+			return SIZE_MAX;
 		}
-		else if (index == ITEM_MAX)
+
+		if (reuse == SIZE_MAX && is_removed(hs, index) && hash_get_amount_by_index(hs, index) == amount)
 		{
-			return SIZE_MAX;
+			reuse = slot;
 		}
 	}
 
-	if (index == 0)
+	if (reuse != SIZE_MAX)
 	{
-		index = (item_t)vector_size(hs);
-		vector_set(hs, prev, index);
-		vector_increase(hs, 3 + amount);	// New elements set by zero
-		vector_set(hs, (size_t)index + 2, (item_t)amount);
+		const size_t index = hs->table[reuse];
+		for (size_t i = 0; i < amount; i++)
+		{
+			vector_put(&hs->records, index + 2 + i, 0);
+		}
+
+		vector_put(&hs->records, index, key);
+		return index;
 	}
 
-	vector_set(hs, (size_t)index + 1, key);
-	return (size_t)index;
+	const size_t index = vector_size(&hs->records);
+	vector_increase(&hs->records, 2 + amount);	// New elements set by zero
+	vector_put(&hs->records, index, key);
+	vector_put(&hs->records, index + 1, (item_t)amount);
+
+	hs->table[slot] = index;
+	hs->table_used++;
+	return index;
 }
 
 
@@ -120,18 +196,15 @@ size_t hash_get_index(const hash *const hs, const item_t key)
 		return SIZE_MAX;
 	}
 
-	size_t prev = get_hash(key);
-	item_t index = vector_get(hs, prev);
-
-	while (index != ITEM_MAX && index != 0)
+	const size_t mask = hs->table_size - 1;
+	COUNTER_INC(COUNTER_HASH_LOOKUPS);
+	for (size_t slot = get_hash(key, hs->table_size); hs->table[slot] != SIZE_MAX; slot = (slot + 1) & mask)
 	{
-		if (vector_get(hs, (size_t)index + 1) == key)
+		COUNTER_INC(COUNTER_HASH_PROBES);
+		if (vector_at(&hs->records, hs->table[slot]) == key)
 		{
-			return (size_t)index;
+			return hs->table[slot];
 		}
-
-		prev = (size_t)index;
-		index = vector_get(hs, prev);
 	}
 
 	return SIZE_MAX;
@@ -182,3 +255,15 @@ int hash_remove(hash *const hs, const item_t key)
 {
 	return hash_remove_by_index(hs, hash_get_index(hs, key));
 }
+
+int hash_clear(hash *const hs)
+{
+	if (hs == NULL)
+	{
+		return -1;
+	}
+
+	free(hs->table);
+	hs->table = NULL;
+	return vector_clear(&hs->records);
+}
@@ -19,7 +19,7 @@
 #include "vector.h"
 
 
-#define MAX_HASH 256
+#define MAX_HASH 256		/**< Minimal size of hash table */
 #define VALUE_SIZE 4
 
 
@@ -28,7 +28,14 @@ extern "C" {
 #endif
 
 /** Hash table */
-typedef vector hash;
+typedef struct hash
+{
+	vector records;				/**< Records storage: key, amount and values */
+
+	size_t *table;				/**< Open addressing table of records indexes */
+	size_t table_size;			/**< Size of table, power of two */
+	size_t table_used;			/**< Number of used slots of table */
+} hash;
 
 
 /**
@@ -155,7 +162,7 @@ EXPORTED size_t hash_set_int64(hash *const hs, const item_t key, const size_t nu
  */
 inline item_t hash_get_key(const hash *const hs, const size_t index)
 {
-	return vector_get(hs, index + 1);
+	return hs != NULL ? vector_get(&hs->records, index) : ITEM_MAX;
 }
 
 /**
@@ -168,7 +175,7 @@ inline item_t hash_get_key(const hash *const hs, const size_t index)
  */
 inline size_t hash_get_amount_by_index(const hash *const hs, const size_t index)
 {
-	const item_t amount = vector_get(hs, index + 2);
+	const item_t amount = hs != NULL ? vector_get(&hs->records, index + 1) : ITEM_MAX;
 	return index != SIZE_MAX && amount != ITEM_MAX ? (size_t)amount : 0;
 }
 
@@ -184,7 +191,7 @@ inline size_t hash_get_amount_by_index(const hash *const hs, const size_t index)
  */
 inline item_t hash_get_by_index(const hash *const hs, const size_t index, const size_t num)
 {
-	return num < hash_get_amount_by_index(hs, index) ? vector_get(hs, index + 3 + num) : ITEM_MAX;
+	return num < hash_get_amount_by_index(hs, index) ? vector_get(&hs->records, index + 2 + num) : ITEM_MAX;
 }
 
 /**
@@ -198,7 +205,7 @@ inline item_t hash_get_by_index(const hash *const hs, const size_t index, const
  */
 inline double hash_get_double_by_index(const hash *const hs, const size_t index, const size_t num)
 {
-	return num + DOUBLE_SIZE <= hash_get_amount_by_index(hs, index) ? vector_get_double(hs, index + 3 + num) : DBL_MAX;
+	return num + DOUBLE_SIZE <= hash_get_amount_by_index(hs, index) ? vector_get_double(&hs->records, index + 2 + num) : DBL_MAX;
 }
 
 /**
@@ -212,7 +219,7 @@ inline double hash_get_double_by_index(const hash *const hs, const size_t index,
  */
 inline int64_t hash_get_int64_by_index(const hash *const hs, const size_t index, const size_t num)
 {
-	return num + INT64_SIZE <= hash_get_amount_by_index(hs, index) ? vector_get_int64(hs, index + 3 + num) : LLONG_MAX;
+	return num + INT64_SIZE <= hash_get_amount_by_index(hs, index) ? vector_get_int64(&hs->records, index + 2 + num) : LLONG_MAX;
 }
 
 
@@ -228,7 +235,7 @@ inline int64_t hash_get_int64_by_index(const hash *const hs, const size_t index,
  */
 inline int hash_set_by_index(hash *const hs, const size_t index, const size_t num, const item_t value)
 {
-	return num < hash_get_amount_by_index(hs, index) ? vector_set(hs, index + 3 + num, value) : -1;
+	return num < hash_get_amount_by_index(hs, index) ? vector_set(&hs->records, index + 2 + num, value) : -1;
 }
 
 /**
@@ -243,7 +250,7 @@ inline int hash_set_by_index(hash *const hs, const size_t index, const size_t nu
  */
 inline size_t hash_set_double_by_index(hash *const hs, const size_t index, const size_t num, const double value)
 {
-	return num + DOUBLE_SIZE <= hash_get_amount_by_index(hs, index) ? vector_set_double(hs, index + 3 + num, value) : SIZE_MAX;
+	return num + DOUBLE_SIZE <= hash_get_amount_by_index(hs, index) ? vector_set_double(&hs->records, index + 2 + num, value) : SIZE_MAX;
 }
 
 /**
@@ -258,7 +265,7 @@ inline size_t hash_set_double_by_index(hash *const hs, const size_t index, const
  */
 inline size_t hash_set_int64_by_index(hash *const hs, const size_t index, const size_t num, const int64_t value)
 {
-	return num + INT64_SIZE <= hash_get_amount_by_index(hs, index) ? vector_set_int64(hs, index + 3 + num, value) : SIZE_MAX;
+	return num + INT64_SIZE <= hash_get_amount_by_index(hs, index) ? vector_set_int64(&hs->records, index + 2 + num, value) : SIZE_MAX;
 }
 
 
@@ -282,7 +289,7 @@ EXPORTED int hash_remove(hash *const hs, const item_t key);
  */
 inline int hash_remove_by_index(hash *const hs, const size_t index)
 {
-	return index != SIZE_MAX ? vector_set(hs, index + 1, ITEM_MAX) : -1;
+	return hs != NULL && index != SIZE_MAX ? vector_set(&hs->records, index, ITEM_MAX) : -1;
 }
 
 
@@ -295,7 +302,7 @@ inline int hash_remove_by_index(hash *const hs, const size_t index)
  */
 inline bool hash_is_correct(const hash *const hs)
 {
-	return vector_is_correct(hs) && vector_size(hs) >= MAX_HASH;
+	return hs != NULL && vector_is_correct(&hs->records) && hs->table != NULL;
 }
 
 
@@ -306,10 +313,7 @@ inline bool hash_is_correct(const hash *const hs)
  *
  *	@return	@c 0 on success, @c -1 on failure
  */
-inline int hash_clear(hash *const hs)
-{
-	return vector_clear(hs);
-}
+EXPORTED int hash_clear(hash *const hs);
 
 #ifdef __cplusplus
 } /* extern "C" */
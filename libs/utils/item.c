@@ -15,16 +15,10 @@
  */
 
 #include "item.h"
-#include <math.h>
 #include <string.h>
 #include "workspace.h"
 
 
-#ifndef abs
-	#define abs(a) ((a) < 0 ? -(a) : (a))
-#endif
-
-
 #if ITEM > 32
 	static const item_status CURRENT_STATUS = item_uint64;
 #elif ITEM > 16
@@ -61,9 +55,11 @@ static inline size_t item_get_size(const item_status status)
 							? 4
 							: 8;
 
-	if ((size_t)abs(ITEM) <= 32 / size)
+	// Host items narrower than target items need several host items for each target item
+	const size_t bits = 8 * sizeof(item_t);
+	if (bits < 64 / size)
 	{
-		size = (size_t)pow(2, ceil(log2(abs(ITEM))));
+		size = 64 / bits;
 	}
 
 	return size;
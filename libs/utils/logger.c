@@ -21,6 +21,7 @@
 #include "utf8.h"
 
 #ifdef _WIN32
+	#include <io.h>
 	#include <windows.h>
 
 	static const uint8_t COLOR_TAG = 0x0F;
@@ -29,6 +30,8 @@
 	static const uint8_t COLOR_NOTE = 0x0E;
 	static const uint8_t COLOR_DEFAULT = 0x07;
 #else
+	#include <unistd.h>
+
 	static const uint8_t COLOR_TAG = 39;
 	static const uint8_t COLOR_ERROR = 31;
 	static const uint8_t COLOR_WARNING = 35;
@@ -52,39 +55,112 @@ static const char *const ERROR_LOGGER_NO_LOCATION  = "позиционирова
 static void default_error_log(const char *const tag, const char *const msg);
 static void default_warning_log(const char *const tag, const char *const msg);
 static void default_note_log(const char *const tag, const char *const msg);
+static void default_report_log(const char *const tag, const char *const msg);
 
 
 static logger current_error_log = &default_error_log;
 static logger current_warning_log = &default_warning_log;
 static logger current_note_log = &default_note_log;
+static logger current_report_log = &default_report_log;
+
+// Собственный обработчик потока позволяет нескольким заданиям одного процесса разделять сообщения
+static _Thread_local logger thread_error_log = NULL;
+static _Thread_local logger thread_warning_log = NULL;
+
+
+/** Diagnostic assembled in memory, since stderr is not buffered and each write is a system call */
+typedef struct output
+{
+	char data[2 * MAX_MSG_SIZE];		/**< Text of diagnostic with colors */
+	size_t size;						/**< Size of text */
+} output;
+
 
+/** Append bytes from begin to end, excess bytes are dropped */
+static inline void output_range(output *const out, const char *const msg, const size_t begin, const size_t end)
+{
+	const size_t free = sizeof(out->data) - out->size;
+	const size_t size = end > begin ? end - begin : 0;
+	const size_t amount = size < free ? size : free;
+
+	memcpy(&out->data[out->size], &msg[begin], amount);
+	out->size += amount;
+}
+
+static inline void output_string(output *const out, const char *const str)
+{
+	output_range(out, str, 0, strlen(str));
+}
 
-static inline void set_color(const uint8_t color)
+/** Write assembled text at once */
+static inline void output_flush(output *const out)
+{
+	if (out->size != 0)
+	{
+		fwrite(out->data, 1, out->size, stderr);
+		out->size = 0;
+	}
+}
+
+static inline void set_color(output *const out, const uint8_t color)
 {
 #if defined(NDEBUG) || !defined(__APPLE__)
+	// Вывод в файл или канал не раскрашивается, проверка делается один раз для потока
+	static _Thread_local int is_terminal = -1;
+	if (is_terminal == -1)
+	{
+	#ifdef _WIN32
+		is_terminal = _isatty(_fileno(stderr)) ? 1 : 0;
+	#else
+		is_terminal = isatty(fileno(stderr)) ? 1 : 0;
+	#endif
+	}
+
+	if (!is_terminal)
+	{
+		return;
+	}
+
 	#ifdef _WIN32
+		// Цвет консоли меняется вызовом, поэтому накопленный текст выводится перед ним
+		output_flush(out);
 		SetConsoleTextAttribute(GetStdHandle(STD_ERROR_HANDLE), color);
 	#else
-		fprintf(stderr, "\x1B[1;%im", color);
+		char escape[16];
+		sprintf(escape, "\x1B[1;%im", color);
+		output_string(out, escape);
 	#endif
 #else
+	(void)out;
 	(void)color;
 #endif
 }
 
-static inline void print_msg(const uint8_t color, const char *const msg)
+/** Get index of byte after the symbol starting at index */
+static inline size_t next_symbol(const char *const msg, const size_t index)
+{
+#ifdef _WIN32
+	(void)msg;
+	return index + 1;
+#else
+	return index + utf8_symbol_size(msg[index]);
+#endif
+}
+
+static inline void print_msg(output *const out, const uint8_t color, const char *const msg)
 {
-	set_color(COLOR_DEFAULT);
+	set_color(out, COLOR_DEFAULT);
 
 	size_t i = 0;
 	while (msg[i] != '\0' && msg[i] != '\n')
 	{
-		fprintf(stderr, "%c", msg[i++]);
+		i++;
 	}
+	output_range(out, msg, 0, i);
 
 	if (msg[i] == '\0')
 	{
-		fprintf(stderr, "\n");
+		output_string(out, "\n");
 		return;
 	}
 
@@ -96,71 +172,70 @@ static inline void print_msg(const uint8_t color, const char *const msg)
 
 	if (msg[j] == '\0')
 	{
-		fprintf(stderr, "%s\n", &msg[i]);
+		output_string(out, &msg[i]);
+		output_string(out, "\n");
 		return;
 	}
 
+	size_t begin = i;
 	while (msg[j] != '^')
 	{
-#ifdef _WIN32
-		fprintf(stderr, "%c", msg[i++]);
-#else
-		for (size_t k = utf8_symbol_size(msg[i]); k > 0; k--)
-		{
-			fprintf(stderr, "%c", msg[i++]);
-		}
-#endif
-
+		i = next_symbol(msg, i);
 		j++;
 	}
+	output_range(out, msg, begin, i);
 
-	set_color(color);
+	set_color(out, color);
+	begin = i;
 	while (msg[j] != '\0')
 	{
-#ifdef _WIN32
-		fprintf(stderr, "%c", msg[i++]);
-#else
-		for (size_t k = utf8_symbol_size(msg[i]); k > 0; k--)
-		{
-			fprintf(stderr, "%c", msg[i++]);
-		}
-#endif
-
+		i = next_symbol(msg, i);
 		j++;
 	}
+	output_range(out, msg, begin, i);
 
-	set_color(COLOR_DEFAULT);
+	set_color(out, COLOR_DEFAULT);
+	begin = i;
 	while (msg[i] != '\n')
 	{
-		fprintf(stderr, "%c", msg[i++]);
+		i++;
 	}
+	output_range(out, msg, begin, i);
 
-	set_color(color);
-	fprintf(stderr, "%s\n", &msg[i]);
-	set_color(COLOR_DEFAULT);
+	set_color(out, color);
+	output_string(out, &msg[i]);
+	output_string(out, "\n");
+	set_color(out, COLOR_DEFAULT);
 }
 
 
 static inline void default_log(const char *const tag, const char *const msg, const uint8_t color, const char *const tag_log)
 {
-	set_color(COLOR_TAG);
-	fprintf(stderr, "%s: ", tag);
+	output out;
+	out.size = 0;
+
+	set_color(&out, COLOR_TAG);
+	output_string(&out, tag);
+	output_string(&out, ": ");
 
-	set_color(color);
+	set_color(&out, color);
 #ifdef _WIN32
 	char buffer[MAX_MSG_SIZE];
 	utf8_to_cp866(tag_log, buffer);
-	fprintf(stderr, "%s: ", buffer);
+	output_string(&out, buffer);
 #else
-	fprintf(stderr, "%s: ", tag_log);
+	output_string(&out, tag_log);
 #endif
+	output_string(&out, ": ");
 
 #ifdef _WIN32
 	utf8_to_cp866(msg, buffer);
-	print_msg(color, buffer);
+	print_msg(&out, color, buffer);
 #else
-	print_msg(color, msg);
+	print_msg(&out, color, msg);
 #endif
+
+	output_flush(&out);
 }
 
 static void default_error_log(const char *const tag, const char *const msg)
@@ -178,18 +253,34 @@ static void default_note_log(const char *const tag, const char *const msg)
 	default_log(tag, msg, COLOR_NOTE, TAG_NOTE);
 }
 
+static void default_report_log(const char *const tag, const char *const msg)
+{
+	// Отчёты разбираются программами, поэтому выводятся без цвета
+	fprintf(stderr, "%s: %s\n", tag, msg);
+}
+
+
+static inline logger get_error_log(void)
+{
+	return thread_error_log != NULL ? thread_error_log : current_error_log;
+}
+
+static inline logger get_warning_log(void)
+{
+	return thread_warning_log != NULL ? thread_warning_log : current_warning_log;
+}
 
 static int check_arg(const char *const arg)
 {
 	if (arg == NULL)
 	{
-		current_error_log(TAG_LOGGER, ERROR_LOGGER_ARG_NULL);
+		get_error_log()(TAG_LOGGER, ERROR_LOGGER_ARG_NULL);
 		return -1;
 	}
 
 	if (strchr(arg, '\n') != NULL)
 	{
-		current_error_log(TAG_LOGGER, ERROR_LOGGER_ARG_MULTILINE);
+		get_error_log()(TAG_LOGGER, ERROR_LOGGER_ARG_MULTILINE);
 		return -1;
 	}
 
@@ -248,10 +339,13 @@ static void splice(char *const buffer, const char *const msg, const char *const
 	size_t size = 0;
 	while (line[size] != '\0' && line[size] != '\n')
 	{
-		cur += (size_t)sprintf(&buffer[cur], "%c", line[size]);
 		size++;
 	}
 
+	memcpy(&buffer[cur], line, size);
+	cur += size;
+	buffer[cur] = '\0';
+
 	const size_t ch = literal(line, symbol);
 	const size_t len = length(line, size, ch);
 	if (len == 0)
@@ -284,7 +378,7 @@ static inline void log_main(const logger func, const char *const tag, const char
 
 	if (line == NULL)
 	{
-		current_error_log(TAG_LOGGER, ERROR_LOGGER_ARG_NULL);
+		get_error_log()(TAG_LOGGER, ERROR_LOGGER_ARG_NULL);
 		return;
 	}
 
@@ -305,7 +399,7 @@ static inline void log_auto(const logger func, location *const loc, const char *
 	char line[MAX_MSG_SIZE];
 	if (!loc_get_tag(loc, tag) || !loc_get_code_line(loc, line))
 	{
-		current_error_log(TAG_LOGGER, ERROR_LOGGER_NO_LOCATION);
+		get_error_log()(TAG_LOGGER, ERROR_LOGGER_NO_LOCATION);
 		return;
 	}
 
@@ -336,6 +430,20 @@ int set_error_log(const logger func)
 	return 0;
 }
 
+logger set_thread_error_log(const logger func)
+{
+	const logger previous = thread_error_log;
+	thread_error_log = func;
+	return previous;
+}
+
+logger set_thread_warning_log(const logger func)
+{
+	const logger previous = thread_warning_log;
+	thread_warning_log = func;
+	return previous;
+}
+
 int set_warning_log(const logger func)
 {
 	if (func == NULL)
@@ -358,15 +466,26 @@ int set_note_log(const logger func)
 	return 0;
 }
 
+int set_report_log(const logger func)
+{
+	if (func == NULL)
+	{
+		return -1;
+	}
+
+	current_report_log = func;
+	return 0;
+}
+
 
 void log_error(const char *const tag, const char *const msg, const char *const line, const size_t symbol)
 {
-	log_main(current_error_log, tag, msg, line, symbol);
+	log_main(get_error_log(), tag, msg, line, symbol);
 }
 
 void log_warning(const char *const tag, const char *const msg, const char *const line, const size_t symbol)
 {
-	log_main(current_warning_log, tag, msg, line, symbol);
+	log_main(get_warning_log(), tag, msg, line, symbol);
 }
 
 void log_note(const char *const tag, const char *const msg, const char *const line, const size_t symbol)
@@ -377,12 +496,12 @@ void log_note(const char *const tag, const char *const msg, const char *const li
 
 void log_auto_error(location *const loc, const char *const msg)
 {
-	log_auto(current_error_log, loc, msg);
+	log_auto(get_error_log(), loc, msg);
 }
 
 void log_auto_warning(location *const loc, const char *const msg)
 {
-	log_auto(current_warning_log, loc, msg);
+	log_auto(get_warning_log(), loc, msg);
 }
 
 void log_auto_note(location *const loc, const char *const msg)
@@ -398,7 +517,7 @@ void log_system_error(const char *const tag, const char *const msg)
 		return;
 	}
 
-	current_error_log(tag, msg);
+	get_error_log()(tag, msg);
 }
 
 void log_system_warning(const char *const tag, const char *const msg)
@@ -408,7 +527,7 @@ void log_system_warning(const char *const tag, const char *const msg)
 		return;
 	}
 
-	current_warning_log(tag, msg);
+	get_warning_log()(tag, msg);
 }
 
 void log_system_note(const char *const tag, const char *const msg)
@@ -420,3 +539,30 @@ void log_system_note(const char *const tag, const char *const msg)
 
 	current_note_log(tag, msg);
 }
+
+void log_relayed_error(const char *const tag, const char *const msg)
+{
+	if (tag != NULL && msg != NULL)
+	{
+		get_error_log()(tag, msg);
+	}
+}
+
+void log_relayed_warning(const char *const tag, const char *const msg)
+{
+	if (tag != NULL && msg != NULL)
+	{
+		get_warning_log()(tag, msg);
+	}
+}
+
+
+void log_report(const char *const tag, const char *const msg)
+{
+	if (check_arg(tag) || check_arg(msg))
+	{
+		return;
+	}
+
+	current_report_log(tag, msg);
+}
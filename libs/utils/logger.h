@@ -43,6 +43,15 @@ typedef void (*logger)(const char *const tag, const char *const msg);
  */
 EXPORTED int set_error_log(const logger func);
 
+/**
+ *	Set error logging function for current thread only
+ *
+ *	@param	func	Custom logging function, @c NULL to use common one
+ *
+ *	@return	Previous function of current thread
+ */
+EXPORTED logger set_thread_error_log(const logger func);
+
 /**
  *	Set custom warning logging function
  *
@@ -52,6 +61,15 @@ EXPORTED int set_error_log(const logger func);
  */
 EXPORTED int set_warning_log(const logger func);
 
+/**
+ *	Set warning logging function for current thread only
+ *
+ *	@param	func	Custom logging function, @c NULL to use common one
+ *
+ *	@return	Previous function of current thread
+ */
+EXPORTED logger set_thread_warning_log(const logger func);
+
 /**
  *	Set custom note logging function
  *
@@ -61,6 +79,15 @@ EXPORTED int set_warning_log(const logger func);
  */
 EXPORTED int set_note_log(const logger func);
 
+/**
+ *	Set custom report logging function, which receives statistics of compilation
+ *
+ *	@param	func	Custom logging function
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int set_report_log(const logger func);
+
 
 /**
  *	Add error message to log
@@ -142,6 +169,33 @@ EXPORTED void log_system_warning(const char *const tag, const char *const msg);
  */
 EXPORTED void log_system_note(const char *const tag, const char *const msg);
 
+/**
+ *	Add error message, which is already spliced with line of code, to log.
+ *	Used for messages received from other processes, message may consist of several lines.
+ *
+ *	@param	tag		Message location
+ *	@param	msg		Spliced message content
+ */
+EXPORTED void log_relayed_error(const char *const tag, const char *const msg);
+
+/**
+ *	Add warning message, which is already spliced with line of code, to log.
+ *	Used for messages received from other processes, message may consist of several lines.
+ *
+ *	@param	tag		Message location
+ *	@param	msg		Spliced message content
+ */
+EXPORTED void log_relayed_warning(const char *const tag, const char *const msg);
+
+
+/**
+ *	Add report line to log
+ *
+ *	@param	tag		Report source
+ *	@param	msg		Report line
+ */
+EXPORTED void log_report(const char *const tag, const char *const msg);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,254 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "lz.h"
+#include <string.h>
+
+
+#define LZ_HASH_BITS 12
+
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_LIMIT 12
+#define LZ_MAX_OFFSET 65535
+#define LZ_MAX_SIZE 0x7E000000
+
+#define LZ_RUN_MASK 15
+
+
+static inline uint32_t lz_read(const uint8_t *const src)
+{
+	uint32_t value;
+	memcpy(&value, src, sizeof(value));
+	return value;
+}
+
+static inline size_t lz_hash(const uint32_t value)
+{
+	return (size_t)((value * 2654435761U) >> (32 - LZ_HASH_BITS));
+}
+
+/** Write extension bytes of length, which does not fit into token */
+static size_t lz_write_length(uint8_t *const dst, size_t out, size_t length)
+{
+	if (length < LZ_RUN_MASK)
+	{
+		return out;
+	}
+
+	for (length -= LZ_RUN_MASK; length >= 255; length -= 255)
+	{
+		dst[out++] = 255;
+	}
+
+	dst[out++] = (uint8_t)length;
+	return out;
+}
+
+static inline uint8_t lz_token_part(const size_t length)
+{
+	return (uint8_t)(length < LZ_RUN_MASK ? length : LZ_RUN_MASK);
+}
+
+/** Worst size of sequence with literals and match lengths */
+static inline size_t lz_sequence_size(const size_t literals, const size_t match)
+{
+	return 1 + literals / 255 + 1 + literals + 2 + match / 255 + 1;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+size_t lz_bound(const size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t lz_compress(const uint8_t *const src, const size_t size, uint8_t *const dst, const size_t capacity)
+{
+	if ((src == NULL && size != 0) || dst == NULL || size > LZ_MAX_SIZE)
+	{
+		return SIZE_MAX;
+	}
+
+	// Позиции хранятся со сдвигом на единицу, ноль означает пустую ячейку
+	uint32_t table[1 << LZ_HASH_BITS];
+	memset(table, 0, sizeof(table));
+
+	size_t out = 0;
+	size_t anchor = 0;
+	size_t i = 0;
+	while (i + LZ_MATCH_LIMIT <= size)
+	{
+		const uint32_t sequence = lz_read(&src[i]);
+		const size_t hash = lz_hash(sequence);
+		const size_t candidate = table[hash];
+		table[hash] = (uint32_t)(i + 1);
+
+		if (candidate == 0 || i - (candidate - 1) > LZ_MAX_OFFSET || lz_read(&src[candidate - 1]) != sequence)
+		{
+			i++;
+			continue;
+		}
+
+		// Совпадение заканчивается не ближе последних литералов блока
+		const size_t reference = candidate - 1;
+		const size_t limit = size - LZ_LAST_LITERALS;
+		size_t length = LZ_MIN_MATCH;
+		while (i + length < limit && src[reference + length] == src[i + length])
+		{
+			length++;
+		}
+
+		const size_t literals = i - anchor;
+		if (out + lz_sequence_size(literals, length) > capacity)
+		{
+			return SIZE_MAX;
+		}
+
+		dst[out++] = (uint8_t)(lz_token_part(literals) << 4 | lz_token_part(length - LZ_MIN_MATCH));
+		out = lz_write_length(dst, out, literals);
+		memcpy(&dst[out], &src[anchor], literals);
+		out += literals;
+
+		const size_t offset = i - reference;
+		dst[out++] = (uint8_t)(offset & 0xFF);
+		dst[out++] = (uint8_t)(offset >> 8);
+		out = lz_write_length(dst, out, length - LZ_MIN_MATCH);
+
+		i += length;
+		anchor = i;
+
+		// Середина совпадения тоже может начать следующее
+		if (i + LZ_MATCH_LIMIT <= size)
+		{
+			table[lz_hash(lz_read(&src[i - 2]))] = (uint32_t)(i - 1);
+		}
+	}
+
+	const size_t literals = size - anchor;
+	if (out + lz_sequence_size(literals, 0) > capacity)
+	{
+		return SIZE_MAX;
+	}
+
+	dst[out++] = (uint8_t)(lz_token_part(literals) << 4);
+	out = lz_write_length(dst, out, literals);
+	if (literals != 0)
+	{
+		memcpy(&dst[out], &src[anchor], literals);
+	}
+
+	return out + literals;
+}
+
+size_t lz_decompress(const uint8_t *const src, const size_t size, uint8_t *const dst, const size_t capacity)
+{
+	if (src == NULL || (dst == NULL && capacity != 0))
+	{
+		return SIZE_MAX;
+	}
+
+	size_t in = 0;
+	size_t out = 0;
+	while (in < size)
+	{
+		const uint8_t token = src[in++];
+
+		size_t literals = token >> 4;
+		if (literals == LZ_RUN_MASK)
+		{
+			uint8_t byte;
+			do
+			{
+				if (in == size)
+				{
+					return SIZE_MAX;
+				}
+
+				byte = src[in++];
+				literals += byte;
+			} while (byte == 255);
+		}
+
+		if (literals > size - in || literals > capacity - out)
+		{
+			return SIZE_MAX;
+		}
+
+		if (literals != 0)
+		{
+			memcpy(&dst[out], &src[in], literals);
+		}
+		in += literals;
+		out += literals;
+
+		// Последняя последовательность состоит только из литералов
+		if (in == size)
+		{
+			break;
+		}
+
+		if (size - in < 2)
+		{
+			return SIZE_MAX;
+		}
+
+		const size_t offset = (size_t)src[in] | (size_t)src[in + 1] << 8;
+		in += 2;
+		if (offset == 0 || offset > out)
+		{
+			return SIZE_MAX;
+		}
+
+		size_t length = token & LZ_RUN_MASK;
+		if (length == LZ_RUN_MASK)
+		{
+			uint8_t byte;
+			do
+			{
+				if (in == size)
+				{
+					return SIZE_MAX;
+				}
+
+				byte = src[in++];
+				length += byte;
+			} while (byte == 255);
+		}
+
+		length += LZ_MIN_MATCH;
+		if (length > capacity - out)
+		{
+			return SIZE_MAX;
+		}
+
+		// Копирование по байту, так как совпадение может перекрывать само себя
+		for (size_t i = 0; i < length; i++, out++)
+		{
+			dst[out] = dst[out - offset];
+		}
+	}
+
+	return out;
+}
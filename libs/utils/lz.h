@@ -0,0 +1,64 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dll.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Get maximal size of compressed data
+ *
+ *	@param	size			Size of data
+ *
+ *	@return	Size of buffer enough for compressed data
+ */
+EXPORTED size_t lz_bound(const size_t size);
+
+/**
+ *	Compress data into LZ4 block format,
+ *	so every section can be decompressed independently by any LZ4 block decoder
+ *
+ *	@param	src				Data
+ *	@param	size			Size of data
+ *	@param	dst				Buffer for compressed data
+ *	@param	capacity		Size of buffer
+ *
+ *	@return	Size of compressed data, @c SIZE_MAX on failure
+ */
+EXPORTED size_t lz_compress(const uint8_t *const src, const size_t size, uint8_t *const dst, const size_t capacity);
+
+/**
+ *	Decompress data from LZ4 block format
+ *
+ *	@param	src				Compressed data
+ *	@param	size			Size of compressed data
+ *	@param	dst				Buffer for data
+ *	@param	capacity		Size of buffer
+ *
+ *	@return	Size of data, @c SIZE_MAX on malformed data or small buffer
+ */
+EXPORTED size_t lz_decompress(const uint8_t *const src, const size_t size, uint8_t *const dst, const size_t capacity);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
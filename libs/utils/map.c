@@ -17,18 +17,47 @@
 #include "map.h"
 #include <stdlib.h>
 #include <string.h>
+#include "counters.h"
 #include "uniscanner.h"
 #include "utf8.h"
 
 
 struct map_hash
 {
-	size_t next;
+	size_t hash;
 	size_t ref;
 	item_t value;
 };
 
 
+static const uint64_t MAP_SEED = 0xa0761d6478bd642f;
+static const uint64_t MAP_PRIME = 0xe7037ed1a0b428db;
+
+
+static int map_reserve_keys(map *const as, const size_t size)
+{
+	size_t alloc_new = as->keys_alloc;
+	while (alloc_new - as->keys_size < size)
+	{
+		alloc_new *= 2;
+	}
+
+	if (alloc_new == as->keys_alloc)
+	{
+		return 0;
+	}
+
+	char *keys_new = realloc(as->keys, alloc_new * sizeof(char));
+	if (keys_new == NULL)
+	{
+		return -1;
+	}
+
+	as->keys_alloc = alloc_new;
+	as->keys = keys_new;
+	return 0;
+}
+
 static int map_add_key_symbol(map *const as, const char32_t ch)
 {
 	if (MAX_SYMBOL_SIZE <= as->keys_alloc - as->keys_next)
@@ -48,34 +77,41 @@ static int map_add_key_symbol(map *const as, const char32_t ch)
 	return map_add_key_symbol(as, ch);
 }
 
-static size_t map_get_hash(map *const as, const char *const key)
+static inline uint64_t map_mix(const uint64_t fst, const uint64_t snd)
 {
-	if (!map_is_correct(as) || key == NULL || key[0] == '\0')
-	{
-		return SIZE_MAX;
-	}
-
-	as->keys_next = as->keys_size;
+#ifdef __SIZEOF_INT128__
+	const __uint128_t product = (__uint128_t)fst * snd;
+	return (uint64_t)product ^ (uint64_t)(product >> 64);
+#else
+	const uint64_t product = (fst ^ (fst >> 32)) * snd;
+	return product ^ (product >> 29);
+#endif
+}
 
-	char32_t ch = utf8_convert(key);
-	if (map_add_key_symbol(as, ch))
+/** Hash UTF-8 octets of key, never returns @c SIZE_MAX */
+static size_t map_hash_span(const char *const key, const size_t size)
+{
+	uint64_t hash = MAP_SEED ^ size;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
 	{
-		return SIZE_MAX;
+		uint64_t word;
+		memcpy(&word, &key[i], sizeof(uint64_t));
+		hash = map_mix(hash ^ word, MAP_PRIME);
 	}
 
-	size_t hash = ch;
-	while (key[as->keys_next - as->keys_size] != '\0')
-	{
-		ch = utf8_convert(&key[as->keys_next - as->keys_size]);
-		if (map_add_key_symbol(as, ch))
-		{
-			return SIZE_MAX;
-		}
+	uint64_t tail = 0;
+	memcpy(&tail, &key[i], size - i);
+	hash = map_mix(hash ^ tail, MAP_PRIME ^ size);
 
-		hash += ch;
-	}
+	const size_t result = (size_t)(hash ^ (hash >> 32));
+	return result == SIZE_MAX ? 0 : result;
+}
 
-	return hash % MAP_HASH_MAX;
+/** Hash UTF-8 octets of last read key */
+static inline size_t map_hash_key(const map *const as)
+{
+	return map_hash_span(&as->keys[as->keys_size], as->keys_next - as->keys_size);
 }
 
 static size_t map_get_hash_by_utf8(map *const as, const char32_t *const key)
@@ -87,18 +123,15 @@ static size_t map_get_hash_by_utf8(map *const as, const char32_t *const key)
 
 	as->keys_next = as->keys_size;
 
-	size_t hash = 0;
 	for (size_t i = 0; key[i] != '\0'; i++)
 	{
 		if (map_add_key_symbol(as, key[i]))
 		{
 			return SIZE_MAX;
 		}
-
-		hash += key[i];
 	}
 
-	return hash % MAP_HASH_MAX;
+	return map_hash_key(as);
 }
 
 static size_t map_get_hash_by_io(map *const as, universal_io *const io, char32_t *const last)
@@ -121,80 +154,118 @@ static size_t map_get_hash_by_io(map *const as, universal_io *const io, char32_t
 		return SIZE_MAX;
 	}
 
-	size_t hash = *last;
 	*last = uni_scan_char(io);
-	while (utf8_is_letter(*last) || utf8_is_digit(*last))
+	while ((utf8_get_class(*last) & (UTF8_LETTER | UTF8_DIGIT)) != 0)
 	{
 		if (map_add_key_symbol(as, *last))
 		{
 			return SIZE_MAX;
 		}
 
-		hash += *last;
 		*last = uni_scan_char(io);
 	}
 
-	return hash % MAP_HASH_MAX;
+	return map_hash_key(as);
 }
 
 
-static inline int map_cmp_key(const map *const as, const size_t index)
+static inline bool map_cmp_key(const map *const as, const size_t index, const size_t hash
+	, const char *const key, const size_t size)
 {
-	return strcmp(&as->keys[as->values[index].ref], &as->keys[as->keys_size]);
-}
-
-static inline size_t map_get_index_by_hash(const map *const as, const size_t hash)
-{
-	if (hash == SIZE_MAX)
+	if (as->values[index].hash != hash)
 	{
-		return SIZE_MAX;
+		return false;
 	}
 
-	size_t index = hash;
-	while (as->values[index].next != SIZE_MAX)
+	// Stored key is null-terminated, so it is never read beyond its end
+	const char *const stored = &as->keys[as->values[index].ref];
+	for (size_t i = 0; i < size; i++)
 	{
-		if (map_cmp_key(as, index) == 0)
+		if (stored[i] != key[i] || stored[i] == '\0')
 		{
-			return index;
+			return false;
 		}
-		index = as->values[index].next;
 	}
 
-	if (as->values[index].ref == SIZE_MAX || map_cmp_key(as, index) != 0)
+	return stored[size] == '\0';
+}
+
+/** Return table slot of key span with such hash, or empty slot where it should be */
+static inline size_t map_find_span_slot(const map *const as, const size_t hash
+	, const char *const key, const size_t size)
+{
+	const size_t mask = as->table_size - 1;
+	size_t slot = hash & mask;
+
+	COUNTER_INC(COUNTER_MAP_LOOKUPS);
+	while (as->table[slot] != SIZE_MAX && !map_cmp_key(as, as->table[slot], hash, key, size))
 	{
-		return SIZE_MAX;
+		COUNTER_INC(COUNTER_MAP_PROBES);
+		slot = (slot + 1) & mask;
 	}
 
-	return index;
+	return slot;
 }
 
-static size_t map_add_by_hash(map *const as, const size_t hash, const item_t value)
+/** Return table slot of last read key with such hash, or empty slot where it should be */
+static inline size_t map_find_slot(const map *const as, const size_t hash)
 {
-	if (hash == SIZE_MAX)
+	return map_find_span_slot(as, hash, &as->keys[as->keys_size], as->keys_next - as->keys_size);
+}
+
+static int map_grow_table(map *const as)
+{
+	const size_t size_new = 2 * as->table_size;
+	size_t *table_new = malloc(size_new * sizeof(size_t));
+	if (table_new == NULL)
 	{
-		return SIZE_MAX;
+		return -1;
+	}
+
+	for (size_t i = 0; i < size_new; i++)
+	{
+		table_new[i] = SIZE_MAX;
 	}
 
-	size_t index = hash;
-	while (as->values[index].next != SIZE_MAX)
+	// Stored hashes make rehashing independent of keys
+	for (size_t i = 0; i < as->values_size; i++)
 	{
-		if (map_cmp_key(as, index) == 0)
+		size_t slot = as->values[i].hash & (size_new - 1);
+		while (table_new[slot] != SIZE_MAX)
 		{
-			return value == ITEM_MAX ? index : SIZE_MAX;
+			slot = (slot + 1) & (size_new - 1);
 		}
-		index = as->values[index].next;
+		table_new[slot] = i;
 	}
 
-	if (as->values[index].ref == SIZE_MAX)
+	free(as->table);
+	as->table = table_new;
+	as->table_size = size_new;
+	return 0;
+}
+
+static inline size_t map_get_index_by_hash(const map *const as, const size_t hash)
+{
+	if (hash == SIZE_MAX)
 	{
-		as->values[index].ref = as->keys_size;
-		as->keys_size = as->keys_next + 1;
-		as->values[index].value = value;
-		return index;
+		return SIZE_MAX;
 	}
-	else if (map_cmp_key(as, index) == 0)
+
+	return as->table[map_find_slot(as, hash)];
+}
+
+/** Insert last read key to empty slot found for it */
+static size_t map_insert(map *const as, size_t slot, const size_t hash, const item_t value)
+{
+	// Load factor is kept under 1/2
+	if (2 * (as->values_size + 1) > as->table_size)
 	{
-		return value == ITEM_MAX ? index : SIZE_MAX;
+		if (map_grow_table(as))
+		{
+			return SIZE_MAX;
+		}
+
+		slot = map_find_slot(as, hash);
 	}
 
 	if (as->values_size == as->values_alloc)
@@ -209,16 +280,75 @@ static size_t map_add_by_hash(map *const as, const size_t hash, const item_t val
 		as->values = values_new;
 	}
 
-	as->values[index].next = as->values_size;
-	index = as->values_size++;
+	const size_t index = as->values_size++;
+	as->table[slot] = index;
 
-	as->values[index].next = SIZE_MAX;
+	as->values[index].hash = hash;
 	as->values[index].ref = as->keys_size;
 	as->keys_size = as->keys_next + 1;
 	as->values[index].value = value;
 	return index;
 }
 
+static size_t map_add_by_hash(map *const as, const size_t hash, const item_t value)
+{
+	if (hash == SIZE_MAX)
+	{
+		return SIZE_MAX;
+	}
+
+	const size_t slot = map_find_slot(as, hash);
+	if (as->table[slot] != SIZE_MAX)
+	{
+		return value == ITEM_MAX ? as->table[slot] : SIZE_MAX;
+	}
+
+	return map_insert(as, slot, hash, value);
+}
+
+static inline bool map_is_span(const map *const as, const char *const key, const size_t size)
+{
+	return map_is_correct(as) && key != NULL && size != 0;
+}
+
+static size_t map_add_by_span_hash(map *const as, const char *const key, const size_t size, const item_t value)
+{
+	if (!map_is_span(as, key, size))
+	{
+		return SIZE_MAX;
+	}
+
+	// Key is compared in place and copied to storage only on insertion
+	const size_t hash = map_hash_span(key, size);
+	const size_t slot = map_find_span_slot(as, hash, key, size);
+	if (as->table[slot] != SIZE_MAX)
+	{
+		as->keys_next = as->keys_size;
+		return value == ITEM_MAX ? as->table[slot] : SIZE_MAX;
+	}
+
+	if (map_reserve_keys(as, size + 1))
+	{
+		return SIZE_MAX;
+	}
+
+	memcpy(&as->keys[as->keys_size], key, size);
+	as->keys_next = as->keys_size + size;
+	as->keys[as->keys_next] = '\0';
+	return map_insert(as, slot, hash, value);
+}
+
+static size_t map_get_index_by_span_hash(map *const as, const char *const key, const size_t size)
+{
+	if (!map_is_span(as, key, size))
+	{
+		return SIZE_MAX;
+	}
+
+	as->keys_next = as->keys_size;
+	return as->table[map_find_span_slot(as, map_hash_span(key, size), key, size)];
+}
+
 static size_t map_set_by_hash(map *const as, const size_t hash, const item_t value)
 {
 	const size_t index = map_get_index_by_hash(as, hash);
@@ -248,6 +378,7 @@ static inline map map_broken()
 	map as;
 	as.values = NULL;
 	as.keys = NULL;
+	as.table = NULL;
 	return as;
 }
 
@@ -265,8 +396,8 @@ map map_create(const size_t alloc)
 {
 	map as;
 
-	as.values_size = MAP_HASH_MAX;
-	as.values_alloc = as.values_size + alloc;
+	as.values_size = 0;
+	as.values_alloc = alloc != 0 ? alloc : 1;
 
 	as.values = malloc(as.values_alloc * sizeof(map_hash));
 	if (as.values == NULL)
@@ -274,10 +405,22 @@ map map_create(const size_t alloc)
 		return map_broken();
 	}
 
-	for (size_t i = 0; i < as.values_size; i++)
+	as.table_size = MAP_HASH_MAX;
+	while (as.table_size < 2 * as.values_alloc)
+	{
+		as.table_size *= 2;
+	}
+
+	as.table = malloc(as.table_size * sizeof(size_t));
+	if (as.table == NULL)
+	{
+		free(as.values);
+		return map_broken();
+	}
+
+	for (size_t i = 0; i < as.table_size; i++)
 	{
-		as.values[i].next = SIZE_MAX;
-		as.values[i].ref = SIZE_MAX;
+		as.table[i] = SIZE_MAX;
 	}
 
 	as.keys_size = 0;
@@ -286,6 +429,7 @@ map map_create(const size_t alloc)
 	as.keys = malloc(as.keys_alloc * sizeof(char));
 	if (as.keys == NULL)
 	{
+		free(as.table);
 		free(as.values);
 		return map_broken();
 	}
@@ -293,10 +437,40 @@ map map_create(const size_t alloc)
 	return as;
 }
 
+map map_copy(const map *const as)
+{
+	if (!map_is_correct(as))
+	{
+		return map_broken();
+	}
+
+	map copy = *as;
+	copy.values = malloc(as->values_alloc * sizeof(map_hash));
+	copy.table = malloc(as->table_size * sizeof(size_t));
+	copy.keys = malloc(as->keys_alloc * sizeof(char));
+	if (copy.values == NULL || copy.table == NULL || copy.keys == NULL)
+	{
+		free(copy.values);
+		free(copy.table);
+		free(copy.keys);
+		return map_broken();
+	}
+
+	memcpy(copy.values, as->values, as->values_size * sizeof(map_hash));
+	memcpy(copy.table, as->table, as->table_size * sizeof(size_t));
+	memcpy(copy.keys, as->keys, as->keys_size * sizeof(char));
+	return copy;
+}
+
 
 size_t map_reserve(map *const as, const char *const key)
 {
-	return map_add_by_hash(as, map_get_hash(as, key), ITEM_MAX);
+	return map_add_by_span_hash(as, key, key != NULL ? strlen(key) : 0, ITEM_MAX);
+}
+
+size_t map_reserve_by_span(map *const as, const char *const key, const size_t size)
+{
+	return map_add_by_span_hash(as, key, size, ITEM_MAX);
 }
 
 size_t map_reserve_by_utf8(map *const as, const char32_t *const key)
@@ -312,7 +486,12 @@ size_t map_reserve_by_io(map *const as, universal_io *const io, char32_t *const
 
 size_t map_add(map *const as, const char *const key, const item_t value)
 {
-	return map_add_by_hash(as, map_get_hash(as, key), value);
+	return map_add_by_span_hash(as, key, key != NULL ? strlen(key) : 0, value);
+}
+
+size_t map_add_by_span(map *const as, const char *const key, const size_t size, const item_t value)
+{
+	return map_add_by_span_hash(as, key, size, value);
 }
 
 size_t map_add_by_utf8(map *const as, const char32_t *const key, const item_t value)
@@ -328,7 +507,19 @@ size_t map_add_by_io(map *const as, universal_io *const io, const item_t value,
 
 size_t map_set(map *const as, const char *const key, const item_t value)
 {
-	return map_set_by_hash(as, map_get_hash(as, key), value);
+	return map_set_by_span(as, key, key != NULL ? strlen(key) : 0, value);
+}
+
+size_t map_set_by_span(map *const as, const char *const key, const size_t size, const item_t value)
+{
+	const size_t index = map_get_index_by_span_hash(as, key, size);
+	if (index == SIZE_MAX)
+	{
+		return SIZE_MAX;
+	}
+
+	as->values[index].value = value;
+	return index;
 }
 
 size_t map_set_by_utf8(map *const as, const char32_t *const key, const item_t value)
@@ -343,7 +534,7 @@ size_t map_set_by_io(map *const as, universal_io *const io, const item_t value,
 
 int map_set_by_index(map *const as, const size_t index, const item_t value)
 {
-	if (!map_is_correct(as) || index >= as->values_size || as->values[index].ref == SIZE_MAX)
+	if (!map_is_correct(as) || index >= as->values_size)
 	{
 		return -1;
 	}
@@ -355,7 +546,12 @@ int map_set_by_index(map *const as, const size_t index, const item_t value)
 
 size_t map_get_index(map *const as, const char *const key)
 {
-	return map_get_index_by_hash(as, map_get_hash(as, key));
+	return map_get_index_by_span_hash(as, key, key != NULL ? strlen(key) : 0);
+}
+
+size_t map_get_index_by_span(map *const as, const char *const key, const size_t size)
+{
+	return map_get_index_by_span_hash(as, key, size);
 }
 
 size_t map_get_index_by_utf8(map *const as, const char32_t *const key)
@@ -371,7 +567,13 @@ size_t map_get_index_by_io(map *const as, universal_io *const io, char32_t *cons
 
 item_t map_get(map *const as, const char *const key)
 {
-	return map_get_by_hash(as, map_get_hash(as, key));
+	return map_get_by_span(as, key, key != NULL ? strlen(key) : 0);
+}
+
+item_t map_get_by_span(map *const as, const char *const key, const size_t size)
+{
+	const size_t index = map_get_index_by_span_hash(as, key, size);
+	return index != SIZE_MAX ? as->values[index].value : ITEM_MAX;
 }
 
 item_t map_get_by_utf8(map *const as, const char32_t *const key)
@@ -386,7 +588,7 @@ item_t map_get_by_io(map *const as, universal_io *const io, char32_t *const last
 
 item_t map_get_by_index(const map *const as, const size_t index)
 {
-	return map_is_correct(as) && index < as->values_size && as->values[index].ref != SIZE_MAX
+	return map_is_correct(as) && index < as->values_size
 		? as->values[index].value
 		: ITEM_MAX;
 }
@@ -394,7 +596,7 @@ item_t map_get_by_index(const map *const as, const size_t index)
 
 const char *map_to_string(const map *const as, const size_t index)
 {
-	return map_is_correct(as) && index < as->values_size && as->values[index].ref != SIZE_MAX
+	return map_is_correct(as) && index < as->values_size
 		? &as->keys[as->values[index].ref]
 		: NULL;
 }
@@ -406,7 +608,7 @@ const char *map_last_read(const map *const as)
 
 bool map_is_correct(const map *const as)
 {
-	return as != NULL && as->values != NULL && as->keys != NULL;
+	return as != NULL && as->values != NULL && as->keys != NULL && as->table != NULL;
 }
 
 
@@ -420,6 +622,9 @@ int map_clear(map *const as)
 	free(as->values);
 	as->values = NULL;
 
+	free(as->table);
+	as->table = NULL;
+
 	free(as->keys);
 	as->keys = NULL;
 
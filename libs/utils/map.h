@@ -25,6 +25,7 @@
 extern "C" {
 #endif
 
+/** Minimal size of hash table */
 static const size_t MAP_HASH_MAX = 256;
 static const size_t MAP_KEY_SIZE = 8;
 
@@ -43,6 +44,9 @@ typedef struct map
 	map_hash *values;			/**< Values storage */
 	size_t values_size;			/**< Size of values storage */
 	size_t values_alloc;		/**< Allocated size of values storage */
+
+	size_t *table;				/**< Open addressing table of values indexes */
+	size_t table_size;			/**< Size of table, power of two */
 } map;
 
 
@@ -55,6 +59,15 @@ typedef struct map
  */
 EXPORTED map map_create(const size_t alloc);
 
+/**
+ *	Create copy of map structure
+ *
+ *	@param	as				Map structure
+ *
+ *	@return	Map structure
+ */
+EXPORTED map map_copy(const map *const as);
+
 
 /**
  *	Reserve new key or return existing
@@ -87,6 +100,18 @@ EXPORTED size_t map_reserve_by_utf8(map *const as, const char32_t *const key);
  */
 EXPORTED size_t map_reserve_by_io(map *const as, universal_io *const io, char32_t *const last);
 
+/**
+ *	Reserve new key by octets span or return existing.
+ *	Key is copied to map only on insertion.
+ *
+ *	@param	as				Map structure
+ *	@param	key				UTF-8 octets of key, not null-terminated
+ *	@param	size			Number of octets in key
+ *
+ *	@return	Index of record, @c SIZE_MAX on failure
+ */
+EXPORTED size_t map_reserve_by_span(map *const as, const char *const key, const size_t size);
+
 
 /**
  *	Add new key-value pair
@@ -122,6 +147,19 @@ EXPORTED size_t map_add_by_utf8(map *const as, const char32_t *const key, const
  */
 EXPORTED size_t map_add_by_io(map *const as, universal_io *const io, const item_t value, char32_t *const last);
 
+/**
+ *	Add new pair by octets span of key.
+ *	Key is copied to map only on insertion.
+ *
+ *	@param	as				Map structure
+ *	@param	key				UTF-8 octets of key, not null-terminated
+ *	@param	size			Number of octets in key
+ *	@param	value			Value
+ *
+ *	@return	Index of record, @c SIZE_MAX on failure
+ */
+EXPORTED size_t map_add_by_span(map *const as, const char *const key, const size_t size, const item_t value);
+
 
 /**
  *	Set new value by existing key
@@ -157,6 +195,18 @@ EXPORTED size_t map_set_by_utf8(map *const as, const char32_t *const key, const
  */
 EXPORTED size_t map_set_by_io(map *const as, universal_io *const io, const item_t value, char32_t *const last);
 
+/**
+ *	Set new value by octets span of existing key
+ *
+ *	@param	as				Map structure
+ *	@param	key				UTF-8 octets of key, not null-terminated
+ *	@param	size			Number of octets in key
+ *	@param	value			New value
+ *
+ *	@return	Index of record, @c SIZE_MAX on failure
+ */
+EXPORTED size_t map_set_by_span(map *const as, const char *const key, const size_t size, const item_t value);
+
 /**
  *	Set new value by index
  *
@@ -200,6 +250,17 @@ EXPORTED size_t map_get_index_by_utf8(map *const as, const char32_t *const key);
  */
 EXPORTED size_t map_get_index_by_io(map *const as, universal_io *const io, char32_t *const last);
 
+/**
+ *	Get index of record by octets span of key
+ *
+ *	@param	as				Map structure
+ *	@param	key				UTF-8 octets of key, not null-terminated
+ *	@param	size			Number of octets in key
+ *
+ *	@return	Index of record, @c SIZE_MAX on failure
+ */
+EXPORTED size_t map_get_index_by_span(map *const as, const char *const key, const size_t size);
+
 
 /**
  *	Get value by key
@@ -232,6 +293,17 @@ EXPORTED item_t map_get_by_utf8(map *const as, const char32_t *const key);
  */
 EXPORTED item_t map_get_by_io(map *const as, universal_io *const io, char32_t *const last);
 
+/**
+ *	Get value by octets span of key
+ *
+ *	@param	as				Map structure
+ *	@param	key				UTF-8 octets of key, not null-terminated
+ *	@param	size			Number of octets in key
+ *
+ *	@return	Value, @c ITEM_MAX on failure
+ */
+EXPORTED item_t map_get_by_span(map *const as, const char *const key, const size_t size);
+
 /**
  *	Get value by index
  *
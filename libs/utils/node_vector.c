@@ -18,6 +18,7 @@
 
 
 extern node_vector node_vector_create(void);
+extern int node_vector_reserve(node_vector *const vec, const size_t size);
 extern size_t node_vector_add(node_vector *const vec, const node *const nd);
 extern int node_vector_set(node_vector *const vec, const size_t index, const node *const nd);
 extern node node_vector_get(const node_vector *const vec, const size_t index);
@@ -28,5 +29,15 @@ extern int node_vector_clear(node_vector *const vec);
 
 node_vector node_vector_create(void)
 {
-    return (node_vector){ .tree = NULL, .nodes = vector_create(NODE_VECTOR_SIZE) };
+	return node_vector_create_with_capacity(NODE_VECTOR_SIZE);
+}
+
+node_vector node_vector_create_with_capacity(const size_t alloc)
+{
+	return (node_vector){ .tree = NULL, .nodes = vector_create(alloc) };
+}
+
+node_vector node_vector_create_by_arena(arena *const memory)
+{
+	return (node_vector){ .tree = NULL, .nodes = vector_create_by_arena(memory, NODE_VECTOR_SIZE) };
 }
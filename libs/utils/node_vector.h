@@ -41,6 +41,24 @@ typedef struct node_vector
  */
 EXPORTED node_vector node_vector_create(void);
 
+/**
+ *	Create empty node vector with space for several nodes
+ *
+ *	@param	alloc			Number of nodes to hold without reallocation
+ *
+ *	@return	Node vector
+ */
+EXPORTED node_vector node_vector_create_with_capacity(const size_t alloc);
+
+/**
+ *	Create empty node vector in arena
+ *
+ *	@param	memory			Arena
+ *
+ *	@return	Node vector
+ */
+EXPORTED node_vector node_vector_create_by_arena(arena *const memory);
+
 /**
  *	Add new node
  *
@@ -57,6 +75,19 @@ inline size_t node_vector_add(node_vector *const vec, const node *const nd)
 		: SIZE_MAX;
 }
 
+/**
+ *	Reserve memory for nodes
+ *
+ *	@param	vec				Node vector
+ *	@param	size			Number of nodes to hold without reallocation
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+inline int node_vector_reserve(node_vector *const vec, const size_t size)
+{
+	return vector_reserve(&vec->nodes, size);
+}
+
 /**
  *	Set new node
  *
@@ -0,0 +1,451 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "scheduler.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include "logger.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
+
+#define MAX_WORKERS			64
+#define DEQUE_INIT_SIZE		16
+
+
+#ifdef _WIN32
+	typedef SRWLOCK lock_t;
+	typedef CONDITION_VARIABLE cond_t;
+
+	#define LOCK_INIT								SRWLOCK_INIT
+	#define COND_INIT								CONDITION_VARIABLE_INIT
+
+	#define lock_init(lock)							InitializeSRWLock(lock)
+	#define lock_acquire(lock)						AcquireSRWLockExclusive(lock)
+	#define lock_release(lock)						ReleaseSRWLockExclusive(lock)
+	#define cond_wait(cond, lock)					SleepConditionVariableSRW(cond, lock, INFINITE, 0)
+	#define cond_signal(cond)						WakeConditionVariable(cond)
+	#define cond_broadcast(cond)					WakeAllConditionVariable(cond)
+#else
+	typedef pthread_mutex_t lock_t;
+	typedef pthread_cond_t cond_t;
+
+	#define LOCK_INIT								PTHREAD_MUTEX_INITIALIZER
+	#define COND_INIT								PTHREAD_COND_INITIALIZER
+
+	#define lock_init(lock)							pthread_mutex_init(lock, NULL)
+	#define lock_acquire(lock)						pthread_mutex_lock(lock)
+	#define lock_release(lock)						pthread_mutex_unlock(lock)
+	#define cond_wait(cond, lock)					pthread_cond_wait(cond, lock)
+	#define cond_signal(cond)						pthread_cond_signal(cond)
+	#define cond_broadcast(cond)					pthread_cond_broadcast(cond)
+#endif
+
+
+struct task_group
+{
+	size_t pending;					/**< Number of spawned and not finished tasks */
+};
+
+/** Spawned task */
+typedef struct task
+{
+	task_func func;					/**< Task function */
+	void *context;					/**< Task context */
+	task_group *group;				/**< Group of task */
+	logger error_log;				/**< Error logger of spawning thread */
+	logger warning_log;				/**< Warning logger of spawning thread */
+} task;
+
+/** Double-ended queue of tasks, owner takes from bottom, thieves take from top */
+typedef struct deque
+{
+	task *tasks;					/**< Ring buffer of tasks */
+	size_t alloc;					/**< Allocated size of buffer */
+	size_t top;						/**< Index of top task */
+	size_t size;					/**< Number of tasks */
+
+	lock_t lock;					/**< Lock of deque */
+} deque;
+
+/** Task with index of @c scheduler_for */
+typedef struct indexed
+{
+	task_index_func func;			/**< Function of task with index */
+	void *context;					/**< Context of tasks */
+	size_t index;					/**< Index of task */
+} indexed;
+
+
+static lock_t state_lock = LOCK_INIT;
+static cond_t state_wake = COND_INIT;
+
+static size_t jobs;
+static bool is_started;
+static size_t workers_num;
+static size_t queued;
+
+// Последняя очередь принимает задачи потоков, не являющихся рабочими
+static deque deques[MAX_WORKERS + 1];
+
+static _Thread_local deque *current_deque = NULL;
+
+
+static size_t cores_num(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+	const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (size_t)cores : 1;
+#endif
+}
+
+
+static int deque_push(deque *const dq, const task tk)
+{
+	lock_acquire(&dq->lock);
+
+	if (dq->size == dq->alloc)
+	{
+		const size_t alloc = dq->alloc != 0 ? 2 * dq->alloc : DEQUE_INIT_SIZE;
+		task *const tasks = malloc(alloc * sizeof(task));
+		if (tasks == NULL)
+		{
+			lock_release(&dq->lock);
+			return -1;
+		}
+
+		for (size_t i = 0; i < dq->size; i++)
+		{
+			tasks[i] = dq->tasks[(dq->top + i) % dq->alloc];
+		}
+
+		free(dq->tasks);
+		dq->tasks = tasks;
+		dq->alloc = alloc;
+		dq->top = 0;
+	}
+
+	dq->tasks[(dq->top + dq->size) % dq->alloc] = tk;
+	dq->size++;
+
+	lock_release(&dq->lock);
+	return 0;
+}
+
+static bool deque_pop(deque *const dq, task *const tk, const bool is_bottom)
+{
+	lock_acquire(&dq->lock);
+
+	const bool is_found = dq->size != 0;
+	if (is_found && is_bottom)
+	{
+		dq->size--;
+		*tk = dq->tasks[(dq->top + dq->size) % dq->alloc];
+	}
+	else if (is_found)
+	{
+		*tk = dq->tasks[dq->top];
+		dq->top = (dq->top + 1) % dq->alloc;
+		dq->size--;
+	}
+
+	lock_release(&dq->lock);
+	return is_found;
+}
+
+
+/** Take task from own deque, otherwise steal it from other deques */
+static bool task_take(task *const tk)
+{
+	deque *const own = current_deque != NULL ? current_deque : &deques[MAX_WORKERS];
+	bool is_found = deque_pop(own, tk, true);
+
+	const size_t first = own != &deques[MAX_WORKERS] ? (size_t)(own - deques) : 0;
+	for (size_t i = 0; !is_found && i <= workers_num; i++)
+	{
+		// Очередь внешних потоков проверяется последней
+		deque *const victim = i < workers_num ? &deques[(first + i + 1) % workers_num] : &deques[MAX_WORKERS];
+		is_found = victim != own && deque_pop(victim, tk, false);
+	}
+
+	if (is_found)
+	{
+		lock_acquire(&state_lock);
+		queued--;
+		lock_release(&state_lock);
+	}
+
+	return is_found;
+}
+
+static void task_run(const task *const tk)
+{
+	const logger error_log = set_thread_error_log(tk->error_log);
+	const logger warning_log = set_thread_warning_log(tk->warning_log);
+	tk->func(tk->context);
+	set_thread_error_log(error_log);
+	set_thread_warning_log(warning_log);
+
+	lock_acquire(&state_lock);
+	if (--tk->group->pending == 0)
+	{
+		cond_broadcast(&state_wake);
+	}
+	lock_release(&state_lock);
+}
+
+
+#ifdef _WIN32
+static DWORD WINAPI worker_run(void *arg)
+#else
+static void *worker_run(void *arg)
+#endif
+{
+	current_deque = arg;
+
+	while (true)
+	{
+		// Рабочий ждёт под общей блокировкой, поэтому видит число рабочих после окончания запуска
+		lock_acquire(&state_lock);
+		while (queued == 0)
+		{
+			cond_wait(&state_wake, &state_lock);
+		}
+		lock_release(&state_lock);
+
+		task tk;
+		while (task_take(&tk))
+		{
+			task_run(&tk);
+		}
+	}
+
+	return 0;
+}
+
+/** Start workers once, returns @c false if tasks are run by spawning thread */
+static bool scheduler_start(void)
+{
+	lock_acquire(&state_lock);
+
+	if (!is_started)
+	{
+		is_started = true;
+		jobs = jobs != 0 ? jobs : cores_num();
+
+		for (size_t i = 0; i <= MAX_WORKERS; i++)
+		{
+			lock_init(&deques[i].lock);
+		}
+
+		const size_t num = jobs - 1 < MAX_WORKERS ? jobs - 1 : MAX_WORKERS;
+		while (workers_num < num)
+		{
+#ifdef _WIN32
+			HANDLE thread = CreateThread(NULL, 0, &worker_run, &deques[workers_num], 0, NULL);
+			if (thread == NULL)
+			{
+				break;
+			}
+			CloseHandle(thread);
+#else
+			pthread_t thread;
+			if (pthread_create(&thread, NULL, &worker_run, &deques[workers_num]))
+			{
+				break;
+			}
+			pthread_detach(thread);
+#endif
+			workers_num++;
+		}
+	}
+
+	const bool is_parallel = workers_num != 0;
+	lock_release(&state_lock);
+	return is_parallel;
+}
+
+
+static void indexed_run(void *const context)
+{
+	const indexed *const item = context;
+	item->func(item->context, item->index);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int scheduler_set_jobs(const size_t num)
+{
+	if (num == 0)
+	{
+		return 0;
+	}
+
+	lock_acquire(&state_lock);
+
+	// Рабочие уже запущены, поэтому первый заданный бюджет действует до конца процесса
+	const int ret = is_started && jobs != num ? -1 : 0;
+	if (!is_started)
+	{
+		jobs = num;
+	}
+
+	lock_release(&state_lock);
+	return ret;
+}
+
+size_t scheduler_get_jobs(void)
+{
+	lock_acquire(&state_lock);
+	const size_t num = jobs != 0 ? jobs : cores_num();
+	lock_release(&state_lock);
+	return num;
+}
+
+
+task_group *group_create(void)
+{
+	task_group *const group = malloc(sizeof(task_group));
+	if (group != NULL)
+	{
+		group->pending = 0;
+	}
+
+	return group;
+}
+
+void group_spawn(task_group *const group, const task_func func, void *const context)
+{
+	if (func == NULL)
+	{
+		return;
+	}
+
+	if (group == NULL || !scheduler_start())
+	{
+		func(context);
+		return;
+	}
+
+	// Журналы запоминаются без изменения, чтобы сообщения задачи шли туда же, куда и у порождающего потока
+	const logger error_log = set_thread_error_log(NULL);
+	const logger warning_log = set_thread_warning_log(NULL);
+	set_thread_error_log(error_log);
+	set_thread_warning_log(warning_log);
+
+	const task tk = { .func = func, .context = context, .group = group
+		, .error_log = error_log, .warning_log = warning_log };
+
+	lock_acquire(&state_lock);
+	group->pending++;
+	lock_release(&state_lock);
+
+	if (deque_push(current_deque != NULL ? current_deque : &deques[MAX_WORKERS], tk))
+	{
+		task_run(&tk);
+		return;
+	}
+
+	lock_acquire(&state_lock);
+	queued++;
+	cond_signal(&state_wake);
+	lock_release(&state_lock);
+}
+
+void group_join(task_group *const group)
+{
+	if (group == NULL)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		lock_acquire(&state_lock);
+		const bool is_done = group->pending == 0;
+		lock_release(&state_lock);
+
+		if (is_done)
+		{
+			break;
+		}
+
+		// Ожидающий поток выполняет задачи сам, поэтому вложенные группы не требуют новых потоков
+		task tk;
+		if (task_take(&tk))
+		{
+			task_run(&tk);
+			continue;
+		}
+
+		lock_acquire(&state_lock);
+		while (group->pending != 0 && queued == 0)
+		{
+			cond_wait(&state_wake, &state_lock);
+		}
+		lock_release(&state_lock);
+	}
+
+	free(group);
+}
+
+
+void scheduler_for(const task_index_func func, void *const context, const size_t num)
+{
+	if (func == NULL || num == 0)
+	{
+		return;
+	}
+
+	indexed *const items = num > 1 ? malloc(num * sizeof(indexed)) : NULL;
+	task_group *const group = items != NULL ? group_create() : NULL;
+	if (group == NULL)
+	{
+		free(items);
+		for (size_t i = 0; i < num; i++)
+		{
+			func(context, i);
+		}
+		return;
+	}
+
+	// Задачи кладутся в обратном порядке, чтобы свой поток начал с первой
+	for (size_t i = num; i > 0; i--)
+	{
+		items[i - 1] = (indexed){ .func = func, .context = context, .index = i - 1 };
+		group_spawn(group, &indexed_run, &items[i - 1]);
+	}
+
+	group_join(group);
+	free(items);
+}
@@ -0,0 +1,93 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "dll.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Task function */
+typedef void (*task_func)(void *const context);
+
+/** Function of task with index */
+typedef void (*task_index_func)(void *const context, const size_t index);
+
+/** Group of tasks, which are joined together */
+typedef struct task_group task_group;
+
+
+/**
+ *	Set number of jobs of shared scheduler, calling thread is counted as one of them.
+ *	Budget is shared by all tasks of process, so nested tasks do not add threads.
+ *	Number of online processors is used by default.
+ *
+ *	@param	num			Number of jobs, @c 0 keeps current budget
+ *
+ *	@return	@c 0 on success, @c -1 if workers are already started with another budget
+ */
+EXPORTED int scheduler_set_jobs(const size_t num);
+
+/**
+ *	Get number of jobs of shared scheduler
+ *
+ *	@return	Number of jobs
+ */
+EXPORTED size_t scheduler_get_jobs(void);
+
+
+/**
+ *	Create task group
+ *
+ *	@return	Task group, @c NULL on failure, then tasks are run by spawning thread
+ */
+EXPORTED task_group *group_create(void);
+
+/**
+ *	Spawn task in group. Task is pushed to deque of current worker, other workers steal it,
+ *	if they are idle. Task is run with thread loggers of spawning thread.
+ *
+ *	@param	group		Task group
+ *	@param	func		Task function
+ *	@param	context		Task context
+ */
+EXPORTED void group_spawn(task_group *const group, const task_func func, void *const context);
+
+/**
+ *	Wait for all tasks of group and free it. Waiting thread runs tasks meanwhile.
+ *
+ *	@param	group		Task group
+ */
+EXPORTED void group_join(task_group *const group);
+
+
+/**
+ *	Run function for each index in parallel and wait for all of them.
+ *	Results written by index do not depend on order of execution.
+ *
+ *	@param	func		Function of task with index
+ *	@param	context		Context of tasks
+ *	@param	num			Number of indexes
+ */
+EXPORTED void scheduler_for(const task_index_func func, void *const context, const size_t num);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -0,0 +1,84 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "source.h"
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+source source_create(const universal_io *const io)
+{
+	source src;
+	src.code = in_get_buffer(io);
+	src.size = in_get_size(io);
+	if (in_get_path(io, src.path) == 0)
+	{
+		src.path[0] = '\0';
+	}
+
+	// Индекс строится сразу, чтобы дальше исходный текст только читался
+	src.index = cmt_index_create_by_map(src.code, in_get_locations(io));
+	return src;
+}
+
+int source_open(const source *const src, universal_io *const io, const size_t position)
+{
+	if (!source_is_correct(src) || in_set_range(io, src->code, src->size))
+	{
+		return -1;
+	}
+
+	return in_set_position(io, position);
+}
+
+comment source_search(const source *const src, const size_t position)
+{
+	return cmt_index_search(source_get_index(src), position);
+}
+
+const comment_index *source_get_index(const source *const src)
+{
+	return src != NULL ? &src->index : NULL;
+}
+
+const char *source_get_path(const source *const src)
+{
+	return src != NULL ? src->path : NULL;
+}
+
+bool source_is_correct(const source *const src)
+{
+	return src != NULL && src->code != NULL;
+}
+
+int source_clear(source *const src)
+{
+	if (src == NULL)
+	{
+		return -1;
+	}
+
+	src->code = NULL;
+	src->size = 0;
+	return cmt_index_clear(&src->index);
+}
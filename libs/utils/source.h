@@ -0,0 +1,113 @@
+/*
+ *	Copyright 2022 Andrey Terekhov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "commenter.h"
+#include "dll.h"
+#include "uniio.h"
+#include "workspace.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Immutable source text with index of lines and line markers.
+ *	Source is not changed after creation, so many readers may use it at once,
+ *	each through its own input with independent position.
+ */
+typedef struct source
+{
+	const char *code;				/**< Source text */
+	size_t size;					/**< Size of source text */
+	char path[MAX_ARG_SIZE];		/**< Path of input, empty if text has no file */
+	comment_index index;			/**< Index of line ends and line markers */
+} source;
+
+
+/**
+ *	Create source from input buffer and its line markers, they must not be changed while source is used
+ *
+ *	@param	io			Universal io with input buffer
+ *
+ *	@return	Source
+ */
+EXPORTED source source_create(const universal_io *const io);
+
+/**
+ *	Open source for reading by new reader
+ *
+ *	@param	src			Source
+ *	@param	io			Universal io of reader
+ *	@param	position	Initial position of reader
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int source_open(const source *const src, universal_io *const io, const size_t position);
+
+/**
+ *	Find location of position in source
+ *
+ *	@param	src			Source
+ *	@param	position	Position in source text
+ *
+ *	@return	Comment with file, line and code line of position
+ */
+EXPORTED comment source_search(const source *const src, const size_t position);
+
+/**
+ *	Get index of source
+ *
+ *	@param	src			Source
+ *
+ *	@return	Index of line ends and line markers
+ */
+EXPORTED const comment_index *source_get_index(const source *const src);
+
+/**
+ *	Get path of source input
+ *
+ *	@param	src			Source
+ *
+ *	@return	Path, empty if text has no file
+ */
+EXPORTED const char *source_get_path(const source *const src);
+
+/**
+ *	Check that source is correct
+ *
+ *	@param	src			Source
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED bool source_is_correct(const source *const src);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	src			Source
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int source_clear(source *const src);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
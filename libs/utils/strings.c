@@ -1,227 +1,410 @@
-/*
- *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev, Dmitrii Davladov
- *
- *	Licensed under the Apache License, Version 2.0 (the "License");
- *	you may not use this file except in compliance with the License.
- *	You may obtain a copy of the License at
- *
- *		http://www.apache.org/licenses/LICENSE-2.0
- *
- *	Unless required by applicable law or agreed to in writing, software
- *	distributed under the License is distributed on an "AS IS" BASIS,
- *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
- *	See the License for the specific language governing permissions and
- *	limitations under the License.
- */
-
-#include "strings.h"
-#include <stdlib.h>
-
-
-static const size_t AVERAGE_STRING_SIZE = 256;
-
-
-static inline int strings_add_index(strings *const vec)
-{
-	if (vec->indexes_size == vec->indexes_alloc)
-	{
-		size_t *indexes_new = realloc(vec->indexes, 2 * vec->indexes_alloc * sizeof(size_t));
-		if (indexes_new == NULL)
-		{
-			return -1;
-		}
-
-		vec->indexes_alloc *= 2;
-		vec->indexes = indexes_new;
-	}
-
-	vec->indexes[vec->indexes_size] = vec->all_strings_size;
-	return 0;
-}
-
-static inline int strings_increase(strings *const vec, const size_t size)
-{
-	if (vec->all_strings_size + size <= vec->all_strings_alloc)
-	{
-		return 0;
-	}
-
-	char *all_strings_new = realloc(vec->all_strings, 2 * vec->all_strings_alloc * sizeof(char));
-	if (all_strings_new == NULL)
-	{
-		return -1;
-	}
-
-	vec->all_strings_alloc *= 2;
-	vec->all_strings = all_strings_new;
-	return strings_increase(vec, size);
-}
-
-
-/*
- *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
- *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
- *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
- *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
- *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
- */
-
-
-strings strings_create(const size_t alloc)
-{
-	strings vec;
-
-	vec.indexes_size = 0;
-	vec.indexes_alloc = alloc != 0 ? alloc : 1;
-
-	vec.indexes = malloc(vec.indexes_alloc * sizeof(size_t));	
-	if (vec.indexes == NULL)
-	{
-		return vec;
-	}
-
-	vec.all_strings_size = 0;
-	vec.all_strings_alloc = vec.indexes_alloc * AVERAGE_STRING_SIZE;
-
-	vec.all_strings = malloc(vec.all_strings_alloc * sizeof(char));
-	if (vec.all_strings == NULL)
-	{
-		free(vec.indexes);
-		return vec;
-	}
-
-	return vec;
-}
-
-
-size_t strings_add(strings *const vec, const char *const str)
-{
-	if (!strings_is_correct(vec) || str == NULL || str[0] == '\0' || strings_add_index(vec))
-	{
-		return SIZE_MAX;
-	}
-
-	for (size_t i = 0; str[i] != '\0'; i++)
-	{
-		if (strings_increase(vec, 2))
-		{
-			return SIZE_MAX;
-		}
-
-		vec->all_strings[vec->all_strings_size++] = str[i];
-	}
-
-	vec->all_strings[vec->all_strings_size++] = '\0';
-	return vec->indexes_size++;
-}
-
-size_t strings_add_by_utf8(strings *const vec, const char32_t *const str)
-{
-	if (!strings_is_correct(vec) || str == NULL || str[0] == '\0' || strings_add_index(vec))
-	{
-		return SIZE_MAX;
-	}
-
-	for (size_t i = 0; str[i] != '\0'; i++)
-	{
-		if (strings_increase(vec, utf8_size(str[i]) + 1))
-		{
-			return SIZE_MAX;
-		}
-
-		vec->all_strings_size += utf8_to_string(&vec->all_strings[vec->all_strings_size], str[i]);
-	}
-
-	vec->all_strings_size++;
-	return vec->indexes_size++;
-}
-
-size_t strings_add_by_vector(strings *const vec, const vector *const str)
-{
-	if (!strings_is_correct(vec) || !vector_is_correct(str) || vector_get(str, 0) == '\0' || strings_add_index(vec))
-	{
-		return SIZE_MAX;
-	}
-
-	for (size_t i = 0; i < vector_size(str); i++)
-	{
-		const char32_t ch = (char32_t)vector_get(str, i);
-		if (ch == '\0')
-		{
-			break;
-		}
-
-		if (strings_increase(vec, utf8_size(ch) + 1))
-		{
-			return SIZE_MAX;
-		}
-
-		vec->all_strings_size += utf8_to_string(&vec->all_strings[vec->all_strings_size], ch);
-	}
-
-	vec->all_strings_size++;
-	return vec->indexes_size++;
-}
-
-
-const char *strings_get(const strings *const vec, const size_t index)
-{
-	if (!strings_is_correct(vec) || index >= vec->indexes_size)
-	{
-		return NULL;
-	}
-
-	return &vec->all_strings[vec->indexes[index]];
-}
-
-size_t strings_get_length(const strings *const vec, const size_t index)
-{
-	if (!strings_is_correct(vec) || index >= vec->indexes_size)
-	{
-		return 0;
-	}
-
-	return index == vec->indexes_size - 1
-		? vec->all_strings_size - vec->indexes[index] - 1
-		: vec->indexes[index + 1] - vec->indexes[index] - 1;
-}
-
-
-const char *strings_remove(strings *const vec)
-{
-	if (!strings_is_correct(vec) || vec->indexes_size == 0)
-	{
-		return NULL;
-	}
-
-	vec->all_strings_size = vec->indexes[--vec->indexes_size];
-	return &vec->all_strings[vec->all_strings_size];
-}
-
-
-size_t strings_size(const strings *const vec)
-{
-	return strings_is_correct(vec) ? vec->indexes_size : SIZE_MAX;
-}
-
-bool strings_is_correct(const strings *const vec)
-{
-	return vec != NULL && vec->indexes != NULL && vec->all_strings != NULL;
-}
-
-
-int strings_clear(strings *const vec)
-{
-	if (!strings_is_correct(vec))
-	{
-		return -1;
-	}
-
-	free(vec->indexes);
-	vec->indexes = NULL;
-
-	free(vec->all_strings);
-	vec->all_strings = NULL;
-
-	return 0;
-}
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev, Dmitrii Davladov
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "strings.h"
+#include <stdlib.h>
+#include <string.h>
+
+
+static const size_t AVERAGE_STRING_SIZE = 16;
+static const size_t MIN_TABLE_SIZE = 64;
+static const uint32_t EMPTY_SLOT = UINT32_MAX;
+
+
+/** Grow buffer to hold at least requested number of elements */
+static inline int strings_reserve(void **const buffer, uint32_t *const alloc, const size_t size, const size_t element)
+{
+	if (size <= *alloc)
+	{
+		return 0;
+	}
+
+	if (size > UINT32_MAX - 1)
+	{
+		return -1;
+	}
+
+	// Capacity is doubled within the limit of 32-bit offsets
+	size_t alloc_new = 2 * (size_t)*alloc > size ? 2 * (size_t)*alloc : size;
+	alloc_new = alloc_new < UINT32_MAX ? alloc_new : UINT32_MAX - 1;
+
+	void *const buffer_new = realloc(*buffer, alloc_new * element);
+	if (buffer_new == NULL)
+	{
+		return -1;
+	}
+
+	*alloc = (uint32_t)alloc_new;
+	*buffer = buffer_new;
+	return 0;
+}
+
+/** Reserve new span with space for string of known length and its null character */
+static char *strings_begin(strings *const vec, const size_t length)
+{
+	void *data = vec->data;
+	void *spans = vec->spans;
+	const int error = strings_reserve(&data, &vec->data_alloc, (size_t)vec->data_size + length + 1, sizeof(char))
+		|| strings_reserve(&spans, &vec->spans_alloc, 2 * ((size_t)vec->spans_size + 1), sizeof(uint32_t));
+	vec->data = data;
+	vec->spans = spans;
+	if (error)
+	{
+		return NULL;
+	}
+
+	vec->spans[2 * vec->spans_size] = vec->data_size;
+	vec->spans[2 * vec->spans_size + 1] = (uint32_t)length;
+	return &vec->data[vec->data_size];
+}
+
+/** Finish string reserved by strings_begin */
+static inline size_t strings_end(strings *const vec)
+{
+	const uint32_t length = vec->spans[2 * vec->spans_size + 1];
+	vec->data[vec->data_size + length] = '\0';
+	vec->data_size += length + 1;
+	return vec->spans_size++;
+}
+
+
+/** FNV-1a hash of string */
+static inline size_t strings_hash(const char *const str, const size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)str[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/** Return table slot of string equal to string with index, or empty slot */
+static size_t strings_find_slot(const strings *const vec, const size_t index)
+{
+	const char *const str = strings_get(vec, index);
+	const size_t length = strings_get_length(vec, index);
+	const size_t mask = vec->table_size - 1;
+
+	size_t slot = strings_hash(str, length) & mask;
+	while (vec->table[slot] != EMPTY_SLOT && (strings_get_length(vec, vec->table[slot]) != length
+		|| memcmp(strings_get(vec, vec->table[slot]), str, length) != 0))
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	return slot;
+}
+
+static int strings_grow_table(strings *const vec)
+{
+	uint32_t *const table_old = vec->table;
+	const size_t size_old = vec->table_size;
+
+	const size_t size = size_old != 0 ? 2 * size_old : MIN_TABLE_SIZE;
+	vec->table = malloc(size * sizeof(uint32_t));
+	if (vec->table == NULL)
+	{
+		vec->table = table_old;
+		return -1;
+	}
+
+	vec->table_size = (uint32_t)size;
+	for (size_t i = 0; i < size; i++)
+	{
+		vec->table[i] = EMPTY_SLOT;
+	}
+
+	for (size_t i = 0; i < size_old; i++)
+	{
+		if (table_old[i] != EMPTY_SLOT)
+		{
+			vec->table[strings_find_slot(vec, table_old[i])] = table_old[i];
+		}
+	}
+
+	free(table_old);
+	return 0;
+}
+
+/** Deduplicate just added last string */
+static size_t strings_intern_last(strings *const vec, const size_t index)
+{
+	if (index == SIZE_MAX)
+	{
+		return SIZE_MAX;
+	}
+
+	// Load factor is kept under 1/2
+	if (2 * ((size_t)vec->table_used + 1) > vec->table_size && strings_grow_table(vec))
+	{
+		strings_remove(vec);
+		return SIZE_MAX;
+	}
+
+	const size_t slot = strings_find_slot(vec, index);
+	if (vec->table[slot] != EMPTY_SLOT)
+	{
+		strings_remove(vec);
+		return vec->table[slot];
+	}
+
+	vec->table[slot] = (uint32_t)index;
+	vec->table_used++;
+	return index;
+}
+
+/** Remove string from table of interned strings */
+static void strings_unintern(strings *const vec, const size_t index)
+{
+	if (vec->table == NULL)
+	{
+		return;
+	}
+
+	const size_t mask = vec->table_size - 1;
+	size_t slot = strings_find_slot(vec, index);
+	if (vec->table[slot] != index)
+	{
+		return;
+	}
+
+	// Backward shift deletion keeps probe sequences without gaps
+	vec->table[slot] = EMPTY_SLOT;
+	vec->table_used--;
+	for (size_t next = (slot + 1) & mask; vec->table[next] != EMPTY_SLOT; next = (next + 1) & mask)
+	{
+		const size_t moved = vec->table[next];
+		const size_t home = strings_hash(strings_get(vec, moved), strings_get_length(vec, moved)) & mask;
+		if (((next - home) & mask) >= ((next - slot) & mask))
+		{
+			vec->table[slot] = vec->table[next];
+			vec->table[next] = EMPTY_SLOT;
+			slot = next;
+		}
+	}
+}
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+strings strings_create(const size_t alloc)
+{
+	strings vec;
+
+	vec.spans_size = 0;
+	vec.spans_alloc = alloc != 0 && alloc < UINT32_MAX / AVERAGE_STRING_SIZE ? (uint32_t)alloc : 1;
+
+	vec.table = NULL;
+	vec.table_size = 0;
+	vec.table_used = 0;
+
+	vec.spans = malloc(2 * (size_t)vec.spans_alloc * sizeof(uint32_t));
+	if (vec.spans == NULL)
+	{
+		return vec;
+	}
+
+	vec.data_size = 0;
+	vec.data_alloc = (uint32_t)(vec.spans_alloc * AVERAGE_STRING_SIZE);
+
+	vec.data = malloc(vec.data_alloc * sizeof(char));
+	if (vec.data == NULL)
+	{
+		free(vec.spans);
+		vec.spans = NULL;
+		return vec;
+	}
+
+	// Offsets and lengths are stored in pairs
+	vec.spans_alloc *= 2;
+	return vec;
+}
+
+
+size_t strings_add(strings *const vec, const char *const str)
+{
+	if (!strings_is_correct(vec) || str == NULL || str[0] == '\0')
+	{
+		return SIZE_MAX;
+	}
+
+	return strings_add_by_range(vec, str, strlen(str));
+}
+
+size_t strings_add_by_utf8(strings *const vec, const char32_t *const str)
+{
+	if (!strings_is_correct(vec) || str == NULL || str[0] == '\0')
+	{
+		return SIZE_MAX;
+	}
+
+	size_t length = 0;
+	for (size_t i = 0; str[i] != '\0'; i++)
+	{
+		length += utf8_size(str[i]);
+	}
+
+	char *buffer = strings_begin(vec, length);
+	if (buffer == NULL)
+	{
+		return SIZE_MAX;
+	}
+
+	for (size_t i = 0; str[i] != '\0'; i++)
+	{
+		buffer += utf8_to_string(buffer, str[i]);
+	}
+
+	return strings_end(vec);
+}
+
+size_t strings_add_by_vector(strings *const vec, const vector *const str)
+{
+	if (!strings_is_correct(vec) || !vector_is_correct(str) || vector_get(str, 0) == '\0')
+	{
+		return SIZE_MAX;
+	}
+
+	size_t length = 0;
+	size_t size = 0;
+	for (; size < vector_size(str) && vector_get(str, size) != '\0'; size++)
+	{
+		length += utf8_size((char32_t)vector_get(str, size));
+	}
+
+	char *buffer = strings_begin(vec, length);
+	if (buffer == NULL)
+	{
+		return SIZE_MAX;
+	}
+
+	for (size_t i = 0; i < size; i++)
+	{
+		buffer += utf8_to_string(buffer, (char32_t)vector_get(str, i));
+	}
+
+	return strings_end(vec);
+}
+
+size_t strings_add_by_range(strings *const vec, const char *const str, const size_t size)
+{
+	if (!strings_is_correct(vec) || (str == NULL && size != 0))
+	{
+		return SIZE_MAX;
+	}
+
+	char *const buffer = strings_begin(vec, size);
+	if (buffer == NULL)
+	{
+		return SIZE_MAX;
+	}
+
+	if (size != 0)
+	{
+		memcpy(buffer, str, size);
+	}
+
+	return strings_end(vec);
+}
+
+size_t strings_intern(strings *const vec, const char *const str)
+{
+	return strings_intern_last(vec, strings_add(vec, str));
+}
+
+size_t strings_intern_by_vector(strings *const vec, const vector *const str)
+{
+	return strings_intern_last(vec, strings_add_by_vector(vec, str));
+}
+
+size_t strings_intern_by_range(strings *const vec, const char *const str, const size_t size)
+{
+	return strings_intern_last(vec, strings_add_by_range(vec, str, size));
+}
+
+
+const char *strings_get(const strings *const vec, const size_t index)
+{
+	if (!strings_is_correct(vec) || index >= vec->spans_size)
+	{
+		return NULL;
+	}
+
+	return &vec->data[vec->spans[2 * index]];
+}
+
+size_t strings_get_length(const strings *const vec, const size_t index)
+{
+	if (!strings_is_correct(vec) || index >= vec->spans_size)
+	{
+		return 0;
+	}
+
+	return vec->spans[2 * index + 1];
+}
+
+
+const char *strings_remove(strings *const vec)
+{
+	if (!strings_is_correct(vec) || vec->spans_size == 0)
+	{
+		return NULL;
+	}
+
+	strings_unintern(vec, vec->spans_size - 1);
+	vec->data_size = vec->spans[2 * --vec->spans_size];
+	return &vec->data[vec->data_size];
+}
+
+
+size_t strings_size(const strings *const vec)
+{
+	return strings_is_correct(vec) ? vec->spans_size : SIZE_MAX;
+}
+
+bool strings_is_correct(const strings *const vec)
+{
+	return vec != NULL && vec->spans != NULL && vec->data != NULL;
+}
+
+
+int strings_clear(strings *const vec)
+{
+	if (!strings_is_correct(vec))
+	{
+		return -1;
+	}
+
+	free(vec->spans);
+	vec->spans = NULL;
+
+	free(vec->data);
+	vec->data = NULL;
+
+	free(vec->table);
+	vec->table = NULL;
+
+	return 0;
+}
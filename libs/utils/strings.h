@@ -28,13 +28,17 @@ extern "C" {
 /** Strings vector */
 typedef struct strings
 {
-	char *all_strings;				/**< Strings storage */
-	size_t all_strings_size;		/**< Size of strings storage */
-	size_t all_strings_alloc;		/**< Allocated size of strings storage */
+	char *data;						/**< Contiguous storage of null-terminated strings */
+	uint32_t data_size;				/**< Size of strings storage */
+	uint32_t data_alloc;			/**< Allocated size of strings storage */
 
-	size_t *indexes;				/**< Indexes array */
-	size_t indexes_size;			/**< Size of indexes array */
-	size_t indexes_alloc;			/**< Allocated size of indexes array */
+	uint32_t *spans;				/**< Offset and length of each string */
+	uint32_t spans_size;			/**< Number of strings */
+	uint32_t spans_alloc;			/**< Allocated size of spans array */
+
+	uint32_t *table;				/**< Open addressing table of interned strings indexes */
+	uint32_t table_size;			/**< Size of table, power of two */
+	uint32_t table_used;			/**< Number of interned strings */
 } strings;
 
 
@@ -78,6 +82,48 @@ EXPORTED size_t strings_add_by_utf8(strings *const vec, const char32_t *const st
  */
 EXPORTED size_t strings_add_by_vector(strings *const vec, const vector *const str);
 
+/**
+ *	Add new string from range of characters, range should not contain null characters
+ *
+ *	@param	vec				Strings vector
+ *	@param	str				Beginning of range
+ *	@param	size			Size of range
+ *
+ *	@return	Index, @c SIZE_MAX on failure
+ */
+EXPORTED size_t strings_add_by_range(strings *const vec, const char *const str, const size_t size);
+
+/**
+ *	Intern string, equal interned strings share the same index
+ *
+ *	@param	vec				Strings vector
+ *	@param	str				String
+ *
+ *	@return	Index of new or equal interned string, @c SIZE_MAX on failure
+ */
+EXPORTED size_t strings_intern(strings *const vec, const char *const str);
+
+/**
+ *	Intern dynamic UTF-8 string, equal interned strings share the same index
+ *
+ *	@param	vec				Strings vector
+ *	@param	str				Dynamic UTF-8 string
+ *
+ *	@return	Index of new or equal interned string, @c SIZE_MAX on failure
+ */
+EXPORTED size_t strings_intern_by_vector(strings *const vec, const vector *const str);
+
+/**
+ *	Intern string from range of characters, equal interned strings share the same index
+ *
+ *	@param	vec				Strings vector
+ *	@param	str				Beginning of range
+ *	@param	size			Size of range
+ *
+ *	@return	Index of new or equal interned string, @c SIZE_MAX on failure
+ */
+EXPORTED size_t strings_intern_by_range(strings *const vec, const char *const str, const size_t size);
+
 
 /**
  *	Get string
@@ -15,6 +15,17 @@
  */
 
 #include "tree.h"
+#include "counters.h"
+
+
+extern bool node_is_correct(const node *const nd);
+extern item_t node_get_type(const node *const nd);
+extern size_t node_get_argc(const node *const nd);
+extern item_t node_get_arg(const node *const nd, const size_t index);
+extern size_t node_get_amount(const node *const nd);
+extern bool node_iterator_is_correct(const node_iterator *const it);
+extern node node_iterator_get(const node_iterator *const it);
+extern size_t node_iterator_get_depth(const node_iterator *const it);
 
 
 static inline bool is_negative(const item_t value)
@@ -35,12 +46,17 @@ static inline size_t from_negative(const item_t value)
 
 static inline void vector_swap(vector *const vec, size_t fst, size_t snd)
 {
-	const item_t temp = vector_get(vec, fst);
-	vector_set(vec, fst, vector_get(vec, snd));
-	vector_set(vec, snd, temp);
+	const item_t temp = vector_at(vec, fst);
+	vector_put(vec, fst, vector_at(vec, snd));
+	vector_put(vec, snd, temp);
 }
 
 
+static inline size_t ref_get_parent(const node *const nd)
+{
+	return nd->index - 3;
+}
+
 static inline size_t ref_get_next(const node *const nd)
 {
 	return nd->index - 2;
@@ -62,24 +78,29 @@ static inline size_t ref_get_argc(const node *const nd)
 }
 
 
-static inline int ref_set_next(const node *const nd, const item_t value)
+static inline void ref_set_parent(const node *const nd, const item_t value)
+{
+	vector_put(nd->tree, ref_get_parent(nd), value);
+}
+
+static inline void ref_set_next(const node *const nd, const item_t value)
 {
-	return vector_set(nd->tree, ref_get_next(nd), value);
+	vector_put(nd->tree, ref_get_next(nd), value);
 }
 
-static inline int ref_set_amount(const node *const nd, const item_t value)
+static inline void ref_set_amount(const node *const nd, const item_t value)
 {
-	return vector_set(nd->tree, ref_get_amount(nd), value);
+	vector_put(nd->tree, ref_get_amount(nd), value);
 }
 
-static inline int ref_set_children(const node *const nd, const item_t value)
+static inline void ref_set_children(const node *const nd, const item_t value)
 {
-	return vector_set(nd->tree, ref_get_children(nd), value);
+	vector_put(nd->tree, ref_get_children(nd), value);
 }
 
-static inline int ref_set_argc(const node *const nd, const item_t value)
+static inline void ref_set_argc(const node *const nd, const item_t value)
 {
-	return vector_set(nd->tree, ref_get_argc(nd), value);
+	vector_put(nd->tree, ref_get_argc(nd), value);
 }
 
 
@@ -90,6 +111,70 @@ static inline node node_broken()
 }
 
 
+static inline size_t node_get_first_index(const node *const nd)
+{
+	const item_t children = vector_at(nd->tree, ref_get_children(nd));
+	return is_negative(children) ? (size_t)vector_at(nd->tree, from_negative(children)) : (size_t)children;
+}
+
+static inline size_t node_get_following_index(const node *const nd)
+{
+	item_t index = vector_at(nd->tree, ref_get_next(nd));
+	while (is_negative(index))
+	{
+		// Get next reference from parent
+		index = vector_at(nd->tree, from_negative(index) - 2);
+	}
+
+	return (size_t)index;
+}
+
+static inline void node_adopt_children(const node *const nd)
+{
+	const size_t amount = node_get_amount(nd);
+	size_t index = node_get_first_index(nd);
+	for (size_t i = 0; i < amount; i++)
+	{
+		vector_put(nd->tree, index - 3, (item_t)nd->index);
+		index = (size_t)vector_at(nd->tree, index - 2);
+	}
+}
+
+static int node_freeze_children(const node *const nd)
+{
+	const size_t amount = node_get_amount(nd);
+	if (amount < 2 || is_negative(vector_at(nd->tree, ref_get_children(nd))))
+	{
+		return 0;
+	}
+
+	const size_t offset = vector_size(nd->tree);
+	if (vector_reserve(nd->tree, offset + amount))
+	{
+		return -1;
+	}
+
+	size_t index = (size_t)vector_at(nd->tree, ref_get_children(nd));
+	for (size_t i = 0; i < amount; i++)
+	{
+		vector_add(nd->tree, (item_t)index);
+		index = (size_t)vector_at(nd->tree, index - 2);
+	}
+
+	ref_set_children(nd, to_negative(offset));
+	return 0;
+}
+
+static inline void node_thaw(const node *const nd)
+{
+	const item_t children = vector_at(nd->tree, ref_get_children(nd));
+	if (is_negative(children))
+	{
+		ref_set_children(nd, vector_at(nd->tree, from_negative(children)));
+	}
+}
+
+
 static node node_search_parent(const node *const nd, size_t *const number)
 {
 	if (!node_is_correct(nd) || nd->index == 0)
@@ -98,10 +183,10 @@ static node node_search_parent(const node *const nd, size_t *const number)
 	}
 
 	size_t child_number = 1;
-	item_t index = vector_get(nd->tree, ref_get_next(nd));
+	item_t index = vector_at(nd->tree, ref_get_next(nd));
 	while (!is_negative(index) && index != 0)
 	{
-		index = vector_get(nd->tree, (size_t)index - 2);
+		index = vector_at(nd->tree, (size_t)index - 2);
 		child_number++;
 	}
 
@@ -147,10 +232,18 @@ node node_get_child(const node *const nd, const size_t index)
 		return node_broken();
 	}
 
-	size_t child_index = (size_t)vector_get(nd->tree, ref_get_children(nd));
+	const item_t children = vector_at(nd->tree, ref_get_children(nd));
+	if (is_negative(children))
+	{
+		node child = { nd->tree, (size_t)vector_at(nd->tree, from_negative(children) + index) };
+		return child;
+	}
+
+	COUNTER_ADD(COUNTER_TREE_STEPS, index);
+	size_t child_index = (size_t)children;
 	for (size_t i = 0; i < index; i++)
 	{
-		child_index = (size_t)vector_get(nd->tree, child_index - 2);
+		child_index = (size_t)vector_at(nd->tree, child_index - 2);
 	}
 
 	node child = { nd->tree, child_index };
@@ -159,24 +252,15 @@ node node_get_child(const node *const nd, const size_t index)
 
 node node_get_parent(const node *const nd)
 {
-	return node_search_parent(nd, NULL);
-}
-
-
-item_t node_get_type(const node *const nd)
-{
-	return node_is_correct(nd) && nd->index != 0 ? vector_get(nd->tree, nd->index - 1) : ITEM_MAX;
-}
+	if (!node_is_correct(nd) || nd->index == 0)
+	{
+		return node_broken();
+	}
 
-size_t node_get_argc(const node *const nd)
-{
-	return node_is_correct(nd) ? (size_t)vector_get(nd->tree, ref_get_argc(nd)) : 0;
+	node parent = { nd->tree, (size_t)vector_at(nd->tree, ref_get_parent(nd)) };
+	return parent;
 }
 
-item_t node_get_arg(const node *const nd, const size_t index)
-{
-	return index < node_get_argc(nd) ? vector_get(nd->tree, ref_get_argc(nd) + 1 + index) : ITEM_MAX;
-}
 
 double node_get_arg_double(const node *const nd, const size_t index)
 {
@@ -188,11 +272,6 @@ int64_t node_get_arg_int64(const node *const nd, const size_t index)
 	return index + INT64_SIZE <= node_get_argc(nd) ? vector_get_int64(nd->tree, ref_get_argc(nd) + 1 + index) : LLONG_MAX;
 }
 
-size_t node_get_amount(const node *const nd)
-{
-	return node_is_correct(nd) ? (size_t)vector_get(nd->tree, ref_get_amount(nd)) : 0;
-}
-
 
 node node_get_next(const node *const nd)
 {
@@ -201,20 +280,18 @@ node node_get_next(const node *const nd)
 		return node_broken();
 	}
 
-	node next = { nd->tree, (size_t)vector_get(nd->tree, ref_get_children(nd)) };
-
-	if (node_get_amount(nd) == 0)
+	if (node_get_amount(nd) != 0)
 	{
-		item_t index = vector_get(nd->tree, ref_get_next(nd));
-		while (is_negative(index))
-		{
-			// Get next reference from parent
-			index = vector_get(nd->tree, from_negative(index) - 2);
-		}
+		node next = { nd->tree, node_get_first_index(nd) };
+		return next;
+	}
 
-		next.index = (size_t)index;
+	if (nd->index == 0)
+	{
+		return node_broken();
 	}
 
+	node next = { nd->tree, node_get_following_index(nd) };
 	return next.index != 0 ? next : node_broken();
 }
 
@@ -238,6 +315,9 @@ node node_add_child(const node *const nd, const item_t type)
 		return node_broken();
 	}
 
+	node_thaw(nd);
+
+	vector_add(nd->tree, (item_t)nd->index);
 	vector_add(nd->tree, to_negative(nd->index));
 	vector_add(nd->tree, type);
 	node child = { nd->tree, vector_add(nd->tree, 0) };
@@ -397,6 +477,8 @@ node node_insert(const node *const nd, const item_t type, const size_t argc)
 		return node_broken();
 	}
 
+	node_thaw(&parent);
+
 	size_t reference;
 	if (index == 0)
 	{
@@ -408,6 +490,7 @@ node node_insert(const node *const nd, const item_t type, const size_t argc)
 		reference = ref_get_next(&prev);
 	}
 
+	vector_add(nd->tree, (item_t)parent.index);
 	vector_add(nd->tree, vector_get(nd->tree, ref_get_next(nd)));
 	vector_add(nd->tree, type);
 	node child = { nd->tree, vector_add(nd->tree, 1) };
@@ -417,6 +500,7 @@ node node_insert(const node *const nd, const item_t type, const size_t argc)
 
 	vector_set(nd->tree, reference, (item_t)child.index);
 	ref_set_next(nd, to_negative(child.index));
+	ref_set_parent(nd, (item_t)child.index);
 	return child;
 }
 
@@ -435,6 +519,7 @@ int node_order(const node *const fst, const node *const snd)
 	{
 		const node child = node_get_child(fst, fst_amount - 1);
 		ref_set_next(&child, to_negative(fst->index));
+		node_adopt_children(fst);
 	}
 
 	const size_t snd_amount = node_get_amount(snd);
@@ -442,6 +527,7 @@ int node_order(const node *const fst, const node *const snd)
 	{
 		const node child = node_get_child(snd, snd_amount - 1);
 		ref_set_next(&child, to_negative(snd->index));
+		node_adopt_children(snd);
 	}
 
 	return 0;
@@ -460,6 +546,9 @@ int node_swap(const node *const fst, const node *const snd)
 		return -1;
 	}
 
+	node_thaw(&fst_parent);
+	node_thaw(&snd_parent);
+
 	vector *const tree = fst->tree;
 	if (fst_index == 0 && snd_index == 0)
 	{
@@ -483,6 +572,63 @@ int node_swap(const node *const fst, const node *const snd)
 	}
 
 	vector_swap(tree, ref_get_next(fst), ref_get_next(snd));
+	vector_swap(tree, ref_get_parent(fst), ref_get_parent(snd));
+	return 0;
+}
+
+int node_absorb(const node *const nd, const size_t amount, const node *const last)
+{
+	if (!node_is_correct(nd) || nd->index == 0 || !node_is_correct(last) || last->tree != nd->tree || amount == 0)
+	{
+		return -1;
+	}
+
+	vector *const tree = nd->tree;
+	size_t index = nd->index;
+	for (size_t i = 0; i < amount; i++)
+	{
+		const item_t next = vector_at(tree, index - 2);
+		if (next <= 0)
+		{
+			return -1;
+		}
+
+		index = (size_t)next;
+	}
+
+	if (index != last->index)
+	{
+		return -1;
+	}
+
+	const node parent = node_get_parent(nd);
+	node_thaw(&parent);
+	node_thaw(nd);
+
+	const size_t first = (size_t)vector_at(tree, ref_get_next(nd));
+	index = first;
+	for (size_t i = 0; i < amount; i++)
+	{
+		vector_put(tree, index - 3, (item_t)nd->index);
+		index = (size_t)vector_at(tree, index - 2);
+	}
+
+	const size_t children = node_get_amount(nd);
+	if (children == 0)
+	{
+		ref_set_children(nd, (item_t)first);
+	}
+	else
+	{
+		const node prev = node_get_child(nd, children - 1);
+		ref_set_next(&prev, (item_t)first);
+	}
+
+	ref_set_next(nd, vector_at(tree, ref_get_next(last)));
+	ref_set_next(last, to_negative(nd->index));
+
+	ref_set_amount(nd, (item_t)(children + amount));
+	ref_set_amount(&parent, (item_t)(node_get_amount(&parent) - amount));
 	return 0;
 }
 
@@ -495,6 +641,8 @@ int node_remove(node *const nd)
 		return -1;
 	}
 
+	node_thaw(&parent);
+
 	if (index == 0)
 	{
 		ref_set_amount(&parent, (item_t)node_get_amount(&parent) - 1);
@@ -516,14 +664,165 @@ int node_remove(node *const nd)
 
 	if (node_get_amount(nd) == 0 && (ref_get_argc(nd) + node_get_argc(nd)) == vector_size(nd->tree) - 1)
 	{
-		vector_resize(nd->tree, ref_get_next(nd));
+		vector_resize(nd->tree, ref_get_parent(nd));
 	}
 
 	*nd = node_broken();
 	return 0;
 }
 
-bool node_is_correct(const node *const nd)
+int node_compact(vector *const tree)
 {
-	return nd != NULL && vector_is_correct(nd->tree) && nd->index != SIZE_MAX;
+	const node root = node_get_root(tree);
+	if (!node_is_correct(&root))
+	{
+		return -1;
+	}
+
+	vector compact = tree->memory != NULL
+		? vector_create_by_arena(tree->memory, vector_size(tree))
+		: vector_create(vector_size(tree));
+	// Frames of old node index, old index of next child, new node index and new index of last child
+	vector stack = vector_create(4 * 64);
+	if (!vector_is_correct(&compact) || !vector_is_correct(&stack))
+	{
+		vector_clear(&compact);
+		vector_clear(&stack);
+		return -1;
+	}
+
+	const size_t root_size = 3 + node_get_argc(&root);
+	vector_append(&compact, vector_data(tree), root_size);
+	vector_put(&compact, 1, 0);
+
+	vector_add(&stack, 0);
+	vector_add(&stack, node_get_amount(&root) != 0 ? (item_t)node_get_first_index(&root) : 0);
+	vector_add(&stack, 0);
+	vector_add(&stack, 0);
+
+	while (vector_size(&stack) != 0)
+	{
+		const size_t top = vector_size(&stack) - 4;
+		const size_t old_child = (size_t)vector_at(&stack, top + 1);
+		if (old_child == 0)
+		{
+			vector_resize(&stack, top);
+			continue;
+		}
+
+		const item_t next = vector_at(tree, old_child - 2);
+		vector_put(&stack, top + 1, next > 0 ? next : 0);
+
+		// Copy node record with links to new parent
+		const node child = { tree, old_child };
+		const size_t parent = (size_t)vector_at(&stack, top + 2);
+		vector_add(&compact, (item_t)parent);
+		vector_add(&compact, to_negative(parent));
+		vector_add(&compact, node_get_type(&child));
+		const size_t index = vector_add(&compact, (item_t)node_get_amount(&child));
+		vector_add(&compact, 0);
+		vector_append(&compact, &vector_data(tree)[ref_get_argc(&child)], 1 + node_get_argc(&child));
+
+		const size_t last = (size_t)vector_at(&stack, top + 3);
+		vector_put(&compact, last != 0 ? last - 2 : parent + 1, (item_t)index);
+		vector_put(&stack, top + 3, (item_t)index);
+
+		vector_add(&stack, (item_t)old_child);
+		vector_add(&stack, node_get_amount(&child) != 0 ? (item_t)node_get_first_index(&child) : 0);
+		vector_add(&stack, (item_t)index);
+		vector_add(&stack, 0);
+	}
+
+	vector_clear(&stack);
+	vector_clear(tree);
+	*tree = compact;
+	return 0;
+}
+
+int node_truncate(const node *const nd, const size_t amount, const size_t size)
+{
+	if (!node_is_correct(nd) || amount > node_get_amount(nd) || size > vector_size(nd->tree)
+		|| ref_get_argc(nd) + node_get_argc(nd) >= size)
+	{
+		return -1;
+	}
+
+	node_thaw(nd);
+	if (amount != 0)
+	{
+		const node last = node_get_child(nd, amount - 1);
+		ref_set_next(&last, to_negative(nd->index));
+	}
+
+	ref_set_amount(nd, (item_t)amount);
+	return vector_resize(nd->tree, size);
+}
+
+int node_freeze(const node *const nd)
+{
+	if (!node_is_correct(nd))
+	{
+		return -1;
+	}
+
+	for (node_iterator it = node_iterator_create(nd); node_iterator_is_correct(&it); node_iterator_next(&it))
+	{
+		if (node_freeze_children(&it.current))
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+node_iterator node_iterator_create(const node *const nd)
+{
+	node_iterator it = { node_is_correct(nd) ? *nd : node_broken(), node_is_correct(nd) ? nd->index : SIZE_MAX, 0 };
+	return it;
+}
+
+int node_iterator_next(node_iterator *const it)
+{
+	if (!node_iterator_is_correct(it))
+	{
+		return -1;
+	}
+
+	if (node_get_amount(&it->current) == 0)
+	{
+		return node_iterator_skip(it);
+	}
+
+	it->current.index = node_get_first_index(&it->current);
+	it->depth++;
+	return 0;
+}
+
+int node_iterator_skip(node_iterator *const it)
+{
+	if (!node_iterator_is_correct(it) || it->current.index == it->root)
+	{
+		it->current = node_broken();
+		return -1;
+	}
+
+	// Отрицательная ссылка последнего ребёнка ведёт к родителю, каждый родитель покидается один раз
+	item_t index = vector_at(it->current.tree, ref_get_next(&it->current));
+	while (is_negative(index) && from_negative(index) != it->root)
+	{
+		it->depth--;
+		index = vector_at(it->current.tree, from_negative(index) - 2);
+	}
+
+	// Ссылка на корень дерева с индексом 0 неотличима от нуля
+	if (is_negative(index) || index == 0)
+	{
+		it->current = node_broken();
+		return -1;
+	}
+
+	it->current.index = (size_t)index;
+	return 0;
 }
@@ -30,6 +30,27 @@ typedef struct node
 	size_t index;			/**< Node index */
 } node;
 
+/** Pre-order tree iterator */
+typedef struct node_iterator
+{
+	node current;			/**< Current node */
+	size_t root;			/**< Root of traversed subtree */
+	size_t depth;			/**< Depth of current node in subtree */
+} node_iterator;
+
+
+/**
+ *	Check that node is correct
+ *
+ *	@param	nd			Node structure
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+inline bool node_is_correct(const node *const nd)
+{
+	return nd != NULL && vector_is_correct(nd->tree) && nd->index != SIZE_MAX;
+}
+
 
 /**
  *	Get tree root node
@@ -67,7 +88,10 @@ EXPORTED node node_get_parent(const node *const nd);
  *
  *	@return	Node type, @c ITEM_MAX on failure
  */
-EXPORTED item_t node_get_type(const node *const nd);
+inline item_t node_get_type(const node *const nd)
+{
+	return node_is_correct(nd) && nd->index != 0 ? vector_at(nd->tree, nd->index - 1) : ITEM_MAX;
+}
 
 /**
  *	Get amount of arguments
@@ -76,7 +100,10 @@ EXPORTED item_t node_get_type(const node *const nd);
  *
  *	@return	Amount of arguments
  */
-EXPORTED size_t node_get_argc(const node *const nd);
+inline size_t node_get_argc(const node *const nd)
+{
+	return node_is_correct(nd) ? (size_t)vector_at(nd->tree, nd->index + 2) : 0;
+}
 
 /**
  *	Get argument from node by index
@@ -86,7 +113,10 @@ EXPORTED size_t node_get_argc(const node *const nd);
  *
  *	@return	Argument, @c ITEM_MAX on failure
  */
-EXPORTED item_t node_get_arg(const node *const nd, const size_t index);
+inline item_t node_get_arg(const node *const nd, const size_t index)
+{
+	return index < node_get_argc(nd) ? vector_at(nd->tree, nd->index + 3 + index) : ITEM_MAX;
+}
 
 /**
  *	Get double argument from node by index
@@ -115,7 +145,10 @@ EXPORTED int64_t node_get_arg_int64(const node *const nd, const size_t index);
  *
  *	@return	Amount of children
  */
-EXPORTED size_t node_get_amount(const node *const nd);
+inline size_t node_get_amount(const node *const nd)
+{
+	return node_is_correct(nd) ? (size_t)vector_at(nd->tree, nd->index) : 0;
+}
 
 
 /**
@@ -289,6 +322,17 @@ EXPORTED int node_order(const node *const fst, const node *const snd);
  */
 EXPORTED int node_swap(const node *const fst, const node *const snd);
 
+/**
+ *	Move next siblings of node to the end of its children
+ *
+ *	@param	nd			Node structure
+ *	@param	amount		Number of siblings to move
+ *	@param	last		Expected last moved sibling
+ *
+ *	@return	@c 0 on success, @c -1 on failure, tree stays unchanged
+ */
+EXPORTED int node_absorb(const node *const nd, const size_t amount, const node *const last);
+
 /**
  *	Remove node from tree
  *
@@ -299,13 +343,103 @@ EXPORTED int node_swap(const node *const fst, const node *const snd);
 EXPORTED int node_remove(node *const nd);
 
 /**
- *	Check that node is correct
+ *	Move nodes reachable from root to the beginning of tree in pre-order,
+ *	memory of removed nodes is released. Saved node indexes become invalid.
+ *
+ *	@param	tree		Tree table
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int node_compact(vector *const tree);
+
+/**
+ *	Remove last children of node and release tree table after given size.
+ *	Removed subtrees must be placed after this size and
+ *	nothing before it may refer to them.
  *
  *	@param	nd			Node structure
+ *	@param	amount		Number of kept children
+ *	@param	size		New size of tree table
+ *
+ *	@return	@c 0 on success, @c -1 on failure, tree stays unchanged
+ */
+EXPORTED int node_truncate(const node *const nd, const size_t amount, const size_t size);
+
+/**
+ *	Freeze subtree for constant time access to children by index.
+ *	Every node with several children gets an array of children indexes,
+ *	which is dropped when children list of node changes.
+ *
+ *	@param	nd			Root of subtree
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int node_freeze(const node *const nd);
+
+
+/**
+ *	Create pre-order (NLR) iterator over subtree.
+ *	Each step costs amortized constant time, subtree is traversed in linear time.
+ *
+ *	@param	nd			Root of subtree, it is the first visited node
+ *
+ *	@return	Iterator
+ */
+EXPORTED node_iterator node_iterator_create(const node *const nd);
+
+/**
+ *	Move iterator to the next node of subtree
+ *
+ *	@param	it			Iterator
+ *
+ *	@return	@c 0 on success, @c -1 on the end of subtree
+ */
+EXPORTED int node_iterator_next(node_iterator *const it);
+
+/**
+ *	Move iterator to the next node of subtree omitting descendants of current node
+ *
+ *	@param	it			Iterator
+ *
+ *	@return	@c 0 on success, @c -1 on the end of subtree
+ */
+EXPORTED int node_iterator_skip(node_iterator *const it);
+
+/**
+ *	Check that iterator points to node of subtree
+ *
+ *	@param	it			Iterator
  *
  *	@return	@c 1 on true, @c 0 on false
  */
-EXPORTED bool node_is_correct(const node *const nd);
+inline bool node_iterator_is_correct(const node_iterator *const it)
+{
+	return it != NULL && node_is_correct(&it->current);
+}
+
+/**
+ *	Get current node of iterator
+ *
+ *	@param	it			Iterator
+ *
+ *	@return	Current node
+ */
+inline node node_iterator_get(const node_iterator *const it)
+{
+	return it->current;
+}
+
+/**
+ *	Get depth of current node, root of subtree has depth @c 0
+ *
+ *	@param	it			Iterator
+ *
+ *	@return	Depth of current node
+ */
+inline size_t node_iterator_get_depth(const node_iterator *const it)
+{
+	return it->depth;
+}
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -24,15 +24,162 @@
 	#include <windows.h>
 
 	extern intptr_t _get_osfhandle(int fd);
-#elif __APPLE__
-	#include <fcntl.h>
 #else
+	#include <pthread.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 	#include <unistd.h>
 
-	#define MAX_LINK_SIZE 20
+	#ifdef __APPLE__
+		#include <fcntl.h>
+	#else
+		#define MAX_LINK_SIZE 20
+	#endif
 #endif
 
 #define MAX_FORMAT_SIZE 128
+#define MAX_SYMBOL_SIZE 8
+#define OUT_STAGE_SIZE 65536
+
+
+#ifndef _WIN32
+/** Writer thread of output file, which writes filled block while next one is filled */
+struct io_writer
+{
+	pthread_t thread;				/**< Writer thread */
+	pthread_mutex_t lock;			/**< Lock of block handoff */
+	pthread_cond_t cond;			/**< Signal of handoff and of written block */
+
+	FILE *file;						/**< Output file */
+	char *block;					/**< Block being written or free block */
+	size_t size;					/**< Size of block being written */
+
+	bool is_busy;					/**< Set, if block is being written */
+	bool is_finished;				/**< Set, if no more blocks will be handed */
+	bool was_error;					/**< Set, if some block was not written */
+};
+
+
+static void *out_writer_thread(void *const arg)
+{
+	io_writer *const writer = arg;
+
+	pthread_mutex_lock(&writer->lock);
+	while (true)
+	{
+		while (!writer->is_busy && !writer->is_finished)
+		{
+			pthread_cond_wait(&writer->cond, &writer->lock);
+		}
+
+		if (!writer->is_busy)
+		{
+			break;
+		}
+
+		// Запись идёт без блокировки, чтобы кодогенератор в это время заполнял второй блок
+		pthread_mutex_unlock(&writer->lock);
+		const bool is_written = fwrite(writer->block, sizeof(char), writer->size, writer->file) == writer->size;
+		pthread_mutex_lock(&writer->lock);
+
+		writer->was_error = writer->was_error || !is_written;
+		writer->is_busy = false;
+		pthread_cond_broadcast(&writer->cond);
+	}
+	pthread_mutex_unlock(&writer->lock);
+
+	return NULL;
+}
+
+/** Wait until writer thread writes handed block, so output file may be used directly */
+static int out_writer_wait(universal_io *const io)
+{
+	io_writer *const writer = io->out_writer;
+	if (writer == NULL)
+	{
+		return 0;
+	}
+
+	pthread_mutex_lock(&writer->lock);
+	while (writer->is_busy)
+	{
+		pthread_cond_wait(&writer->cond, &writer->lock);
+	}
+	const bool was_error = writer->was_error;
+	pthread_mutex_unlock(&writer->lock);
+
+	return was_error ? -1 : 0;
+}
+
+/** Hand filled staging buffer to writer thread and take its free block */
+static int out_writer_hand(universal_io *const io)
+{
+	io_writer *const writer = io->out_writer;
+
+	pthread_mutex_lock(&writer->lock);
+	while (writer->is_busy)
+	{
+		pthread_cond_wait(&writer->cond, &writer->lock);
+	}
+
+	char *const block = writer->block;
+	writer->block = io->out_stage;
+	writer->size = io->out_stage_position;
+	writer->is_busy = true;
+
+	const bool was_error = writer->was_error;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
+
+	io->out_stage = block;
+	io->out_stage_position = 0;
+	return was_error ? -1 : 0;
+}
+
+/** Stop writer thread after the last handed block */
+static int out_writer_join(universal_io *const io)
+{
+	io_writer *const writer = io->out_writer;
+	if (writer == NULL)
+	{
+		return 0;
+	}
+
+	pthread_mutex_lock(&writer->lock);
+	writer->is_finished = true;
+	pthread_cond_broadcast(&writer->cond);
+	pthread_mutex_unlock(&writer->lock);
+
+	pthread_join(writer->thread, NULL);
+	const bool was_error = writer->was_error;
+
+	pthread_cond_destroy(&writer->cond);
+	pthread_mutex_destroy(&writer->lock);
+	free(writer->block);
+	free(writer);
+
+	io->out_writer = NULL;
+	return was_error ? -1 : 0;
+}
+#else
+static inline int out_writer_wait(universal_io *const io)
+{
+	(void)io;
+	return 0;
+}
+
+static inline int out_writer_hand(universal_io *const io)
+{
+	(void)io;
+	return -1;
+}
+
+static inline int out_writer_join(universal_io *const io)
+{
+	(void)io;
+	return 0;
+}
+#endif
 
 
 static inline bool is_specifier(const char ch)
@@ -83,6 +230,41 @@ static int scan_buffer_arg(universal_io *const io, const char *const format, con
 	return io->in_position < io->in_size || number != 0 ? ret : 0;
 }
 
+static size_t window_fill(universal_io *const io)
+{
+	// Window keeps IN_REWIND_SIZE bytes before current position and takes next chunk after loaded bytes
+	const size_t start = io->in_position > io->in_window_position + IN_REWIND_SIZE
+		? io->in_position - IN_REWIND_SIZE
+		: io->in_window_position;
+	const size_t kept = io->in_size - start;
+	memmove(io->in_window, &io->in_window[start - io->in_window_position], kept);
+	io->in_window_position = start;
+
+	const size_t size = io->in_reader(io->in_context, &io->in_window[kept], IN_REWIND_SIZE + IN_CHUNK_SIZE - kept);
+	io->in_size += size;
+	io->in_window[kept + size] = '\0';
+	return size;
+}
+
+static int scan_window_arg(universal_io *const io, const char *const format, const size_t size, void *arg)
+{
+	// Scanned value should not be cut by the end of window
+	if (io->in_size - io->in_position < IN_CHUNK_SIZE / 2)
+	{
+		window_fill(io);
+	}
+
+	char buffer[MAX_FORMAT_SIZE];
+	strncpy(buffer, format, size);
+	sprintf(&buffer[size], "%%zn");
+
+	size_t number = 0;
+	int ret = sscanf(&io->in_window[io->in_position - io->in_window_position], buffer, arg, &number);
+	io->in_position += number;
+
+	return io->in_position < io->in_size || number != 0 ? ret : 0;
+}
+
 static inline int in_func_position(universal_io *const io, const char *const format, va_list args
 	, int (*scan_arg)(universal_io *const, const char *const, const size_t, void *))
 {
@@ -147,41 +329,190 @@ static int in_func_buffer(universal_io *const io, const char *const format, va_l
 	return in_func_position(io, format, args, &scan_buffer_arg);
 }
 
+static int in_func_window(universal_io *const io, const char *const format, va_list args)
+{
+	return in_func_position(io, format, args, &scan_window_arg);
+}
+
 static int in_func_user(universal_io *const io, const char *const format, va_list args)
 {
 	return io->in_user_func(format, args);
 }
 
 
-static int out_func_file(universal_io *const io, const char *const format, va_list args)
+static int in_func_call(universal_io *const io, const char *const format, ...)
 {
-	return vfprintf(io->out_file, format, args);
+	va_list args;
+	va_start(args, format);
+
+	const int ret = io->in_func(io, format, args);
+
+	va_end(args);
+	return ret;
 }
 
-static int out_func_buffer(universal_io *const io, const char *const format, va_list args)
+
+static int read_byte_file(universal_io *const io)
+{
+	const int ret = getc(io->in_file);
+	if (ret != EOF)
+	{
+		io->in_position++;
+	}
+
+	return ret;
+}
+
+static int read_byte_window(universal_io *const io)
 {
+	if (io->in_position >= io->in_size && window_fill(io) == 0)
+	{
+		return EOF;
+	}
+
+	return (unsigned char)io->in_window[io->in_position++ - io->in_window_position];
+}
+
+static size_t read_stream(void *const context, char *const buffer, const size_t size)
+{
+	return fread(buffer, sizeof(char), size, (FILE *)context);
+}
+
+static int read_byte_user(universal_io *const io)
+{
+	char ch = '\0';
+	return in_func_call(io, "%c", &ch) == 1 ? (unsigned char)ch : EOF;
+}
+
+static char32_t read_char_buffer(universal_io *const io)
+{
+	if (io->in_position >= io->in_size)
+	{
+		return (char32_t)EOF;
+	}
+
+	const char *const symbol = &io->in_buffer[io->in_position];
+	const size_t size = utf8_symbol_size(symbol[0]);
+	if (size > io->in_size - io->in_position)
+	{
+		io->in_position = io->in_size;
+		return (char32_t)EOF;
+	}
+
+	io->in_position += size;
+	return utf8_convert(symbol);
+}
+
+static inline char32_t read_char(universal_io *const io, int (*read_byte)(universal_io *const))
+{
+	char buffer[MAX_SYMBOL_SIZE];
+
+	int ch = read_byte(io);
+	if (ch == EOF)
+	{
+		return (char32_t)EOF;
+	}
+
+	buffer[0] = (char)ch;
+	const size_t size = utf8_symbol_size(buffer[0]);
+	for (size_t i = 1; i < size; i++)
+	{
+		ch = read_byte(io);
+		if (ch == EOF)
+		{
+			return (char32_t)EOF;
+		}
+
+		buffer[i] = (char)ch;
+	}
+
+	return utf8_convert(buffer);
+}
+
+
+static int out_func_file(universal_io *const io, const char *const format, va_list args)
+{
+	if (io->out_stage == NULL)
+	{
+		return vfprintf(io->out_file, format, args);
+	}
+
 	va_list local;
 	va_copy(local, args);
 
-	int ret = vsnprintf(&io->out_buffer[io->out_position], io->out_size - io->out_position, format, local);
+	const size_t free = OUT_STAGE_SIZE - io->out_stage_position;
+	const int ret = vsnprintf(&io->out_stage[io->out_stage_position], free, format, local);
+	va_end(local);
 
-	if (ret != -1 && (size_t)ret + io->out_position < io->out_size)
+	if (ret < 0 || (size_t)ret < free)
 	{
-		io->out_position += (size_t)ret;
+		io->out_stage_position += ret < 0 ? 0 : (size_t)ret;
 		return ret;
 	}
 
-	io->out_buffer[io->out_position] = '\0';
+	if (out_flush(io))
+	{
+		return -1;
+	}
+
+	if ((size_t)ret < OUT_STAGE_SIZE)
+	{
+		io->out_stage_position = (size_t)vsnprintf(io->out_stage, OUT_STAGE_SIZE, format, args);
+		return ret;
+	}
+
+	return out_writer_wait(io) ? -1 : vfprintf(io->out_file, format, args);
+}
 
-	char *new_buffer = realloc(io->out_buffer, 2 * io->out_size * sizeof(char));
-	if (new_buffer == NULL)
+static int out_reserve_buffer(universal_io *const io, const size_t size)
+{
+	if (io->out_position + size < io->out_size)
+	{
+		return 0;
+	}
+
+	// Grow geometrically like vector, but never less than requested
+	const size_t size_required = io->out_position + size + 1;
+	const size_t size_new = size_required > 2 * io->out_size ? size_required : 2 * io->out_size;
+
+	char *buffer_new = realloc(io->out_buffer, size_new * sizeof(char));
+	if (buffer_new == NULL)
 	{
 		return -1;
 	}
 
-	io->out_size *= 2;
-	io->out_buffer = new_buffer;
-	return out_func_buffer(io, format, args);
+	io->out_size = size_new;
+	io->out_buffer = buffer_new;
+	return 0;
+}
+
+static int out_func_buffer(universal_io *const io, const char *const format, va_list args)
+{
+	va_list local;
+	va_copy(local, args);
+
+	const int ret = vsnprintf(&io->out_buffer[io->out_position], io->out_size - io->out_position, format, local);
+	va_end(local);
+
+	if (ret < 0)
+	{
+		io->out_buffer[io->out_position] = '\0';
+		return ret;
+	}
+
+	if ((size_t)ret >= io->out_size - io->out_position)
+	{
+		if (out_reserve_buffer(io, (size_t)ret))
+		{
+			io->out_buffer[io->out_position] = '\0';
+			return -1;
+		}
+
+		vsnprintf(&io->out_buffer[io->out_position], io->out_size - io->out_position, format, args);
+	}
+
+	io->out_position += (size_t)ret;
+	return ret;
 }
 
 static int out_func_user(universal_io *const io, const char *const format, va_list args)
@@ -189,6 +520,58 @@ static int out_func_user(universal_io *const io, const char *const format, va_li
 	return io->out_user_func(format, args);
 }
 
+static int out_func_call(universal_io *const io, const char *const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	const int ret = io->out_func(io, format, args);
+
+	va_end(args);
+	return ret;
+}
+
+
+static int out_write_file(universal_io *const io, const char *const str, const size_t size)
+{
+	if (io->out_stage == NULL)
+	{
+		return fwrite(str, sizeof(char), size, io->out_file) == size ? (int)size : -1;
+	}
+
+	if (size > OUT_STAGE_SIZE - io->out_stage_position && out_flush(io))
+	{
+		return -1;
+	}
+
+	if (size >= OUT_STAGE_SIZE)
+	{
+		if (out_writer_wait(io))
+		{
+			return -1;
+		}
+
+		return fwrite(str, sizeof(char), size, io->out_file) == size ? (int)size : -1;
+	}
+
+	memcpy(&io->out_stage[io->out_stage_position], str, size);
+	io->out_stage_position += size;
+	return (int)size;
+}
+
+static int out_write_buffer(universal_io *const io, const char *const str, const size_t size)
+{
+	if (out_reserve_buffer(io, size))
+	{
+		return -1;
+	}
+
+	memcpy(&io->out_buffer[io->out_position], str, size);
+	io->out_position += size;
+	io->out_buffer[io->out_position] = '\0';
+	return (int)size;
+}
+
 
 static inline size_t io_get_path(FILE *const file, char *const buffer)
 {
@@ -223,6 +606,61 @@ static inline size_t io_get_path(FILE *const file, char *const buffer)
 }
 
 
+static inline size_t io_map_file(FILE *const file, const char **const buffer)
+{
+#ifdef _WIN32
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+
+	LARGE_INTEGER size;
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0 || size.QuadPart % info.dwPageSize == 0)
+	{
+		return 0;
+	}
+
+	HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL)
+	{
+		return 0;
+	}
+
+	*buffer = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+
+	return *buffer != NULL ? (size_t)size.QuadPart : 0;
+#else
+	struct stat info;
+	const long page = sysconf(_SC_PAGESIZE);
+
+	// Tail of the last page is filled by zeros, so buffer stays null-terminated
+	if (fstat(fileno(file), &info) || info.st_size == 0 || page <= 0 || info.st_size % page == 0)
+	{
+		return 0;
+	}
+
+	void *const mapping = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (mapping == MAP_FAILED)
+	{
+		return 0;
+	}
+
+	*buffer = mapping;
+	return (size_t)info.st_size;
+#endif
+}
+
+static inline void io_unmap_file(const char *const buffer, const size_t size)
+{
+#ifdef _WIN32
+	(void)size;
+	UnmapViewOfFile(buffer);
+#else
+	munmap((void *)buffer, size);
+#endif
+}
+
+
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
  *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
@@ -238,6 +676,8 @@ universal_io io_create(void)
 
 	io.in_file = NULL;
 	io.in_buffer = NULL;
+	io.in_map = NULL;
+	io.in_locations = NULL;
 
 	io.in_size = 0;
 	io.in_position = 0;
@@ -245,9 +685,18 @@ universal_io io_create(void)
 	io.in_user_func = NULL;
 	io.in_func = NULL;
 
+	io.in_reader = NULL;
+	io.in_context = NULL;
+	io.in_window = NULL;
+	io.in_window_position = 0;
+
 	io.out_file = NULL;
 	io.out_buffer = NULL;
 
+	io.out_stage = NULL;
+	io.out_stage_position = 0;
+	io.out_writer = NULL;
+
 	io.out_size = 0;
 	io.out_position = 0;
 
@@ -279,6 +728,11 @@ int in_set_file(universal_io *const io, const char *const path)
 }
 
 int in_set_buffer(universal_io *const io, const char *const buffer)
+{
+	return buffer != NULL ? in_set_range(io, buffer, strlen(buffer)) : -1;
+}
+
+int in_set_range(universal_io *const io, const char *const buffer, const size_t size)
 {
 	if (buffer == NULL || in_clear(io))
 	{
@@ -287,7 +741,44 @@ int in_set_buffer(universal_io *const io, const char *const buffer)
 
 	io->in_buffer = buffer;
 
-	io->in_size = strlen(io->in_buffer);
+	io->in_size = size;
+	io->in_position = 0;
+
+	io->in_func = &in_func_buffer;
+
+	return 0;
+}
+
+int in_set_locations(universal_io *const io, const location_map *const map)
+{
+	if (!in_is_buffer(io))
+	{
+		return -1;
+	}
+
+	io->in_locations = map;
+	return 0;
+}
+
+int in_set_mmap(universal_io *const io, const char *const path)
+{
+	if (in_set_file(io, path))
+	{
+		return -1;
+	}
+
+	const char *buffer = NULL;
+	const size_t size = io_map_file(io->in_file, &buffer);
+	if (size == 0)
+	{
+		return 0;
+	}
+
+	io->in_map = io->in_file;
+	io->in_file = NULL;
+
+	io->in_buffer = buffer;
+	io->in_size = size;
 	io->in_position = 0;
 
 	io->in_func = &in_func_buffer;
@@ -308,6 +799,38 @@ int in_set_func(universal_io *const io, const io_user_func func)
 	return 0;
 }
 
+int in_set_reader(universal_io *const io, const io_read_func func, void *const context)
+{
+	if (func == NULL || in_clear(io))
+	{
+		return -1;
+	}
+
+	io->in_window = malloc((IN_REWIND_SIZE + IN_CHUNK_SIZE + 1) * sizeof(char));
+	if (io->in_window == NULL)
+	{
+		return -1;
+	}
+
+	io->in_window[0] = '\0';
+	io->in_window_position = 0;
+
+	io->in_reader = func;
+	io->in_context = context;
+
+	io->in_size = 0;
+	io->in_position = 0;
+
+	io->in_func = &in_func_window;
+
+	return 0;
+}
+
+int in_set_stream(universal_io *const io, FILE *const file)
+{
+	return file != NULL ? in_set_reader(io, &read_stream, file) : -1;
+}
+
 int in_set_position(universal_io *const io, const size_t position)
 {
 	if (in_is_buffer(io))
@@ -334,6 +857,13 @@ int in_set_position(universal_io *const io, const size_t position)
 		return -1;
 	}
 
+	// Window is rewound only to its beginning and advanced only over bytes already read
+	if (in_is_reader(io) && position >= io->in_window_position && position <= io->in_size)
+	{
+		io->in_position = position;
+		return 0;
+	}
+
 	return -1;
 }
 
@@ -352,6 +882,14 @@ int in_swap(universal_io *const fst, universal_io *const snd)
 	fst->in_buffer = snd->in_buffer;
 	snd->in_buffer = buffer;
 
+	FILE *map = fst->in_map;
+	fst->in_map = snd->in_map;
+	snd->in_map = map;
+
+	const location_map *locations = fst->in_locations;
+	fst->in_locations = snd->in_locations;
+	snd->in_locations = locations;
+
 	const size_t size = fst->in_size;
 	fst->in_size = snd->in_size;
 	snd->in_size = size;
@@ -368,13 +906,50 @@ int in_swap(universal_io *const fst, universal_io *const snd)
 	fst->in_func = snd->in_func;
 	snd->in_func = func;
 
+	const io_read_func reader = fst->in_reader;
+	fst->in_reader = snd->in_reader;
+	snd->in_reader = reader;
+
+	void *const context = fst->in_context;
+	fst->in_context = snd->in_context;
+	snd->in_context = context;
+
+	char *const window = fst->in_window;
+	fst->in_window = snd->in_window;
+	snd->in_window = window;
+
+	const size_t window_position = fst->in_window_position;
+	fst->in_window_position = snd->in_window_position;
+	snd->in_window_position = window_position;
+
 	return 0;
 }
 
 
+char32_t in_read_char(universal_io *const io)
+{
+	if (in_is_buffer(io))
+	{
+		return read_char_buffer(io);
+	}
+
+	if (in_is_file(io))
+	{
+		return read_char(io, &read_byte_file);
+	}
+
+	if (in_is_reader(io))
+	{
+		return read_char(io, &read_byte_window);
+	}
+
+	return in_is_func(io) ? read_char(io, &read_byte_user) : (char32_t)EOF;
+}
+
+
 bool in_is_correct(const universal_io *const io)
 {
-	return io != NULL && (in_is_file(io) || in_is_buffer(io) || in_is_func(io));
+	return io != NULL && (in_is_file(io) || in_is_buffer(io) || in_is_func(io) || in_is_reader(io));
 }
 
 bool in_is_file(const universal_io *const io)
@@ -392,6 +967,11 @@ bool in_is_func(const universal_io *const io)
 	return io != NULL && io->in_user_func != NULL;
 }
 
+bool in_is_reader(const universal_io *const io)
+{
+	return io != NULL && io->in_reader != NULL;
+}
+
 
 io_func in_get_func(const universal_io *const io)
 {
@@ -400,7 +980,12 @@ io_func in_get_func(const universal_io *const io)
 
 size_t in_get_path(const universal_io *const io, char *const buffer)
 {
-	return in_is_file(io) ? io_get_path(io->in_file, buffer) : 0;
+	if (in_is_file(io))
+	{
+		return io_get_path(io->in_file, buffer);
+	}
+
+	return in_is_buffer(io) && io->in_map != NULL ? io_get_path(io->in_map, buffer) : 0;
 }
 
 const char *in_get_buffer(const universal_io *const io)
@@ -408,9 +993,19 @@ const char *in_get_buffer(const universal_io *const io)
 	return in_is_buffer(io) ? io->in_buffer : NULL;
 }
 
+const location_map *in_get_locations(const universal_io *const io)
+{
+	return in_is_buffer(io) ? io->in_locations : NULL;
+}
+
 size_t in_get_position(const universal_io *const io)
 {
-	return in_is_buffer(io) || in_is_file(io) ? io->in_position : 0;
+	return in_is_buffer(io) || in_is_file(io) || in_is_reader(io) ? io->in_position : 0;
+}
+
+size_t in_get_size(const universal_io *const io)
+{
+	return in_is_buffer(io) ? io->in_size : 0;
 }
 
 
@@ -442,7 +1037,27 @@ int in_clear(universal_io *const io)
 	}
 	else if (in_is_buffer(io))
 	{
+		if (io->in_map != NULL)
+		{
+			io_unmap_file(io->in_buffer, io->in_size);
+			fclose(io->in_map);
+			io->in_map = NULL;
+		}
+
 		io->in_buffer = NULL;
+		io->in_locations = NULL;
+
+		io->in_size = 0;
+		io->in_position = 0;
+	}
+	else if (in_is_reader(io))
+	{
+		free(io->in_window);
+		io->in_window = NULL;
+		io->in_window_position = 0;
+
+		io->in_reader = NULL;
+		io->in_context = NULL;
 
 		io->in_size = 0;
 		io->in_position = 0;
@@ -470,6 +1085,15 @@ int out_set_file(universal_io *const io, const char *const path)
 		return -1;
 	}
 
+	// Output is staged in a large buffer and written by whole chunks,
+	// so the stream buffer would only add one more copy
+	io->out_stage = malloc(OUT_STAGE_SIZE * sizeof(char));
+	io->out_stage_position = 0;
+	if (io->out_stage != NULL)
+	{
+		setvbuf(io->out_file, NULL, _IONBF, 0);
+	}
+
 	io->out_func = &out_func_file;
 
 	return 0;
@@ -512,6 +1136,52 @@ int out_set_func(universal_io *const io, const io_user_func func)
 	return 0;
 }
 
+int out_set_async(universal_io *const io)
+{
+#ifndef _WIN32
+	if (!out_is_file(io) || io->out_stage == NULL || io->out_writer != NULL)
+	{
+		return -1;
+	}
+
+	io_writer *const writer = malloc(sizeof(io_writer));
+	if (writer == NULL)
+	{
+		return -1;
+	}
+
+	writer->file = io->out_file;
+	writer->block = malloc(OUT_STAGE_SIZE * sizeof(char));
+	writer->size = 0;
+	writer->is_busy = false;
+	writer->is_finished = false;
+	writer->was_error = false;
+
+	if (writer->block == NULL)
+	{
+		free(writer);
+		return -1;
+	}
+
+	pthread_mutex_init(&writer->lock, NULL);
+	pthread_cond_init(&writer->cond, NULL);
+	if (pthread_create(&writer->thread, NULL, &out_writer_thread, writer))
+	{
+		pthread_cond_destroy(&writer->cond);
+		pthread_mutex_destroy(&writer->lock);
+		free(writer->block);
+		free(writer);
+		return -1;
+	}
+
+	io->out_writer = writer;
+	return 0;
+#else
+	(void)io;
+	return -1;
+#endif
+}
+
 int out_swap(universal_io *const fst, universal_io *const snd)
 {
 	if (fst == NULL || snd == NULL)
@@ -527,6 +1197,18 @@ int out_swap(universal_io *const fst, universal_io *const snd)
 	fst->out_buffer = snd->out_buffer;
 	snd->out_buffer = buffer;
 
+	char *stage = fst->out_stage;
+	fst->out_stage = snd->out_stage;
+	snd->out_stage = stage;
+
+	const size_t stage_position = fst->out_stage_position;
+	fst->out_stage_position = snd->out_stage_position;
+	snd->out_stage_position = stage_position;
+
+	io_writer *writer = fst->out_writer;
+	fst->out_writer = snd->out_writer;
+	snd->out_writer = writer;
+
 	const size_t size = fst->out_size;
 	fst->out_size = snd->out_size;
 	snd->out_size = size;
@@ -547,6 +1229,49 @@ int out_swap(universal_io *const fst, universal_io *const snd)
 }
 
 
+int out_write(universal_io *const io, const char *const str, const size_t size)
+{
+	if (str == NULL)
+	{
+		return -1;
+	}
+
+	if (out_is_file(io))
+	{
+		return out_write_file(io, str, size);
+	}
+
+	if (out_is_buffer(io))
+	{
+		return out_write_buffer(io, str, size);
+	}
+
+	return out_is_func(io) ? out_func_call(io, "%.*s", (int)size, str) : -1;
+}
+
+int out_flush(universal_io *const io)
+{
+	if (!out_is_file(io))
+	{
+		return -1;
+	}
+
+	if (io->out_stage == NULL || io->out_stage_position == 0)
+	{
+		return 0;
+	}
+
+	if (io->out_writer != NULL)
+	{
+		return out_writer_hand(io);
+	}
+
+	const size_t size = io->out_stage_position;
+	io->out_stage_position = 0;
+	return fwrite(io->out_stage, sizeof(char), size, io->out_file) == size ? 0 : -1;
+}
+
+
 bool out_is_correct(const universal_io *const io)
 {
 	return io != NULL && (out_is_file(io) || out_is_buffer(io) || out_is_func(io));;
@@ -583,6 +1308,11 @@ size_t out_get_path(const universal_io *const io, char *const buffer)
 	return io_get_path(io->out_file, buffer);
 }
 
+size_t out_get_position(const universal_io *const io)
+{
+	return out_is_buffer(io) ? io->out_position : 0;
+}
+
 
 char *out_extract_buffer(universal_io *const io)
 {
@@ -608,9 +1338,15 @@ int out_close_file(universal_io *const io)
 		return -1;
 	}
 
-	int ret = fclose(io->out_file);
+	int ret = out_flush(io);
+	ret = out_writer_join(io) || ret ? EOF : 0;
+	ret = fclose(io->out_file) || ret ? EOF : 0;
 	io->out_file = NULL;
 
+	free(io->out_stage);
+	io->out_stage = NULL;
+	io->out_stage_position = 0;
+
 	return ret;
 }
 
@@ -24,11 +24,17 @@
 #include "utf8.h"
 
 
+#define IN_CHUNK_SIZE 65536
+#define IN_REWIND_SIZE 4096
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 typedef struct universal_io universal_io;
+typedef struct io_writer io_writer;
+typedef struct location_map location_map;
 
 
 /**
@@ -52,12 +58,25 @@ typedef int (*io_user_func)(const char *const format, va_list args);
  */
 typedef int (*io_func)(universal_io *const io, const char *const format, va_list args);
 
+/**
+ *	Prototype of block input function
+ *
+ *	@param	context		User context
+ *	@param	buffer		Buffer to fill
+ *	@param	size		Size of buffer
+ *
+ *	@return	Number of read bytes, @c 0 on end of input
+ */
+typedef size_t (*io_read_func)(void *const context, char *const buffer, const size_t size);
+
 
 /** Input and output settings */
 struct universal_io
 {
 	FILE *in_file;				/**< Input file */
 	const char *in_buffer;		/**< Input buffer */
+	FILE *in_map;				/**< Memory-mapped input file */
+	const location_map *in_locations;	/**< Line markers moved out of input buffer */
 
 	size_t in_size;				/**< Size of input buffer */
 	size_t in_position;			/**< Current position of input buffer */
@@ -65,9 +84,18 @@ struct universal_io
 	io_user_func in_user_func;	/**< Input user function */
 	io_func in_func;			/**< Current input function */
 
+	io_read_func in_reader;		/**< Block input function */
+	void *in_context;			/**< Context of block input function */
+	char *in_window;			/**< Sliding window over input read by blocks */
+	size_t in_window_position;	/**< Input position of the first byte of window */
+
 	FILE *out_file;				/**< Output file */
 	char *out_buffer;			/**< Output buffer */
 
+	char *out_stage;			/**< Staging buffer of output file */
+	size_t out_stage_position;	/**< Current position of staging buffer */
+	io_writer *out_writer;		/**< Writer thread of staging buffers */
+
 	size_t out_size;			/**< Size of output buffer */
 	size_t out_position;		/**< Current position of output buffer */
 
@@ -104,6 +132,38 @@ EXPORTED int in_set_file(universal_io *const io, const char *const path);
  */
 EXPORTED int in_set_buffer(universal_io *const io, const char *const buffer);
 
+/**
+ *	Set input buffer of known size without scanning it
+ *
+ *	@param	io			Universal io structure
+ *	@param	buffer		Input buffer
+ *	@param	size		Size of buffer
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int in_set_range(universal_io *const io, const char *const buffer, const size_t size);
+
+/**
+ *	Set line markers moved out of input buffer, they are reset by the next input
+ *
+ *	@param	io			Universal io structure
+ *	@param	map			Line markers, @c NULL if they are comments in buffer
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int in_set_locations(universal_io *const io, const location_map *const map);
+
+/**
+ *	Set input file mapped into memory as read-only buffer,
+ *	falls back to ordinary input file if mapping is impossible
+ *
+ *	@param	io			Universal io structure
+ *	@param	path		Input file path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int in_set_mmap(universal_io *const io, const char *const path);
+
 /**
  *	Set input function
  *
@@ -114,6 +174,30 @@ EXPORTED int in_set_buffer(universal_io *const io, const char *const buffer);
  */
 EXPORTED int in_set_func(universal_io *const io, const io_user_func func);
 
+/**
+ *	Set block input function.
+ *	Input is read by chunks into sliding window, so non-seekable streams are read without copying them whole.
+ *	Position can be set back inside the window only, which keeps at least @c IN_REWIND_SIZE bytes before the current one.
+ *
+ *	@param	io			Universal io structure
+ *	@param	func		Block input function
+ *	@param	context		Context passed to block input function
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int in_set_reader(universal_io *const io, const io_read_func func, void *const context);
+
+/**
+ *	Set input stream, such as pipe or standard input, which is read by chunks.
+ *	Stream is not closed by universal io structure.
+ *
+ *	@param	io			Universal io structure
+ *	@param	file		Input stream
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int in_set_stream(universal_io *const io, FILE *const file);
+
 /**
  *	Set input position
  *
@@ -135,6 +219,16 @@ EXPORTED int in_set_position(universal_io *const io, const size_t position);
 EXPORTED int in_swap(universal_io *const fst, universal_io *const snd);
 
 
+/**
+ *	Read next UTF-8 character from input without format parsing
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	UTF-8 character, @c EOF on failure
+ */
+EXPORTED char32_t in_read_char(universal_io *const io);
+
+
 /**
  *	Check that current input option is correct
  *
@@ -171,6 +265,15 @@ EXPORTED bool in_is_buffer(const universal_io *const io);
  */
 EXPORTED bool in_is_func(const universal_io *const io);
 
+/**
+ *	Check that current input option is block input function
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED bool in_is_reader(const universal_io *const io);
+
 
 /**
  *	Get input func from universal io structure
@@ -200,6 +303,15 @@ EXPORTED size_t in_get_path(const universal_io *const io, char *const buffer);
  */
 EXPORTED const char *in_get_buffer(const universal_io *const io);
 
+/**
+ *	Get line markers moved out of input buffer
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	Line markers, @c NULL if they are comments in buffer
+ */
+EXPORTED const location_map *in_get_locations(const universal_io *const io);
+
 /**
  *	Get input position from universal io structure
  *
@@ -209,6 +321,15 @@ EXPORTED const char *in_get_buffer(const universal_io *const io);
  */
 EXPORTED size_t in_get_position(const universal_io *const io);
 
+/**
+ *	Get input buffer size from universal io structure
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	Input buffer size
+ */
+EXPORTED size_t in_get_size(const universal_io *const io);
+
 
 /**
  *	Close input file
@@ -240,10 +361,10 @@ EXPORTED int in_clear(universal_io *const io);
 EXPORTED int out_set_file(universal_io *const io, const char *const path);
 
 /**
- *	Set output buffer
+ *	Set output buffer, which grows on demand and never truncates output
  *
  *	@param	io			Universal io structure
- *	@param	size		Output buffer size
+ *	@param	size		Initial output buffer size
  *
  *	@return	@c 0 on success, @c -1 on failure
  */
@@ -259,6 +380,16 @@ EXPORTED int out_set_buffer(universal_io *const io, const size_t size);
  */
 EXPORTED int out_set_func(universal_io *const io, const io_user_func func);
 
+/**
+ *	Write output file by separate thread: filled staging buffer is handed to writer thread,
+ *	while the next one is filled. Writer thread is joined, when output file is closed.
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int out_set_async(universal_io *const io);
+
 /**
  *	Swap output option between two streams
  *
@@ -270,6 +401,27 @@ EXPORTED int out_set_func(universal_io *const io, const io_user_func func);
 EXPORTED int out_swap(universal_io *const fst, universal_io *const snd);
 
 
+/**
+ *	Write bytes to output without format parsing
+ *
+ *	@param	io			Universal io structure
+ *	@param	str			Bytes to write
+ *	@param	size		Number of bytes
+ *
+ *	@return	Number of written bytes, @c -1 on failure
+ */
+EXPORTED int out_write(universal_io *const io, const char *const str, const size_t size);
+
+/**
+ *	Flush staging buffer of output file
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int out_flush(universal_io *const io);
+
+
 /**
  *	Check that current output option is correct
  *
@@ -326,6 +478,15 @@ EXPORTED io_func out_get_func(const universal_io *const io);
  */
 EXPORTED size_t out_get_path(const universal_io *const io, char *const buffer);
 
+/**
+ *	Get output buffer position from universal io structure
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	Output position
+ */
+EXPORTED size_t out_get_position(const universal_io *const io);
+
 
 /**
  *	Extract output buffer from universal io structure
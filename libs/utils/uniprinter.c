@@ -16,9 +16,14 @@
 
 #include "uniprinter.h"
 #include <stdarg.h>
+#include <string.h>
+#include "counters.h"
 #include "utf8.h"
 
 
+#define MAX_ITEM_SIZE 24
+
+
 int uni_printf(universal_io *const io, const char *const format, ...)
 {
 	if (!out_is_correct(io))
@@ -26,6 +31,8 @@ int uni_printf(universal_io *const io, const char *const format, ...)
 		return -1;
 	}
 
+	COUNTER_INC(counters_get_output());
+
 	va_list args;
 	va_start(args, format);
 
@@ -40,10 +47,43 @@ int uni_print_char(universal_io *const io, const char32_t wchar)
 {
 	char buffer[8];
 
-	if (!utf8_to_string(buffer, wchar))
+	const size_t size = utf8_to_string(buffer, wchar);
+	if (size == 0)
 	{
 		return 0;
 	}
 
-	return uni_printf(io, "%s", buffer);
+	return out_write(io, buffer, size);
+}
+
+int uni_print_str(universal_io *const io, const char *const str)
+{
+	return str != NULL ? out_write(io, str, strlen(str)) : -1;
+}
+
+int uni_print_item(universal_io *const io, const item_t item)
+{
+	char buffer[MAX_ITEM_SIZE];
+	size_t index = MAX_ITEM_SIZE;
+
+#if ITEM_MIN < 0
+	const bool is_negative = item < 0;
+	uint64_t value = is_negative ? ~(uint64_t)item + 1 : (uint64_t)item;
+#else
+	const bool is_negative = false;
+	uint64_t value = (uint64_t)item;
+#endif
+
+	do
+	{
+		buffer[--index] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	if (is_negative)
+	{
+		buffer[--index] = '-';
+	}
+
+	return out_write(io, &buffer[index], MAX_ITEM_SIZE - index);
 }
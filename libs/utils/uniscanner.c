@@ -17,6 +17,7 @@
 #include "uniscanner.h"
 #include <stdarg.h>
 #include <string.h>
+#include "counters.h"
 #include "utf8.h"
 
 
@@ -39,37 +40,71 @@ int uni_scanf(universal_io *const io, const char *const format, ...)
 
 char32_t uni_scan_char(universal_io *const io)
 {
-	char buffer[MAX_SYMBOL_SIZE];
-	if (!uni_scanf(io, "%c", &buffer[0]))
+	COUNTER_INC(COUNTER_SCAN_CHAR);
+	return in_read_char(io);
+}
+
+size_t uni_scan_number(universal_io *const io, char *const buffer)
+{
+	const size_t begin = in_get_position(io);
+	size_t index = 0;
+	size_t digits = 0;
+
+	char32_t character = uni_scan_char(io);
+	if (character == '+' || character == '-')
 	{
-		return (char32_t)EOF;
+		buffer[index++] = (char)character;
+		character = uni_scan_char(io);
+	}
+
+	for (; utf8_is_digit(character); digits++, character = uni_scan_char(io))
+	{
+		buffer[index++] = (char)character;
 	}
 
-	const size_t size = utf8_symbol_size(buffer[0]);
-	for (size_t i = 1; i < size; i++)
+	if (character == '.')
 	{
-		if (!uni_scanf(io, "%c", &buffer[i]))
+		buffer[index++] = (char)character;
+		for (character = uni_scan_char(io); utf8_is_digit(character); digits++, character = uni_scan_char(io))
 		{
-			return (char32_t)EOF;
+			buffer[index++] = (char)character;
 		}
 	}
 
-	return utf8_convert(buffer);
-}
+	if (digits == 0)
+	{
+		in_set_position(io, begin);
+		return 0;
+	}
 
-size_t uni_scan_number(universal_io *const io, char *const buffer)
-{
-	const size_t begin = in_get_position(io);
-	double number = 0;
-	uni_scanf(io, "%lf", &number);
+	if (utf8_is_power(character))
+	{
+		// Exponent belongs to number only if it has digits
+		const size_t mantissa_end = in_get_position(io) - utf8_size(character);
+		const size_t mantissa_size = index;
+
+		index += utf8_to_string(&buffer[index], character);
+		character = uni_scan_char(io);
+		if (character == '+' || character == '-')
+		{
+			buffer[index++] = (char)character;
+			character = uni_scan_char(io);
+		}
 
-	const size_t end = in_get_position(io);
-	in_set_position(io, begin);
+		if (!utf8_is_digit(character))
+		{
+			in_set_position(io, mantissa_end);
+			return mantissa_size;
+		}
 
-	for (size_t index = 0; in_get_position(io) < end;
-		index += utf8_to_string(&buffer[index], uni_scan_char(io)));
+		for (; utf8_is_digit(character); character = uni_scan_char(io))
+		{
+			buffer[index++] = (char)character;
+		}
+	}
 
-	return end - begin;
+	uni_unscan_char(io, character);
+	return index;
 }
 
 size_t uni_scan_identifier(universal_io *const io, char *const buffer)
@@ -82,7 +117,7 @@ size_t uni_scan_identifier(universal_io *const io, char *const buffer)
 	}
 
 	size_t index = 0;
-	while (utf8_is_letter(character) || utf8_is_digit(character))
+	while ((utf8_get_class(character) & (UTF8_LETTER | UTF8_DIGIT)) != 0)
 	{
 		index += utf8_to_string(&buffer[index], character);
 		character = uni_scan_char(io);
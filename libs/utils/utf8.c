@@ -16,6 +16,55 @@
 
 #include "utf8.h"
 #include <assert.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define UTF8_SSE2
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#define UTF8_NEON
+	#include <arm_neon.h>
+#endif
+
+
+#define UTF8_BLOCK_SIZE 16
+
+
+extern uint8_t utf8_get_class(const char32_t symbol);
+extern bool utf8_is_letter(const char32_t symbol);
+extern bool utf8_is_digit(const char32_t symbol);
+extern bool utf8_is_hexa_digit(const char32_t symbol);
+
+
+const uint8_t utf8_octet_class[256] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 4, 4, 4, 4, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 0, 0, 0, 0, 0, 0,
+	0, 9, 9, 9, 9, 9, 9, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+	0, 9, 9, 9, 9, 9, 9, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+const uint8_t utf8_cyrillic_class[UTF8_CYRILLIC_SIZE] =
+{
+	0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
 
 
 static char32_t char32_from_cp866(const unsigned char symbol)
@@ -868,6 +917,183 @@ static size_t char_transliteration(char *const buffer, const char32_t symbol)
 }
 
 
+
+static inline uint8_t ascii_class(const unsigned char symbol)
+{
+	return utf8_octet_class[symbol] & (UTF8_LETTER | UTF8_DIGIT | UTF8_SPACE);
+}
+
+static inline bool is_russian_pair(const unsigned char fst, const unsigned char snd)
+{
+	return (fst == 0xD0 && (snd == 0x81 || (snd >= 0x90 && snd <= 0xBF)))
+		|| (fst == 0xD1 && (snd == 0x91 || (snd >= 0x80 && snd <= 0x8F)));
+}
+
+/** Return size of correct UTF-8 character at the beginning of string, @c 0 if incorrect */
+static size_t valid_symbol_size(const unsigned char *const str, const size_t size)
+{
+	const unsigned char fst = str[0];
+	if (fst < 0x80)
+	{
+		return 1;
+	}
+
+	const size_t expected = fst < 0xC2 ? 0 : fst < 0xE0 ? 2 : fst < 0xF0 ? 3 : fst < 0xF5 ? 4 : 0;
+	if (expected == 0 || expected > size)
+	{
+		return 0;
+	}
+
+	for (size_t i = 1; i < expected; i++)
+	{
+		if ((str[i] & 0xC0) != 0x80)
+		{
+			return 0;
+		}
+	}
+
+	// Overlong forms, surrogates and code points above U+10FFFF
+	if ((fst == 0xE0 && str[1] < 0xA0) || (fst == 0xED && str[1] > 0x9F)
+		|| (fst == 0xF0 && str[1] < 0x90) || (fst == 0xF4 && str[1] > 0x8F))
+	{
+		return 0;
+	}
+
+	return expected;
+}
+
+/** Check that block contains only ASCII characters */
+static inline bool block_is_ascii(const unsigned char *const str)
+{
+#if defined(UTF8_SSE2)
+	return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)str)) == 0;
+#elif defined(UTF8_NEON)
+	return vmaxvq_u8(vld1q_u8(str)) < 0x80;
+#else
+	for (size_t i = 0; i < UTF8_BLOCK_SIZE; i++)
+	{
+		if (str[i] >= 0x80)
+		{
+			return false;
+		}
+	}
+
+	return true;
+#endif
+}
+
+/** Write classes of ASCII block, return @c false if block has non-ASCII characters */
+static inline bool block_classify_ascii(const unsigned char *const str, uint8_t *const classes)
+{
+#if defined(UTF8_SSE2)
+	const __m128i block = _mm_loadu_si128((const __m128i *)str);
+	if (_mm_movemask_epi8(block) != 0)
+	{
+		return false;
+	}
+
+	const __m128i lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+	const __m128i letter = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('_'))
+		, _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))));
+	const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1))
+		, _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1)));
+	const __m128i space = _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' '))
+		, _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(block, _mm_set1_epi8('\r' + 1))));
+
+	const __m128i result = _mm_or_si128(_mm_and_si128(letter, _mm_set1_epi8(UTF8_LETTER))
+		, _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(UTF8_DIGIT)), _mm_and_si128(space, _mm_set1_epi8(UTF8_SPACE))));
+	_mm_storeu_si128((__m128i *)classes, result);
+	return true;
+#elif defined(UTF8_NEON)
+	const uint8x16_t block = vld1q_u8(str);
+	if (vmaxvq_u8(block) >= 0x80)
+	{
+		return false;
+	}
+
+	const uint8x16_t lower = vorrq_u8(block, vdupq_n_u8(0x20));
+	const uint8x16_t letter = vorrq_u8(vceqq_u8(block, vdupq_n_u8('_'))
+		, vandq_u8(vcgeq_u8(lower, vdupq_n_u8('a')), vcleq_u8(lower, vdupq_n_u8('z'))));
+	const uint8x16_t digit = vandq_u8(vcgeq_u8(block, vdupq_n_u8('0')), vcleq_u8(block, vdupq_n_u8('9')));
+	const uint8x16_t space = vorrq_u8(vceqq_u8(block, vdupq_n_u8(' '))
+		, vandq_u8(vcgeq_u8(block, vdupq_n_u8('\t')), vcleq_u8(block, vdupq_n_u8('\r'))));
+
+	const uint8x16_t result = vorrq_u8(vandq_u8(letter, vdupq_n_u8(UTF8_LETTER))
+		, vorrq_u8(vandq_u8(digit, vdupq_n_u8(UTF8_DIGIT)), vandq_u8(space, vdupq_n_u8(UTF8_SPACE))));
+	vst1q_u8(classes, result);
+	return true;
+#else
+	if (!block_is_ascii(str))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < UTF8_BLOCK_SIZE; i++)
+	{
+		classes[i] = ascii_class(str[i]);
+	}
+
+	return true;
+#endif
+}
+
+/** Check that block consists of eight 2-byte russian letters */
+static inline bool block_is_russian(const unsigned char *const str)
+{
+#if defined(UTF8_SSE2)
+	// Little-endian 16-bit lanes hold first octet in low byte and second octet in high byte
+	const __m128i block = _mm_loadu_si128((const __m128i *)str);
+	const __m128i fst = _mm_and_si128(block, _mm_set1_epi16(0xFF));
+	const __m128i snd = _mm_srli_epi16(block, 8);
+
+	const __m128i upper = _mm_and_si128(_mm_cmpeq_epi16(fst, _mm_set1_epi16(0xD0))
+		, _mm_or_si128(_mm_cmpeq_epi16(snd, _mm_set1_epi16(0x81))
+			, _mm_and_si128(_mm_cmpgt_epi16(snd, _mm_set1_epi16(0x8F)), _mm_cmplt_epi16(snd, _mm_set1_epi16(0xC0)))));
+	const __m128i lower = _mm_and_si128(_mm_cmpeq_epi16(fst, _mm_set1_epi16(0xD1))
+		, _mm_or_si128(_mm_cmpeq_epi16(snd, _mm_set1_epi16(0x91))
+			, _mm_and_si128(_mm_cmpgt_epi16(snd, _mm_set1_epi16(0x7F)), _mm_cmplt_epi16(snd, _mm_set1_epi16(0x90)))));
+
+	return _mm_movemask_epi8(_mm_or_si128(upper, lower)) == 0xFFFF;
+#elif defined(UTF8_NEON)
+	const uint16x8_t block = vreinterpretq_u16_u8(vld1q_u8(str));
+	const uint16x8_t fst = vandq_u16(block, vdupq_n_u16(0xFF));
+	const uint16x8_t snd = vshrq_n_u16(block, 8);
+
+	const uint16x8_t upper = vandq_u16(vceqq_u16(fst, vdupq_n_u16(0xD0))
+		, vorrq_u16(vceqq_u16(snd, vdupq_n_u16(0x81))
+			, vandq_u16(vcgeq_u16(snd, vdupq_n_u16(0x90)), vcleq_u16(snd, vdupq_n_u16(0xBF)))));
+	const uint16x8_t lower = vandq_u16(vceqq_u16(fst, vdupq_n_u16(0xD1))
+		, vorrq_u16(vceqq_u16(snd, vdupq_n_u16(0x91))
+			, vandq_u16(vcgeq_u16(snd, vdupq_n_u16(0x80)), vcleq_u16(snd, vdupq_n_u16(0x8F)))));
+
+	return vminvq_u16(vorrq_u16(upper, lower)) == 0xFFFF;
+#else
+	for (size_t i = 0; i < UTF8_BLOCK_SIZE; i += 2)
+	{
+		if (!is_russian_pair(str[i], str[i + 1]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+#endif
+}
+
+/** Return class and size of correct character, @c 0 size if incorrect */
+static inline size_t symbol_classify(const unsigned char *const str, const size_t size, uint8_t *const class)
+{
+	if (str[0] < 0x80)
+	{
+		*class = ascii_class(str[0]);
+		return 1;
+	}
+
+	const size_t symbol_size = valid_symbol_size(str, size);
+	*class = symbol_size == 2 && is_russian_pair(str[0], str[1]) ? UTF8_LETTER : UTF8_OTHER;
+	return symbol_size;
+}
+
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
  *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
@@ -1102,26 +1328,116 @@ bool utf8_is_russian(const char32_t symbol)
 		|| (symbol >= U'р' && symbol <= U'я');
 }
 
-bool utf8_is_letter(const char32_t symbol)
+bool utf8_is_power(const char32_t symbol)
 {
-	return  utf8_is_russian(symbol) || symbol == '_'
-		|| (symbol >= 'A' && symbol <= 'Z')
-		|| (symbol >= 'a' && symbol <= 'z');
+	return symbol == 'e' || symbol == 'E' || symbol == U'е' || symbol == U'Е';
 }
 
-bool utf8_is_digit(const char32_t symbol)
+
+size_t utf8_validate(const char *const str, const size_t size)
 {
-	return symbol >= '0' && symbol <= '9';
+	const unsigned char *const octets = (const unsigned char *)str;
+	size_t i = 0;
+
+	while (i < size)
+	{
+		if (i + UTF8_BLOCK_SIZE <= size && block_is_ascii(&octets[i]))
+		{
+			i += UTF8_BLOCK_SIZE;
+			continue;
+		}
+
+		const size_t symbol_size = valid_symbol_size(&octets[i], size - i);
+		if (symbol_size == 0)
+		{
+			break;
+		}
+
+		i += symbol_size;
+	}
+
+	return i;
 }
 
-bool utf8_is_hexa_digit(const char32_t symbol)
+size_t utf8_classify(const char *const str, const size_t size, uint8_t *const classes)
 {
-	return utf8_is_digit(symbol)
-		|| (symbol >= 'A' && symbol <= 'F')
-		|| (symbol >= 'a' && symbol <= 'f');
+	const unsigned char *const octets = (const unsigned char *)str;
+	size_t i = 0;
+
+	while (i < size)
+	{
+		if (i + UTF8_BLOCK_SIZE <= size)
+		{
+			if (block_classify_ascii(&octets[i], &classes[i]))
+			{
+				i += UTF8_BLOCK_SIZE;
+				continue;
+			}
+
+			if (block_is_russian(&octets[i]))
+			{
+				memset(&classes[i], UTF8_LETTER, UTF8_BLOCK_SIZE);
+				i += UTF8_BLOCK_SIZE;
+				continue;
+			}
+		}
+
+		uint8_t class;
+		const size_t symbol_size = symbol_classify(&octets[i], size - i, &class);
+		if (symbol_size == 0)
+		{
+			break;
+		}
+
+		memset(&classes[i], class, symbol_size);
+		i += symbol_size;
+	}
+
+	return i;
 }
 
-bool utf8_is_power(const char32_t symbol)
+size_t utf8_span(const char *const str, const size_t size, const uint8_t mask)
 {
-	return symbol == 'e' || symbol == 'E' || symbol == U'е' || symbol == U'Е';
+	const unsigned char *const octets = (const unsigned char *)str;
+	size_t i = 0;
+
+	while (i < size)
+	{
+		if (i + UTF8_BLOCK_SIZE <= size)
+		{
+			uint8_t classes[UTF8_BLOCK_SIZE];
+			if (block_classify_ascii(&octets[i], classes))
+			{
+				size_t j = 0;
+				while (j < UTF8_BLOCK_SIZE && (classes[j] & mask) != 0)
+				{
+					j++;
+				}
+
+				i += j;
+				if (j != UTF8_BLOCK_SIZE)
+				{
+					break;
+				}
+				continue;
+			}
+
+			if ((mask & UTF8_LETTER) != 0 && block_is_russian(&octets[i]))
+			{
+				i += UTF8_BLOCK_SIZE;
+				continue;
+			}
+		}
+
+		uint8_t class;
+		const size_t symbol_size = symbol_classify(&octets[i], size - i, &class);
+		if (symbol_size == 0 || (class & mask) == 0)
+		{
+			break;
+		}
+
+		i += symbol_size;
+	}
+
+	return i;
 }
@@ -34,6 +34,29 @@
 extern "C" {
 #endif
 
+/** Character classes of bulk classification */
+enum UTF8_CLASS
+{
+	UTF8_OTHER = 0,
+	UTF8_LETTER = 1,	/**< English or russian letter, or '_' */
+	UTF8_DIGIT = 2,		/**< Decimal digit */
+	UTF8_SPACE = 4,		/**< Whitespace character */
+	UTF8_HEXA = 8,		/**< Hexadecimal digit, only in lookup tables */
+};
+
+
+/** First code point of cyrillic lookup table */
+#define UTF8_CYRILLIC_BEGIN 0x400
+/** Size of cyrillic lookup table */
+#define UTF8_CYRILLIC_SIZE 0x60
+
+/** Classes of octets, non-zero only for ASCII characters */
+EXPORTED extern const uint8_t utf8_octet_class[256];
+
+/** Classes of characters from U+0400 to U+045F */
+EXPORTED extern const uint8_t utf8_cyrillic_class[UTF8_CYRILLIC_SIZE];
+
+
 /**
  *	Number of UTF-8 character bytes
  *
@@ -158,6 +181,25 @@ EXPORTED uint8_t utf8_to_number(const char32_t symbol);
  */
 EXPORTED bool utf8_is_russian(const char32_t symbol);
 
+/**
+ *	Get class of character from lookup tables
+ *
+ *	@param	symbol	UTF-8 сharacter
+ *
+ *	@return	Bitwise OR of @ref UTF8_CLASS values
+ */
+inline uint8_t utf8_get_class(const char32_t symbol)
+{
+	if (symbol < 256)
+	{
+		return utf8_octet_class[symbol];
+	}
+
+	return symbol - UTF8_CYRILLIC_BEGIN < UTF8_CYRILLIC_SIZE
+		? utf8_cyrillic_class[symbol - UTF8_CYRILLIC_BEGIN]
+		: (uint8_t)UTF8_OTHER;
+}
+
 /**
  *	Check if сharacter is english or russian letter
  *
@@ -165,7 +207,10 @@ EXPORTED bool utf8_is_russian(const char32_t symbol);
  *
  *	@return	@c 1 on true, @c 0 on false
  */
-EXPORTED bool utf8_is_letter(const char32_t symbol);
+inline bool utf8_is_letter(const char32_t symbol)
+{
+	return (utf8_get_class(symbol) & UTF8_LETTER) != 0;
+}
 
 /**
  *	Check if сharacter is decimal digit
@@ -174,7 +219,10 @@ EXPORTED bool utf8_is_letter(const char32_t symbol);
  *
  *	@return	@c 1 on true, @c 0 on false
  */
-EXPORTED bool utf8_is_digit(const char32_t symbol);
+inline bool utf8_is_digit(const char32_t symbol)
+{
+	return symbol - '0' < 10;
+}
 
 /**
  *	Check if сharacter is hexadecimal digit
@@ -183,7 +231,10 @@ EXPORTED bool utf8_is_digit(const char32_t symbol);
  *
  *	@return	@c 1 on true, @c 0 on false
  */
-EXPORTED bool utf8_is_hexa_digit(const char32_t symbol);
+inline bool utf8_is_hexa_digit(const char32_t symbol)
+{
+	return symbol < 256 && (utf8_octet_class[symbol] & UTF8_HEXA) != 0;
+}
 
 /**
  *	Check if сharacter is 'E', 'e', 'Е' or 'е'
@@ -194,6 +245,40 @@ EXPORTED bool utf8_is_hexa_digit(const char32_t symbol);
  */
 EXPORTED bool utf8_is_power(const char32_t symbol);
 
+
+/**
+ *	Validate UTF-8 string using vector instructions where available
+ *
+ *	@param	str		UTF-8 string
+ *	@param	size	Size of string
+ *
+ *	@return	Size of correct prefix, equals @p size on success
+ */
+EXPORTED size_t utf8_validate(const char *const str, const size_t size);
+
+/**
+ *	Validate UTF-8 string and write class of every byte in one pass,
+ *	all octets of character have the same class
+ *
+ *	@param	str		UTF-8 string
+ *	@param	size	Size of string
+ *	@param	classes	Output array of @ref UTF8_CLASS values, at least @p size long
+ *
+ *	@return	Size of correct and classified prefix
+ */
+EXPORTED size_t utf8_classify(const char *const str, const size_t size, uint8_t *const classes);
+
+/**
+ *	Get size of run of characters which classes belong to mask
+ *
+ *	@param	str		UTF-8 string
+ *	@param	size	Size of string
+ *	@param	mask	Bitwise OR of @ref UTF8_CLASS values
+ *
+ *	@return	Size of run in bytes
+ */
+EXPORTED size_t utf8_span(const char *const str, const size_t size, const uint8_t mask);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -17,21 +17,36 @@
 #include "vector.h"
 #include <stdlib.h>
 #include <string.h>
+#include "counters.h"
 
 
-static int change_size(vector *const vec, const size_t size)
+extern item_t vector_at(const vector *const vec, const size_t index);
+extern void vector_put(vector *const vec, const size_t index, const item_t value);
+extern item_t *vector_data(const vector *const vec);
+extern bool vector_is_correct(const vector *const vec);
+
+
+static int change_alloc(vector *const vec, const size_t alloc)
 {
-	if (size > vec->size_alloc)
+	COUNTER_INC(COUNTER_VECTOR_REALLOCS);
+	item_t *array_new = vec->memory != NULL
+		? arena_realloc(vec->memory, vec->array, vec->size_alloc * sizeof(item_t), alloc * sizeof(item_t))
+		: realloc(vec->array, alloc * sizeof(item_t));
+	if (array_new == NULL)
 	{
-		const size_t alloc_new = size > 2 * vec->size_alloc ? size : 2 * vec->size_alloc;
-		item_t *array_new = realloc(vec->array, alloc_new * sizeof(item_t));
-		if (array_new == NULL)
-		{
-			return -1;
-		}
+		return -1;
+	}
+
+	vec->size_alloc = alloc;
+	vec->array = array_new;
+	return 0;
+}
 
-		vec->size_alloc = alloc_new;
-		vec->array = array_new;
+static int change_size(vector *const vec, const size_t size)
+{
+	if (size > vec->size_alloc && change_alloc(vec, size > 2 * vec->size_alloc ? size : 2 * vec->size_alloc))
+	{
+		return -1;
 	}
 
 	if (size > vec->size)
@@ -60,6 +75,19 @@ vector vector_create(const size_t alloc)
 	vec.size = 0;
 	vec.size_alloc = alloc != 0 ? alloc : 1;
 	vec.array = malloc(vec.size_alloc * sizeof(item_t));
+	vec.memory = NULL;
+
+	return vec;
+}
+
+vector vector_create_by_arena(arena *const memory, const size_t alloc)
+{
+	vector vec;
+
+	vec.size = 0;
+	vec.size_alloc = alloc != 0 ? alloc : 1;
+	vec.array = arena_alloc(memory, vec.size_alloc * sizeof(item_t));
+	vec.memory = memory;
 
 	return vec;
 }
@@ -76,6 +104,17 @@ size_t vector_add(vector *const vec, const item_t value)
 	return vec->size - 1;
 }
 
+size_t vector_append(vector *const vec, const item_t *const values, const size_t size)
+{
+	if (!vector_is_correct(vec) || values == NULL || change_size(vec, vec->size + size))
+	{
+		return SIZE_MAX;
+	}
+
+	memcpy(&vec->array[vec->size - size], values, size * sizeof(item_t));
+	return vec->size - size;
+}
+
 size_t vector_add_double(vector *const vec, const double value)
 {
 	if (!vector_is_correct(vec) || change_size(vec, vec->size + DOUBLE_SIZE))
@@ -200,6 +239,16 @@ int vector_increase(vector *const vec, const size_t size)
 	return vector_is_correct(vec) ? change_size(vec, vec->size + size) : -1;
 }
 
+int vector_reserve(vector *const vec, const size_t size)
+{
+	if (!vector_is_correct(vec))
+	{
+		return -1;
+	}
+
+	return size > vec->size_alloc ? change_alloc(vec, size) : 0;
+}
+
 int vector_resize(vector *const vec, const size_t size)
 {
 	return vector_is_correct(vec) ? change_size(vec, size) : -1;
@@ -210,12 +259,6 @@ size_t vector_size(const vector *const vec)
 	return vector_is_correct(vec) ? vec->size : SIZE_MAX;
 }
 
-bool vector_is_correct(const vector *const vec)
-{
-	return vec != NULL && vec->array != NULL;
-}
-
-
 int vector_clear(vector *const vec)
 {
 	if (!vector_is_correct(vec))
@@ -223,7 +266,15 @@ int vector_clear(vector *const vec)
 		return -1;
 	}
 
-	free(vec->array);
+	if (vec->memory != NULL)
+	{
+		arena_free(vec->memory, vec->array, vec->size_alloc * sizeof(item_t));
+	}
+	else
+	{
+		free(vec->array);
+	}
+
 	vec->array = NULL;
 
 	return 0;
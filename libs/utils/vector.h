@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <assert.h>
+#include "arena.h"
 #include "dll.h"
 #include "item.h"
 
@@ -30,6 +32,8 @@ typedef struct vector
 	item_t *array;				/**< Vector array */
 	size_t size;				/**< Size of vector */
 	size_t size_alloc;			/**< Allocated size of vector */
+
+	arena *memory;				/**< Arena of vector array, @c NULL for heap */
 } vector;
 
 
@@ -42,6 +46,17 @@ typedef struct vector
  */
 EXPORTED vector vector_create(const size_t alloc);
 
+/**
+ *	Create new vector with array in arena,
+ *	memory of such vector is released with arena
+ *
+ *	@param	memory			Arena
+ *	@param	alloc			Initializer of allocated size
+ *
+ *	@return	Vector structure
+ */
+EXPORTED vector vector_create_by_arena(arena *const memory, const size_t alloc);
+
 
 /**
  *	Add new value
@@ -53,6 +68,17 @@ EXPORTED vector vector_create(const size_t alloc);
  */
 EXPORTED size_t vector_add(vector *const vec, const item_t value);
 
+/**
+ *	Add several values at once
+ *
+ *	@param	vec				Vector structure
+ *	@param	values			Array of values
+ *	@param	size			Number of values
+ *
+ *	@return	Index of first added value, @c SIZE_MAX on failure
+ */
+EXPORTED size_t vector_append(vector *const vec, const item_t *const values, const size_t size);
+
 /**
  *	Add new double value
  *
@@ -139,6 +165,48 @@ EXPORTED double vector_get_double(const vector *const vec, const size_t index);
 EXPORTED int64_t vector_get_int64(const vector *const vec, const size_t index);
 
 
+/**
+ *	Get value without checks, for hot loops over valid indices
+ *
+ *	@param	vec				Vector structure
+ *	@param	index			Index, less than vector size
+ *
+ *	@return	Value
+ */
+inline item_t vector_at(const vector *const vec, const size_t index)
+{
+	assert(vec != NULL && vec->array != NULL && index < vec->size);
+	return vec->array[index];
+}
+
+/**
+ *	Set value without checks, for hot loops over valid indices
+ *
+ *	@param	vec				Vector structure
+ *	@param	index			Index, less than vector size
+ *	@param	value			Value
+ */
+inline void vector_put(vector *const vec, const size_t index, const item_t value)
+{
+	assert(vec != NULL && vec->array != NULL && index < vec->size);
+	vec->array[index] = value;
+}
+
+/**
+ *	Get vector array without checks,
+ *	pointer is valid until vector size changes
+ *
+ *	@param	vec				Vector structure
+ *
+ *	@return	Vector array
+ */
+inline item_t *vector_data(const vector *const vec)
+{
+	assert(vec != NULL && vec->array != NULL);
+	return vec->array;
+}
+
+
 /**
  *	Remove last value
  *
@@ -187,6 +255,16 @@ EXPORTED int vector_increase(vector *const vec, const size_t size);
  */
 EXPORTED int vector_resize(vector *const vec, const size_t size);
 
+/**
+ *	Reserve memory for vector, size of vector stays the same
+ *
+ *	@param	vec				Vector structure
+ *	@param	size			Number of values to hold without reallocation
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int vector_reserve(vector *const vec, const size_t size);
+
 /**
  *	Get vector size
  *
@@ -203,7 +281,10 @@ EXPORTED size_t vector_size(const vector *const vec);
  *
  *	@return	@c 1 on true, @c 0 on false
  */
-EXPORTED bool vector_is_correct(const vector *const vec);
+inline bool vector_is_correct(const vector *const vec)
+{
+	return vec != NULL && vec->array != NULL;
+}
 
 
 /**
@@ -15,6 +15,7 @@
  */
 
 #include "workspace.h"
+#include <stdlib.h>
 #include <string.h>
 
 #ifndef _WIN32
@@ -28,6 +29,52 @@
 
 static const size_t MAX_FLAGS = 32;
 
+static const char *const OPTIONS[OPT_AMOUNT] =
+{
+	"-Wno",
+	"-c",
+	"-E",
+	"-LLVM",
+	"-MIPS",
+	"-RVM",
+	"-VM",
+	"-O1",
+	"-O2",
+	"-g",
+	"--binary",
+	"--bitcode",
+	"--profile",
+	"--incremental",
+	"--parallel",
+	"-ftime-report",
+	"-ftime-report=json",
+	"-MD",
+	"--lazy",
+	"-fno-schedule-insns",
+	"-fprofile-generate",
+	"-fprofile-use",
+	"--dump-ast",
+	"--dump-vm",
+	"--dump-binary",
+	"-ffast-math",
+	"--run",
+	"--stream",
+	"--eager",
+	"--counters",
+	"--dense",
+	"--compact",
+	"--compress",
+	"-fsyntax-only",
+	"--xref",
+	"--packed",
+	"-malign-double",
+	"--async-output",
+	"--reorder-fields",
+	"-fcost-report",
+	"-fcost-report=json",
+	"--vm-extended",
+};
+
 
 typedef size_t (*ws_add)(workspace *const ws, const char *const str);
 
@@ -128,7 +175,7 @@ static inline size_t ws_add_path(workspace *const ws, strings *const vec, const
 
 	char buffer[MAX_ARG_SIZE];
 	ws_unix_path(path, buffer);
-	if (access(buffer, F_OK) == -1)
+	if (strcmp(buffer, STDIN_PATH) != 0 && access(buffer, F_OK) == -1)
 	{
 		ws->was_error = true;
 		return SIZE_MAX;
@@ -142,6 +189,18 @@ static inline bool ws_is_dir_flag(const char *const flag)
 	return flag[0] == '-' && flag[1] == 'I';
 }
 
+static void ws_add_option(workspace *const ws, const char *const flag)
+{
+	for (size_t i = 0; i < OPT_AMOUNT; i++)
+	{
+		if (strcmp(flag, OPTIONS[i]) == 0)
+		{
+			ws->options |= (uint64_t)1 << i;
+			return;
+		}
+	}
+}
+
 static inline size_t ws_get_num(const strings *const vec)
 {
 	const size_t size = strings_size(vec);
@@ -176,7 +235,7 @@ workspace ws_parse_args(const int argc, const char *const *const argv)
 			return ws;
 		}
 
-		if (argv[i][0] != '-')
+		if (argv[i][0] != '-' || strcmp(argv[i], STDIN_PATH) == 0)
 		{
 			if (ws_add_file(&ws, argv[i]) == SIZE_MAX)
 			{
@@ -212,10 +271,14 @@ workspace ws_create(void)
 	ws.files = strings_create(MAX_PATHS);
 	ws.dirs = strings_create(MAX_PATHS);
 	ws.flags = strings_create(MAX_FLAGS);
+	ws.options = 0;
 
 	ws.output[0] = '\0';
 	ws.was_error = false;
 
+	ws.error_log = NULL;
+	ws.warning_log = NULL;
+
 	return ws;
 }
 
@@ -225,6 +288,19 @@ size_t ws_add_file(workspace *const ws, const char *const path)
 	return ws_add_path(ws, &ws->files, path);
 }
 
+size_t ws_add_virtual_file(workspace *const ws, const char *const path)
+{
+	if (!ws_is_correct(ws) || path == NULL)
+	{
+		ws_add_error(ws);
+		return SIZE_MAX;
+	}
+
+	char buffer[MAX_ARG_SIZE];
+	ws_unix_path(path, buffer);
+	return ws_add_string(&ws->files, buffer);
+}
+
 int ws_add_files(workspace *const ws, const char *const *const paths, const size_t num)
 {
 	return ws_add_array(ws, &ws_add_file, paths, num);
@@ -250,7 +326,19 @@ size_t ws_add_flag(workspace *const ws, const char *const flag)
 		return SIZE_MAX;
 	}
 
-	return ws_is_dir_flag(flag) ? ws_add_dir(ws, &flag[2]) : ws_add_string(&ws->flags, flag);
+	if (ws_is_dir_flag(flag))
+	{
+		return ws_add_dir(ws, &flag[2]);
+	}
+
+	// Известные флаги разбираются один раз, дальше проверяются по битовой маске
+	const size_t index = ws_add_string(&ws->flags, flag);
+	if (index != SIZE_MAX)
+	{
+		ws_add_option(ws, flag);
+	}
+
+	return index;
 }
 
 int ws_add_flags(workspace *const ws, const char *const *const flags, const size_t num)
@@ -271,6 +359,18 @@ int ws_set_output(workspace *const ws, const char *const path)
 	return 0;
 }
 
+int ws_set_log(workspace *const ws, const logger error, const logger warning)
+{
+	if (!ws_is_correct(ws))
+	{
+		return -1;
+	}
+
+	ws->error_log = error;
+	ws->warning_log = warning;
+	return 0;
+}
+
 
 bool ws_is_correct(const workspace *const ws)
 {
@@ -298,6 +398,11 @@ bool ws_has_flag(const workspace *const ws, const char *const flag)
 	}
 }
 
+bool ws_has_option(const workspace *const ws, const option_t opt)
+{
+	return ws_is_correct(ws) && opt < OPT_AMOUNT && (ws->options & ((uint64_t)1 << opt)) != 0;
+}
+
 
 const char *ws_get_file(const workspace *const ws, const size_t index)
 {
@@ -324,6 +429,26 @@ const char *ws_get_flag(const workspace *const ws, const size_t index)
 	return ws_is_correct(ws) ? strings_get(&ws->flags, index) : NULL;
 }
 
+const char *ws_get_flag_value(const workspace *const ws, const char *const prefix)
+{
+	if (!ws_is_correct(ws) || prefix == NULL)
+	{
+		return NULL;
+	}
+
+	const size_t size = strlen(prefix);
+	for (size_t i = 0; i < ws_get_num(&ws->flags); i++)
+	{
+		const char *const flag = strings_get(&ws->flags, i);
+		if (strncmp(flag, prefix, size) == 0 && flag[size] != '\0')
+		{
+			return &flag[size];
+		}
+	}
+
+	return NULL;
+}
+
 size_t ws_get_flags_num(const workspace *const ws)
 {
 	return ws_is_correct(ws) ? ws_get_num(&ws->flags) : 0;
@@ -335,6 +460,24 @@ const char *ws_get_output(const workspace *const ws)
 	return ws_is_correct(ws) && ws->output[0] != '\0' ? ws->output : NULL;
 }
 
+size_t ws_get_jobs(const workspace *const ws)
+{
+	// Последний флаг главнее, как и у make
+	size_t jobs = 0;
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		const char *const flag = ws_get_flag(ws, i);
+		if (flag[0] == '-' && flag[1] == 'j' && flag[2] >= '1' && flag[2] <= '9')
+		{
+			char *end;
+			const unsigned long value = strtoul(&flag[2], &end, 10);
+			jobs = *end == '\0' ? (size_t)value : jobs;
+		}
+	}
+
+	return jobs;
+}
+
 
 int ws_clear(workspace *const ws)
 {
@@ -346,6 +489,7 @@ int ws_clear(workspace *const ws)
 	strings_clear(&ws->files);
 	strings_clear(&ws->dirs);
 	strings_clear(&ws->flags);
+	ws->options = 0;
 
 	ws->was_error = true;
 	return 0;
@@ -21,26 +21,83 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "dll.h"
+#include "logger.h"
 #include "strings.h"
 
 
 #define MAX_PATHS 128
 #define MAX_ARG_SIZE 1024
 
+#define STDIN_PATH "-"
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/** Flags recognized while adding to workspace */
+typedef enum OPTION
+{
+	OPT_NO_RECOVERY,				/**< '-Wno' flag, stop after first error */
+	OPT_COMPILE_ONLY,				/**< '-c' flag, skip linker stage */
+	OPT_PREPROCESS_ONLY,			/**< '-E' flag, only preprocess */
+	OPT_LLVM,						/**< '-LLVM' flag, LLVM IR target */
+	OPT_MIPS,						/**< '-MIPS' flag, MIPS assembler target */
+	OPT_RVM,						/**< '-RVM' flag, RuC virtual machine target */
+	OPT_VM,							/**< '-VM' flag, virtual machine target */
+	OPT_O1,							/**< '-O1' flag, basic optimizations */
+	OPT_O2,							/**< '-O2' flag, advanced optimizations */
+	OPT_DEBUG,						/**< '-g' flag, debug information */
+	OPT_BINARY,						/**< '--binary' flag, binary output */
+	OPT_BITCODE,					/**< '--bitcode' flag, LLVM bitcode output */
+	OPT_PROFILE,					/**< '--profile' flag, profiling code */
+	OPT_INCREMENTAL,				/**< '--incremental' flag, reuse of tables snapshots */
+	OPT_PARALLEL,					/**< '--parallel' flag, parallel preprocessing and lexing */
+	OPT_TIME_REPORT,				/**< '-ftime-report' flag, phases timing */
+	OPT_TIME_REPORT_JSON,			/**< '-ftime-report=json' flag, phases timing in JSON */
+	OPT_DEPENDENCIES,				/**< '-MD' flag, dependency file for build systems */
+	OPT_LAZY,						/**< '--lazy' flag, only functions reachable from main are parsed */
+	OPT_NO_SCHEDULE,				/**< '-fno-schedule-insns' flag, no reordering of MIPS instructions */
+	OPT_PROFILE_GENERATE,			/**< '-fprofile-generate' flag, execution counters in generated code */
+	OPT_PROFILE_USE,				/**< '-fprofile-use' flag, code layout by execution profile */
+	OPT_DUMP_AST,					/**< '--dump-ast' flag, dump of abstract syntax tree */
+	OPT_DUMP_VM,					/**< '--dump-vm' flag, dump of virtual machine codes */
+	OPT_DUMP_BINARY,				/**< '--dump-binary' flag, dumps in compact binary form */
+	OPT_FAST_MATH,					/**< '-ffast-math' flag, unsafe floating point optimizations */
+	OPT_RUN,						/**< '--run' flag, execution of LLVM code in process */
+	OPT_STREAM,						/**< '--stream' flag, code generation right after each declaration */
+	OPT_EAGER,						/**< '--eager' flag, loading of all functions at start of virtual machine */
+	OPT_COUNTERS,					/**< '--counters' flag, report of hot path counters */
+	OPT_DENSE,						/**< '--dense' flag, dense instruction codes in binary output */
+	OPT_COMPACT,					/**< '--compact' flag, variable-length codes in binary output */
+	OPT_COMPRESS,					/**< '--compress' flag, compressed sections in binary output */
+	OPT_SYNTAX_ONLY,				/**< '-fsyntax-only' flag, only diagnostics of parsing without code generation */
+	OPT_XREF,						/**< '--xref' flag, symbol cross-reference index */
+	OPT_PACKED,						/**< '--packed' flag, string literals packed as octets in binary output */
+	OPT_ALIGN_DOUBLE,				/**< '-malign-double' flag, floating variables aligned to size of double */
+	OPT_ASYNC_OUTPUT,				/**< '--async-output' flag, output file written by separate thread */
+	OPT_REORDER_FIELDS,				/**< '--reorder-fields' flag, structure fields laid out by alignment */
+	OPT_COST_REPORT,				/**< '-fcost-report' flag, static costs of virtual machine codes */
+	OPT_COST_REPORT_JSON,			/**< '-fcost-report=json' flag, static costs in JSON */
+	OPT_VM_EXTENDED,				/**< '--vm-extended' flag, codes for extended virtual machine */
+
+	OPT_AMOUNT,						/**< Number of recognized flags */
+} option_t;
+
+
 /** Structure for parsing start arguments of program */
 typedef struct workspace
 {
 	strings files;					/**< Files list */
 	strings dirs;					/**< Directories list */
 	strings flags;					/**< Flags list */
+	uint64_t options;				/**< Bitset of recognized flags */
 
 	char output[MAX_ARG_SIZE];		/**< Output file name */
 	bool was_error;					/**< @c 0 if no errors */
+
+	logger error_log;				/**< Error logging function, @c NULL for common one */
+	logger warning_log;				/**< Warning logging function, @c NULL for common one */
 } workspace;
 
 
@@ -64,7 +121,7 @@ EXPORTED workspace ws_create(void);
 
 
 /**
- *	Add file path to workspace
+ *	Add file path to workspace, @c STDIN_PATH stands for standard input
  *
  *	@param	ws			Workspace structure
  *	@param	path		File path
@@ -73,6 +130,16 @@ EXPORTED workspace ws_create(void);
  */
 EXPORTED size_t ws_add_file(workspace *const ws, const char *const path);
 
+/**
+ *	Add path of file, which contents are not stored on disk
+ *
+ *	@param	ws			Workspace structure
+ *	@param	path		File path
+ *
+ *	@return	File index, @c SIZE_MAX on failure
+ */
+EXPORTED size_t ws_add_virtual_file(workspace *const ws, const char *const path);
+
 /**
  *	Add files paths to workspace
  *
@@ -139,6 +206,17 @@ EXPORTED int ws_add_flags(workspace *const ws, const char *const *const flags, c
  */
 EXPORTED int ws_set_output(workspace *const ws, const char *const path);
 
+/**
+ *	Set error and warning logging functions used while processing workspace
+ *
+ *	@param	ws			Workspace structure
+ *	@param	error		Error logging function, @c NULL for common one
+ *	@param	warning		Warning logging function, @c NULL for common one
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int ws_set_log(workspace *const ws, const logger error, const logger warning);
+
 
 /**
  *	Check that workspace structure is correct
@@ -159,6 +237,16 @@ EXPORTED bool ws_is_correct(const workspace *const ws);
  */
 EXPORTED bool ws_has_flag(const workspace *const ws, const char *const flag);
 
+/**
+ *	Check that workspace contains recognized flag, costs single bit test
+ *
+ *	@param	ws			Workspace structure
+ *	@param	opt			Recognized flag
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED bool ws_has_option(const workspace *const ws, const option_t opt);
+
 
 /**
  *	Get file by index from workspase
@@ -208,6 +296,16 @@ EXPORTED size_t ws_get_dirs_num(const workspace *const ws);
  */
 EXPORTED const char *ws_get_flag(const workspace *const ws, const size_t index);
 
+/**
+ *	Get value of flag with prefix like @c "--name="
+ *
+ *	@param	ws			Workspace structure
+ *	@param	prefix		Prefix of flag before value
+ *
+ *	@return	Value of the first such flag with non-empty value, @c NULL if there is none
+ */
+EXPORTED const char *ws_get_flag_value(const workspace *const ws, const char *const prefix);
+
 /**
  *	Get number of flags
  *
@@ -227,6 +325,15 @@ EXPORTED size_t ws_get_flags_num(const workspace *const ws);
  */
 EXPORTED const char *ws_get_output(const workspace *const ws);
 
+/**
+ *	Get number of parallel jobs from flag @c -jN
+ *
+ *	@param	ws			Workspace structure
+ *
+ *	@return	Number of jobs, @c 0 if not set
+ */
+EXPORTED size_t ws_get_jobs(const workspace *const ws);
+
 
 /**
  *	Free allocated memory
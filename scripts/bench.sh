@@ -0,0 +1,233 @@
+#!/bin/bash
+
+init()
+{
+	vm_exec=export.txt
+	llvm_ir=export.ll
+	llvm_exec=export
+
+	vm_release=master
+	repeats=3
+	threshold=10
+	wait_for=600
+
+	dir_install=./install
+	dir_bench=../tests/benchmarks
+	results=bench_results.txt
+
+	subdir_no_llvm=no-llvm
+
+	while ! [[ -z $1 ]]
+	do
+		case $1 in
+			-h|--help)
+				echo -e "Usage: ./${0##*/} [KEY] ..."
+				echo -e "Description:"
+				echo -e "\tThis script measures execution time of all programs from \"$dir_bench\" directory."
+				echo -e "\tEvery program is compiled for RuC virtual machine and for LLVM."
+				echo -e "\tPrograms from \"*/$subdir_no_llvm/*\" subdirectory are executed on RuC virtual machine only."
+				echo -e "\tResults are written as \"name backend seconds\" lines, the best of all runs is taken."
+				echo -e "Keys:"
+				echo -e "\t-h, --help\tTo output help info."
+				echo -e "\t-r, --repeat\tSet number of runs of every program (default = 3)."
+				echo -e "\t-b, --baseline\tSet results file of previous run to detect regressions."
+				echo -e "\t-t, --threshold\tSet allowed slowdown in percent (default = 10)."
+				echo -e "\t-o, --output\tSet results file (default = $results)."
+				echo -e "\t-v, --virtual\tSet RuC virtual machine release."
+				echo -e "\t-w, --wait\tSet waiting time for timeout result (default = 600)."
+				echo -e "\t--no-llvm\tSkip LLVM backend."
+				exit 0
+				;;
+			-r|--repeat)
+				repeats=$2
+				shift
+				;;
+			-b|--baseline)
+				baseline=`realpath $2`
+				shift
+				;;
+			-t|--threshold)
+				threshold=$2
+				shift
+				;;
+			-o|--output)
+				results=$2
+				shift
+				;;
+			-v|--virtual)
+				vm_release=$2
+				shift
+				;;
+			-w|--wait)
+				wait_for=$2
+				shift
+				;;
+			--no-llvm)
+				no_llvm=$1
+				;;
+		esac
+		shift
+	done
+
+	regression=0
+	failure=0
+
+	if [[ $OSTYPE == "darwin"* ]] ; then
+		runner="gtimeout $wait_for"
+	else
+		runner="timeout $wait_for"
+	fi
+
+	TIMEFORMAT=%R
+	log=tmp
+}
+
+build_folder()
+{
+	mkdir -p build && cd build
+
+	if [[ $OSTYPE != "msys" ]] ; then
+		CMAKE_BUILD_TYPE=-DCMAKE_BUILD_TYPE=Release
+	fi
+
+	cmake .. $CMAKE_BUILD_TYPE
+	if ! cmake --build . --config Release ; then
+		exit 1
+	fi
+
+	if [[ $OSTYPE != "msys" ]] ; then
+		cmake --install . --prefix $dir_install --config Release
+		rm -rf Release
+		mv $dir_install/ruc Release
+		rm -rf $dir_install
+	fi
+}
+
+build_vm()
+{
+	if ! [[ -d ruc-vm ]] ; then
+		git clone -b $vm_release --recursive https://github.com/andrey-terekhov/RuC-VM ruc-vm
+		cd ruc-vm
+	else
+		cd ruc-vm
+		git checkout $vm_release
+	fi
+
+	if [[ $OSTYPE != "msys" ]] ; then
+		CMAKE_BUILD_TYPE=-DCMAKE_BUILD_TYPE=Release
+	fi
+
+	mkdir -p build && cd build && cmake .. $CMAKE_BUILD_TYPE
+	if ! cmake --build . --config Release ; then
+		exit 1
+	fi
+
+	cd ../..
+	if [[ $OSTYPE == "msys" ]] ; then
+		interpreter=./ruc-vm/build/Release/ruc-vm
+	else
+		interpreter=./ruc-vm/build/ruc-vm
+	fi
+}
+
+build()
+{
+	cd `dirname $0`/..
+	build_folder
+
+	compiler=./Release/ruc
+	runtime=./Release/libruntime.a
+
+	build_vm
+	rm -f $results
+}
+
+# Run command several times, the best time is saved to $elapsed
+measure()
+{
+	elapsed=""
+	for (( i = 0; i < $repeats; i++ ))
+	do
+		current=$( { time $runner $@ &>$log ; } 2>&1 )
+		if [[ $? != 0 ]] ; then
+			return 1
+		fi
+
+		if [[ -z $elapsed ]] || awk "BEGIN { exit !($current < $elapsed) }" ; then
+			elapsed=$current
+		fi
+	done
+
+	return 0
+}
+
+report()
+{
+	echo "$name $backend $elapsed" >>$results
+
+	previous=""
+	if ! [[ -z $baseline ]] ; then
+		previous=`awk -v name=$name -v backend=$backend '$1 == name && $2 == backend { print $3 }' $baseline`
+	fi
+
+	if [[ -z $previous ]] ; then
+		echo -e "\x1B[1;32m $backend \x1B[1;39m: $name $elapsed s"
+	elif awk "BEGIN { exit !($elapsed > $previous * (100 + $threshold) / 100) }" ; then
+		echo -e "\x1B[1;31m $backend regression \x1B[1;39m: $name $previous s -> $elapsed s"
+		let regression++
+	else
+		echo -e "\x1B[1;32m $backend \x1B[1;39m: $name $previous s -> $elapsed s"
+	fi
+}
+
+message_failure()
+{
+	echo -e "\x1B[1;31m $backend failure \x1B[1;39m: $name"
+	let failure++
+}
+
+bench()
+{
+	# Do not use names with spaces!
+	for path in `find $dir_bench -name *.c | sort`
+	do
+		name=${path#$dir_bench/}
+
+		backend="vm"
+		if $compiler $path -o $vm_exec -VM &>$log && measure $interpreter $vm_exec ; then
+			report
+		else
+			message_failure
+		fi
+
+		if [[ -z $no_llvm && $path != */$subdir_no_llvm/* ]] ; then
+			backend="llvm"
+			if $compiler $path -LLVM -o $llvm_ir &>$log && clang $llvm_ir $runtime -lpthread -lm -o $llvm_exec &>$log \
+				&& measure ./$llvm_exec ; then
+				report
+			else
+				message_failure
+			fi
+		fi
+	done
+
+	echo
+	echo -e "\x1B[1;39m regression = $regression, failure = $failure"
+	rm -f $log $vm_exec $llvm_ir $llvm_exec
+}
+
+main()
+{
+	init $@
+
+	build
+	bench
+
+	if [[ $regression != 0 || $failure != 0 ]] ; then
+		exit 1
+	fi
+
+	exit 0
+}
+
+main $@
@@ -18,6 +18,9 @@ init()
 	dir_multiple_errors=../tests/multiple_errors
 	dir_unsorted=../tests/unsorted
 	dir_exec=../tests/codegen/executable
+	dir_optimized=../tests/codegen/executable/optimized
+	dir_rvm=../tests/codegen/rvm
+	dir_mips=../tests/codegen/mips
 
 	subdir_error=errors
 	subdir_warning=warnings
@@ -37,6 +40,9 @@ init()
 				echo -e "\tFolder \"$dir_multiple_errors\" should contain tests with multiple errors."
 				echo -e "\tFolder \"$dir_unsorted\" should contain tests with unsorted errors."
 				echo -e "\tExecutable tests should be in \"$dir_exec\" directory."
+				echo -e "\tExecutable tests of optimizations compiled with -O1 should be in \"$dir_optimized\" directory."
+				echo -e "\tTests of register virtual machine backend should be in \"$dir_rvm\" directory."
+				echo -e "\tTests of MIPS backend should be in \"$dir_mips\" directory."
 				echo -e "\tTo ignore invalid tests output, use \"*/$subdir_warning/*\" subdirectory."
 				echo -e "\tFor tests with expected runtime error, use \"*/$subdir_error/*\" subdirectory."
 				echo -e "\tFor multi-file tests, use \"*/$subdir_include/*\" subdirectory."
@@ -381,7 +387,7 @@ compiling()
 	if [[ -z $ignore || $path != $dir_lexing/* || $path != $dir_preprocessor/* || $path != $dir_semantics/* 
 		|| $path != $dir_syntax/* || $path != $dir_multiple_errors/* || $path != $dir_unsorted/* ]] ; then
 		action="compiling"
-		run $compiler $compiler_debug $sources -o $vm_exec -VM
+		run $compiler $compiler_debug $sources -o $vm_exec -VM $options
 
 		case $? in
 			0)
@@ -446,15 +452,72 @@ compiling()
 	fi
 }
 
+backend()
+{
+	# $1 - каталог тестов кодогенератора, $2 - ключ кодогенератора, $3 - строка, обязательная в выводе
+	if [[ $path == $1/* ]] ; then
+		action="compiling $2"
+		run $compiler $compiler_debug $sources -o $vm_exec $2
+
+		case $? in
+			0)
+				if [[ $path == */$subdir_error/* || $build_type == "(Debug)" ]] || ! grep -q "$3" $vm_exec ; then
+					build_type=""
+
+					message_failure
+					let failure++
+				else
+					message_success
+					let success++
+				fi
+				;;
+			124|142)
+				message_timeout
+				let timeout++
+				;;
+			$exit_code)
+				if [[ $path == */$subdir_error/* && $build_type != "(Debug)" ]] ; then
+					message_success
+					let success++
+				else
+					build_type=""
+
+					message_failure
+					let failure++
+
+					if ! [[ -z $debug ]] ; then
+						cat $log
+					fi
+				fi
+				;;
+			*)
+				message_failure
+				let failure++
+
+				if ! [[ -z $debug ]] ; then
+					cat $log
+				fi
+				;;
+		esac
+	fi
+}
+
 test()
 {
 	# Do not use names with spaces!
 	for path in `find $dir_test -name *.c | sort`
 	do
 		sources=$path
+		options=""
+
+		if [[ $path == $dir_optimized/* ]] ; then
+			options=-O1
+		fi
 
 		if [[ $path != */$subdir_include/* ]] ; then
 			compiling
+			backend $dir_rvm -RVM "^entry main$"
+			backend $dir_mips -MIPS "^main:$"
 		fi
 	done
 
@@ -463,6 +526,7 @@ test()
 		for path in `ls -d $include/*`
 		do
 			sources=`find $path -name *.c | sort`
+			options=""
 
 			for subdir in `find $path -name *.h | sort`
 			do
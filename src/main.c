@@ -18,7 +18,9 @@
 	#pragma comment(linker, "/STACK:268435456")
 #endif
 
+#include <string.h>
 #include "compiler.h"
+#include "server.h"
 #include "workspace.h"
 
 
@@ -28,6 +30,12 @@ const char *name = "../tests/executable/output/printf/string_rus.c";
 
 int main(int argc, const char *argv[])
 {
+	// Сервер принимает запросы из стандартного ввода или из сокета, указанного после флага
+	if (argc == 2 && strncmp(argv[1], "--server", 8) == 0 && (argv[1][8] == '\0' || argv[1][8] == '='))
+	{
+		return compile_server(argv[1][8] == '=' ? &argv[1][9] : NULL);
+	}
+
 	workspace ws = ws_parse_args(argc, argv);
 
 	if (argc < 2)
@@ -37,10 +45,14 @@ int main(int argc, const char *argv[])
 		ws_set_output(&ws, "export.txt");
 	}
 
+	// При исполнении в процессе возвращается код завершения программы
+	int result = 0;
+	const status_t sts = ws_has_option(&ws, OPT_RUN) ? compile_and_run(&ws, &result) : compile(&ws);
+
 #ifdef TESTING_EXIT_CODE
-	const int ret = compile(&ws) ? TESTING_EXIT_CODE : 0;
+	const int ret = sts ? TESTING_EXIT_CODE : result;
 #else
-	const int ret = compile(&ws);
+	const int ret = sts ? (int)sts : result;
 #endif
 
 	ws_clear(&ws);
@@ -0,0 +1,38 @@
+#define N 128
+
+void main()
+{
+	double a[N][N];
+	double b[N][N];
+	double c[N][N];
+
+	for (int i = 0; i < N; i++)
+	{
+		for (int j = 0; j < N; j++)
+		{
+			a[i][j] = (i + j) % 7 + 0.5;
+			b[i][j] = (i * j) % 5 - 1.5;
+			c[i][j] = 0;
+		}
+	}
+
+	for (int i = 0; i < N; i++)
+	{
+		for (int k = 0; k < N; k++)
+		{
+			double aik = a[i][k];
+			for (int j = 0; j < N; j++)
+			{
+				c[i][j] += aik * b[k][j];
+			}
+		}
+	}
+
+	double trace = 0;
+	for (int i = 0; i < N; i++)
+	{
+		trace += c[i][i];
+	}
+
+	printf("trace = %f\n", trace);
+}
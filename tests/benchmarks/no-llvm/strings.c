@@ -0,0 +1,34 @@
+#define ROUNDS 2000
+
+void main()
+{
+	int total = 0;
+
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		char buffer[] = "";
+		for (int j = 0; j < 8; j++)
+		{
+			if ((i + j) % 3 == 0)
+			{
+				strcat(&buffer, "альфа");
+			}
+			else
+			{
+				strcat(&buffer, "beta");
+			}
+		}
+
+		char copy[] = "";
+		strcpy(&copy, buffer);
+		assert(strcmp(copy, buffer) == 0, "copy must be equal");
+
+		total += strlen(buffer);
+		if (strncmp(buffer, "альфа", 5) == 0)
+		{
+			total--;
+		}
+	}
+
+	assert(total > 0, "total must be positive");
+}
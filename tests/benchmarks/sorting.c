@@ -0,0 +1,100 @@
+#define N 50000
+
+int seed = 12345;
+
+int next_random()
+{
+	seed = (seed * 1103515245 + 12345) % 2147483647;
+	if (seed < 0)
+	{
+		seed = -seed;
+	}
+
+	return seed % 100000;
+}
+
+void quick_sort(int values[], int low, int high)
+{
+	while (low < high)
+	{
+		int pivot = values[(low + high) / 2];
+		int i = low;
+		int j = high;
+
+		while (i <= j)
+		{
+			while (values[i] < pivot)
+			{
+				i++;
+			}
+
+			while (values[j] > pivot)
+			{
+				j--;
+			}
+
+			if (i <= j)
+			{
+				int temp = values[i];
+				values[i] = values[j];
+				values[j] = temp;
+				i++;
+				j--;
+			}
+		}
+
+		if (j - low < high - i)
+		{
+			quick_sort(values, low, j);
+			low = i;
+		}
+		else
+		{
+			quick_sort(values, i, high);
+			high = j;
+		}
+	}
+}
+
+void insertion_sort(int values[], int size)
+{
+	for (int i = 1; i < size; i++)
+	{
+		int value = values[i];
+		int j = i - 1;
+		while (j >= 0 && values[j] > value)
+		{
+			values[j + 1] = values[j];
+			j--;
+		}
+
+		values[j + 1] = value;
+	}
+}
+
+void main()
+{
+	int values[N];
+	for (int i = 0; i < N; i++)
+	{
+		values[i] = next_random();
+	}
+
+	quick_sort(values, 0, N - 1);
+	for (int i = 1; i < N; i++)
+	{
+		assert(values[i - 1] <= values[i], "quick sort failed");
+	}
+
+	int small[N / 10];
+	for (int i = 0; i < N / 10; i++)
+	{
+		small[i] = next_random();
+	}
+
+	insertion_sort(small, N / 10);
+	for (int i = 1; i < N / 10; i++)
+	{
+		assert(small[i - 1] <= small[i], "insertion sort failed");
+	}
+}
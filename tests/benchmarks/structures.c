@@ -0,0 +1,59 @@
+#define PARTICLES 2000
+#define STEPS 300
+
+struct particle
+{
+	double x;
+	double y;
+	double vx;
+	double vy;
+	int bounces;
+};
+
+void step(struct particle particles[], int size, double dt)
+{
+	for (int i = 0; i < size; i++)
+	{
+		particles[i].vy -= 9.8 * dt;
+		particles[i].x += particles[i].vx * dt;
+		particles[i].y += particles[i].vy * dt;
+
+		if (particles[i].y < 0)
+		{
+			particles[i].y = -particles[i].y;
+			particles[i].vy = -particles[i].vy * 0.9;
+			particles[i].bounces++;
+		}
+
+		if (particles[i].x < 0 || particles[i].x > 100)
+		{
+			particles[i].vx = -particles[i].vx;
+		}
+	}
+}
+
+void main()
+{
+	struct particle particles[PARTICLES];
+	for (int i = 0; i < PARTICLES; i++)
+	{
+		particles[i].x = i % 100;
+		particles[i].y = 10 + i % 17;
+		particles[i].vx = (i % 11) - 5;
+		particles[i].vy = 0;
+		particles[i].bounces = 0;
+	}
+
+	for (int i = 0; i < STEPS; i++)
+	{
+		step(particles, PARTICLES, 0.01);
+	}
+
+	int bounces = 0;
+	for (int i = 0; i < PARTICLES; i++)
+	{
+		bounces += particles[i].bounces;
+	}
+
+	assert(bounces >= 0, "bounces must not be negative");
+}
@@ -0,0 +1,37 @@
+#define ROUNDS 2000
+
+void* ponger(void* arg)
+{
+	struct msg_info { int numTh; int data; } msg;
+	struct msg_info reply;
+	reply.numTh = 0;
+
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		msg = t_msg_receive();
+		reply.data = msg.data + 1;
+		t_msg_send(reply);
+	}
+
+	t_exit();
+	return 0;
+}
+
+int main()
+{
+	struct msg_info { int numTh; int data; } msg;
+	struct msg_info request;
+	request.numTh = t_create(ponger);
+	request.data = 0;
+
+	for (int i = 0; i < ROUNDS; i++)
+	{
+		t_msg_send(request);
+		msg = t_msg_receive();
+		request.data = msg.data + 1;
+	}
+
+	t_join(request.numTh);
+	assert(request.data == 2 * ROUNDS, "every message must be answered");
+	return 0;
+}
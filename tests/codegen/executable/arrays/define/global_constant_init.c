@@ -0,0 +1,15 @@
+int table[] = { 1, 2, 3, 4 };
+double matrix[2][2] = { { 1.5, 2.5 }, { 3.0, -4.25 } };
+char letters[] = { 'a', 'b', 'c' };
+int rows[2][] = { { 1, 2 }, { 3 } };
+
+void main()
+{
+	assert(table[3] == 4, "table[3] must be 4");
+	assert(matrix[1][1] < -4.0, "matrix[1][1] must be negative");
+	assert(letters[2] == 'c', "letters[2] must be 'c'");
+	assert(rows[1][0] == 3, "rows[1][0] must be 3");
+
+	table[0] = 5;
+	assert(table[0] == 5, "constant initialized array must stay writable");
+}
@@ -0,0 +1,44 @@
+int counter = 0;
+
+int square(int x)
+{
+	return x * x;
+}
+
+int get_counter()
+{
+	return counter;
+}
+
+void increase(int *p)
+{
+	*p = *p + 1;
+}
+
+int is_even(int);
+
+int is_odd(int n)
+{
+	return n == 0 ? 0 : is_even(n - 1);
+}
+
+int is_even(int n)
+{
+	return n == 0 ? 1 : is_odd(n - 1);
+}
+
+void main()
+{
+	int sum = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		sum += square(i);
+	}
+	assert(sum == 14, "sum of squares must be 14");
+
+	int before = get_counter();
+	increase(&counter);
+	assert(get_counter() == before + 1, "counter must be read after write");
+
+	assert(is_even(10) == 1 && is_odd(7) == 1, "mutual recursion must work");
+}
@@ -0,0 +1,34 @@
+struct point
+{
+	int x;
+	int y;
+};
+
+void main()
+{
+	int a[4] = { 10, 20, 30, 40 };
+	int b[2] = { 0, 0 };
+	int *p = &b[0];
+
+	int sum = 0;
+	sum = a[b[0]] + (*p = 1) + a[b[0]];
+	assert(sum == 10 + 1 + 20, "sum must be 31");
+
+	int m[2][2] = { { 1, 2 }, { 3, 4 } };
+	int i = 0;
+	int *q = &i;
+	m[i][1] = m[i][1] * 10 + (*q = 1) + m[i][1];
+	assert(m[0][1] == 20 + 1 + 4, "m[0][1] must be 25");
+	assert(m[1][1] == 4, "m[1][1] must stay 4");
+
+	struct point points[2];
+	points[0].x = 1;
+	points[1].x = 3;
+	int k = 0;
+	points[k].y = points[k].x + (k = 1) + points[k].x;
+	assert(points[0].y == 1 + 1 + 3, "points[0].y must be 5");
+
+	int *r = &a[2];
+	a[3] = a[2] * 2 + (*r = 7) + a[2];
+	assert(a[3] == 60 + 7 + 7, "a[3] must be 74");
+}
@@ -0,0 +1,10 @@
+void main()
+{
+	int a[3][3] = { { 1, 2, 3 }, { 4, 5, 6 }, { 7, 8, 9 } };
+	int i = 1, j = 2;
+	a[i][j] = a[i][j] * 2 + a[i][j];
+	assert(a[1][2] == 18, "a[1][2] must be 18");
+
+	a[i][j] = a[j][i] + a[i][j];
+	assert(a[1][2] == 26, "a[1][2] must be 26");
+}
@@ -0,0 +1,43 @@
+int counter = 0;
+
+int square(int x)
+{
+	return x * x;
+}
+
+int add(int a, int b)
+{
+	return a + b;
+}
+
+double half(double x)
+{
+	return x / 2;
+}
+
+int next()
+{
+	counter = counter + 1;
+	return counter;
+}
+
+void main()
+{
+	int x = 5;
+	assert(add(square(2), square(add(1, 2))) == 13, "add(square(2), square(add(1, 2))) must be 13");
+	assert(square(x + 1) == 36, "square(x + 1) must be 36");
+	assert(x == 5, "x must stay 5");
+	assert(half(3.0) > 1.4 && half(3.0) < 1.6, "half(3.0) must be 1.5");
+
+	int first = next();
+	next();
+	assert(first == 1, "first must be 1");
+	assert(counter == 2, "counter must be 2");
+
+	int sum = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		sum += square(i);
+	}
+	assert(sum == 14, "sum must be 14");
+}
@@ -0,0 +1,22 @@
+int factorial(int n)
+{
+	return n <= 1 ? 1 : n * factorial(n - 1);
+}
+
+int twice(int n)
+{
+	return factorial(n) + factorial(n);
+}
+
+int get(int a[], int i)
+{
+	return a[i];
+}
+
+void main()
+{
+	int a[3] = { 4, 5, 6 };
+	assert(factorial(5) == 120, "factorial(5) must be 120");
+	assert(twice(3) == 12, "twice(3) must be 12");
+	assert(get(a, 2) == 6, "get(a, 2) must be 6");
+}
@@ -0,0 +1,38 @@
+void main()
+{
+	int a[20];
+	for (int i = 0; i < 20; i++)
+	{
+		a[i] = 0;
+	}
+
+	for (int i = 0; i < 5; i++)
+	{
+		a[i * 4] = i * 4 + 1;
+	}
+	assert(a[0] == 1, "a[0] must be 1");
+	assert(a[8] == 9, "a[8] must be 9");
+	assert(a[16] == 17, "a[16] must be 17");
+	assert(a[1] == 0, "a[1] must be 0");
+
+	int sum = 0;
+	for (int i = 10; i > 0; i -= 2)
+	{
+		sum += i * 3;
+	}
+	assert(sum == 90, "sum must be 90");
+
+	int k = 0;
+	int last = 0;
+	for (int i = 0; i < 10; i++)
+	{
+		last = i * 2;
+		if (i == 3)
+		{
+			i = 7;
+		}
+		k++;
+	}
+	assert(k == 6, "k must be 6");
+	assert(last == 18, "last must be 18");
+}
@@ -0,0 +1,49 @@
+int limit = 10;
+
+void shrink()
+{
+	limit = limit - 1;
+}
+
+void main()
+{
+	int a = 2, b = 3;
+	int sum = 0;
+	for (int i = 0; i < 5; i++)
+	{
+		sum += a * b;
+		if (i == 2)
+		{
+			b = 4;
+		}
+	}
+	assert(sum == 6 * 3 + 8 * 2, "sum must be 34");
+
+	int n = 8;
+	int count = 0;
+	while (count < n * 2)
+	{
+		count++;
+		n--;
+	}
+	assert(count == 6, "count must be 6");
+	assert(n == 2, "n must be 2");
+
+	int c = 1;
+	int *p = &c;
+	int product = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		product += c * 10;
+		*p = *p + 1;
+	}
+	assert(product == 60, "product must be 60");
+
+	int steps = 0;
+	do
+	{
+		steps++;
+		shrink();
+	} while (steps < limit + 0 * steps);
+	assert(steps == 5, "steps must be 5");
+}
@@ -0,0 +1,14 @@
+void main()
+{
+	int sum = 0;
+	for (int i = 10; i > 0; i -= 2)
+	{
+		sum += i * 3;
+		if (i == 6)
+		{
+			continue;
+		}
+		sum += 1;
+	}
+	assert(sum == 3 * 30 + 4, "sum must be 94");
+}
@@ -0,0 +1,27 @@
+int calls = 0;
+
+int count()
+{
+	calls++;
+	return calls;
+}
+
+int unused_function(int x)
+{
+	return x * 2;
+}
+
+int unused_global = 5;
+int unused_with_side_effect = count();
+int used_global = 7;
+
+int used_function(int x)
+{
+	return x + used_global;
+}
+
+void main()
+{
+	assert(calls == 1, "initializer of unused global must be called once");
+	assert(used_function(3) == 10, "used_function(3) must be 10");
+}
@@ -0,0 +1,13 @@
+int counter = 0;
+
+void main()
+{
+	assert(t_atomic_add(&counter, 5) == 0, "old value must be returned");
+	assert(t_atomic_load(&counter) == 5, "counter must be increased");
+
+	assert(t_atomic_cas(&counter, 5, 7) == 5, "exchange must succeed");
+	assert(t_atomic_cas(&counter, 5, 9) == 7, "exchange must fail");
+
+	н_атом_записать(&counter, 11);
+	assert(н_атом_прочитать(&counter) == 11, "counter must be stored");
+}
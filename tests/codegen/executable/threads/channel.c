@@ -0,0 +1,42 @@
+int frames[8][16];
+int sums[8];
+
+void stage(int i)
+{
+	if (i == 0)
+	{
+		for (int k = 0; k < 8; k++)
+		{
+			for (int j = 0; j < 16; j++)
+			{
+				frames[k][j] = k + j;
+			}
+
+			t_chan_send(1, k);
+		}
+	}
+	else
+	{
+		for (int k = 0; k < 8; k++)
+		{
+			int frame = н_канал_получить(1);
+			int sum = 0;
+			for (int j = 0; j < 16; j++)
+			{
+				sum += frames[frame][j];
+			}
+
+			sums[frame] = sum;
+		}
+	}
+}
+
+void main()
+{
+	t_parallel_for(stage, 0, 2);
+
+	for (int k = 0; k < 8; k++)
+	{
+		assert(sums[k] == 16 * k + 120, "frame must be passed through channel");
+	}
+}
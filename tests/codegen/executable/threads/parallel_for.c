@@ -0,0 +1,19 @@
+int squares[1000];
+int total = 0;
+
+void square(int i)
+{
+	squares[i] = i * i;
+	t_atomic_add(&total, i);
+}
+
+void main()
+{
+	t_parallel_for(square, 0, 1000);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		assert(squares[i] == i * i, "wrong square");
+	}
+	assert(total == 499500, "wrong total");
+}
@@ -0,0 +1,21 @@
+void main()
+{
+	// Политики реального времени требуют прав, поэтому результат не проверяется
+	t_set_priority(1, 10);
+	assert(t_set_priority(0, 0) == 0, "default policy must be set");
+	assert(t_set_priority(3, 0) == -1, "unknown policy must fail");
+
+	t_set_affinity(0);
+	assert(t_set_affinity(-1) == 0, "all processors must be allowed");
+
+	int missed = 0;
+	t_period_start(2000);
+	for (int i = 0; i < 5; i++)
+	{
+		missed += t_period_wait();
+	}
+	assert(missed >= 0, "missed periods must be counted");
+
+	н_период(0);
+	assert(н_ждать_период() == 0, "stopped period must not wait");
+}
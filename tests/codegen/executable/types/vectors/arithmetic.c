@@ -0,0 +1,24 @@
+float4 scale(float4 a, float4 k)
+{
+	return a * k;
+}
+
+void main()
+{
+	float4 a = { 1.0, 2.0, 3.0, 4.0 };
+	float4 b = { 0.5, 0.5, 2.0, -1.0 };
+	float4 c = a + b;
+	float4 s;
+
+	цел4 i = { 1, 2, 3, 4 };
+	цел4 j = { 10, 20, 30, 40 };
+	цел4 r;
+
+	r = j / i - i;
+	assert(r.x == 9 && r.y == 8 && r.z == 7 && r.w == 6, "int4 arithmetic");
+
+	s = scale(c, b) - a;
+	assert(abs(c.x - 1.5) < 0.001 && abs(c.w - 3.0) < 0.001, "float4 addition");
+	assert(abs(s.x + 0.25) < 0.001 && abs(s.y + 0.75) < 0.001, "float4 product");
+	assert(abs(s.z - 7.0) < 0.001 && abs(s.w + 7.0) < 0.001, "float4 difference");
+}
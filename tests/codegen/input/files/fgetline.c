@@ -0,0 +1,14 @@
+void main()
+{
+	FILE *f = fopen("../../../ruc/tests/executable/files/selftest.c", "r");
+
+	char line[256];
+	int length = fgetline(line, 256, f);
+	while (length != 0)
+	{
+		printf("%i: %s", length, line);
+		length = fgetline(line, 256, f);
+	}
+
+	fclose(f);
+}
@@ -0,0 +1,18 @@
+void main()
+{
+	int numbers[4] = { 1, 2, 3, 4 };
+	FILE *f = fopen("block.bin", "w");
+	fwrite_ints(numbers, 4, f);
+	fwrite_chars("block", 5, f);
+	fclose(f);
+
+	int read_numbers[4];
+	char read_chars[6];
+	f = fopen("block.bin", "r");
+	printf("%i ", fread_ints(read_numbers, 4, f));
+	printf("%i\n", fread_chars(read_chars, 5, f));
+	fclose(f);
+
+	read_chars[5] = '\0';
+	printf("%i %s\n", read_numbers[3], read_chars);
+}
@@ -0,0 +1,25 @@
+int main()
+{
+	int a[5] = { 5, 3, 4, 1, 2 };
+	for (int i = 0; i < 5; i++)
+	{
+		for (int j = i + 1; j < 5; j++)
+		{
+			if (a[j] < a[i])
+			{
+				int t = a[i];
+				a[i] = a[j];
+				a[j] = t;
+			}
+		}
+	}
+
+	double sum = 0;
+	for (int i = 0; i < 5; i++)
+	{
+		sum += a[i] * 0.5;
+	}
+
+	printf("%i %f\n", a[0], sum);
+	return 0;
+}
@@ -0,0 +1,14 @@
+int fact(int n)
+{
+	return n <= 1 ? 1 : n * fact(n - 1);
+}
+
+int main()
+{
+	for (int i = 0; i < 5; i++)
+	{
+		printf("%i\n", fact(i));
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+void main()
+{
+	int i = 0, sum = 0;
+	while (i < 10)
+	{
+		i++;
+		if (i % 2 == 0)
+		{
+			continue;
+		}
+
+		sum += i;
+	}
+
+	do
+	{
+		sum--;
+	} while (sum > 20);
+
+	for (int j = 0; j < 100; j++)
+	{
+		if (j * j > sum)
+		{
+			break;
+		}
+
+		print(j);
+	}
+}
@@ -0,0 +1,5 @@
+void main()
+{
+	int a[3] = { 1, 2, 3 };
+	print(a[1]);
+}
@@ -0,0 +1,11 @@
+struct point
+{
+	int x;
+	int y;
+};
+
+void main()
+{
+	struct point p = { 1, 2 };
+	print(p.x + p.y);
+}
@@ -0,0 +1,13 @@
+int fact(int n)
+{
+	return n <= 1 ? 1 : n * fact(n - 1);
+}
+
+void main()
+{
+	int i;
+	for (i = 0; i < 5; i++)
+	{
+		print(fact(i));
+	}
+}
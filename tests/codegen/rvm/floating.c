@@ -0,0 +1,21 @@
+double scale = 0.5;
+int steps = 10;
+
+double area(double from, double to)
+{
+	double h = (to - from) / steps;
+	double sum = 0;
+	for (int i = 0; i < steps; i++)
+	{
+		double x = from + i * h;
+		sum += x * x * h;
+	}
+
+	return sum * scale;
+}
+
+void main()
+{
+	bool is_positive = area(0, 1) > 0;
+	print(is_positive ? area(0, 2) : abs(area(-1, 0)));
+}
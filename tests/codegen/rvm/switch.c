@@ -0,0 +1,24 @@
+int classify(int n)
+{
+	switch (n % 4)
+	{
+		case 0:
+			return 10;
+		case 1:
+		case 2:
+			n += 5;
+			break;
+		default:
+			n = -n;
+	}
+
+	return n;
+}
+
+void main()
+{
+	for (int i = 0; i < 8; i++)
+	{
+		print(classify(i));
+	}
+}